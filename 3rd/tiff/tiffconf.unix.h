@@ -58,7 +58,7 @@
 #define TIFF_UINT64_T uint64_t
 
 /* Signed size type */
-#if defined(_WIN64)
+#if defined(_WIN64) || defined(__LP64__)
 #define TIFF_SSIZE_T int64_t
 #else
 #define TIFF_SSIZE_T int32_t
@@ -0,0 +1,41 @@
+#include <cgv/base/register.h>
+#include <cgv/render/null_context.h>
+#include <cgv/utils/scan.h>
+#include <iostream>
+
+using namespace cgv::base;
+using namespace cgv::render;
+
+/** renders the drawables registered by the plugins given on the command line with a null_context and reports
+    the CPU time per frame and per drawable. Besides the usual command line arguments, "frames=N" specifies the
+    number of timed frames. Drawables may use the renderers of cgv_gl, but must not issue GL commands themselves.
+    Example: render_bench plugin:my_plugin frames=500 */
+int main(int argc, char** argv)
+{
+	unsigned nr_frames = 100;
+	std::vector<char*> args;
+	for (int ai = 0; ai < argc; ++ai) {
+		std::string arg(argv[ai]);
+		int n;
+		if (arg.substr(0, 7) == "frames=" && cgv::utils::is_integer(arg.substr(7), n) && n > 0)
+			nr_frames = n;
+		else
+			args.push_back(argv[ai]);
+	}
+	null_context_ptr ctx = new null_context();
+	register_object(ctx);
+	enable_registration();
+	process_command_line_args(int(args.size()), &args[0]);
+	if (ctx->get_nr_children() == 0) {
+		std::cout << "no drawables registered, specify plugins with plugin:<name>" << std::endl;
+		return -1;
+	}
+	// warm up caches and lazily created render objects before timing
+	ctx->replay_frame(10);
+	ctx->clear_drawable_timings();
+	double seconds = ctx->replay_frame(nr_frames);
+	std::cout << "average CPU time per frame " << 1000 * seconds << " ms" << std::endl;
+	ctx->print_report(std::cout);
+	unregister_all_objects();
+	return 0;
+}
@@ -1,5 +1,6 @@
 #include <cgv/base/register.h>
 #include <iostream>
+#include <cstring>
 
 using namespace cgv::base;
 
@@ -7,6 +8,7 @@ using namespace cgv::base;
 struct test_listener : public base, public registration_listener
 {
 	static std::vector<base_ptr> tests;
+	static bool run_benchmarks;
 	void register_object(base_ptr object, const std::string& options)
 	{
 		if (object->get_interface<test>())
@@ -21,9 +23,13 @@ struct test_listener : public base, public registration_listener
 			std::cout << "no tests registered" << std::endl;
 			return true;
 		}
-		unsigned int succeeded = 0;
+		unsigned int succeeded = 0, skipped = 0;
 		for (unsigned int i=0; i<tests.size(); ++i) {
 			test* t = tests[i]->get_interface<test>();
+			if (t->is_benchmark_test() && !run_benchmarks) {
+				++skipped;
+				continue;
+			}
 			std::cout << "test " << t->get_test_name().c_str() << ":";
 			std::cout.flush();
 			cgv::base::test::nr_failed = 0;
@@ -35,20 +41,32 @@ struct test_listener : public base, public registration_listener
 				std::cout << "failed";
 			std::cout << std::endl;
 		}
-		if (succeeded == tests.size()) {
+		if (skipped > 0)
+			std::cout << skipped << " benchmarks skipped, run with --benchmarks to execute them" << std::endl;
+		if (succeeded + skipped == tests.size()) {
 			std::cout << "all tests successful" << std::endl;
 			return true;
 		}
 		else
-			std::cout << (tests.size()-succeeded) << " tests of " << tests.size() << " failed" << std::endl;
+			std::cout << (tests.size()-skipped-succeeded) << " tests of " << (tests.size()-skipped) << " failed" << std::endl;
 		return false;
 	}
 };
 
 std::vector<base_ptr> test_listener::tests;
+bool test_listener::run_benchmarks = false;
 
 int main(int argc, char** argv)
 {
+	// benchmarks only measure timings and are executed on request only
+	int j = 1;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--benchmarks") == 0)
+			test_listener::run_benchmarks = true;
+		else
+			argv[j++] = argv[i];
+	}
+	argc = j;
 	register_object(new test_listener());
 	enable_registration();
 	process_command_line_args(argc, argv);
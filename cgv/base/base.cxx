@@ -4,6 +4,7 @@
 #include "group.h"
 #include <cgv/reflect/get_reflection_handler.h>
 #include <cgv/reflect/set_reflection_handler.h>
+#include <cgv/reflect/property_index.h>
 #include <cgv/type/variant.h>
 #include <cgv/utils/tokenizer.h>
 #include <cgv/utils/scan.h>
@@ -163,6 +164,21 @@ bool base::self_reflect(reflection_handler&)
 	return true;
 }
 
+/// the default implementation returns 0 and disables the property index
+const property_index* base::get_property_index()
+{
+	return 0;
+}
+
+/// the index is never deleted, as function local statics of ref_property_index() point to it until the process ends
+const property_index* build_property_index(base* instance, size_t size)
+{
+	property_index* index = new property_index();
+	property_index_builder pib(*index, instance, size);
+	instance->self_reflect(pib);
+	return index;
+}
+
 
 /// overload to implement the execution of a method based on the method name and the given parameters
 bool base::call_void(const std::string& method, 
@@ -177,9 +193,23 @@ bool base::call_void(const std::string& method,
 }
 
 
+/// return the entry of the property in the property index of the dynamic type of the instance or 0
+static const property_index::entry* find_indexed_member(base* instance, const std::string& property)
+{
+	const property_index* index = instance->get_property_index();
+	return index ? index->find(property) : 0;
+}
+
 /// abstract interface for the setter, by default it simply returns false
 bool base::set_void(const std::string& property, const std::string& value_type, const void* value_ptr)
 {
+	const property_index::entry* e = find_indexed_member(this, property);
+	if (e) {
+		if (!property_index::set_value(this, *e, value_type, value_ptr))
+			return false;
+		on_set(property_index::get_member_ptr(this, *e));
+		return true;
+	}
 	set_reflection_handler ssrh(property, value_type, value_ptr);
 	self_reflect(ssrh);
 	if (ssrh.found_valid_target()) {
@@ -206,6 +236,16 @@ bool base::set_void(const std::string& property, const std::string& value_type,
 	return false;
 }
 
+/// set several properties
+unsigned base::multi_set_void(const std::vector<std::string>& properties, const std::vector<std::string>& value_types, const std::vector<const void*>& value_ptrs)
+{
+	unsigned nr_set = 0;
+	for (size_t i = 0; i < properties.size() && i < value_types.size() && i < value_ptrs.size(); ++i)
+		if (set_void(properties[i], value_types[i], value_ptrs[i]))
+			++nr_set;
+	return nr_set;
+}
+
 /// this callback is called when the set_void method has changed a member and can be overloaded in derived class
 void base::on_set(void* member_ptr)
 {
@@ -214,6 +254,9 @@ void base::on_set(void* member_ptr)
 /// abstract interface for the getter, by default it simply returns false
 bool base::get_void(const std::string& property, const std::string& value_type, void* value_ptr)
 {
+	const property_index::entry* e = find_indexed_member(this, property);
+	if (e)
+		return property_index::get_value(this, *e, value_type, value_ptr);
 	get_reflection_handler gsrh(property, value_type, value_ptr);
 	self_reflect(gsrh);
 	if (gsrh.found_valid_target())
@@ -351,6 +394,12 @@ bool base::is_property(const std::string& property_name, std::string* type_name)
     property is copied to the referenced string.*/
 void* base::find_member_ptr(const std::string& property_name, std::string* type_name)
 {
+	const property_index::entry* e = find_indexed_member(this, property_name);
+	if (e) {
+		if (type_name)
+			*type_name = e->rt->get_type_name();
+		return property_index::get_member_ptr(this, *e);
+	}
 	find_reflection_handler fsrh(property_name);
 	self_reflect(fsrh);
 	if (!fsrh.found_target())
@@ -4,6 +4,7 @@
 #include <cgv/reflect/reflection_handler.h>
 #include <cgv/data/ref_ptr.h>
 #include <iostream>
+#include <typeinfo>
 
 #include <cgv/type/lib_begin.h>
 
@@ -18,6 +19,9 @@ typedef cgv::data::ref_ptr<const type_interface,true> const_type_ptr;
 
 		}
 	}
+	namespace reflect {
+		class property_index;
+	}
 }
 #include <cgv/config/lib_end.h>
 
@@ -113,6 +117,13 @@ public:
 	    with corresponding reflection handlers. 
 		The default implementation of self_reflect is empty. */
 	virtual bool self_reflect(cgv::reflect::reflection_handler&);
+	//! overload to enable caching of the members found by self_reflect() in a cgv::reflect::property_index
+	/*! Return cgv::base::ref_property_index(this) if self_reflect() reflects the same members for
+		all instances independent of their state. Only members inside of the instance are cached,
+		members reached through pointers or vectors are always looked up with self_reflect().
+		Instances of derived classes use self_reflect() unless they overload this method again. The
+		default implementation returns 0, which disables the cache. */
+	virtual const cgv::reflect::property_index* get_property_index();
 	//! return a semicolon separated list of property declarations
 	/*! of the form "name1:type1;name2:type2;...", by default an empty 
 		list is returned. The types should by consistent with the names 
@@ -124,14 +135,19 @@ public:
 	//! abstract interface for the setter of a dynamic property. 
 	/*! The default implementation 
 	    uses the self_reflect() method to find a member with the given property as name. If
-		not found, the set_void method returns false. */
+		not found, the set_void method returns false. If get_property_index() is overloaded, the
+		members found by self_reflect() are cached per type in a cgv::reflect::property_index such
+		that self_reflect() is only traversed for properties that are not indexed. */
 	virtual bool set_void(const std::string& property, const std::string& value_type, const void* value_ptr);
+	//! set several properties with one call to set_void() per property and return the number of successfully set properties
+	unsigned multi_set_void(const std::vector<std::string>& properties, const std::vector<std::string>& value_types, const std::vector<const void*>& value_ptrs);
 	/// this callback is called when the set_void method has changed a member and can be overloaded in derived class
 	virtual void on_set(void* member_ptr);
 	//! abstract interface for the getter of a dynamic property. 
 	/*! The default implementation 
 	    uses the self_reflect() method to find a member with the given property as name. If
-		not found, the get_void method returns false. */
+		not found, the get_void method returns false. Like set_void() it uses the property index
+		of the type. */
 	virtual bool get_void(const std::string& property, const std::string& value_type, void* value_ptr);
 	//! abstract interface to call an action
 	/*! , i.e. a class method based on the action name and 
@@ -181,6 +197,20 @@ inline data::ref_ptr<T,true> cast_helper_base::cast_of_base(base* b)
 	return base::cast_dynamic<T>(b);
 }
 
+/// build the property index of a type of the given size from the self reflection of one of its instances
+extern CGV_API const cgv::reflect::property_index* build_property_index(base* instance, size_t size);
+
+/** return the property index of type T, which is built from the first instance passed in and kept in a function
+	local static such that later calls neither lock nor search. Returns 0 for instances of classes derived from T. */
+template <typename T>
+const cgv::reflect::property_index* ref_property_index(T* instance)
+{
+	if (typeid(*instance) != typeid(T))
+		return 0;
+	static const cgv::reflect::property_index* index = build_property_index(instance, sizeof(T));
+	return index;
+}
+
 #if _MSC_VER > 1400
 CGV_TEMPLATE template class CGV_API cgv::data::ref_ptr<cgv::base::base>;
 CGV_TEMPLATE template class CGV_API std::vector<cgv::data::ref_ptr<cgv::base::base> >;
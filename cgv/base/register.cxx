@@ -723,8 +723,8 @@ bool process_gui_file(const std::string& file_name)
 }
 
 
-test::test(const std::string& _test_name, bool (*_test_func)())
-	: test_name(_test_name), test_func(_test_func)
+test::test(const std::string& _test_name, bool (*_test_func)(), bool _is_benchmark)
+	: test_name(_test_name), test_func(_test_func), is_benchmark(_is_benchmark)
 {
 }
 
@@ -733,6 +733,11 @@ std::string test::get_test_name() const
 	return test_name;
 }
 
+bool test::is_benchmark_test() const
+{
+	return is_benchmark;
+}
+
 bool test::exec_test() const
 {
 	return test_func();
@@ -750,6 +755,11 @@ test_registration::test_registration(const std::string& _test_name, bool (*_test
 	register_object(base_ptr(new test(_test_name,_test_func)),"");
 }
 
+benchmark_registration::benchmark_registration(const std::string& _test_name, bool (*_test_func)())
+{
+	register_object(base_ptr(new test(_test_name,_test_func,true)),"");
+}
+
 
 /// construct 
 factory::factory(const std::string& _created_type_name, bool _singleton, const std::string& _object_options)
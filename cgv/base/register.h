@@ -373,13 +373,17 @@ protected:
 	std::string test_name;
 	/// pointer to test function
 	bool (*test_func)();
+	/// whether the test only measures timings and is run on request
+	bool is_benchmark;
 public:
 	/// constructor for a test structure
-	test(const std::string& _test_name, bool (*_test_func)());
+	test(const std::string& _test_name, bool (*_test_func)(), bool _is_benchmark = false);
 	/// implementation of the type name function of the base class
 	std::string get_type_name() const;
 	/// access to name of test function
 	std::string get_test_name() const;
+	/// return whether this is a benchmark that the tester only runs with the command line argument --benchmarks
+	bool is_benchmark_test() const;
 	/// execute test and return whether this was successful
 	bool exec_test() const;
 };
@@ -404,6 +408,13 @@ struct CGV_API test_registration
 	/// the constructor creates a test structure and registeres the test
 	test_registration(const std::string& _test_name, bool (*_test_func)());
 };
+
+/// declare an instance of benchmark_registration as static variable in order to register a timing test that is skipped in regular test runs
+struct CGV_API benchmark_registration
+{
+	/// the constructor creates a test structure marked as benchmark and registeres it
+	benchmark_registration(const std::string& _test_name, bool (*_test_func)());
+};
 //@}
 
 
@@ -1,4 +1,5 @@
 #include <cgv/data/data_view.h>
+#include <cgv/data/format_conversion.h>
 #include <iostream> 
 #include <memory.h>
 #include <map>
@@ -333,6 +334,12 @@ void const_data_view::set_ptr(const void* ptr)
 	data_ptr = static_cast<const unsigned char*>(ptr);
 }
 
+/// convert the data of src into this view
+bool data_view::convert_from(const const_data_view& src, unsigned nr_threads)
+{
+	return convert_data_view(src, *this, nr_threads);
+}
+
 /// reflect image at horizontal axis
 void data_view::reflect_horizontally()
 {
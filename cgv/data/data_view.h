@@ -197,6 +197,10 @@ public:
 	}
 	/// reflect 2D data view at horizontal axis
 	void reflect_horizontally();
+	/** convert the entries of a source view of same dimension and resolution into the format of this
+	    view with format_converter, distributing rows over nr_threads threads (0 uses all cores).
+	    Returns false if resolutions do not match or the formats cannot be converted. */
+	bool convert_from(const const_data_view& src, unsigned nr_threads = 0);
 };
 
 /** The const_data_view has the functionality of the data_view but 
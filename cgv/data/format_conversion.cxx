@@ -0,0 +1,730 @@
+#include "format_conversion.h"
+#include <cgv/type/info/type_access.h>
+#include <cgv/utils/parallel_tasks.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CGV_DATA_USE_SSE2
+#endif
+
+using namespace cgv::type::info;
+
+namespace cgv {
+	namespace data {
+
+unsigned short float_to_half(float f)
+{
+	unsigned x;
+	std::memcpy(&x, &f, 4);
+	unsigned sign = (x >> 16) & 0x8000;
+	x &= 0x7fffffff;
+	// infinity and nan
+	if (x >= 0x7f800000)
+		return (unsigned short)(sign | 0x7c00 | (x > 0x7f800000 ? 0x200 : 0));
+	// overflow to infinity
+	if (x >= 0x47800000)
+		return (unsigned short)(sign | 0x7c00);
+	// subnormal results are rounded by the floating point addition of a magic number
+	if (x < 0x38800000) {
+		const unsigned magic_bits = ((127 - 15) + (23 - 10) + 1) << 23;
+		float a, magic;
+		std::memcpy(&a, &x, 4);
+		std::memcpy(&magic, &magic_bits, 4);
+		a += magic;
+		unsigned r;
+		std::memcpy(&r, &a, 4);
+		return (unsigned short)(sign | (r - magic_bits));
+	}
+	// rebias exponent and round mantissa to nearest even
+	unsigned mantissa_odd = (x >> 13) & 1;
+	x += 0xc8000fff + mantissa_odd;
+	return (unsigned short)(sign | (x >> 13));
+}
+
+float half_to_float(unsigned short h)
+{
+	unsigned sign = unsigned(h & 0x8000) << 16;
+	unsigned exponent = (h >> 10) & 0x1f;
+	unsigned mantissa = h & 0x3ff;
+	unsigned bits;
+	if (exponent == 0) {
+		float f = mantissa * (1.0f / 16777216.0f);
+		std::memcpy(&bits, &f, 4);
+		bits |= sign;
+	}
+	else if (exponent == 31)
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	else
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	float f;
+	std::memcpy(&f, &bits, 4);
+	return f;
+}
+
+namespace {
+	/// component type traits of the compiled kernels that load into float and store with rounding and clamping
+	struct uint8_kind
+	{
+		typedef unsigned char stored_type;
+		static float load(stored_type v) { return v; }
+		static stored_type store(float v) { return !(v > 0.0f) ? 0 : (v >= 255.0f ? 255 : stored_type(v + 0.5f)); }
+	};
+	struct uint16_kind
+	{
+		typedef unsigned short stored_type;
+		static float load(stored_type v) { return v; }
+		static stored_type store(float v) { return !(v > 0.0f) ? 0 : (v >= 65535.0f ? 65535 : stored_type(v + 0.5f)); }
+	};
+	struct flt16_kind
+	{
+		typedef unsigned short stored_type;
+		static float load(stored_type v) { return half_to_float(v); }
+		static stored_type store(float v) { return float_to_half(v); }
+	};
+	struct flt32_kind
+	{
+		typedef float stored_type;
+		static float load(stored_type v) { return v; }
+		static stored_type store(float v) { return v; }
+	};
+	enum Kind { K_UINT8, K_UINT16, K_FLT16, K_FLT32, K_NONE };
+
+	/// check whether components are stored without padding
+	bool is_dense(const component_format& cf)
+	{
+		if (cf.is_packing())
+			return false;
+		unsigned s = get_type_size(cf.get_component_type());
+		return s > 0 && packing_info::align(s, cf.get_component_alignment()) == s;
+	}
+	Kind get_kind(const component_format& cf)
+	{
+		if (!is_dense(cf))
+			return K_NONE;
+		switch (cf.get_component_type()) {
+		case TI_UINT8: return K_UINT8;
+		case TI_UINT16: return K_UINT16;
+		case TI_FLT16: return K_FLT16;
+		case TI_FLT32: return K_FLT32;
+		default: return K_NONE;
+		}
+	}
+	bool is_signed_type(TypeId t)
+	{
+		return t >= TI_INT8 && t <= TI_INT64;
+	}
+	/// return factor that maps stored values of component ci to normalized values
+	double get_norm(const component_format& cf, unsigned ci)
+	{
+		TypeId t = cf.get_component_type();
+		if (cf.get_integer_interpretation() == CII_INTEGER || t == TI_BOOL || t == TI_FLT16 || t == TI_FLT32 || t == TI_FLT64)
+			return 1.0;
+		unsigned nr_bits = cf.is_packing() ? cf.get_bit_depth(ci) : 8 * get_type_size(t);
+		if (is_signed_type(t))
+			--nr_bits;
+		return 1.0 / (double((unsigned long long)1 << nr_bits) - 1.0);
+	}
+	/// return the range of stored values of the component type
+	void get_range(const component_format& cf, unsigned ci, double& lo, double& hi)
+	{
+		TypeId t = cf.get_component_type();
+		if (cf.is_packing()) {
+			unsigned bd = cf.get_bit_depth(ci);
+			if (is_signed_type(t)) {
+				hi = double((unsigned long long)1 << (bd - 1)) - 1;
+				lo = -hi - 1;
+			}
+			else {
+				lo = 0;
+				hi = double((unsigned long long)1 << bd) - 1;
+			}
+			return;
+		}
+		switch (t) {
+		case TI_BOOL: lo = 0; hi = 1; break;
+		case TI_INT8: lo = -128.0; hi = 127.0; break;
+		case TI_INT16: lo = -32768.0; hi = 32767.0; break;
+		case TI_INT32: lo = -2147483648.0; hi = 2147483647.0; break;
+		case TI_INT64: lo = -9223372036854775808.0; hi = 9223372036854774784.0; break;
+		case TI_UINT8: lo = 0; hi = 255.0; break;
+		case TI_UINT16: lo = 0; hi = 65535.0; break;
+		case TI_UINT32: lo = 0; hi = 4294967295.0; break;
+		case TI_UINT64: lo = 0; hi = 18446744073709549568.0; break;
+		default: lo = -1e300; hi = 1e300; break;
+		}
+	}
+	bool is_supported_type(TypeId t)
+	{
+		return t >= TI_BOOL && t <= TI_FLT64;
+	}
+	/// compute bit shifts and masks of packed components, return false if the entry does not fit into 32 bits
+	bool compute_packing(const component_format& cf, std::vector<unsigned>& shifts, std::vector<unsigned>& masks)
+	{
+		unsigned off = 0;
+		for (unsigned ci = 0; ci < cf.get_nr_components(); ++ci) {
+			unsigned bd = cf.get_bit_depth(ci);
+			if (bd == 0 || bd > 31)
+				return false;
+			shifts.push_back(off);
+			masks.push_back((1u << bd) - 1);
+			off += packing_info::align(bd, cf.get_component_alignment());
+		}
+		return off <= 32;
+	}
+}
+
+/// kernels converting rows of entries, which are selected by the format_converter
+struct format_conversion_kernels
+{
+	static void copy(const format_converter& fc, const unsigned char* src, unsigned char* dst, size_t n)
+	{
+		std::memcpy(dst, src, n * fc.src_entry_size);
+	}
+	/// reorder 8 bit components with a compile time map, where negative map entries denote fill values
+	template <int NS, int ND, int M0, int M1, int M2, int M3>
+	static void swizzle8(const format_converter& fc, const unsigned char* src, unsigned char* dst, size_t n)
+	{
+		const int M[4] = { M0, M1, M2, M3 };
+		unsigned char fill[4];
+		for (int c = 0; c < 4; ++c)
+			fill[c] = c < ND ? (unsigned char)fc.fill_bits[c] : 0;
+		for (size_t i = 0; i < n; ++i, src += NS, dst += ND)
+			for (int c = 0; c < ND; ++c)
+				dst[c] = M[c] < 0 ? fill[c] : src[M[c]];
+	}
+	/// reorder components of the same type
+	template <typename T, int NS, int ND>
+	static void shuffle(const format_converter& fc, const unsigned char* _src, unsigned char* _dst, size_t n)
+	{
+		const T* src = reinterpret_cast<const T*>(_src);
+		T* dst = reinterpret_cast<T*>(_dst);
+		int M[ND];
+		T fill[ND];
+		for (int c = 0; c < ND; ++c) {
+			M[c] = fc.component_map[c];
+			std::memcpy(&fill[c], &fc.fill_bits[c], sizeof(T));
+		}
+		for (size_t i = 0; i < n; ++i, src += NS, dst += ND)
+			for (int c = 0; c < ND; ++c)
+				dst[c] = M[c] < 0 ? fill[c] : src[M[c]];
+	}
+	/// convert components between types
+	template <typename S, typename D, int NS, int ND>
+	static void convert(const format_converter& fc, const unsigned char* _src, unsigned char* _dst, size_t n)
+	{
+		const typename S::stored_type* src = reinterpret_cast<const typename S::stored_type*>(_src);
+		typename D::stored_type* dst = reinterpret_cast<typename D::stored_type*>(_dst);
+		int M[ND];
+		float F[ND];
+		typename D::stored_type fill[ND];
+		for (int c = 0; c < ND; ++c) {
+			M[c] = fc.component_map[c];
+			F[c] = fc.factors[c];
+			std::memcpy(&fill[c], &fc.fill_bits[c], sizeof(fill[c]));
+		}
+		for (size_t i = 0; i < n; ++i, src += NS, dst += ND)
+			for (int c = 0; c < ND; ++c)
+				dst[c] = M[c] < 0 ? fill[c] : D::store(S::load(src[M[c]]) * F[c]);
+	}
+	/// unpack components from packed entries of type E
+	template <typename E, typename D, int ND>
+	static void unpack(const format_converter& fc, const unsigned char* _src, unsigned char* _dst, size_t n)
+	{
+		const E* src = reinterpret_cast<const E*>(_src);
+		typename D::stored_type* dst = reinterpret_cast<typename D::stored_type*>(_dst);
+		unsigned shift[ND], mask[ND];
+		float F[ND];
+		bool use_fill[ND];
+		typename D::stored_type fill[ND];
+		for (int c = 0; c < ND; ++c) {
+			int m = fc.component_map[c];
+			use_fill[c] = m < 0;
+			shift[c] = m < 0 ? 0 : fc.src_shifts[m];
+			mask[c] = m < 0 ? 0 : fc.src_masks[m];
+			F[c] = fc.factors[c];
+			std::memcpy(&fill[c], &fc.fill_bits[c], sizeof(fill[c]));
+		}
+		for (size_t i = 0; i < n; ++i, dst += ND) {
+			E e;
+			std::memcpy(&e, src + i, sizeof(E));
+			for (int c = 0; c < ND; ++c)
+				dst[c] = use_fill[c] ? fill[c] : D::store(float((unsigned(e) >> shift[c]) & mask[c]) * F[c]);
+		}
+	}
+	/// pack components into packed entries of type E
+	template <typename S, int NS, typename E>
+	static void pack(const format_converter& fc, const unsigned char* _src, unsigned char* _dst, size_t n)
+	{
+		const typename S::stored_type* src = reinterpret_cast<const typename S::stored_type*>(_src);
+		E* dst = reinterpret_cast<E*>(_dst);
+		unsigned nd = (unsigned)fc.component_map.size();
+		int M[4];
+		unsigned shift[4], fill[4];
+		float F[4], hi[4];
+		for (unsigned c = 0; c < 4; ++c) {
+			M[c] = c < nd ? fc.component_map[c] : -1;
+			shift[c] = c < nd ? fc.dst_shifts[c] : 0;
+			hi[c] = c < nd ? float(fc.dst_masks[c]) : 0.0f;
+			fill[c] = c < nd ? unsigned(fc.fill_bits[c]) : 0;
+			F[c] = c < nd ? fc.factors[c] : 0.0f;
+		}
+		for (size_t i = 0; i < n; ++i, src += NS) {
+			unsigned e = 0;
+			for (unsigned c = 0; c < 4; ++c) {
+				unsigned v = fill[c];
+				if (M[c] >= 0) {
+					float f = S::load(src[M[c]]) * F[c];
+					v = !(f > 0.0f) ? 0 : (f >= hi[c] ? unsigned(hi[c]) : unsigned(f + 0.5f));
+				}
+				e |= v << shift[c];
+			}
+			E packed = E(e);
+			std::memcpy(dst + i, &packed, sizeof(E));
+		}
+	}
+#ifdef CGV_DATA_USE_SSE2
+	/// convert 16 bit unsigned integer components into floats with SSE2, which is the typical case of depth images
+	static void uint16_to_float_sse2(const format_converter& fc, const unsigned char* _src, unsigned char* _dst, size_t n)
+	{
+		const unsigned short* src = reinterpret_cast<const unsigned short*>(_src);
+		float* dst = reinterpret_cast<float*>(_dst);
+		size_t m = n * fc.component_map.size();
+		float f = fc.factors[0];
+		__m128 F = _mm_set1_ps(f);
+		__m128i zero = _mm_setzero_si128();
+		size_t i = 0;
+		for (; i + 8 <= m; i += 8) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)), F));
+			_mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)), F));
+		}
+		for (; i < m; ++i)
+			dst[i] = src[i] * f;
+	}
+	/// convert 8 bit unsigned integer components into floats with SSE2
+	static void uint8_to_float_sse2(const format_converter& fc, const unsigned char* src, unsigned char* _dst, size_t n)
+	{
+		float* dst = reinterpret_cast<float*>(_dst);
+		size_t m = n * fc.component_map.size();
+		float f = fc.factors[0];
+		__m128 F = _mm_set1_ps(f);
+		__m128i zero = _mm_setzero_si128();
+		size_t i = 0;
+		for (; i + 16 <= m; i += 16) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			__m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+			_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), F));
+			_mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), F));
+			_mm_storeu_ps(dst + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), F));
+			_mm_storeu_ps(dst + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), F));
+		}
+		for (; i < m; ++i)
+			dst[i] = src[i] * f;
+	}
+	/// convert float to rounded integer after clamping to [0,255.5], such that out of range values and NaN do not wrap in the conversion
+	static inline __m128i round_to_uint8_range_sse2(__m128 x, __m128 F, __m128 H, __m128 M)
+	{
+		return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(x, F), H), _mm_setzero_ps()), M));
+	}
+	/// convert floats into 8 bit unsigned integer components with SSE2
+	static void float_to_uint8_sse2(const format_converter& fc, const unsigned char* _src, unsigned char* dst, size_t n)
+	{
+		const float* src = reinterpret_cast<const float*>(_src);
+		size_t m = n * fc.component_map.size();
+		float f = fc.factors[0];
+		__m128 F = _mm_set1_ps(f), H = _mm_set1_ps(0.5f), M = _mm_set1_ps(255.5f);
+		size_t i = 0;
+		for (; i + 16 <= m; i += 16) {
+			__m128i a = round_to_uint8_range_sse2(_mm_loadu_ps(src + i), F, H, M);
+			__m128i b = round_to_uint8_range_sse2(_mm_loadu_ps(src + i + 4), F, H, M);
+			__m128i c = round_to_uint8_range_sse2(_mm_loadu_ps(src + i + 8), F, H, M);
+			__m128i d = round_to_uint8_range_sse2(_mm_loadu_ps(src + i + 12), F, H, M);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+		}
+		for (; i < m; ++i)
+			dst[i] = uint8_kind::store(src[i] * f);
+	}
+#endif
+	/// read the ci-th component of an entry as stored value
+	static double read(const format_converter& fc, const component_format& cf, bool src, unsigned ci, const unsigned char* ptr)
+	{
+		TypeId t = cf.get_component_type();
+		if (cf.is_packing()) {
+			unsigned e = 0;
+			std::memcpy(&e, ptr, src ? fc.src_entry_size : fc.dst_entry_size);
+			unsigned shift = src ? fc.src_shifts[ci] : fc.dst_shifts[ci];
+			unsigned mask = src ? fc.src_masks[ci] : fc.dst_masks[ci];
+			unsigned v = (e >> shift) & mask;
+			// sign extension
+			if (is_signed_type(t) && v > (mask >> 1))
+				return double(v) - double(mask) - 1.0;
+			return double(v);
+		}
+		const unsigned char* p = ptr + ci * packing_info::align(get_type_size(t), cf.get_component_alignment());
+		if (t == TI_FLT16) {
+			unsigned short h;
+			std::memcpy(&h, p, 2);
+			return half_to_float(h);
+		}
+		return type_access<double>::get(p, t);
+	}
+	/// convert entries with component_format based access, which supports all formats
+	static void generic(const format_converter& fc, const unsigned char* src, unsigned char* dst, size_t n)
+	{
+		const component_format& sf = fc.src_format;
+		const component_format& df = fc.dst_format;
+		unsigned nd = df.get_nr_components();
+		TypeId dt = df.get_component_type();
+		unsigned comp_step = df.is_packing() ? 0 : packing_info::align(get_type_size(dt), df.get_component_alignment());
+		bool round = dt != TI_FLT16 && dt != TI_FLT32 && dt != TI_FLT64;
+		std::vector<double> lo(nd), hi(nd);
+		for (unsigned c = 0; c < nd; ++c)
+			get_range(df, c, lo[c], hi[c]);
+		for (size_t i = 0; i < n; ++i, src += fc.src_entry_size, dst += fc.dst_entry_size) {
+			unsigned packed = 0;
+			for (unsigned c = 0; c < nd; ++c) {
+				int m = fc.component_map[c];
+				double v;
+				if (m >= 0)
+					v = read(fc, sf, true, m, src) * fc.src_norms[m];
+				else if (m == -1)
+					v = fc.fill_values[c];
+				else
+					v = 0.299 * read(fc, sf, true, fc.rgb_components[0], src) * fc.src_norms[fc.rgb_components[0]] +
+					    0.587 * read(fc, sf, true, fc.rgb_components[1], src) * fc.src_norms[fc.rgb_components[1]] +
+					    0.114 * read(fc, sf, true, fc.rgb_components[2], src) * fc.src_norms[fc.rgb_components[2]];
+				v /= fc.dst_norms[c];
+				if (round) {
+					v = std::floor(v + 0.5);
+					if (!(v > lo[c]))
+						v = lo[c];
+					else if (v > hi[c])
+						v = hi[c];
+				}
+				if (df.is_packing())
+					packed |= (unsigned(int(v)) & fc.dst_masks[c]) << fc.dst_shifts[c];
+				else if (dt == TI_FLT16) {
+					unsigned short h = float_to_half(float(v));
+					std::memcpy(dst + c * comp_step, &h, 2);
+				}
+				else
+					type_access<double>::set(dst + c * comp_step, dt, v);
+			}
+			if (df.is_packing())
+				std::memcpy(dst, &packed, fc.dst_entry_size);
+		}
+	}
+
+	/// select instantiation of typed conversion for given component counts
+	template <typename S, typename D, int NS>
+	static format_converter::kernel_type select_convert(int nd)
+	{
+		switch (nd) {
+		case 1: return &convert<S, D, NS, 1>;
+		case 2: return &convert<S, D, NS, 2>;
+		case 3: return &convert<S, D, NS, 3>;
+		case 4: return &convert<S, D, NS, 4>;
+		}
+		return 0;
+	}
+	template <typename S, typename D>
+	static format_converter::kernel_type select_convert(int ns, int nd)
+	{
+		switch (ns) {
+		case 1: return select_convert<S, D, 1>(nd);
+		case 2: return select_convert<S, D, 2>(nd);
+		case 3: return select_convert<S, D, 3>(nd);
+		case 4: return select_convert<S, D, 4>(nd);
+		}
+		return 0;
+	}
+	template <typename S>
+	static format_converter::kernel_type select_convert(Kind dk, int ns, int nd)
+	{
+		switch (dk) {
+		case K_UINT8: return select_convert<S, uint8_kind>(ns, nd);
+		case K_UINT16: return select_convert<S, uint16_kind>(ns, nd);
+		case K_FLT16: return select_convert<S, flt16_kind>(ns, nd);
+		case K_FLT32: return select_convert<S, flt32_kind>(ns, nd);
+		default: return 0;
+		}
+	}
+	static format_converter::kernel_type select_convert(Kind sk, Kind dk, int ns, int nd)
+	{
+		switch (sk) {
+		case K_UINT8: return select_convert<uint8_kind>(dk, ns, nd);
+		case K_UINT16: return select_convert<uint16_kind>(dk, ns, nd);
+		case K_FLT16: return select_convert<flt16_kind>(dk, ns, nd);
+		case K_FLT32: return select_convert<flt32_kind>(dk, ns, nd);
+		default: return 0;
+		}
+	}
+	template <typename T, int NS>
+	static format_converter::kernel_type select_shuffle(int nd)
+	{
+		switch (nd) {
+		case 1: return &shuffle<T, NS, 1>;
+		case 2: return &shuffle<T, NS, 2>;
+		case 3: return &shuffle<T, NS, 3>;
+		case 4: return &shuffle<T, NS, 4>;
+		}
+		return 0;
+	}
+	template <typename T>
+	static format_converter::kernel_type select_shuffle(int ns, int nd)
+	{
+		switch (ns) {
+		case 1: return select_shuffle<T, 1>(nd);
+		case 2: return select_shuffle<T, 2>(nd);
+		case 3: return select_shuffle<T, 3>(nd);
+		case 4: return select_shuffle<T, 4>(nd);
+		}
+		return 0;
+	}
+	static format_converter::kernel_type select_shuffle(unsigned size, int ns, int nd)
+	{
+		switch (size) {
+		case 1: return select_shuffle<unsigned char>(ns, nd);
+		case 2: return select_shuffle<unsigned short>(ns, nd);
+		case 4: return select_shuffle<unsigned>(ns, nd);
+		case 8: return select_shuffle<unsigned long long>(ns, nd);
+		}
+		return 0;
+	}
+	/// return swizzle kernel for the common reorderings of 8 bit color formats
+	static format_converter::kernel_type select_swizzle8(int ns, const std::vector<int>& M)
+	{
+		int nd = int(M.size());
+		int m[4] = { 0, 0, 0, 0 };
+		for (int c = 0; c < nd; ++c)
+			m[c] = M[c];
+#define CGV_SWIZZLE(NS,ND,M0,M1,M2,M3) if (ns == NS && nd == ND && m[0] == M0 && m[1] == M1 && m[2] == M2 && m[3] == M3) return &swizzle8<NS,ND,M0,M1,M2,M3>;
+		CGV_SWIZZLE(3, 4, 0, 1, 2, -1) // rgb -> rgba
+		CGV_SWIZZLE(4, 3, 0, 1, 2, 0)  // rgba -> rgb
+		CGV_SWIZZLE(3, 3, 2, 1, 0, 0)  // bgr <-> rgb
+		CGV_SWIZZLE(4, 4, 2, 1, 0, 3)  // bgra <-> rgba
+		CGV_SWIZZLE(3, 4, 2, 1, 0, -1) // bgr -> rgba
+		CGV_SWIZZLE(4, 3, 2, 1, 0, 0)  // bgra -> rgb
+		CGV_SWIZZLE(1, 3, 0, 0, 0, 0)  // l -> rgb
+		CGV_SWIZZLE(1, 4, 0, 0, 0, -1) // l -> rgba
+#undef CGV_SWIZZLE
+		return 0;
+	}
+	template <typename E>
+	static format_converter::kernel_type select_unpack(Kind dk, int nd)
+	{
+		switch (dk) {
+		case K_UINT8:
+			switch (nd) { case 1: return &unpack<E, uint8_kind, 1>; case 2: return &unpack<E, uint8_kind, 2>; case 3: return &unpack<E, uint8_kind, 3>; case 4: return &unpack<E, uint8_kind, 4>; }
+			break;
+		case K_UINT16:
+			switch (nd) { case 1: return &unpack<E, uint16_kind, 1>; case 2: return &unpack<E, uint16_kind, 2>; case 3: return &unpack<E, uint16_kind, 3>; case 4: return &unpack<E, uint16_kind, 4>; }
+			break;
+		case K_FLT32:
+			switch (nd) { case 1: return &unpack<E, flt32_kind, 1>; case 2: return &unpack<E, flt32_kind, 2>; case 3: return &unpack<E, flt32_kind, 3>; case 4: return &unpack<E, flt32_kind, 4>; }
+			break;
+		default:
+			break;
+		}
+		return 0;
+	}
+	template <typename E>
+	static format_converter::kernel_type select_pack(Kind sk, int ns)
+	{
+		switch (sk) {
+		case K_UINT8:
+			switch (ns) { case 1: return &pack<uint8_kind, 1, E>; case 2: return &pack<uint8_kind, 2, E>; case 3: return &pack<uint8_kind, 3, E>; case 4: return &pack<uint8_kind, 4, E>; }
+			break;
+		case K_UINT16:
+			switch (ns) { case 1: return &pack<uint16_kind, 1, E>; case 2: return &pack<uint16_kind, 2, E>; case 3: return &pack<uint16_kind, 3, E>; case 4: return &pack<uint16_kind, 4, E>; }
+			break;
+		case K_FLT32:
+			switch (ns) { case 1: return &pack<flt32_kind, 1, E>; case 2: return &pack<flt32_kind, 2, E>; case 3: return &pack<flt32_kind, 3, E>; case 4: return &pack<flt32_kind, 4, E>; }
+			break;
+		default:
+			break;
+		}
+		return 0;
+	}
+};
+
+format_converter::format_converter(const component_format& src, const component_format& dst)
+	: src_format(src), dst_format(dst), kernel(0), specialized(false)
+{
+	src_entry_size = src_format.get_entry_size();
+	dst_entry_size = dst_format.get_entry_size();
+	rgb_components[0] = rgb_components[1] = rgb_components[2] = -1;
+	select_kernel();
+}
+
+void format_converter::select_kernel()
+{
+	unsigned ns = src_format.get_nr_components(), nd = dst_format.get_nr_components();
+	if (ns == 0 || nd == 0 || !is_supported_type(src_format.get_component_type()) || !is_supported_type(dst_format.get_component_type()))
+		return;
+	if (src_format.is_packing() && !compute_packing(src_format, src_shifts, src_masks))
+		return;
+	if (dst_format.is_packing() && !compute_packing(dst_format, dst_shifts, dst_masks))
+		return;
+	for (unsigned ci = 0; ci < ns; ++ci)
+		src_norms.push_back(get_norm(src_format, ci));
+	for (unsigned ci = 0; ci < nd; ++ci)
+		dst_norms.push_back(get_norm(dst_format, ci));
+
+	// match destination components by name
+	unsigned L = src_format.get_component_index("L"), I = src_format.get_component_index("I");
+	unsigned R = src_format.get_component_index("R"), G = src_format.get_component_index("G"), B = src_format.get_component_index("B");
+	unsigned gray = L != (unsigned)-1 ? L : I;
+	bool has_rgb = R != (unsigned)-1 && G != (unsigned)-1 && B != (unsigned)-1;
+	bool needs_luminance = false;
+	for (unsigned c = 0; c < nd; ++c) {
+		std::string name = dst_format.get_component_name(c);
+		unsigned ci = src_format.get_component_index(name);
+		int m = -1;
+		if (ci != (unsigned)-1)
+			m = int(ci);
+		else if (ns == 1 && nd == 1)
+			m = 0;
+		else if ((name == "R" || name == "G" || name == "B") && gray != (unsigned)-1)
+			m = int(gray);
+		else if ((name == "L" || name == "I") && gray != (unsigned)-1)
+			m = int(gray);
+		else if ((name == "L" || name == "I") && has_rgb) {
+			m = -2;
+			needs_luminance = true;
+			rgb_components[0] = R;
+			rgb_components[1] = G;
+			rgb_components[2] = B;
+		}
+		component_map.push_back(m);
+		factors.push_back(m >= 0 ? float(src_norms[m] / dst_norms[c]) : float(src_norms[R == (unsigned)-1 ? 0 : R] / dst_norms[c]));
+		fill_values.push_back(name == "A" ? 1.0 : 0.0);
+		// fill value in the representation of the destination
+		double v = fill_values.back() / dst_norms[c];
+		unsigned long long bits = 0;
+		TypeId dt = dst_format.get_component_type();
+		if (dst_format.is_packing())
+			bits = (unsigned long long)v;
+		else if (dt == TI_FLT16) {
+			unsigned short h = float_to_half(float(v));
+			std::memcpy(&bits, &h, 2);
+		}
+		else
+			type_access<double>::set(&bits, dt, v);
+		fill_bits.push_back(bits);
+	}
+	kernel = &format_conversion_kernels::generic;
+	if (needs_luminance || ns > 4 || nd > 4)
+		return;
+
+	Kind sk = get_kind(src_format), dk = get_kind(dst_format);
+	bool unit_factors = true, identity = ns == nd;
+	for (unsigned c = 0; c < nd; ++c) {
+		if (factors[c] != 1.0f)
+			unit_factors = false;
+		if (component_map[c] != int(c))
+			identity = false;
+	}
+	kernel_type k = 0;
+	if (is_dense(src_format) && is_dense(dst_format) && src_format.get_component_type() == dst_format.get_component_type() && unit_factors) {
+		if (identity)
+			k = &format_conversion_kernels::copy;
+		else if (get_type_size(src_format.get_component_type()) == 1)
+			k = format_conversion_kernels::select_swizzle8(ns, component_map);
+		if (!k)
+			k = format_conversion_kernels::select_shuffle(get_type_size(src_format.get_component_type()), ns, nd);
+	}
+#ifdef CGV_DATA_USE_SSE2
+	else if (identity && sk == K_UINT16 && dk == K_FLT32)
+		k = &format_conversion_kernels::uint16_to_float_sse2;
+	else if (identity && sk == K_UINT8 && dk == K_FLT32)
+		k = &format_conversion_kernels::uint8_to_float_sse2;
+	else if (identity && sk == K_FLT32 && dk == K_UINT8)
+		k = &format_conversion_kernels::float_to_uint8_sse2;
+#endif
+	else if (sk != K_NONE && dk != K_NONE)
+		k = format_conversion_kernels::select_convert(sk, dk, ns, nd);
+	else if (src_format.is_packing() && !is_signed_type(src_format.get_component_type()) && dk != K_NONE) {
+		switch (src_entry_size) {
+		case 1: k = format_conversion_kernels::select_unpack<unsigned char>(dk, nd); break;
+		case 2: k = format_conversion_kernels::select_unpack<unsigned short>(dk, nd); break;
+		case 4: k = format_conversion_kernels::select_unpack<unsigned>(dk, nd); break;
+		}
+	}
+	else if (dst_format.is_packing() && !is_signed_type(dst_format.get_component_type()) && sk != K_NONE) {
+		switch (dst_entry_size) {
+		case 1: k = format_conversion_kernels::select_pack<unsigned char>(sk, ns); break;
+		case 2: k = format_conversion_kernels::select_pack<unsigned short>(sk, ns); break;
+		case 4: k = format_conversion_kernels::select_pack<unsigned>(sk, ns); break;
+		}
+	}
+	if (k) {
+		kernel = k;
+		specialized = true;
+	}
+}
+
+void format_converter::convert(const void* src, void* dst, size_t n) const
+{
+	kernel(*this, static_cast<const unsigned char*>(src), static_cast<unsigned char*>(dst), n);
+}
+
+void format_converter::convert(const void* src, size_t src_step, void* dst, size_t dst_step, size_t n) const
+{
+	if (src_step == src_entry_size && dst_step == dst_entry_size) {
+		convert(src, dst, n);
+		return;
+	}
+	const unsigned char* s = static_cast<const unsigned char*>(src);
+	unsigned char* d = static_cast<unsigned char*>(dst);
+	for (size_t i = 0; i < n; ++i, s += src_step, d += dst_step)
+		kernel(*this, s, d, 1);
+}
+
+bool convert_data_view(const const_data_view& src, const data_view& dst, unsigned nr_threads)
+{
+	if (src.empty() || dst.empty() || src.get_dim() != dst.get_dim())
+		return false;
+	format_converter fc(*src.get_format(), *dst.get_format());
+	if (!fc.is_valid())
+		return false;
+	unsigned dim = src.get_dim();
+	if (dim == 0) {
+		fc.convert(src.get_ptr<unsigned char>(), dst.get_ptr<unsigned char>(), 1);
+		return true;
+	}
+	// the i-th view dimension corresponds to dimension dim-1-i of the data format
+	size_t res[4];
+	size_t nr_rows = 1;
+	for (unsigned i = 0; i < dim; ++i) {
+		res[i] = src.get_format()->get_resolution(dim - 1 - i);
+		if (res[i] != dst.get_format()->get_resolution(dim - 1 - i))
+			return false;
+		if (i + 1 < dim)
+			nr_rows *= res[i];
+	}
+	size_t n = res[dim - 1];
+	const unsigned char* src_ptr = src.get_ptr<unsigned char>();
+	unsigned char* dst_ptr = dst.get_ptr<unsigned char>();
+	const size_t rows_per_task = std::max(size_t(1), size_t(16384) / std::max(n, size_t(1)));
+	cgv::utils::parallel_tasks((nr_rows + rows_per_task - 1) / rows_per_task, nr_threads, [&](size_t t) {
+		size_t r1 = std::min(nr_rows, (t + 1) * rows_per_task);
+		for (size_t r = t * rows_per_task; r < r1; ++r) {
+			size_t src_off = 0, dst_off = 0, idx = r;
+			for (int i = int(dim) - 2; i >= 0; --i) {
+				size_t j = idx % res[i];
+				idx /= res[i];
+				src_off += j * src.get_step_size(i);
+				dst_off += j * dst.get_step_size(i);
+			}
+			fc.convert(src_ptr + src_off, src.get_step_size(dim - 1), dst_ptr + dst_off, dst.get_step_size(dim - 1), n);
+		}
+	}, nr_rows * n);
+	return true;
+}
+
+	}
+}
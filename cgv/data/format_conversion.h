@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cgv/data/component_format.h>
+#include <cgv/data/data_view.h>
+#include <vector>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace data {
+
+/// half precision float conversion with rounding to nearest even
+extern CGV_API unsigned short float_to_half(float f);
+/// convert half precision float to single precision
+extern CGV_API float half_to_float(unsigned short h);
+
+struct format_conversion_kernels;
+
+/** converts data entries from a source to a destination component format. On construction the
+    destination components are matched by name to the source components and a row conversion
+	kernel is selected, which is instantiated at compile time for the common pairs of component
+	types and component counts, such that no dispatch happens per component. Formats without a
+	compiled kernel are converted by a generic kernel based on component_format::get and set.
+
+	Values are transferred in the interpretation of the integer components:
+	- integers in default or snorm interpretation and packed components are normalized to [0,1]
+	  for unsigned and [-1,1] for signed types, such that uint8 255 becomes 1.0f or uint16 65535
+	  and a float 1.0f becomes uint8 255, where floats outside of the range are clamped
+	- integers in integer interpretation, i.e. "_uint16[D]", keep their values
+	- destination components missing in the source become 0, except of alpha, which becomes 1
+	- R, G and B are replicated from L or I and L and I are computed from R, G and B as luminance
+*/
+class CGV_API format_converter
+{
+public:
+	/// signature of kernels converting n densely stored entries
+	typedef void (*kernel_type)(const format_converter& fc, const unsigned char* src, unsigned char* dst, size_t n);
+protected:
+	friend struct format_conversion_kernels;
+	component_format src_format, dst_format;
+	unsigned src_entry_size, dst_entry_size;
+	kernel_type kernel;
+	bool specialized;
+	/// per destination component the source component index, -1 for a fill value or -2 for luminance
+	std::vector<int> component_map;
+	/// per component factors mapping stored to normalized values
+	std::vector<double> src_norms, dst_norms;
+	/// per destination component the factor converting source into destination values
+	std::vector<float> factors;
+	/// per destination component the normalized fill value and its bit pattern in the destination type
+	std::vector<double> fill_values;
+	std::vector<unsigned long long> fill_bits;
+	/// bit shifts and masks of packed source and destination components
+	std::vector<unsigned> src_shifts, src_masks, dst_shifts, dst_masks;
+	/// indices of the R, G and B source components from which luminance is computed
+	int rgb_components[3];
+	/// choose kernel for the formats
+	void select_kernel();
+public:
+	/// construct converter between given formats
+	format_converter(const component_format& src, const component_format& dst);
+	/// return whether conversion is supported
+	bool is_valid() const { return kernel != 0; }
+	/// return whether a compiled kernel is used instead of the generic one
+	bool is_specialized() const { return specialized; }
+	/// return the source format
+	const component_format& get_source_format() const { return src_format; }
+	/// return the destination format
+	const component_format& get_destination_format() const { return dst_format; }
+	/// convert n densely stored entries
+	void convert(const void* src, void* dst, size_t n) const;
+	/// convert n entries with the given distances in bytes between successive entries
+	void convert(const void* src, size_t src_step, void* dst, size_t dst_step, size_t n) const;
+};
+
+/** convert all entries of the source view into the format of the destination view. Both views
+    need to have the same dimension and resolution. Rows are distributed over nr_threads threads,
+	where 0 uses the hardware concurrency. Returns false if the views do not match or the formats
+	cannot be converted. */
+extern CGV_API bool convert_data_view(const const_data_view& src, const data_view& dst, unsigned nr_threads = 0);
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
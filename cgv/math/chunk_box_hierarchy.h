@@ -0,0 +1,301 @@
+#pragma once
+
+#include <cgv/math/fmat.h>
+#include <cgv/utils/parallel_tasks.h>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+namespace cgv{
+	namespace math{
+
+/** hierarchy of axis aligned bounding boxes over chunks of consecutive elements of an attribute array that supports
+	view frustum culling of large arrays of points, spheres, boxes or other primitives with a bounded extent. Level 0
+	holds one box per chunk of chunk_size elements, which is enlarged by a uniform radius and optionally by a per element
+	radius. Each further level merges fan_out boxes of the previous level until a single box remains. Changes to the
+	attribute array are reported with invalidate() and the affected chunks and their ancestors are recomputed in the next
+	call to update(). cull() tests the boxes against a set of planes and returns the visible elements as sorted list of
+	maximal index ranges. Chunks intersecting a plane are reported as visible, such that culling is conservative. */
+template <typename T = float>
+class chunk_box_hierarchy
+{
+public:
+	/// type of positions
+	typedef fvec<T, 3> vec_type;
+	/// type of planes (nx,ny,nz,d), where points with dot(n,p)+d >= 0 are on the inside
+	typedef fvec<T, 4> plane_type;
+	/// range of consecutive elements
+	struct index_range
+	{
+		/// index of first element
+		size_t start;
+		/// number of elements
+		size_t count;
+	};
+	/// boxes of one level
+	struct level
+	{
+		/// minimum corner per box
+		std::vector<vec_type> box_min;
+		/// maximum corner per box
+		std::vector<vec_type> box_max;
+		/// return number of boxes
+		size_t get_nr_boxes() const { return box_min.size(); }
+	};
+protected:
+	/// number of elements per chunk
+	size_t chunk_size;
+	/// number of boxes merged into a box of the next level
+	unsigned fan_out;
+	/// number of elements
+	size_t nr_elements;
+	/// radius added to all elements
+	T radius;
+	/// levels from finest to coarsest
+	std::vector<level> levels;
+	/// number of chunks covered by a box per level
+	std::vector<size_t> spans;
+	/// per chunk whether it needs to be recomputed
+	std::vector<unsigned char> dirty;
+	/// indices of chunks that need to be recomputed
+	std::vector<size_t> dirty_chunks;
+	/// compute box of chunk ci from the positions and optional radii
+	void compute_chunk_box(size_t ci, const vec_type* positions, const T* radii)
+	{
+		vec_type& mn = levels[0].box_min[ci];
+		vec_type& mx = levels[0].box_max[ci];
+		mn = vec_type(std::numeric_limits<T>::max());
+		mx = vec_type(std::numeric_limits<T>::lowest());
+		size_t end = std::min(nr_elements, (ci + 1)*chunk_size);
+		for (size_t i = ci*chunk_size; i < end; ++i) {
+			T r = radii ? radius + radii[i] : radius;
+			for (unsigned j = 0; j < 3; ++j) {
+				mn[j] = std::min(mn[j], positions[i][j] - r);
+				mx[j] = std::max(mx[j], positions[i][j] + r);
+			}
+		}
+	}
+	/// compute box bi of level li > 0 from its children
+	void compute_parent_box(unsigned li, size_t bi)
+	{
+		const level& f = levels[li - 1];
+		vec_type& mn = levels[li].box_min[bi];
+		vec_type& mx = levels[li].box_max[bi];
+		mn = f.box_min[bi*fan_out];
+		mx = f.box_max[bi*fan_out];
+		size_t end = std::min(f.get_nr_boxes(), (bi + 1)*fan_out);
+		for (size_t ci = bi*fan_out + 1; ci < end; ++ci)
+			for (unsigned j = 0; j < 3; ++j) {
+				mn[j] = std::min(mn[j], f.box_min[ci][j]);
+				mx[j] = std::max(mx[j], f.box_max[ci][j]);
+			}
+	}
+	/// return number of threads used for n work items, where few items are processed on the calling thread
+	static unsigned get_nr_threads(unsigned nr_threads, size_t n, size_t min_items_per_thread)
+	{
+		nr_threads = cgv::utils::get_nr_parallel_tasks_threads(nr_threads);
+		return unsigned(std::max(size_t(1), std::min(size_t(nr_threads), n / min_items_per_thread)));
+	}
+	/// call f(i) for i in [0,n) with the given number of threads, where blocks of indices are distributed dynamically
+	template <typename F>
+	static void parallel_for(size_t n, unsigned nr_threads, const F& f)
+	{
+		const size_t block_size = 64;
+		cgv::utils::parallel_tasks((n + block_size - 1) / block_size, nr_threads, [&](size_t b) {
+			for (size_t i = b*block_size; i < std::min(n, (b + 1)*block_size); ++i)
+				f(i);
+		});
+	}
+	/// append range to list of ranges and merge it with the last range if they are adjacent
+	static void append_range(std::vector<index_range>& ranges, size_t start, size_t count)
+	{
+		if (!ranges.empty() && ranges.back().start + ranges.back().count == start)
+			ranges.back().count += count;
+		else {
+			index_range r = { start, count };
+			ranges.push_back(r);
+		}
+	}
+	/// test box bi of level li against the planes selected by plane_mask and append visible elements
+	void cull_box(unsigned li, size_t bi, const plane_type* planes, unsigned nr_planes, unsigned plane_mask, std::vector<index_range>& ranges) const
+	{
+		const vec_type& mn = levels[li].box_min[bi];
+		const vec_type& mx = levels[li].box_max[bi];
+		for (unsigned pi = 0; pi < nr_planes; ++pi) {
+			if ((plane_mask & (1u << pi)) == 0)
+				continue;
+			const plane_type& p = planes[pi];
+			// corners of box furthest along and against the plane normal
+			T d_max = p[3], d_min = p[3];
+			for (unsigned j = 0; j < 3; ++j) {
+				if (p[j] > 0) {
+					d_max += p[j] * mx[j];
+					d_min += p[j] * mn[j];
+				}
+				else {
+					d_max += p[j] * mn[j];
+					d_min += p[j] * mx[j];
+				}
+			}
+			if (d_max < 0)
+				return;
+			if (d_min >= 0)
+				plane_mask &= ~(1u << pi);
+		}
+		if (plane_mask == 0 || li == 0) {
+			size_t nr_chunks = levels[0].get_nr_boxes();
+			size_t c0 = bi*spans[li], c1 = std::min(nr_chunks, (bi + 1)*spans[li]);
+			size_t start = c0*chunk_size;
+			append_range(ranges, start, std::min(nr_elements, c1*chunk_size) - start);
+			return;
+		}
+		size_t end = std::min(levels[li - 1].get_nr_boxes(), (bi + 1)*fan_out);
+		for (size_t ci = bi*fan_out; ci < end; ++ci)
+			cull_box(li - 1, ci, planes, nr_planes, plane_mask, ranges);
+	}
+public:
+	/// construct empty hierarchy
+	chunk_box_hierarchy() : chunk_size(256), fan_out(8), nr_elements(0), radius(0) {}
+	/** build hierarchy over n positions with the given uniform radius and optional per element radii, which are added
+		to the uniform radius. The number of threads defaults to cgv::utils::get_nr_parallel_tasks_threads(). */
+	void build(const vec_type* positions, size_t n, T _radius = 0, const T* radii = 0, size_t _chunk_size = 256, unsigned _fan_out = 8, unsigned nr_threads = 0)
+	{
+		levels.clear();
+		spans.clear();
+		dirty.clear();
+		dirty_chunks.clear();
+		chunk_size = std::max(size_t(1), _chunk_size);
+		fan_out = std::max(2u, _fan_out);
+		nr_elements = n;
+		radius = _radius;
+		if (n == 0)
+			return;
+		size_t nr_chunks = (n + chunk_size - 1) / chunk_size;
+		levels.resize(1);
+		levels[0].box_min.resize(nr_chunks);
+		levels[0].box_max.resize(nr_chunks);
+		spans.push_back(1);
+		parallel_for(nr_chunks, get_nr_threads(nr_threads, nr_chunks, 256), [&](size_t ci) { compute_chunk_box(ci, positions, radii); });
+		while (levels.back().get_nr_boxes() > 1) {
+			size_t nr_boxes = (levels.back().get_nr_boxes() + fan_out - 1) / fan_out;
+			levels.push_back(level());
+			levels.back().box_min.resize(nr_boxes);
+			levels.back().box_max.resize(nr_boxes);
+			spans.push_back(spans.back()*fan_out);
+			unsigned li = unsigned(levels.size() - 1);
+			for (size_t bi = 0; bi < nr_boxes; ++bi)
+				compute_parent_box(li, bi);
+		}
+		dirty.assign(nr_chunks, 0);
+	}
+	/// mark the chunks overlapping the given element range to be recomputed in the next call to update()
+	void invalidate(size_t start = 0, size_t count = size_t(-1))
+	{
+		if (start >= nr_elements || count == 0)
+			return;
+		size_t end = count > nr_elements - start ? nr_elements : start + count;
+		for (size_t ci = start / chunk_size; ci <= (end - 1) / chunk_size; ++ci)
+			if (!dirty[ci]) {
+				dirty[ci] = 1;
+				dirty_chunks.push_back(ci);
+			}
+	}
+	/** recompute invalidated chunks and their ancestors from the current positions and radii, which need to have the
+		number of elements the hierarchy has been built for. Returns the number of recomputed chunks. */
+	size_t update(const vec_type* positions, const T* radii = 0, unsigned nr_threads = 0)
+	{
+		if (dirty_chunks.empty())
+			return 0;
+		std::vector<size_t> boxes;
+		boxes.swap(dirty_chunks);
+		std::sort(boxes.begin(), boxes.end());
+		parallel_for(boxes.size(), get_nr_threads(nr_threads, boxes.size(), 256), [&](size_t i) { compute_chunk_box(boxes[i], positions, radii); });
+		for (size_t i = 0; i < boxes.size(); ++i)
+			dirty[boxes[i]] = 0;
+		size_t nr_updated = boxes.size();
+		for (unsigned li = 1; li < levels.size(); ++li) {
+			size_t nr_parents = 0;
+			for (size_t i = 0; i < boxes.size(); ++i) {
+				size_t pi = boxes[i] / fan_out;
+				if (nr_parents == 0 || boxes[nr_parents - 1] != pi)
+					boxes[nr_parents++] = pi;
+			}
+			boxes.resize(nr_parents);
+			for (size_t i = 0; i < boxes.size(); ++i)
+				compute_parent_box(li, boxes[i]);
+		}
+		return nr_updated;
+	}
+	/** cull against up to 32 planes and return the number of visible elements. The visible elements are returned as
+		sorted list of maximal ranges. Subtrees are distributed over the given number of threads, which defaults to
+		cgv::utils::get_nr_parallel_tasks_threads() and is reduced for small hierarchies. */
+	size_t cull(const plane_type* planes, unsigned nr_planes, std::vector<index_range>& ranges, unsigned nr_threads = 0) const
+	{
+		ranges.clear();
+		if (levels.empty())
+			return 0;
+		unsigned plane_mask = nr_planes >= 32 ? ~0u : (1u << nr_planes) - 1;
+		nr_planes = std::min(nr_planes, 32u);
+		nr_threads = get_nr_threads(nr_threads, levels[0].get_nr_boxes(), 4096);
+		if (nr_threads == 1)
+			cull_box(unsigned(levels.size() - 1), 0, planes, nr_planes, plane_mask, ranges);
+		else {
+			// start at the coarsest level with enough boxes to balance the threads
+			unsigned li = unsigned(levels.size() - 1);
+			while (li > 0 && levels[li].get_nr_boxes() < 16 * nr_threads)
+				--li;
+			size_t nr_boxes = levels[li].get_nr_boxes();
+			std::vector<std::vector<index_range> > thread_ranges(nr_threads);
+			cgv::utils::parallel_tasks(nr_threads, nr_threads, [&](size_t t) {
+				for (size_t bi = t*nr_boxes / nr_threads; bi < (t + 1)*nr_boxes / nr_threads; ++bi)
+					cull_box(li, bi, planes, nr_planes, plane_mask, thread_ranges[t]);
+			});
+			for (unsigned t = 0; t < nr_threads; ++t)
+				for (size_t i = 0; i < thread_ranges[t].size(); ++i)
+					append_range(ranges, thread_ranges[t][i].start, thread_ranges[t][i].count);
+		}
+		size_t nr_visible = 0;
+		for (size_t i = 0; i < ranges.size(); ++i)
+			nr_visible += ranges[i].count;
+		return nr_visible;
+	}
+	/// cull against the view frustum of a combined projection and modelview matrix, see cull()
+	size_t cull(const fmat<T, 4, 4>& modelview_projection, std::vector<index_range>& ranges, unsigned nr_threads = 0) const
+	{
+		plane_type planes[6];
+		extract_frustum_planes(modelview_projection, planes);
+		return cull(planes, 6, ranges, nr_threads);
+	}
+	/// extract the normalized planes of the view frustum of a combined projection and modelview matrix in the order left, right, bottom, top, near, far
+	static void extract_frustum_planes(const fmat<T, 4, 4>& M, plane_type planes[6])
+	{
+		for (unsigned i = 0; i < 3; ++i)
+			for (unsigned j = 0; j < 4; ++j) {
+				planes[2 * i][j] = M(3, j) + M(i, j);
+				planes[2 * i + 1][j] = M(3, j) - M(i, j);
+			}
+		for (unsigned pi = 0; pi < 6; ++pi) {
+			T l = std::sqrt(planes[pi][0] * planes[pi][0] + planes[pi][1] * planes[pi][1] + planes[pi][2] * planes[pi][2]);
+			if (l > 0)
+				planes[pi] /= l;
+		}
+	}
+	/// return number of elements the hierarchy has been built for
+	size_t get_nr_elements() const { return nr_elements; }
+	/// return number of elements per chunk
+	size_t get_chunk_size() const { return chunk_size; }
+	/// return number of boxes merged into a box of the next level
+	unsigned get_fan_out() const { return fan_out; }
+	/// return uniform radius
+	T get_radius() const { return radius; }
+	/// return number of chunks waiting to be recomputed in update()
+	size_t get_nr_dirty_chunks() const { return dirty_chunks.size(); }
+	/// return number of levels, which is 0 before the hierarchy has been built
+	unsigned get_nr_levels() const { return unsigned(levels.size()); }
+	/// return level li, where level 0 holds the chunk boxes
+	const level& get_level(unsigned li) const { return levels[li]; }
+};
+
+	}
+}
@@ -279,3 +279,5 @@ const fmat<T, N, M> lerp(const fmat<T, N, M>& m1, const fmat<T, N, M>& m2, fmat<
 	}
 
 }
+
+#include "fmat_simd.h"
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "fmat.h"
+
+/** overloads of the 4x4 matrix products for float with SSE or NEON and for double with AVX
+	instructions if available. The overloads are non template functions and therefore preferred
+	over the generic templates of fmat.h. The storage of fvec and fmat is unchanged, such that all
+	loads and stores are unaligned. Products are accumulated in the same order as in the generic
+	implementation and without fused multiply add, such that results are identical up to the sign
+	of zero entries. */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CGV_MATH_SSE2
+#include <emmintrin.h>
+#if defined(__AVX__)
+#define CGV_MATH_AVX
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CGV_MATH_NEON
+#include <arm_neon.h>
+#endif
+
+namespace cgv {
+	namespace math {
+
+#if defined(CGV_MATH_SSE2)
+
+/// 4x4 float matrix vector product with SSE
+inline fvec<float, 4> operator * (const fmat<float, 4, 4>& m, const fvec<float, 4>& v)
+{
+	const float* a = &m(0, 0);
+	__m128 r = _mm_mul_ps(_mm_loadu_ps(a), _mm_set1_ps(v(0)));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(a + 4), _mm_set1_ps(v(1))));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(a + 8), _mm_set1_ps(v(2))));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(a + 12), _mm_set1_ps(v(3))));
+	fvec<float, 4> result;
+	_mm_storeu_ps(&result(0), r);
+	return result;
+}
+
+/// 4x4 float matrix product with SSE
+inline fmat<float, 4, 4> operator * (const fmat<float, 4, 4>& m1, const fmat<float, 4, 4>& m2)
+{
+	const float* a = &m1(0, 0);
+	const float* b = &m2(0, 0);
+	__m128 c0 = _mm_loadu_ps(a), c1 = _mm_loadu_ps(a + 4), c2 = _mm_loadu_ps(a + 8), c3 = _mm_loadu_ps(a + 12);
+	fmat<float, 4, 4> result;
+	float* r = &result(0, 0);
+	for (unsigned j = 0; j < 16; j += 4) {
+		__m128 rj = _mm_mul_ps(c0, _mm_set1_ps(b[j]));
+		rj = _mm_add_ps(rj, _mm_mul_ps(c1, _mm_set1_ps(b[j + 1])));
+		rj = _mm_add_ps(rj, _mm_mul_ps(c2, _mm_set1_ps(b[j + 2])));
+		rj = _mm_add_ps(rj, _mm_mul_ps(c3, _mm_set1_ps(b[j + 3])));
+		_mm_storeu_ps(r + j, rj);
+	}
+	return result;
+}
+
+/// multiply a float row vector from the left to a 4x4 matrix, what corresponds to a multiplication with the transposed matrix, with SSE
+inline fvec<float, 4> operator * (const fvec<float, 4>& v_row, const fmat<float, 4, 4>& m)
+{
+	const float* a = &m(0, 0);
+	__m128 r0 = _mm_loadu_ps(a), r1 = _mm_loadu_ps(a + 4), r2 = _mm_loadu_ps(a + 8), r3 = _mm_loadu_ps(a + 12);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	__m128 r = _mm_mul_ps(r0, _mm_set1_ps(v_row(0)));
+	r = _mm_add_ps(r, _mm_mul_ps(r1, _mm_set1_ps(v_row(1))));
+	r = _mm_add_ps(r, _mm_mul_ps(r2, _mm_set1_ps(v_row(2))));
+	r = _mm_add_ps(r, _mm_mul_ps(r3, _mm_set1_ps(v_row(3))));
+	fvec<float, 4> result;
+	_mm_storeu_ps(&result(0), r);
+	return result;
+}
+
+#if defined(CGV_MATH_AVX)
+
+/// 4x4 double matrix vector product with AVX
+inline fvec<double, 4> operator * (const fmat<double, 4, 4>& m, const fvec<double, 4>& v)
+{
+	const double* a = &m(0, 0);
+	__m256d r = _mm256_mul_pd(_mm256_loadu_pd(a), _mm256_set1_pd(v(0)));
+	r = _mm256_add_pd(r, _mm256_mul_pd(_mm256_loadu_pd(a + 4), _mm256_set1_pd(v(1))));
+	r = _mm256_add_pd(r, _mm256_mul_pd(_mm256_loadu_pd(a + 8), _mm256_set1_pd(v(2))));
+	r = _mm256_add_pd(r, _mm256_mul_pd(_mm256_loadu_pd(a + 12), _mm256_set1_pd(v(3))));
+	fvec<double, 4> result;
+	_mm256_storeu_pd(&result(0), r);
+	return result;
+}
+
+/// 4x4 double matrix product with AVX
+inline fmat<double, 4, 4> operator * (const fmat<double, 4, 4>& m1, const fmat<double, 4, 4>& m2)
+{
+	const double* a = &m1(0, 0);
+	const double* b = &m2(0, 0);
+	__m256d c0 = _mm256_loadu_pd(a), c1 = _mm256_loadu_pd(a + 4), c2 = _mm256_loadu_pd(a + 8), c3 = _mm256_loadu_pd(a + 12);
+	fmat<double, 4, 4> result;
+	double* r = &result(0, 0);
+	for (unsigned j = 0; j < 16; j += 4) {
+		__m256d rj = _mm256_mul_pd(c0, _mm256_set1_pd(b[j]));
+		rj = _mm256_add_pd(rj, _mm256_mul_pd(c1, _mm256_set1_pd(b[j + 1])));
+		rj = _mm256_add_pd(rj, _mm256_mul_pd(c2, _mm256_set1_pd(b[j + 2])));
+		rj = _mm256_add_pd(rj, _mm256_mul_pd(c3, _mm256_set1_pd(b[j + 3])));
+		_mm256_storeu_pd(r + j, rj);
+	}
+	return result;
+}
+
+#endif
+
+#elif defined(CGV_MATH_NEON)
+
+/// 4x4 float matrix vector product with NEON
+inline fvec<float, 4> operator * (const fmat<float, 4, 4>& m, const fvec<float, 4>& v)
+{
+	const float* a = &m(0, 0);
+	float32x4_t r = vmulq_n_f32(vld1q_f32(a), v(0));
+	r = vaddq_f32(r, vmulq_n_f32(vld1q_f32(a + 4), v(1)));
+	r = vaddq_f32(r, vmulq_n_f32(vld1q_f32(a + 8), v(2)));
+	r = vaddq_f32(r, vmulq_n_f32(vld1q_f32(a + 12), v(3)));
+	fvec<float, 4> result;
+	vst1q_f32(&result(0), r);
+	return result;
+}
+
+/// 4x4 float matrix product with NEON
+inline fmat<float, 4, 4> operator * (const fmat<float, 4, 4>& m1, const fmat<float, 4, 4>& m2)
+{
+	const float* a = &m1(0, 0);
+	const float* b = &m2(0, 0);
+	float32x4_t c0 = vld1q_f32(a), c1 = vld1q_f32(a + 4), c2 = vld1q_f32(a + 8), c3 = vld1q_f32(a + 12);
+	fmat<float, 4, 4> result;
+	float* r = &result(0, 0);
+	for (unsigned j = 0; j < 16; j += 4) {
+		float32x4_t rj = vmulq_n_f32(c0, b[j]);
+		rj = vaddq_f32(rj, vmulq_n_f32(c1, b[j + 1]));
+		rj = vaddq_f32(rj, vmulq_n_f32(c2, b[j + 2]));
+		rj = vaddq_f32(rj, vmulq_n_f32(c3, b[j + 3]));
+		vst1q_f32(r + j, rj);
+	}
+	return result;
+}
+
+/// multiply a float row vector from the left to a 4x4 matrix with NEON
+inline fvec<float, 4> operator * (const fvec<float, 4>& v_row, const fmat<float, 4, 4>& m)
+{
+	float32x4x4_t t = vld4q_f32(&m(0, 0));
+	float32x4_t r = vmulq_n_f32(t.val[0], v_row(0));
+	r = vaddq_f32(r, vmulq_n_f32(t.val[1], v_row(1)));
+	r = vaddq_f32(r, vmulq_n_f32(t.val[2], v_row(2)));
+	r = vaddq_f32(r, vmulq_n_f32(t.val[3], v_row(3)));
+	fvec<float, 4> result;
+	vst1q_f32(&result(0), r);
+	return result;
+}
+
+#endif
+
+	}
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cgv/data/data_view.h>
+#include <cgv/type/standard_types.h>
+#include <cgv/utils/parallel_tasks.h>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+namespace cgv{
+	namespace math{
+
+/** hierarchy of value ranges over cubic bricks of a 3d data view that supports empty space skipping in volume rendering.
+	Level 0 partitions the volume into bricks of brick_size^3 voxels, where the value range of a brick includes a one voxel
+	wide apron, such that interpolation at sample positions inside of the brick cannot leave the range. Each further level
+	merges 2x2x2 bricks of the previous level until a single brick remains. The brick layers of level 0 are processed in
+	parallel. Given an opacity table of the transfer function, compute_occupancy() classifies the bricks of a level in
+	constant time per brick. */
+template <typename T = float>
+class min_max_brick_hierarchy
+{
+public:
+	/// value ranges of the bricks of one level stored in x fastest order
+	struct level
+	{
+		/// number of bricks along x, y and z
+		unsigned dims[3];
+		/// minimum value per brick
+		std::vector<T> min_values;
+		/// maximum value per brick
+		std::vector<T> max_values;
+		/// return number of bricks
+		size_t get_nr_bricks() const { return size_t(dims[0])*dims[1]*dims[2]; }
+		/// return index of brick (x,y,z)
+		size_t get_index(unsigned x, unsigned y, unsigned z) const { return x + dims[0]*(y + size_t(dims[1])*z); }
+	};
+protected:
+	/// edge length of level 0 bricks in voxels
+	unsigned brick_size;
+	/// resolution of volume
+	unsigned volume_dims[3];
+	/// levels from finest to coarsest
+	std::vector<level> levels;
+	/// read component ci of a row of n voxels with stride sx into values, where common single component types avoid the generic access
+	static void read_row(const cgv::data::data_format* df, const unsigned char* ptr, unsigned sx, unsigned n, unsigned ci, T* values)
+	{
+		if (df->get_nr_components() == 1) {
+			switch (df->get_component_type()) {
+			case cgv::type::info::TI_UINT8: for (unsigned i = 0; i < n; ++i, ptr += sx) values[i] = T(*ptr); return;
+			case cgv::type::info::TI_UINT16: for (unsigned i = 0; i < n; ++i, ptr += sx) values[i] = T(*reinterpret_cast<const cgv::type::uint16_type*>(ptr)); return;
+			case cgv::type::info::TI_INT16: for (unsigned i = 0; i < n; ++i, ptr += sx) values[i] = T(*reinterpret_cast<const cgv::type::int16_type*>(ptr)); return;
+			case cgv::type::info::TI_FLT32: for (unsigned i = 0; i < n; ++i, ptr += sx) values[i] = T(*reinterpret_cast<const cgv::type::flt32_type*>(ptr)); return;
+			default: break;
+			}
+		}
+		for (unsigned i = 0; i < n; ++i, ptr += sx)
+			values[i] = df->get<T>(ci, ptr);
+	}
+	/// return the voxel range [begin,end) of brick b including the apron
+	void get_voxel_range(unsigned b, unsigned n, unsigned& begin, unsigned& end) const
+	{
+		begin = b*brick_size == 0 ? 0 : b*brick_size - 1;
+		end = std::min(n, (b + 1)*brick_size + 1);
+	}
+	/// compute the ranges of all level 0 bricks in brick layer bz with the help of buffers for one row and the row ranges of one slice
+	void build_brick_layer(const cgv::data::const_data_view& input, unsigned ci, unsigned bz, std::vector<T>& row, std::vector<T>& row_min, std::vector<T>& row_max)
+	{
+		const cgv::data::data_format* df = input.get_format();
+		const unsigned w = volume_dims[0], h = volume_dims[1];
+		const unsigned sx = input.get_step_size(2), sy = input.get_step_size(1), sz = input.get_step_size(0);
+		const unsigned char* data = input.get_ptr<unsigned char>();
+		level& l = levels[0];
+		const unsigned wb = l.dims[0], hb = l.dims[1];
+		T* layer_min = &l.min_values[size_t(bz)*wb*hb];
+		T* layer_max = &l.max_values[size_t(bz)*wb*hb];
+		std::fill(layer_min, layer_min + size_t(wb)*hb, std::numeric_limits<T>::max());
+		std::fill(layer_max, layer_max + size_t(wb)*hb, std::numeric_limits<T>::lowest());
+		unsigned z0, z1;
+		get_voxel_range(bz, volume_dims[2], z0, z1);
+		for (unsigned z = z0; z < z1; ++z) {
+			// reduce each row over the x-ranges of the bricks
+			for (unsigned y = 0; y < h; ++y) {
+				read_row(df, data + z*size_t(sz) + y*size_t(sy), sx, w, ci, &row[0]);
+				for (unsigned bx = 0; bx < wb; ++bx) {
+					unsigned x0, x1;
+					get_voxel_range(bx, w, x0, x1);
+					T v_min = row[x0], v_max = row[x0];
+					for (unsigned x = x0 + 1; x < x1; ++x) {
+						v_min = std::min(v_min, row[x]);
+						v_max = std::max(v_max, row[x]);
+					}
+					row_min[size_t(y)*wb + bx] = v_min;
+					row_max[size_t(y)*wb + bx] = v_max;
+				}
+			}
+			// reduce rows of the slice over the y-ranges of the bricks
+			for (unsigned by = 0; by < hb; ++by) {
+				unsigned y0, y1;
+				get_voxel_range(by, h, y0, y1);
+				T* b_min = layer_min + size_t(by)*wb;
+				T* b_max = layer_max + size_t(by)*wb;
+				for (unsigned y = y0; y < y1; ++y) {
+					const T* r_min = &row_min[size_t(y)*wb];
+					const T* r_max = &row_max[size_t(y)*wb];
+					for (unsigned bx = 0; bx < wb; ++bx) {
+						b_min[bx] = std::min(b_min[bx], r_min[bx]);
+						b_max[bx] = std::max(b_max[bx], r_max[bx]);
+					}
+				}
+			}
+		}
+	}
+public:
+	/// construct empty hierarchy
+	min_max_brick_hierarchy() : brick_size(16) { volume_dims[0] = volume_dims[1] = volume_dims[2] = 0; }
+	/** build hierarchy over component ci of a 3d data view with the given brick size. The number of threads
+		defaults to cgv::utils::get_nr_parallel_tasks_threads(). Returns false if the view is not 3d. */
+	bool build(const cgv::data::const_data_view& input, unsigned _brick_size = 16, unsigned ci = 0, unsigned nr_threads = 0)
+	{
+		levels.clear();
+		const cgv::data::data_format* df = input.get_format();
+		if (!df || input.empty() || input.get_dim() != 3 || _brick_size == 0)
+			return false;
+		brick_size = _brick_size;
+		volume_dims[0] = df->get_width();
+		volume_dims[1] = df->get_height();
+		volume_dims[2] = df->get_depth();
+		levels.resize(1);
+		level& l0 = levels[0];
+		for (unsigned i = 0; i < 3; ++i)
+			l0.dims[i] = (volume_dims[i] + brick_size - 1) / brick_size;
+		l0.min_values.resize(l0.get_nr_bricks());
+		l0.max_values.resize(l0.get_nr_bricks());
+		nr_threads = std::min(cgv::utils::get_nr_parallel_tasks_threads(nr_threads), l0.dims[2]);
+		// brick layers are distributed dynamically over the threads, each of which owns its row buffers
+		std::atomic<unsigned> next_layer(0);
+		cgv::utils::parallel_tasks(nr_threads, nr_threads, [&](size_t) {
+			std::vector<T> row(volume_dims[0]), row_min(size_t(volume_dims[1])*l0.dims[0]), row_max(row_min.size());
+			for (unsigned bz; (bz = next_layer++) < l0.dims[2]; )
+				build_brick_layer(input, ci, bz, row, row_min, row_max);
+		});
+		// merge 2x2x2 bricks into the next coarser level
+		while (levels.back().get_nr_bricks() > 1) {
+			levels.push_back(level());
+			const level& f = levels[levels.size() - 2];
+			level& c = levels.back();
+			for (unsigned i = 0; i < 3; ++i)
+				c.dims[i] = (f.dims[i] + 1) / 2;
+			c.min_values.resize(c.get_nr_bricks(), std::numeric_limits<T>::max());
+			c.max_values.resize(c.get_nr_bricks(), std::numeric_limits<T>::lowest());
+			for (unsigned z = 0; z < f.dims[2]; ++z)
+				for (unsigned y = 0; y < f.dims[1]; ++y)
+					for (unsigned x = 0; x < f.dims[0]; ++x) {
+						size_t fi = f.get_index(x, y, z), pi = c.get_index(x / 2, y / 2, z / 2);
+						c.min_values[pi] = std::min(c.min_values[pi], f.min_values[fi]);
+						c.max_values[pi] = std::max(c.max_values[pi], f.max_values[fi]);
+					}
+		}
+		return true;
+	}
+	/// return edge length of level 0 bricks in voxels
+	unsigned get_brick_size() const { return brick_size; }
+	/// return resolution of volume along axis i
+	unsigned get_volume_dim(unsigned i) const { return volume_dims[i]; }
+	/// return number of levels, which is 0 before the hierarchy has been built
+	size_t get_nr_levels() const { return levels.size(); }
+	/// return level li, where level 0 is the finest
+	const level& get_level(size_t li) const { return levels[li]; }
+	/** classify the bricks of level li with an opacity table that samples the opacity applied by the renderer
+		uniformly over the values [value_min,value_max]. A brick is occupied if one of the table entries overlapping its value range
+		exceeds opacity_threshold. The occupancy vector receives 1 for occupied and 0 for empty bricks. Returns the
+		number of occupied bricks. */
+	size_t compute_occupancy(const std::vector<float>& opacity, T value_min, T value_max, std::vector<unsigned char>& occupancy,
+		size_t li = 0, float opacity_threshold = 0.0f) const
+	{
+		const level& l = levels[li];
+		occupancy.resize(l.get_nr_bricks());
+		if (opacity.empty()) {
+			std::fill(occupancy.begin(), occupancy.end(), (unsigned char)0);
+			return 0;
+		}
+		// prefix counts of opaque table entries answer whether an index range contains one in constant time
+		const int n = int(opacity.size());
+		std::vector<unsigned> prefix(n + 1, 0);
+		for (int i = 0; i < n; ++i)
+			prefix[i + 1] = prefix[i] + (opacity[i] > opacity_threshold ? 1 : 0);
+		double scale = value_max > value_min ? double(n - 1) / (double(value_max) - value_min) : 0.0;
+		size_t nr_occupied = 0;
+		for (size_t bi = 0; bi < occupancy.size(); ++bi) {
+			// interpolation between table entries requires the enclosing entries
+			double i0 = std::floor((double(l.min_values[bi]) - value_min)*scale);
+			double i1 = std::ceil((double(l.max_values[bi]) - value_min)*scale);
+			int lo = int(std::max(0.0, std::min(double(n - 1), i0)));
+			int hi = int(std::max(0.0, std::min(double(n - 1), i1)));
+			bool occupied = prefix[hi + 1] > prefix[lo];
+			occupancy[bi] = occupied ? 1 : 0;
+			if (occupied)
+				++nr_occupied;
+		}
+		return nr_occupied;
+	}
+};
+
+	}
+}
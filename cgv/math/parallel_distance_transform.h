@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cgv/data/data_view.h>
+#include <cgv/utils/parallel_tasks.h>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <atomic>
+#include <algorithm>
+
+namespace cgv{
+	namespace math{
+
+/**
+* Exact euclidean distance transform of 2d and 3d data views that applies the 1d squared distance
+* transform of Felzenszwalb and Huttenlocher (see distance_transform.h) separably along each axis.
+* The lines of each axis are processed in parallel, where each thread uses preallocated buffers.
+* Optionally the linear index x+w*(y+h*z) of the nearest feature voxel is computed for each voxel.
+*/
+
+/** 1d squared distance transform on raw buffers without memory allocation. f is the input of length n
+	with std::numeric_limits<T>::max() marking positions without feature, d receives the squared distances
+	and v and z are buffers of size n and n+1. If nearest_in and nearest_out are given, nearest_out[q]
+	is set to nearest_in[p] where p is the position that minimizes (q-p)^2+f[p]. Positions that do not
+	see any feature keep the value max() in d and nearest_out. */
+template <typename T>
+void sqrdist_transf_1d(const T* f, T* d, unsigned n, int* v, T* z,
+					   const unsigned* nearest_in = 0, unsigned* nearest_out = 0)
+{
+	const T INF = std::numeric_limits<T>::max();
+	// build lower envelope of parabolas over positions with finite values only
+	int k = -1;
+	for (unsigned q = 0; q < n; ++q) {
+		if (f[q] == INF)
+			continue;
+		T fq = f[q] + T(q)*T(q);
+		T s = -INF;
+		while (k >= 0) {
+			int p = v[k];
+			s = (fq - (f[p] + T(p)*T(p))) / (2 * (T(q) - T(p)));
+			if (s > z[k])
+				break;
+			--k;
+		}
+		if (k < 0)
+			s = -INF;
+		++k;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = INF;
+	}
+	if (k < 0) {
+		std::fill(d, d + n, INF);
+		if (nearest_out)
+			std::fill(nearest_out, nearest_out + n, std::numeric_limits<unsigned>::max());
+		return;
+	}
+	k = 0;
+	for (unsigned q = 0; q < n; ++q) {
+		while (z[k + 1] < T(q))
+			++k;
+		int p = v[k];
+		d[q] = (T(q) - T(p))*(T(q) - T(p)) + f[p];
+		if (nearest_out)
+			nearest_out[q] = nearest_in[p];
+	}
+}
+
+/** compute the squared euclidean distance transform of a 2d or 3d data view in parallel. Feature
+	voxels are those whose component ci is greater or equal to threshold, where components of
+	arbitrary type are accessed through the data format. The squared distances in voxel units are
+	written to sqr_dist in x fastest order. If nearest is not null, it receives for each voxel the
+	linear index x+w*(y+h*z) of the nearest feature voxel. Voxels without any feature in the volume
+	get std::numeric_limits<T>::max() and std::numeric_limits<unsigned>::max(). The number of threads
+	defaults to cgv::utils::get_nr_parallel_tasks_threads(). Returns false if the view is not 2d or 3d. */
+template <typename T>
+bool sqrdist_transf(const cgv::data::const_data_view& input, std::vector<T>& sqr_dist,
+					std::vector<unsigned>* nearest = 0, double threshold = 0.5, unsigned ci = 0,
+					unsigned nr_threads = 0)
+{
+	const cgv::data::data_format* df = input.get_format();
+	if (!df || input.empty())
+		return false;
+	unsigned dim = input.get_dim();
+	if (dim < 2 || dim > 3)
+		return false;
+	const T INF = std::numeric_limits<T>::max();
+	const unsigned w = df->get_width(), h = df->get_height(), dp = dim == 3 ? df->get_depth() : 1;
+	const size_t wh = size_t(w)*h, n = wh*dp;
+	const unsigned sx = input.get_step_size(dim - 1), sy = input.get_step_size(dim - 2), sz = dim == 3 ? input.get_step_size(0) : 0;
+	const unsigned char* data = input.get_ptr<unsigned char>();
+	sqr_dist.resize(n);
+	if (nearest)
+		nearest->resize(n);
+	nr_threads = cgv::utils::get_nr_parallel_tasks_threads(nr_threads);
+	unsigned max_len = std::max(w, std::max(h, dp));
+	T* D = &sqr_dist[0];
+	unsigned* I = nearest ? &(*nearest)[0] : 0;
+
+	// distribute blocks of lines of one axis over threads, each thread owns buffers for line input and output
+	// that hold a complete block such that strided lines of the y- and z-pass are gathered with contiguous reads
+	const unsigned B = 16;
+	std::atomic<size_t> next_line;
+	auto run_pass = [&](size_t nr_lines, unsigned len, size_t elem_step, int axis) {
+		next_line = 0;
+		cgv::utils::parallel_tasks(nr_threads, nr_threads, [&](size_t) {
+			std::vector<T> f(B*max_len), d(max_len), z(max_len + 1);
+			std::vector<int> v(max_len);
+			std::vector<unsigned> nin(I ? B*max_len : 0), nout(I ? max_len : 0);
+			size_t base[B];
+			for (;;) {
+				size_t l0 = next_line.fetch_add(B);
+				if (l0 >= nr_lines)
+					break;
+				unsigned nb = (unsigned)(std::min(nr_lines, l0 + B) - l0);
+				if (axis == 0) {
+					// x-lines are contiguous and initialized from the input
+					for (unsigned b = 0; b < nb; ++b) {
+						size_t l = l0 + b, o = l*w;
+						const unsigned char* ptr = data + (l / h)*sz + (l % h)*sy;
+						for (unsigned i = 0; i < len; ++i, ptr += sx) {
+							f[i] = df->get<double>(ci, ptr) >= threshold ? T(0) : INF;
+							if (I)
+								nin[i] = unsigned(o + i);
+						}
+						sqrdist_transf_1d(&f[0], D + o, len, &v[0], &z[0], I ? &nin[0] : 0, I ? I + o : 0);
+					}
+					continue;
+				}
+				// lines of the y-pass are indexed by (x,z) and of the z-pass by (x,y)
+				for (unsigned b = 0; b < nb; ++b) {
+					size_t l = l0 + b;
+					base[b] = axis == 1 ? (l % w) + (l / w)*wh : l;
+				}
+				for (unsigned i = 0; i < len; ++i)
+					for (unsigned b = 0; b < nb; ++b) {
+						size_t j = base[b] + i*elem_step;
+						f[b*len + i] = D[j];
+						if (I)
+							nin[b*len + i] = I[j];
+					}
+				for (unsigned b = 0; b < nb; ++b) {
+					sqrdist_transf_1d(&f[b*len], &d[0], len, &v[0], &z[0], I ? &nin[b*len] : 0, I ? &nout[0] : 0);
+					for (unsigned i = 0; i < len; ++i)
+						f[b*len + i] = d[i];
+					if (I)
+						std::copy(nout.begin(), nout.begin() + len, nin.begin() + b*len);
+				}
+				for (unsigned i = 0; i < len; ++i)
+					for (unsigned b = 0; b < nb; ++b) {
+						size_t j = base[b] + i*elem_step;
+						D[j] = f[b*len + i];
+						if (I)
+							I[j] = nin[b*len + i];
+					}
+			}
+		});
+	};
+	// x-pass over h*dp contiguous lines, y-pass over w*dp lines with stride w, z-pass over w*h lines with stride w*h
+	run_pass(h*size_t(dp), w, 1, 0);
+	run_pass(w*size_t(dp), h, w, 1);
+	if (dp > 1)
+		run_pass(wh, dp, wh, 2);
+	return true;
+}
+
+/// compute the euclidean distance transform of a 2d or 3d data view in parallel, see sqrdist_transf() for parameters
+template <typename T>
+bool dist_transf(const cgv::data::const_data_view& input, std::vector<T>& dist,
+				 std::vector<unsigned>* nearest = 0, double threshold = 0.5, unsigned ci = 0,
+				 unsigned nr_threads = 0)
+{
+	if (!sqrdist_transf(input, dist, nearest, threshold, ci, nr_threads))
+		return false;
+	const T INF = std::numeric_limits<T>::max();
+	for (size_t i = 0; i < dist.size(); ++i)
+		if (dist[i] != INF)
+			dist[i] = std::sqrt(dist[i]);
+	return true;
+}
+
+	}
+}
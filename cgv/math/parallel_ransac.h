@@ -0,0 +1,444 @@
+#pragma once
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <cgv/math/fvec.h>
+#include <cgv/math/vec.h>
+#include <cgv/math/mat.h>
+#include <cgv/math/random.h>
+#include <cgv/math/ransac.h>
+#include <cgv/math/plane.h>
+#include <cgv/math/sphere.h>
+#include <cgv/utils/parallel_tasks.h>
+
+namespace cgv{
+	namespace math{
+
+/** model traits for the parallel ransac engine that describe a plane as (a,b,c,d) with a*x+b*y+c*z+d=0
+	and a normalized normal (a,b,c) as in plane.h */
+template <typename T>
+struct ransac_plane_model
+{
+	typedef fvec<T,4> model_type;
+	typedef fvec<T,3> point_type;
+	/// number of points in a minimal sample
+	enum { sample_size = 3 };
+	/// fit a model to a minimal sample, return false for degenerate samples
+	static bool fit_minimal(const point_type* const* P, model_type& m)
+	{
+		point_type n = cross(*P[1] - *P[0], *P[2] - *P[0]);
+		T l = length(n);
+		if (!(l > std::numeric_limits<T>::epsilon()*sqr_length(*P[1] - *P[0])))
+			return false;
+		n /= l;
+		m.set(n(0), n(1), n(2), -dot(n, *P[0]));
+		return true;
+	}
+	/// total least squares fit to the given inliers based on tls_plane_fit
+	static bool fit_least_squares(const std::vector<point_type>& pnts, model_type& m)
+	{
+		if (pnts.size() < sample_size)
+			return false;
+		mat<T> points(3, (unsigned)pnts.size());
+		for (unsigned i = 0; i < pnts.size(); ++i)
+			for (unsigned j = 0; j < 3; ++j)
+				points(j, i) = pnts[i](j);
+		vec<T> pl = tls_plane_fit(points);
+		m.set(pl(0), pl(1), pl(2), pl(3));
+		return true;
+	}
+	/// compute absolute distances of a batch of n points given in SoA layout
+	static void residuals(const model_type& m, const T* x, const T* y, const T* z, unsigned n, T* r)
+	{
+		const T a = m(0), b = m(1), c = m(2), d = m(3);
+		for (unsigned i = 0; i < n; ++i)
+			r[i] = std::abs(a*x[i] + b*y[i] + c*z[i] + d);
+	}
+};
+
+/** model traits for the parallel ransac engine that describe a sphere as (cx,cy,cz,r) as in sphere.h */
+template <typename T>
+struct ransac_sphere_model
+{
+	typedef fvec<T,4> model_type;
+	typedef fvec<T,3> point_type;
+	/// number of points in a minimal sample
+	enum { sample_size = 4 };
+	/// fit a model to a minimal sample based on sphere_fit, return false for degenerate samples
+	static bool fit_minimal(const point_type* const* P, model_type& m)
+	{
+		point_type a = *P[1] - *P[0], b = *P[2] - *P[0], c = *P[3] - *P[0];
+		T vol = dot(cross(a, b), c);
+		T s = length(a)*length(b)*length(c);
+		if (!(std::abs(vol) > (T)1e-6*s))
+			return false;
+		vec<T> sp = sphere_fit(P[0]->to_vec(), P[1]->to_vec(), P[2]->to_vec(), P[3]->to_vec());
+		if (!(sp(3) > 0))
+			return false;
+		m.set(sp(0), sp(1), sp(2), sp(3));
+		return true;
+	}
+	/// algebraic least squares fit of x^2+y^2+z^2 + D*x + E*y + F*z + G = 0 to the given inliers
+	static bool fit_least_squares(const std::vector<point_type>& pnts, model_type& m)
+	{
+		if (pnts.size() < sample_size)
+			return false;
+		// accumulate normal equations relative to first point for numerical stability
+		point_type o = pnts[0];
+		mat<T> A(4, 4);
+		vec<T> b(4);
+		A.zeros();
+		b.zeros();
+		for (unsigned i = 0; i < pnts.size(); ++i) {
+			point_type p = pnts[i] - o;
+			T row[4] = { p(0), p(1), p(2), 1 };
+			T rhs = -sqr_length(p);
+			for (unsigned j = 0; j < 4; ++j) {
+				for (unsigned k = 0; k < 4; ++k)
+					A(j, k) += row[j] * row[k];
+				b(j) += row[j] * rhs;
+			}
+		}
+		vec<T> x;
+		if (!solve(A, b, x))
+			return false;
+		point_type c((T)-0.5*x(0), (T)-0.5*x(1), (T)-0.5*x(2));
+		T r2 = sqr_length(c) - x(3);
+		if (!(r2 > 0))
+			return false;
+		c += o;
+		m.set(c(0), c(1), c(2), std::sqrt(r2));
+		return true;
+	}
+	/// compute absolute distances to the sphere surface of a batch of n points given in SoA layout
+	static void residuals(const model_type& m, const T* x, const T* y, const T* z, unsigned n, T* r)
+	{
+		const T cx = m(0), cy = m(1), cz = m(2), rad = m(3);
+		for (unsigned i = 0; i < n; ++i)
+			r[i] = std::abs(std::sqrt((x[i] - cx)*(x[i] - cx) + (y[i] - cy)*(y[i] - cy) + (z[i] - cz)*(z[i] - cz)) - rad);
+	}
+};
+
+/// configuration of the parallel ransac engine
+template <typename T>
+struct parallel_ransac_config
+{
+	/// maximum distance of an inlier to the model
+	T inlier_threshold;
+	/// probability to draw at least one all-inlier sample, used for adaptive iteration count; values >= 1 always run max_iterations
+	T confidence;
+	/// upper bound on the number of hypotheses
+	unsigned max_iterations;
+	/// number of worker threads, 0 selects cgv::utils::get_nr_parallel_tasks_threads()
+	unsigned nr_threads;
+	/// number of points scored per batch, the sprt test is evaluated after each batch
+	unsigned batch_size;
+	/// whether to use the sequential probability ratio test (Wald) to preempt the scoring of bad hypotheses
+	bool use_sprt;
+	/// initial estimate of the fraction of inliers used by the sprt
+	T sprt_initial_inlier_ratio;
+	/// initial estimate of the probability that a point is consistent with a bad model
+	T sprt_initial_delta;
+	/// whether to locally optimize every new best hypothesis with least squares fits to its inliers (LO-RANSAC)
+	bool local_optimization;
+	/// maximum number of least squares iterations of the local optimization
+	unsigned local_optimization_iterations;
+	/// seed for the per thread random generators
+	unsigned long long seed;
+	/// construct with default values
+	parallel_ransac_config(T _inlier_threshold = (T)0.01) :
+		inlier_threshold(_inlier_threshold), confidence((T)0.99), max_iterations(100000),
+		nr_threads(0), batch_size(64), use_sprt(true), sprt_initial_inlier_ratio((T)0.1),
+		sprt_initial_delta((T)0.01), local_optimization(true), local_optimization_iterations(4), seed(1) {}
+};
+
+/// result of a parallel ransac run
+template <typename M>
+struct parallel_ransac_result
+{
+	/// best model found
+	M model;
+	/// whether a valid model was found
+	bool valid;
+	/// number of inliers of the best model
+	size_t nr_inliers;
+	/// truncated quadratic (MSAC) cost of the best model
+	double cost;
+	/// number of generated hypotheses including degenerate samples
+	size_t nr_hypotheses;
+	/// number of hypotheses that were rejected early by the sprt
+	size_t nr_rejected;
+	/// number of point residuals that have been evaluated
+	size_t nr_evaluated_points;
+	/// number of performed local optimizations
+	size_t nr_local_optimizations;
+	///
+	parallel_ransac_result() : valid(false), nr_inliers(0), cost(std::numeric_limits<double>::max()),
+		nr_hypotheses(0), nr_rejected(0), nr_evaluated_points(0), nr_local_optimizations(0) {}
+};
+
+/** RANSAC engine that generates and scores hypotheses in parallel on several threads. The template argument
+	is a model traits class like ransac_plane_model or ransac_sphere_model. Points are copied once into a
+	randomly permuted structure of arrays such that residuals can be computed in batches with vectorizable
+	loops and the sprt can evaluate the points of each hypothesis in random order. The number of iterations is
+	adapted to the best inlier ratio found so far with num_ransac_iterations() from ransac.h. */
+template <class Model, typename T = typename Model::point_type::value_type>
+class parallel_ransac
+{
+public:
+	typedef typename Model::model_type model_type;
+	typedef typename Model::point_type point_type;
+	typedef parallel_ransac_config<T> config_type;
+	typedef parallel_ransac_result<model_type> result_type;
+protected:
+	/// permuted point coordinates in SoA layout
+	std::vector<T> x, y, z;
+	/// permuted points in AoS layout used for sampling and least squares fits
+	std::vector<point_type> points;
+	/// state shared among the worker threads
+	struct shared_state
+	{
+		std::mutex mtx;
+		std::atomic<size_t> nr_started;
+		size_t required_iterations;
+		T epsilon, delta, log_A;
+		double delta_sum;
+		size_t delta_count;
+		result_type result;
+	};
+	/// compute the sprt decision threshold log(A) from the current estimates of epsilon and delta
+	static T compute_sprt_log_threshold(T epsilon, T delta, T nr_points)
+	{
+		// time of model fit in units of point evaluations and number of models per sample
+		const T t_M = (T)200, m_S = (T)1;
+		T C = (1 - delta)*std::log((1 - delta) / (1 - epsilon)) + delta*std::log(delta / epsilon);
+		if (!(C > 0))
+			return std::numeric_limits<T>::max();
+		T K = t_M*C / m_S + 1;
+		T A = K;
+		for (unsigned i = 0; i < 10; ++i)
+			A = K + std::log(A);
+		// the threshold should not reject before a reasonable fraction of the data has been seen
+		return std::min(std::log(A), nr_points);
+	}
+	/// score model on all points, return cost and fill inlier count; if sprt is enabled return false on early rejection
+	bool score(const model_type& m, const config_type& cfg, bool sprt, T log_A, T epsilon, T delta,
+		       std::vector<T>& r, size_t& nr_inliers, double& cost, size_t& nr_evaluated) const
+	{
+		const T thr = cfg.inlier_threshold, thr2 = thr*thr;
+		const T log_in = std::log(delta / epsilon), log_out = std::log((1 - delta) / (1 - epsilon));
+		size_t n = x.size();
+		nr_inliers = 0;
+		cost = 0;
+		nr_evaluated = 0;
+		for (size_t b = 0; b < n; b += cfg.batch_size) {
+			unsigned cnt = (unsigned)std::min(n - b, (size_t)cfg.batch_size);
+			Model::residuals(m, &x[b], &y[b], &z[b], cnt, &r[0]);
+			unsigned batch_inliers = 0;
+			T batch_cost = 0;
+			for (unsigned i = 0; i < cnt; ++i) {
+				T ri = r[i];
+				bool in = ri < thr;
+				batch_inliers += in ? 1 : 0;
+				batch_cost += in ? ri*ri : thr2;
+			}
+			nr_inliers += batch_inliers;
+			cost += batch_cost;
+			nr_evaluated += cnt;
+			if (sprt) {
+				T log_lambda = nr_inliers*log_in + (nr_evaluated - nr_inliers)*log_out;
+				if (log_lambda > log_A)
+					return false;
+			}
+		}
+		return true;
+	}
+	/// collect inliers of model into given vector
+	void collect_inliers(const model_type& m, T thr, std::vector<T>& r, std::vector<point_type>& inliers, unsigned batch_size) const
+	{
+		inliers.clear();
+		size_t n = x.size();
+		for (size_t b = 0; b < n; b += batch_size) {
+			unsigned cnt = (unsigned)std::min(n - b, (size_t)batch_size);
+			Model::residuals(m, &x[b], &y[b], &z[b], cnt, &r[0]);
+			for (unsigned i = 0; i < cnt; ++i)
+				if (r[i] < thr)
+					inliers.push_back(points[b + i]);
+		}
+	}
+	/// worker function executed by each thread
+	void work(const config_type& cfg, shared_state& S, unsigned thread_index) const
+	{
+		cgv::math::random rg(cfg.seed + 7919ull*thread_index);
+		std::vector<T> r(cfg.batch_size);
+		std::vector<point_type> inliers;
+		const point_type* sample[Model::sample_size];
+		unsigned n = (unsigned)points.size();
+		for (;;) {
+			size_t it = S.nr_started++;
+			T epsilon, delta, log_A;
+			{
+				std::lock_guard<std::mutex> lock(S.mtx);
+				if (it >= S.required_iterations)
+					break;
+				epsilon = S.epsilon;
+				delta = S.delta;
+				log_A = S.log_A;
+			}
+			// draw minimal sample of distinct indices
+			unsigned idx[Model::sample_size];
+			for (unsigned i = 0; i < Model::sample_size; ++i) {
+				bool unique;
+				do {
+					rg.uniform(0, n - 1, idx[i]);
+					unique = true;
+					for (unsigned j = 0; j < i; ++j)
+						if (idx[j] == idx[i])
+							unique = false;
+				} while (!unique);
+				sample[i] = &points[idx[i]];
+			}
+			model_type m;
+			if (!Model::fit_minimal(sample, m)) {
+				std::lock_guard<std::mutex> lock(S.mtx);
+				++S.result.nr_hypotheses;
+				continue;
+			}
+			size_t nr_inliers, nr_evaluated;
+			double cost;
+			bool accepted = score(m, cfg, cfg.use_sprt, log_A, epsilon, delta, r, nr_inliers, cost, nr_evaluated);
+			size_t nr_lo = 0;
+			double best_cost;
+			{
+				std::lock_guard<std::mutex> lock(S.mtx);
+				best_cost = S.result.cost;
+			}
+			// locally optimize hypotheses that improve on the best one
+			if (accepted && cfg.local_optimization && cost < best_cost) {
+				for (unsigned k = 0; k < cfg.local_optimization_iterations; ++k) {
+					collect_inliers(m, cfg.inlier_threshold, r, inliers, cfg.batch_size);
+					model_type m_lo;
+					if (!Model::fit_least_squares(inliers, m_lo))
+						break;
+					size_t nr_inliers_lo, nr_evaluated_lo;
+					double cost_lo;
+					score(m_lo, cfg, false, log_A, epsilon, delta, r, nr_inliers_lo, cost_lo, nr_evaluated_lo);
+					nr_evaluated += nr_evaluated_lo;
+					++nr_lo;
+					if (!(cost_lo < cost))
+						break;
+					m = m_lo;
+					cost = cost_lo;
+					nr_inliers = nr_inliers_lo;
+				}
+			}
+			std::lock_guard<std::mutex> lock(S.mtx);
+			result_type& R = S.result;
+			++R.nr_hypotheses;
+			R.nr_evaluated_points += nr_evaluated;
+			R.nr_local_optimizations += nr_lo;
+			if (!accepted) {
+				++R.nr_rejected;
+				// update estimate of the probability that a point is consistent with a bad model
+				S.delta_sum += (double)nr_inliers / nr_evaluated;
+				++S.delta_count;
+				T new_delta = (T)(S.delta_sum / S.delta_count);
+				if (new_delta > 0 && std::abs(new_delta - S.delta) > (T)0.05*S.delta && new_delta < S.epsilon) {
+					S.delta = new_delta;
+					S.log_A = compute_sprt_log_threshold(S.epsilon, S.delta, (T)n);
+				}
+				continue;
+			}
+			if (cost < R.cost) {
+				R.model = m;
+				R.cost = cost;
+				R.nr_inliers = nr_inliers;
+				R.valid = true;
+				T inlier_ratio = (T)nr_inliers / n;
+				if (inlier_ratio > S.epsilon) {
+					S.epsilon = std::min(inlier_ratio, (T)0.999);
+					if (S.delta >= S.epsilon)
+						S.delta = (T)0.5*S.epsilon;
+					S.log_A = compute_sprt_log_threshold(S.epsilon, S.delta, (T)n);
+				}
+				// a confidence of 1 would need infinitely many iterations and disables the adaptive termination
+				if (inlier_ratio > 0 && cfg.confidence < 1) {
+					size_t req = num_ransac_iterations<T>(Model::sample_size, 1 - inlier_ratio, cfg.confidence);
+					S.required_iterations = std::min(S.required_iterations, std::max(req, (size_t)1));
+				}
+			}
+		}
+	}
+public:
+	/// construct from n points, which are copied into an internal randomly permuted SoA layout
+	parallel_ransac(const point_type* pnts, size_t n, unsigned long long seed = 1)
+	{
+		std::vector<size_t> perm(n);
+		for (size_t i = 0; i < n; ++i)
+			perm[i] = i;
+		cgv::math::random rg(seed);
+		for (size_t i = n; i > 1; --i) {
+			unsigned j;
+			rg.uniform(0, (unsigned)(i - 1), j);
+			std::swap(perm[i - 1], perm[j]);
+		}
+		points.resize(n);
+		x.resize(n);
+		y.resize(n);
+		z.resize(n);
+		for (size_t i = 0; i < n; ++i) {
+			const point_type& p = pnts[perm[i]];
+			points[i] = p;
+			x[i] = p(0);
+			y[i] = p(1);
+			z[i] = p(2);
+		}
+	}
+	/// return the number of points
+	size_t get_nr_points() const { return points.size(); }
+	/// run ransac with the given configuration
+	result_type run(const config_type& cfg) const
+	{
+		shared_state S;
+		S.nr_started = 0;
+		S.required_iterations = cfg.max_iterations;
+		S.epsilon = cfg.sprt_initial_inlier_ratio;
+		S.delta = std::min(cfg.sprt_initial_delta, (T)0.5*S.epsilon);
+		S.delta_sum = 0;
+		S.delta_count = 0;
+		S.log_A = compute_sprt_log_threshold(S.epsilon, S.delta, (T)points.size());
+		if (points.size() < Model::sample_size || cfg.batch_size == 0)
+			return S.result;
+		unsigned nr_threads = cgv::utils::get_nr_parallel_tasks_threads(cfg.nr_threads);
+		cgv::utils::parallel_tasks(nr_threads, nr_threads, [&](size_t i) { work(cfg, S, unsigned(i)); });
+		return S.result;
+	}
+	/// collect all points within inlier_threshold of model m
+	void get_inliers(const model_type& m, T inlier_threshold, std::vector<point_type>& inliers) const
+	{
+		std::vector<T> r(256);
+		collect_inliers(m, inlier_threshold, r, inliers, 256);
+	}
+};
+
+/// convenience function for parallel ransac plane detection in a point set
+template <typename T>
+parallel_ransac_result<fvec<T,4> > parallel_ransac_plane_fit(const fvec<T,3>* points, size_t n, const parallel_ransac_config<T>& cfg)
+{
+	parallel_ransac<ransac_plane_model<T> > engine(points, n, cfg.seed);
+	return engine.run(cfg);
+}
+
+/// convenience function for parallel ransac sphere detection in a point set
+template <typename T>
+parallel_ransac_result<fvec<T,4> > parallel_ransac_sphere_fit(const fvec<T,3>* points, size_t n, const parallel_ransac_config<T>& cfg)
+{
+	parallel_ransac<ransac_sphere_model<T> > engine(points, n, cfg.seed);
+	return engine.run(cfg);
+}
+
+	}
+}
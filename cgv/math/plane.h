@@ -2,7 +2,10 @@
 #include <cgv/math/vec.h>
 #include <cgv/math/point_operations.h>
 #include <cgv/math/eig.h>
+#include <cgv/math/random.h>
+#include <cgv/math/ransac.h>
 #include <algorithm>
+#include <limits>
 
 namespace cgv{
 	namespace math{
@@ -87,23 +90,24 @@ vec<T> tls_plane_fit(const mat<T>& points)
 ///d_max... threshold distance 
 ///p_surety... surety to compute number needed samples 
 ///if m_sac flag is true m-estimator cost function is used
-///if loransac flag is true 
+///if loransac flag is true each hypothesis is refit to its inliers before its error is evaluated
+///see parallel_ransac.h for a multi-threaded version with early termination
 template <typename T>
-vec<T> ransac_plane_fit(const mat<T>& points,const T p_out=0.8, const T d_max=0.001, const T p_surety = 0.99, bool msac=true)
+vec<T> ransac_plane_fit(const mat<T>& points, T p_out=0.8, const T d_max=0.001, const T p_surety = 0.99, bool msac=true, bool loransac=false)
 {
-	assert(points.nrows == 3);
+	assert(points.nrows() == 3);
 	vec<T> plane(4);
 
 	vec<unsigned int> ind;
 	vec<T> p1,p2,p3,dists(points.ncols());
 	cgv::math::random rg;
-	unsigned n = points.ncols;
-	unsigned max_iter = num_ransac_iterations(3,p_out,psurety);
+	unsigned n = points.ncols();
+	unsigned max_iter = num_ransac_iterations(3,p_out,p_surety);
 	unsigned num_inlier = (unsigned)::ceil((1-p_out)*points.ncols());
 	
 	T error = std::numeric_limits<T>::max();
 	
-	for(unsigned i = 0; i < max_iter; i++)
+	for(unsigned iter = 0; iter < max_iter; iter++)
 	{
 		//random sample
 		do
@@ -113,13 +117,13 @@ vec<T> ransac_plane_fit(const mat<T>& points,const T p_out=0.8, const T d_max=0.
 			p2 = points.col(ind(1));
 			p3 = points.col(ind(2));
 		}
-		while(fabs(length(cross(q2-q1,q3-q1)))<0.001);
+		while(fabs(length(cross(p2-p1,p3-p1)))<0.001);
 		
 		//fit
 		vec<T> pl = plane_fit(p1,p2,p3);
 		
 		//consensus
-		int n_inlier=0;
+		unsigned n_inlier=0;
 		T e = 0;
 		
 		for(unsigned i = 0; i < points.ncols(); i++)
@@ -133,7 +137,7 @@ vec<T> ransac_plane_fit(const mat<T>& points,const T p_out=0.8, const T d_max=0.
 			}
 			else
 			{
-				e += dmax;
+				e += d_max;
 			}
 		}
 
@@ -141,32 +145,32 @@ vec<T> ransac_plane_fit(const mat<T>& points,const T p_out=0.8, const T d_max=0.
 		if(loransac && n_inlier > 3)
 		{
 			mat<T> inliers(3,n_inlier);
-			int j=0;
-			n_inlier=0;
+			unsigned j=0;
 			for(unsigned i = 0; i < points.ncols(); i++)
 			{
 				if(dists(i) < d_max)
 				{ 
-					n_inlier++;
 					inliers.set_col(j,points.col(i));
 					j++;
 				}
 			}
-			pl = plane_fit(inliers)
+			pl = tls_plane_fit(inliers);
 
 			//recompute error
+			n_inlier = 0;
+			e = 0;
 			for(unsigned i = 0; i < points.ncols(); i++)
 			{
 				dists(i) = std::abs(plane_val(pl,points.col(i)));	
 				if(dists(i) < d_max)
 				{
-				
+					n_inlier++;
 					if(msac)
 						e += dists(i);
 				}
 				else
 				{
-					e += dmax;
+					e += d_max;
 				}
 			}
 		}
@@ -181,7 +185,8 @@ vec<T> ransac_plane_fit(const mat<T>& points,const T p_out=0.8, const T d_max=0.
 		if(n_inlier >= num_inlier)
 		{
 			p_out = (T)1-(T)n_inlier/(T)points.ncols();
-			max_iter = num_ransac_iterations(3,p_out,psurety);	
+			num_inlier = n_inlier;
+			max_iter = std::min(max_iter, num_ransac_iterations(3,p_out,p_surety));
 		}
 	}
 	return plane;
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <cgv/math/fvec.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace cgv{
+	namespace math{
+
+/** pyramid of minimum and maximum value locations over a strided series of values that answers range queries in
+	logarithmic time. Level 0 stores the indices of the smallest and largest value of each block of block_size
+	consecutive values and each further level merges pairs of entries of the previous level. The values themselves are
+	not copied and need to be passed to all functions. Appending values and changing value ranges only recompute the
+	affected blocks and their ancestors, and dropping whole blocks from the front only shifts level 0 and rebuilds the
+	small upper levels, which supports sliding windows over streamed series. */
+template <typename T = float>
+class min_max_pyramid
+{
+public:
+	/// indices of minimum and maximum values of the entries of one level
+	struct level
+	{
+		/// index of smallest value per entry
+		std::vector<size_t> min_index;
+		/// index of largest value per entry
+		std::vector<size_t> max_index;
+		/// return number of entries
+		size_t get_nr_entries() const { return min_index.size(); }
+	};
+protected:
+	/// number of values per level 0 entry
+	size_t block_size;
+	/// number of covered values
+	size_t nr_values;
+	/// levels from finest to coarsest
+	std::vector<level> levels;
+	/// merge the value locations j_min and j_max into i_min and i_max
+	static void merge(const T* values, size_t stride, size_t j_min, size_t j_max, size_t& i_min, size_t& i_max)
+	{
+		if (values[j_min*stride] < values[i_min*stride])
+			i_min = j_min;
+		if (values[j_max*stride] > values[i_max*stride])
+			i_max = j_max;
+	}
+	/// scan the values in [begin,end) and merge them into i_min and i_max
+	static void scan(const T* values, size_t stride, size_t begin, size_t end, size_t& i_min, size_t& i_max)
+	{
+		T v_min = values[i_min*stride], v_max = values[i_max*stride];
+		for (size_t i = begin; i < end; ++i) {
+			T v = values[i*stride];
+			if (v < v_min) { v_min = v; i_min = i; }
+			if (v > v_max) { v_max = v; i_max = i; }
+		}
+	}
+	/// recompute level 0 entries [b0,b1)
+	void compute_blocks(const T* values, size_t stride, size_t b0, size_t b1)
+	{
+		level& l = levels[0];
+		for (size_t b = b0; b < b1; ++b) {
+			size_t begin = b*block_size;
+			size_t i_min = begin, i_max = begin;
+			scan(values, stride, begin + 1, std::min(nr_values, begin + block_size), i_min, i_max);
+			l.min_index[b] = i_min;
+			l.max_index[b] = i_max;
+		}
+	}
+	/// resize levels to the current number of values
+	void resize_levels()
+	{
+		size_t n = (nr_values + block_size - 1) / block_size;
+		unsigned li = 0;
+		do {
+			if (li == levels.size())
+				levels.push_back(level());
+			levels[li].min_index.resize(n);
+			levels[li].max_index.resize(n);
+			++li;
+			n = (n + 1) / 2;
+		} while (levels[li - 1].get_nr_entries() > 1);
+		levels.resize(li);
+	}
+	/// recompute entries [b0,b1) of all levels above level 0 from their children, where b0 and b1 refer to level 0
+	void compute_parents(const T* values, size_t stride, size_t b0, size_t b1)
+	{
+		for (unsigned li = 1; li < levels.size(); ++li) {
+			b0 /= 2;
+			b1 = (b1 + 1) / 2;
+			const level& c = levels[li - 1];
+			level& l = levels[li];
+			for (size_t b = b0; b < b1; ++b) {
+				size_t i_min = c.min_index[2 * b], i_max = c.max_index[2 * b];
+				if (2 * b + 1 < c.get_nr_entries())
+					merge(values, stride, c.min_index[2 * b + 1], c.max_index[2 * b + 1], i_min, i_max);
+				l.min_index[b] = i_min;
+				l.max_index[b] = i_max;
+			}
+		}
+	}
+public:
+	/// construct empty pyramid
+	min_max_pyramid(size_t _block_size = 64) : block_size(_block_size), nr_values(0) {}
+	/// build pyramid over n values that are stride elements apart
+	void build(const T* values, size_t n, size_t stride = 1, size_t _block_size = 0)
+	{
+		if (_block_size > 0)
+			block_size = _block_size;
+		levels.clear();
+		nr_values = n;
+		if (n == 0)
+			return;
+		resize_levels();
+		compute_blocks(values, stride, 0, levels[0].get_nr_entries());
+		compute_parents(values, stride, 0, levels[0].get_nr_entries());
+	}
+	/// extend pyramid to the first n values after values have been appended to the series
+	void append(const T* values, size_t n, size_t stride = 1)
+	{
+		if (n <= nr_values)
+			return;
+		size_t b0 = nr_values / block_size;
+		nr_values = n;
+		resize_levels();
+		compute_blocks(values, stride, b0, levels[0].get_nr_entries());
+		compute_parents(values, stride, b0, levels[0].get_nr_entries());
+	}
+	/// recompute the pyramid after the values in [start,start+count) have changed
+	void update(const T* values, size_t start, size_t count, size_t stride = 1)
+	{
+		if (start >= nr_values || count == 0)
+			return;
+		size_t b0 = start / block_size;
+		size_t b1 = std::min(levels[0].get_nr_entries(), (std::min(nr_values, start + count) + block_size - 1) / block_size);
+		compute_blocks(values, stride, b0, b1);
+		compute_parents(values, stride, b0, b1);
+	}
+	/// remove the first nr_blocks*block_size values, where values points to the series after removal
+	void drop_front_blocks(const T* values, size_t nr_blocks, size_t stride = 1)
+	{
+		if (nr_blocks == 0)
+			return;
+		size_t nr_dropped = std::min(nr_values, nr_blocks*block_size);
+		nr_blocks = (nr_dropped + block_size - 1) / block_size;
+		level& l = levels[0];
+		l.min_index.erase(l.min_index.begin(), l.min_index.begin() + nr_blocks);
+		l.max_index.erase(l.max_index.begin(), l.max_index.begin() + nr_blocks);
+		for (size_t b = 0; b < l.get_nr_entries(); ++b) {
+			l.min_index[b] -= nr_dropped;
+			l.max_index[b] -= nr_dropped;
+		}
+		nr_values -= nr_dropped;
+		if (nr_values == 0) {
+			levels.clear();
+			return;
+		}
+		resize_levels();
+		compute_parents(values, stride, 0, levels[0].get_nr_entries());
+	}
+	/// find indices of smallest and largest value in [begin,end) and return false if range is empty
+	bool find(const T* values, size_t begin, size_t end, size_t& i_min, size_t& i_max, size_t stride = 1) const
+	{
+		end = std::min(end, nr_values);
+		if (begin >= end)
+			return false;
+		i_min = i_max = begin;
+		size_t bb = (begin + block_size - 1) / block_size, be = end / block_size;
+		if (bb >= be) {
+			scan(values, stride, begin + 1, end, i_min, i_max);
+			return true;
+		}
+		scan(values, stride, begin + 1, bb*block_size, i_min, i_max);
+		scan(values, stride, be*block_size, end, i_min, i_max);
+		for (unsigned li = 0; bb < be; ++li, bb /= 2, be /= 2) {
+			const level& l = levels[li];
+			if (bb & 1) {
+				merge(values, stride, l.min_index[bb], l.max_index[bb], i_min, i_max);
+				++bb;
+			}
+			if (be & 1) {
+				--be;
+				merge(values, stride, l.min_index[be], l.max_index[be], i_min, i_max);
+			}
+		}
+		return true;
+	}
+	/// return index of smallest value in the series, which is only valid for non empty series
+	size_t get_min_index() const { return levels.back().min_index[0]; }
+	/// return index of largest value in the series, which is only valid for non empty series
+	size_t get_max_index() const { return levels.back().max_index[0]; }
+	/// return number of covered values
+	size_t get_nr_values() const { return nr_values; }
+	/// return number of values per level 0 entry
+	size_t get_block_size() const { return block_size; }
+	/// return number of levels
+	unsigned get_nr_levels() const { return unsigned(levels.size()); }
+	/// return the li-th level
+	const level& get_level(unsigned li) const { return levels[li]; }
+};
+
+/** reduce the samples of a series that is sorted by x to the view interval [x_min,x_max] divided into nr_columns
+	columns of equal width, typically one per pixel. Of each column the first, smallest, largest and last sample are
+	kept in series order, such that a line strip through the result rasterizes like the full series. One sample to
+	either side of the view is kept to connect lines to the border. The pyramid needs to be built over the y
+	coordinates of the samples. If the view contains fewer than 4*nr_columns samples, they are copied. Returns the
+	number of samples of the series that are inside of the view. */
+template <typename T>
+size_t decimate_min_max(const fvec<T, 2>* samples, size_t n, const min_max_pyramid<T>& pyramid, T x_min, T x_max, unsigned nr_columns, std::vector<fvec<T, 2> >& result)
+{
+	struct less_x {
+		bool operator () (const fvec<T, 2>& s, T x) const { return s[0] < x; }
+		bool operator () (T x, const fvec<T, 2>& s) const { return x < s[0]; }
+	};
+	result.clear();
+	size_t begin = std::lower_bound(samples, samples + n, x_min, less_x()) - samples;
+	size_t end = std::upper_bound(samples + begin, samples + n, x_max, less_x()) - samples;
+	size_t nr_visible = end - begin;
+	if (nr_columns == 0 || nr_visible <= 4 * size_t(nr_columns)) {
+		result.assign(samples + (begin > 0 ? begin - 1 : 0), samples + (end < n ? end + 1 : n));
+		return nr_visible;
+	}
+	const T* y_values = &samples[0][1];
+	if (begin > 0)
+		result.push_back(samples[begin - 1]);
+	T column_width = (x_max - x_min) / nr_columns;
+	size_t j = begin;
+	for (unsigned c = 0; c < nr_columns && j < end; ++c) {
+		size_t j_end = end;
+		if (c + 1 < nr_columns)
+			j_end = std::lower_bound(samples + j, samples + end, x_min + (c + 1)*column_width, less_x()) - samples;
+		if (j_end - j <= 4) {
+			result.insert(result.end(), samples + j, samples + j_end);
+			j = j_end;
+			continue;
+		}
+		size_t i_min, i_max;
+		pyramid.find(y_values, j, j_end, i_min, i_max, 2);
+		size_t indices[4] = { j, std::min(i_min, i_max), std::max(i_min, i_max), j_end - 1 };
+		result.push_back(samples[indices[0]]);
+		for (unsigned k = 1; k < 4; ++k)
+			if (indices[k] != indices[k - 1])
+				result.push_back(samples[indices[k]]);
+		j = j_end;
+	}
+	if (end < n)
+		result.push_back(samples[end]);
+	return nr_visible;
+}
+
+/** reduce n samples of a series to nr_out samples with the largest triangle three buckets method. The first and last
+	sample are kept and from each of the nr_out-2 buckets in between the sample is selected that spans the largest
+	triangle with the previously selected sample and the average of the next bucket. If nr_out is not smaller than n
+	or smaller than 3, the samples are copied. */
+template <typename T>
+void decimate_lttb(const fvec<T, 2>* samples, size_t n, size_t nr_out, std::vector<fvec<T, 2> >& result)
+{
+	result.clear();
+	if (nr_out >= n || nr_out < 3) {
+		result.assign(samples, samples + n);
+		return;
+	}
+	result.reserve(nr_out);
+	result.push_back(samples[0]);
+	double bucket_size = double(n - 2) / (nr_out - 2);
+	size_t a = 0;
+	for (size_t b = 0; b < nr_out - 2; ++b) {
+		size_t begin = size_t(b*bucket_size) + 1;
+		size_t end = std::min(n - 1, size_t((b + 1)*bucket_size) + 1);
+		// average of next bucket or the last sample
+		size_t next_begin = end;
+		size_t next_end = std::min(n, size_t((b + 2)*bucket_size) + 1);
+		if (b + 1 == nr_out - 2) {
+			next_begin = n - 1;
+			next_end = n;
+		}
+		T avg_x = 0, avg_y = 0;
+		for (size_t i = next_begin; i < next_end; ++i) {
+			avg_x += samples[i][0];
+			avg_y += samples[i][1];
+		}
+		avg_x /= T(next_end - next_begin);
+		avg_y /= T(next_end - next_begin);
+		// select sample spanning the largest triangle
+		T ax = samples[a][0], ay = samples[a][1];
+		T max_area = -1;
+		size_t selected = begin;
+		for (size_t i = begin; i < end; ++i) {
+			T area = std::abs((ax - avg_x)*(samples[i][1] - ay) - (ax - samples[i][0])*(avg_y - ay));
+			if (area > max_area) {
+				max_area = area;
+				selected = i;
+			}
+		}
+		result.push_back(samples[selected]);
+		a = selected;
+	}
+	result.push_back(samples[n - 1]);
+}
+
+	}
+}
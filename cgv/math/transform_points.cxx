@@ -0,0 +1,274 @@
+#include "transform_points.h"
+#include <cstring>
+
+namespace cgv {
+	namespace math {
+
+namespace {
+
+/// coefficients of a transformation of three dimensional points, where the fourth row is used for projective transformations only
+template <typename T>
+struct transform_kernel
+{
+	/// rows of the linear part
+	T m[4][3];
+	/// translation
+	T t[4];
+	/// whether translation is added
+	bool translate;
+	/// whether result is divided by the fourth coordinate
+	bool project;
+	/// construct linear transformation
+	transform_kernel(const fmat<T, 3, 3>& L) : translate(false), project(false) {
+		for (unsigned i = 0; i < 4; ++i) {
+			for (unsigned j = 0; j < 3; ++j)
+				m[i][j] = i < 3 ? L(i, j) : T(0);
+			t[i] = T(0);
+		}
+	}
+	/// set translation
+	void set_translation(const T* _t) {
+		for (unsigned i = 0; i < 3; ++i)
+			t[i] = _t[i];
+		translate = true;
+	}
+	/// construct from first rows of a matrix with at least four columns
+	template <cgv::type::uint32_type N>
+	transform_kernel(const fmat<T, N, 4>& M, bool _project) : translate(true), project(_project) {
+		for (unsigned i = 0; i < 4; ++i) {
+			for (unsigned j = 0; j < 3; ++j)
+				m[i][j] = (i < 3 || project) ? M(i, j) : T(0);
+			t[i] = (i < 3 || project) ? M(i, 3) : T(0);
+		}
+	}
+};
+
+/// transform a single point in the same order as the vectorized implementations
+template <typename T>
+inline void transform_point(const transform_kernel<T>& k, const T* p, T* q)
+{
+	T x = p[0], y = p[1], z = p[2];
+	T r[4];
+	for (unsigned i = 0; i < (k.project ? 4u : 3u); ++i) {
+		r[i] = k.m[i][0] * x;
+		r[i] += k.m[i][1] * y;
+		r[i] += k.m[i][2] * z;
+		if (k.translate)
+			r[i] += k.t[i];
+	}
+	if (k.project) {
+		T rw = T(1) / r[3];
+		for (unsigned i = 0; i < 3; ++i)
+			r[i] *= rw;
+	}
+	q[0] = r[0];
+	q[1] = r[1];
+	q[2] = r[2];
+}
+
+/// transform points one by one
+template <typename T>
+void transform_scalar(const transform_kernel<T>& k, const T* in, T* out, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		transform_point(k, in + 3 * i, out + 3 * i);
+}
+
+#if defined(CGV_MATH_SSE2)
+
+/// transform four interleaved float points with SSE
+template <bool translate, bool project>
+inline void transform_block(const __m128 (&m)[4][3], const __m128 (&t)[4], const float* p, float* q)
+{
+	__m128 a = _mm_loadu_ps(p), b = _mm_loadu_ps(p + 4), c = _mm_loadu_ps(p + 8);
+	// deinterleave x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+	__m128 X = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 2, 3, 0)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+	__m128 Y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 0, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+	__m128 Z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+	__m128 r[4];
+	for (unsigned i = 0; i < (project ? 4u : 3u); ++i) {
+		r[i] = _mm_mul_ps(m[i][0], X);
+		r[i] = _mm_add_ps(r[i], _mm_mul_ps(m[i][1], Y));
+		r[i] = _mm_add_ps(r[i], _mm_mul_ps(m[i][2], Z));
+		if (translate)
+			r[i] = _mm_add_ps(r[i], t[i]);
+	}
+	if (project) {
+		__m128 rw = _mm_div_ps(_mm_set1_ps(1.0f), r[3]);
+		for (unsigned i = 0; i < 3; ++i)
+			r[i] = _mm_mul_ps(r[i], rw);
+	}
+	// interleave again
+	_mm_storeu_ps(q, _mm_shuffle_ps(_mm_shuffle_ps(r[0], r[1], _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(r[2], r[0], _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+	_mm_storeu_ps(q + 4, _mm_shuffle_ps(_mm_shuffle_ps(r[1], r[2], _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(r[0], r[1], _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+	_mm_storeu_ps(q + 8, _mm_shuffle_ps(_mm_shuffle_ps(r[2], r[0], _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(r[1], r[2], _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+/// transform float points in blocks of four, where the remaining points are processed in a padded block such that all points are rounded alike
+template <bool translate, bool project>
+void transform_simd(const transform_kernel<float>& k, const float* in, float* out, size_t n)
+{
+	__m128 m[4][3], t[4];
+	for (unsigned i = 0; i < 4; ++i) {
+		for (unsigned j = 0; j < 3; ++j)
+			m[i][j] = _mm_set1_ps(k.m[i][j]);
+		t[i] = _mm_set1_ps(k.t[i]);
+	}
+	size_t nr_blocks = n / 4;
+	for (size_t b = 0; b < nr_blocks; ++b)
+		transform_block<translate, project>(m, t, in + 12 * b, out + 12 * b);
+	size_t nr_remaining = n - 4 * nr_blocks;
+	if (nr_remaining > 0) {
+		float tmp[12] = { 0 };
+		std::memcpy(tmp, in + 12 * nr_blocks, 3 * nr_remaining * sizeof(float));
+		transform_block<translate, project>(m, t, tmp, tmp);
+		std::memcpy(out + 12 * nr_blocks, tmp, 3 * nr_remaining * sizeof(float));
+	}
+}
+
+#define CGV_MATH_TRANSFORM_SIMD_FLOAT
+
+#elif defined(CGV_MATH_NEON) && defined(__aarch64__)
+
+/// transform float points in blocks of four with NEON, where the remaining points are processed in a padded block
+template <bool translate, bool project>
+void transform_simd(const transform_kernel<float>& k, const float* in, float* out, size_t n)
+{
+	float32x4_t m[4][3], t[4];
+	for (unsigned i = 0; i < 4; ++i) {
+		for (unsigned j = 0; j < 3; ++j)
+			m[i][j] = vdupq_n_f32(k.m[i][j]);
+		t[i] = vdupq_n_f32(k.t[i]);
+	}
+	float tmp[12] = { 0 };
+	for (size_t b = 0; b < n; b += 4) {
+		const float* p = in + 3 * b;
+		float* q = out + 3 * b;
+		size_t nr_points = n - b < 4 ? n - b : 4;
+		if (nr_points < 4) {
+			std::memcpy(tmp, p, 3 * nr_points * sizeof(float));
+			p = q = tmp;
+		}
+		float32x4x3_t v = vld3q_f32(p);
+		float32x4_t r[4];
+		for (unsigned i = 0; i < (project ? 4u : 3u); ++i) {
+			r[i] = vmulq_f32(m[i][0], v.val[0]);
+			r[i] = vaddq_f32(r[i], vmulq_f32(m[i][1], v.val[1]));
+			r[i] = vaddq_f32(r[i], vmulq_f32(m[i][2], v.val[2]));
+			if (translate)
+				r[i] = vaddq_f32(r[i], t[i]);
+		}
+		if (project) {
+			float32x4_t rw = vdivq_f32(vdupq_n_f32(1.0f), r[3]);
+			for (unsigned i = 0; i < 3; ++i)
+				r[i] = vmulq_f32(r[i], rw);
+		}
+		for (unsigned i = 0; i < 3; ++i)
+			v.val[i] = r[i];
+		vst3q_f32(q, v);
+		if (nr_points < 4)
+			std::memcpy(out + 3 * b, tmp, 3 * nr_points * sizeof(float));
+	}
+}
+
+#define CGV_MATH_TRANSFORM_SIMD_FLOAT
+
+#endif
+
+#if defined(CGV_MATH_TRANSFORM_SIMD_FLOAT)
+/// dispatch to the vectorized implementation specialized to the kind of transformation
+void transform_simd(const transform_kernel<float>& k, const float* in, float* out, size_t n)
+{
+	if (k.project)
+		transform_simd<true, true>(k, in, out, n);
+	else if (k.translate)
+		transform_simd<true, false>(k, in, out, n);
+	else
+		transform_simd<false, false>(k, in, out, n);
+}
+#endif
+
+void apply(const transform_kernel<float>& k, const fvec<float, 3>* in, fvec<float, 3>* out, size_t n)
+{
+	static_assert(sizeof(fvec<float, 3>) == 3 * sizeof(float), "fvec<float,3> must be tightly packed");
+#if defined(CGV_MATH_TRANSFORM_SIMD_FLOAT)
+	transform_simd(k, reinterpret_cast<const float*>(in), reinterpret_cast<float*>(out), n);
+#else
+	transform_scalar(k, reinterpret_cast<const float*>(in), reinterpret_cast<float*>(out), n);
+#endif
+}
+
+void apply(const transform_kernel<double>& k, const fvec<double, 3>* in, fvec<double, 3>* out, size_t n)
+{
+	static_assert(sizeof(fvec<double, 3>) == 3 * sizeof(double), "fvec<double,3> must be tightly packed");
+	transform_scalar(k, reinterpret_cast<const double*>(in), reinterpret_cast<double*>(out), n);
+}
+
+}
+
+void transform_points(const fmat<float, 3, 3>& L, const fvec<float, 3>& t, const fvec<float, 3>* in, fvec<float, 3>* out, size_t n)
+{
+	transform_kernel<float> k(L);
+	k.set_translation(&t(0));
+	apply(k, in, out, n);
+}
+
+void transform_points(const fmat<double, 3, 3>& L, const fvec<double, 3>& t, const fvec<double, 3>* in, fvec<double, 3>* out, size_t n)
+{
+	transform_kernel<double> k(L);
+	k.set_translation(&t(0));
+	apply(k, in, out, n);
+}
+
+void transform_points(const fmat<float, 3, 4>& M, const fvec<float, 3>* in, fvec<float, 3>* out, size_t n)
+{
+	apply(transform_kernel<float>(M, false), in, out, n);
+}
+
+void transform_points(const fmat<double, 3, 4>& M, const fvec<double, 3>* in, fvec<double, 3>* out, size_t n)
+{
+	apply(transform_kernel<double>(M, false), in, out, n);
+}
+
+void transform_points(const fmat<float, 4, 4>& M, const fvec<float, 3>* in, fvec<float, 3>* out, size_t n)
+{
+	apply(transform_kernel<float>(M, false), in, out, n);
+}
+
+void transform_points(const fmat<double, 4, 4>& M, const fvec<double, 3>* in, fvec<double, 3>* out, size_t n)
+{
+	apply(transform_kernel<double>(M, false), in, out, n);
+}
+
+void transform_points_projective(const fmat<float, 4, 4>& M, const fvec<float, 3>* in, fvec<float, 3>* out, size_t n)
+{
+	apply(transform_kernel<float>(M, true), in, out, n);
+}
+
+void transform_points_projective(const fmat<double, 4, 4>& M, const fvec<double, 3>* in, fvec<double, 3>* out, size_t n)
+{
+	apply(transform_kernel<double>(M, true), in, out, n);
+}
+
+void transform_vectors(const fmat<float, 3, 3>& L, const fvec<float, 3>* in, fvec<float, 3>* out, size_t n)
+{
+	apply(transform_kernel<float>(L), in, out, n);
+}
+
+void transform_vectors(const fmat<double, 3, 3>& L, const fvec<double, 3>* in, fvec<double, 3>* out, size_t n)
+{
+	apply(transform_kernel<double>(L), in, out, n);
+}
+
+void rotate_points(const quaternion<float>& q, const fvec<float, 3>* in, fvec<float, 3>* out, size_t n)
+{
+	apply(transform_kernel<float>(q.get_matrix()), in, out, n);
+}
+
+void rotate_points(const quaternion<double>& q, const fvec<double, 3>* in, fvec<double, 3>* out, size_t n)
+{
+	apply(transform_kernel<double>(q.get_matrix()), in, out, n);
+}
+
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include "fmat.h"
+#include "quaternion.h"
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace math {
+
+/** transformation of arrays of points and vectors, where float points are processed in blocks of four
+	with SSE or NEON instructions if available.
+
+	All functions transform n elements from in to out, where in and out may point to the same
+	array. Coordinates are accumulated in the same order as by the matrix vector products of fmat
+	and without fused multiply add, such that results equal the ones of transforming each element
+	separately, i.e. transform_points(L, t, in, out, n) computes out[i] = L*in[i] + t. */
+
+/// transform points with linear transformation L followed by translation t
+extern CGV_API void transform_points(const fmat<float, 3, 3>& L, const fvec<float, 3>& t, const fvec<float, 3>* in, fvec<float, 3>* out, size_t n);
+/// transform points with linear transformation L followed by translation t
+extern CGV_API void transform_points(const fmat<double, 3, 3>& L, const fvec<double, 3>& t, const fvec<double, 3>* in, fvec<double, 3>* out, size_t n);
+/// transform points with affine transformation given as 3x4 matrix
+extern CGV_API void transform_points(const fmat<float, 3, 4>& M, const fvec<float, 3>* in, fvec<float, 3>* out, size_t n);
+/// transform points with affine transformation given as 3x4 matrix
+extern CGV_API void transform_points(const fmat<double, 3, 4>& M, const fvec<double, 3>* in, fvec<double, 3>* out, size_t n);
+/// transform points with affine transformation given as homogeneous matrix whose last row is ignored
+extern CGV_API void transform_points(const fmat<float, 4, 4>& M, const fvec<float, 3>* in, fvec<float, 3>* out, size_t n);
+/// transform points with affine transformation given as homogeneous matrix whose last row is ignored
+extern CGV_API void transform_points(const fmat<double, 4, 4>& M, const fvec<double, 3>* in, fvec<double, 3>* out, size_t n);
+/// transform points with projective transformation and divide by the resulting w-coordinate, which is done by multiplication with its reciprocal
+extern CGV_API void transform_points_projective(const fmat<float, 4, 4>& M, const fvec<float, 3>* in, fvec<float, 3>* out, size_t n);
+/// transform points with projective transformation and divide by the resulting w-coordinate, which is done by multiplication with its reciprocal
+extern CGV_API void transform_points_projective(const fmat<double, 4, 4>& M, const fvec<double, 3>* in, fvec<double, 3>* out, size_t n);
+/// transform vectors with linear transformation L, for normals pass the transposed inverse of the linear transformation of the points
+extern CGV_API void transform_vectors(const fmat<float, 3, 3>& L, const fvec<float, 3>* in, fvec<float, 3>* out, size_t n);
+/// transform vectors with linear transformation L, for normals pass the transposed inverse of the linear transformation of the points
+extern CGV_API void transform_vectors(const fmat<double, 3, 3>& L, const fvec<double, 3>* in, fvec<double, 3>* out, size_t n);
+/// rotate points or vectors with a unit quaternion, which is converted to a rotation matrix first such that results can differ from quaternion::apply() by rounding
+extern CGV_API void rotate_points(const quaternion<float>& q, const fvec<float, 3>* in, fvec<float, 3>* out, size_t n);
+/// rotate points or vectors with a unit quaternion, which is converted to a rotation matrix first such that results can differ from quaternion::apply() by rounding
+extern CGV_API void rotate_points(const quaternion<double>& q, const fvec<double, 3>* in, fvec<double, 3>* out, size_t n);
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -1,4 +1,13 @@
 #include "color_scale.h"
+#include <cgv/os/task_scheduler.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CGV_MEDIA_USE_SSE2
+#endif
 
 namespace cgv {
 	namespace media {
@@ -21,5 +30,196 @@ color<float,RGB> color_scale(double v, ColorScale cs)
 	return color<float,RGB>(0,0,0);
 }
 
+color_scale_lut::color_scale_lut(ColorScale cs, unsigned _resolution)
+{
+	v_min = 0;
+	v_max = 1;
+	mapping = CSM_LINEAR;
+	gamma = 1;
+	alpha = 255;
+	set_color_scale(cs, _resolution);
+}
+
+void color_scale_lut::set_color_scale(ColorScale cs, unsigned _resolution)
+{
+	scale_type = cs;
+	gradient_positions.clear();
+	gradient_colors.clear();
+	resolution = std::max(2u, _resolution);
+	compile();
+}
+
+void color_scale_lut::set_gradient(const std::vector<float>& positions, const std::vector<rgb_type>& colors, unsigned _resolution)
+{
+	size_t n = std::min(positions.size(), colors.size());
+	gradient_positions.assign(positions.begin(), positions.begin() + n);
+	gradient_colors.assign(colors.begin(), colors.begin() + n);
+	resolution = std::max(2u, _resolution);
+	compile();
+}
+
+void color_scale_lut::set_value_range(float _v_min, float _v_max, ColorScaleMapping _mapping, float _gamma)
+{
+	v_min = _v_min;
+	v_max = _v_max;
+	mapping = _mapping;
+	gamma = _gamma;
+	compile();
+}
+
+void color_scale_lut::set_alpha(unsigned char _alpha)
+{
+	alpha = _alpha;
+	for (size_t i = 0; i < table_rgba8.size(); ++i)
+		table_rgba8[i].alpha() = alpha;
+}
+
+color_scale_lut::rgb_type color_scale_lut::evaluate(float t) const
+{
+	if (gradient_colors.empty())
+		return color_scale(t, scale_type);
+	size_t i = std::upper_bound(gradient_positions.begin(), gradient_positions.end(), t) - gradient_positions.begin();
+	if (i == 0)
+		return gradient_colors.front();
+	if (i == gradient_positions.size())
+		return gradient_colors.back();
+	float d = gradient_positions[i] - gradient_positions[i - 1];
+	float l = d > 0 ? (t - gradient_positions[i - 1]) / d : 1.0f;
+	return (1 - l)*gradient_colors[i - 1] + l*gradient_colors[i];
+}
+
+void color_scale_lut::compile()
+{
+	// the log mapping is applied per value and the gamma mapping is baked into the table
+	float f_min = v_min, f_max = v_max;
+	if (mapping == CSM_LOG) {
+		f_min = std::log(std::max(v_min, std::numeric_limits<float>::min()));
+		f_max = std::log(std::max(v_max, std::numeric_limits<float>::min()));
+	}
+	offset = f_min;
+	scale = f_max != f_min ? (resolution - 1) / (f_max - f_min) : 0.0f;
+	table.resize(resolution);
+	table_rgb8.resize(resolution);
+	table_rgba8.resize(resolution);
+	for (unsigned i = 0; i < resolution; ++i) {
+		float t = float(i) / (resolution - 1);
+		if (mapping == CSM_GAMMA)
+			t = std::pow(t, gamma);
+		table[i] = evaluate(t);
+		for (unsigned c = 0; c < 3; ++c) {
+			float v = std::min(1.0f, std::max(0.0f, table[i][c]));
+			table_rgb8[i][c] = table_rgba8[i][c] = (unsigned char)(255 * v + 0.5f);
+		}
+		table_rgba8[i].alpha() = alpha;
+	}
+}
+
+unsigned color_scale_lut::get_index(double v) const
+{
+	float f = float(mapping == CSM_LOG ? std::log(v) : v);
+	float x = (f - offset)*scale + 0.5f;
+	// comparisons are written such that NaN maps to the first entry
+	if (!(x > 0))
+		return 0;
+	if (x > resolution - 1)
+		return resolution - 1;
+	return unsigned(x);
+}
+
+namespace {
+	/// compute table indices of n values that are stride bytes apart
+	template <typename T>
+	void compute_indices_scalar(const T* values, size_t n, size_t stride, bool use_log, float offset, float scale, unsigned max_index, int* indices)
+	{
+		const char* ptr = reinterpret_cast<const char*>(values);
+		for (size_t i = 0; i < n; ++i, ptr += stride) {
+			T v = *reinterpret_cast<const T*>(ptr);
+			float f = float(use_log ? std::log(v) : v);
+			float x = (f - offset)*scale + 0.5f;
+			indices[i] = !(x > 0) ? 0 : (x > max_index ? int(max_index) : int(x));
+		}
+	}
+	void compute_indices(const double* values, size_t n, size_t stride, bool use_log, float offset, float scale, unsigned max_index, int* indices)
+	{
+		compute_indices_scalar(values, n, stride, use_log, offset, scale, max_index, indices);
+	}
+	void compute_indices(const float* values, size_t n, size_t stride, bool use_log, float offset, float scale, unsigned max_index, int* indices)
+	{
+		size_t i = 0;
+#ifdef CGV_MEDIA_USE_SSE2
+		if (stride == sizeof(float) && !use_log) {
+			// max and min return their second argument for NaN, which maps NaN to the first entry
+			__m128 o = _mm_set1_ps(offset), s = _mm_set1_ps(scale), h = _mm_set1_ps(0.5f);
+			__m128 lo = _mm_setzero_ps(), hi = _mm_set1_ps(float(max_index));
+			for (; i + 4 <= n; i += 4) {
+				__m128 x = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(values + i), o), s), h);
+				x = _mm_min_ps(_mm_max_ps(x, lo), hi);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(indices + i), _mm_cvttps_epi32(x));
+			}
+		}
+#endif
+		compute_indices_scalar(reinterpret_cast<const float*>(reinterpret_cast<const char*>(values) + i*stride), n - i, stride, use_log, offset, scale, max_index, indices + i);
+	}
+}
+
+template <typename T, typename C>
+void color_scale_lut::map_values(const T* values, size_t count, size_t stride, C* colors, const std::vector<C>& tab, unsigned nr_threads) const
+{
+	if (stride == 0)
+		stride = sizeof(T);
+	const char* ptr = reinterpret_cast<const char*>(values);
+	const C* lut = &tab[0];
+	// values are processed in blocks whose indices fit into a buffer on the stack
+	const size_t block_size = 256;
+	const size_t blocks_per_task = 64;
+	size_t nr_blocks = (count + block_size - 1) / block_size;
+	auto process = [&](size_t b0, size_t b1) {
+		int indices[block_size];
+		for (size_t i0 = b0*block_size; i0 < std::min(count, b1*block_size); i0 += block_size) {
+			size_t n = std::min(block_size, count - i0);
+			compute_indices(reinterpret_cast<const T*>(ptr + i0*stride), n, stride, mapping == CSM_LOG, offset, scale, resolution - 1, indices);
+			C* c = colors + i0;
+			for (size_t i = 0; i < n; ++i)
+				c[i] = lut[indices[i]];
+		}
+	};
+	// small arrays are not worth the scheduling overhead
+	if (nr_threads == 1 || count < 65536) {
+		process(0, nr_blocks);
+		return;
+	}
+	cgv::os::parallel_for_ranges(0, nr_blocks, process, blocks_per_task);
+}
+
+void color_scale_lut::map(const float* values, size_t count, rgb_type* colors, size_t stride, unsigned nr_threads) const
+{
+	map_values(values, count, stride, colors, table, nr_threads);
+}
+
+void color_scale_lut::map(const float* values, size_t count, rgb8_type* colors, size_t stride, unsigned nr_threads) const
+{
+	map_values(values, count, stride, colors, table_rgb8, nr_threads);
+}
+
+void color_scale_lut::map(const float* values, size_t count, rgba8_type* colors, size_t stride, unsigned nr_threads) const
+{
+	map_values(values, count, stride, colors, table_rgba8, nr_threads);
+}
+
+void color_scale_lut::map(const double* values, size_t count, rgb_type* colors, size_t stride, unsigned nr_threads) const
+{
+	map_values(values, count, stride, colors, table, nr_threads);
+}
+
+void color_scale_lut::map(const double* values, size_t count, rgb8_type* colors, size_t stride, unsigned nr_threads) const
+{
+	map_values(values, count, stride, colors, table_rgb8, nr_threads);
+}
+
+void color_scale_lut::map(const double* values, size_t count, rgba8_type* colors, size_t stride, unsigned nr_threads) const
+{
+	map_values(values, count, stride, colors, table_rgba8, nr_threads);
+}
+
 	}
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "color.h"
+#include <vector>
 
 #include "lib_begin.h"
 
@@ -16,6 +17,93 @@ enum ColorScale {
 /// compute an rgb color according to the selected color scale
 extern CGV_API color<float,RGB> color_scale(double v, ColorScale cs = CS_TEMPERATURE);
 
+/// mapping of values to the unit interval that is applied before the color scale is evaluated
+enum ColorScaleMapping {
+	CSM_LINEAR, /// map [v_min,v_max] linearly
+	CSM_LOG,    /// map [v_min,v_max] logarithmically, which requires positive values
+	CSM_GAMMA   /// map [v_min,v_max] linearly and raise the result to the power gamma
+};
+
+/** precomputed lookup table of a color scale that maps arrays of values to colors. Each value is mapped to the
+	unit interval according to the value range and mapping, clamped and rounded to the nearest of the resolution
+	many table entries. The table is compiled from one of the predefined color scales or from a gradient of user
+	defined colors. Indices of contiguous float arrays are computed with SSE2 and large arrays are distributed over
+	threads. */
+class CGV_API color_scale_lut
+{
+public:
+	/// color type of float tables
+	typedef color<float,RGB> rgb_type;
+	/// color type of 8 bit tables without alpha
+	typedef color<unsigned char,RGB> rgb8_type;
+	/// color type of 8 bit tables with alpha
+	typedef color<unsigned char,RGB,OPACITY> rgba8_type;
+	/// default number of table entries
+	static const unsigned default_resolution = 4096;
+protected:
+	/// predefined color scale used if no gradient is set
+	ColorScale scale_type;
+	/// sorted positions of gradient colors in the unit interval
+	std::vector<float> gradient_positions;
+	/// gradient colors
+	std::vector<rgb_type> gradient_colors;
+	/// number of table entries
+	unsigned resolution;
+	/// value range
+	float v_min, v_max;
+	/// mapping of values to the unit interval
+	ColorScaleMapping mapping;
+	/// exponent used for CSM_GAMMA
+	float gamma;
+	/// alpha value of rgba8 colors
+	unsigned char alpha;
+	/// table index of a value v is (f(v)-offset)*scale where f is the identity or the logarithm
+	float offset, scale;
+	/// float table
+	std::vector<rgb_type> table;
+	/// 8 bit rgb table
+	std::vector<rgb8_type> table_rgb8;
+	/// 8 bit rgba table
+	std::vector<rgba8_type> table_rgba8;
+	/// evaluate color scale or gradient at position t of the unit interval
+	rgb_type evaluate(float t) const;
+	/// rebuild tables and index transformation
+	void compile();
+	/// map values with arbitrary stride to colors of the given table
+	template <typename T, typename C>
+	void map_values(const T* values, size_t count, size_t stride, C* colors, const std::vector<C>& tab, unsigned nr_threads) const;
+public:
+	/// construct table of predefined color scale for the value range [0,1]
+	color_scale_lut(ColorScale cs = CS_TEMPERATURE, unsigned _resolution = default_resolution);
+	/// select predefined color scale
+	void set_color_scale(ColorScale cs, unsigned _resolution = default_resolution);
+	/// compile a gradient that interpolates colors linearly between ascending positions in the unit interval
+	void set_gradient(const std::vector<float>& positions, const std::vector<rgb_type>& colors, unsigned _resolution = default_resolution);
+	/// set value range and mapping to the unit interval
+	void set_value_range(float _v_min, float _v_max, ColorScaleMapping _mapping = CSM_LINEAR, float _gamma = 1.0f);
+	/// set the alpha value of rgba8 colors
+	void set_alpha(unsigned char _alpha);
+	/// return number of table entries
+	unsigned get_resolution() const { return resolution; }
+	/// return table index of value v
+	unsigned get_index(double v) const;
+	/// return color of a single value
+	const rgb_type& lookup(double v) const { return table[get_index(v)]; }
+	/** map count values to colors, where stride is the distance between values in bytes and defaults to the
+		size of one value. Large arrays are mapped in parallel with the task scheduler of cgv_os unless nr_threads is 1. */
+	void map(const float* values, size_t count, rgb_type* colors, size_t stride = 0, unsigned nr_threads = 0) const;
+	/// map float values to 8 bit rgb colors
+	void map(const float* values, size_t count, rgb8_type* colors, size_t stride = 0, unsigned nr_threads = 0) const;
+	/// map float values to 8 bit rgba colors
+	void map(const float* values, size_t count, rgba8_type* colors, size_t stride = 0, unsigned nr_threads = 0) const;
+	/// map double values to float colors
+	void map(const double* values, size_t count, rgb_type* colors, size_t stride = 0, unsigned nr_threads = 0) const;
+	/// map double values to 8 bit rgb colors
+	void map(const double* values, size_t count, rgb8_type* colors, size_t stride = 0, unsigned nr_threads = 0) const;
+	/// map double values to 8 bit rgba colors
+	void map(const double* values, size_t count, rgba8_type* colors, size_t stride = 0, unsigned nr_threads = 0) const;
+};
+
 	}
 }
 
@@ -1,8 +1,65 @@
 #include "color_storage.h"
+#include <cstring>
 
 namespace cgv {
 	namespace media {
 
+		/// size in bytes of the color types in the order of the ColorType enum
+		static const size_t color_type_sizes[] = { sizeof(color_storage_types::rgb8), sizeof(color_storage_types::rgba8), sizeof(color_storage_types::rgb), sizeof(color_storage_types::rgba) };
+
+		/// convert a single color given by n1 components of type T1 to n2 components of type T2, where a missing alpha is set to one
+		template <typename T1, unsigned n1, typename T2, unsigned n2>
+		inline void convert_color_components(const T1* src, T2* dst)
+		{
+			for (unsigned c = 0; c < (n1 < n2 ? n1 : n2); ++c)
+				convert_color_component(src[c], dst[c]);
+			if (n2 > n1)
+				dst[n2 - 1] = color_one<T2>::value();
+		}
+
+		/// convert a range of colors, where densely packed colors are processed as flat component arrays that the compiler can vectorize
+		template <typename T1, unsigned n1, typename T2, unsigned n2>
+		void convert_color_range(const unsigned char* src_ptr, size_t src_stride, unsigned char* dst_ptr, size_t dst_stride, size_t count)
+		{
+			if (src_stride == n1*sizeof(T1) && dst_stride == n2*sizeof(T2)) {
+				const T1* src = reinterpret_cast<const T1*>(src_ptr);
+				T2* dst = reinterpret_cast<T2*>(dst_ptr);
+				// with equal number of components the colors form a single flat array of components
+				if (n1 == n2) {
+					for (size_t i = 0; i < count*n1; ++i)
+						convert_color_component(src[i], dst[i]);
+					return;
+				}
+				for (size_t i = 0; i < count; ++i, src += n1, dst += n2)
+					convert_color_components<T1, n1, T2, n2>(src, dst);
+				return;
+			}
+			for (size_t i = 0; i < count; ++i, src_ptr += src_stride, dst_ptr += dst_stride)
+				convert_color_components<T1, n1, T2, n2>(reinterpret_cast<const T1*>(src_ptr), reinterpret_cast<T2*>(dst_ptr));
+		}
+
+		void convert_colors(const void* src_ptr, ColorType src_type, size_t src_stride,
+			void* dst_ptr, ColorType dst_type, size_t dst_stride, size_t count)
+		{
+			typedef void(*convert_function)(const unsigned char*, size_t, unsigned char*, size_t, size_t);
+			typedef unsigned char uint8;
+			static const convert_function convert_functions[4][4] = {
+				{ &convert_color_range<uint8, 3, uint8, 3>, &convert_color_range<uint8, 3, uint8, 4>, &convert_color_range<uint8, 3, float, 3>, &convert_color_range<uint8, 3, float, 4> },
+				{ &convert_color_range<uint8, 4, uint8, 3>, &convert_color_range<uint8, 4, uint8, 4>, &convert_color_range<uint8, 4, float, 3>, &convert_color_range<uint8, 4, float, 4> },
+				{ &convert_color_range<float, 3, uint8, 3>, &convert_color_range<float, 3, uint8, 4>, &convert_color_range<float, 3, float, 3>, &convert_color_range<float, 3, float, 4> },
+				{ &convert_color_range<float, 4, uint8, 3>, &convert_color_range<float, 4, uint8, 4>, &convert_color_range<float, 4, float, 3>, &convert_color_range<float, 4, float, 4> }
+			};
+			if (src_stride == 0)
+				src_stride = color_type_sizes[src_type];
+			if (dst_stride == 0)
+				dst_stride = color_type_sizes[dst_type];
+			if (src_type == dst_type && src_stride == color_type_sizes[src_type] && dst_stride == color_type_sizes[dst_type]) {
+				std::memcpy(dst_ptr, src_ptr, count*color_type_sizes[src_type]);
+				return;
+			}
+			convert_functions[src_type][dst_type](static_cast<const unsigned char*>(src_ptr), src_stride, static_cast<unsigned char*>(dst_ptr), dst_stride, count);
+		}
+
 		abst_color_storage::abst_color_storage(ColorType _color_type)
 			: color_type(_color_type)
 		{
@@ -20,8 +77,7 @@ namespace cgv {
 		/// return size of a single color in byte
 		size_t abst_color_storage::get_color_size() const
 		{
-			size_t sizes[] = { sizeof(rgb8), sizeof(rgba8), sizeof(rgb),sizeof(rgba)};
-			return sizes[color_type];
+			return color_type_sizes[color_type];
 		}
 	}
 }
\ No newline at end of file
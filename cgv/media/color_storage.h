@@ -33,6 +33,12 @@ namespace cgv {
 			typedef color<unsigned char, RGB, OPACITY> rgba8;
 		};
 
+		/** convert count colors of type src_type to colors of type dst_type, where strides are given in bytes and a
+			stride of 0 denotes densely packed colors. The conversion is selected once for the whole range. Colors of
+			the same type are copied with memcpy if both ranges are densely packed. Source and destination must not overlap. */
+		extern CGV_API void convert_colors(const void* src_ptr, ColorType src_type, size_t src_stride,
+			void* dst_ptr, ColorType dst_type, size_t dst_stride, size_t count);
+
 		/// interface for color storage of different internal types
 		class abst_color_storage : public color_storage_types
 		{
@@ -76,6 +82,10 @@ namespace cgv {
 			virtual void put_color(size_t i, rgb8& col) const = 0;
 			/// set color of type rgba8 to i-th color
 			virtual void put_color(size_t i, rgba8& col) const = 0;
+			/// set count colors starting at index begin from colors of type src_type with stride in bytes (0 for densely packed colors)
+			virtual void set_colors(size_t begin, size_t count, const void* src_ptr, ColorType src_type, size_t src_stride = 0) = 0;
+			/// convert count colors starting at index begin to colors of type dst_type with stride in bytes (0 for densely packed colors)
+			virtual void put_colors(size_t begin, size_t count, void* dst_ptr, ColorType dst_type, size_t dst_stride = 0) const = 0;
 		};
 
 		/// template implementation of color storage model
@@ -91,18 +101,14 @@ namespace cgv {
 				colors(csm.colors) { }
 			/// construct from color storage of different type
 			template <typename C1>
-			color_storage(const color_storage<C1>& csm) : abst_color_storage(color_storage_traits<C>::color_type) {
-				for (const auto& col : csm.colors)
-					colors.push_back(col);
+			color_storage(const color_storage<C1>& csm) : abst_color_storage(color_storage_traits<C>::color_type),
+				colors(csm.colors.size()) {
+				csm.put_colors(0, colors.size(), colors.data(), color_type);
 			}
 			/// construct from abstract color storage of unknown type
-			color_storage(const abst_color_storage& acsm) : abst_color_storage(color_storage_traits<C>::color_type) {
-				switch (acsm.get_color_type()) {
-				case CT_RGB:   new (this) color_storage<C>(static_cast<const color_storage<rgb>&>(acsm)); break;
-				case CT_RGBA:  new (this) color_storage<C>(static_cast<const color_storage<rgba>&>(acsm)); break;
-				case CT_RGB8:  new (this) color_storage<C>(static_cast<const color_storage<rgb8>&>(acsm)); break;
-				case CT_RGBA8: new (this) color_storage<C>(static_cast<const color_storage<rgba8>&>(acsm)); break;
-				}
+			color_storage(const abst_color_storage& acsm) : abst_color_storage(color_storage_traits<C>::color_type),
+				colors(acsm.get_nr_colors()) {
+				acsm.put_colors(0, colors.size(), colors.data(), color_type);
 			}
 			// implementation of vector access passes interface to std::vector class
 			size_t get_nr_colors() const { return colors.size(); }
@@ -120,6 +126,15 @@ namespace cgv {
 			void put_color(size_t i, rgba& col) const { col = colors[i]; }
 			void put_color(size_t i, rgb8& col) const { col = colors[i]; }
 			void put_color(size_t i, rgba8& col) const { col = colors[i]; }
+			// implementation of range access converts all colors with a single dispatch on the color types
+			void set_colors(size_t begin, size_t count, const void* src_ptr, ColorType src_type, size_t src_stride = 0) {
+				if (count > 0)
+					convert_colors(src_ptr, src_type, src_stride, &colors[begin], color_type, sizeof(C), count);
+			}
+			void put_colors(size_t begin, size_t count, void* dst_ptr, ColorType dst_type, size_t dst_stride = 0) const {
+				if (count > 0)
+					convert_colors(&colors[begin], color_type, sizeof(C), dst_ptr, dst_type, dst_stride, count);
+			}
 		};
 	}
 }
@@ -74,6 +74,16 @@ namespace cgv {
 			assert(has_colors());
 			color_storage_ptr->put_color(i, col);
 		}
+		void colored_model::set_colors(size_t begin, size_t count, const void* src_ptr, ColorType src_type, size_t src_stride)
+		{
+			assert(has_colors());
+			color_storage_ptr->set_colors(begin, count, src_ptr, src_type, src_stride);
+		}
+		void colored_model::put_colors(size_t begin, size_t count, void* dst_ptr, ColorType dst_type, size_t dst_stride) const
+		{
+			assert(has_colors());
+			color_storage_ptr->put_colors(begin, count, dst_ptr, dst_type, dst_stride);
+		}
 
 		size_t colored_model::get_nr_colors() const
 		{
@@ -42,6 +42,10 @@ namespace cgv {
 			void put_color(size_t i, rgb8& col) const;
 			/// set color of type rgba8 to i-th color
 			void put_color(size_t i, rgba8& col) const;
+			/// set count colors starting at index begin from colors of type src_type with stride in bytes (0 for densely packed colors)
+			void set_colors(size_t begin, size_t count, const void* src_ptr, ColorType src_type, size_t src_stride = 0);
+			/// convert count colors starting at index begin to colors of type dst_type with stride in bytes (0 for densely packed colors)
+			void put_colors(size_t begin, size_t count, void* dst_ptr, ColorType dst_type, size_t dst_stride = 0) const;
 			/// return number of allocated colors
 			size_t get_nr_colors() const;
 			/// resize the color storage to given number of colors
@@ -1,5 +1,7 @@
 #include "bmp_writer.h"
 #include <iostream>
+#include <vector>
+#include <cgv/data/format_conversion.h>
 #include <cgv/base/register.h>
 
 #ifdef WIN32
@@ -96,20 +98,18 @@ bool bmp_writer::write_image(const const_data_view& dv, const std::vector<const_
 			unsigned int line_padding   = 
 				packing_info::align(bytes_per_line,4) - bytes_per_line;
 
+			// rgb rows are swizzled into a line buffer and written at once
+			format_converter to_bgr(*dv.get_format(), component_format("uint8[B,G,R]"));
+			std::vector<unsigned char> line(bytes_per_line);
 			data += (height-1)*bytes_per_line;
 			for (unsigned short y = 0; success && y < height; ++y) {
-				if (_cf == CF_BGR) {
+				if (_cf == CF_BGR)
 					success = fwrite(data, 1, bytes_per_line, fp) == bytes_per_line;
-					data -= bytes_per_line;
-				}
 				else {
-					for (unsigned short x = 0; x < width; ++x, data += 3) {
-						unsigned char col[3] = { data[2], data[1], data[0] };
-						if (!(success = fwrite(col, 1, 3, fp) == 3) )
-							break;
-					}
-					data -= 2*bytes_per_line;
+					to_bgr.convert(data, line.empty() ? 0 : &line[0], width);
+					success = fwrite(line.empty() ? 0 : &line[0], 1, bytes_per_line, fp) == bytes_per_line;
 				}
+				data -= bytes_per_line;
 				if (success)
 					success = !(line_padding && fwrite(bmp_header+50, 1, line_padding, fp) != line_padding);
 				else
@@ -0,0 +1,173 @@
+#include "image_decode_queue.h"
+#include "image_reader.h"
+#include <algorithm>
+
+using namespace cgv::data;
+
+namespace cgv {
+	namespace media {
+		namespace image {
+
+image_decode_queue::image_decode_queue(unsigned nr_threads) : next_ticket(0), nr_tasks(0)
+{
+	max_nr_tasks = cgv::os::get_nr_parallel_threads(nr_threads);
+}
+
+image_decode_queue::~image_decode_queue()
+{
+	tasks.wait();
+	for (std::map<unsigned, job*>::iterator i = jobs.begin(); i != jobs.end(); ++i)
+		delete i->second;
+}
+
+unsigned image_decode_queue::get_nr_threads() const
+{
+	return max_nr_tasks;
+}
+
+void image_decode_queue::work()
+{
+	while (true) {
+		job* j;
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			// the task ends under the lock, such that submit() starts a new task for jobs queued afterwards
+			if (waiting.empty()) {
+				--nr_tasks;
+				return;
+			}
+			j = jobs[waiting.front()];
+			waiting.pop_front();
+		}
+		decode(j);
+	}
+}
+
+void image_decode_queue::decode(job* j)
+{
+	// decode outside of the lock, where only the decoding thread accesses the job until it is marked done
+	data_format df;
+	image_reader reader(df);
+	data_view dv;
+	bool success = reader.open(j->file_name);
+	if (success) {
+		// files are decoded in parallel, such that readers should not spawn further threads
+		reader.set("nr_threads", 1u);
+		if (j->is_region)
+			success = reader.read_region(j->x, j->y, j->w, j->h, dv);
+		else {
+			data_format* image_format = new data_format(df);
+			new(&dv) data_view(image_format);
+			dv.manage_format();
+			success = reader.read_image(static_cast<const data_view&>(dv));
+		}
+		if (!reader.close())
+			success = false;
+	}
+	std::string error;
+	if (!success) {
+		error = reader.get_last_error();
+		if (error.empty())
+			error = "could not decode image file " + j->file_name;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		j->success = success;
+		j->error = error;
+		if (success)
+			j->result = dv;
+		j->done = true;
+	}
+	done_cv.notify_all();
+}
+
+unsigned image_decode_queue::submit(job* j)
+{
+	j->done = false;
+	j->success = false;
+	unsigned ticket;
+	bool start_task;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		ticket = next_ticket++;
+		jobs[ticket] = j;
+		waiting.push_back(ticket);
+		start_task = nr_tasks < max_nr_tasks;
+		if (start_task)
+			++nr_tasks;
+	}
+	if (start_task)
+		tasks.run([this]() { work(); });
+	return ticket;
+}
+
+unsigned image_decode_queue::enqueue(const std::string& file_name)
+{
+	job* j = new job();
+	j->file_name = file_name;
+	j->is_region = false;
+	j->x = j->y = j->w = j->h = 0;
+	return submit(j);
+}
+
+unsigned image_decode_queue::enqueue_region(const std::string& file_name, unsigned x, unsigned y, unsigned w, unsigned h)
+{
+	job* j = new job();
+	j->file_name = file_name;
+	j->is_region = true;
+	j->x = x;
+	j->y = y;
+	j->w = w;
+	j->h = h;
+	return submit(j);
+}
+
+bool image_decode_queue::is_ready(unsigned ticket) const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	std::map<unsigned, job*>::const_iterator i = jobs.find(ticket);
+	return i != jobs.end() && i->second->done;
+}
+
+bool image_decode_queue::retrieve(unsigned ticket, data_view& dv, std::string* error_message)
+{
+	job* j;
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		std::map<unsigned, job*>::iterator i = jobs.find(ticket);
+		if (i == jobs.end()) {
+			if (error_message)
+				*error_message = "unknown ticket";
+			return false;
+		}
+		j = i->second;
+		// decode the job on the calling thread if no task has started it yet
+		std::deque<unsigned>::iterator w = std::find(waiting.begin(), waiting.end(), ticket);
+		if (w != waiting.end()) {
+			waiting.erase(w);
+			lock.unlock();
+			decode(j);
+			lock.lock();
+		}
+		while (!j->done)
+			done_cv.wait(lock);
+		jobs.erase(ticket);
+	}
+	bool success = j->success;
+	if (success)
+		dv = j->result;
+	else if (error_message)
+		*error_message = j->error;
+	delete j;
+	return success;
+}
+
+size_t image_decode_queue::get_nr_pending() const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	return jobs.size();
+}
+
+		}
+	}
+}
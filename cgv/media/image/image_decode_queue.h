@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cgv/data/data_view.h>
+#include <cgv/os/task_scheduler.h>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace media {
+		namespace image {
+
+/** decodes image files in the background with tasks of the cgv::os scheduler. Files are submitted with enqueue() or
+	enqueue_region(), which return a ticket, and decoded in the order of submission with the readers registered for
+	their extensions, where at most nr_threads files are decoded at the same time. The decoded images are retrieved
+	by ticket with retrieve(), which blocks until the file has been processed or decodes it on the calling thread if
+	no task has started it yet. As files are decoded concurrently, each reader decodes single threaded. */
+class CGV_API image_decode_queue
+{
+protected:
+	/// a submitted file together with its decoding result
+	struct job
+	{
+		std::string file_name;
+		bool is_region;
+		unsigned x, y, w, h;
+		bool done;
+		bool success;
+		std::string error;
+		cgv::data::data_view result;
+	};
+	/// protects all members below except of tasks
+	mutable std::mutex mtx;
+	/// signals finished jobs to retrieve()
+	mutable std::condition_variable done_cv;
+	/// submitted jobs that have not been retrieved yet
+	std::map<unsigned, job*> jobs;
+	/// tickets of the jobs that have not been started yet
+	std::deque<unsigned> waiting;
+	/// ticket of the next submitted job
+	unsigned next_ticket;
+	/// maximum number of tasks decoding files at the same time
+	unsigned max_nr_tasks;
+	/// number of running or queued decoding tasks
+	unsigned nr_tasks;
+	/// decoding tasks
+	cgv::os::task_group tasks;
+	/// decode waiting jobs until none is left, called by the decoding tasks
+	void work();
+	/// decode a job and mark it as done
+	void decode(job* j);
+	/// submit a job and return its ticket
+	unsigned submit(job* j);
+public:
+	/// construct the queue that decodes up to nr_threads files at the same time, where 0 uses cgv::os::get_nr_parallel_threads()
+	image_decode_queue(unsigned nr_threads = 0);
+	/// finish the submitted jobs and wait for the tasks, results that have not been retrieved are discarded
+	~image_decode_queue();
+	/// return the maximum number of files that are decoded at the same time
+	unsigned get_nr_threads() const;
+	/// submit an image file for decoding and return the ticket to retrieve the image
+	unsigned enqueue(const std::string& file_name);
+	/// submit the region of width w and height h with upper left corner (x,y) of an image file for decoding
+	unsigned enqueue_region(const std::string& file_name, unsigned x, unsigned y, unsigned w, unsigned h);
+	/// return whether the job of the ticket has been processed, such that retrieve() does not block
+	bool is_ready(unsigned ticket) const;
+	/** wait until the job of the ticket has been processed and move the decoded image into the data view, which owns
+		format and data afterwards. Returns false for unknown or already retrieved tickets and if decoding failed, in
+		which case the error message is stored in the optionally passed string. */
+	bool retrieve(unsigned ticket, cgv::data::data_view& dv, std::string* error_message = 0);
+	/// return the number of submitted jobs that have not been retrieved yet
+	size_t get_nr_pending() const;
+};
+
+		}
+	}
+}
+
+#include <cgv/config/lib_end.h>
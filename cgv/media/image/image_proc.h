@@ -4,62 +4,97 @@
 #include <cgv/utils/statistics.h>
 #endif
 #include <cgv/math/permute.h>
+#include <cgv/os/task_scheduler.h>
+#include <algorithm>
+#include <vector>
+
 namespace cgv {
 	namespace media {
 		namespace image {
 
+/** call f(begin,end) for consecutive ranges of [0,n) in parallel with the task scheduler of cgv_os, where the number
+	of ranges is at most nr_threads and 0 selects cgv::os::get_nr_parallel_threads(). Ranges contain at least
+	min_range_size elements such that small tasks run on the calling thread only. */
+template <typename F>
+void parallel_ranges(size_t n, unsigned nr_threads, size_t min_range_size, const F& f)
+{
+	nr_threads = cgv::os::get_nr_parallel_threads(nr_threads);
+	size_t nr_ranges = std::min(size_t(nr_threads), std::max(size_t(1), n / std::max(size_t(1), min_range_size)));
+	if (nr_ranges <= 1) {
+		f(size_t(0), n);
+		return;
+	}
+	cgv::os::parallel_for(0, nr_ranges, [&](size_t r) { f(r*n / nr_ranges, (r + 1)*n / nr_ranges); }, 1);
+}
+
+/// permute the entries of nr_outside lines of nr_inside entries with permute_arrays in parallel over the lines
+template <typename T>
+void permute_lines(T* data, const std::vector<int>& P, size_t nr_inside, size_t nr_outside, size_t step_inside, size_t step_outside, unsigned nr_threads)
+{
+	parallel_ranges(nr_outside, nr_threads, 1 + 65536 / std::max(size_t(1), nr_inside), [&](size_t y_begin, size_t y_end) {
+		// permute_arrays marks visited entries in the permutation, such that each thread needs its own copy
+		std::vector<int> Q(P);
+		cgv::math::permute_arrays(data + y_begin*step_outside, &Q.front(), nr_inside, y_end - y_begin, step_inside, step_outside);
+	});
+}
+
 template <typename T_calc, typename T_detail, typename T_store>
-void integer_wavelet_transform(T_store* data, size_t nr_inside, size_t nr_outside, size_t step_inside, size_t step_outside, size_t nr_components, unsigned mask, bool do_split = true, int s_scale = 1, int d_scale = 2)
+void integer_wavelet_transform(T_store* data, size_t nr_inside, size_t nr_outside, size_t step_inside, size_t step_outside, size_t nr_components, unsigned mask, bool do_split = true, int s_scale = 1, int d_scale = 2, unsigned nr_threads = 0)
 {
 #ifdef SHOW_WAVELET_STATS
 	cgv::utils::statistics s_stats, d_stats;
+	// statistics are not synchronized
+	nr_threads = 1;
 #endif
 	// perform wavelet transform in x-direction
-	size_t c, x, y;
-	for (y = 0; y < nr_outside; ++y) {
-		T_store* s0_ptr  = data + y * step_outside;
-		T_store* d1_ptr  = s0_ptr + step_inside;
-		T_store* s0n_ptr = d1_ptr + step_inside;
+	// lines are independent and transformed in parallel
+	parallel_ranges(nr_outside, nr_threads, 1 + 65536 / std::max(size_t(1), nr_inside*nr_components), [&](size_t y_begin, size_t y_end) {
+		size_t c, x, y;
+		for (y = y_begin; y < y_end; ++y) {
+			T_store* s0_ptr  = data + y * step_outside;
+			T_store* d1_ptr  = s0_ptr + step_inside;
+			T_store* s0n_ptr = d1_ptr + step_inside;
 
-		T_calc  s0n;
-		T_calc  d1p;
-		for (c = 0; c < nr_components; ++c) {
-			s0n[c] = (*s0_ptr)[c] / s_scale;
-			d1p[c] = 0;
-		}
-		for (x = 0; x < nr_inside; x += 2) {
-			// if not right boundary reached, step on with second source color
-			if (x + 2 < nr_inside) {
-				for (c = 0; c < nr_components; ++c)
-					s0n[c] = (*s0n_ptr)[c] / s_scale;
-			}
-			// predict and compute detail coefficient
-			T_calc d1, s0;
+			T_calc  s0n;
+			T_calc  d1p;
 			for (c = 0; c < nr_components; ++c) {
-				d1[c] = (*d1_ptr)[c] / s_scale;
-				s0[c] = (*s0_ptr)[c] / s_scale;
-				d1[c] -= (s0[c] + s0n[c] + 1) / 2;
+				s0n[c] = (*s0_ptr)[c] / s_scale;
+				d1p[c] = 0;
+			}
+			for (x = 0; x < nr_inside; x += 2) {
+				// if not right boundary reached, step on with second source color
+				if (x + 2 < nr_inside) {
+					for (c = 0; c < nr_components; ++c)
+						s0n[c] = (*s0n_ptr)[c] / s_scale;
+				}
+				// predict and compute detail coefficient
+				T_calc d1, s0;
+				for (c = 0; c < nr_components; ++c) {
+					d1[c] = (*d1_ptr)[c] / s_scale;
+					s0[c] = (*s0_ptr)[c] / s_scale;
+					d1[c] -= (s0[c] + s0n[c] + 1) / 2;
 #ifdef SHOW_WAVELET_STATS
-				d_stats.update(d1[c]);
+					d_stats.update(d1[c]);
 #endif
-				(*reinterpret_cast<T_detail*>(d1_ptr))[c] = d1[c] / d_scale;
-			}
+					(*reinterpret_cast<T_detail*>(d1_ptr))[c] = d1[c] / d_scale;
+				}
 
-			// update source term and previous detail coefficient
-			for (c = 0; c < nr_components; ++c) {
-				s0[c] += (d1p[c] + d1[c] + 2) / 4;
+				// update source term and previous detail coefficient
+				for (c = 0; c < nr_components; ++c) {
+					s0[c] += (d1p[c] + d1[c] + 2) / 4;
 #ifdef SHOW_WAVELET_STATS
-				s_stats.update(s0[c]);
+					s_stats.update(s0[c]);
 #endif
-				(*reinterpret_cast<T_detail*>(s0_ptr))[c] = s0[c];
-				d1p[c] = d1[c];
+					(*reinterpret_cast<T_detail*>(s0_ptr))[c] = s0[c];
+					d1p[c] = d1[c];
+				}
+				// step on pointers
+				s0_ptr += 2 * step_inside;
+				d1_ptr += 2 * step_inside;
+				s0n_ptr += 2 * step_inside;
 			}
-			// step on pointers
-			s0_ptr += 2 * step_inside;
-			d1_ptr += 2 * step_inside;
-			s0n_ptr += 2 * step_inside;
 		}
-	}
+	});
 #ifdef SHOW_WAVELET_STATS
 	std::cout << "s_stats=" << s_stats << std::endl;
 	std::cout << "d_stats=" << d_stats << std::endl;
@@ -68,126 +103,137 @@ void integer_wavelet_transform(T_store* data, size_t nr_inside, size_t nr_outsid
 		// compute permutation
 		std::vector<int> P;
 		P.resize(nr_inside);
-		for (x = 0; x < nr_inside; ++x)
+		for (size_t x = 0; x < nr_inside; ++x)
 			P[x] = ((x & 1) == 0) ? x / 2 : (x / 2 + (nr_inside+1) / 2);
-		cgv::math::permute_arrays(data, &P.front(), nr_inside, nr_outside, step_inside, step_outside);
+		permute_lines(data, P, nr_inside, nr_outside, step_inside, step_outside, nr_threads);
 	}
 }
 
 template <typename T_calc, typename T_detail, typename T_store>
-void integer_inverse_wavelet_transform(T_store* data, size_t nr_inside, size_t nr_outside, size_t step_inside, size_t step_outside, size_t nr_components, unsigned mask, bool do_split = true, int s_scale = 1, int d_scale = 2)
+void integer_inverse_wavelet_transform(T_store* data, size_t nr_inside, size_t nr_outside, size_t step_inside, size_t step_outside, size_t nr_components, unsigned mask, bool do_split = true, int s_scale = 1, int d_scale = 2, unsigned nr_threads = 0)
 {
-	size_t c, x, y;
 	if (do_split) {
 		// compute permutation
 		std::vector<int> P;
 		P.resize(nr_inside);
-		for (x = 0; x < nr_inside; ++x)
+		for (size_t x = 0; x < nr_inside; ++x)
 			P[x] = (x < nr_inside / 2) ? 2*x : 2*(x-nr_inside / 2)+1;
 
-		cgv::math::permute_arrays(data, &P.front(), nr_inside, nr_outside, step_inside, step_outside);
+		permute_lines(data, P, nr_inside, nr_outside, step_inside, step_outside, nr_threads);
 	}
 #ifdef SHOW_WAVELET_STATS
 	cgv::utils::statistics s_stats, d_stats;
+	// statistics are not synchronized
+	nr_threads = 1;
 #endif
 
 	// perform inverse wavelet transform in x-direction
-	for (y = 0; y < nr_outside; ++y) {
-		T_detail* s0_ptr  = reinterpret_cast<T_detail*>(data + y * step_outside);
-		T_detail* d1_ptr  = s0_ptr + step_inside;
-		T_detail* d1p_ptr = 0;
-		T_detail* s0n_ptr = d1_ptr + step_inside;
+	// lines are independent and transformed in parallel
+	parallel_ranges(nr_outside, nr_threads, 1 + 65536 / std::max(size_t(1), nr_inside*nr_components), [&](size_t y_begin, size_t y_end) {
+		size_t c, x, y;
+		for (y = y_begin; y < y_end; ++y) {
+			T_detail* s0_ptr  = reinterpret_cast<T_detail*>(data + y * step_outside);
+			T_detail* d1_ptr  = s0_ptr + step_inside;
+			T_detail* d1p_ptr = 0;
+			T_detail* s0n_ptr = d1_ptr + step_inside;
 
-		T_calc  s0p, s0;
-		T_calc  d1p, d1;
-		for (c = 0; c < nr_components; ++c)
-			d1p[c] = 0;
+			T_calc  s0p, s0;
+			T_calc  d1p, d1;
+			for (c = 0; c < nr_components; ++c)
+				d1p[c] = 0;
 
-		for (x = 0; x < nr_inside; x += 2) {
-			// invert source term update
-			for (c = 0; c < nr_components; ++c) {
-				d1[c] = (*d1_ptr)[c] * d_scale;
-				s0[c] = (*s0_ptr)[c];
-				s0[c] -= (d1p[c] + d1[c] + 2) / 4;
+			for (x = 0; x < nr_inside; x += 2) {
+				// invert source term update
+				for (c = 0; c < nr_components; ++c) {
+					d1[c] = (*d1_ptr)[c] * d_scale;
+					s0[c] = (*s0_ptr)[c];
+					s0[c] -= (d1p[c] + d1[c] + 2) / 4;
 #ifdef SHOW_WAVELET_STATS
-				s_stats.update(s0[c]);
+					s_stats.update(s0[c]);
 #endif
-				(*reinterpret_cast<T_store*>(s0_ptr))[c] = s_scale * s0[c];
-			}
-			// invert previous predict step
-			if (x > 0) {
-				for (c = 0; c < nr_components; ++c) {
-					d1p[c] += (s0p[c] + s0[c] + 1) / 2;
+					(*reinterpret_cast<T_store*>(s0_ptr))[c] = s_scale * s0[c];
+				}
+				// invert previous predict step
+				if (x > 0) {
+					for (c = 0; c < nr_components; ++c) {
+						d1p[c] += (s0p[c] + s0[c] + 1) / 2;
 #ifdef SHOW_WAVELET_STATS
-					d_stats.update(d1p[c]);
+						d_stats.update(d1p[c]);
 #endif
-					(*reinterpret_cast<T_store*>(d1p_ptr))[c] = s_scale * d1p[c];
+						(*reinterpret_cast<T_store*>(d1p_ptr))[c] = s_scale * d1p[c];
+					}
+				}
+				for (c = 0; c < nr_components; ++c) {
+					d1p[c] = d1[c];
+					s0p[c] = s0[c];
 				}
+				d1p_ptr = d1_ptr;
+				// step on pointers
+				s0_ptr += 2 * step_inside;
+				d1_ptr += 2 * step_inside;
+				s0n_ptr += 2 * step_inside;
 			}
+			// invert last predict step
 			for (c = 0; c < nr_components; ++c) {
-				d1p[c] = d1[c];
-				s0p[c] = s0[c];
-			}
-			d1p_ptr = d1_ptr;
-			// step on pointers
-			s0_ptr += 2 * step_inside;
-			d1_ptr += 2 * step_inside;
-			s0n_ptr += 2 * step_inside;
-		}
-		// invert last predict step
-		for (c = 0; c < nr_components; ++c) {
-			d1p[c] += (s0p[c] + s0[c] + 1) / 2;
+				d1p[c] += (s0p[c] + s0[c] + 1) / 2;
 #ifdef SHOW_WAVELET_STATS
-			d_stats.update(d1p[c]);
+				d_stats.update(d1p[c]);
 #endif
-			(*reinterpret_cast<T_store*>(d1p_ptr))[c] = d1p[c];
+				(*reinterpret_cast<T_store*>(d1p_ptr))[c] = d1p[c];
+			}
 		}
-	}
+	});
 #ifdef SHOW_WAVELET_STATS
 	std::cout << "inverse s_stats=" << s_stats << std::endl;
 	std::cout << "inverse d_stats=" << d_stats << std::endl;
 #endif
 }
 
+/// average 2x2 blocks of an image with W x H entries into an image with (W+1)/2 x (H+1)/2 entries in parallel over rows
 template <typename T_calc, typename T>
-void subsample_image(const T* image_ptr, T* subsampled_image, const int W, const int H, const int nr_components)
+void subsample_image(const T* image_ptr, T* subsampled_image, const int W, const int H, const int nr_components, unsigned nr_threads = 0)
 {
 	int w = (W + 1) / 2;
 	int h = (H + 1) / 2;
-	for (int y = 0; y < h; ++y) {
-		bool condense_y = 2 * y + 1 == H;
-		for (int x = 0; x < w; ++x) {
-			T* target_ptr = subsampled_image + y*w + x;
-			const T* src0_ptr = image_ptr + 2 * (y*W + x);
-			const T* src1_ptr = src0_ptr + (condense_y ? 0 : W);
-			int dx = (2 * x + 1 == W ? 0 : 1);
-			for (int c = 0; c < nr_components; ++c)
-				(*target_ptr)[c] = (T_calc(src0_ptr[0][c]) + T_calc(src0_ptr[dx][c]) + T_calc(src1_ptr[0][c]) + T_calc(src1_ptr[dx][c])) / 4;
+	parallel_ranges(size_t(h), nr_threads, 1 + 65536 / size_t(4 * w), [&](size_t y_begin, size_t y_end) {
+		for (int y = int(y_begin); y < int(y_end); ++y) {
+			bool condense_y = 2 * y + 1 == H;
+			for (int x = 0; x < w; ++x) {
+				T* target_ptr = subsampled_image + y*w + x;
+				const T* src0_ptr = image_ptr + 2 * (y*W + x);
+				const T* src1_ptr = src0_ptr + (condense_y ? 0 : W);
+				int dx = (2 * x + 1 == W ? 0 : 1);
+				for (int c = 0; c < nr_components; ++c)
+					(*target_ptr)[c] = (T_calc(src0_ptr[0][c]) + T_calc(src0_ptr[dx][c]) + T_calc(src1_ptr[0][c]) + T_calc(src1_ptr[dx][c])) / 4;
+			}
 		}
-	}
+	});
 }
 
+/// average 2x2x2 blocks of two slices with W x H entries into a slice with (W+1)/2 x (H+1)/2 entries in parallel over rows
 template <typename T_calc, typename T>
-void subsample_slice(const T* slice0_ptr, const T* slice1_ptr, T* subsampled_slice, const int W, const int H, const int nr_components)
+void subsample_slice(const T* slice0_ptr, const T* slice1_ptr, T* subsampled_slice, const int W, const int H, const int nr_components, unsigned nr_threads = 0)
 {
 	int w = (W + 1) / 2;
 	int h = (H + 1) / 2;
-	for (int y = 0; y < h; ++y) {
-		bool condense_y = 2 * y + 1 == H;
-		for (int x = 0; x < w; ++x) {
-			T* target_ptr = subsampled_slice + y*w + x;
-			const T* src00_ptr = slice0_ptr + 2 * (y*W + x);
-			const T* src01_ptr = src00_ptr + (condense_y ? 0 : W);
-			const T* src10_ptr = slice1_ptr + 2 * (y*W + x);
-			const T* src11_ptr = src10_ptr + (condense_y ? 0 : W);
-			int dx = (2 * x + 1 == W ? 0 : 1);
-			for (int c = 0; c < nr_components; ++c)
-				(*target_ptr)[c] = (
-					T_calc(src00_ptr[0][c]) + T_calc(src00_ptr[dx][c]) + T_calc(src01_ptr[0][c]) + T_calc(src01_ptr[dx][c]) + 
-					T_calc(src10_ptr[0][c]) + T_calc(src10_ptr[dx][c]) + T_calc(src11_ptr[0][c]) + T_calc(src11_ptr[dx][c])
-					) / 8;
+	parallel_ranges(size_t(h), nr_threads, 1 + 65536 / size_t(8 * w), [&](size_t y_begin, size_t y_end) {
+		for (int y = int(y_begin); y < int(y_end); ++y) {
+			bool condense_y = 2 * y + 1 == H;
+			for (int x = 0; x < w; ++x) {
+				T* target_ptr = subsampled_slice + y*w + x;
+				const T* src00_ptr = slice0_ptr + 2 * (y*W + x);
+				const T* src01_ptr = src00_ptr + (condense_y ? 0 : W);
+				const T* src10_ptr = slice1_ptr + 2 * (y*W + x);
+				const T* src11_ptr = src10_ptr + (condense_y ? 0 : W);
+				int dx = (2 * x + 1 == W ? 0 : 1);
+				for (int c = 0; c < nr_components; ++c)
+					(*target_ptr)[c] = (
+						T_calc(src00_ptr[0][c]) + T_calc(src00_ptr[dx][c]) + T_calc(src01_ptr[0][c]) + T_calc(src01_ptr[dx][c]) + 
+						T_calc(src10_ptr[0][c]) + T_calc(src10_ptr[dx][c]) + T_calc(src11_ptr[0][c]) + T_calc(src11_ptr[dx][c])
+						) / 8;
+			}
 		}
-	}
+	});
 }
 		}
 	}
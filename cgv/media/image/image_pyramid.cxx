@@ -0,0 +1,473 @@
+#include "image_pyramid.h"
+#include <cgv/data/format_conversion.h>
+#include <cgv/os/task_scheduler.h>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CGV_MEDIA_USE_SSE2
+#endif
+
+using namespace cgv::data;
+using namespace cgv::type::info;
+
+namespace cgv {
+	namespace media {
+		namespace image {
+
+downsample_options::downsample_options(DownsampleFilter _filter, bool _srgb, unsigned _nr_threads)
+	: filter(_filter), filter_radius(3.0f), kaiser_alpha(4.0f), srgb(_srgb), nr_threads(_nr_threads)
+{
+}
+
+data_format get_downsampled_format(const data_format& df)
+{
+	data_format result(df);
+	for (unsigned i = 0; i < df.get_nr_dimensions(); ++i) {
+		unsigned r = df.get_resolution(i);
+		if (r > 1)
+			result.set_resolution(i, (r + 1) / 2);
+	}
+	return result;
+}
+
+unsigned get_nr_pyramid_levels(const data_format& df)
+{
+	unsigned r = 1;
+	for (unsigned i = 0; i < df.get_nr_dimensions(); ++i)
+		r = std::max(r, df.get_resolution(i));
+	unsigned n = 1;
+	for (; r > 1; r = (r + 1) / 2)
+		++n;
+	return n;
+}
+
+namespace {
+	const double pi = 3.14159265358979323846;
+
+	double sinc(double x)
+	{
+		if (std::abs(x) < 1e-8)
+			return 1.0;
+		return std::sin(pi*x) / (pi*x);
+	}
+	/// modified Bessel function of the first kind and order zero
+	double bessel_i0(double x)
+	{
+		double sum = 1.0, term = 1.0, q = 0.25*x*x;
+		for (int k = 1; k < 50 && term > 1e-12*sum; ++k) {
+			term *= q / (double(k)*k);
+			sum += term;
+		}
+		return sum;
+	}
+	/// evaluate windowed sinc filter at distance t measured in destination entries
+	double evaluate_filter(const downsample_options& o, double t)
+	{
+		double r = o.filter_radius;
+		if (std::abs(t) >= r)
+			return 0.0;
+		if (o.filter == DF_LANCZOS)
+			return sinc(t) * sinc(t / r);
+		double u = t / r;
+		return sinc(t) * bessel_i0(o.kaiser_alpha*std::sqrt(1.0 - u*u)) / bessel_i0(o.kaiser_alpha);
+	}
+
+	/// resampling of one dimension given by the same number of weighted source indices per destination entry
+	struct resampler
+	{
+		unsigned nr_taps;
+		/// nr_taps source indices per destination entry clamped to the valid range
+		std::vector<unsigned> indices;
+		/// nr_taps weights per destination entry summing up to one
+		std::vector<float> weights;
+		/// range of source indices needed for destination entries [i0,i1)
+		void get_source_range(unsigned i0, unsigned i1, unsigned& s0, unsigned& s1) const
+		{
+			s0 = indices[i0*nr_taps];
+			s1 = s0 + 1;
+			for (size_t j = i0*nr_taps; j < i1*nr_taps; ++j) {
+				s0 = std::min(s0, indices[j]);
+				s1 = std::max(s1, indices[j] + 1);
+			}
+		}
+		void init(const downsample_options& o, unsigned n_in, unsigned n_out)
+		{
+			std::vector<std::vector<std::pair<unsigned, double> > > taps(n_out);
+			double s = double(n_in) / n_out;
+			for (unsigned i = 0; i < n_out; ++i) {
+				std::vector<std::pair<unsigned, double> >& t = taps[i];
+				double c = (i + 0.5)*s;
+				if (n_in == n_out)
+					t.push_back(std::make_pair(i, 1.0));
+				else if (o.filter == DF_BOX) {
+					// area of overlap between source entry and destination footprint
+					double a = c - 0.5*s, b = c + 0.5*s;
+					for (int j = int(std::floor(a)); j < int(std::ceil(b)); ++j) {
+						double w = std::min(b, j + 1.0) - std::max(a, double(j));
+						if (w > 1e-9)
+							t.push_back(std::make_pair(unsigned(std::min(std::max(j, 0), int(n_in) - 1)), w));
+					}
+				}
+				else {
+					// the filter is stretched to the source spacing when reducing the resolution
+					double f = std::max(s, 1.0), r = o.filter_radius*f;
+					for (int j = int(std::floor(c - r - 0.5)); j <= int(std::ceil(c + r - 0.5)); ++j) {
+						double w = evaluate_filter(o, (j + 0.5 - c) / f);
+						if (w != 0.0)
+							t.push_back(std::make_pair(unsigned(std::min(std::max(j, 0), int(n_in) - 1)), w));
+					}
+				}
+			}
+			nr_taps = 1;
+			for (unsigned i = 0; i < n_out; ++i)
+				nr_taps = std::max(nr_taps, unsigned(taps[i].size()));
+			indices.resize(size_t(n_out)*nr_taps);
+			weights.resize(size_t(n_out)*nr_taps);
+			for (unsigned i = 0; i < n_out; ++i) {
+				double sum = 0.0;
+				for (size_t k = 0; k < taps[i].size(); ++k)
+					sum += taps[i][k].second;
+				for (unsigned k = 0; k < nr_taps; ++k) {
+					// unused taps repeat the first index with zero weight
+					bool used = k < taps[i].size();
+					indices[i*nr_taps + k] = used ? taps[i][k].first : (taps[i].empty() ? 0 : taps[i][0].first);
+					weights[i*nr_taps + k] = used ? float(taps[i][k].second / sum) : 0.0f;
+				}
+			}
+		}
+	};
+
+	/// lookup tables for sRGB conversion
+	struct srgb_tables
+	{
+		static const unsigned encode_resolution = 4096;
+		float decode8[256];
+		float encode[encode_resolution + 1];
+		static float to_linear(float v) { return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f); }
+		static float to_srgb(float v) { return v <= 0.0031308f ? 12.92f*v : 1.055f*std::pow(v, 1.0f / 2.4f) - 0.055f; }
+		srgb_tables()
+		{
+			for (unsigned i = 0; i < 256; ++i)
+				decode8[i] = to_linear(i / 255.0f);
+			for (unsigned i = 0; i <= encode_resolution; ++i)
+				encode[i] = to_srgb(float(i) / encode_resolution);
+		}
+		static const srgb_tables& get()
+		{
+			static srgb_tables tables;
+			return tables;
+		}
+		/// encode linear value in [0,1] with linear interpolation of table entries
+		float encode_value(float v) const
+		{
+			if (!(v > 0.0f))
+				return 0.0f;
+			if (v >= 1.0f)
+				return 1.0f;
+			float x = v*encode_resolution;
+			unsigned i = unsigned(x);
+			return encode[i] + (x - i)*(encode[i + 1] - encode[i]);
+		}
+	};
+
+	/// call f(task) for all nr_tasks tasks, which are executed in parallel by the task scheduler if nr_threads > 1
+	template <typename F>
+	void parallel_tasks(size_t nr_tasks, unsigned nr_threads, const F& f)
+	{
+		if (nr_threads <= 1 || nr_tasks <= 1) {
+			for (size_t t = 0; t < nr_tasks; ++t)
+				f(t);
+			return;
+		}
+		cgv::os::parallel_for(0, nr_tasks, f, 1);
+	}
+
+	/// compute out[j] = sum_k weights[k]*rows[k][j] for j < n
+	void weighted_sum(const float* const* rows, const float* weights, unsigned nr_rows, float* out, size_t n)
+	{
+		size_t j = 0;
+#ifdef CGV_MEDIA_USE_SSE2
+		for (; j + 8 <= n; j += 8) {
+			__m128 a = _mm_setzero_ps(), b = _mm_setzero_ps();
+			for (unsigned k = 0; k < nr_rows; ++k) {
+				__m128 w = _mm_set1_ps(weights[k]);
+				a = _mm_add_ps(a, _mm_mul_ps(w, _mm_loadu_ps(rows[k] + j)));
+				b = _mm_add_ps(b, _mm_mul_ps(w, _mm_loadu_ps(rows[k] + j + 4)));
+			}
+			_mm_storeu_ps(out + j, a);
+			_mm_storeu_ps(out + j + 4, b);
+		}
+#endif
+		for (; j < n; ++j) {
+			float v = 0.0f;
+			for (unsigned k = 0; k < nr_rows; ++k)
+				v += weights[k] * rows[k][j];
+			out[j] = v;
+		}
+	}
+
+	/// filter a row of entries with nc components along the row
+	void filter_row(const resampler& rs, const float* row, unsigned nc, float* out, unsigned n_out)
+	{
+		const unsigned* I = &rs.indices[0];
+		const float* W = &rs.weights[0];
+		unsigned K = rs.nr_taps;
+#ifdef CGV_MEDIA_USE_SSE2
+		if (nc == 4) {
+			for (unsigned i = 0; i < n_out; ++i, I += K, W += K) {
+				__m128 a = _mm_setzero_ps();
+				for (unsigned k = 0; k < K; ++k)
+					a = _mm_add_ps(a, _mm_mul_ps(_mm_set1_ps(W[k]), _mm_loadu_ps(row + 4 * I[k])));
+				_mm_storeu_ps(out + 4 * i, a);
+			}
+			return;
+		}
+#endif
+		if (nc == 1) {
+			for (unsigned i = 0; i < n_out; ++i, I += K, W += K) {
+				float v = 0.0f;
+				for (unsigned k = 0; k < K; ++k)
+					v += W[k] * row[I[k]];
+				out[i] = v;
+			}
+			return;
+		}
+		for (unsigned i = 0; i < n_out; ++i, I += K, W += K) {
+			float* o = out + nc*i;
+			for (unsigned c = 0; c < nc; ++c)
+				o[c] = 0.0f;
+			for (unsigned k = 0; k < K; ++k) {
+				const float* r = row + nc*I[k];
+				for (unsigned c = 0; c < nc; ++c)
+					o[c] += W[k] * r[c];
+			}
+		}
+	}
+
+	/// state shared by all threads of one downsampling operation
+	struct downsampler
+	{
+		const downsample_options& options;
+		unsigned nc;
+		unsigned w_in, h_in, d_in, w_out, h_out, d_out;
+		const unsigned char* src_ptr;
+		size_t src_steps[3];
+		unsigned char* dst_ptr;
+		size_t dst_steps[3];
+		format_converter fc_in, fc_out;
+		resampler rx, ry, rz;
+		/// per component whether it is sRGB encoded
+		std::vector<bool> srgb_components;
+		bool decode_with_table;
+		/// number of destination rows per task
+		unsigned band_size;
+
+		downsampler(const downsample_options& _options, const component_format& src_cf, const component_format& work_cf, const component_format& dst_cf)
+			: options(_options), fc_in(src_cf, work_cf), fc_out(work_cf, dst_cf)
+		{
+			nc = work_cf.get_nr_components();
+			srgb_components.resize(nc, false);
+			if (options.srgb)
+				for (unsigned c = 0; c < nc; ++c)
+					srgb_components[c] = work_cf.get_component_name(c) != "A";
+			decode_with_table = src_cf.get_component_type() == TI_UINT8 && !src_cf.is_packing() &&
+				src_cf.get_integer_interpretation() == CII_DEFAULT;
+		}
+		/// convert a source row into floats and decode sRGB components
+		void load_row(unsigned y, unsigned z, float* row) const
+		{
+			fc_in.convert(src_ptr + z*src_steps[0] + y*src_steps[1], src_steps[2], row, nc*sizeof(float), w_in);
+			if (!options.srgb)
+				return;
+			const srgb_tables& T = srgb_tables::get();
+			for (unsigned c = 0; c < nc; ++c) {
+				if (!srgb_components[c])
+					continue;
+				float* v = row + c;
+				if (decode_with_table) {
+					for (unsigned x = 0; x < w_in; ++x, v += nc)
+						*v = T.decode8[unsigned(*v * 255.0f + 0.5f)];
+				}
+				else {
+					for (unsigned x = 0; x < w_in; ++x, v += nc)
+						*v = srgb_tables::to_linear(std::min(std::max(*v, 0.0f), 1.0f));
+				}
+			}
+		}
+		/// encode sRGB components of a float row and convert it into the destination row
+		void store_row(unsigned y, unsigned z, float* row) const
+		{
+			if (options.srgb) {
+				const srgb_tables& T = srgb_tables::get();
+				for (unsigned c = 0; c < nc; ++c) {
+					if (!srgb_components[c])
+						continue;
+					float* v = row + c;
+					for (unsigned x = 0; x < w_out; ++x, v += nc)
+						*v = T.encode_value(*v);
+				}
+			}
+			fc_out.convert(row, nc*sizeof(float), dst_ptr + z*dst_steps[0] + y*dst_steps[1], dst_steps[2], w_out);
+		}
+		/// filter destination rows [y0,y1) of source slice z within the slice into out
+		void filter_slice_band(unsigned z, unsigned y0, unsigned y1, float* out, std::vector<float>& rows, std::vector<const float*>& row_ptrs) const
+		{
+			unsigned s0, s1;
+			ry.get_source_range(y0, y1, s0, s1);
+			size_t n_in = size_t(w_in)*nc, n_out = size_t(w_out)*nc;
+			rows.resize(n_in + (s1 - s0)*n_out);
+			float* input = &rows[0];
+			float* filtered = input + n_in;
+			for (unsigned y = s0; y < s1; ++y) {
+				load_row(y, z, input);
+				filter_row(rx, input, nc, filtered + (y - s0)*n_out, w_out);
+			}
+			row_ptrs.resize(ry.nr_taps);
+			for (unsigned y = y0; y < y1; ++y) {
+				for (unsigned k = 0; k < ry.nr_taps; ++k)
+					row_ptrs[k] = filtered + (ry.indices[y*ry.nr_taps + k] - s0)*n_out;
+				weighted_sum(&row_ptrs[0], &ry.weights[y*ry.nr_taps], ry.nr_taps, out + (y - y0)*n_out, n_out);
+			}
+		}
+		/// downsample a 2D image or a single slice
+		void downsample_2d(unsigned nr_threads)
+		{
+			size_t nr_bands = (h_out + band_size - 1) / band_size;
+			parallel_tasks(nr_bands, nr_threads, [this](size_t b) {
+				std::vector<float> rows, out;
+				std::vector<const float*> row_ptrs;
+				unsigned y0 = unsigned(b*band_size), y1 = std::min(h_out, y0 + band_size);
+				out.resize(size_t(y1 - y0)*w_out*nc);
+				filter_slice_band(0, y0, y1, &out[0], rows, row_ptrs);
+				for (unsigned y = y0; y < y1; ++y)
+					store_row(y, 0, &out[size_t(y - y0)*w_out*nc]);
+			});
+		}
+		/** downsample a volume slice by slice, where slices filtered within the slice plane are kept for all
+			destination slices that need them */
+		void downsample_3d(unsigned nr_threads)
+		{
+			size_t slice_size = size_t(w_out)*h_out*nc;
+			std::vector<std::vector<float> > slices(d_in);
+			size_t nr_bands = (h_out + band_size - 1) / band_size;
+			for (unsigned z = 0; z < d_out; ++z) {
+				const unsigned* Z = &rz.indices[z*rz.nr_taps];
+				const float* W = &rz.weights[z*rz.nr_taps];
+				// release slices that are not needed anymore
+				unsigned z_min = *std::min_element(Z, Z + rz.nr_taps);
+				for (unsigned i = 0; i < z_min; ++i)
+					std::vector<float>().swap(slices[i]);
+				// filter missing slices in parallel over slices and rows
+				std::vector<unsigned> missing;
+				for (unsigned k = 0; k < rz.nr_taps; ++k)
+					if (slices[Z[k]].empty() && std::find(missing.begin(), missing.end(), Z[k]) == missing.end()) {
+						missing.push_back(Z[k]);
+						slices[Z[k]].resize(slice_size);
+					}
+				parallel_tasks(missing.size()*nr_bands, nr_threads, [&](size_t t) {
+					std::vector<float> rows;
+					std::vector<const float*> row_ptrs;
+					unsigned zi = missing[t / nr_bands];
+					unsigned y0 = unsigned((t % nr_bands)*band_size), y1 = std::min(h_out, y0 + band_size);
+					filter_slice_band(zi, y0, y1, &slices[zi][size_t(y0)*w_out*nc], rows, row_ptrs);
+				});
+				// combine slices
+				parallel_tasks(nr_bands, nr_threads, [&](size_t b) {
+					std::vector<float> out(size_t(w_out)*nc);
+					std::vector<const float*> row_ptrs(rz.nr_taps);
+					unsigned y0 = unsigned(b*band_size), y1 = std::min(h_out, y0 + band_size);
+					for (unsigned y = y0; y < y1; ++y) {
+						for (unsigned k = 0; k < rz.nr_taps; ++k)
+							row_ptrs[k] = &slices[Z[k]][size_t(y)*w_out*nc];
+						weighted_sum(&row_ptrs[0], W, rz.nr_taps, &out[0], out.size());
+						store_row(y, z, &out[0]);
+					}
+				});
+			}
+		}
+	};
+}
+
+bool downsample_image(const const_data_view& src, const data_view& dst, const downsample_options& options)
+{
+	if (src.empty() || dst.empty() || src.get_dim() != dst.get_dim() || src.get_dim() < 1 || src.get_dim() > 3)
+		return false;
+	const data_format& sf = *src.get_format();
+	const data_format& df = *dst.get_format();
+	unsigned dim = src.get_dim();
+	// floats with the components of the source are the working format
+	std::string names;
+	for (unsigned c = 0; c < sf.get_nr_components(); ++c) {
+		if (c > 0)
+			names += ",";
+		names += sf.get_component_name(c);
+	}
+	component_format work_cf(TI_FLT32, names);
+	downsampler ds(options, sf, work_cf, df);
+	if (!ds.fc_in.is_valid() || !ds.fc_out.is_valid())
+		return false;
+	// the i-th view dimension corresponds to dimension dim-1-i of the data format
+	unsigned res_in[3] = { 1, 1, 1 }, res_out[3] = { 1, 1, 1 };
+	for (unsigned i = 0; i < dim; ++i) {
+		res_in[i] = sf.get_resolution(i);
+		res_out[i] = df.get_resolution(i);
+		if (res_in[i] == 0 || res_out[i] == 0)
+			return false;
+	}
+	ds.w_in = res_in[0]; ds.h_in = res_in[1]; ds.d_in = res_in[2];
+	ds.w_out = res_out[0]; ds.h_out = res_out[1]; ds.d_out = res_out[2];
+	// steps of slices, rows and entries, where missing dimensions have step 0
+	for (unsigned i = 0; i < 3; ++i) {
+		ds.src_steps[i] = i + dim < 3 ? 0 : src.get_step_size(i + dim - 3);
+		ds.dst_steps[i] = i + dim < 3 ? 0 : dst.get_step_size(i + dim - 3);
+	}
+	ds.src_ptr = src.get_ptr<unsigned char>();
+	ds.dst_ptr = dst.get_ptr<unsigned char>();
+	ds.rx.init(options, ds.w_in, ds.w_out);
+	ds.ry.init(options, ds.h_in, ds.h_out);
+	ds.rz.init(options, ds.d_in, ds.d_out);
+
+	unsigned nr_threads = cgv::os::get_nr_parallel_threads(options.nr_threads);
+	// small images are not worth the scheduling overhead
+	size_t nr_entries = size_t(ds.w_in)*ds.h_in*ds.d_in;
+	if (nr_entries < 65536)
+		nr_threads = 1;
+	// aim at several tasks per thread for load balancing
+	ds.band_size = std::max(1u, std::min(64u, ds.h_out / (4 * nr_threads)));
+	if (ds.d_in == 1 && ds.d_out == 1)
+		ds.downsample_2d(nr_threads);
+	else
+		ds.downsample_3d(nr_threads);
+	return true;
+}
+
+unsigned build_image_pyramid(const const_data_view& src, std::vector<data_view>& levels, const downsample_options& options, unsigned max_nr_levels)
+{
+	levels.clear();
+	if (src.empty() || src.get_dim() != src.get_format()->get_nr_dimensions())
+		return 0;
+	unsigned n = get_nr_pyramid_levels(*src.get_format()) - 1;
+	if (max_nr_levels > 0)
+		n = std::min(n, max_nr_levels);
+	levels.resize(n);
+	const data_format* prev_format = src.get_format();
+	for (unsigned i = 0; i < n; ++i) {
+		data_format* level_format = new data_format(get_downsampled_format(*prev_format));
+		data_view level(level_format);
+		level.manage_format(true);
+		levels[i] = level;
+		bool success = i == 0 ? downsample_image(src, levels[i], options) : downsample_image(levels[i - 1], levels[i], options);
+		if (!success) {
+			levels.clear();
+			return 0;
+		}
+		prev_format = level_format;
+	}
+	return n;
+}
+
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cgv/data/data_view.h>
+#include <vector>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace media {
+		namespace image {
+
+/// reconstruction filters used to downsample images
+enum DownsampleFilter {
+	DF_BOX,     /// average of the covered source entries, which equals the classic 2x2 or 2x2x2 mipmap filter
+	DF_KAISER,  /// sinc windowed with a Kaiser window of radius filter_radius and shape parameter kaiser_alpha
+	DF_LANCZOS  /// sinc windowed with a wider sinc of filter_radius lobes
+};
+
+/// options of downsample_image() and build_image_pyramid()
+struct CGV_API downsample_options
+{
+	/// reconstruction filter
+	DownsampleFilter filter;
+	/// radius of the Kaiser and Lanczos filters in destination entries, defaults to 3
+	float filter_radius;
+	/// shape parameter of the Kaiser window, defaults to 4
+	float kaiser_alpha;
+	/** whether components other than alpha store sRGB encoded values, which are filtered after conversion to
+		linear intensities to avoid darkening of averaged colors. Defaults to false. */
+	bool srgb;
+	/// number of threads, where 0 uses cgv::os::get_nr_parallel_threads() and 1 disables the use of the task scheduler
+	unsigned nr_threads;
+	/// construct options
+	downsample_options(DownsampleFilter _filter = DF_BOX, bool _srgb = false, unsigned _nr_threads = 0);
+};
+
+/** return the format of the next coarser pyramid level, whose resolution is halved in each dimension and rounded up,
+	where dimensions of resolution 1 are kept. */
+extern CGV_API cgv::data::data_format get_downsampled_format(const cgv::data::data_format& df);
+
+/// return the number of levels of a complete pyramid including the finest level
+extern CGV_API unsigned get_nr_pyramid_levels(const cgv::data::data_format& df);
+
+/** downsample a 2D image or 3D volume into the destination view of same dimension and component format. The
+	resolution of the destination can be chosen freely, but is typically the one of get_downsampled_format(). Any
+	component format supported by cgv::data::format_converter is filtered separably in single precision, where the
+	horizontal and vertical filter loops process four floats per SSE2 instruction if available. Bands of rows of the
+	destination and in case of volumes also the slices are filtered by tasks of the cgv::os scheduler. Returns false
+	if dimensions or component formats of the views do not match or the format is not supported. */
+extern CGV_API bool downsample_image(const cgv::data::const_data_view& src, const cgv::data::data_view& dst,
+	const downsample_options& options = downsample_options());
+
+/** build all coarser levels of a pyramid over the source image or volume down to a single entry, or at most
+	max_nr_levels levels if not 0. Each level is computed from the previous level and stored in a data view
+	that owns its format and data. Returns the number of computed levels, which excludes the source. */
+extern CGV_API unsigned build_image_pyramid(const cgv::data::const_data_view& src, std::vector<cgv::data::data_view>& levels,
+	const downsample_options& options = downsample_options(), unsigned max_nr_levels = 0);
+
+		}
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -1,7 +1,9 @@
 #include "image_reader.h"
 #include <cgv/base/register.h>
 #include <cgv/utils/scan.h>
+#include <cgv/utils/trace.h>
 #include <vector>
+#include <string.h>
 
 using namespace cgv::base;
 using namespace cgv::utils;
@@ -48,6 +50,41 @@ bool abst_image_reader::read_palette(unsigned int, const data_view&)
 	return false;
 }
 
+/// whether the reader decodes regions without decoding the complete image, the standard implementation returns false
+bool abst_image_reader::supports_region_read() const
+{
+	return false;
+}
+
+/// read the rectangular region with upper left corner (x,y) of the current image into the given data view
+bool abst_image_reader::read_region(const data_format& df, unsigned x, unsigned y, const data_view& dv)
+{
+	const data_format* rf = dv.get_format();
+	if (dv.empty() || !rf || rf->get_entry_size() != df.get_entry_size() ||
+		x + rf->get_width() > df.get_width() || y + rf->get_height() > df.get_height())
+		return false;
+	unsigned entry_size = df.get_entry_size();
+	unsigned row_size = rf->get_width()*entry_size;
+	unsigned char* dst_ptr = dv.get_ptr<unsigned char>();
+	if (supports_per_line_read()) {
+		std::vector<unsigned char> line(df.get_width()*entry_size);
+		data_view line_view(&df, &line[0]);
+		for (unsigned r = 0; r < y + rf->get_height(); ++r) {
+			if (!read_line(df, line_view(0)))
+				return false;
+			if (r >= y)
+				memcpy(dst_ptr + (r - y)*dv.get_step_size(0), &line[x*entry_size], row_size);
+		}
+		return true;
+	}
+	data_view image_view(&df);
+	if (!read_image(df, image_view))
+		return false;
+	for (unsigned r = 0; r < rf->get_height(); ++r)
+		memcpy(dst_ptr + r*dv.get_step_size(0), image_view.get_ptr<unsigned char>() + (y + r)*image_view.get_step_size(0) + x*entry_size, row_size);
+	return true;
+}
+
 /// interfaces that allows to listen to registration events
 struct reader_listener : public cgv::base::base, public cgv::base::registration_listener
 {
@@ -80,6 +117,14 @@ image_reader::image_reader(data_format& file_format, std::vector<data_format>* _
 {
 }
 
+/// destruct the chosen reader
+image_reader::~image_reader()
+{
+	if (rd)
+		delete rd;
+	rd = 0;
+}
+
 /// return a string with a list of supported extensions, where the list entries are separated with the passed character that defaults to a semicolon
 const std::string& image_reader::get_supported_extensions(char sep)
 {
@@ -120,6 +165,7 @@ const std::string& image_reader::get_last_error() const
 /// read the whole image into the given data pointer, set data format if not yet specified and allocate the data ptr if not yet done. If image file has not been opened yet, open it and close it after reading
 bool image_reader::read_image(const std::string& file_name, data_view& dv, std::vector<data_view> *palettes)
 {
+	CGV_TRACE_SCOPE("image_reader::read_image");
 	if (!open(file_name) || file_format_ptr->empty())
 		return false;
 	if (!read_image(dv, palettes) || !close())
@@ -150,6 +196,8 @@ bool image_reader::open(const std::string& file_name)
 	std::vector<base_ptr>& readers = reader_listener::ref_readers();
 	for (unsigned int i=0; i<readers.size(); ++i) {
 		if (cgv::utils::is_element(ext, readers[i]->get_interface<abst_image_reader>()->get_supported_extensions())) {
+			if (rd)
+				delete rd;
 			rd = readers[i]->get_interface<abst_image_reader>()->clone();
 			return rd->open(file_name, *file_format_ptr, palette_formats);
 		}
@@ -285,6 +333,46 @@ bool image_reader::read_image(const data_view& dv, const std::vector<data_view>
 	return rd->read_image(*file_format_ptr, dv);
 }
 
+/// whether the reader decodes regions without decoding the complete image
+bool image_reader::supports_region_read() const
+{
+	if (!rd)
+		return false;
+	return rd->supports_region_read();
+}
+
+/// read the region of width w and height h with upper left corner (x,y) and allocate the data view if it is empty
+bool image_reader::read_region(unsigned x, unsigned y, unsigned w, unsigned h, data_view& dv)
+{
+	if (!rd || x + w > file_format_ptr->get_width() || y + h > file_format_ptr->get_height())
+		return false;
+	if (dv.empty()) {
+		data_format* region_format = new data_format(*file_format_ptr);
+		region_format->set_width(w);
+		region_format->set_height(h);
+		new(&dv) data_view(region_format);
+		dv.manage_format();
+	}
+	return read_region(x, y, dv);
+}
+
+/// read the region with upper left corner (x,y) and the resolution of the format of a preallocated data view
+bool image_reader::read_region(unsigned x, unsigned y, const data_view& dv)
+{
+	if (!rd || dv.empty())
+		return false;
+	return rd->read_region(*file_format_ptr, x, y, dv);
+}
+
+/// open the file, read the region and close the file
+bool image_reader::read_region(const std::string& file_name, unsigned x, unsigned y, unsigned w, unsigned h, data_view& dv)
+{
+	if (!open(file_name) || file_format_ptr->empty())
+		return false;
+	bool success = read_region(x, y, w, h, dv);
+	return close() && success;
+}
+
 /// close the image file
 bool image_reader::close()
 {
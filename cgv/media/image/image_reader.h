@@ -51,6 +51,14 @@ public:
 		The number of images can be determined despite of the method \c get_nr_images() by calling this method until it 
 		returns false. */
 	virtual bool read_image(const data_format& df, const data_view& dv) = 0;
+	/// whether the reader decodes regions without decoding the complete image, the standard implementation returns false
+	virtual bool supports_region_read() const;
+	//! read the rectangular region with upper left corner (x,y) of the current image into the given data view.
+	/*! The resolution of the region is defined by the format of the data view, whose entries must have the size 
+	    of the entries in the file format df. The standard implementation streams the lines up to the last row of 
+		the region through \c read_line() if per line reading is supported and otherwise reads the whole image 
+		into a temporary buffer. In both cases the current image cannot be read again afterwards. */
+	virtual bool read_region(const data_format& df, unsigned x, unsigned y, const data_view& dv);
 	/// close the image file
 	virtual bool close() = 0;
 
@@ -79,6 +87,8 @@ public:
 		paletted image formats to non paletted ones. In case palettes are used, the components in the file_format
 		will be '0', '1', ... for the components that reference the i-th palette. */
 	image_reader(data_format& file_format, std::vector<data_format>* palette_formats = 0);
+	/// destruct the chosen reader
+	~image_reader();
 	/// overload to return the type name of this object
 	std::string get_type_name() const;
 	/// return a string with a list of supported extensions, where the list entries are separated with the passed character that defaults to a semicolon
@@ -139,6 +149,17 @@ public:
 	bool read_image(data_view& dv, std::vector<data_view> *palettes = 0);
 	/// read image to a data_view with the correct format and an allocated pointer
 	bool read_image(const data_view& dv, const std::vector<data_view> *palettes = 0);
+	/// return whether the reader decodes regions without decoding the complete image (only valid after successfully opening an image file)
+	bool supports_region_read() const;
+	/** read the region of width w and height h with upper left corner (x,y) from an opened image file into the
+	    given data view. If the data view is empty, construct a format of the region's resolution with the 
+		components of the file format and allocate memory for the region only. Format and data pointer are then 
+		owned by the view. */
+	bool read_region(unsigned x, unsigned y, unsigned w, unsigned h, data_view& dv);
+	/// read the region with upper left corner (x,y) and the resolution of the format of a preallocated data view
+	bool read_region(unsigned x, unsigned y, const data_view& dv);
+	/// open the file, read the region as in the method above and close the file
+	bool read_region(const std::string& file_name, unsigned x, unsigned y, unsigned w, unsigned h, data_view& dv);
 	/// close the image file
 	bool close();
 };
@@ -4,6 +4,7 @@
 #include <cgv/type/standard_types.h>
 #include <cgv/utils/advanced_scan.h>
 #include <cgv/utils/tokenizer.h>
+#include <cgv/utils/trace.h>
 #include <cgv/base/import.h>
 
 using namespace cgv::math;
@@ -189,6 +190,7 @@ void obj_reader_generic<T>::parse_and_process_texcoord(const std::vector<cgv::ut
 
 bool obj_reader_base::read_obj(const std::string& file_name)
 {
+	CGV_TRACE_SCOPE("obj_reader::read_obj");
 	std::string content;
 	if (!cgv::base::read_data_file(file_name, content, true))
 		return false;
@@ -1,5 +1,6 @@
 #include "simple_mesh.h"
 #include <cgv/math/inv.h>
+#include <cgv/math/transform_points.h>
 #include <cgv/media/mesh/obj_reader.h>
 #include <cgv/math/bucket_sort.h>
 #include <fstream>
@@ -443,10 +444,9 @@ void simple_mesh<T>::transform(const mat3& linear_transformation, const vec3& tr
 template <typename T>
 void simple_mesh<T>::transform(const mat3& linear_transform, const vec3& translation, const mat3& inverse_linear_transform)
 {
-	for (auto& p : positions)
-		p = linear_transform * p + translation;
-	for (auto& n : normals)
-		n = n * inverse_linear_transform;
+	cgv::math::transform_points(linear_transform, translation, positions.data(), positions.data(), positions.size());
+	// multiplying normals from the left equals multiplication with the transposed matrix
+	cgv::math::transform_vectors(transpose(inverse_linear_transform), normals.data(), normals.data(), normals.size());
 }
 
 /// construct from string corresponding to conway notation (defaults to empty mesh)
@@ -165,5 +165,102 @@ bool riff_reader::read(const std::string& file_name)
 	return true;
 }
 
+/// seek with 64 bit offsets
+static int seek64(FILE* fp, long long offset, int origin)
+{
+#ifdef _MSC_VER
+	return _fseeki64(fp, offset, origin);
+#else
+	return fseeko(fp, off_t(offset), origin);
+#endif
+}
+
+/// tell with 64 bit offsets
+static long long tell64(FILE* fp)
+{
+#ifdef _MSC_VER
+	return _ftelli64(fp);
+#else
+	return (long long)ftello(fp);
+#endif
+}
+
+riff_writer::riff_writer() : fp(0)
+{
+}
+
+riff_writer::~riff_writer()
+{
+	if (fp)
+		close();
+}
+
+bool riff_writer::open(const std::string& file_name)
+{
+	if (fp)
+		close();
+	fp = fopen(file_name.c_str(), "wb");
+	return fp != 0;
+}
+
+long long riff_writer::tell() const
+{
+	return fp ? tell64(fp) : -1;
+}
+
+bool riff_writer::begin_list(fourcc id, fourcc hdr)
+{
+	unsigned size = 0;
+	list_offsets.push_back(tell64(fp) + 4);
+	return write(&id.id, 4) && write(&size, 4) && write(&hdr.id, 4);
+}
+
+bool riff_writer::end_list()
+{
+	if (list_offsets.empty())
+		return false;
+	long long offset = list_offsets.back();
+	list_offsets.pop_back();
+	unsigned size = unsigned(tell64(fp) - offset - 4);
+	return write_at(offset, &size, 4);
+}
+
+bool riff_writer::write_chunk(fourcc id, const void* data, unsigned size)
+{
+	if (!write(&id.id, 4) || !write(&size, 4) || !write(data, size))
+		return false;
+	if ((size & 1) == 1) {
+		char pad = 0;
+		return write(&pad, 1);
+	}
+	return true;
+}
+
+bool riff_writer::write(const void* data, size_t size)
+{
+	return size == 0 || fwrite(data, 1, size, fp) == size;
+}
+
+bool riff_writer::write_at(long long offset, const void* data, size_t size)
+{
+	long long current = tell64(fp);
+	if (seek64(fp, offset, SEEK_SET) != 0)
+		return false;
+	bool success = write(data, size);
+	return seek64(fp, current, SEEK_SET) == 0 && success;
+}
+
+bool riff_writer::close()
+{
+	if (!fp)
+		return false;
+	bool success = true;
+	while (!list_offsets.empty())
+		success = end_list() && success;
+	success = fclose(fp) == 0 && success;
+	fp = 0;
+	return success;
+}
+
 	}
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <stdio.h>
 #include <iostream>
 
@@ -62,6 +63,42 @@ public:
 	bool read(const std::string& file_name);
 };
 
+/** writer class for riff files such as .avi. Lists are opened with begin_list() and their sizes are written in
+    end_list(). File offsets are 64 bit such that OpenDML files with several RIFF lists larger than 4GB in total
+	can be written, while each single list needs to be smaller than 4GB. */
+class CGV_API riff_writer
+{
+protected:
+	FILE* fp;
+	/// file offsets of the size fields of the open lists
+	std::vector<long long> list_offsets;
+public:
+	/// construct writer without file
+	riff_writer();
+	/// close file if still open
+	~riff_writer();
+	/// open file for writing
+	bool open(const std::string& file_name);
+	/// check whether file is open
+	bool is_open() const { return fp != 0; }
+	/// return current file offset
+	long long tell() const;
+	/// return number of open lists
+	size_t get_nr_open_lists() const { return list_offsets.size(); }
+	/// start a RIFF or LIST chunk with the given header, whose size is written in the corresponding call to end_list()
+	bool begin_list(fourcc id, fourcc hdr);
+	/// finish the innermost open list
+	bool end_list();
+	/// write chunk with given id and data and pad it to an even size
+	bool write_chunk(fourcc id, const void* data, unsigned size);
+	/// write raw data at current offset
+	bool write(const void* data, size_t size);
+	/// overwrite data at the given file offset and return to current offset afterwards
+	bool write_at(long long offset, const void* data, size_t size);
+	/// finish all open lists and close file
+	bool close();
+};
+
 	}
 }
 
@@ -2,10 +2,32 @@
 
 #include <string>
 #include <map>
+#include <memory>
 
 namespace cgv {
 	namespace os {
 
+/** interface to push the body of a chunked http response from an arbitrary thread. A stream stays
+    valid after web_server::handle_request returned and can be kept to send rendered frames or state
+	updates until it is closed. */
+struct http_stream
+{
+	virtual ~http_stream() {}
+	/// send data as one chunk, returns false if the connection is closed or too much data waits for being sent
+	virtual bool write(const void* data, size_t size) = 0;
+	/// send string as one chunk
+	bool write(const std::string& data) { return write(data.data(), data.size()); }
+	/// check whether the client is still connected and the stream has not been closed
+	virtual bool is_open() const = 0;
+	/// return the number of bytes that wait for being sent on the connection
+	virtual size_t get_nr_pending_bytes() const = 0;
+	/// terminate the response, which is also done on destruction of the last reference
+	virtual void close() = 0;
+};
+
+/// shared pointer to a http stream
+typedef std::shared_ptr<http_stream> http_stream_ptr;
+
 /// structure that contains all input and output parameters of a http request
 struct http_request
 {
@@ -32,6 +54,8 @@ struct http_request
 	std::string accept_language;
 	std::string accept_encoding;
 	std::string user_agent;
+	/// body of the request, i.e. of a POST request
+	std::string content;
 
 	/**@name return values*/
 	//@{
@@ -45,6 +69,18 @@ struct http_request
 	std::string auth_realm;
 	/// set this member to the html page to be returned
 	std::string answer;
+	/// mime type of the answer, which defaults to html if empty
+	std::string content_type;
+	/// if not empty, the content of this file is returned instead of answer without copying it through user space
+	std::string file_name;
+	/** set to true to answer with a chunked response whose body is pushed through stream. This is
+	    only supported if the web server provider set stream to a non empty pointer. */
+	bool streaming;
+	/// stream to the client set by web server providers that support streaming
+	http_stream_ptr stream;
+	//@}
+	/// construct with default values
+	http_request() : authentication_given(false), streaming(false) {}
 };
 
 	}
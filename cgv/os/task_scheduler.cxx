@@ -0,0 +1,368 @@
+#include "task_scheduler.h"
+#include <cgv/utils/parallel_tasks.h>
+#include <iostream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace cgv {
+	namespace os {
+
+/// scheduler of which the calling thread is a worker or 0
+static thread_local const task_scheduler* current_scheduler = 0;
+/// index of the calling thread among the workers of current_scheduler
+static thread_local unsigned current_worker = 0;
+/// number of nested tasks executed by the calling thread, which can be a waiting thread that is not a worker
+static thread_local unsigned nr_executing = 0;
+
+task_group::task_group(ExecutionPriority ep) : scheduler(ref_task_scheduler()), priority(ep), nr_pending(0), cancelled(false)
+{
+}
+
+task_group::task_group(task_scheduler& _scheduler, ExecutionPriority ep) : scheduler(_scheduler), priority(ep), nr_pending(0), cancelled(false)
+{
+}
+
+task_group::~task_group()
+{
+	scheduler.wait_for(*this);
+}
+
+void task_group::set_exception(std::exception_ptr e)
+{
+	std::lock_guard<std::mutex> lock(exception_mtx);
+	if (!first_exception)
+		first_exception = e;
+}
+
+size_t task_group::get_default_grain_size(size_t n) const
+{
+	return std::max(size_t(1), n / (8 * (scheduler.get_nr_threads() + 1)));
+}
+
+void task_group::run(const std::function<void()>& f)
+{
+	if (is_cancelled())
+		return;
+	++nr_pending;
+	task_scheduler::task* t = new task_scheduler::task;
+	t->function = f;
+	t->group = this;
+	scheduler.push(t, priority);
+}
+
+bool task_group::wait()
+{
+	scheduler.wait_for(*this);
+	std::exception_ptr e;
+	{
+		std::lock_guard<std::mutex> lock(exception_mtx);
+		e = first_exception;
+		first_exception = std::exception_ptr();
+	}
+	if (e)
+		std::rethrow_exception(e);
+	return !is_cancelled();
+}
+
+void task_group::cancel()
+{
+	cancelled = true;
+}
+
+bool task_group::is_cancelled() const
+{
+	return cancelled.load();
+}
+
+size_t task_group::get_nr_pending() const
+{
+	return nr_pending.load();
+}
+
+task_scheduler::task_scheduler(unsigned nr_threads, bool _pin_threads) : pin_threads(_pin_threads), nr_queued(0), nr_detached(0), nr_sleeping(0), terminate(false)
+{
+	start(nr_threads);
+}
+
+task_scheduler::~task_scheduler()
+{
+	stop();
+}
+
+unsigned task_scheduler::get_default_nr_threads()
+{
+	return std::max(2u, std::thread::hardware_concurrency()) - 1;
+}
+
+unsigned task_scheduler::get_nr_threads() const
+{
+	return unsigned(workers.size());
+}
+
+void task_scheduler::start(unsigned nr_threads)
+{
+	if (nr_threads == 0)
+		nr_threads = get_default_nr_threads();
+	terminate = false;
+	for (unsigned i = 0; i <= nr_threads; ++i)
+		queues.push_back(new task_queue);
+	for (unsigned i = 0; i < nr_threads; ++i) {
+		workers.push_back(std::thread(&task_scheduler::work, this, i));
+		if (pin_threads)
+			apply_affinity(i);
+	}
+}
+
+void task_scheduler::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleep_mtx);
+		terminate = true;
+	}
+	sleep_cv.notify_all();
+	for (size_t i = 0; i < workers.size(); ++i)
+		workers[i].join();
+	workers.clear();
+	for (size_t i = 0; i < queues.size(); ++i)
+		delete queues[i];
+	queues.clear();
+}
+
+bool task_scheduler::set_nr_threads(unsigned nr_threads)
+{
+	if (is_worker_thread() || nr_executing > 0)
+		return false;
+	stop();
+	start(nr_threads);
+	return true;
+}
+
+bool task_scheduler::apply_affinity(unsigned wi)
+{
+#ifdef __linux__
+	cpu_set_t process_set, set;
+	if (sched_getaffinity(getpid(), sizeof(process_set), &process_set) != 0)
+		return false;
+	if (pin_threads) {
+		// leave the first core to the thread that waits for the tasks
+		int k = int((wi + 1) % CPU_COUNT(&process_set));
+		CPU_ZERO(&set);
+		for (int c = 0; c < CPU_SETSIZE; ++c)
+			if (CPU_ISSET(c, &process_set) && k-- == 0) {
+				CPU_SET(c, &set);
+				break;
+			}
+	}
+	else
+		set = process_set;
+	return pthread_setaffinity_np(workers[wi].native_handle(), sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+bool task_scheduler::set_thread_affinity(bool _pin_threads)
+{
+#ifdef __linux__
+	pin_threads = _pin_threads;
+	bool success = true;
+	for (unsigned i = 0; i < workers.size(); ++i)
+		if (!apply_affinity(i))
+			success = false;
+	return success;
+#else
+	return !_pin_threads;
+#endif
+}
+
+bool task_scheduler::is_worker_thread() const
+{
+	return current_scheduler == this;
+}
+
+unsigned task_scheduler::get_queue_index() const
+{
+	return is_worker_thread() ? current_worker : unsigned(workers.size());
+}
+
+void task_scheduler::spawn(const std::function<void()>& f, ExecutionPriority ep)
+{
+	task* t = new task;
+	t->function = f;
+	t->group = 0;
+	++nr_detached;
+	{
+		std::lock_guard<std::mutex> lock(detached_queue.mtx);
+		detached_queue.tasks[ep].push_back(t);
+	}
+	// threads waiting for groups ignore detached tasks, so a single notification could get lost
+	if (nr_sleeping.load() > 0) {
+		std::lock_guard<std::mutex> lock(sleep_mtx);
+		sleep_cv.notify_all();
+	}
+}
+
+void task_scheduler::push(task* t, ExecutionPriority ep)
+{
+	// count before queuing, such that nr_queued is never smaller than the number of queued tasks
+	++nr_queued;
+	task_queue& q = *queues[get_queue_index()];
+	{
+		std::lock_guard<std::mutex> lock(q.mtx);
+		q.tasks[ep].push_back(t);
+	}
+	if (nr_sleeping.load() > 0) {
+		std::lock_guard<std::mutex> lock(sleep_mtx);
+		sleep_cv.notify_one();
+	}
+}
+
+task_scheduler::task* task_scheduler::pop(unsigned qi, bool detached)
+{
+	bool groups = nr_queued.load() > 0;
+	detached = detached && nr_detached.load() > 0;
+	if (!groups && !detached)
+		return 0;
+	unsigned n = unsigned(queues.size());
+	for (int p = nr_priorities - 1; p >= 0; --p) {
+		for (unsigned k = 0; groups && k < n; ++k) {
+			unsigned i = (qi + k) % n;
+			task_queue& q = *queues[i];
+			std::lock_guard<std::mutex> lock(q.mtx);
+			std::deque<task*>& tasks = q.tasks[p];
+			if (tasks.empty())
+				continue;
+			task* t;
+			// workers take their newest task, all other tasks are taken in the order of submission
+			if (k == 0 && i < workers.size()) {
+				t = tasks.back();
+				tasks.pop_back();
+			}
+			else {
+				t = tasks.front();
+				tasks.pop_front();
+			}
+			--nr_queued;
+			return t;
+		}
+		if (detached) {
+			std::lock_guard<std::mutex> lock(detached_queue.mtx);
+			std::deque<task*>& tasks = detached_queue.tasks[p];
+			if (!tasks.empty()) {
+				task* t = tasks.front();
+				tasks.pop_front();
+				--nr_detached;
+				return t;
+			}
+		}
+	}
+	return 0;
+}
+
+void task_scheduler::execute(task* t)
+{
+	task_group* g = t->group;
+	if (!g || !g->is_cancelled()) {
+		++nr_executing;
+		try {
+			t->function();
+		}
+		catch (...) {
+			if (g)
+				g->set_exception(std::current_exception());
+			else
+				std::cerr << "task_scheduler: uncaught exception in spawned task" << std::endl;
+		}
+		--nr_executing;
+	}
+	// destruct captured state before the group can be destructed by a waiting thread
+	delete t;
+	if (!g)
+		return;
+	// the group must not be accessed after the decrement
+	if (g->nr_pending.fetch_sub(1) == 1 && nr_sleeping.load() > 0) {
+		std::lock_guard<std::mutex> lock(sleep_mtx);
+		sleep_cv.notify_all();
+	}
+}
+
+void task_scheduler::work(unsigned wi)
+{
+	current_scheduler = this;
+	current_worker = wi;
+	while (true) {
+		task* t = pop(wi, true);
+		if (t) {
+			execute(t);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleep_mtx);
+		if (terminate && nr_queued.load() == 0 && nr_detached.load() == 0)
+			break;
+		++nr_sleeping;
+		while (nr_queued.load() == 0 && nr_detached.load() == 0 && !terminate)
+			sleep_cv.wait(lock);
+		--nr_sleeping;
+	}
+	current_scheduler = 0;
+}
+
+void task_scheduler::wait_for(task_group& g)
+{
+	unsigned qi = get_queue_index();
+	while (g.nr_pending.load() != 0) {
+		task* t = pop(qi, false);
+		if (t) {
+			execute(t);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleep_mtx);
+		++nr_sleeping;
+		while (nr_queued.load() == 0 && g.nr_pending.load() != 0)
+			sleep_cv.wait(lock);
+		--nr_sleeping;
+		// pass on a notification for a new task that was consumed by the completion of the group
+		if (g.nr_pending.load() == 0 && nr_queued.load() > 0 && nr_sleeping.load() > 0)
+			sleep_cv.notify_one();
+	}
+}
+
+task_scheduler& ref_task_scheduler()
+{
+	static task_scheduler scheduler;
+	return scheduler;
+}
+
+namespace {
+	/// execute the tasks of cgv::utils::parallel_tasks() with nr_threads - 1 team members queued in a task group
+	void execute_parallel_tasks(size_t nr_tasks, unsigned nr_threads, const std::function<void(size_t)>& f)
+	{
+		std::atomic<size_t> next_task(0);
+		auto process = [&]() {
+			for (size_t t = next_task++; t < nr_tasks; t = next_task++)
+				f(t);
+		};
+		task_group g;
+		for (unsigned t = 1; t < nr_threads; ++t)
+			g.run(process);
+		process();
+		g.wait();
+	}
+	unsigned get_default_nr_parallel_tasks_threads()
+	{
+		return get_nr_parallel_threads();
+	}
+	/// route the thread teams of the libraries below cgv_os to the process wide scheduler while cgv_os is loaded
+	struct parallel_tasks_handler_installer
+	{
+		parallel_tasks_handler_installer() { cgv::utils::set_parallel_tasks_handler(&execute_parallel_tasks, &get_default_nr_parallel_tasks_threads); }
+		~parallel_tasks_handler_installer() { cgv::utils::set_parallel_tasks_handler(0, 0); }
+	} installer;
+}
+
+	}
+}
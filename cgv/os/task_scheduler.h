@@ -0,0 +1,248 @@
+#pragma once
+
+#include "priority.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace os {
+
+class task_scheduler;
+
+/** set of tasks that are forked with run() and joined with wait(). A thread that waits for a group executes pending
+	tasks of the scheduler meanwhile, such that groups can be nested arbitrarily inside of tasks. The parallel_for(),
+	parallel_for_ranges() and parallel_reduce() methods split an index range recursively into tasks of at least
+	grain_size indices, where a grain size of 0 selects about eight tasks per thread. A group can be cancelled from any
+	thread, after which its tasks that have not been started are skipped and parallel loops stop splitting. The first
+	exception thrown by a task is rethrown in wait(). The destructor waits for all tasks of the group. */
+class CGV_API task_group
+{
+protected:
+	friend class task_scheduler;
+	/// scheduler that executes the tasks
+	task_scheduler& scheduler;
+	/// priority of the tasks of this group
+	ExecutionPriority priority;
+	/// number of tasks that have not been completed
+	std::atomic<size_t> nr_pending;
+	/// whether the group has been cancelled
+	std::atomic<bool> cancelled;
+	/// protects first_exception
+	std::mutex exception_mtx;
+	/// first exception thrown by a task
+	std::exception_ptr first_exception;
+	/// store the exception if it is the first one
+	void set_exception(std::exception_ptr e);
+	/// return the grain size used for n indices if none is specified
+	size_t get_default_grain_size(size_t n) const;
+	/// fork the upper halves of [begin,end) until grain_size is reached and process the remaining lower part
+	template <typename F>
+	void run_range(size_t begin, size_t end, size_t grain_size, const F* f)
+	{
+		while (end - begin > grain_size && !is_cancelled()) {
+			size_t middle = begin + (end - begin) / 2;
+			run([this, middle, end, grain_size, f]() { run_range(middle, end, grain_size, f); });
+			end = middle;
+		}
+		if (!is_cancelled())
+			(*f)(begin, end);
+	}
+public:
+	/// construct group of the process wide scheduler whose tasks are executed with the given priority
+	task_group(ExecutionPriority ep = EP_NORMAL);
+	/// construct group of the given scheduler
+	task_group(task_scheduler& _scheduler, ExecutionPriority ep = EP_NORMAL);
+	/// wait for all tasks, where exceptions are discarded
+	~task_group();
+	/// fork a task
+	void run(const std::function<void()>& f);
+	/// join all tasks, rethrow the first exception of a task and return false if the group has been cancelled
+	bool wait();
+	/// skip all tasks of the group that have not been started yet
+	void cancel();
+	/// return whether the group has been cancelled, what long running tasks can check to stop early
+	bool is_cancelled() const;
+	/// return the number of tasks that have not been completed
+	size_t get_nr_pending() const;
+	/// return the priority of the tasks
+	ExecutionPriority get_priority() const { return priority; }
+	/// call f(b,e) for disjoint subranges [b,e) that cover [begin,end) in parallel and join, returns false if cancelled
+	template <typename F>
+	bool parallel_for_ranges(size_t begin, size_t end, const F& f, size_t grain_size = 0)
+	{
+		if (begin < end) {
+			if (grain_size == 0)
+				grain_size = get_default_grain_size(end - begin);
+			run_range(begin, end, grain_size, &f);
+		}
+		return wait();
+	}
+	/// call f(i) for all i in [begin,end) in parallel and join, returns false if cancelled
+	template <typename F>
+	bool parallel_for(size_t begin, size_t end, const F& f, size_t grain_size = 0)
+	{
+		return parallel_for_ranges(begin, end, [&f](size_t b, size_t e) {
+			for (size_t i = b; i < e; ++i)
+				f(i);
+		}, grain_size);
+	}
+	/** reduce [begin,end) in parallel, where each chunk [b,e) of grain_size indices is reduced with f(b,e,identity)
+		and the results of the chunks are combined with reduce(x,y) in the order of the chunks, such that the result
+		does not depend on the scheduling. Returns identity if cancelled. */
+	template <typename T, typename F, typename R>
+	T parallel_reduce(size_t begin, size_t end, const T& identity, const F& f, const R& reduce, size_t grain_size = 0)
+	{
+		if (begin >= end)
+			return identity;
+		if (grain_size == 0)
+			grain_size = get_default_grain_size(end - begin);
+		size_t nr_chunks = (end - begin + grain_size - 1) / grain_size;
+		std::vector<T> partial(nr_chunks, identity);
+		if (!parallel_for(0, nr_chunks, [&](size_t c) {
+				size_t b = begin + c * grain_size;
+				partial[c] = f(b, std::min(end, b + grain_size), identity);
+			}, 1))
+			return identity;
+		T result = identity;
+		for (size_t c = 0; c < nr_chunks; ++c)
+			result = reduce(result, partial[c]);
+		return result;
+	}
+};
+
+/** work stealing scheduler that executes tasks on a fixed set of worker threads. Each worker owns a queue per
+	priority, into which the tasks forked by the worker are pushed. Workers execute their newest local task first and
+	steal the oldest tasks of other workers if they run out of work, such that forked ranges are split close to their
+	root. Tasks submitted by other threads enter a shared queue. Tasks of higher priority are always taken before
+	tasks of lower priority. Idle workers sleep until new tasks arrive. On Linux the workers can be pinned to cores.
+	The process wide scheduler is accessed with ref_task_scheduler(), its number of threads can be configured with
+	set_nr_threads() as long as no tasks are in flight. */
+class CGV_API task_scheduler
+{
+protected:
+	friend class task_group;
+	/// number of task priorities, which correspond to the values of ExecutionPriority
+	static const unsigned nr_priorities = 3;
+	/// a task together with the group it belongs to, which is 0 for tasks submitted with spawn()
+	struct task
+	{
+		std::function<void()> function;
+		task_group* group;
+	};
+	/// double ended queues of tasks per priority protected by a mutex
+	struct task_queue
+	{
+		std::mutex mtx;
+		std::deque<task*> tasks[nr_priorities];
+	};
+	/// one queue per worker followed by the shared queue of all other threads
+	std::vector<task_queue*> queues;
+	/// queue of the tasks submitted with spawn(), which are only executed by workers
+	task_queue detached_queue;
+	/// worker threads
+	std::vector<std::thread> workers;
+	/// whether workers are pinned to cores
+	bool pin_threads;
+	/// number of queued tasks of groups
+	std::atomic<size_t> nr_queued;
+	/// number of queued tasks in detached_queue
+	std::atomic<size_t> nr_detached;
+	/// number of threads that sleep in sleep_cv
+	std::atomic<unsigned> nr_sleeping;
+	/// whether the workers should terminate after all queued tasks have been executed
+	std::atomic<bool> terminate;
+	/// protects sleeping
+	std::mutex sleep_mtx;
+	/// signals new tasks, completed groups and termination
+	std::condition_variable sleep_cv;
+	/// start nr_threads workers
+	void start(unsigned nr_threads);
+	/// execute all queued tasks and join the workers
+	void stop();
+	/// main loop of worker wi
+	void work(unsigned wi);
+	/// return the queue index of the calling thread, which is the number of workers for other threads
+	unsigned get_queue_index() const;
+	/// queue a task of a group in the queue of the calling thread and wake a sleeping thread
+	void push(task* t, ExecutionPriority ep);
+	/** take the task of highest priority, preferring the newest task of queue qi and the oldest tasks of other
+		queues, where detached tasks are only considered if requested */
+	task* pop(unsigned qi, bool detached);
+	/// execute and delete a task and complete its group
+	void execute(task* t);
+	/// execute tasks until all tasks of the group have been completed
+	void wait_for(task_group& g);
+	/// apply pin_threads to worker wi
+	bool apply_affinity(unsigned wi);
+public:
+	/// construct scheduler with nr_threads workers, where 0 selects get_default_nr_threads()
+	task_scheduler(unsigned nr_threads = 0, bool _pin_threads = false);
+	/// execute all queued tasks and join the workers
+	~task_scheduler();
+	/// return the number of hardware threads minus one for the thread that waits for the tasks, but at least one
+	static unsigned get_default_nr_threads();
+	/// return the number of worker threads
+	unsigned get_nr_threads() const;
+	/** restart the scheduler with nr_threads workers, where 0 selects get_default_nr_threads(). Queued tasks are
+		executed before. Must not be called from a task or concurrently to other calls and returns false otherwise. */
+	bool set_nr_threads(unsigned nr_threads);
+	/** pin worker i to core i+1 modulo the number of cores of the process, leaving the first core to the waiting
+		thread, or allow all cores of the process again. Pinning is only supported on Linux and fails elsewhere. */
+	bool set_thread_affinity(bool _pin_threads);
+	/// return whether workers are pinned to cores
+	bool get_thread_affinity() const { return pin_threads; }
+	/// return whether the calling thread is a worker of this scheduler
+	bool is_worker_thread() const;
+	/** submit a task that does not belong to a group. Detached tasks are only executed by workers and not by threads
+		waiting for a group, such that long running background tasks do not delay the waiting thread. Exceptions
+		thrown by them are reported on std::cerr. */
+	void spawn(const std::function<void()>& f, ExecutionPriority ep = EP_NORMAL);
+};
+
+/// return the process wide task scheduler, which is constructed with the default number of threads on first access
+extern CGV_API task_scheduler& ref_task_scheduler();
+
+/** return nr_threads if it is not 0 and otherwise the number of threads that execute a parallel loop of the process
+	wide scheduler, which are its workers and the waiting thread. Used to resolve nr_threads parameters of algorithms. */
+inline unsigned get_nr_parallel_threads(unsigned nr_threads = 0)
+{
+	return nr_threads != 0 ? nr_threads : ref_task_scheduler().get_nr_threads() + 1;
+}
+
+/// parallel loop calling f(i) for all i in [begin,end) with a temporary task group of the process wide scheduler
+template <typename F>
+bool parallel_for(size_t begin, size_t end, const F& f, size_t grain_size = 0, ExecutionPriority ep = EP_NORMAL)
+{
+	task_group g(ep);
+	return g.parallel_for(begin, end, f, grain_size);
+}
+
+/// parallel loop calling f(b,e) for subranges of [begin,end) with a temporary task group of the process wide scheduler
+template <typename F>
+bool parallel_for_ranges(size_t begin, size_t end, const F& f, size_t grain_size = 0, ExecutionPriority ep = EP_NORMAL)
+{
+	task_group g(ep);
+	return g.parallel_for_ranges(begin, end, f, grain_size);
+}
+
+/// parallel reduction of [begin,end) with a temporary task group of the process wide scheduler
+template <typename T, typename F, typename R>
+T parallel_reduce(size_t begin, size_t end, const T& identity, const F& f, const R& reduce, size_t grain_size = 0, ExecutionPriority ep = EP_NORMAL)
+{
+	task_group g(ep);
+	return g.parallel_reduce(begin, end, identity, f, reduce, grain_size);
+}
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -40,10 +40,10 @@ void web_server::start()
 /// can only be called from a different thread
 void web_server::stop()
 {
-	if (user_data && ref_provider()) 
-		ref_provider()->stop_web_server(this);
-	else
+	if (!ref_provider())
 		std::cerr << "no web server provider registered, please use the co_web plugin" << std::endl;
+	else if (user_data)
+		ref_provider()->stop_web_server(this);
 }
 
 
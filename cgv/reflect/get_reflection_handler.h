@@ -26,6 +26,10 @@ public:
 	/// copy value of member to external value pointer
 	void process_member_void(const std::string& member_name, void* member_ptr, 
 						     abst_reflection_traits* rt, GroupKind group_kind, unsigned grp_size);
+	/** copy the member described by rt to the value given by value_rt or, if value_rt is 0, by value_type
+	    and return whether a conversion was found. This is shared with cgv::reflect::property_index. */
+	static bool get_value(const void* member_ptr, abst_reflection_traits* rt, const std::string& value_type,
+						  void* value_ptr, abst_reflection_traits* value_rt = 0);
 };
 
 #ifdef REFLECT_TRAITS_WITH_DECLTYPE
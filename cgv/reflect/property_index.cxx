@@ -0,0 +1,208 @@
+#include "property_index.h"
+#include "set_reflection_handler.h"
+#include "get_reflection_handler.h"
+#include <cgv/type/standard_types.h>
+#include <cgv/utils/convert.h>
+
+using namespace cgv::type;
+using namespace cgv::type::info;
+
+namespace cgv {
+	namespace reflect {
+
+namespace {
+	/// compiled assignment with the same conversion semantics as cgv::type::assign_variant
+	template <typename D, typename S>
+	void assign(void* dst_ptr, const void* src_ptr)
+	{
+		*static_cast<D*>(dst_ptr) = (D) *static_cast<const S*>(src_ptr);
+	}
+	/// number of types handled by the assignment table, which are TI_BOOL to TI_FLT64 without TI_FLT16
+	const unsigned nr_number_types = TI_FLT64 - TI_BOOL;
+	unsigned get_number_type_index(TypeId tid)
+	{
+		return tid < TI_FLT16 ? tid - TI_BOOL : tid - TI_BOOL - 1;
+	}
+	template <typename D>
+	void fill_assign_row(property_index::assign_function* row)
+	{
+		row[0] = &assign<D, bool>;
+		row[1] = &assign<D, int8_type>;
+		row[2] = &assign<D, int16_type>;
+		row[3] = &assign<D, int32_type>;
+		row[4] = &assign<D, int64_type>;
+		row[5] = &assign<D, uint8_type>;
+		row[6] = &assign<D, uint16_type>;
+		row[7] = &assign<D, uint32_type>;
+		row[8] = &assign<D, uint64_type>;
+		row[9] = &assign<D, flt32_type>;
+		row[10] = &assign<D, flt64_type>;
+	}
+	struct assign_table
+	{
+		property_index::assign_function functions[nr_number_types][nr_number_types];
+		std::unordered_map<std::string, TypeId> type_ids;
+		assign_table()
+		{
+			fill_assign_row<bool>(functions[0]);
+			fill_assign_row<int8_type>(functions[1]);
+			fill_assign_row<int16_type>(functions[2]);
+			fill_assign_row<int32_type>(functions[3]);
+			fill_assign_row<int64_type>(functions[4]);
+			fill_assign_row<uint8_type>(functions[5]);
+			fill_assign_row<uint16_type>(functions[6]);
+			fill_assign_row<uint32_type>(functions[7]);
+			fill_assign_row<uint64_type>(functions[8]);
+			fill_assign_row<flt32_type>(functions[9]);
+			fill_assign_row<flt64_type>(functions[10]);
+			for (int tid = TI_BOOL; tid <= TI_FLT64; ++tid)
+				if (tid != TI_FLT16)
+					type_ids[get_type_name(TypeId(tid))] = TypeId(tid);
+		}
+	};
+	const assign_table& ref_assign_table()
+	{
+		static assign_table table;
+		return table;
+	}
+	bool is_number_type(TypeId tid)
+	{
+		return tid >= TI_BOOL && tid <= TI_FLT64 && tid != TI_FLT16;
+	}
+}
+
+property_index::property_index()
+{
+}
+
+property_index::~property_index()
+{
+	for (std::unordered_map<std::string, entry>::iterator i = entries.begin(); i != entries.end(); ++i)
+		delete i->second.rt;
+}
+
+const property_index::entry* property_index::find(const std::string& property) const
+{
+	std::unordered_map<std::string, entry>::const_iterator i = entries.find(property);
+	if (i == entries.end())
+		return 0;
+	return &i->second;
+}
+
+TypeId property_index::get_number_type_id(const std::string& type_name)
+{
+	const assign_table& table = ref_assign_table();
+	std::unordered_map<std::string, TypeId>::const_iterator i = table.type_ids.find(type_name);
+	return i == table.type_ids.end() ? TI_UNDEF : i->second;
+}
+
+property_index::assign_function property_index::get_assign_function(TypeId dst_type, TypeId src_type)
+{
+	if (!is_number_type(dst_type) || !is_number_type(src_type))
+		return 0;
+	return ref_assign_table().functions[get_number_type_index(dst_type)][get_number_type_index(src_type)];
+}
+
+bool property_index::set_value(void* instance, const entry& e, const std::string& value_type, const void* value_ptr)
+{
+	void* member_ptr = get_member_ptr(instance, e);
+	if (is_number_type(e.type_id)) {
+		assign_function f = get_assign_function(e.type_id, get_number_type_id(value_type));
+		if (f) {
+			f(member_ptr, value_ptr);
+			return true;
+		}
+	}
+	return set_reflection_handler::set_value(member_ptr, e.rt, value_type, value_ptr);
+}
+
+bool property_index::get_value(void* instance, const entry& e, const std::string& value_type, void* value_ptr)
+{
+	const void* member_ptr = get_member_ptr(instance, e);
+	if (is_number_type(e.type_id)) {
+		assign_function f = get_assign_function(get_number_type_id(value_type), e.type_id);
+		if (f) {
+			f(value_ptr, member_ptr);
+			return true;
+		}
+	}
+	return get_reflection_handler::get_value(member_ptr, e.rt, value_type, value_ptr);
+}
+
+property_index_builder::property_index_builder(property_index& _index, const void* _instance_ptr, size_t _instance_size)
+	: index(_index), instance_ptr(static_cast<const char*>(_instance_ptr)), instance_size(_instance_size)
+{
+}
+
+std::string property_index_builder::extend_name(const std::string& name) const
+{
+	std::string res;
+	for (unsigned i = 0; i < nesting_info_stack.size(); ++i) {
+		const nesting_info& ni = nesting_info_stack[i];
+		switch (ni.group_kind) {
+		case GK_STRUCTURE:
+			// unnamed structures are base classes or array elements, where the latter are accessed with the .-operator
+			if (!ni.name->empty())
+				res += *ni.name + ".";
+			else if (i > 0 && nesting_info_stack[i - 1].group_kind == GK_ARRAY)
+				res += ".";
+			break;
+		case GK_ARRAY:
+			res += *ni.name + "[" + cgv::utils::to_string(ni.idx) + "]";
+			break;
+		default:
+			break;
+		}
+	}
+	return res + name;
+}
+
+void property_index_builder::add_entry(const std::string& name, void* member_ptr, abst_reflection_traits* rt)
+{
+	if (name.empty() || index.entries.find(name) != index.entries.end())
+		return;
+	// members outside of the instance are reached through pointers and can move independently of it
+	const char* ptr = static_cast<const char*>(member_ptr);
+	if (ptr < instance_ptr || ptr + rt->size() > instance_ptr + instance_size)
+		return;
+	property_index::entry& e = index.entries[name];
+	e.offset = ptr - instance_ptr;
+	e.rt = rt->clone();
+	e.type_id = rt->get_type_id();
+}
+
+int property_index_builder::reflect_group_begin(GroupKind group_kind, const std::string& group_name, void* group_ptr, abst_reflection_traits* rt, unsigned grp_size)
+{
+	switch (group_kind) {
+	case GK_BASE_CLASS:
+		return GT_COMPLETE;
+	case GK_STRUCTURE:
+		if (!group_name.empty() || (!nesting_info_stack.empty() && nesting_info_stack.back().group_kind == GK_ARRAY))
+			add_entry(extend_name(group_name), group_ptr, rt);
+		return GT_COMPLETE;
+	case GK_ARRAY:
+		add_entry(extend_name(group_name), group_ptr, rt);
+		return GT_COMPLETE;
+	case GK_VECTOR:
+		// the vector itself is part of the instance, but not its elements
+		add_entry(extend_name(group_name), group_ptr, rt);
+		return GT_SKIP;
+	default:
+		return GT_SKIP;
+	}
+}
+
+bool property_index_builder::reflect_member_void(const std::string& member_name, void* member_ptr, abst_reflection_traits* rt)
+{
+	add_entry(extend_name(member_name), member_ptr, rt);
+	return true;
+}
+
+bool property_index_builder::reflect_method_void(const std::string& method_name, method_interface* mi_ptr,
+						 abst_reflection_traits* return_traits, const std::vector<abst_reflection_traits*>& param_value_traits)
+{
+	return true;
+}
+
+	}
+}
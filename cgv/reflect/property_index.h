@@ -0,0 +1,95 @@
+#pragma once
+
+#include "reflection_handler.h"
+#include <cgv/type/info/type_id.h>
+#include <cstddef>
+#include <unordered_map>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace reflect {
+
+/** The property_index maps the names of all members of a reflected type to their offset relative to the
+    reflected instance, such that properties can be accessed without traversing the self reflection and comparing
+	member names. It is built once per type with the property_index_builder from one instance, which is only valid
+	if the self reflection of the type does not depend on the state of its instances. Members are named as in the
+	textual targets of the find_reflection_handler, i.e. \c style.radius or \c color[2]. Only members that lie
+	inside of the reflected instance are indexed, such that elements of vectors and members reached through
+	pointers are skipped, because their location depends on the instance. Assignments between fundamental number types are dispatched through a table of compiled
+	conversions, all other assignments use the conversions of set_reflection_handler and get_reflection_handler. */
+class CGV_API property_index
+{
+public:
+	/// signature of a compiled assignment between two fundamental types
+	typedef void (*assign_function)(void* dst_ptr, const void* src_ptr);
+	/// information stored per indexed member
+	struct entry
+	{
+		/// offset of member in bytes relative to the reflected instance
+		std::ptrdiff_t offset;
+		/// reflection traits of member
+		abst_reflection_traits* rt;
+		/// type id of member
+		cgv::type::info::TypeId type_id;
+	};
+protected:
+	friend class property_index_builder;
+	/// map from member name to entry
+	std::unordered_map<std::string, entry> entries;
+	/// no copy construction
+	property_index(const property_index&);
+	/// no assignment
+	property_index& operator = (const property_index&);
+public:
+	/// construct empty index
+	property_index();
+	/// delete reflection traits
+	~property_index();
+	/// return number of indexed members
+	size_t size() const { return entries.size(); }
+	/// return entry of given member name or 0 if the member is not indexed
+	const entry* find(const std::string& property) const;
+	/// return pointer to the member of an entry in the given instance
+	static void* get_member_ptr(void* instance, const entry& e) { return static_cast<char*>(instance) + e.offset; }
+	/// assign the value of given type to the member of entry e in the instance and return whether a conversion existed
+	static bool set_value(void* instance, const entry& e, const std::string& value_type, const void* value_ptr);
+	/// copy the member of entry e in the instance to a value of given type and return whether a conversion existed
+	static bool get_value(void* instance, const entry& e, const std::string& value_type, void* value_ptr);
+	/// return the type id of the number type or bool with the given name or TI_UNDEF if it is no number type
+	static cgv::type::info::TypeId get_number_type_id(const std::string& type_name);
+	/// return compiled assignment between two types returned from get_number_type_id() or 0
+	static assign_function get_assign_function(cgv::type::info::TypeId dst_type, cgv::type::info::TypeId src_type);
+};
+
+/** reflection handler that adds all members of the reflected instance to a property_index. Pass it to the
+    self_reflect() method of the instance from which the index is built. */
+class CGV_API property_index_builder : public reflection_handler
+{
+protected:
+	/// index to be filled
+	property_index& index;
+	/// pointer to reflected instance
+	const char* instance_ptr;
+	/// size of the dynamic type of the reflected instance
+	size_t instance_size;
+	/// build name of member from the nesting info stack
+	std::string extend_name(const std::string& name) const;
+	/// add entry if name has not been added before and the member lies inside of the instance
+	void add_entry(const std::string& name, void* member_ptr, abst_reflection_traits* rt);
+public:
+	/// construct from index to be filled, instance that is reflected and sizeof of its dynamic type
+	property_index_builder(property_index& _index, const void* _instance_ptr, size_t _instance_size);
+	/// add groups and traverse structures, base classes and arrays
+	int reflect_group_begin(GroupKind group_kind, const std::string& group_name, void* group_ptr, abst_reflection_traits* rt, unsigned grp_size);
+	/// add member
+	bool reflect_member_void(const std::string& member_name, void* member_ptr, abst_reflection_traits* rt);
+	/// ignore methods
+	bool reflect_method_void(const std::string& method_name, method_interface* mi_ptr,
+							 abst_reflection_traits* return_traits, const std::vector<abst_reflection_traits*>& param_value_traits);
+};
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -27,43 +27,50 @@ void set_reflection_handler::process_member_void(const std::string& member_name,
 	                     abst_reflection_traits* rt, GroupKind group_kind, unsigned grp_size)
 {
 	find_reflection_handler::process_member_void(member_name, member_ptr, rt, group_kind, grp_size);
-	valid = false;
+	valid = set_value(member_ptr, rt, value_type, value_ptr, value_rt);
+}
+
+/// assign value to member
+bool set_reflection_handler::set_value(void* member_ptr, abst_reflection_traits* rt, const std::string& value_type,
+					  const void* value_ptr, abst_reflection_traits* value_rt)
+{
 	if (value_rt) {
 		if (info::is_fundamental(rt->get_type_id())) {
 			if (info::is_fundamental(value_rt->get_type_id())) {
 				cgv::type::assign_variant(rt->get_type_name(), member_ptr, value_rt->get_type_name(), value_ptr);
-				valid = true;
+				return true;
 			}
 			else if (value_rt->has_string_conversions()) {
 				std::string tmp_str;
 				value_rt->get_to_string(value_ptr, tmp_str);
 				set_variant(tmp_str, rt->get_type_name(), member_ptr);
-				valid = true;
+				return true;
 			}
 
 		}
-		if (!valid && rt->has_string_conversions() && value_rt->has_string_conversions()) {
+		if (rt->has_string_conversions() && value_rt->has_string_conversions()) {
 			std::string tmp;
 			value_rt->get_to_string(value_ptr, tmp);
-			valid = rt->set_from_string(member_ptr, tmp);
-		}
-		if (!valid && rt->has_string_conversions() && value_rt->get_type_id() == info::TI_STRING) {
-			valid = rt->set_from_string(member_ptr, *static_cast<const std::string*>(value_ptr));
+			if (rt->set_from_string(member_ptr, tmp))
+				return true;
 		}
+		if (rt->has_string_conversions() && value_rt->get_type_id() == info::TI_STRING)
+			return rt->set_from_string(member_ptr, *static_cast<const std::string*>(value_ptr));
 	}
 	else {
 		if (info::is_fundamental(rt->get_type_id())) {
 			cgv::type::assign_variant(rt->get_type_name(), member_ptr, value_type, value_ptr);
-			valid = true;
+			return true;
 		}
 		else if (value_type == rt->get_type_name()) {
 			memcpy(member_ptr, value_ptr, rt->size());
-			valid = true;
+			return true;
 		}
 		else if (value_type == "string" && rt->has_string_conversions()) {
-			valid = rt->set_from_string(member_ptr, *static_cast<const std::string*>(value_ptr));
+			return rt->set_from_string(member_ptr, *static_cast<const std::string*>(value_ptr));
 		}
 	}
+	return false;
 }
 
 	}
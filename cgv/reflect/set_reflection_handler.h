@@ -27,6 +27,10 @@ public:
 	///
 	void process_member_void(const std::string& member_name, void* member_ptr, 
 						     abst_reflection_traits* rt, GroupKind group_kind, unsigned grp_size);
+	/** assign the value given by value_rt or, if value_rt is 0, by value_type to the member described by rt
+	    and return whether a conversion was found. This is shared with cgv::reflect::property_index. */
+	static bool set_value(void* member_ptr, abst_reflection_traits* rt, const std::string& value_type,
+						  const void* value_ptr, abst_reflection_traits* value_rt = 0);
 };
 
 #ifdef REFLECT_TRAITS_WITH_DECLTYPE
@@ -5,6 +5,7 @@
 #include <cgv/base/traverser.h>
 #include <cgv/render/drawable.h>
 #include <cgv/render/shader_program.h>
+#include <cgv/utils/trace.h>
 
 using namespace cgv::base;
 using namespace cgv::media::image;
@@ -166,6 +167,7 @@ context::context()
 	support_compatibility_mode = true;
 	draw_in_compatibility_mode = false;
 	debug_render_passes = false;
+	drawable_traverse_callback_handler = 0;
 
 	default_light_source[0].set_local_to_eye(true);
 	default_light_source[0].set_position(vec3(-0.4f, 0.3f, 0.8f));
@@ -692,6 +694,7 @@ void context::set_debug_render_passes(bool _debug)
 /// perform the given render task
 void context::render_pass(RenderPass rp, RenderPassFlags rpf, void* user_data)
 {
+	CGV_TRACE_SCOPE("context::render_pass");
 	// ensure that default light sources are created
 	if (default_light_source_handles[0] == 0) {
 		for (unsigned i=0; i<nr_default_light_sources; ++i)
@@ -717,19 +720,19 @@ void context::render_pass(RenderPass rp, RenderPassFlags rpf, void* user_data)
 	if (grp && (rpf&RPF_DRAWABLES_DRAW)) {
 		matched_method_action<drawable,void,void,context&> 
 			mma(*this, &drawable::draw, &drawable::finish_draw, true, true);
-		traverser(mma).traverse(group_ptr(grp));
+		traverser(mma).traverse(group_ptr(grp), drawable_traverse_callback_handler);
 	}
 	if (rpf&RPF_DRAW_TEXTUAL_INFO)
 		draw_textual_info();
 	if (grp && (rpf&RPF_DRAWABLES_FINISH_FRAME)) {
 		single_method_action<drawable,void,context&> 
 			sma(*this, &drawable::finish_frame, true, true);
-		traverser(sma).traverse(group_ptr(grp));
+		traverser(sma).traverse(group_ptr(grp), drawable_traverse_callback_handler);
 	}
 	if (grp && (rpf&RPF_DRAWABLES_AFTER_FINISH)) {
 		single_method_action<drawable,void,context&> 
 			sma(*this, &drawable::after_finish, true, true);
-		traverser(sma).traverse(group_ptr(grp));
+		traverser(sma).traverse(group_ptr(grp), drawable_traverse_callback_handler);
 	}
 	if ((rpf&RPF_HANDLE_SCREEN_SHOT) && do_screen_shot) {
 		perform_screen_shot();
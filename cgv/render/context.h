@@ -9,6 +9,7 @@
 #include <cgv/media/illum/textured_surface_material.h>
 #include <cgv/media/illum/light_source.hh>
 #include <cgv/signal/callback_stream.h>
+#include <cgv/base/traverser.h>
 #include <cgv/render/render_types.h>
 #include <cgv/math/vec.h>
 #include <cgv/math/inv.h>
@@ -58,7 +59,8 @@ struct type_descriptor
 /// enumeration of rendering APIs which can be queried from the context
 enum RenderAPI {
 	RA_OPENGL,
-	RA_DIRECTX
+	RA_DIRECTX,
+	RA_NULL
 };
 
 
@@ -552,6 +554,8 @@ protected:
 	bool draw_in_compatibility_mode;
 	/// whether to debug render passes
 	bool debug_render_passes;
+	/// optional callback handler passed to the traversals of drawables in render passes, defaults to 0
+	cgv::base::traverse_callback_handler* drawable_traverse_callback_handler;
 	/// whether vsynch should be enabled
 	bool enable_vsynch;
 	/// whether to use opengl option to support sRGB framebuffer
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cgv/utils/statistics.h>
+
+namespace cgv {
+	namespace render {
+
+/** measures the time between successive frames in milliseconds. Call tick() once per frame, for example in
+	init_frame(), and read average, jitter as standard deviation and maximum of the frame times from the collected
+	statistics. The first tick after construction or reset() only starts the measurement. */
+class frame_jitter_meter
+{
+protected:
+	/// time of the last tick
+	std::chrono::steady_clock::time_point last_tick;
+	/// whether last_tick is valid
+	bool started;
+	/// frame times in milliseconds
+	cgv::utils::statistics frame_times;
+public:
+	/// construct without measurements
+	frame_jitter_meter() : started(false) {}
+	/// discard all measurements
+	void reset() { started = false; frame_times.init(); }
+	/// record the end of a frame and return its duration in milliseconds, which is 0 for the first tick
+	double tick()
+	{
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		double ms = 0;
+		if (started) {
+			ms = std::chrono::duration<double, std::milli>(now - last_tick).count();
+			frame_times.update(ms);
+		}
+		last_tick = now;
+		started = true;
+		return ms;
+	}
+	/// return the statistics of the frame times in milliseconds
+	const cgv::utils::statistics& get_frame_times() const { return frame_times; }
+	/// return the number of measured frames
+	unsigned get_nr_frames() const { return frame_times.get_count(); }
+	/// return the average frame time in milliseconds
+	double get_average() const { return frame_times.get_count() > 0 ? frame_times.get_average() : 0.0; }
+	/// return the standard deviation of the frame times in milliseconds
+	double get_jitter() const { return frame_times.get_count() > 1 ? frame_times.get_standard_deviation() : 0.0; }
+	/// return the maximum frame time in milliseconds
+	double get_max() const { return frame_times.get_count() > 0 ? frame_times.get_max() : 0.0; }
+};
+
+	}
+}
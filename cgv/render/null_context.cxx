@@ -0,0 +1,953 @@
+#include "null_context.h"
+#include <cgv/render/drawable.h>
+#include <cgv/render/textured_material.h>
+#include <cgv/math/ftransform.h>
+#include <cgv/type/info/type_id.h>
+#include <iomanip>
+
+namespace cgv {
+	namespace render {
+
+const char* get_null_context_command_name(NullContextCommand ncc)
+{
+	static const char* names[] = {
+		"clear", "texture_create", "texture_replace", "texture_enable", "texture_disable", "texture_destruct",
+		"render_buffer_create", "frame_buffer_enable", "frame_buffer_disable", "shader_program_enable",
+		"shader_program_disable", "set_uniform", "set_attribute", "attribute_array_binding_enable",
+		"attribute_array_binding_disable", "set_attribute_array", "enable_attribute_array", "vertex_buffer_create",
+		"vertex_buffer_replace", "vertex_buffer_copy", "vertex_buffer_copy_back", "vertex_buffer_destruct",
+		"set_modelview_matrix", "set_projection_matrix", "set_viewport", "draw"
+	};
+	return ncc < NCC_LAST ? names[ncc] : "unknown";
+}
+
+void render_statistics::clear()
+{
+	nr_state_changes = nr_buffer_bytes = nr_texture_bytes = nr_draw_calls = nr_vertices = nr_uniform_sets = 0;
+	std::fill(nr_commands, nr_commands + NCC_LAST, size_t(0));
+}
+
+void render_statistics::add(const null_context_command& cmd)
+{
+	++nr_commands[cmd.type];
+	switch (cmd.type) {
+	case NCC_TEXTURE_CREATE:
+	case NCC_TEXTURE_REPLACE:
+		nr_texture_bytes += cmd.size;
+		break;
+	case NCC_VERTEX_BUFFER_CREATE:
+	case NCC_VERTEX_BUFFER_REPLACE:
+	case NCC_VERTEX_BUFFER_COPY:
+	case NCC_VERTEX_BUFFER_COPY_BACK:
+	case NCC_SET_ATTRIBUTE_ARRAY:
+		nr_buffer_bytes += cmd.size;
+		break;
+	case NCC_SET_UNIFORM:
+	case NCC_SET_ATTRIBUTE:
+		++nr_uniform_sets;
+		break;
+	case NCC_DRAW:
+		++nr_draw_calls;
+		nr_vertices += cmd.size;
+		break;
+	case NCC_TEXTURE_ENABLE:
+	case NCC_TEXTURE_DISABLE:
+	case NCC_FRAME_BUFFER_ENABLE:
+	case NCC_FRAME_BUFFER_DISABLE:
+	case NCC_SHADER_PROGRAM_ENABLE:
+	case NCC_SHADER_PROGRAM_DISABLE:
+	case NCC_ATTRIBUTE_ARRAY_BINDING_ENABLE:
+	case NCC_ATTRIBUTE_ARRAY_BINDING_DISABLE:
+	case NCC_ENABLE_ATTRIBUTE_ARRAY:
+	case NCC_SET_MODELVIEW_MATRIX:
+	case NCC_SET_PROJECTION_MATRIX:
+	case NCC_SET_VIEWPORT:
+		++nr_state_changes;
+		break;
+	default:
+		break;
+	}
+}
+
+null_context::null_context(unsigned w, unsigned h) : group("null_context"), width(w), height(h)
+{
+	recording = true;
+	in_frame = false;
+	redraw_requested = false;
+	last_handle = 0;
+	nr_timed_frames = 0;
+	window_transformation_stack.top()[0].viewport = ivec4(0, 0, w, h);
+	drawable_traverse_callback_handler = this;
+}
+
+null_context::~null_context()
+{
+	remove_all_children();
+	destruct_render_objects();
+}
+
+std::string null_context::get_type_name() const
+{
+	return "null_context";
+}
+
+void* null_context::new_handle() const
+{
+	return reinterpret_cast<void*>(++last_handle);
+}
+
+void null_context::record(NullContextCommand type, const void* id, size_t size) const
+{
+	null_context_command cmd;
+	cmd.type = type;
+	cmd.id = reinterpret_cast<size_t>(id);
+	cmd.size = size;
+	statistics.add(cmd);
+	if (recording)
+		commands.push_back(cmd);
+}
+
+void null_context::record_location(NullContextCommand type, int loc, size_t size) const
+{
+	record(type, reinterpret_cast<const void*>(size_t(loc)), size);
+}
+
+size_t null_context::get_nr_values(const type_descriptor& td)
+{
+	return size_t(td.nr_rows)*td.nr_columns;
+}
+
+bool null_context::on_enter_node(cgv::base::base_ptr b)
+{
+	timing_entry e;
+	e.node_ptr = &*b;
+	e.start = clock_type::now();
+	e.child_seconds = 0;
+	timing_stack.push_back(e);
+	return false;
+}
+
+bool null_context::on_leave_node(cgv::base::base_ptr b)
+{
+	if (timing_stack.empty() || timing_stack.back().node_ptr != &*b)
+		return false;
+	timing_entry e = timing_stack.back();
+	timing_stack.pop_back();
+	double seconds = std::chrono::duration<double>(clock_type::now() - e.start).count();
+	if (!timing_stack.empty())
+		timing_stack.back().child_seconds += seconds;
+	if (!b->get_interface<drawable>())
+		return false;
+	std::map<const cgv::base::base*, size_t>::iterator iter = drawable_timing_indices.find(e.node_ptr);
+	if (iter == drawable_timing_indices.end()) {
+		drawable_timing dt;
+		dt.name = b->get_type_name();
+		cgv::base::named_ptr n = b->get_named();
+		if (n && !n->get_name().empty())
+			dt.name += std::string(" ") + n->get_name();
+		dt.seconds = 0;
+		iter = drawable_timing_indices.insert(std::make_pair(e.node_ptr, drawable_timings.size())).first;
+		drawable_timings.push_back(dt);
+	}
+	drawable_timings[iter->second].seconds += seconds - e.child_seconds;
+	return false;
+}
+
+int null_context::query_integer_constant(ContextIntegerConstant cic) const
+{
+	switch (cic) {
+	case MAX_NR_GEOMETRY_SHADER_OUTPUT_VERTICES: return 256;
+	}
+	return -1;
+}
+
+void null_context::destruct_render_objects()
+{
+	for (unsigned i = 0; i < 4; ++i)
+		if (progs[i].is_created())
+			progs[i].destruct(*this);
+}
+
+void null_context::put_id(void* handle, void* ptr) const
+{
+	*static_cast<unsigned*>(ptr) = unsigned(reinterpret_cast<size_t>(handle));
+}
+
+cgv::data::component_format null_context::texture_find_best_format(const cgv::data::component_format& cf, render_component&, const std::vector<cgv::data::data_view>*) const
+{
+	return cf;
+}
+
+bool null_context::texture_create(texture_base& tb, cgv::data::data_format& df) const
+{
+	if (tb.tt == TT_UNDEF)
+		tb.tt = (TextureType)df.get_nr_dimensions();
+	tb.handle = new_handle();
+	record(NCC_TEXTURE_CREATE, tb.handle);
+	return true;
+}
+
+bool null_context::texture_create(texture_base& tb, cgv::data::data_format&, const cgv::data::const_data_view& data, int, int cube_side, const std::vector<cgv::data::data_view>*) const
+{
+	tb.tt = (TextureType)data.get_format()->get_nr_dimensions();
+	if (tb.tt == TT_2D && cube_side != -1)
+		tb.tt = TT_CUBEMAP;
+	if (!tb.is_created())
+		tb.handle = new_handle();
+	record(NCC_TEXTURE_CREATE, tb.handle, data.get_format()->get_nr_bytes());
+	return true;
+}
+
+bool null_context::texture_create_from_buffer(texture_base& tb, cgv::data::data_format& df, int, int, int) const
+{
+	if (tb.tt == TT_UNDEF)
+		tb.tt = (TextureType)df.get_nr_dimensions();
+	tb.handle = new_handle();
+	record(NCC_TEXTURE_CREATE, tb.handle);
+	return true;
+}
+
+bool null_context::texture_replace(texture_base& tb, int, int, int, const cgv::data::const_data_view& data, int, const std::vector<cgv::data::data_view>*) const
+{
+	if (!tb.is_created()) {
+		error("null_context::texture_replace: attempt to replace in not created texture", &tb);
+		return false;
+	}
+	record(NCC_TEXTURE_REPLACE, tb.handle, data.get_format()->get_nr_bytes());
+	return true;
+}
+
+bool null_context::texture_replace_from_buffer(texture_base& tb, int, int, int, int, int, unsigned int, unsigned int, int) const
+{
+	if (!tb.is_created()) {
+		error("null_context::texture_replace_from_buffer: attempt to replace in not created texture", &tb);
+		return false;
+	}
+	record(NCC_TEXTURE_REPLACE, tb.handle);
+	return true;
+}
+
+bool null_context::texture_generate_mipmaps(texture_base& tb, unsigned int) const
+{
+	tb.have_mipmaps = true;
+	return true;
+}
+
+bool null_context::texture_destruct(texture_base& tb) const
+{
+	if (!tb.is_created()) {
+		error("null_context::texture_destruct: attempt to destruct not created texture", &tb);
+		return false;
+	}
+	record(NCC_TEXTURE_DESTRUCT, tb.handle);
+	tb.handle = 0;
+	return true;
+}
+
+bool null_context::texture_set_state(const texture_base& tb) const
+{
+	return tb.is_created();
+}
+
+bool null_context::texture_enable(texture_base& tb, int tex_unit, unsigned int) const
+{
+	if (!tb.is_created()) {
+		error("null_context::texture_enable: attempt to enable not created texture", &tb);
+		return false;
+	}
+	record(NCC_TEXTURE_ENABLE, tb.handle, size_t(tex_unit));
+	return true;
+}
+
+bool null_context::texture_disable(texture_base& tb, int tex_unit, unsigned int) const
+{
+	record(NCC_TEXTURE_DISABLE, tb.handle, size_t(tex_unit));
+	return true;
+}
+
+bool null_context::render_buffer_create(render_component& rc, cgv::data::component_format&, int& _width, int& _height) const
+{
+	if (_width == -1)
+		_width = get_width();
+	if (_height == -1)
+		_height = get_height();
+	rc.handle = new_handle();
+	record(NCC_RENDER_BUFFER_CREATE, rc.handle);
+	return true;
+}
+
+bool null_context::render_buffer_destruct(render_component& rc) const
+{
+	rc.handle = 0;
+	return true;
+}
+
+bool null_context::frame_buffer_create(frame_buffer_base& fbb) const
+{
+	if (!context::frame_buffer_create(fbb))
+		return false;
+	fbb.handle = new_handle();
+	return true;
+}
+
+bool null_context::frame_buffer_is_complete(const frame_buffer_base& fbb) const
+{
+	if (fbb.handle == 0) {
+		error("null_context::frame_buffer_is_complete: attempt to check completeness on frame buffer that is not created", &fbb);
+		return false;
+	}
+	return true;
+}
+
+bool null_context::frame_buffer_enable(frame_buffer_base& fbb)
+{
+	if (!context::frame_buffer_enable(fbb))
+		return false;
+	record(NCC_FRAME_BUFFER_ENABLE, fbb.handle);
+	return true;
+}
+
+bool null_context::frame_buffer_disable(frame_buffer_base& fbb)
+{
+	if (!context::frame_buffer_disable(fbb))
+		return false;
+	record(NCC_FRAME_BUFFER_DISABLE, fbb.handle);
+	return true;
+}
+
+bool null_context::frame_buffer_destruct(frame_buffer_base& fbb) const
+{
+	if (!context::frame_buffer_destruct(fbb))
+		return false;
+	fbb.handle = 0;
+	return true;
+}
+
+int null_context::frame_buffer_get_max_nr_color_attachments() const
+{
+	return 8;
+}
+
+int null_context::frame_buffer_get_max_nr_draw_buffers() const
+{
+	return 8;
+}
+
+bool null_context::shader_code_create(render_component& sc, ShaderType, const std::string&) const
+{
+	sc.handle = new_handle();
+	return true;
+}
+
+bool null_context::shader_code_compile(render_component& sc) const
+{
+	return sc.handle != 0;
+}
+
+void null_context::shader_code_destruct(render_component& sc) const
+{
+	sc.handle = 0;
+}
+
+bool null_context::shader_program_create(shader_program_base& spb) const
+{
+	spb.handle = new_handle();
+	return true;
+}
+
+void null_context::shader_program_attach(shader_program_base&, const render_component&) const
+{
+}
+
+void null_context::shader_program_detach(shader_program_base&, const render_component&) const
+{
+}
+
+bool null_context::shader_program_set_state(shader_program_base& spb) const
+{
+	return spb.handle != 0;
+}
+
+bool null_context::shader_program_enable(shader_program_base& spb)
+{
+	if (!context::shader_program_enable(spb))
+		return false;
+	record(NCC_SHADER_PROGRAM_ENABLE, spb.handle);
+	// update the same standard uniforms as the gl_context
+	shader_program& prog = static_cast<shader_program&>(spb);
+	if (auto_set_lights_in_current_shader_program && spb.does_use_lights())
+		set_current_lights(prog);
+	if (auto_set_material_in_current_shader_program && spb.does_use_material())
+		set_current_material(prog);
+	if (auto_set_view_in_current_shader_program && spb.does_use_view())
+		set_current_view(prog);
+	if (auto_set_gamma_in_current_shader_program && spb.does_use_gamma())
+		prog.set_uniform(*this, "gamma", gamma);
+	return true;
+}
+
+bool null_context::shader_program_disable(shader_program_base& spb)
+{
+	if (!context::shader_program_disable(spb))
+		return false;
+	record(NCC_SHADER_PROGRAM_DISABLE, spb.handle);
+	return true;
+}
+
+bool null_context::shader_program_destruct(shader_program_base& spb) const
+{
+	if (!context::shader_program_destruct(spb))
+		return false;
+	spb.handle = 0;
+	return true;
+}
+
+int null_context::get_uniform_location(const shader_program_base&, const std::string& name) const
+{
+	return uniform_locations.insert(std::make_pair(name, int(uniform_locations.size()))).first->second;
+}
+
+bool null_context::set_uniform_void(shader_program_base& spb, int loc, type_descriptor value_type, const void*) const
+{
+	if (!spb.handle) {
+		error("null_context::set_uniform_void() called on not created program", &spb);
+		return false;
+	}
+	record_location(NCC_SET_UNIFORM, loc, get_nr_values(value_type));
+	return true;
+}
+
+bool null_context::set_uniform_array_void(shader_program_base& spb, int loc, type_descriptor value_type, const void*, size_t nr_elements) const
+{
+	if (!spb.handle) {
+		error("null_context::set_uniform_array_void() called on not created program", &spb);
+		return false;
+	}
+	record_location(NCC_SET_UNIFORM, loc, nr_elements*get_nr_values(value_type));
+	return true;
+}
+
+int null_context::get_attribute_location(const shader_program_base&, const std::string& name) const
+{
+	return attribute_locations.insert(std::make_pair(name, int(attribute_locations.size()))).first->second;
+}
+
+bool null_context::set_attribute_void(shader_program_base&, int loc, type_descriptor value_type, const void*) const
+{
+	record_location(NCC_SET_ATTRIBUTE, loc, get_nr_values(value_type));
+	return true;
+}
+
+bool null_context::attribute_array_binding_create(attribute_array_binding_base& aab) const
+{
+	aab.handle = new_handle();
+	return true;
+}
+
+bool null_context::attribute_array_binding_destruct(attribute_array_binding_base& aab) const
+{
+	if (!context::attribute_array_binding_destruct(aab))
+		return false;
+	enabled_attribute_arrays.erase(&aab);
+	aab.handle = 0;
+	return true;
+}
+
+bool null_context::attribute_array_binding_enable(attribute_array_binding_base& aab)
+{
+	if (!context::attribute_array_binding_enable(aab))
+		return false;
+	record(NCC_ATTRIBUTE_ARRAY_BINDING_ENABLE, aab.handle);
+	return true;
+}
+
+bool null_context::attribute_array_binding_disable(attribute_array_binding_base& aab)
+{
+	if (!context::attribute_array_binding_disable(aab))
+		return false;
+	record(NCC_ATTRIBUTE_ARRAY_BINDING_DISABLE, aab.handle);
+	return true;
+}
+
+bool null_context::set_attribute_array_void(attribute_array_binding_base* aab, int loc, type_descriptor value_type, const vertex_buffer_base* vbb, const void*, size_t nr_elements, unsigned) const
+{
+	// only arrays in client memory are transferred with each draw call
+	size_t nr_bytes = vbb ? 0 : nr_elements*get_nr_values(value_type)*cgv::type::info::get_type_size(value_type.coordinate_type);
+	record_location(NCC_SET_ATTRIBUTE_ARRAY, loc, nr_bytes);
+	return enable_attribute_array(aab, loc, true);
+}
+
+bool null_context::set_element_array(attribute_array_binding_base*, const vertex_buffer_base* vbb) const
+{
+	return vbb != 0 && vbb->handle != 0;
+}
+
+bool null_context::enable_attribute_array(attribute_array_binding_base* aab, int loc, bool do_enable) const
+{
+	if (loc < 0 || loc >= 32)
+		return false;
+	unsigned& mask = enabled_attribute_arrays[aab];
+	if (do_enable)
+		mask |= 1u << loc;
+	else
+		mask &= ~(1u << loc);
+	record_location(NCC_ENABLE_ATTRIBUTE_ARRAY, loc, do_enable ? 1 : 0);
+	return true;
+}
+
+bool null_context::is_attribute_array_enabled(const attribute_array_binding_base* aab, int loc) const
+{
+	if (loc < 0 || loc >= 32)
+		return false;
+	std::map<const attribute_array_binding_base*, unsigned>::const_iterator iter = enabled_attribute_arrays.find(aab);
+	return iter != enabled_attribute_arrays.end() && (iter->second & (1u << loc)) != 0;
+}
+
+bool null_context::vertex_buffer_bind(const vertex_buffer_base& vbb, VertexBufferType) const
+{
+	return vbb.handle != 0;
+}
+
+bool null_context::vertex_buffer_create(vertex_buffer_base& vbb, const void* array_ptr, size_t size_in_bytes) const
+{
+	vbb.handle = new_handle();
+	record(NCC_VERTEX_BUFFER_CREATE, vbb.handle, array_ptr ? size_in_bytes : 0);
+	return true;
+}
+
+bool null_context::vertex_buffer_replace(vertex_buffer_base& vbb, size_t, size_t size_in_bytes, const void*) const
+{
+	if (!vbb.handle)
+		return false;
+	record(NCC_VERTEX_BUFFER_REPLACE, vbb.handle, size_in_bytes);
+	return true;
+}
+
+bool null_context::vertex_buffer_copy(const vertex_buffer_base& src, size_t, vertex_buffer_base& target, size_t, size_t size_in_bytes) const
+{
+	if (!src.handle || !target.handle)
+		return false;
+	record(NCC_VERTEX_BUFFER_COPY, target.handle, size_in_bytes);
+	return true;
+}
+
+bool null_context::vertex_buffer_copy_back(vertex_buffer_base& vbb, size_t, size_t size_in_bytes, void*) const
+{
+	if (!vbb.handle)
+		return false;
+	record(NCC_VERTEX_BUFFER_COPY_BACK, vbb.handle, size_in_bytes);
+	return true;
+}
+
+bool null_context::vertex_buffer_destruct(vertex_buffer_base& vbb) const
+{
+	if (!vbb.handle)
+		return false;
+	record(NCC_VERTEX_BUFFER_DESTRUCT, vbb.handle);
+	vbb.handle = 0;
+	return true;
+}
+
+void null_context::clear_child(cgv::base::base_ptr child)
+{
+	cgv::base::single_method_action<drawable, void, context&> sma(*this, &drawable::clear, false, false);
+	cgv::base::traverser(sma, "nc").traverse(child);
+}
+
+unsigned int null_context::append_child(cgv::base::base_ptr child)
+{
+	if (child->get_interface<drawable>() == 0)
+		return -1;
+	unsigned int i = group::append_child(child);
+	configure_new_child(child);
+	return i;
+}
+
+unsigned int null_context::remove_child(cgv::base::base_ptr child)
+{
+	clear_child(child);
+	return group::remove_child(child);
+}
+
+void null_context::remove_all_children()
+{
+	for (unsigned int i = 0; i < get_nr_children(); ++i)
+		clear_child(get_child(i));
+	group::remove_all_children();
+}
+
+void null_context::insert_child(unsigned int i, cgv::base::base_ptr child)
+{
+	if (child->get_interface<drawable>() == 0)
+		return;
+	group::insert_child(i, child);
+	configure_new_child(child);
+}
+
+void null_context::register_object(cgv::base::base_ptr object, const std::string&)
+{
+	append_child(object);
+}
+
+void null_context::unregister_object(cgv::base::base_ptr object, const std::string&)
+{
+	remove_child(object);
+}
+
+void null_context::set_recording(bool enable)
+{
+	recording = enable;
+	if (!recording)
+		commands.clear();
+}
+
+void null_context::render_frame()
+{
+	commands.clear();
+	statistics.clear();
+	redraw_requested = false;
+	in_frame = true;
+	render_pass(RP_MAIN, get_default_render_pass_flags());
+	in_frame = false;
+}
+
+double null_context::replay_frame(unsigned nr_frames)
+{
+	clock_type::time_point start = clock_type::now();
+	for (unsigned i = 0; i < nr_frames; ++i)
+		render_frame();
+	nr_timed_frames += nr_frames;
+	return nr_frames == 0 ? 0.0 : std::chrono::duration<double>(clock_type::now() - start).count() / nr_frames;
+}
+
+void null_context::clear_drawable_timings()
+{
+	drawable_timings.clear();
+	drawable_timing_indices.clear();
+	nr_timed_frames = 0;
+}
+
+void null_context::print_report(std::ostream& os) const
+{
+	os << "frame statistics:\n"
+		<< "  state changes " << statistics.nr_state_changes << ", uniform sets " << statistics.nr_uniform_sets
+		<< ", draw calls " << statistics.nr_draw_calls << " with " << statistics.nr_vertices << " vertices"
+		<< ", buffer bytes " << statistics.nr_buffer_bytes << ", texture bytes " << statistics.nr_texture_bytes << "\n";
+	for (unsigned i = 0; i < NCC_LAST; ++i)
+		if (statistics.nr_commands[i] > 0)
+			os << "  " << std::setw(32) << std::left << get_null_context_command_name(NullContextCommand(i)) << statistics.nr_commands[i] << "\n";
+	if (nr_timed_frames == 0)
+		return;
+	os << "CPU time per frame averaged over " << nr_timed_frames << " frames:\n";
+	for (size_t i = 0; i < drawable_timings.size(); ++i)
+		os << "  " << std::setw(32) << std::left << drawable_timings[i].name
+			<< std::fixed << std::setprecision(4) << 1000.0*drawable_timings[i].seconds / nr_timed_frames << " ms\n";
+	os.flush();
+}
+
+RenderAPI null_context::get_render_api() const
+{
+	return RA_NULL;
+}
+
+void null_context::init_render_pass()
+{
+	// perform the same CPU side initialization as the gl_context
+	if (get_render_pass_flags()&RPF_SET_LIGHTS) {
+		for (unsigned i = 0; i < nr_default_light_sources; ++i)
+			set_light_source(default_light_source_handles[i], default_light_source[i], false);
+	}
+	for (unsigned i = 0; i < nr_default_light_sources; ++i)
+		if (get_render_pass_flags()&RPF_SET_LIGHTS_ON)
+			enable_light_source(default_light_source_handles[i]);
+		else
+			disable_light_source(default_light_source_handles[i]);
+	if (get_render_pass_flags()&RPF_SET_MATERIAL)
+		set_material(default_material);
+	if ((get_render_pass_flags()&RPF_SET_PROJECTION) != 0)
+		set_projection_matrix(cgv::math::perspective4<double>(45.0, (double)get_width() / get_height(), 0.001, 1000.0));
+	if ((get_render_pass_flags()&RPF_SET_MODELVIEW) != 0)
+		set_modelview_matrix(cgv::math::look_at4<double>(vec3(0, 0, 10), vec3(0, 0, 0), vec3(0, 1, 0)));
+	if (get_render_pass_flags()&RPF_DRAWABLES_INIT_FRAME) {
+		cgv::base::single_method_action<drawable, void, context&> sma(*this, &drawable::init_frame, true, true);
+		cgv::base::traverser(sma).traverse(cgv::base::group_ptr(this), drawable_traverse_callback_handler);
+	}
+	if (get_render_pass_flags()&(RPF_CLEAR_COLOR | RPF_CLEAR_DEPTH | RPF_CLEAR_STENCIL | RPF_CLEAR_ACCUM))
+		record(NCC_CLEAR, 0, get_render_pass_flags()&(RPF_CLEAR_COLOR | RPF_CLEAR_DEPTH | RPF_CLEAR_STENCIL | RPF_CLEAR_ACCUM));
+}
+
+bool null_context::in_render_process() const
+{
+	return in_frame;
+}
+
+bool null_context::is_created() const
+{
+	return true;
+}
+
+bool null_context::is_current() const
+{
+	return true;
+}
+
+bool null_context::make_current() const
+{
+	return true;
+}
+
+void null_context::clear_current() const
+{
+}
+
+void null_context::attach_alpha_buffer(bool)
+{
+}
+
+void null_context::attach_depth_buffer(bool)
+{
+}
+
+void null_context::attach_stencil_buffer(bool)
+{
+}
+
+bool null_context::is_stereo_buffer_supported() const
+{
+	return false;
+}
+
+void null_context::attach_stereo_buffer(bool)
+{
+}
+
+void null_context::attach_accumulation_buffer(bool)
+{
+}
+
+void null_context::attach_multi_sample_buffer(bool)
+{
+}
+
+unsigned int null_context::get_width() const
+{
+	return width;
+}
+
+unsigned int null_context::get_height() const
+{
+	return height;
+}
+
+void null_context::resize(unsigned int w, unsigned int h)
+{
+	width = w;
+	height = h;
+	set_viewport(ivec4(0, 0, w, h));
+	cgv::base::single_method_action_2<drawable, void, unsigned int, unsigned int> sma(w, h, &drawable::resize);
+	cgv::base::traverser(sma).traverse(cgv::base::group_ptr(this));
+}
+
+bool null_context::read_frame_buffer(data::data_view&, unsigned int, unsigned int, FrameBufferType, TypeId, data::ComponentFormat, int, int)
+{
+	error("null_context::read_frame_buffer: null context does not provide frame buffer content");
+	return false;
+}
+
+void null_context::post_redraw()
+{
+	redraw_requested = true;
+}
+
+void null_context::force_redraw()
+{
+	render_frame();
+}
+
+void null_context::announce_external_frame_buffer_change(void*& cgv_fbo_storage)
+{
+	cgv_fbo_storage = frame_buffer_stack.top()->handle;
+}
+
+void null_context::recover_from_external_frame_buffer_change(void* cgv_fbo_storage)
+{
+	frame_buffer_stack.top()->handle = cgv_fbo_storage;
+}
+
+void null_context::enable_font_face(media::font::font_face_ptr font_face, float font_size)
+{
+	current_font_face = font_face;
+	current_font_size = font_size;
+}
+
+void null_context::set_color(const rgba& clr)
+{
+	if (shader_program_stack.empty())
+		return;
+	cgv::render::shader_program& prog = *static_cast<cgv::render::shader_program*>(shader_program_stack.top());
+	int clr_loc = prog.get_color_index();
+	if (clr_loc == -1)
+		return;
+	prog.set_attribute(*this, clr_loc, clr);
+}
+
+void null_context::enable_material(textured_material& mat)
+{
+	set_textured_material(mat);
+	mat.enable_textures(*this);
+}
+
+void null_context::disable_material(textured_material& mat)
+{
+	mat.disable_textures(*this);
+	current_material_ptr = 0;
+	current_material_is_textured = false;
+}
+
+shader_program& null_context::ref_default_shader_program(bool texture_support)
+{
+	shader_program& prog = progs[texture_support ? 1 : 0];
+	if (!prog.is_created()) {
+		prog.create(*this);
+		prog.link(*this);
+		if (texture_support)
+			prog.set_uniform(*this, "texture", 0);
+		prog.specify_standard_uniforms(true, false, false, true);
+		prog.specify_standard_vertex_attribute_names(*this, true, false, texture_support);
+	}
+	return prog;
+}
+
+shader_program& null_context::ref_surface_shader_program(bool texture_support)
+{
+	shader_program& prog = progs[texture_support ? 3 : 2];
+	if (!prog.is_created()) {
+		prog.create(*this);
+		prog.link(*this);
+		prog.specify_standard_uniforms(true, true, true, true);
+		prog.specify_standard_vertex_attribute_names(*this, true, true, texture_support);
+	}
+	return prog;
+}
+
+void null_context::enumerate_program_uniforms(shader_program&, std::vector<std::string>& names, std::vector<int>* locations_ptr, std::vector<int>*, std::vector<int>*, bool show) const
+{
+	for (std::map<std::string, int>::const_iterator iter = uniform_locations.begin(); iter != uniform_locations.end(); ++iter) {
+		names.push_back(iter->first);
+		if (locations_ptr)
+			locations_ptr->push_back(iter->second);
+		if (show)
+			std::cout << iter->second << " : " << iter->first << std::endl;
+	}
+}
+
+void null_context::enumerate_program_attributes(shader_program&, std::vector<std::string>& names, std::vector<int>* locations_ptr, std::vector<int>*, std::vector<int>*, bool show) const
+{
+	for (std::map<std::string, int>::const_iterator iter = attribute_locations.begin(); iter != attribute_locations.end(); ++iter) {
+		names.push_back(iter->first);
+		if (locations_ptr)
+			locations_ptr->push_back(iter->second);
+		if (show)
+			std::cout << iter->second << " : " << iter->first << std::endl;
+	}
+}
+
+void null_context::draw_edges_of_faces(const float*, const float*, const float*, const int*, const int*, const int*, int nr_faces, int face_degree, bool) const
+{
+	record(NCC_DRAW, 0, 2 * size_t(nr_faces)*face_degree);
+}
+
+void null_context::draw_edges_of_strip_or_fan(const float*, const float*, const float*, const int*, const int*, const int*, int nr_faces, int face_degree, bool, bool) const
+{
+	record(NCC_DRAW, 0, 2 * size_t(nr_faces)*face_degree);
+}
+
+void null_context::draw_faces(const float*, const float*, const float*, const int*, const int*, const int*, int nr_faces, int face_degree, bool) const
+{
+	record(NCC_DRAW, 0, size_t(nr_faces)*face_degree);
+}
+
+void null_context::draw_strip_or_fan(const float*, const float*, const float*, const int*, const int*, const int*, int nr_faces, int face_degree, bool, bool) const
+{
+	record(NCC_DRAW, 0, size_t(nr_faces)*(face_degree - 2) + 2);
+}
+
+void null_context::record_draw_call(size_t nr_vertices) const
+{
+	record(NCC_DRAW, 0, nr_vertices);
+}
+
+void null_context::push_pixel_coords()
+{
+	push_projection_matrix();
+	push_modelview_matrix();
+	const ivec4& vp = window_transformation_stack.top()[0].viewport;
+	set_modelview_matrix(cgv::math::identity4<double>());
+	set_projection_matrix(cgv::math::ortho4<double>(0, vp[2], vp[3], 0, -1, 1));
+}
+
+void null_context::pop_pixel_coords()
+{
+	pop_modelview_matrix();
+	pop_projection_matrix();
+}
+
+null_context::dmat4 null_context::get_modelview_matrix() const
+{
+	return modelview_matrix_stack.top();
+}
+
+void null_context::set_modelview_matrix(const dmat4& V)
+{
+	record(NCC_SET_MODELVIEW_MATRIX);
+	context::set_modelview_matrix(V);
+}
+
+null_context::dmat4 null_context::get_projection_matrix() const
+{
+	return projection_matrix_stack.top();
+}
+
+void null_context::set_projection_matrix(const dmat4& P)
+{
+	record(NCC_SET_PROJECTION_MATRIX);
+	context::set_projection_matrix(P);
+}
+
+void null_context::set_viewport(const ivec4& viewport, int array_index)
+{
+	record(NCC_SET_VIEWPORT);
+	context::set_viewport(viewport, array_index);
+}
+
+void null_context::announce_external_viewport_change(ivec4& cgv_viewport_storage)
+{
+	cgv_viewport_storage = window_transformation_stack.top()[0].viewport;
+}
+
+void null_context::recover_from_external_viewport_change(const ivec4& cgv_viewport_storage)
+{
+	window_transformation_stack.top()[0].viewport = cgv_viewport_storage;
+}
+
+unsigned null_context::get_max_window_transformation_array_size() const
+{
+	return 16;
+}
+
+double null_context::get_window_z(int, int) const
+{
+	return get_bg_depth();
+}
+
+context* create_null_context(RenderAPI api, unsigned int w, unsigned int h, const std::string&, bool)
+{
+	if (api != RA_NULL)
+		return 0;
+	return new null_context(w, h);
+}
+
+context_factory_registration create_null_context_registration(create_null_context);
+
+	}
+}
@@ -0,0 +1,346 @@
+#pragma once
+
+#include <cgv/base/group.h>
+#include <cgv/base/register.h>
+#include <cgv/base/traverser.h>
+#include <cgv/render/context.h>
+#include <cgv/render/shader_program.h>
+#include <chrono>
+#include <map>
+#include <iostream>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace render {
+
+/// types of commands recorded by the null_context
+enum NullContextCommand
+{
+	NCC_CLEAR,
+	NCC_TEXTURE_CREATE,
+	NCC_TEXTURE_REPLACE,
+	NCC_TEXTURE_ENABLE,
+	NCC_TEXTURE_DISABLE,
+	NCC_TEXTURE_DESTRUCT,
+	NCC_RENDER_BUFFER_CREATE,
+	NCC_FRAME_BUFFER_ENABLE,
+	NCC_FRAME_BUFFER_DISABLE,
+	NCC_SHADER_PROGRAM_ENABLE,
+	NCC_SHADER_PROGRAM_DISABLE,
+	NCC_SET_UNIFORM,
+	NCC_SET_ATTRIBUTE,
+	NCC_ATTRIBUTE_ARRAY_BINDING_ENABLE,
+	NCC_ATTRIBUTE_ARRAY_BINDING_DISABLE,
+	NCC_SET_ATTRIBUTE_ARRAY,
+	NCC_ENABLE_ATTRIBUTE_ARRAY,
+	NCC_VERTEX_BUFFER_CREATE,
+	NCC_VERTEX_BUFFER_REPLACE,
+	NCC_VERTEX_BUFFER_COPY,
+	NCC_VERTEX_BUFFER_COPY_BACK,
+	NCC_VERTEX_BUFFER_DESTRUCT,
+	NCC_SET_MODELVIEW_MATRIX,
+	NCC_SET_PROJECTION_MATRIX,
+	NCC_SET_VIEWPORT,
+	NCC_DRAW,
+	NCC_LAST
+};
+
+/// return the name of a recorded command type
+extern CGV_API const char* get_null_context_command_name(NullContextCommand ncc);
+
+/// compact representation of a command recorded by the null_context
+struct null_context_command
+{
+	/// type of command
+	NullContextCommand type;
+	/// handle of the render object or location of the uniform or attribute
+	size_t id;
+	/// number of transferred bytes, number of values for uniforms or number of vertices for draw commands
+	size_t size;
+};
+
+/// statistics over the commands issued since the start of the current frame
+struct render_statistics
+{
+	/// number of enable and disable commands and matrix or viewport changes
+	size_t nr_state_changes;
+	/// number of bytes transferred to or from vertex buffers
+	size_t nr_buffer_bytes;
+	/// number of bytes transferred to textures
+	size_t nr_texture_bytes;
+	/// number of draw calls
+	size_t nr_draw_calls;
+	/// number of vertices passed to draw calls
+	size_t nr_vertices;
+	/// number of uniform and constant vertex attribute sets
+	size_t nr_uniform_sets;
+	/// number of commands per command type
+	size_t nr_commands[NCC_LAST];
+	/// construct zero statistics
+	render_statistics() { clear(); }
+	/// set all counts to zero
+	void clear();
+	/// update counts with a command
+	void add(const null_context_command& cmd);
+};
+
+/// CPU time spent in the methods of one drawable
+struct drawable_timing
+{
+	/// type name and name of the drawable
+	std::string name;
+	/// seconds accumulated over the timed frames excluding the time spent in child drawables
+	double seconds;
+};
+
+/** implementation of the context interface that does not render anything and does not need a window or a
+	graphics driver. Render objects receive handles without allocating resources, shader programs compile and
+	link successfully and every uniform or attribute name is assigned a location. All commands that would reach
+	the rendering API are counted in render_statistics and optionally recorded into a compact command stream,
+	such that the CPU side of drawables can be profiled and regression tested on headless machines. Drawables are
+	added as children, either directly or through registration if the null_context is registered as listener.
+	replay_frame() renders a frame repeatedly and measures the CPU time per drawable. The renderers of cgv_gl skip
+	their GL calls if the render API is RA_NULL and report their draw calls with record_draw_call(). Drawables
+	that call the rendering API themselves cannot be used with the null_context. */
+class CGV_API null_context :
+	public context,
+	public cgv::base::group,
+	public cgv::base::registration_listener,
+	protected cgv::base::traverse_callback_handler
+{
+protected:
+	typedef std::chrono::high_resolution_clock clock_type;
+	/// extent of the virtual frame buffer
+	unsigned width, height;
+	/// whether commands are recorded into the command stream
+	bool recording;
+	/// whether a frame is currently rendered
+	bool in_frame;
+	/// whether a redraw has been requested since the last frame
+	bool redraw_requested;
+	/// last assigned handle
+	mutable size_t last_handle;
+	/// locations assigned to uniform names
+	mutable std::map<std::string, int> uniform_locations;
+	/// locations assigned to attribute names
+	mutable std::map<std::string, int> attribute_locations;
+	/// per attribute array binding the mask of enabled attribute arrays
+	mutable std::map<const attribute_array_binding_base*, unsigned> enabled_attribute_arrays;
+	/// commands recorded since the start of the current frame
+	mutable std::vector<null_context_command> commands;
+	/// statistics since the start of the current frame
+	mutable render_statistics statistics;
+	/// default shader programs
+	shader_program progs[4];
+	/// start time and time spent in children of a node on the traversal stack
+	struct timing_entry
+	{
+		const cgv::base::base* node_ptr;
+		clock_type::time_point start;
+		double child_seconds;
+	};
+	/// stack of nodes currently traversed
+	std::vector<timing_entry> timing_stack;
+	/// timings of drawables
+	std::vector<drawable_timing> drawable_timings;
+	/// index of drawable timing per drawable
+	std::map<const cgv::base::base*, size_t> drawable_timing_indices;
+	/// number of frames accumulated in the drawable timings
+	unsigned nr_timed_frames;
+	/// return a new handle
+	void* new_handle() const;
+	/// update statistics with a command and record it if recording is enabled
+	void record(NullContextCommand type, const void* id = 0, size_t size = 0) const;
+	/// record a command addressing a uniform or attribute location
+	void record_location(NullContextCommand type, int loc, size_t size) const;
+	/// return the number of values in a type descriptor
+	static size_t get_nr_values(const type_descriptor& td);
+	/// start timing of a traversed node
+	bool on_enter_node(cgv::base::base_ptr b);
+	/// stop timing of a traversed node and accumulate the time of drawables
+	bool on_leave_node(cgv::base::base_ptr b);
+	/// call the clear method of all drawables in the given subtree
+	void clear_child(cgv::base::base_ptr child);
+
+	int query_integer_constant(ContextIntegerConstant cic) const;
+	void destruct_render_objects();
+	void put_id(void* handle, void* ptr) const;
+
+	cgv::data::component_format texture_find_best_format(const cgv::data::component_format& cf, render_component& rc, const std::vector<cgv::data::data_view>* palettes = 0) const;
+	bool texture_create(texture_base& tb, cgv::data::data_format& df) const;
+	bool texture_create(texture_base& tb, cgv::data::data_format& target_format, const cgv::data::const_data_view& data, int level, int cube_side = -1, const std::vector<cgv::data::data_view>* palettes = 0) const;
+	bool texture_create_from_buffer(texture_base& tb, cgv::data::data_format& df, int x, int y, int level) const;
+	bool texture_replace(texture_base& tb, int x, int y, int z_or_cube_side, const cgv::data::const_data_view& data, int level, const std::vector<cgv::data::data_view>* palettes = 0) const;
+	bool texture_replace_from_buffer(texture_base& tb, int x, int y, int z_or_cube_side, int x_buffer, int y_buffer, unsigned int width, unsigned int height, int level) const;
+	bool texture_generate_mipmaps(texture_base& tb, unsigned int dim) const;
+	bool texture_destruct(texture_base& tb) const;
+	bool texture_set_state(const texture_base& tb) const;
+	bool texture_enable(texture_base& tb, int tex_unit, unsigned int nr_dims) const;
+	bool texture_disable(texture_base& tb, int tex_unit, unsigned int nr_dims) const;
+
+	bool render_buffer_create(render_component& rc, cgv::data::component_format& cf, int& _width, int& _height) const;
+	bool render_buffer_destruct(render_component& rc) const;
+
+	bool frame_buffer_create(frame_buffer_base& fbb) const;
+	bool frame_buffer_is_complete(const frame_buffer_base& fbb) const;
+	bool frame_buffer_enable(frame_buffer_base& fbb);
+	bool frame_buffer_disable(frame_buffer_base& fbb);
+	bool frame_buffer_destruct(frame_buffer_base& fbb) const;
+	int frame_buffer_get_max_nr_color_attachments() const;
+	int frame_buffer_get_max_nr_draw_buffers() const;
+
+	bool shader_code_create(render_component& sc, ShaderType st, const std::string& source) const;
+	bool shader_code_compile(render_component& sc) const;
+	void shader_code_destruct(render_component& sc) const;
+
+	bool shader_program_create(shader_program_base& spb) const;
+	void shader_program_attach(shader_program_base& spb, const render_component& sc) const;
+	void shader_program_detach(shader_program_base& spb, const render_component& sc) const;
+	bool shader_program_set_state(shader_program_base& spb) const;
+	bool shader_program_enable(shader_program_base& spb);
+	bool shader_program_disable(shader_program_base& spb);
+	bool shader_program_destruct(shader_program_base& spb) const;
+	int  get_uniform_location(const shader_program_base& spb, const std::string& name) const;
+	bool set_uniform_void(shader_program_base& spb, int loc, type_descriptor value_type, const void* value_ptr) const;
+	bool set_uniform_array_void(shader_program_base& spb, int loc, type_descriptor value_type, const void* value_ptr, size_t nr_elements) const;
+	int  get_attribute_location(const shader_program_base& spb, const std::string& name) const;
+	bool set_attribute_void(shader_program_base& spb, int loc, type_descriptor value_type, const void* value_ptr) const;
+
+	bool attribute_array_binding_create(attribute_array_binding_base& aab) const;
+	bool attribute_array_binding_destruct(attribute_array_binding_base& aab) const;
+	bool attribute_array_binding_enable(attribute_array_binding_base& aab);
+	bool attribute_array_binding_disable(attribute_array_binding_base& aab);
+	bool set_attribute_array_void(attribute_array_binding_base* aab, int loc, type_descriptor value_type, const vertex_buffer_base* vbb, const void* ptr, size_t nr_elements = 0, unsigned stride_in_bytes = 0) const;
+	bool set_element_array(attribute_array_binding_base* aab, const vertex_buffer_base* vbb) const;
+	bool enable_attribute_array(attribute_array_binding_base* aab, int loc, bool do_enable) const;
+	bool is_attribute_array_enabled(const attribute_array_binding_base* aab, int loc) const;
+
+	bool vertex_buffer_bind(const vertex_buffer_base& vbb, VertexBufferType _type) const;
+	bool vertex_buffer_create(vertex_buffer_base& vbb, const void* array_ptr, size_t size_in_bytes) const;
+	bool vertex_buffer_replace(vertex_buffer_base& vbb, size_t offset, size_t size_in_bytes, const void* array_ptr) const;
+	bool vertex_buffer_copy(const vertex_buffer_base& src, size_t src_offset, vertex_buffer_base& target, size_t target_offset, size_t size_in_bytes) const;
+	bool vertex_buffer_copy_back(vertex_buffer_base& vbb, size_t offset, size_t size_in_bytes, void* array_ptr) const;
+	bool vertex_buffer_destruct(vertex_buffer_base& vbb) const;
+public:
+	/// construct null context with the given extent of the virtual frame buffer
+	null_context(unsigned w = 640, unsigned h = 480);
+	/// destruct render objects
+	~null_context();
+	/// return "null_context"
+	std::string get_type_name() const;
+
+	/**@name children, registration and frames*/
+	//@{
+	/// append drawable child, initialize it and return index of appended child
+	unsigned int append_child(cgv::base::base_ptr child);
+	/// clear and remove all elements of the vector that point to child, return the number of removed children
+	unsigned int remove_child(cgv::base::base_ptr child);
+	/// clear and remove all children
+	void remove_all_children();
+	/// insert a drawable child at the given position and initialize it
+	void insert_child(unsigned int i, cgv::base::base_ptr child);
+	/// append registered drawables as children
+	void register_object(cgv::base::base_ptr object, const std::string& options = "");
+	/// remove unregistered drawables from children
+	void unregister_object(cgv::base::base_ptr object, const std::string& options = "");
+	/// enable or disable recording of the command stream, statistics are always collected
+	void set_recording(bool enable);
+	/// return whether commands are recorded
+	bool is_recording() const { return recording; }
+	/// clear command stream and statistics and render one frame with the default render pass flags
+	void render_frame();
+	/// render nr_frames frames, accumulate the CPU time per drawable and return the average CPU time per frame in seconds
+	double replay_frame(unsigned nr_frames = 1);
+	/// return commands recorded since the start of the current frame
+	const std::vector<null_context_command>& get_commands() const { return commands; }
+	/// return statistics since the start of the current frame
+	const render_statistics& get_statistics() const { return statistics; }
+	/// return CPU time per drawable accumulated over get_nr_timed_frames() frames
+	const std::vector<drawable_timing>& get_drawable_timings() const { return drawable_timings; }
+	/// return number of frames over which drawable timings are accumulated
+	unsigned get_nr_timed_frames() const { return nr_timed_frames; }
+	/// reset the drawable timings
+	void clear_drawable_timings();
+	/// print statistics of the current frame and average CPU time per drawable
+	void print_report(std::ostream& os) const;
+	/// record a draw call of renderers that issue draw commands themselves and skip them with a null context
+	void record_draw_call(size_t nr_vertices) const;
+	//@}
+
+	/**@name implementation of context interface*/
+	//@{
+	RenderAPI get_render_api() const;
+	void init_render_pass();
+	bool in_render_process() const;
+	bool is_created() const;
+	bool is_current() const;
+	bool make_current() const;
+	void clear_current() const;
+	void attach_alpha_buffer(bool attach = true);
+	void attach_depth_buffer(bool attach = true);
+	void attach_stencil_buffer(bool attach = true);
+	bool is_stereo_buffer_supported() const;
+	void attach_stereo_buffer(bool attach = true);
+	void attach_accumulation_buffer(bool attach = true);
+	void attach_multi_sample_buffer(bool attach = true);
+	unsigned int get_width() const;
+	unsigned int get_height() const;
+	void resize(unsigned int width, unsigned int height);
+	/// no frame buffer content is available, such that this always fails
+	bool read_frame_buffer(data::data_view& dv, unsigned int x = 0, unsigned int y = 0, FrameBufferType buffer_type = FB_BACK,
+		TypeId type = type::info::TI_UINT8, data::ComponentFormat cf = data::CF_RGB, int w = -1, int h = -1);
+	/// remember the redraw request, which is cleared by the next frame
+	void post_redraw();
+	/// render a frame immediately
+	void force_redraw();
+	/// return whether a redraw has been requested since the last frame
+	bool is_redraw_requested() const { return redraw_requested; }
+	void announce_external_frame_buffer_change(void*& cgv_fbo_storage);
+	void recover_from_external_frame_buffer_change(void* cgv_fbo_storage);
+	void enable_font_face(media::font::font_face_ptr font_face, float font_size);
+	void set_color(const rgba& clr);
+	void enable_material(textured_material& mat);
+	void disable_material(textured_material& mat);
+	/// return a program without shader code, which uses the standard uniforms and attributes of the default program
+	shader_program& ref_default_shader_program(bool texture_support = false);
+	/// return a program without shader code, which uses the standard uniforms and attributes of the surface program
+	shader_program& ref_surface_shader_program(bool texture_support = false);
+	/// enumerate all uniform names that have been assigned a location
+	void enumerate_program_uniforms(shader_program& prog, std::vector<std::string>& names, std::vector<int>* locations_ptr = 0, std::vector<int>* sizes_ptr = 0, std::vector<int>* types_ptr = 0, bool show = false) const;
+	/// enumerate all attribute names that have been assigned a location
+	void enumerate_program_attributes(shader_program& prog, std::vector<std::string>& names, std::vector<int>* locations_ptr = 0, std::vector<int>* sizes_ptr = 0, std::vector<int>* types_ptr = 0, bool show = false) const;
+	void draw_edges_of_faces(const float* vertices, const float* normals, const float* tex_coords,
+		const int* vertex_indices, const int* normal_indices, const int* tex_coord_indices,
+		int nr_faces, int face_degree, bool flip_normals = false) const;
+	void draw_edges_of_strip_or_fan(const float* vertices, const float* normals, const float* tex_coords,
+		const int* vertex_indices, const int* normal_indices, const int* tex_coord_indices,
+		int nr_faces, int face_degree, bool is_fan, bool flip_normals = false) const;
+	void draw_faces(const float* vertices, const float* normals, const float* tex_coords,
+		const int* vertex_indices, const int* normal_indices, const int* tex_coord_indices,
+		int nr_faces, int face_degree, bool flip_normals = false) const;
+	void draw_strip_or_fan(const float* vertices, const float* normals, const float* tex_coords,
+		const int* vertex_indices, const int* normal_indices, const int* tex_coord_indices,
+		int nr_faces, int face_degree, bool is_fan, bool flip_normals = false) const;
+	void push_pixel_coords();
+	void pop_pixel_coords();
+	dmat4 get_modelview_matrix() const;
+	void set_modelview_matrix(const dmat4& V);
+	dmat4 get_projection_matrix() const;
+	void set_projection_matrix(const dmat4& P);
+	void set_viewport(const ivec4& viewport, int array_index = -1);
+	void announce_external_viewport_change(ivec4& cgv_viewport_storage);
+	void recover_from_external_viewport_change(const ivec4& cgv_viewport_storage);
+	unsigned get_max_window_transformation_array_size() const;
+	/// return the background depth as no depth buffer is available
+	double get_window_z(int x_window, int y_window) const;
+	//@}
+};
+
+/// ref counted pointer to null context
+typedef cgv::data::ref_ptr<null_context, true> null_context_ptr;
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -16,6 +16,14 @@ void performance_monitor::add_measurement(const performance_measurement& pm)
 	current_frame().push_back(pm); 
 }
 
+void performance_monitor::add_measurement(int task_id, bool start)
+{
+	cgv::type::uint64_type time = cgv::utils::get_trace_time();
+	if (cgv::utils::is_tracing_enabled())
+		cgv::utils::record_trace_event(tasks[task_id].trace_name_id, start ? cgv::utils::TP_BEGIN : cgv::utils::TP_END, time);
+	add_measurement(performance_measurement(1e-9*(time - frame_start_time), task_id, start));
+}
+
 performance_monitor::performance_monitor() : plot_color(0.3f,1,1)
 {
 	fps = -1;
@@ -28,6 +36,7 @@ performance_monitor::performance_monitor() : plot_color(0.3f,1,1)
 	nr_display_cycles = 2;
 	bar_line_width = 5;
 	frame_id = 0;
+	frame_start_time = 0;
 	init_tasks();
 	bar_config.push_back(PMB_MAX);
 	bar_config.push_back(PMB_CUR);
@@ -108,9 +117,8 @@ void performance_monitor::start_frame()
 	while (data.size() >= get_buffer_size())
 		data.pop_front();
 	data.push_back(frame_data());
-	watch.restart();
-	performance_measurement pm(watch.get_elapsed_time(), 0, true);
-	add_measurement(pm);
+	frame_start_time = cgv::utils::get_trace_time();
+	add_measurement(0, true);
 	frame_finished = false;
 	++frame_id;
 }
@@ -120,16 +128,14 @@ void performance_monitor::start_task(int task_id)
 {
 	if (!enabled)
 		return;
-	performance_measurement pm(watch.get_elapsed_time(), task_id, true);
-	add_measurement(pm);
+	add_measurement(task_id, true);
 }
 
 void performance_monitor::finish_task(int task_id)
 {
 	if (!enabled)
 		return;
-	performance_measurement pm(watch.get_elapsed_time(), task_id, false);
-	add_measurement(pm);
+	add_measurement(task_id, false);
 }
 /// finish measurement of a frame, if this is not called by hand, it is called automatically in the next call to start_frame.
 void performance_monitor::finish_frame()
@@ -137,8 +143,7 @@ void performance_monitor::finish_frame()
 	if (!enabled)
 		return;
 	const char* start_or_finish[] = { "start", "finish" };
-	performance_measurement pm(watch.get_elapsed_time(), 0, false);
-	add_measurement(pm);
+	add_measurement(0, false);
 	double new_fps = 1.0 / (data.back().back().time - data.back().front().time);
 	if (fps < 0)
 		fps = new_fps;
@@ -2,7 +2,7 @@
 
 #include <deque>
 #include <vector>
-#include <cgv/utils/stopwatch.h>
+#include <cgv/utils/trace.h>
 #include <cgv/media/axis_aligned_box.h>
 #include <cgv/media/color.h>
 
@@ -31,14 +31,18 @@ struct CGV_API performance_task
 {
 	std::string name;
 	cgv::media::color<float> col;
-	performance_task(std::string _name, cgv::media::color<float> _col) : name(_name), col(_col) {}
+	/// id of the name in the trace of cgv/utils/trace.h
+	unsigned trace_name_id;
+	performance_task(std::string _name, cgv::media::color<float> _col) : name(_name), col(_col), trace_name_id(cgv::utils::intern_trace_name(_name)) {}
 };
 
 /** This class allows to monitor the performance of a set of tasks that are repeatedly 
     executed over time. Each repetition is called a frame. The performance monitor 
 	supports storage of performance information in a file and prepares everything for
 	rendering performance measurements, where the actually rendering is implemented in
-	libs/cgv_gl/gl/gl_performance_monitor. */
+	libs/cgv_gl/gl/gl_performance_monitor. Measurements use the clock of cgv/utils/trace.h
+	and are also recorded as trace events if tracing is enabled, such that frames and
+	render passes appear in exported traces with the same time stamps as in the bar. */
 class CGV_API performance_monitor
 {
 public:
@@ -62,7 +66,8 @@ protected:
 	std::deque<frame_data> data;
 	std::vector<PerformanceMonitoringBar> bar_config;
 
-	cgv::utils::stopwatch watch;
+	/// trace time of the start of the current frame
+	cgv::type::uint64_type frame_start_time;
 	float time_scale;
 	std::vector<Pos> positions;
 	std::vector<Col> colors;
@@ -71,6 +76,8 @@ protected:
 	void compute_positions(int x, int y, int dx, int dy, const frame_data& fdata);
 	frame_data& current_frame();
 	void add_measurement(const performance_measurement& pm);
+	/// add a measurement at the current time and record it as trace event if tracing is enabled
+	void add_measurement(int task_id, bool start);
 
 public:
 	/// construct performance monitor with standard configuration
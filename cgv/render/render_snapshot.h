@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cgv/type/standard_types.h>
+
+namespace cgv {
+	namespace render {
+
+/** triple buffer through which an update thread publishes immutable snapshots of the render state of a drawable to
+	the render thread. The update side fills the snapshot returned by ref_back() and hands it over with publish(). The
+	render side calls consume() once per frame, typically in init_frame() of the main render pass, such that all passes
+	of a frame draw the same snapshot. consume() makes the latest published snapshot available through ref_front() and
+	returns whether it changed, where snapshots published in between are skipped. None of the calls blocks and the
+	front snapshot is not modified until the next call to consume(), such that drawing does not need to be synchronized
+	with updates. Only a single thread at a time may act as update side, what the update_pool guarantees for the tasks
+	of the same owner. The snapshot returned by ref_back() still holds the content of an older snapshot and needs to be
+	overwritten completely, where the capacity of vectors is reused. */
+template <typename T>
+class snapshot_buffer
+{
+protected:
+	/// flag in shared_slot that marks a published but not yet consumed snapshot
+	static const unsigned fresh_flag = 4;
+	/// the three snapshots
+	T slots[3];
+	/// version of the snapshot stored in each slot, where 0 is used for slots that were never published
+	cgv::type::uint64_type versions[3];
+	/// slot exchanged between update and render side together with the fresh_flag
+	std::atomic<unsigned> shared_slot;
+	/// slot filled by the update side
+	unsigned back_slot;
+	/// slot read by the render side
+	unsigned front_slot;
+	/// number of published snapshots, only accessed by the update side
+	cgv::type::uint64_type nr_published;
+public:
+	/// construct with default constructed snapshots and without published snapshot
+	snapshot_buffer() : shared_slot(1), back_slot(0), front_slot(2), nr_published(0)
+	{
+		versions[0] = versions[1] = versions[2] = 0;
+	}
+	/**@name update side*/
+	//@{
+	/// return the snapshot under construction
+	T& ref_back() { return slots[back_slot]; }
+	/// publish the snapshot under construction, which is not accessed by the update side afterwards, and return its version
+	cgv::type::uint64_type publish()
+	{
+		versions[back_slot] = ++nr_published;
+		back_slot = shared_slot.exchange(back_slot | fresh_flag, std::memory_order_acq_rel) & 3;
+		return nr_published;
+	}
+	/// return the number of published snapshots
+	cgv::type::uint64_type get_nr_published() const { return nr_published; }
+	//@}
+
+	/**@name render side*/
+	//@{
+	/// return whether a snapshot has been published since the last call to consume()
+	bool has_new_snapshot() const { return (shared_slot.load(std::memory_order_acquire) & fresh_flag) != 0; }
+	/// make the latest published snapshot the front snapshot and return whether a new snapshot was available
+	bool consume()
+	{
+		if (!has_new_snapshot())
+			return false;
+		front_slot = shared_slot.exchange(front_slot, std::memory_order_acq_rel) & 3;
+		return true;
+	}
+	/// return the front snapshot, which is default constructed as long as get_front_version() returns 0
+	const T& ref_front() const { return slots[front_slot]; }
+	/// return the version of the front snapshot or 0 if none has been consumed yet
+	cgv::type::uint64_type get_front_version() const { return versions[front_slot]; }
+	//@}
+};
+
+/** keeps track of the snapshot version that has been uploaded to render objects like vertex buffers or attribute
+	arrays, such that uploads are only performed when the render side consumed a new snapshot. */
+class snapshot_upload_tracker
+{
+protected:
+	/// version of the uploaded snapshot, 0 if nothing has been uploaded
+	cgv::type::uint64_type uploaded_version;
+public:
+	/// construct without uploaded snapshot
+	snapshot_upload_tracker() : uploaded_version(0) {}
+	/// return whether the front snapshot of the buffer differs from the uploaded one
+	template <typename T>
+	bool needs_upload(const snapshot_buffer<T>& sb) const { return sb.get_front_version() != uploaded_version; }
+	/// record that the front snapshot of the buffer has been uploaded
+	template <typename T>
+	void set_uploaded(const snapshot_buffer<T>& sb) { uploaded_version = sb.get_front_version(); }
+	/// return the uploaded version
+	cgv::type::uint64_type get_uploaded_version() const { return uploaded_version; }
+	/// forget about the upload, for example after the render objects have been destructed
+	void invalidate() { uploaded_version = 0; }
+};
+
+	}
+}
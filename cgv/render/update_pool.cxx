@@ -0,0 +1,96 @@
+#include "update_pool.h"
+
+namespace cgv {
+	namespace render {
+
+update_pool::update_pool(cgv::os::task_scheduler* _scheduler, cgv::os::ExecutionPriority _priority) :
+	scheduler(_scheduler ? *_scheduler : cgv::os::ref_task_scheduler()), priority(_priority)
+{
+}
+
+update_pool::~update_pool()
+{
+	wait_all();
+}
+
+unsigned update_pool::get_nr_threads() const
+{
+	return scheduler.get_nr_threads();
+}
+
+void update_pool::process(const void* owner)
+{
+	std::unique_lock<std::mutex> lock(mtx);
+	while (true) {
+		std::map<const void*, owner_state>::iterator i = owners.find(owner);
+		// tasks scheduled while the previous one was running are processed by the same scheduler task
+		if (!i->second.has_task) {
+			owners.erase(i);
+			break;
+		}
+		std::function<void()> task;
+		task.swap(i->second.task);
+		i->second.has_task = false;
+		lock.unlock();
+		task();
+		lock.lock();
+	}
+	idle_cv.notify_all();
+}
+
+bool update_pool::schedule(const void* owner, const std::function<void()>& task)
+{
+	bool replaced, spawn;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		spawn = owners.find(owner) == owners.end();
+		owner_state& os = owners[owner];
+		replaced = os.has_task;
+		os.task = task;
+		os.has_task = true;
+	}
+	if (spawn)
+		scheduler.spawn(std::bind(&update_pool::process, this, owner), priority);
+	return !replaced;
+}
+
+bool update_pool::cancel(const void* owner)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	std::map<const void*, owner_state>::iterator i = owners.find(owner);
+	if (i == owners.end() || !i->second.has_task)
+		return false;
+	// the spawned scheduler task finds no pending task and removes the owner
+	i->second.task = std::function<void()>();
+	i->second.has_task = false;
+	return true;
+}
+
+bool update_pool::is_busy(const void* owner) const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	return owners.find(owner) != owners.end();
+}
+
+void update_pool::wait(const void* owner)
+{
+	std::unique_lock<std::mutex> lock(mtx);
+	while (owners.find(owner) != owners.end())
+		idle_cv.wait(lock);
+}
+
+void update_pool::wait_all()
+{
+	std::unique_lock<std::mutex> lock(mtx);
+	while (!owners.empty())
+		idle_cv.wait(lock);
+}
+
+update_pool& ref_update_pool()
+{
+	static update_pool pool;
+	return pool;
+}
+
+	}
+}
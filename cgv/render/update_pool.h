@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cgv/os/task_scheduler.h>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace render {
+
+/** schedules the update tasks of drawables outside of the render thread on a cgv::os::task_scheduler. Tasks are
+	scheduled per owner, typically the drawable, and the tasks of one owner never run concurrently, such that a task can
+	publish into the snapshot_buffer of its owner without further synchronization. An owner has at most one pending
+	task, where scheduling another one replaces the pending task. Thus updates that fall behind skip intermediate states
+	instead of piling up. The process wide pool is accessed with ref_update_pool() and uses the process wide task
+	scheduler. Owners need to call wait() before they are destructed or before they access the state of their tasks
+	from another thread. */
+class CGV_API update_pool
+{
+protected:
+	/// scheduling state of an owner
+	struct owner_state
+	{
+		/// pending task
+		std::function<void()> task;
+		/// whether task is pending
+		bool has_task;
+		owner_state() : has_task(false) {}
+	};
+	/// scheduler that executes the tasks
+	cgv::os::task_scheduler& scheduler;
+	/// priority of the scheduler tasks
+	cgv::os::ExecutionPriority priority;
+	/// protects owners
+	mutable std::mutex mtx;
+	/// signals finished owners to wait()
+	std::condition_variable idle_cv;
+	/// owners for which a scheduler task has been spawned that processes their pending tasks
+	std::map<const void*, owner_state> owners;
+	/// scheduler task that runs the pending tasks of an owner one after the other until none is left
+	void process(const void* owner);
+public:
+	/// construct the pool on the given scheduler or on the process wide scheduler if none is given
+	update_pool(cgv::os::task_scheduler* _scheduler = 0, cgv::os::ExecutionPriority _priority = cgv::os::EP_NORMAL);
+	/// finish all pending tasks
+	~update_pool();
+	/// return the number of threads of the scheduler
+	unsigned get_nr_threads() const;
+	/// schedule a task of the given owner and return false if it replaced a pending task of the owner
+	bool schedule(const void* owner, const std::function<void()>& task);
+	/// remove the pending task of the owner and return whether there was one, a running task is not interrupted
+	bool cancel(const void* owner);
+	/// return whether the owner has a pending or running task
+	bool is_busy(const void* owner) const;
+	/// block until the owner has neither a pending nor a running task
+	void wait(const void* owner);
+	/// block until all scheduled tasks have been processed
+	void wait_all();
+};
+
+/// return the process wide update pool, which is constructed on first access
+extern CGV_API update_pool& ref_update_pool();
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -1,4 +1,6 @@
 #include "advanced_scan.h"
+#include "char_set.h"
+#include <cstring>
 
 namespace cgv {
 	namespace utils {
@@ -12,6 +14,10 @@ void split_to_tokens(
 			const std::string& whitespaces,
 			unsigned int max_nr_tokens)
 {
+	// lookup tables replace the string searches and allow to skip plain characters in blocks
+	char_set whitespace_set(whitespaces), separator_set(separators), special_set(whitespaces);
+	special_set.add(separators);
+	special_set.add(open_parenthesis);
 	const char* b = begin;
 	const char* p = b;
 	size_t pos;
@@ -20,10 +26,10 @@ void split_to_tokens(
 		bool is_sep = false;
 		bool is_whitespace = false;
 		bool create_token = false;
-		if (p == end || (is_whitespace = is_element(*p, whitespaces)))
+		if ((is_whitespace = whitespace_set.contains(*p)))
 			create_token = true;
 		else {
-			is_sep=is_element(*p, separators);
+			is_sep = separator_set.contains(*p);
 			if (is_sep) {
 				if (!(last_is_sep && merge_separators))
 					create_token = true;
@@ -31,6 +37,8 @@ void split_to_tokens(
 			else
 				if (last_is_sep)
 					create_token = true;
+				else if (!special_set.contains(*p))
+					p = special_set.find_first(p+1, end) - 1;
 		}
 		last_is_sep = is_sep;
 		if (create_token) {
@@ -67,8 +75,10 @@ void split_to_lines(const char* global_begin, const char* global_end,
 	const char* ptr = global_begin;
 	while (ptr < global_end) {
 		const char* begin = ptr;
-		while (ptr < global_end && *ptr != '\n' )
-			++ptr;
+		// memchr is vectorized by the c runtime
+		ptr = static_cast<const char*>(memchr(ptr, '\n', global_end - ptr));
+		if (!ptr)
+			ptr = global_end;
 		const char* end = ptr;
 		if (truncate_trailing_spaces) {
 			while (end > begin && is_space(end[-1]))
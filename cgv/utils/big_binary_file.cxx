@@ -1,40 +1,283 @@
+#ifndef _MSC_VER
+#define _FILE_OFFSET_BITS 64
+#endif
 #include <cgv/utils/big_binary_file.h>
 #include <iostream>
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #ifdef _MSC_VER
 #include <windows.h>
 HANDLE& F(void*& file) { return (HANDLE&) file; }
 const HANDLE& F(const void*& file) { return (const HANDLE&) file; }
-std::wstring str2wstr(const std::string& s)
-{
-	std::wstring ws;
-	ws.resize(s.size());
+std::wstring str2wstr(const std::string& s)
+{
+	std::wstring ws;
+	ws.resize(s.size());
 	int n = MultiByteToWideChar(CP_ACP,0,s.c_str(),(int)s.size(),&ws[0],(int)ws.size());
 	ws.resize(n);
 	return ws;
-}
+}
 #else
-FILE*& F(void*& file) { return (FILE*&) file; }
-const FILE*& F(const void*& file) { return (const FILE*&) file; }
-std::string str2wstr(const std::string& s)
-{
-	std::cerr << "str2wstr(const std::string& s) not implemented" << std::endl;
-	return s;
-}
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+static int FD(void* file) { return (int)(intptr_t)file; }
 #endif
 
 
 namespace cgv {
 	namespace utils{
 
-	#ifdef _MSC_VER
-
-	big_binary_file::big_binary_file(const std::string &filename)
+namespace {
+	/// pool of threads shared by all files that processes asynchronous reads
+	class io_thread_pool
 	{
-		this->filename = filename;
-		fileopened=false;
+		std::vector<std::thread> threads;
+		std::deque<std::function<void()> > tasks;
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool stop;
+		void run()
+		{
+			for (;;) {
+				std::function<void()> task;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					condition.wait(lock, [this] { return stop || !tasks.empty(); });
+					if (tasks.empty())
+						return;
+					task = std::move(tasks.front());
+					tasks.pop_front();
+				}
+				task();
+			}
+		}
+	public:
+		/// several threads keep requests outstanding also on single core machines, as they mostly wait for the device
+		io_thread_pool(unsigned nr_threads) : stop(false)
+		{
+			for (unsigned i = 0; i < nr_threads; ++i)
+				threads.push_back(std::thread(&io_thread_pool::run, this));
+		}
+		~io_thread_pool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stop = true;
+			}
+			condition.notify_all();
+			for (size_t i = 0; i < threads.size(); ++i)
+				threads[i].join();
+		}
+		void enqueue(const std::function<void()>& task)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				tasks.push_back(task);
+			}
+			condition.notify_one();
+		}
 	};
-		
+	io_thread_pool& ref_io_thread_pool()
+	{
+		static io_thread_pool pool(4);
+		return pool;
+	}
+}
+
+struct big_binary_file::async_state
+{
+	std::mutex mutex;
+	std::condition_variable condition;
+	/// number of asynchronous reads that have not finished yet
+	unsigned nr_pending;
+	/// current read ahead window [0] and next window [1] that is loaded in the background
+	std::vector<unsigned char> window[2];
+	long long window_begin[2];
+	size_t window_size[2];
+	std::future<size_t> next_window;
+	async_state() : nr_pending(0)
+	{
+		window_begin[0] = window_begin[1] = 0;
+		window_size[0] = window_size[1] = 0;
+	}
+};
+
+big_binary_file::big_binary_file(const std::string &filename)
+	: access_mode(READ), filename(filename), fileopened(false), file(0), file_position(0),
+	  map_ptr(0), map_length(0), map_base(0), map_base_length(0), map_handle(0), read_ahead_size(0), async(0)
+{
+}
+
+big_binary_file::~big_binary_file()
+{
+	close();
+	delete async;
+}
+
+bool big_binary_file::is_open()
+{
+	return fileopened;
+}
+
+bool big_binary_file::read(unsigned char *targetbuffer, size_t num, size_t *numread)
+{
+	if (!fileopened || (access_mode & READ) == 0)
+		return false;
+	size_t _numread = 0;
+	if (read_ahead_size > 0)
+		read_ahead(targetbuffer, num, _numread);
+	else {
+		read_at(file_position, targetbuffer, num, &_numread);
+		file_position += _numread;
+	}
+	if (numread)
+		*numread = _numread;
+	return num == _numread;
+}
+
+bool big_binary_file::seek(long long index)
+{
+	if (!fileopened || index < 0)
+		return false;
+	file_position = index;
+	return true;
+}
+
+long long big_binary_file::position()
+{
+	if (fileopened)
+		return file_position;
+	else
+		return false;
+}
+
+void big_binary_file::set_read_ahead(size_t window_size)
+{
+	reset_read_ahead();
+	read_ahead_size = window_size;
+#if !defined(_MSC_VER) && defined(POSIX_FADV_SEQUENTIAL)
+	if (fileopened)
+		posix_fadvise(FD(file), 0, 0, read_ahead_size > 0 ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_NORMAL);
+#endif
+}
+
+bool big_binary_file::read_ahead(unsigned char *targetbuffer, size_t num, size_t& numread)
+{
+	if (!async)
+		async = new async_state();
+	async_state& s = *async;
+	numread = 0;
+	while (num > 0) {
+		// serve from current window
+		if (file_position >= s.window_begin[0] && file_position < s.window_begin[0] + (long long)s.window_size[0]) {
+			size_t offset = size_t(file_position - s.window_begin[0]);
+			size_t n = std::min(num, s.window_size[0] - offset);
+			std::memcpy(targetbuffer, &s.window[0][offset], n);
+			targetbuffer += n;
+			num -= n;
+			numread += n;
+			file_position += n;
+			continue;
+		}
+		// sequential case where the next window starts at the current position
+		if (s.next_window.valid() && s.window_begin[1] == file_position) {
+			s.window_size[1] = s.next_window.get();
+			std::swap(s.window[0], s.window[1]);
+			std::swap(s.window_begin[0], s.window_begin[1]);
+			std::swap(s.window_size[0], s.window_size[1]);
+		}
+		else {
+			// after a jump, read large requests directly and small ones through a new window
+			if (s.next_window.valid())
+				s.next_window.get();
+			if (num >= read_ahead_size) {
+				size_t n = 0;
+				read_at(file_position, targetbuffer, num, &n);
+				numread += n;
+				file_position += n;
+				break;
+			}
+			s.window[0].resize(read_ahead_size);
+			s.window_begin[0] = file_position;
+			read_at(file_position, &s.window[0][0], read_ahead_size, &s.window_size[0]);
+		}
+		if (s.window_size[0] == 0)
+			break;
+		// load the next window in the background unless the end of the file has been reached
+		if (s.window_size[0] == read_ahead_size) {
+			s.window[1].resize(read_ahead_size);
+			s.window_begin[1] = s.window_begin[0] + s.window_size[0];
+			s.next_window = read_async(s.window_begin[1], &s.window[1][0], read_ahead_size);
+		}
+	}
+	return num == 0;
+}
+
+void big_binary_file::reset_read_ahead()
+{
+	if (!async)
+		return;
+	if (async->next_window.valid())
+		async->next_window.get();
+	for (unsigned i = 0; i < 2; ++i) {
+		std::vector<unsigned char>().swap(async->window[i]);
+		async->window_begin[i] = 0;
+		async->window_size[i] = 0;
+	}
+}
+
+std::future<size_t> big_binary_file::read_async(long long offset, unsigned char *targetbuffer, size_t num)
+{
+	std::shared_ptr<std::promise<size_t> > promise = std::make_shared<std::promise<size_t> >();
+	std::future<size_t> result = promise->get_future();
+	read_async(offset, targetbuffer, num, [promise](size_t numread) { promise->set_value(numread); });
+	return result;
+}
+
+void big_binary_file::read_async(long long offset, unsigned char *targetbuffer, size_t num, const read_callback& callback)
+{
+	if (!fileopened || (access_mode & READ) == 0) {
+		callback(0);
+		return;
+	}
+	if (!async)
+		async = new async_state();
+	{
+		std::lock_guard<std::mutex> lock(async->mutex);
+		++async->nr_pending;
+	}
+	big_binary_file* self = this;
+	ref_io_thread_pool().enqueue([self, offset, targetbuffer, num, callback]() {
+		size_t numread = 0;
+		self->read_at(offset, targetbuffer, num, &numread);
+		callback(numread);
+		std::lock_guard<std::mutex> lock(self->async->mutex);
+		if (--self->async->nr_pending == 0)
+			self->async->condition.notify_all();
+	});
+}
+
+void big_binary_file::wait_async()
+{
+	if (!async)
+		return;
+	std::unique_lock<std::mutex> lock(async->mutex);
+	async->condition.wait(lock, [this] { return async->nr_pending == 0; });
+}
+
+	#ifdef _MSC_VER
+
 	bool big_binary_file::open( MODE m, const std::string& file_name)
 	{	
 			if(fileopened)
@@ -43,13 +286,14 @@ namespace cgv {
 			if (!file_name.empty())
 				filename = file_name;
 #ifdef UNICODE
-			std::wstring wfile_name = str2wstr(file_name);
+			std::wstring wfile_name = str2wstr(filename);
 			const wchar_t* name = wfile_name.c_str();
 #else
-			const char* name = file_name.c_str();
+			const char* name = filename.c_str();
 #endif
 
 			access_mode = m;
+			file_position = 0;
 			if(m == READ) {
 				//open for read
 				F(file) = CreateFile(name,						
@@ -91,18 +335,15 @@ namespace cgv {
 
 	void big_binary_file::close()
 	{
-		if(fileopened)
-			CloseHandle(F(file));	
+		if (!fileopened)
+			return;
+		wait_async();
+		reset_read_ahead();
+		unmap();
+		CloseHandle(F(file));	
 		fileopened=false;
-
-	}
-
-	bool big_binary_file::is_open()
-	{
-		return fileopened;
 	}
 
-
 	long long big_binary_file::size()
 	{
 			if(fileopened)
@@ -116,7 +357,8 @@ namespace cgv {
 			}
 			else
 			{
-				open(READ);
+				if (!open(READ))
+					return -1;
 
 				LARGE_INTEGER fs;
 				long long value;
@@ -131,101 +373,117 @@ namespace cgv {
 			}
 		}
 		
-	bool big_binary_file::read(unsigned char *targetbuffer,unsigned long num, unsigned long *numread)
-		{
-			if(fileopened && access_mode == READ)
-			{
-				if(numread == NULL)
-				{
-					unsigned long _numread;
-					ReadFile(F(file),targetbuffer,num,&_numread,NULL);
-					return num == _numread;
-				}
-				else
-				{
-					ReadFile(F(file),targetbuffer,num,numread,NULL);
-					return  num == *numread;
-				} 
+	bool big_binary_file::read_at(long long offset, unsigned char *targetbuffer, size_t num, size_t *numread)
+	{
+		size_t total = 0;
+		if (fileopened && (access_mode & READ) != 0) {
+			// ReadFile takes 32 bit sizes and reads from the offset in the OVERLAPPED structure without using the file pointer
+			while (total < num) {
+				DWORD n = (DWORD)std::min(num - total, size_t(1) << 30), _numread = 0;
+				OVERLAPPED o;
+				std::memset(&o, 0, sizeof(o));
+				o.Offset = DWORD(offset + total);
+				o.OffsetHigh = DWORD((offset + total) >> 32);
+				if (!ReadFile(F(file), targetbuffer + total, n, &_numread, &o) || _numread == 0)
+					break;
+				total += _numread;
 			}
-			return false;
 		}
+		if (numread)
+			*numread = total;
+		return total == num;
+	}
 
-	bool big_binary_file::write(const unsigned char *sourcebuffer,unsigned long num, unsigned long *numwrote)
+	bool big_binary_file::write(const unsigned char *sourcebuffer, size_t num, size_t *numwrote)
 		{
-			if(fileopened && access_mode == WRITE)
+			if(fileopened && (access_mode & WRITE) != 0)
 			{
-				if(numwrote == NULL)
-				{
-					unsigned long _numwrote;
-					WriteFile(F(file),sourcebuffer, num, &_numwrote, NULL);
-					return _numwrote == num;
-				}
-				else
-				{
-					if(!WriteFile(F(file),sourcebuffer, num, numwrote, NULL))
-
-					{
+				reset_read_ahead();
+				size_t total = 0;
+				while (total < num) {
+					DWORD n = (DWORD)std::min(num - total, size_t(1) << 30), _numwrote = 0;
+					OVERLAPPED o;
+					std::memset(&o, 0, sizeof(o));
+					o.Offset = DWORD(file_position);
+					o.OffsetHigh = DWORD(file_position >> 32);
+					if (!WriteFile(F(file), sourcebuffer + total, n, &_numwrote, &o)) {
 						std::cerr << "write error"<<std::endl;		
-						
+						break;
 					}
-
-					return *numwrote == num;
+					total += _numwrote;
+					file_position += _numwrote;
 				}
+				if (numwrote)
+					*numwrote = total;
+				return total == num;
 			}
 			return false;
 		}
-		
-	bool big_binary_file::seek(long long index)
-		{
-			if(fileopened)
-			{
-				LARGE_INTEGER l;
-					l.QuadPart=(index);
-			
-				if(SetFilePointerEx(F(file),l,NULL,FILE_BEGIN))
-					return true;
-				else
-					return false;
-			}
-			return false;
-		}
-
-	long long big_binary_file::position()
-		{
-			if(fileopened)
-			{
-				LARGE_INTEGER l1,l2;
-				l1.QuadPart=0;
-				if(SetFilePointerEx(F(file),l1,&l2,FILE_CURRENT))
-					return l2.QuadPart;
-				else
-					return -1;
-
-			}
-			else
-				return false;
 
+	unsigned char* big_binary_file::map(long long offset, size_t num, ACCESS_HINT hint)
+	{
+		unmap();
+		if (!fileopened || (access_mode & READ) == 0)
+			return NULL;
+		long long file_size = size();
+		if (offset < 0 || offset >= file_size)
+			return NULL;
+		if (num == 0 || offset + (long long)num > file_size)
+			num = size_t(file_size - offset);
+		bool writable = (access_mode & WRITE) != 0;
+		map_handle = CreateFileMapping(F(file), NULL, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+		if (!map_handle)
+			return NULL;
+		// views start at multiples of the allocation granularity
+		SYSTEM_INFO si;
+		GetSystemInfo(&si);
+		long long base = offset - offset % si.dwAllocationGranularity;
+		map_base_length = num + size_t(offset - base);
+		map_base = MapViewOfFile(map_handle, writable ? FILE_MAP_WRITE : FILE_MAP_READ, DWORD(base >> 32), DWORD(base), map_base_length);
+		if (!map_base) {
+			CloseHandle(map_handle);
+			map_handle = 0;
+			return NULL;
 		}
-		
+		map_ptr = static_cast<unsigned char*>(map_base) + (offset - base);
+		map_length = num;
+		if (hint != AH_NORMAL)
+			advise(0, num, hint);
+		return map_ptr;
+	}
 
-	big_binary_file::~big_binary_file()
+	bool big_binary_file::advise(size_t begin, size_t num, ACCESS_HINT hint)
 	{
-		if(fileopened)
-			CloseHandle(F(file));
+		if (!map_ptr || begin >= map_length)
+			return false;
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+		// windows only supports prefetching of mapped ranges
+		if (hint == AH_WILL_NEED) {
+			WIN32_MEMORY_RANGE_ENTRY range;
+			range.VirtualAddress = map_ptr + begin;
+			range.NumberOfBytes = std::min(num, map_length - begin);
+			return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0) != 0;
+		}
+#endif
+		return true;
 	}
 
+	void big_binary_file::unmap()
+	{
+		if (map_base)
+			UnmapViewOfFile(map_base);
+		if (map_handle)
+			CloseHandle(map_handle);
+		map_base = 0;
+		map_handle = 0;
+		map_ptr = 0;
+		map_length = map_base_length = 0;
+	}
 
 	#else
 
-/*
-	// Linux-Implementation
-	
-	big_binary_file::big_binary_file(const std::string &filename)
-	{
-		this->filename = filename;
-		fileopened=false;
-	};
-		
+	// Linux-Implementation based on pread and pwrite with 64 bit offsets
+
 	bool big_binary_file::open(MODE m, const std::string& file_name)
 	{	
 		if(fileopened)
@@ -235,153 +493,147 @@ namespace cgv {
 			filename = file_name;
 
 		access_mode = m;
-		if(m == READ)
-		{
-			//open for read
-			F(file) = fopen64(filename.c_str(), "rb");
-		} if (m == WRITE) else
-		{
-			//open for write
-			F(file) = fopen64(filename.c_str(), "wb");
-		}
-		else {
-			//open for write
-			F(file) = fopen64(filename.c_str(), "w+b");
-		}
-		if (file) {
-			fileopened=true;
-			return true;
-		}
-		return false;
+		file_position = 0;
+		int fd;
+		if (m == READ)
+			fd = ::open(filename.c_str(), O_RDONLY);
+		else if (m == WRITE)
+			fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		else
+			fd = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+		if (fd == -1)
+			return false;
+		file = (void*)(intptr_t)fd;
+		fileopened = true;
+		if (read_ahead_size > 0)
+			set_read_ahead(read_ahead_size);
+		return true;
 	}
 	
 	void big_binary_file::close()
 	{
-		if(fileopened)
-			fclose(F(file));	
-
+		if (!fileopened)
+			return;
+		wait_async();
+		reset_read_ahead();
+		unmap();
+		::close(FD(file));
 		fileopened=false;
 	}
 
-	bool big_binary_file::is_open()
-	{
-		return fileopened;
-	}
-	
 	long long big_binary_file::size()
 	{
-		if(fileopened)
-		{
-			off64_t size;
-
-			if(!fseeko64(F(file), 0, SEEK_END))
-			{
-  				size = ftello64(F(file));
-	  			fseeko64(F(file), 0, SEEK_SET);
-				return size;
-			}
-			else
-			{
-				fseeko64(F(file), 0, SEEK_SET);
+		if (fileopened) {
+			struct stat st;
+			if (fstat(FD(file), &st) != 0)
 				return -1;
-			}
-
-		}
-		else
-		{
-			open(READ);
-
-			off64_t size;
-			long long value;
-
-			if(!fseeko64(F(file), 0, SEEK_END))
-			{
-  				size = ftello64(F(file));
-	  			fseeko64(F(file), 0, SEEK_SET);
-				value = size;
-			}
-			else
-			{
-				fseeko64(F(file), 0, SEEK_SET);
-				value = -1;
-			}
-
-			close();
-
-			return value;
+			return st.st_size;
 		}
+		struct stat st;
+		if (stat(filename.c_str(), &st) != 0)
+			return -1;
+		return st.st_size;
 	}
 
-	bool big_binary_file::read(unsigned char *targetbuffer,unsigned long num, unsigned long *numread)
+	bool big_binary_file::read_at(long long offset, unsigned char *targetbuffer, size_t num, size_t *numread)
 	{
-		if(fileopened && access_mode == READ)
-		{
-			if(numread == NULL)
-			{
-				unsigned long _numread;
-				_numread = fread(targetbuffer, 1, num, F(file));
-				return num == _numread;
+		size_t total = 0;
+		if (fileopened && (access_mode & READ) != 0) {
+			while (total < num) {
+				ssize_t n = pread(FD(file), targetbuffer + total, num - total, off_t(offset + total));
+				if (n < 0 && errno == EINTR)
+					continue;
+				if (n <= 0)
+					break;
+				total += n;
 			}
-			else
-			{
-				*numread = fread(targetbuffer, 1, num, F(file));
-				return  num == *numread;
-			} 
 		}
-		return false;
+		if (numread)
+			*numread = total;
+		return total == num;
 	}
 
-	bool big_binary_file::write(unsigned char *sourcebuffer,unsigned long num, unsigned long *numwrote)
+	bool big_binary_file::write(const unsigned char *sourcebuffer, size_t num, size_t *numwrote)
 	{
-		if(fileopened && access_mode == WRITE)
-		{
-			if(numwrote == NULL)
-			{
-				unsigned long _numwrote;
-				_numwrote = fwrite(sourcebuffer, 1, num, F(file));
-				return _numwrote == num;
-			}
-			else
-			{
-				if(!fwrite(sourcebuffer, 1, num, F(file)))
-					std::cerr << "write error"<<std::endl;		
-
-				return *numwrote == num;
+		if (fileopened && (access_mode & WRITE) != 0) {
+			reset_read_ahead();
+			size_t total = 0;
+			while (total < num) {
+				ssize_t n = pwrite(FD(file), sourcebuffer + total, num - total, off_t(file_position));
+				if (n < 0 && errno == EINTR)
+					continue;
+				if (n <= 0) {
+					std::cerr << "write error" << std::endl;
+					break;
+				}
+				total += n;
+				file_position += n;
 			}
+			if (numwrote)
+				*numwrote = total;
+			return total == num;
 		}
 		return false;
 	}
 
-	bool big_binary_file::seek(long long index)
+	unsigned char* big_binary_file::map(long long offset, size_t num, ACCESS_HINT hint)
 	{
-		if(fileopened)
-		{
-			off64_t pos;
-			pos = index;
-
-			if(!fseeko64(F(file), pos, SEEK_SET)) 
-				return true;
-			else 
-				return false;
-		}
-
-		return false;
+		unmap();
+		if (!fileopened || (access_mode & READ) == 0)
+			return NULL;
+		long long file_size = size();
+		if (offset < 0 || offset >= file_size)
+			return NULL;
+		if (num == 0 || offset + (long long)num > file_size)
+			num = size_t(file_size - offset);
+		// mappings start at multiples of the page size
+		long long page_size = sysconf(_SC_PAGESIZE);
+		long long base = offset - offset % page_size;
+		size_t length = num + size_t(offset - base);
+		int protection = (access_mode & WRITE) != 0 ? PROT_READ | PROT_WRITE : PROT_READ;
+		void* ptr = mmap(0, length, protection, MAP_SHARED, FD(file), off_t(base));
+		if (ptr == MAP_FAILED)
+			return NULL;
+		map_base = ptr;
+		map_base_length = length;
+		map_ptr = static_cast<unsigned char*>(ptr) + (offset - base);
+		map_length = num;
+		if (hint != AH_NORMAL)
+			advise(0, num, hint);
+		return map_ptr;
 	}
 
-	long long big_binary_file::position()
+	bool big_binary_file::advise(size_t begin, size_t num, ACCESS_HINT hint)
 	{
-		if(fileopened)
-			return ftello64(F(file));
-		else
+		if (!map_ptr || begin >= map_length)
 			return false;
+		num = std::min(num, map_length - begin);
+		// madvise expects page aligned addresses
+		size_t page_size = sysconf(_SC_PAGESIZE);
+		unsigned char* ptr = map_ptr + begin;
+		size_t misalignment = size_t(ptr - static_cast<unsigned char*>(map_base)) % page_size;
+		ptr -= misalignment;
+		num += misalignment;
+		int advice = MADV_NORMAL;
+		switch (hint) {
+		case AH_SEQUENTIAL: advice = MADV_SEQUENTIAL; break;
+		case AH_RANDOM: advice = MADV_RANDOM; break;
+		case AH_WILL_NEED: advice = MADV_WILLNEED; break;
+		case AH_DONT_NEED: advice = MADV_DONTNEED; break;
+		default: break;
+		}
+		return madvise(ptr, num, advice) == 0;
 	}
-		
-	big_binary_file::~big_binary_file()
+
+	void big_binary_file::unmap()
 	{
-		if(fileopened)
-			fclose(F(file));
+		if (map_base)
+			munmap(map_base, map_base_length);
+		map_base = 0;
+		map_ptr = 0;
+		map_length = map_base_length = 0;
 	}
-*/
+
 	#endif
 
 	}
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <string>
+#include <cstddef>
+#include <functional>
+#include <future>
 #include "lib_begin.h"
 
 namespace cgv {
@@ -9,18 +12,51 @@ namespace cgv {
 * class to handle files with very large sizes (>=2GB)
 * hiding the ugly win32 api calls
 * 
-* linux-support by using 64bit pointer, LFS required in kernel
+* linux-support by using 64bit offsets with pread/pwrite
+*
+* Besides the synchronous read and write functions the class supports
+* - a memory mapped view of a range of the file with hints on the access pattern (map(), advise()),
+* - asynchronous reads at arbitrary offsets that return a future or call a callback, where
+*   several requests can be outstanding and are processed by a shared pool of io threads (read_async()),
+* - a read ahead window for sequential readers that loads the next window in the background
+*   while the current one is consumed (set_read_ahead()).
 */
 class CGV_API big_binary_file
 {
 public:
 	enum MODE {READ = 1, WRITE = 2, READ_WRITE = 3};
-
+	/// hints on how a mapped range is accessed
+	enum ACCESS_HINT { AH_NORMAL, AH_SEQUENTIAL, AH_RANDOM, AH_WILL_NEED, AH_DONT_NEED };
+	/// callback of asynchronous reads that is called from an io thread with the number of read bytes
+	typedef std::function<void(size_t)> read_callback;
+	/// state of asynchronous requests and read ahead that is private to the implementation
+	struct async_state;
 private:
 	MODE access_mode;
 	std::string filename;
 	bool fileopened;
 	void* file;
+	/// position of next read or write
+	long long file_position;
+	/// begin and length of the mapped range as well as the aligned base address and size of the mapping
+	unsigned char* map_ptr;
+	size_t map_length;
+	void* map_base;
+	size_t map_base_length;
+	/// handle of the file mapping object under windows
+	void* map_handle;
+	/// size of the read ahead window or 0 if disabled
+	size_t read_ahead_size;
+	/// created on the first asynchronous request
+	async_state* async;
+	/// read from the current read ahead windows and return whether the request could be served
+	bool read_ahead(unsigned char *targetbuffer, size_t num, size_t& numread);
+	/// discard read ahead windows after waiting for a pending window
+	void reset_read_ahead();
+	/// no copy construction
+	big_binary_file(const big_binary_file&);
+	/// no assignment
+	big_binary_file& operator = (const big_binary_file&);
 public:
 	
 	///assosiates the new instance to the file filename
@@ -32,7 +68,7 @@ public:
 	///open a file in read or write mode
 	bool open(MODE m, const std::string& file_name = "");
 	
-	///close the file
+	///close the file after waiting for outstanding asynchronous reads and unmapping the mapped range
 	void close();
 	
 	///return true if the file is opened
@@ -42,30 +78,59 @@ public:
 	long long size();
 		
 	///read num bytes from the file into the targetbuffer
-	bool read(unsigned char *targetbuffer,unsigned long num, unsigned long *numread=NULL);
+	bool read(unsigned char *targetbuffer, size_t num, size_t *numread = NULL);
 
 	///write num bytes to the file from the sourcebuffer (file must be opened with write access first)
-	bool write(const unsigned char *sourcebuffer,unsigned long num, unsigned long *numwrote=NULL);
+	bool write(const unsigned char *sourcebuffer, size_t num, size_t *numwrote = NULL);
+
+	/// read num bytes at the given offset without changing the file position, can be called from several threads
+	bool read_at(long long offset, unsigned char *targetbuffer, size_t num, size_t *numread = NULL);
 
 	/// read a typedef value
 	template <typename T>
 	bool read(T& v) { return read((unsigned char*)(&v),sizeof(T)); }
 	/// read an array of typed values
 	template <typename T>
-	bool read_array(T* a, unsigned int n) { return read((unsigned char*)a,sizeof(T)*n); }
+	bool read_array(T* a, size_t n) { return read((unsigned char*)a,sizeof(T)*n); }
 
 	/// write a typedef value
 	template <typename T>
 	bool write(const T& v) { return write((const unsigned char*)(&v),sizeof(T)); }
 	/// write an array of typed values
 	template <typename T>
-	bool write_array(const T* a, unsigned int n) { return write((const unsigned char*)a,sizeof(T)*n); }
+	bool write_array(const T* a, size_t n) { return write((const unsigned char*)a,sizeof(T)*n); }
 
 	//set the file pointer to index (position in bytes from the beginning of the file)
 	bool seek(long long index);
 	
 	///return the position of the file pointer in bytes 
 	long long position();
+
+	/// enable reading ahead in windows of the given size for sequential reads or disable it with size 0
+	void set_read_ahead(size_t window_size);
+	/// return the size of the read ahead window
+	size_t get_read_ahead() const { return read_ahead_size; }
+
+	/** start reading num bytes at offset into targetbuffer, which must stay valid until the returned
+	    future is ready. The future yields the number of read bytes. */
+	std::future<size_t> read_async(long long offset, unsigned char *targetbuffer, size_t num);
+	/// same as above but calls the callback from an io thread after the read has finished
+	void read_async(long long offset, unsigned char *targetbuffer, size_t num, const read_callback& callback);
+	/// wait until all asynchronous reads of this file have finished
+	void wait_async();
+
+	/** map num bytes starting at offset into memory, where num = 0 maps until the end of the file. The
+	    range is mapped writable if the file has been opened in READ_WRITE mode. Only one range can be mapped
+		at a time and a previously mapped range is unmapped. Returns a pointer to the byte at offset or NULL. */
+	unsigned char* map(long long offset = 0, size_t num = 0, ACCESS_HINT hint = AH_NORMAL);
+	/// give a hint on how a sub range of the mapped range given relative to the mapped range is accessed
+	bool advise(size_t begin, size_t num, ACCESS_HINT hint);
+	/// return pointer to mapped range or NULL
+	unsigned char* get_mapped_ptr() const { return map_ptr; }
+	/// return length of mapped range
+	size_t get_mapped_size() const { return map_length; }
+	/// unmap the mapped range
+	void unmap();
 };
 
 	}
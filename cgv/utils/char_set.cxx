@@ -0,0 +1,106 @@
+#include "char_set.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define CGV_UTILS_USE_SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace cgv {
+	namespace utils {
+
+#ifdef CGV_UTILS_USE_SSE2
+/// return index of lowest set bit of a non zero mask
+static inline unsigned lowest_bit(unsigned mask)
+{
+#ifdef _MSC_VER
+	unsigned long idx;
+	_BitScanForward(&idx, mask);
+	return idx;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+char_set::char_set()
+{
+	clear();
+}
+
+char_set::char_set(const std::string& s)
+{
+	clear();
+	add(s);
+}
+
+void char_set::clear()
+{
+	std::memset(table, 0, sizeof(table));
+	size = 0;
+}
+
+void char_set::add(const std::string& s)
+{
+	for (size_t i = 0; i < s.size(); ++i)
+		add(s[i]);
+}
+
+void char_set::add(char c)
+{
+	if (table[(unsigned char)c])
+		return;
+	table[(unsigned char)c] = true;
+	if (size < max_vectorized_size)
+		chars[size] = c;
+	++size;
+}
+
+const char* char_set::find_first(const char* p, const char* end) const
+{
+	if (size == 0)
+		return end;
+#ifdef CGV_UTILS_USE_SSE2
+	if (size <= max_vectorized_size) {
+#ifdef __AVX2__
+		if (end - p >= 32) {
+			__m256i needles[max_vectorized_size];
+			for (unsigned i = 0; i < size; ++i)
+				needles[i] = _mm256_set1_epi8(chars[i]);
+			for (; end - p >= 32; p += 32) {
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+				__m256i m = _mm256_cmpeq_epi8(v, needles[0]);
+				for (unsigned i = 1; i < size; ++i)
+					m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, needles[i]));
+				unsigned mask = (unsigned)_mm256_movemask_epi8(m);
+				if (mask)
+					return p + lowest_bit(mask);
+			}
+		}
+#endif
+		if (end - p >= 16) {
+			__m128i needles[max_vectorized_size];
+			for (unsigned i = 0; i < size; ++i)
+				needles[i] = _mm_set1_epi8(chars[i]);
+			for (; end - p >= 16; p += 16) {
+				__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+				__m128i m = _mm_cmpeq_epi8(v, needles[0]);
+				for (unsigned i = 1; i < size; ++i)
+					m = _mm_or_si128(m, _mm_cmpeq_epi8(v, needles[i]));
+				unsigned mask = (unsigned)_mm_movemask_epi8(m);
+				if (mask)
+					return p + lowest_bit(mask);
+			}
+		}
+	}
+#endif
+	while (p < end && !table[(unsigned char)*p])
+		++p;
+	return p;
+}
+
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace utils {
+
+/** a set of characters that supports constant time membership tests through a lookup table and
+    searching for the first member of the set in a text range. The search classifies 16 characters
+	at a time with SSE2 and 32 with AVX2 if the set contains at most max_vectorized_size characters,
+	which covers typical combinations of white spaces and separators. */
+class CGV_API char_set
+{
+public:
+	/// maximum number of characters for which the search is vectorized
+	static const unsigned max_vectorized_size = 16;
+protected:
+	/// lookup table with one entry per character
+	bool table[256];
+	/// distinct characters of the set
+	char chars[max_vectorized_size];
+	/// number of distinct characters
+	unsigned size;
+public:
+	/// construct empty set
+	char_set();
+	/// construct set from the characters of a string
+	char_set(const std::string& s);
+	/// remove all characters
+	void clear();
+	/// add the characters of a string
+	void add(const std::string& s);
+	/// add a single character
+	void add(char c);
+	/// return whether the set is empty
+	bool empty() const { return size == 0; }
+	/// check for membership
+	bool contains(char c) const { return table[(unsigned char)c]; }
+	/// return pointer to the first character in [begin,end) contained in the set or end if there is none
+	const char* find_first(const char* begin, const char* end) const;
+};
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -1,4 +1,6 @@
 #include "convert_string.h"
+#include "scan.h"
+#include <climits>
 
 namespace cgv {
 	namespace utils {
@@ -16,5 +18,39 @@ bool from_string(std::string& v, const std::string& s)
 	return true;
 }
 
+/// skip white spaces in the same way as the stream extraction operators
+static const char* skip_stream_spaces(const std::string& s)
+{
+	const char* p = s.c_str();
+	while (*p == ' ' || (*p >= '\t' && *p <= '\r'))
+		++p;
+	return p;
+}
+
+template <>
+bool from_string(int& v, const std::string& s)
+{
+	const char* p = skip_stream_spaces(s);
+	long long value;
+	if (parse_integer(p, s.c_str() + s.size(), value) == p || value < INT_MIN || value > INT_MAX)
+		return false;
+	v = (int)value;
+	return true;
+}
+
+template <>
+bool from_string(float& v, const std::string& s)
+{
+	const char* p = skip_stream_spaces(s);
+	return parse_float(p, s.c_str() + s.size(), v) != p;
+}
+
+template <>
+bool from_string(double& v, const std::string& s)
+{
+	const char* p = skip_stream_spaces(s);
+	return parse_double(p, s.c_str() + s.size(), v) != p;
+}
+
 	}
 }
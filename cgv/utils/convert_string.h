@@ -41,6 +41,15 @@ bool from_string(T& v, const std::string& s)
 /// specialization to extract string value from string
 template <> CGV_API bool from_string(std::string& v, const std::string& s);
 
+/// specialization to extract int value from string without constructing a stream
+template <> CGV_API bool from_string(int& v, const std::string& s);
+
+/// specialization to extract float value from string independent of the locale
+template <> CGV_API bool from_string(float& v, const std::string& s);
+
+/// specialization to extract double value from string independent of the locale
+template <> CGV_API bool from_string(double& v, const std::string& s);
+
 	}
 }
 
@@ -0,0 +1,32 @@
+#include "parallel_tasks.h"
+
+namespace cgv {
+	namespace utils {
+
+namespace {
+	std::atomic<parallel_tasks_handler> handler(nullptr);
+	std::atomic<unsigned (*)()> default_nr_threads_func(nullptr);
+}
+
+void set_parallel_tasks_handler(parallel_tasks_handler _handler, unsigned (*get_default_nr_threads)())
+{
+	default_nr_threads_func = get_default_nr_threads;
+	handler = _handler;
+}
+
+parallel_tasks_handler get_parallel_tasks_handler()
+{
+	return handler;
+}
+
+unsigned get_nr_parallel_tasks_threads(unsigned nr_threads)
+{
+	if (nr_threads != 0)
+		return nr_threads;
+	if (unsigned (*func)() = default_nr_threads_func)
+		return func();
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace utils {
+
+/// number of processed items below which parallel_tasks() does not start threads as their start up dominates
+const size_t min_parallel_work_size = 65536;
+
+/** signature of a function that calls f(t) for all tasks t in [0,nr_tasks) on up to nr_threads threads, where the
+	calling thread is one of them and nr_threads is at least two */
+typedef void (*parallel_tasks_handler)(size_t nr_tasks, unsigned nr_threads, const std::function<void(size_t)>& f);
+
+/** install the handler that executes parallel_tasks() together with the function that resolves nr_threads 0. If no
+	handler is installed, parallel_tasks() starts std::threads per call. cgv_os installs a handler that executes the
+	tasks on the process wide task scheduler. Pass 0 for both to uninstall the handler. */
+extern CGV_API void set_parallel_tasks_handler(parallel_tasks_handler handler, unsigned (*get_default_nr_threads)());
+/// return the installed handler or 0 if parallel_tasks() starts its own threads
+extern CGV_API parallel_tasks_handler get_parallel_tasks_handler();
+/** return nr_threads if it is not 0 and otherwise the number of threads used by parallel_tasks(), which is determined
+	by the installed handler or std::thread::hardware_concurrency() */
+extern CGV_API unsigned get_nr_parallel_tasks_threads(unsigned nr_threads = 0);
+
+/** call f(t) for all tasks t in [0,nr_tasks) on up to nr_threads threads, where the calling thread is one of them
+	and 0 selects get_nr_parallel_tasks_threads(). Tasks are handed out in increasing order. If the total number
+	of processed items given in work_size is smaller than min_parallel_work_size, all tasks are executed by the
+	calling thread. The tasks are dispatched to the installed parallel_tasks_handler, such that the helpers of
+	libraries below cgv_os run on the task scheduler whenever cgv_os is loaded. */
+template <typename F>
+void parallel_tasks(size_t nr_tasks, unsigned nr_threads, const F& f, size_t work_size = min_parallel_work_size)
+{
+	nr_threads = get_nr_parallel_tasks_threads(nr_threads);
+	if (nr_threads > nr_tasks)
+		nr_threads = unsigned(nr_tasks);
+	if (nr_threads <= 1 || work_size < min_parallel_work_size) {
+		for (size_t t = 0; t < nr_tasks; ++t)
+			f(t);
+		return;
+	}
+	if (parallel_tasks_handler handler = get_parallel_tasks_handler()) {
+		handler(nr_tasks, nr_threads, [&f](size_t t) { f(t); });
+		return;
+	}
+	std::atomic<size_t> next_task(0);
+	auto process = [&]() {
+		for (size_t t = next_task++; t < nr_tasks; t = next_task++)
+			f(t);
+	};
+	std::vector<std::thread> threads;
+	for (unsigned t = 1; t < nr_threads; ++t)
+		threads.push_back(std::thread(process));
+	process();
+	for (unsigned t = 0; t < threads.size(); ++t)
+		threads[t].join();
+}
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -2,6 +2,9 @@
 
 #include <stdlib.h>
 #include <algorithm>
+#include <limits>
+#include <locale>
+#include <sstream>
 
 namespace cgv {
 	namespace utils {
@@ -339,6 +342,160 @@ bool is_integer(const std::string& s, int& value)
 	return is_integer(&s[0], &s[0]+s.size(), value);
 }
 
+namespace {
+	/// decimal number split into up to 19 significant digits and a decimal exponent
+	struct decimal_number
+	{
+		unsigned long long mantissa;
+		int exponent;
+		bool negative;
+		/// whether non zero digits have been dropped from the mantissa
+		bool truncated;
+	};
+	/// scan a decimal number and return pointer after it or begin if no digit was found
+	const char* scan_decimal(const char* begin, const char* end, decimal_number& n)
+	{
+		n.mantissa = 0;
+		n.exponent = 0;
+		n.negative = false;
+		n.truncated = false;
+		const char* p = begin;
+		if (p < end && (*p == '+' || *p == '-'))
+			n.negative = *p++ == '-';
+		int nr_digits = 0;
+		bool found_digit = false;
+		for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+			found_digit = true;
+			if (nr_digits < 19) {
+				n.mantissa = 10 * n.mantissa + (*p - '0');
+				if (n.mantissa > 0)
+					++nr_digits;
+			}
+			else {
+				++n.exponent;
+				if (*p != '0')
+					n.truncated = true;
+			}
+		}
+		if (p < end && *p == '.') {
+			const char* q = p + 1;
+			for (; q < end && *q >= '0' && *q <= '9'; ++q) {
+				found_digit = true;
+				if (nr_digits < 19) {
+					n.mantissa = 10 * n.mantissa + (*q - '0');
+					--n.exponent;
+					if (n.mantissa > 0)
+						++nr_digits;
+				}
+				else if (*q != '0')
+					n.truncated = true;
+			}
+			if (found_digit)
+				p = q;
+		}
+		if (!found_digit)
+			return begin;
+		if (p < end && (*p == 'e' || *p == 'E')) {
+			const char* q = p + 1;
+			bool negative_exponent = false;
+			if (q < end && (*q == '+' || *q == '-'))
+				negative_exponent = *q++ == '-';
+			if (q < end && *q >= '0' && *q <= '9') {
+				int e = 0;
+				for (; q < end && *q >= '0' && *q <= '9'; ++q)
+					if (e < 100000)
+						e = 10 * e + (*q - '0');
+				n.exponent += negative_exponent ? -e : e;
+				p = q;
+			}
+		}
+		return p;
+	}
+	/// exactly representable powers of ten
+	const double double_powers_of_ten[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	const float float_powers_of_ten[] = {
+		1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+	};
+	/// correctly rounded conversion of the scanned text with the stream conversion of the classic locale
+	template <typename T>
+	T convert_decimal_classic(const char* begin, const char* end, const decimal_number& n)
+	{
+		std::istringstream is(std::string(begin, end));
+		is.imbue(std::locale::classic());
+		T value;
+		if (!(is >> value)) {
+			// out of range
+			value = n.exponent > 0 ? std::numeric_limits<T>::infinity() : T(0);
+			if (n.negative)
+				value = -value;
+		}
+		return value;
+	}
+}
+
+const char* parse_integer(const char* begin, const char* end, long long& value)
+{
+	const char* p = begin;
+	bool negative = false;
+	if (p < end && (*p == '+' || *p == '-'))
+		negative = *p++ == '-';
+	const unsigned long long limit = negative ? 9223372036854775808ull : 9223372036854775807ull;
+	unsigned long long v = 0;
+	const char* digits_begin = p;
+	for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+		unsigned d = *p - '0';
+		if (v > (limit - d) / 10)
+			return begin;
+		v = 10 * v + d;
+	}
+	if (p == digits_begin)
+		return begin;
+	value = negative ? (long long)(0 - v) : (long long)v;
+	return p;
+}
+
+const char* parse_double(const char* begin, const char* end, double& value)
+{
+	decimal_number n;
+	const char* p = scan_decimal(begin, end, n);
+	if (p == begin)
+		return begin;
+	if (n.mantissa == 0 && !n.truncated)
+		value = 0.0;
+	// both mantissa and power of ten are exact such that a single rounding step yields the correct result
+	else if (!n.truncated && n.mantissa <= (1ull << 53) && n.exponent >= -22 && n.exponent <= 22)
+		value = n.exponent < 0 ? double(n.mantissa) / double_powers_of_ten[-n.exponent] : double(n.mantissa) * double_powers_of_ten[n.exponent];
+	else {
+		value = convert_decimal_classic<double>(begin, p, n);
+		return p;
+	}
+	if (n.negative)
+		value = -value;
+	return p;
+}
+
+const char* parse_float(const char* begin, const char* end, float& value)
+{
+	decimal_number n;
+	const char* p = scan_decimal(begin, end, n);
+	if (p == begin)
+		return begin;
+	if (n.mantissa == 0 && !n.truncated)
+		value = 0.0f;
+	else if (!n.truncated && n.mantissa <= (1ull << 24) && n.exponent >= -10 && n.exponent <= 10)
+		value = n.exponent < 0 ? float(n.mantissa) / float_powers_of_ten[-n.exponent] : float(n.mantissa) * float_powers_of_ten[n.exponent];
+	else {
+		value = convert_decimal_classic<float>(begin, p, n);
+		return p;
+	}
+	if (n.negative)
+		value = -value;
+	return p;
+}
+
 bool is_double(const char* begin, const char* end, double& value)
 {
 	if (begin == end)
@@ -386,7 +543,8 @@ bool is_double(const char* begin, const char* end, double& value)
 	}
 	if (!found_digit)
 		return false;
-	value = atof(std::string(begin,end-begin).c_str());
+	if (parse_double(begin, end, value) == begin)
+		value = 0;
 	return true; 
 }
 
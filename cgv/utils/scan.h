@@ -62,6 +62,18 @@ extern CGV_API bool is_integer(const std::string& s, int& value);
 extern CGV_API bool is_double(const char* begin, const char* end, double& value);
 /// check if the passed string defines a double value. If yes, store the value in the passed reference.
 extern CGV_API bool is_double(const std::string& s, double& value);
+/** parse an optionally signed decimal integer at the beginning of the text range [begin,end( without
+    skipping white spaces. Returns the pointer after the last parsed character or begin if no integer
+	was found or the value does not fit into a long long. */
+extern CGV_API const char* parse_integer(const char* begin, const char* end, long long& value);
+/** parse a floating point number of the form [+-]digits[.digits][(e|E)[+-]digits] at the beginning of
+    the text range [begin,end( independent of the locale. Returns the pointer after the last parsed
+	character or begin if no number was found. The result is correctly rounded, where numbers whose
+	significant digits fit into 53 bits and with decimal exponents within [-22,22] are converted without a fallback
+	to the stream conversion of the classic locale. */
+extern CGV_API const char* parse_double(const char* begin, const char* end, double& value);
+/// same as parse_double for single precision, which is correctly rounded as well
+extern CGV_API const char* parse_float(const char* begin, const char* end, float& value);
 /// check and extract year from string token [\c begin, \c end]
 extern CGV_API bool is_year(const char* begin, const char* end, unsigned short& year, bool short_allowed = true);
 /// check and extract year from string \c s
@@ -11,6 +11,7 @@ void tokenizer::init()
 	begin_skip = "";
 	end_skip = "";
 	whitespaces = " \t\n";
+	special_chars_valid = false;
 }
 
 tokenizer::tokenizer()
@@ -38,6 +39,7 @@ tokenizer::tokenizer(const std::string& s) : token(s)
 tokenizer& tokenizer::set_ws(const std::string& ws)
 {
 	whitespaces = ws;
+	special_chars_valid = false;
 	return *this;
 }
 
@@ -45,6 +47,7 @@ tokenizer& tokenizer::set_skip(const std::string& open, const std::string& close
 {
 	begin_skip = open;
 	end_skip = close;
+	special_chars_valid = false;
 	return *this;
 }
 
@@ -53,6 +56,7 @@ tokenizer& tokenizer::set_skip(const std::string& open, const std::string& close
 	begin_skip = open;
 	end_skip = close;
 	escape_skip = escape;
+	special_chars_valid = false;
 	return *this;
 }
 
@@ -60,12 +64,14 @@ tokenizer& tokenizer::set_sep(const std::string& sep, bool merge)
 {
 	separators = sep;
 	merge_separators = merge;
+	special_chars_valid = false;
 	return *this;
 }
 
 tokenizer& tokenizer::set_sep(const std::string& sep)
 {
 	separators = sep;
+	special_chars_valid = false;
 	return *this;
 }
 
@@ -190,8 +196,19 @@ token tokenizer::bite()
 		begin = result.end;
 		return result;
 	}
+	if (!special_chars_valid) {
+		special_chars.clear();
+		special_chars.add(begin_skip);
+		special_chars.add(separators);
+		special_chars.add(whitespaces);
+		special_chars_valid = true;
+	}
 	// merge non separator characters
 	while (++result.end < end) {
+		// characters that are neither skip, separator nor white space characters are passed in blocks
+		result.end = special_chars.find_first(result.end, end);
+		if (result.end == end)
+			break;
 		// handle skip characters
 		const char* tmp_end = result.end;
 		if (handle_skip(result) && result.end == end)
@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "token.h"
+#include "char_set.h"
 
 #include "lib_begin.h"
 
@@ -73,6 +74,9 @@ protected:
 	std::string end_skip;
 	std::string escape_skip;
 	std::string whitespaces;
+	/// union of skip, separator and white space characters, which is rebuilt after changes of the character lists
+	char_set special_chars;
+	bool special_chars_valid;
 	void init();
 	bool handle_skip(token& result);
 	bool handle_separators(token& result,bool check_skip=true);
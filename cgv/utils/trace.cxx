@@ -0,0 +1,284 @@
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <cstdio>
+
+namespace cgv {
+	namespace utils {
+
+namespace trace_detail {
+	std::atomic<bool> enabled(false);
+}
+
+namespace {
+
+/// ring buffer of a thread, which is written only by its thread
+struct trace_buffer
+{
+	std::vector<trace_event> events;
+	cgv::type::uint64_type mask;
+	/// number of events written so far
+	std::atomic<cgv::type::uint64_type> head;
+	/// events with a smaller count have been discarded by clear_trace()
+	std::atomic<cgv::type::uint64_type> first;
+	std::string thread_name;
+	/// whether the thread has exited, such that the events can be released after they have been drained
+	bool exited;
+	trace_buffer(size_t capacity) : events(capacity), mask(capacity - 1), head(0), first(0), exited(false) {}
+	void push(const trace_event& e)
+	{
+		cgv::type::uint64_type h = head.load(std::memory_order_relaxed);
+		events[h & mask] = e;
+		head.store(h + 1, std::memory_order_release);
+	}
+	/// free the events of an exited thread, whose buffer entry is kept to preserve the thread indices
+	void release()
+	{
+		std::vector<trace_event>().swap(events);
+		first.store(head.load());
+	}
+};
+
+/// buffers of all threads that ever recorded events and interned names, which are never destructed such that threads can trace until the process ends; the events of exited threads are released once drained
+struct trace_registry
+{
+	std::mutex mutex;
+	std::vector<trace_buffer*> buffers;
+	size_t capacity;
+	std::deque<std::string> names;
+	std::map<std::string, unsigned> name_ids;
+	trace_registry() : capacity(65536) {}
+};
+
+trace_registry& ref_registry()
+{
+	static trace_registry* registry = new trace_registry();
+	return *registry;
+}
+
+trace_buffer* create_buffer()
+{
+	trace_registry& reg = ref_registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	trace_buffer* buffer = new trace_buffer(reg.capacity);
+	char name[32];
+	snprintf(name, sizeof(name), "thread %d", int(reg.buffers.size()));
+	buffer->thread_name = name;
+	reg.buffers.push_back(buffer);
+	return buffer;
+}
+
+/// set when the buffer owner of the calling thread has been destructed, which is trivially destructible and therefore still valid in later thread local destructors
+thread_local bool thread_exited = false;
+
+/// marks the buffer of a thread as exited when the thread ends
+struct thread_buffer_owner
+{
+	trace_buffer* buffer;
+	thread_buffer_owner() : buffer(0) {}
+	~thread_buffer_owner()
+	{
+		thread_exited = true;
+		if (!buffer)
+			return;
+		std::lock_guard<std::mutex> lock(ref_registry().mutex);
+		buffer->exited = true;
+	}
+};
+
+/// return the buffer of the calling thread or 0 if the thread is exiting
+trace_buffer* get_thread_buffer()
+{
+	if (thread_exited)
+		return 0;
+	static thread_local thread_buffer_owner owner;
+	if (!owner.buffer)
+		owner.buffer = create_buffer();
+	return owner.buffer;
+}
+
+void write_json_string(std::ostream& os, const std::string& s)
+{
+	os << '"';
+	for (size_t i = 0; i < s.size(); ++i) {
+		char c = s[i];
+		if (c == '"' || c == '\\')
+			os << '\\' << c;
+		else if ((unsigned char)c < 32) {
+			char code[8];
+			snprintf(code, sizeof(code), "\\u%04x", (unsigned)c);
+			os << code;
+		}
+		else
+			os << c;
+	}
+	os << '"';
+}
+
+}
+
+void enable_tracing(bool enable)
+{
+	trace_detail::enabled.store(enable);
+}
+
+void set_trace_buffer_capacity(size_t nr_events)
+{
+	size_t capacity = 1;
+	while (capacity < nr_events)
+		capacity *= 2;
+	trace_registry& reg = ref_registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	reg.capacity = capacity;
+}
+
+unsigned intern_trace_name(const std::string& name)
+{
+	trace_registry& reg = ref_registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	std::map<std::string, unsigned>::iterator iter = reg.name_ids.find(name);
+	if (iter != reg.name_ids.end())
+		return iter->second;
+	unsigned id = (unsigned)reg.names.size();
+	reg.names.push_back(name);
+	reg.name_ids[name] = id;
+	return id;
+}
+
+std::string get_trace_name(unsigned name_id)
+{
+	trace_registry& reg = ref_registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	return name_id < reg.names.size() ? reg.names[name_id] : std::string();
+}
+
+void set_trace_thread_name(const std::string& name)
+{
+	trace_buffer* buffer = get_thread_buffer();
+	if (!buffer)
+		return;
+	std::lock_guard<std::mutex> lock(ref_registry().mutex);
+	buffer->thread_name = name;
+}
+
+cgv::type::uint64_type get_trace_time()
+{
+	static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void record_trace_event(unsigned name_id, TracePhase phase, cgv::type::uint64_type time)
+{
+	trace_event e;
+	e.time = time;
+	e.name_id = name_id;
+	e.phase = phase;
+	trace_buffer* buffer = get_thread_buffer();
+	if (buffer)
+		buffer->push(e);
+}
+
+void collect_trace_events(std::vector<trace_record>& events, std::vector<std::string>* thread_names)
+{
+	trace_registry& reg = ref_registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	for (unsigned ti = 0; ti < reg.buffers.size(); ++ti) {
+		trace_buffer& buffer = *reg.buffers[ti];
+		if (thread_names)
+			thread_names->push_back(buffer.thread_name);
+		cgv::type::uint64_type capacity = buffer.mask + 1;
+		cgv::type::uint64_type end = buffer.head.load(std::memory_order_acquire);
+		cgv::type::uint64_type begin = std::max(buffer.first.load(), end > capacity ? end - capacity : 0);
+		size_t offset = events.size();
+		for (cgv::type::uint64_type i = begin; i < end; ++i) {
+			trace_record r;
+			static_cast<trace_event&>(r) = buffer.events[i & buffer.mask];
+			r.thread_index = ti;
+			events.push_back(r);
+		}
+		// discard events that the thread overwrote while they were copied, including the slot of event new_end that a running thread may be writing
+		cgv::type::uint64_type new_end = buffer.head.load(std::memory_order_acquire) + (buffer.exited ? 0 : 1);
+		if (new_end > begin + capacity) {
+			size_t nr_overwritten = size_t(std::min(new_end - capacity, end) - begin);
+			events.erase(events.begin() + offset, events.begin() + offset + nr_overwritten);
+		}
+		// the events of an exited thread are complete and have been drained
+		if (buffer.exited)
+			buffer.release();
+	}
+}
+
+void clear_trace()
+{
+	trace_registry& reg = ref_registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	for (unsigned ti = 0; ti < reg.buffers.size(); ++ti) {
+		if (reg.buffers[ti]->exited)
+			reg.buffers[ti]->release();
+		else
+			reg.buffers[ti]->first.store(reg.buffers[ti]->head.load());
+	}
+}
+
+void write_chrome_trace(std::ostream& os)
+{
+	std::vector<trace_record> events;
+	std::vector<std::string> thread_names;
+	collect_trace_events(events, &thread_names);
+	const char* phases = "BEi";
+	os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	bool first = true;
+	for (unsigned ti = 0; ti < thread_names.size(); ++ti) {
+		os << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ti << ",\"args\":{\"name\":";
+		write_json_string(os, thread_names[ti]);
+		os << "}}";
+		first = false;
+	}
+	std::vector<std::string> names;
+	unsigned depth = 0, thread_index = unsigned(-1);
+	char time[32];
+	for (size_t i = 0; i < events.size(); ++i) {
+		const trace_record& r = events[i];
+		if (r.thread_index != thread_index) {
+			thread_index = r.thread_index;
+			depth = 0;
+		}
+		// skip end events of scopes that began before the kept events
+		if (r.phase == TP_END) {
+			if (depth == 0)
+				continue;
+			--depth;
+		}
+		else if (r.phase == TP_BEGIN)
+			++depth;
+		if (r.name_id >= names.size()) {
+			for (unsigned ni = unsigned(names.size()); ni <= r.name_id; ++ni)
+				names.push_back(get_trace_name(ni));
+		}
+		snprintf(time, sizeof(time), "%.3f", r.time*1e-3);
+		os << (first ? "\n" : ",\n") << "{\"name\":";
+		write_json_string(os, names[r.name_id]);
+		os << ",\"ph\":\"" << phases[r.phase] << "\",\"ts\":" << time << ",\"pid\":1,\"tid\":" << r.thread_index;
+		if (r.phase == TP_INSTANT)
+			os << ",\"s\":\"t\"";
+		os << "}";
+		first = false;
+	}
+	os << "\n]}\n";
+}
+
+bool write_chrome_trace(const std::string& file_name)
+{
+	std::ofstream os(file_name.c_str());
+	if (os.fail())
+		return false;
+	write_chrome_trace(os);
+	return !os.fail();
+}
+
+	}
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <cgv/type/standard_types.h>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace utils {
+
+/** low overhead tracing of nested scopes over all threads of an application.
+
+    Each thread records its events into its own ring buffer without locking, such that the
+	most recent events of every thread are kept. Names are interned once per call site and
+	events only store a timestamp, the name id and the phase. The collected events can be
+	exported in the chrome trace event format, which is read by chrome://tracing and by
+	the perfetto ui (https://ui.perfetto.dev). Tracing is disabled at runtime by default
+	and compiled out completely if CGV_DISABLE_TRACING is defined.
+
+	Example:
+
+	void load_scene(const std::string& file_name)
+	{
+		CGV_TRACE_SCOPE("load_scene");
+		...
+	}
+	...
+	cgv::utils::enable_tracing();
+	load_scene("scene.obj");
+	cgv::utils::write_chrome_trace("scene.json");
+*/
+
+/// phase of a trace event
+enum TracePhase {
+	TP_BEGIN,
+	TP_END,
+	TP_INSTANT
+};
+
+/// event stored in the per thread ring buffers
+struct trace_event
+{
+	/// time in nano seconds as returned by get_trace_time()
+	cgv::type::uint64_type time;
+	/// id of the interned name
+	cgv::type::uint32_type name_id;
+	/// phase of the event
+	cgv::type::uint32_type phase;
+};
+
+/// event together with the index of the recording thread as returned by collect_trace_events()
+struct trace_record : public trace_event
+{
+	/// index of thread in the order of the first event recorded by the thread
+	unsigned thread_index;
+};
+
+namespace trace_detail {
+	/// runtime switch of tracing, use enable_tracing() and is_tracing_enabled()
+	extern CGV_API std::atomic<bool> enabled;
+}
+
+/// enable or disable recording of trace events
+extern CGV_API void enable_tracing(bool enable = true);
+/// return whether trace events are recorded
+inline bool is_tracing_enabled() { return trace_detail::enabled.load(std::memory_order_relaxed); }
+/// set the number of events kept per thread, which is rounded up to a power of two and applies to threads starting to trace afterwards, defaults to 65536
+extern CGV_API void set_trace_buffer_capacity(size_t nr_events);
+/// return the id of a name, where the same name always results in the same id
+extern CGV_API unsigned intern_trace_name(const std::string& name);
+/// return the name of an interned name id
+extern CGV_API std::string get_trace_name(unsigned name_id);
+/// name the calling thread in exported traces
+extern CGV_API void set_trace_thread_name(const std::string& name);
+/// return time in nano seconds since an arbitrary point in time before the first call
+extern CGV_API cgv::type::uint64_type get_trace_time();
+/// record an event of the calling thread with the given time stamp independent of whether tracing is enabled
+extern CGV_API void record_trace_event(unsigned name_id, TracePhase phase, cgv::type::uint64_type time);
+/// record an event of the calling thread with the current time if tracing is enabled
+inline void record_trace_event(unsigned name_id, TracePhase phase) {
+	if (is_tracing_enabled())
+		record_trace_event(name_id, phase, get_trace_time());
+}
+/// append the events kept in the buffers of all threads sorted by thread and time and optionally the names of the threads; the events of exited threads are appended once and then released
+extern CGV_API void collect_trace_events(std::vector<trace_record>& events, std::vector<std::string>* thread_names = 0);
+/// discard all recorded events and release the buffers of exited threads
+extern CGV_API void clear_trace();
+/// write kept events in the chrome trace event format, dropping end events whose begin event has been overwritten
+extern CGV_API void write_chrome_trace(std::ostream& os);
+/// write kept events in the chrome trace event format to a file and return whether this succeeded
+extern CGV_API bool write_chrome_trace(const std::string& file_name);
+
+/// records a begin event on construction and the matching end event on destruction if tracing is enabled
+class trace_scope
+{
+	unsigned name_id;
+	bool active;
+	/// no copy construction
+	trace_scope(const trace_scope&);
+	/// no assignment
+	trace_scope& operator = (const trace_scope&);
+public:
+	/// begin scope with interned name
+	trace_scope(unsigned _name_id) : name_id(_name_id), active(is_tracing_enabled()) {
+		if (active)
+			record_trace_event(name_id, TP_BEGIN, get_trace_time());
+	}
+	/// end scope
+	~trace_scope() {
+		if (active)
+			record_trace_event(name_id, TP_END, get_trace_time());
+	}
+};
+
+	}
+}
+
+#define CGV_TRACE_CONCAT_IMPL(A,B) A##B
+#define CGV_TRACE_CONCAT(A,B) CGV_TRACE_CONCAT_IMPL(A,B)
+
+#ifdef CGV_DISABLE_TRACING
+#define CGV_TRACE_SCOPE(NAME)
+#define CGV_TRACE_INSTANT(NAME)
+#else
+/// trace the remainder of the enclosing scope under the given name, which is interned once
+#define CGV_TRACE_SCOPE(NAME) \
+	static const unsigned CGV_TRACE_CONCAT(cgv_trace_id_,__LINE__) = cgv::utils::intern_trace_name(NAME); \
+	cgv::utils::trace_scope CGV_TRACE_CONCAT(cgv_trace_scope_,__LINE__)(CGV_TRACE_CONCAT(cgv_trace_id_,__LINE__))
+/// record an instant event with the given name
+#define CGV_TRACE_INSTANT(NAME) do { \
+	static const unsigned cgv_trace_id = cgv::utils::intern_trace_name(NAME); \
+	cgv::utils::record_trace_event(cgv_trace_id, cgv::utils::TP_INSTANT); } while (false)
+#endif
+
+#include <cgv/config/lib_end.h>
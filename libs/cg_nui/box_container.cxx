@@ -67,12 +67,15 @@ namespace cgv {
 			contact_info::contact C;
 			C.container = this;
 			C.node = get_parent();
-			for (const auto& c : center_positions) {
-				C.primitive_index = uint32_t(&c - &center_positions.front());
-				compute_closest_box_point(C, pos, c, scales[C.primitive_index], use_orientations ? &orientations[C.primitive_index] : 0);
-				if (info.consider_closest_contact(C))
+			float max_distance = info.get_closest_distance();
+			ref_bvh().traverse_closest(pos, max_distance, [&](uint32_t i) {
+				C.primitive_index = i;
+				compute_closest_box_point(C, pos, center_positions[i], scales[i], use_orientations ? &orientations[i] : 0);
+				if (info.consider_closest_contact(C)) {
+					max_distance = C.distance;
 					result = true;
-			}
+				}
+			});
 			return result;
 		}
 		bool box_container::compute_first_intersection(contact_info& info, const vec3& start, const vec3& direction)
@@ -81,16 +84,20 @@ namespace cgv {
 			contact_info::contact C;
 			C.container = this;
 			C.node = get_parent();
-			for (const auto& c : center_positions) {
-				C.primitive_index = uint32_t(&c - &center_positions.front());
-				const vec3& e = scales[C.primitive_index];
+			float max_t = info.get_closest_distance();
+			ref_bvh().traverse_ray(start, direction, max_t, [&](uint32_t i) {
+				C.primitive_index = i;
+				const vec3& c = center_positions[i];
+				const vec3& e = scales[i];
 				if ((use_orientations ? 
-					 compute_box_intersection(c, e, get_rotation(C.primitive_index), start, direction, C) :
+					 compute_box_intersection(c, e, get_rotation(i), start, direction, C) :
 					 compute_box_intersection(c, e, start, direction, C)) > 0) {
-					if (info.consider_closest_contact(C))
+					if (info.consider_closest_contact(C)) {
+						max_t = C.distance;
 						result = true;
+					}
 				}
-			}
+			});
 			return result;
 		}
 		int box_container::compute_all_intersections(contact_info& info, const vec3& start, const vec3& direction, bool only_entry_points)
@@ -99,22 +106,23 @@ namespace cgv {
 			contact_info::contact C1, C2;
 			C1.container = C2.container = this;
 			C1.node = C2.node = get_parent();
-			for (const auto& c : center_positions) {
-				C1.primitive_index = C2.primitive_index = uint32_t(&c - &center_positions.front());
-				const vec3& e = scales[C1.primitive_index];
-				contact_info::contact ci1, ci2;
+			float max_t = std::numeric_limits<float>::max();
+			ref_bvh().traverse_ray(start, direction, max_t, [&](uint32_t i) {
+				C1.primitive_index = C2.primitive_index = i;
+				const vec3& c = center_positions[i];
+				const vec3& e = scales[i];
 				int nr_intersections = use_orientations ?
-					compute_box_intersection(c, e, get_rotation(C1.primitive_index), start, direction, C1, &C2) :
+					compute_box_intersection(c, e, get_rotation(i), start, direction, C1, &C2) :
 					compute_box_intersection(c, e, start, direction, C1, &C2);
 				if (nr_intersections == 0)
-					continue;
+					return;
 				++result;
 				info.contacts.push_back(C1);
 				if (nr_intersections == 1)
-					continue;
+					return;
 				++result;
 				info.contacts.push_back(C2);
-			}
+			});
 			return result;
 		}
 
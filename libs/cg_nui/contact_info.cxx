@@ -111,6 +111,13 @@ nui_node* contact_info::contact::get_parent() const
 	return &(*(node->get_parent()->cast<nui_node>()));
 }
 
+float contact_info::get_closest_distance() const
+{
+	if (contacts.empty())
+		return std::numeric_limits<float>::max();
+	return contacts.front().distance;
+}
+
 bool contact_info::consider_closest_contact(const contact& C)
 {
 	if (contacts.empty())
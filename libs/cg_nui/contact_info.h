@@ -34,6 +34,8 @@ namespace cgv {
 				nui_node* get_parent() const;
 			};
 			bool contact_info::consider_closest_contact(const contact& C);
+			/// return distance of the closest contact or the maximum float value if there is no contact yet
+			float get_closest_distance() const;
 			std::vector<contact> contacts;
 		};
 
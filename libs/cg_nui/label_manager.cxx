@@ -18,6 +18,7 @@ label_manager::label_manager(cgv::media::font::font_face_ptr _font_face, float _
 	packing_outofdate = true;
 	texture_outofdate = true;
 	texture_content_outofdate = true;
+	repaint_all = true;
 	tex = std::make_shared<cgv::render::texture>("[R,G,B,A]");
 	rrs.culling_mode = cgv::render::CM_OFF;
 	rrs.illumination_mode = cgv::render::IM_OFF;
@@ -62,9 +63,10 @@ uint32_t label_manager::add_label(const std::string& _text,
 	compute_label_size(l);
 	labels.push_back(l);
 	label_states.push_back(LS_NEW_SIZE + LS_NEW_TEXT);
-	packing_outofdate = true;
 	texture_outofdate = true;
 	texture_content_outofdate = true;
+	if (!packing_outofdate)
+		place_label(uint32_t(labels.size() - 1));
 	return (uint32_t)(labels.size() - 1);
 }
 
@@ -102,35 +104,91 @@ void label_manager::fix_label_size(uint32_t li)
 	l.height = l.get_height();
 }
 
+label_manager::ivec2 label_manager::get_packing_extent(const label& l) const
+{
+	const int granularity = 8;
+	return ivec2(
+		(std::abs(l.width) + 2 * safety_extension + granularity - 1) / granularity * granularity,
+		(std::abs(l.height) + 2 * safety_extension + granularity - 1) / granularity * granularity);
+}
+
+void label_manager::update_tex_range(uint32_t i)
+{
+	const auto& R = packer.get_rectangle(packer_ids[i]);
+	tex_ranges[i] = ibox2(ivec2(R.x, R.y), ivec2(
+		R.x + std::abs(labels[i].width) + 2 * safety_extension,
+		R.y + std::abs(labels[i].height) + 2 * safety_extension));
+}
+
 void label_manager::pack_labels()
 {
-	std::vector<rect_pack::rectangle> rectangles;
 	std::vector<rect_pack::rectangle_size> rectangle_sizes;
 	rect_pack::rectangle_size S;
 	for (const auto& l : labels) {
-		S.width = std::abs(l.width) + 2*safety_extension;
-		S.height = std::abs(l.height) + 2*safety_extension;
+		ivec2 e = get_packing_extent(l);
+		S.width = e(0);
+		S.height = e(1);
 		rectangle_sizes.push_back(S);
 	}
 	unsigned width_out, height_out;
-	rect_pack::pack_rectangles_iteratively(rectangle_sizes,
-		width_out, height_out, rectangles, rect_pack::CS_LongerSideFirst, false, true, rect_pack::PS_Skyline);
-	//rect_pack::save_rectangles_html("c:/temp/rect.html", width_out, height_out, rectangles);
-	tex_width = width_out;
-	tex_height = height_out;
+	rect_pack::suggest_output_size(rectangle_sizes, width_out, height_out, true, 0.1f);
+	std::vector<unsigned> permutation;
+	rect_pack::compute_rectangle_permutation(rectangle_sizes, permutation, rect_pack::CS_LongerSideFirst);
+	packer.clear(width_out, height_out);
+	packer_ids.assign(labels.size(), -1);
+	for (unsigned i : permutation)
+		while ((packer_ids[i] = packer.insert(rectangle_sizes[i].width, rectangle_sizes[i].height)) == -1)
+			packer.grow(packer.get_width() <= packer.get_height() ? 2 * packer.get_width() : packer.get_width(),
+				packer.get_width() <= packer.get_height() ? packer.get_height() : 2 * packer.get_height());
+	tex_width = packer.get_width();
+	tex_height = packer.get_height();
+	// the online packer does not rotate labels
 	not_rotated_labels.clear();
 	rotated_labels.clear();
-	tex_ranges.clear();
-	for (const auto& R : rectangles) {
-		uint32_t i = uint32_t(tex_ranges.size());
-		if (std::abs(labels[i].width) + 2 * safety_extension != R.width)
-			rotated_labels.push_back(i);
-		else
-			not_rotated_labels.push_back(i);
-		tex_ranges.push_back(ibox2(ivec2(R.x, R.y), ivec2(R.x + R.width, R.y + R.height)));
+	tex_ranges.resize(labels.size());
+	for (uint32_t i = 0; i < labels.size(); ++i) {
+		not_rotated_labels.push_back(i);
+		update_tex_range(i);
 	}
 	packing_outofdate = false;
+	repaint_all = true;
+	texture_outofdate = true;
+}
+
+void label_manager::place_label(uint32_t i)
+{
+	ivec2 e = get_packing_extent(labels[i]);
+	bool success;
+	if (i >= packer_ids.size()) {
+		packer_ids.push_back(packer.insert(e(0), e(1)));
+		tex_ranges.push_back(ibox2());
+		not_rotated_labels.push_back(i);
+		success = packer_ids[i] != -1;
+	}
+	else {
+		const auto& R = packer.get_rectangle(packer_ids[i]);
+		success = (R.width == e(0) && R.height == e(1)) || packer.resize(packer_ids[i], e(0), e(1));
+	}
+	if (success)
+		update_tex_range(i);
+	else {
+		// make space by repacking the other labels and grow the atlas if this does not suffice
+		if (packer_ids[i] != -1)
+			packer.remove(packer_ids[i]);
+		packer.defragment();
+		while ((packer_ids[i] = packer.insert(e(0), e(1))) == -1)
+			packer.grow(packer.get_width() <= packer.get_height() ? 2 * packer.get_width() : packer.get_width(),
+				packer.get_width() <= packer.get_height() ? packer.get_height() : 2 * packer.get_height());
+		tex_width = packer.get_width();
+		tex_height = packer.get_height();
+		for (uint32_t j = 0; j < labels.size(); ++j)
+			update_tex_range(j);
+		repaint_all = true;
+	}
+	label_states[i] |= LS_NEW_TEXT;
+	texture_outofdate = true;
 }
+
 label_manager::vec4 label_manager::get_texcoord_range(uint32_t label_index)
 {
 	const auto& R = tex_ranges[label_index];
@@ -151,9 +209,10 @@ void label_manager::update_label_text(uint32_t i, const std::string& new_text)
 	label_states[i] |= LS_NEW_TEXT;
 	texture_outofdate = true;
 	if (labels[i].width < 0 || labels[i].height < 0) {
-		packing_outofdate = true;
 		label_states[i] |= LS_NEW_SIZE;
 		compute_label_size(labels[i]);
+		if (!packing_outofdate)
+			place_label(i);
 	}
 }
 
@@ -163,7 +222,9 @@ void label_manager::update_label_size(uint32_t i, int w, int h)
 	labels[i].height = h;
 	compute_label_size(labels[i]);
 	label_states[i] |= LS_NEW_SIZE;
-	packing_outofdate = true;
+	texture_outofdate = true;
+	if (!packing_outofdate)
+		place_label(i);
 }
 
 void label_manager::init(cgv::render::context& ctx)
@@ -256,6 +317,9 @@ void label_manager::draw_labels(cgv::render::context& ctx, bool all)
 		texture_content_outofdate = false;
 		return;
 	}
+	// a new atlas texture needs all labels
+	if (!tex->is_created() || tex->get_width() != tex_width || tex->get_height() != tex_height)
+		all = true;
 	cgv::media::font::font_face_ptr old_font_face = ctx.get_current_font_face();
 	float old_font_size = ctx.get_current_font_size();
 	GLboolean is_depth, is_scissor;
@@ -272,7 +336,7 @@ void label_manager::draw_labels(cgv::render::context& ctx, bool all)
 		tmp_fbo.enable(ctx, 0);
 		ctx.set_viewport(ivec4(0, 0, tex_height, tex_width));
 		ctx.push_pixel_coords();
-		if (created || texture_outofdate)
+		if (created || all)
 			glClear(GL_COLOR_BUFFER_BIT);
 		draw_label_backgrounds(ctx, rotated_labels, all, true);
 		draw_label_texts(ctx, rotated_labels, tex_width, all, true);
@@ -286,7 +350,7 @@ void label_manager::draw_labels(cgv::render::context& ctx, bool all)
 	ctx.set_viewport(ivec4(0, 0, tex_width, tex_height));
 	ctx.push_pixel_coords();
 	glClearColor(0.9f, 0.5f, 0.5f, 1);
-	if (created || texture_outofdate)
+	if (created || all)
 		glClear(GL_COLOR_BUFFER_BIT);
 	draw_label_backgrounds(ctx, not_rotated_labels, all, false);
 	draw_label_texts(ctx, not_rotated_labels, tex_height, all, false);
@@ -345,6 +409,9 @@ void label_manager::draw_labels(cgv::render::context& ctx, bool all)
 	if (is_depth)
 		glEnable(GL_DEPTH_TEST);
 
+	for (auto& s : label_states)
+		s = LS_CURRENT;
+	repaint_all = false;
 	texture_outofdate = false;
 	texture_content_outofdate = false;
 }
@@ -362,7 +429,7 @@ void label_manager::ensure_texture_uptodate(cgv::render::context& ctx)
 	if (packing_outofdate)
 		pack_labels();
 	if (texture_outofdate)
-		draw_labels(ctx, packing_outofdate);
+		draw_labels(ctx, repaint_all);
 }
 
 	}
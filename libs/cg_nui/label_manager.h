@@ -5,6 +5,7 @@
 #include <cgv_gl/rectangle_renderer.h>
 #include <cgv/render/texture.h>
 #include <cgv/render/frame_buffer.h>
+#include <rect_pack/online_packer.h>
 
 #include "lib_begin.h"
 
@@ -66,6 +67,18 @@ protected:
 	int safety_extension;
 	rgba text_color;
 	cgv::render::surface_render_style rrs;
+	/// online packer that places labels in the atlas without moving the other labels
+	rect_pack::online_packer packer;
+	/// per label the id of its rectangle in the packer
+	std::vector<int> packer_ids;
+	/// whether all labels need to be drawn because the atlas has been repacked or resized
+	bool repaint_all;
+	/// return extent of the atlas rectangle reserved for a label, which is rounded up such that small size changes keep the label in place
+	ivec2 get_packing_extent(const label& l) const;
+	/// place a label in the atlas after it has been added or resized and defragment or grow the atlas if necessary
+	void place_label(uint32_t i);
+	/// update texture range of a label from the packer
+	void update_tex_range(uint32_t i);
 	bool ensure_tex_fbo_combi(cgv::render::context& ctx, cgv::render::texture& tex, cgv::render::frame_buffer& fbo, int width, int height);
 	void draw_label_backgrounds(cgv::render::context& ctx, const std::vector<uint32_t>& indices, bool all, bool swap);
 	void draw_label_texts(cgv::render::context& ctx, const std::vector<uint32_t>& indices, int height, bool all, bool swap);
@@ -97,7 +110,9 @@ public:
 	void fix_label_size(uint32_t li);
 	/// return whether labels need to be packed
 	bool is_packing_outofdate() const { return packing_outofdate; }
-	/// pack the sized labels into a texture whose width and height in texels is automatically estimated
+	//! pack the sized labels into a texture whose width and height in texels is automatically estimated
+	/*! Afterwards, added labels and labels whose size changes are placed incrementally without moving
+	    the other labels and only these labels are drawn again in draw_labels(). */
 	void pack_labels();
 	//! for given label return where it is placed in the atlas texture
 	/*! the texture range is encoded as vec4(u_min, v_min, u_max, v_max) such that a reinterpret_cast
@@ -108,10 +123,10 @@ public:
 	/// return specific label
 	const label& get_label(uint32_t i) const { return labels[i]; }
 	//! update text of given label 
-	/*! if label is not a fixed label set packing out of date otherwise 
-	    only texture computation is set out of date */
+	/*! if label is not a fixed label, its size is recomputed and the label is placed again
+	    in the atlas, otherwise only texture computation is set out of date */
 	void update_label_text(uint32_t i, const std::string& new_text);
-	/// update label size, what always sets packing out of date
+	/// update label size, which places the label again in the atlas
 	void update_label_size(uint32_t i, int w, int h);
 	/// you can enforce texture recomputation in ensure_texture_uptodate() by calling this function (typically you do not need this function)
 	void set_texture_outofdate() { texture_outofdate = true; }
@@ -2,6 +2,7 @@
 #include <cgv/math/ftransform.h>
 #include "nui_node.h"
 #include "ray_axis_aligned_box_intersection.h"
+#include "primitive_bvh.h"
 
 namespace cgv {
 	namespace nui {
@@ -105,6 +106,20 @@ namespace cgv {
 			return B;
 		}
 
+		bool nui_node::child_box_may_contain_closer_point(uint32_t ci, const contact_info& info, const vec3& pos_local) const
+		{
+			float d = info.get_closest_distance();
+			if (d == std::numeric_limits<float>::max())
+				return true;
+			// distance of closest contact is given in parent coordinates and bounds local distance after division by smallest scale
+			switch (scaling_mode) {
+			case SM_NONE: break;
+			case SM_UNIFORM: d /= fabs(scale[0]); break;
+			case SM_NON_UNIFORM: d /= std::min(fabs(scale[0]), std::min(fabs(scale[1]), fabs(scale[2]))); break;
+			}
+			return primitive_bvh::sqr_distance(get_bounding_box(ci), pos_local) <= d * d;
+		}
+
 		void nui_node::correct_contact_info(contact_info::contact& C, const mat4& M, const mat4& inv_M, const vec3& pos)
 		{
 			
@@ -132,6 +147,8 @@ namespace cgv {
 			vec3 pos_local = reinterpret_cast<const vec3&>(inv_M * vec4(pos, 1.0f));
 			if (get_nr_children() > 0) {
 				for (uint32_t ci = 0; ci < get_nr_children(); ++ci) {
+					if (!child_box_may_contain_closer_point(ci, info, pos_local))
+						continue;
 					if (get_child(ci)->cast<nui_node>()->compute_closest_point(info, pos_local)) {
 						correct_contact_info(info.contacts.back(), M, inv_M, pos);
 						result = true;
@@ -165,6 +182,8 @@ namespace cgv {
 				normal_local.normalize();
 			if (get_nr_children() > 0) {
 				for (uint32_t ci = 0; ci < get_nr_children(); ++ci) {
+					if (!child_box_may_contain_closer_point(ci, info, pos_local))
+						continue;
 					if (get_child(ci)->cast<nui_node>()->compute_closest_oriented_point(info, pos_local, normal_local, orientation_weight)) {
 						correct_contact_info(info.contacts.back(), M, inv_M, pos);
 						result = true;
@@ -200,7 +219,10 @@ namespace cgv {
 			vec3 p, n;
 			if (get_nr_children() > 0) {
 				if (ray_axis_aligned_box_intersection(start_local, direction_local, box, t, p, n, 0.000001f)) {
+					vec3 inv_direction_local = primitive_bvh::compute_inverse_direction(direction_local);
 					for (uint32_t ci = 0; ci < get_nr_children(); ++ci) {
+						if (!primitive_bvh::intersect(get_bounding_box(ci), start_local, inv_direction_local, info.get_closest_distance(), t))
+							continue;
 						nui_node_ptr C = get_child(ci)->cast<nui_node>();
 						if (C->compute_first_intersection(info, start_local, direction_local)) {
 							correct_contact_info(info.contacts.front(), M, inv_M, start);
@@ -239,7 +261,10 @@ namespace cgv {
 			vec3 p, n;
 			if (get_nr_children() > 0) {
 				if (ray_axis_aligned_box_intersection(start_local, direction_local, box, t, p, n, 0.000001f)) {
+					vec3 inv_direction_local = primitive_bvh::compute_inverse_direction(direction_local);
 					for (uint32_t ci = 0; ci < get_nr_children(); ++ci) {
+						if (!primitive_bvh::intersect(get_bounding_box(ci), start_local, inv_direction_local, std::numeric_limits<float>::max(), t))
+							continue;
 						nui_node_ptr C = get_child(ci)->cast<nui_node>();
 						size_t count = info.contacts.size();
 						result += C->compute_all_intersections(info, start_local, direction_local, only_entry_points);
@@ -33,6 +33,8 @@ namespace cgv {
 			vec3 scale;
 			///
 			void correct_contact_info(contact_info::contact& C, const mat4& M, const mat4& inv_M, const vec3& pos);
+			/// check with the cached bounding box of the ci-th child whether it can contain a point closer to pos_local than the closest contact in info
+			bool child_box_may_contain_closer_point(uint32_t ci, const contact_info& info, const vec3& pos_local) const;
 		public:
 			nui_node(const std::string& _name, ScalingMode _scaling_mode = SM_NONE);
 			virtual ~nui_node();
@@ -2,6 +2,7 @@
 #include <cgv/math/ftransform.h>
 #include "nui_primitive_node.h"
 #include "ray_axis_aligned_box_intersection.h"
+#include "primitive_bvh.h"
 #include <random>
 
 namespace cgv {
@@ -145,6 +146,8 @@ namespace cgv {
 				}
 			}
 			for (uint32_t ci = 0; ci < get_nr_children(); ++ci) {
+				if (!child_box_may_contain_closer_point(ci, info, pos_local))
+					continue;
 				if (get_child(ci)->cast<nui_node>()->compute_closest_point(info, pos_local)) {
 					correct_contact_info(info.contacts.back(), M, inv_M, pos);
 					result = true;
@@ -172,6 +175,8 @@ namespace cgv {
 				}
 			}
 			for (uint32_t ci = 0; ci < get_nr_children(); ++ci) {
+				if (!child_box_may_contain_closer_point(ci, info, pos_local))
+					continue;
 				if (get_child(ci)->cast<nui_node>()->compute_closest_oriented_point(info, pos_local, normal_local, orientation_weight)) {
 					correct_contact_info(info.contacts.back(), M, inv_M, pos);
 					result = true;
@@ -201,7 +206,10 @@ namespace cgv {
 						result = true;
 					}
 				}
+				vec3 inv_direction_local = primitive_bvh::compute_inverse_direction(direction_local);
 				for (uint32_t ci = 0; ci < get_nr_children(); ++ci) {
+					if (!primitive_bvh::intersect(get_bounding_box(ci), start_local, inv_direction_local, info.get_closest_distance(), t))
+						continue;
 					if (get_child(ci)->cast<nui_node>()->compute_first_intersection(info, start_local, direction_local)) {
 						correct_contact_info(info.contacts.front(), M, inv_M, start);
 						result = true;
@@ -232,7 +240,10 @@ namespace cgv {
 					for (uint32_t i = count; i < info.contacts.size(); ++i)
 						correct_contact_info(info.contacts[i], M, inv_M, start);
 				}
+				vec3 inv_direction_local = primitive_bvh::compute_inverse_direction(direction_local);
 				for (uint32_t ci = 0; ci < get_nr_children(); ++ci) {
+					if (!primitive_bvh::intersect(get_bounding_box(ci), start_local, inv_direction_local, std::numeric_limits<float>::max(), t))
+						continue;
 					nui_node_ptr C = get_child(ci)->cast<nui_node>();
 					size_t count = info.contacts.size();
 					result += C->compute_all_intersections(info, start_local, direction_local, only_entry_points);
@@ -0,0 +1,202 @@
+#include "primitive_bvh.h"
+#include <algorithm>
+
+namespace cgv {
+	namespace nui {
+
+primitive_bvh::primitive_bvh()
+{
+}
+
+void primitive_bvh::clear()
+{
+	nodes.clear();
+	primitive_indices.clear();
+	primitive_leaves.clear();
+	primitive_boxes.clear();
+}
+
+void primitive_bvh::build(const std::vector<box3>& boxes)
+{
+	clear();
+	if (boxes.empty())
+		return;
+	uint32_t n = uint32_t(boxes.size());
+	primitive_boxes = boxes;
+	primitive_indices.resize(n);
+	primitive_leaves.resize(n);
+	std::vector<vec3> centers(n);
+	for (uint32_t i = 0; i < n; ++i) {
+		primitive_indices[i] = i;
+		centers[i] = boxes[i].get_center();
+	}
+	nodes.reserve(2 * (n / max_leaf_size + 1));
+	nodes.push_back(node());
+	nodes.back().parent = uint32_t(-1);
+	build_recursive(0, 0, n, centers, 0);
+}
+
+void primitive_bvh::build_recursive(uint32_t ni, uint32_t first, uint32_t count, const std::vector<vec3>& centers, uint32_t depth)
+{
+	box3 B, C;
+	for (uint32_t j = first; j < first + count; ++j) {
+		B.add_axis_aligned_box(primitive_boxes[primitive_indices[j]]);
+		C.add_point(centers[primitive_indices[j]]);
+	}
+	nodes[ni].box = B;
+	auto make_leaf = [&]() {
+		nodes[ni].first = first;
+		nodes[ni].count = count;
+		for (uint32_t j = first; j < first + count; ++j)
+			primitive_leaves[primitive_indices[j]] = ni;
+	};
+	if (count <= max_leaf_size) {
+		make_leaf();
+		return;
+	}
+	// select split axis as longest extent of the center box
+	vec3 e = C.get_extent();
+	int axis = e[0] > e[1] ? (e[0] > e[2] ? 0 : 2) : (e[1] > e[2] ? 1 : 2);
+	uint32_t mid = first + count / 2;
+	if (e[axis] <= 0.0f) {
+		// all centers coincide, so split in the middle of the range
+	}
+	else if (depth >= 40) {
+		std::nth_element(primitive_indices.begin() + first, primitive_indices.begin() + mid, primitive_indices.begin() + first + count,
+			[&](uint32_t i, uint32_t j) { return centers[i][axis] < centers[j][axis]; });
+	}
+	else {
+		// binned surface area heuristic
+		float lo = C.get_min_pnt()[axis];
+		float scale = nr_bins / e[axis];
+		box3 bin_boxes[nr_bins];
+		uint32_t bin_counts[nr_bins] = { 0 };
+		auto bin_of = [&](uint32_t i) { return std::min(nr_bins - 1, uint32_t((centers[i][axis] - lo) * scale)); };
+		for (uint32_t j = first; j < first + count; ++j) {
+			uint32_t b = bin_of(primitive_indices[j]);
+			++bin_counts[b];
+			bin_boxes[b].add_axis_aligned_box(primitive_boxes[primitive_indices[j]]);
+		}
+		auto area = [](const box3& b) {
+			if (!b.is_valid())
+				return 0.0f;
+			vec3 x = b.get_extent();
+			return x[0] * x[1] + x[1] * x[2] + x[2] * x[0];
+		};
+		// sweep from the right to accumulate areas and counts of the right sides
+		float right_area[nr_bins];
+		uint32_t right_count[nr_bins];
+		box3 acc;
+		uint32_t cnt = 0;
+		for (uint32_t b = nr_bins - 1; b > 0; --b) {
+			acc.add_axis_aligned_box(bin_boxes[b]);
+			cnt += bin_counts[b];
+			right_area[b] = area(acc);
+			right_count[b] = cnt;
+		}
+		float best_cost = std::numeric_limits<float>::max();
+		uint32_t best_split = 0;
+		acc.invalidate();
+		cnt = 0;
+		for (uint32_t b = 0; b + 1 < nr_bins; ++b) {
+			acc.add_axis_aligned_box(bin_boxes[b]);
+			cnt += bin_counts[b];
+			if (cnt == 0 || right_count[b + 1] == 0)
+				continue;
+			float cost = cnt * area(acc) + right_count[b + 1] * right_area[b + 1];
+			if (cost < best_cost) {
+				best_cost = cost;
+				best_split = b + 1;
+			}
+		}
+		// keep small nodes as leaves if splitting does not pay off
+		if (count <= 2 * max_leaf_size && best_cost >= count * area(B)) {
+			make_leaf();
+			return;
+		}
+		if (best_split == 0)
+			std::nth_element(primitive_indices.begin() + first, primitive_indices.begin() + mid, primitive_indices.begin() + first + count,
+				[&](uint32_t i, uint32_t j) { return centers[i][axis] < centers[j][axis]; });
+		else {
+			mid = uint32_t(std::partition(primitive_indices.begin() + first, primitive_indices.begin() + first + count,
+				[&](uint32_t i) { return bin_of(i) < best_split; }) - primitive_indices.begin());
+		}
+	}
+	uint32_t li = uint32_t(nodes.size());
+	nodes[ni].first = li;
+	nodes[ni].count = 0;
+	nodes.push_back(node());
+	nodes.push_back(node());
+	nodes[li].parent = nodes[li + 1].parent = ni;
+	build_recursive(li, first, mid - first, centers, depth + 1);
+	build_recursive(li + 1, mid, first + count - mid, centers, depth + 1);
+}
+
+primitive_bvh::box3 primitive_bvh::compute_node_box(uint32_t ni) const
+{
+	const node& N = nodes[ni];
+	box3 B;
+	if (N.is_leaf()) {
+		for (uint32_t j = N.first; j < N.first + N.count; ++j)
+			B.add_axis_aligned_box(primitive_boxes[primitive_indices[j]]);
+	}
+	else {
+		B = nodes[N.first].box;
+		B.add_axis_aligned_box(nodes[N.first + 1].box);
+	}
+	return B;
+}
+
+void primitive_bvh::update_primitive(uint32_t i, const box3& b)
+{
+	if (i >= primitive_boxes.size())
+		return;
+	primitive_boxes[i] = b;
+	// refit on path to the root and stop as soon as a box does not change anymore
+	uint32_t ni = primitive_leaves[i];
+	while (ni != uint32_t(-1)) {
+		box3 B = compute_node_box(ni);
+		if (B.get_min_pnt() == nodes[ni].box.get_min_pnt() && B.get_max_pnt() == nodes[ni].box.get_max_pnt())
+			break;
+		nodes[ni].box = B;
+		ni = nodes[ni].parent;
+	}
+}
+
+float primitive_bvh::sqr_distance(const box3& B, const vec3& p)
+{
+	float d2 = 0.0f;
+	for (int c = 0; c < 3; ++c) {
+		float d = std::max(std::max(B.get_min_pnt()[c] - p[c], p[c] - B.get_max_pnt()[c]), 0.0f);
+		d2 += d * d;
+	}
+	return d2;
+}
+
+primitive_bvh::vec3 primitive_bvh::compute_inverse_direction(const vec3& direction)
+{
+	vec3 inv_dir;
+	for (int c = 0; c < 3; ++c)
+		inv_dir[c] = direction[c] != 0.0f ? 1.0f / direction[c] : std::numeric_limits<float>::max();
+	return inv_dir;
+}
+
+bool primitive_bvh::intersect(const box3& B, const vec3& start, const vec3& inv_dir, float t_max, float& t_entry)
+{
+	float t0 = 0.0f, t1 = t_max;
+	for (int c = 0; c < 3; ++c) {
+		float ta = (B.get_min_pnt()[c] - start[c]) * inv_dir[c];
+		float tb = (B.get_max_pnt()[c] - start[c]) * inv_dir[c];
+		if (ta > tb)
+			std::swap(ta, tb);
+		t0 = std::max(t0, ta);
+		t1 = std::min(t1, tb);
+		if (t0 > t1)
+			return false;
+	}
+	t_entry = t0;
+	return true;
+}
+
+	}
+}
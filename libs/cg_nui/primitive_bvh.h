@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cgv/render/render_types.h>
+#include <vector>
+#include <limits>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace nui {
+
+		/** bounding volume hierarchy over the bounding boxes of the primitives of a container. The
+		    hierarchy is built with binned surface area heuristic and supports refitting after the box
+			of a single primitive changed. Queries use a stack based traversal and call back a visitor
+			with the index of each primitive that cannot be culled. */
+		class CGV_API primitive_bvh : public cgv::render::render_types
+		{
+		public:
+			/// node of the hierarchy; leaves store a range into the primitive index array, inner nodes the index of the left child, the right child follows in the node array
+			struct node
+			{
+				box3 box;
+				uint32_t parent;
+				uint32_t first;
+				uint32_t count;
+				bool is_leaf() const { return count > 0; }
+			};
+			/// maximum number of primitives per leaf
+			static const uint32_t max_leaf_size = 4;
+			/// number of bins used in the surface area heuristic
+			static const uint32_t nr_bins = 12;
+		protected:
+			std::vector<node> nodes;
+			/// permutation of primitive indices such that leaves reference contiguous ranges
+			std::vector<uint32_t> primitive_indices;
+			/// for each primitive the index of its leaf
+			std::vector<uint32_t> primitive_leaves;
+			/// copy of primitive boxes used for refitting
+			std::vector<box3> primitive_boxes;
+			/// recursive build of subtree over primitive_indices[first,first+count), beyond a depth of 40 median splits bound the traversal stack size
+			void build_recursive(uint32_t ni, uint32_t first, uint32_t count, const std::vector<vec3>& centers, uint32_t depth);
+			/// recompute box of node ni from its children or primitives
+			box3 compute_node_box(uint32_t ni) const;
+		public:
+			/// squared distance of point to box, zero inside
+			static float sqr_distance(const box3& B, const vec3& p);
+			/// return componentwise inverse of ray direction as needed by intersect(), where zero components are mapped to the maximum float
+			static vec3 compute_inverse_direction(const vec3& direction);
+			/// compute entry parameter of ray into box and return whether it is hit in the parameter interval [0,t_max]
+			static bool intersect(const box3& B, const vec3& start, const vec3& inv_dir, float t_max, float& t_entry);
+			/// construct empty hierarchy
+			primitive_bvh();
+			/// build hierarchy over given primitive boxes
+			void build(const std::vector<box3>& boxes);
+			/// remove all nodes
+			void clear();
+			/// return whether the hierarchy has been built
+			bool empty() const { return nodes.empty(); }
+			/// return number of primitives the hierarchy has been built for
+			uint32_t get_nr_primitives() const { return uint32_t(primitive_leaves.size()); }
+			/// return number of nodes
+			uint32_t get_nr_nodes() const { return uint32_t(nodes.size()); }
+			/// return bounding box of all primitives
+			const box3& get_box() const { return nodes.front().box; }
+			/// update box of primitive i and refit the boxes on the path to the root
+			void update_primitive(uint32_t i, const box3& b);
+			/// call visitor(i) for each primitive i whose box is closer to pos than max_distance, where visitor can decrease max_distance
+			template <typename F>
+			void traverse_closest(const vec3& pos, const float& max_distance, F visitor) const
+			{
+				if (nodes.empty())
+					return;
+				uint32_t stack[64];
+				uint32_t sp = 0;
+				stack[sp++] = 0;
+				while (sp > 0) {
+					const node& N = nodes[stack[--sp]];
+					float d2 = sqr_distance(N.box, pos);
+					if (d2 > max_distance * max_distance)
+						continue;
+					if (N.is_leaf()) {
+						for (uint32_t j = N.first; j < N.first + N.count; ++j)
+							visitor(primitive_indices[j]);
+						continue;
+					}
+					// push farther child first such that the closer one is processed first
+					uint32_t l = N.first, r = N.first + 1;
+					if (sqr_distance(nodes[l].box, pos) < sqr_distance(nodes[r].box, pos))
+						std::swap(l, r);
+					stack[sp++] = l;
+					stack[sp++] = r;
+				}
+			}
+			/// call visitor(i) for each primitive i whose box is hit by the ray before max_t, where visitor can decrease max_t
+			template <typename F>
+			void traverse_ray(const vec3& start, const vec3& direction, const float& max_t, F visitor) const
+			{
+				if (nodes.empty())
+					return;
+				vec3 inv_dir = compute_inverse_direction(direction);
+				uint32_t stack[64];
+				uint32_t sp = 0;
+				float t;
+				if (!intersect(nodes.front().box, start, inv_dir, max_t, t))
+					return;
+				stack[sp++] = 0;
+				while (sp > 0) {
+					const node& N = nodes[stack[--sp]];
+					if (N.is_leaf()) {
+						for (uint32_t j = N.first; j < N.first + N.count; ++j)
+							visitor(primitive_indices[j]);
+						continue;
+					}
+					float tl, tr;
+					bool hl = intersect(nodes[N.first].box, start, inv_dir, max_t, tl);
+					bool hr = intersect(nodes[N.first + 1].box, start, inv_dir, max_t, tr);
+					if (hl && hr) {
+						// push farther child first such that the closer one is processed first
+						if (tl < tr) {
+							stack[sp++] = N.first + 1;
+							stack[sp++] = N.first;
+						}
+						else {
+							stack[sp++] = N.first;
+							stack[sp++] = N.first + 1;
+						}
+					}
+					else if (hl)
+						stack[sp++] = N.first;
+					else if (hr)
+						stack[sp++] = N.first + 1;
+				}
+			}
+		};
+	}
+}
+
+#include <cgv/config/lib_end.h>
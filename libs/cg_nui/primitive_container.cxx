@@ -7,6 +7,7 @@ namespace cgv {
 primitive_container::primitive_container(nui_node* _parent, PrimitiveType _type, bool _use_colors, bool _use_orientations, ScalingMode _scaling_mode, InteractionCapabilities ic)
 	: parent(_parent), type(_type), use_colors(_use_colors), use_orientations(_use_orientations), nui_interactable(_scaling_mode, ic)
 {
+	bvh_outofdate = true;
 }
 
 nui_node* primitive_container::get_parent() const
@@ -30,6 +31,24 @@ primitive_container::box3 primitive_container::get_bounding_box(uint32_t i) cons
 	return B;
 }
 
+const primitive_bvh& primitive_container::ref_bvh() const
+{
+	if (bvh_outofdate || bvh.get_nr_primitives() != get_nr_primitives()) {
+		std::vector<box3> boxes(get_nr_primitives());
+		for (uint32_t i = 0; i < boxes.size(); ++i)
+			boxes[i] = get_bounding_box(i);
+		bvh.build(boxes);
+		bvh_outofdate = false;
+	}
+	return bvh;
+}
+
+void primitive_container::update_bvh(uint32_t i)
+{
+	if (!bvh_outofdate && bvh.get_nr_primitives() == get_nr_primitives())
+		bvh.update_primitive(i, get_bounding_box(i));
+}
+
 /// last parameter is weight for trading between position and normal distances for closest oriented point query; default implementation defers call to computer_closest_point
 bool primitive_container::compute_closest_oriented_point(contact_info& info, const vec3& pos, const vec3& normal, float orientation_weight)
 {
@@ -71,6 +90,7 @@ bool primitive_container::set_orientation(uint32_t i, const quat& q)
 	if (!use_orientations)
 		return false;
 	orientations[i] = q;
+	update_bvh(i);
 	return true;
 }
 primitive_container::vec3 primitive_container::get_position(uint32_t i) const
@@ -80,6 +100,7 @@ primitive_container::vec3 primitive_container::get_position(uint32_t i) const
 void primitive_container::set_position(uint32_t i, const vec3& p)
 {
 	center_positions[i] = p;
+	update_bvh(i);
 }
 
 float primitive_container::get_uniform_scale(uint32_t i) const
@@ -94,6 +115,7 @@ bool primitive_container::set_uniform_scale(uint32_t i, float u)
 	if (scaling_mode != SM_UNIFORM)
 		return false;
 	uniform_scales[i] = u;
+	update_bvh(i);
 	return true;
 }
 primitive_container::vec3 primitive_container::get_scale(uint32_t i) const
@@ -105,9 +127,10 @@ primitive_container::vec3 primitive_container::get_scale(uint32_t i) const
 
 bool primitive_container::set_scale(uint32_t i, const vec3& s)
 {
-	if (scaling_mode != SM_UNIFORM)
+	if (scaling_mode != SM_NON_UNIFORM)
 		return false;
 	scales[i] = s;
+	update_bvh(i);
 	return true;
 }
 
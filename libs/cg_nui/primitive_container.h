@@ -5,6 +5,7 @@
 #include "contact_info.h"
 #include "bounding_box_cache.h"
 #include "nui_interactable.h"
+#include "primitive_bvh.h"
 
 #include "lib_begin.h"
 
@@ -43,12 +44,20 @@ namespace cgv {
 			std::vector<vec3> scales;
 			///
 			nui_node* parent;
+			/// hierarchy over primitive bounding boxes used to accelerate closest point and ray queries
+			mutable primitive_bvh bvh;
+			/// whether the hierarchy needs to be rebuilt
+			mutable bool bvh_outofdate;
+			/// refit hierarchy after the bounding box of primitive i changed
+			void update_bvh(uint32_t i);
 			virtual void prepare_render(cgv::render::context& ctx, cgv::render::renderer& r, const cgv::render::render_style& rs, const std::vector<uint32_t>* indices_ptr = 0) const;
 			virtual bool render(cgv::render::context& ctx, cgv::render::renderer& r, const cgv::render::render_style& rs, const std::vector<uint32_t>* indices_ptr = 0) const;
 		public:
 			primitive_container(nui_node* _parent, PrimitiveType _type, bool _use_colors, bool _use_orientations, ScalingMode _scaling_mode, InteractionCapabilities ic = IC_ALL);
 			virtual ~primitive_container();
 			nui_node* get_parent() const;
+			/// return hierarchy after rebuilding it if it is out of date or the number of primitives changed
+			const primitive_bvh& ref_bvh() const;
 			/// return primitive type
 			virtual std::string get_primitive_type() const = 0;
 			uint32_t get_nr_primitives() const { return center_positions.size(); }
@@ -61,6 +70,8 @@ namespace cgv {
 			virtual bool compute_first_intersection(contact_info& info, const vec3& start, const vec3& direction) = 0;
 			virtual int compute_all_intersections(contact_info& info, const vec3& start, const vec3& direction, bool only_entry_points = true) = 0;
 			virtual const cgv::render::render_style* get_render_style() const = 0;
+			/// force rebuild of the hierarchy with the next query, needs to be called after changes that affect all primitive extents
+			void set_bvh_outofdate() { bvh_outofdate = true; }
 			/// access to primitive placements
 			bool has_orientations() const { return use_orientations; }
 			quat get_orientation(uint32_t i);
@@ -125,8 +125,10 @@ namespace cgv {
 			contact_info::contact C;
 			C.container = this;
 			C.node = get_parent();
-			for (const auto& c : center_positions) {
-				C.primitive_index = uint32_t(&c - &center_positions.front());
+			float max_distance = info.get_closest_distance();
+			ref_bvh().traverse_closest(pos, max_distance, [&](uint32_t i) {
+				const vec3& c = center_positions[i];
+				C.primitive_index = i;
 				vec3 h = 0.5f * scales[C.primitive_index];
 				vec3& p = C.position;
 				p = pos-c;
@@ -167,9 +169,11 @@ namespace cgv {
 					orientations[C.primitive_index].rotate(n);
 				}
 				p += c;
-				if (info.consider_closest_contact(C))
+				if (info.consider_closest_contact(C)) {
+					max_distance = C.distance;
 					result = true;
-			}
+				}
+			});
 			return result;
 		}
 		bool rectangle_container::compute_intersection(const vec3& rectangle_center, const vec2& rectangle_extent,
@@ -224,16 +228,20 @@ namespace cgv {
 			contact_info::contact C;
 			C.container = this;
 			C.node = get_parent();
-			for (const auto& c : center_positions) {
-				C.primitive_index = uint32_t(&c - &center_positions.front());
-				const vec2& e = reinterpret_cast<const vec2&>(scales[C.primitive_index]);
+			float max_t = info.get_closest_distance();
+			ref_bvh().traverse_ray(start, direction, max_t, [&](uint32_t i) {
+				C.primitive_index = i;
+				const vec3& c = center_positions[i];
+				const vec2& e = reinterpret_cast<const vec2&>(scales[i]);
 				if ((use_orientations ?
-					compute_intersection(c, e, get_rotation(C.primitive_index), start, direction, C) :
+					compute_intersection(c, e, get_rotation(i), start, direction, C) :
 					compute_intersection(c, e, start, direction, C))) {
-					if (info.consider_closest_contact(C))
+					if (info.consider_closest_contact(C)) {
+						max_t = C.distance;
 						result = true;
+					}
 				}
-			}
+			});
 			return result;
 		}
 
@@ -243,16 +251,18 @@ namespace cgv {
 			contact_info::contact C;
 			C.container = this;
 			C.node = get_parent();
-			for (const auto& c : center_positions) {
-				C.primitive_index = uint32_t(&c - &center_positions.front());
-				const vec2& e = reinterpret_cast<const vec2&>(scales[C.primitive_index]);
+			float max_t = std::numeric_limits<float>::max();
+			ref_bvh().traverse_ray(start, direction, max_t, [&](uint32_t i) {
+				C.primitive_index = i;
+				const vec3& c = center_positions[i];
+				const vec2& e = reinterpret_cast<const vec2&>(scales[i]);
 				if (use_orientations ?
-					compute_intersection(c, e, get_rotation(C.primitive_index), start, direction, C) :
+					compute_intersection(c, e, get_rotation(i), start, direction, C) :
 					compute_intersection(c, e, start, direction, C)) {
 					++result;
 					info.contacts.push_back(C);
 				}
-			}
+			});
 			return result;
 		}
 
@@ -73,15 +73,19 @@ bool sphere_container::compute_closest_point(contact_info& info, const vec3& pos
 	contact_info::contact C;
 	C.container = this;
 	C.node = get_parent();
-	for (const auto& c : center_positions) {
-		C.primitive_index = uint32_t(&c - &center_positions.front());
-		float r = get_radius(C.primitive_index);
+	float max_distance = info.get_closest_distance();
+	ref_bvh().traverse_closest(pos, max_distance, [&](uint32_t i) {
+		const vec3& c = center_positions[i];
+		C.primitive_index = i;
+		float r = get_radius(i);
 		C.normal = normalize(pos - c);
 		C.position = c + r*C.normal;
 		C.distance = (C.position - pos).length();
-		if (info.consider_closest_contact(C))
+		if (info.consider_closest_contact(C)) {
+			max_distance = C.distance;
 			result = true;
-	}
+		}
+	});
 	return result;
 }
 
@@ -127,14 +131,16 @@ bool sphere_container::compute_first_intersection(contact_info& info, const vec3
 	contact_info::contact C;
 	C.container = this;
 	C.node = get_parent();
-	for (const auto& c : center_positions) {
-		C.primitive_index = uint32_t(&c - &center_positions.front());
-		float r = get_radius(C.primitive_index);
-		if (compute_intersection(c, r, start, direction, C) > 0) {
-			if (info.consider_closest_contact(C))
+	float max_t = info.get_closest_distance();
+	ref_bvh().traverse_ray(start, direction, max_t, [&](uint32_t i) {
+		C.primitive_index = i;
+		if (compute_intersection(center_positions[i], get_radius(i), start, direction, C) > 0) {
+			if (info.consider_closest_contact(C)) {
+				max_t = C.distance;
 				result = true;
+			}
 		}
-	}
+	});
 	return result;
 }
 
@@ -144,19 +150,19 @@ int sphere_container::compute_all_intersections(contact_info& info, const vec3&
 	contact_info::contact C1, C2;
 	C1.container = C2.container = this;
 	C1.node = C2.node = get_parent();
-	for (const auto& c : center_positions) {
-		C1.primitive_index = C2.primitive_index = uint32_t(&c - &center_positions.front());
-		float r = get_radius(C1.primitive_index);
-		int nr_intersections = compute_intersection(c, r, start, direction, C1, &C2);
+	float max_t = std::numeric_limits<float>::max();
+	ref_bvh().traverse_ray(start, direction, max_t, [&](uint32_t i) {
+		C1.primitive_index = C2.primitive_index = i;
+		int nr_intersections = compute_intersection(center_positions[i], get_radius(i), start, direction, C1, &C2);
 		if (nr_intersections == 0)
-			continue;
+			return;
 		++result;
 		info.contacts.push_back(C1);
 		if (nr_intersections == 1 || only_entry_points)
-			continue;
+			return;
 		++result;
 		info.contacts.push_back(C2);
-	}
+	});
 	return result;
 }
 
@@ -34,9 +34,9 @@ namespace cgv {
 			uint32_t add_sphere(const vec3& center, const rgba& color, float radius);
 			box3 get_oriented_bounding_box(uint32_t i) const;
 			void add_strip(uint32_t start_index, uint32_t count);
-			void set_global_radius(float _radius) { srs.radius = _radius; }
+			void set_global_radius(float _radius) { srs.radius = _radius; set_bvh_outofdate(); }
 			float get_radius(uint32_t sphere_index) const { return (scaling_mode == SM_UNIFORM ? uniform_scales[sphere_index] : srs.radius) * srs.radius_scale; }
-			void set_radius_scale(float scale) { srs.radius_scale = scale; }
+			void set_radius_scale(float scale) { srs.radius_scale = scale; set_bvh_outofdate(); }
 			float get_radius_scale() const { return srs.radius_scale; }
 			bool compute_closest_point(contact_info& info, const vec3& pos);
 			//bool compute_closest_oriented_point(contact_info& info, const vec3& pos, const vec3& normal, float orientation_weight);
@@ -0,0 +1,83 @@
+#include "frustum_culler.h"
+#include <cgv/os/task_scheduler.h>
+#include <algorithm>
+
+namespace cgv {
+	namespace render {
+
+		frustum_culler::frustum_culler(size_t _chunk_size, unsigned _nr_threads) : chunk_size(_chunk_size), nr_threads(_nr_threads)
+		{
+			positions = 0;
+			radii = 0;
+			nr_elements = 0;
+			radius = 0.0f;
+			rebuild = true;
+			nr_visible = 0;
+		}
+
+		void frustum_culler::set_position_array(const vec3* _positions, size_t n, float _radius, const float* _radii)
+		{
+			if (_positions != positions || n != nr_elements || _radius != radius || _radii != radii)
+				rebuild = true;
+			positions = _positions;
+			nr_elements = n;
+			radius = _radius;
+			radii = _radii;
+		}
+
+		void frustum_culler::set_chunk_size(size_t _chunk_size)
+		{
+			if (_chunk_size != chunk_size)
+				rebuild = true;
+			chunk_size = _chunk_size;
+		}
+
+		void frustum_culler::invalidate(size_t start, size_t count)
+		{
+			if (!rebuild)
+				hierarchy.invalidate(start, count);
+		}
+
+		size_t frustum_culler::cull(const context& ctx)
+		{
+			return cull(mat4(ctx.get_projection_matrix()*ctx.get_modelview_matrix()));
+		}
+
+		size_t frustum_culler::cull(const mat4& modelview_projection)
+		{
+			// the hierarchy distributes its work with cgv::utils::parallel_tasks(), which cgv_os executes on the tasks of the process wide scheduler
+			unsigned n = cgv::os::get_nr_parallel_threads(nr_threads);
+			if (rebuild) {
+				hierarchy.build(positions, positions ? nr_elements : 0, radius, radii, chunk_size, 8, n);
+				rebuild = false;
+			}
+			else if (hierarchy.get_nr_dirty_chunks() > 0)
+				hierarchy.update(positions, radii, n);
+			nr_visible = hierarchy.cull(modelview_projection, visible_ranges, n);
+			return nr_visible;
+		}
+
+		size_t frustum_culler::draw(context& ctx, renderer& r, size_t start, size_t count) const
+		{
+			size_t end = count == size_t(-1) ? size_t(-1) : start + count;
+			size_t nr_draw_calls = 0;
+			for (size_t i = 0; i < visible_ranges.size(); ++i) {
+				size_t b = std::max(start, visible_ranges[i].start);
+				size_t e = std::min(end, visible_ranges[i].start + visible_ranges[i].count);
+				if (b >= e)
+					continue;
+				r.draw(ctx, b, e - b);
+				++nr_draw_calls;
+			}
+			return nr_draw_calls;
+		}
+
+		bool frustum_culler::render(context& ctx, renderer& r, size_t start, size_t count) const
+		{
+			if (!r.validate_and_enable(ctx))
+				return false;
+			draw(ctx, r, start, count);
+			return r.disable(ctx);
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cgv/render/context.h>
+#include <cgv/render/render_types.h>
+#include <cgv/math/chunk_box_hierarchy.h>
+#include "renderer.h"
+
+#include "gl/lib_begin.h"
+
+namespace cgv { // @<
+	namespace render { // @<
+
+		/** culls the elements of a position array against the view frustum of a context before they are drawn with a
+			renderer. A cgv::math::chunk_box_hierarchy over chunks of consecutive elements is built on the first call to
+			cull() and rebuilt only if the array pointer, the number of elements or the radius changes. Changes of the
+			positions themselves are reported with invalidate(), after which only the affected chunks are recomputed.
+			cull() tests the hierarchy against the frustum of the current modelview and projection matrices in parallel
+			tasks of the process wide scheduler of cgv/os/task_scheduler.h and stores the visible elements as sorted list
+			of ranges. These are consumed by draw() and render(), which
+			call renderer::draw() per range.
+			Culling is conservative and applies to non indexed drawing only. Group transformations of the renderer are
+			not taken into account. The positions need to stay valid until the last call to cull(). */
+		class CGV_API frustum_culler : public render_types
+		{
+		public:
+			/// type of the used hierarchy
+			typedef cgv::math::chunk_box_hierarchy<float> hierarchy_type;
+			/// range of visible elements
+			typedef hierarchy_type::index_range index_range;
+		protected:
+			/// bounding box hierarchy over chunks of elements
+			hierarchy_type hierarchy;
+			/// position array
+			const vec3* positions;
+			/// optional per element radii
+			const float* radii;
+			/// number of elements
+			size_t nr_elements;
+			/// radius added to all elements
+			float radius;
+			/// number of elements per chunk
+			size_t chunk_size;
+			/// number of threads used for culling, 0 selects cgv::os::get_nr_parallel_threads()
+			unsigned nr_threads;
+			/// whether hierarchy needs to be rebuilt in the next call to cull
+			bool rebuild;
+			/// result of last call to cull
+			std::vector<index_range> visible_ranges;
+			/// number of visible elements in last call to cull
+			size_t nr_visible;
+		public:
+			/// construct culler with the given number of elements per chunk and number of threads
+			frustum_culler(size_t _chunk_size = 256, unsigned _nr_threads = 0);
+			/// set n positions with a uniform radius and optional per element radii that are added to the uniform radius
+			void set_position_array(const vec3* _positions, size_t n, float _radius = 0.0f, const float* _radii = 0);
+			/// set positions from a vector
+			void set_position_array(const std::vector<vec3>& _positions, float _radius = 0.0f) { set_position_array(_positions.empty() ? 0 : &_positions.front(), _positions.size(), _radius); }
+			/// set the number of elements per chunk, which causes a rebuild in the next call to cull
+			void set_chunk_size(size_t _chunk_size);
+			/// return number of elements per chunk
+			size_t get_chunk_size() const { return chunk_size; }
+			/// set number of threads used for culling
+			void set_nr_threads(unsigned _nr_threads) { nr_threads = _nr_threads; }
+			/// report changed positions or radii in the given element range
+			void invalidate(size_t start = 0, size_t count = size_t(-1));
+			/// update hierarchy and cull against the view frustum of the modelview and projection matrices of the context, return number of visible elements
+			size_t cull(const context& ctx);
+			/// update hierarchy and cull against the view frustum of the combined projection and modelview matrix, return number of visible elements
+			size_t cull(const mat4& modelview_projection);
+			/// return visible ranges of last call to cull
+			const std::vector<index_range>& get_visible_ranges() const { return visible_ranges; }
+			/// return number of visible elements of last call to cull
+			size_t get_nr_visible() const { return nr_visible; }
+			/// return number of elements
+			size_t get_nr_elements() const { return nr_elements; }
+			/// return hierarchy
+			const hierarchy_type& get_hierarchy() const { return hierarchy; }
+			/// call renderer::draw() of an enabled renderer for the visible elements in [start,start+count) and return number of draw calls
+			size_t draw(context& ctx, renderer& r, size_t start = 0, size_t count = size_t(-1)) const;
+			/// validate and enable renderer, draw the visible elements in [start,start+count) and disable the renderer; returns false if renderer could not be enabled
+			bool render(context& ctx, renderer& r, size_t start = 0, size_t count = size_t(-1)) const;
+		};
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -350,7 +350,7 @@ void gl_context::init_render_pass()
 	group* grp = dynamic_cast<group*>(this);
 	if (grp && (get_render_pass_flags()&RPF_DRAWABLES_INIT_FRAME)) {
 		single_method_action<drawable,void,cgv::render::context&> sma(*this, &drawable::init_frame, true, true);
-		traverser(sma).traverse(group_ptr(grp));
+		traverser(sma).traverse(group_ptr(grp), drawable_traverse_callback_handler);
 	}
 
 	if (check_gl_error("gl_context::init_render_pass after init_frame"))
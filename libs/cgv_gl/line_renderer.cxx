@@ -33,7 +33,8 @@ namespace cgv {
 		bool line_renderer::enable(context& ctx)
 		{
 			const line_render_style& lrs = get_style<line_render_style>();
-			glLineWidth(lrs.line_width);
+			if (is_gl_context(ctx))
+				glLineWidth(lrs.line_width);
 			if (!group_renderer::enable(ctx))
 				return false;
 			ctx.set_color(lrs.line_color);
@@ -115,10 +115,12 @@ namespace cgv {
 			else
 				res = group_renderer::enable(ctx);
 
-			glPointSize(prs.point_size);
-			if (prs.blend_points) {
-				glEnable(GL_BLEND);
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			if (is_gl_context(ctx)) {
+				glPointSize(prs.point_size);
+				if (prs.blend_points) {
+					glEnable(GL_BLEND);
+					glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				}
 			}
 			if (ref_prog().is_linked()) {
 				if (!has_point_sizes)
@@ -141,7 +143,7 @@ namespace cgv {
 		bool point_renderer::disable(cgv::render::context& ctx)
 		{
 			const point_render_style& prs = get_style<point_render_style>();
-			if (prs.blend_points) {
+			if (prs.blend_points && is_gl_context(ctx)) {
 				glDisable(GL_BLEND);
 			}
 			if (!attributes_persist()) {
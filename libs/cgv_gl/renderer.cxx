@@ -1,5 +1,6 @@
 #include "renderer.h"
 #include "gl/gl_tools.h"
+#include <cgv/render/null_context.h>
 
 namespace cgv {
 	namespace render {
@@ -205,8 +206,17 @@ namespace cgv {
 			}
 			return ref_prog().disable(ctx) && res;
 		}
+		void renderer::skip_draw_call(const context& ctx, size_t nr_vertices)
+		{
+			if (ctx.get_render_api() == RA_NULL)
+				static_cast<const null_context&>(ctx).record_draw_call(nr_vertices);
+		}
 		void renderer::draw_impl(context& ctx, PrimitiveType type, size_t start, size_t count, bool use_strips, bool use_adjacency, uint32_t strip_restart_index)
 		{
+			if (!is_gl_context(ctx)) {
+				skip_draw_call(ctx, count);
+				return;
+			}
 			if (use_strips && has_indices()) {
 				glPrimitiveRestartIndex(strip_restart_index);
 				glEnable(GL_PRIMITIVE_RESTART);
@@ -229,6 +239,10 @@ namespace cgv {
 		}
 		void renderer::draw_impl_instanced(context& ctx, PrimitiveType type, size_t start, size_t count, size_t instance_count, bool use_strips, bool use_adjacency, uint32_t strip_restart_index)
 		{
+			if (!is_gl_context(ctx)) {
+				skip_draw_call(ctx, count*instance_count);
+				return;
+			}
 			if (use_strips && has_indices()) {
 				glPrimitiveRestartIndex(strip_restart_index);
 				glEnable(GL_PRIMITIVE_RESTART);
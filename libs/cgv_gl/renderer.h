@@ -240,6 +240,10 @@ namespace cgv { // @<
 				enabled_attribute_arrays.insert(loc);
 				return attribute_array_binding::set_global_attribute_array(ctx, loc, &elem, nr_elements, sizeof(C));
 			}
+			/// return whether GL commands can be issued, which is not the case for a null_context
+			static bool is_gl_context(const context& ctx) { return ctx.get_render_api() == RA_OPENGL; }
+			/// skip a draw call of nr_vertices vertices in a context without GL and record it in a null_context
+			static void skip_draw_call(const context& ctx, size_t nr_vertices);
 			/// default implementation of draw method with support for indexed rendering and different primitive types
 			void draw_impl(context& ctx, PrimitiveType pt, size_t start, size_t count, bool use_strips, bool use_adjacency, uint32_t strip_restart_index);
 			/// default implementation of instanced draw method with support for indexed rendering and different primitive types
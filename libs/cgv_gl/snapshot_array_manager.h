@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cgv/render/context.h>
+#include <cgv/render/render_snapshot.h>
+#include "renderer.h"
+
+#include "gl/lib_begin.h"
+
+namespace cgv { // @<
+	namespace render { // @<
+
+		/** attribute array manager that keeps the attribute arrays of the front snapshot of a snapshot_buffer on the
+			gpu and uploads them only when the render side consumed a new snapshot. In draw() call attach(), set the
+			arrays of the front snapshot on the renderer only if attach() returned true, render and call detach():
+
+			    if (sam.attach(ctx, pr, snapshots)) {
+			        pr.set_position_array(ctx, snapshots.ref_front().P);
+			        pr.set_color_array(ctx, snapshots.ref_front().C);
+			    }
+			    pr.render(ctx, 0, snapshots.ref_front().P.size());
+			    sam.detach(ctx, pr);
+
+			As a renderer is shared by all drawables of a context, the manager needs to be detached before other
+			drawables use the renderer. Call destruct() in the clear() method of the drawable. */
+		class CGV_API snapshot_array_manager : public attribute_array_manager
+		{
+		protected:
+			/// snapshot version of the uploaded arrays
+			snapshot_upload_tracker tracker;
+		public:
+			/// attach the manager to the renderer and return whether the arrays of the front snapshot need to be set
+			template <typename T>
+			bool attach(context& ctx, renderer& r, const snapshot_buffer<T>& sb)
+			{
+				if (!aab.is_created()) {
+					init(ctx);
+					tracker.invalidate();
+				}
+				r.set_attribute_array_manager(ctx, this);
+				if (!tracker.needs_upload(sb))
+					return false;
+				tracker.set_uploaded(sb);
+				return true;
+			}
+			/// detach the manager from the renderer, such that it uses its own attribute arrays again
+			void detach(const context& ctx, renderer& r) { r.set_attribute_array_manager(ctx, 0); }
+			/// force an upload of the arrays in the next call to attach()
+			void invalidate() { tracker.invalidate(); }
+			/// destruct the vertex buffers and the attribute array binding
+			void destruct(const context& ctx) { attribute_array_manager::destruct(ctx); tracker.invalidate(); }
+		};
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -87,7 +87,7 @@ namespace cgv {
 		{
 			bool res = group_renderer::enable(ctx);
 			const surface_render_style& srs = get_style<surface_render_style>();
-			if (cull_per_primitive) {
+			if (cull_per_primitive && is_gl_context(ctx)) {
 				if (srs.culling_mode == CM_OFF) {
 					glDisable(GL_CULL_FACE);
 				}
@@ -111,7 +111,7 @@ namespace cgv {
 		bool surface_renderer::disable(context& ctx)
 		{
 			const surface_render_style& srs = get_style<surface_render_style>();
-			if (cull_per_primitive) {
+			if (cull_per_primitive && is_gl_context(ctx)) {
 				if (srs.culling_mode != CM_OFF)
 					glDisable(GL_CULL_FACE);
 			}
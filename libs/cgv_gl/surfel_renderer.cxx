@@ -114,10 +114,12 @@ namespace cgv {
 			else
 				res = surface_renderer::enable(ctx);
 
-			glPointSize(srs.point_size);
-			if (srs.blend_points) {
-				glEnable(GL_BLEND);
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			if (is_gl_context(ctx)) {
+				glPointSize(srs.point_size);
+				if (srs.blend_points) {
+					glEnable(GL_BLEND);
+					glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				}
 			}
 			if (ref_prog().is_linked()) {
 				if (!has_point_sizes)
@@ -141,11 +143,13 @@ namespace cgv {
 		bool surfel_renderer::disable(cgv::render::context& ctx)
 		{
 			const surfel_render_style& srs = get_style<surfel_render_style>();
-			if (srs.blend_points) {
-				glDisable(GL_BLEND);
-			}
-			if (srs.culling_mode != CM_OFF) {
-				glDisable(GL_CULL_FACE);
+			if (is_gl_context(ctx)) {
+				if (srs.blend_points) {
+					glDisable(GL_BLEND);
+				}
+				if (srs.culling_mode != CM_OFF) {
+					glDisable(GL_CULL_FACE);
+				}
 			}
 			if (!attributes_persist()) {
 				has_indexed_colors = false;
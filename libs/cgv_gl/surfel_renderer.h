@@ -66,6 +66,8 @@ namespace cgv {
 			bool init(context& ctx);
 			///
 			void set_reference_point_size(float _reference_point_size);
+			/// return reference point size
+			float get_reference_point_size() const { return reference_point_size; }
 			///
 			void set_y_view_angle(float y_view_angle);
 			///
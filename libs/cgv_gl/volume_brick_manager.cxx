@@ -0,0 +1,131 @@
+#include "volume_brick_manager.h"
+#include <cstring>
+
+namespace cgv {
+	namespace render {
+
+		volume_brick_manager::volume_brick_manager() : volume_tex("uint8[L]"), occupancy_tex("uint8[L]", TF_NEAREST, TF_NEAREST)
+		{
+			next_brick = 0;
+			occupancy_outofdate = false;
+		}
+
+		bool volume_brick_manager::build(const cgv::data::const_data_view& dv, unsigned brick_size, unsigned nr_threads)
+		{
+			if (!hierarchy.build(dv, brick_size, 0, nr_threads))
+				return false;
+			volume_data = dv;
+			size_t n = hierarchy.get_level(0).get_nr_bricks();
+			occupancy.assign(n, 0);
+			resident.assign(n, 0);
+			occupancy_texels.assign(n, 0);
+			next_brick = n;
+			occupancy_outofdate = true;
+			return true;
+		}
+
+		size_t volume_brick_manager::classify(const std::vector<float>& opacity, float value_min, float value_max, float opacity_threshold)
+		{
+			if (hierarchy.get_nr_levels() == 0)
+				return 0;
+			size_t nr_occupied = hierarchy.compute_occupancy(opacity, value_min, value_max, occupancy, 0, opacity_threshold);
+			for (size_t bi = 0; bi < occupancy.size(); ++bi)
+				occupancy_texels[bi] = occupancy[bi] && resident[bi] ? 255 : 0;
+			// newly occupied bricks are found in the next stream calls
+			next_brick = 0;
+			occupancy_outofdate = true;
+			return nr_occupied;
+		}
+
+		size_t volume_brick_manager::classify_linear_opacity(float alpha_coeff, float value_min, float value_max, float opacity_threshold)
+		{
+			std::vector<float> opacity(256);
+			for (size_t i = 0; i < opacity.size(); ++i)
+				opacity[i] = alpha_coeff*float(i) / float(opacity.size() - 1);
+			return classify(opacity, value_min, value_max, opacity_threshold);
+		}
+
+		size_t volume_brick_manager::upload_brick(const context& ctx, size_t bi)
+		{
+			const cgv::math::min_max_brick_hierarchy<float>::level& l = hierarchy.get_level(0);
+			unsigned b[3] = { unsigned(bi % l.dims[0]), unsigned((bi / l.dims[0]) % l.dims[1]), unsigned(bi / (size_t(l.dims[0])*l.dims[1])) };
+			// extend brick by the apron used for its value range, such that interpolation at its border reads valid data
+			unsigned begin[3], end[3];
+			for (unsigned i = 0; i < 3; ++i) {
+				begin[i] = b[i] * get_brick_size() == 0 ? 0 : b[i] * get_brick_size() - 1;
+				end[i] = std::min(hierarchy.get_volume_dim(i), (b[i] + 1)*get_brick_size() + 1);
+			}
+			cgv::data::data_format brick_format(*volume_data.get_format());
+			brick_format.set_width(end[0] - begin[0]);
+			brick_format.set_height(end[1] - begin[1]);
+			brick_format.set_depth(end[2] - begin[2]);
+			staging_buffer.resize(brick_format.get_nr_bytes());
+			cgv::data::data_view brick_view(&brick_format, &staging_buffer[0]);
+			// copy rows of the brick into the staging buffer
+			const unsigned sx = volume_data.get_step_size(2), sy = volume_data.get_step_size(1), sz = volume_data.get_step_size(0);
+			const unsigned dy = brick_view.get_step_size(1), dz = brick_view.get_step_size(0);
+			const unsigned char* src = volume_data.get_ptr<unsigned char>();
+			unsigned char* dst = brick_view.get_ptr<unsigned char>();
+			size_t row_size = size_t(end[0] - begin[0])*sx;
+			for (unsigned z = begin[2]; z < end[2]; ++z)
+				for (unsigned y = begin[1]; y < end[1]; ++y)
+					std::memcpy(dst + size_t(z - begin[2])*dz + size_t(y - begin[1])*dy,
+						src + size_t(z)*sz + size_t(y)*sy + size_t(begin[0])*sx, row_size);
+			if (!volume_tex.replace(ctx, begin[0], begin[1], begin[2], brick_view, 0))
+				return 0;
+			return staging_buffer.size();
+		}
+
+		bool volume_brick_manager::stream(const context& ctx, size_t max_nr_bytes)
+		{
+			if (hierarchy.get_nr_levels() == 0)
+				return false;
+			const cgv::math::min_max_brick_hierarchy<float>::level& l = hierarchy.get_level(0);
+			// a rebuild with a different resolution requires new textures
+			if (volume_tex.is_created() && (volume_tex.get_width() != hierarchy.get_volume_dim(0) ||
+				volume_tex.get_height() != hierarchy.get_volume_dim(1) || volume_tex.get_depth() != hierarchy.get_volume_dim(2))) {
+				volume_tex.destruct(ctx);
+				occupancy_tex.destruct(ctx);
+			}
+			if (!volume_tex.is_created()) {
+				volume_tex.set_component_format(*volume_data.get_format());
+				if (!volume_tex.create(ctx, TT_3D, hierarchy.get_volume_dim(0), hierarchy.get_volume_dim(1), hierarchy.get_volume_dim(2)))
+					return false;
+			}
+			if (!occupancy_tex.is_created()) {
+				if (!occupancy_tex.create(ctx, TT_3D, l.dims[0], l.dims[1], l.dims[2]))
+					return false;
+				occupancy_outofdate = true;
+			}
+			size_t nr_bytes = 0;
+			for (; next_brick < occupancy.size() && nr_bytes < max_nr_bytes; ++next_brick) {
+				if (!occupancy[next_brick] || resident[next_brick])
+					continue;
+				size_t brick_bytes = upload_brick(ctx, next_brick);
+				if (brick_bytes == 0)
+					return false;
+				nr_bytes += brick_bytes;
+				resident[next_brick] = 1;
+				occupancy_texels[next_brick] = 255;
+				occupancy_outofdate = true;
+			}
+			if (occupancy_outofdate) {
+				cgv::data::data_format occupancy_format(l.dims[0], l.dims[1], l.dims[2], cgv::type::info::TI_UINT8, cgv::data::CF_L);
+				cgv::data::const_data_view occupancy_view(&occupancy_format, &occupancy_texels[0]);
+				if (!occupancy_tex.replace(ctx, 0, 0, 0, occupancy_view, 0))
+					return false;
+				occupancy_outofdate = false;
+			}
+			return is_complete();
+		}
+
+		void volume_brick_manager::destruct(const context& ctx)
+		{
+			volume_tex.destruct(ctx);
+			occupancy_tex.destruct(ctx);
+			std::fill(resident.begin(), resident.end(), (unsigned char)0);
+			std::fill(occupancy_texels.begin(), occupancy_texels.end(), (unsigned char)0);
+			next_brick = 0;
+		}
+	}
+}
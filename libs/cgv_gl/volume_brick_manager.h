@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cgv/render/context.h>
+#include <cgv/render/texture.h>
+#include <cgv/data/data_view.h>
+#include <cgv/math/min_max_brick_hierarchy.h>
+
+#include "gl/lib_begin.h"
+
+namespace cgv { // @<
+	namespace render { // @<
+
+		/** manages the textures needed to render a large sparse volume with empty space skipping in the volume_renderer.
+			The value ranges of the bricks are computed on the CPU with a min_max_brick_hierarchy and classified against
+			the opacity that the volume_renderer assigns to the values. Only occupied bricks are uploaded to the volume
+			texture, where stream() uploads a limited number of bytes per call such that large volumes can be streamed over
+			several frames. The volume texture is still allocated at the full resolution of the volume, such that empty
+			bricks save upload time and ray marching steps but no GPU memory. The occupancy texture holds one texel per
+			brick and marks bricks that are occupied and already uploaded. Pass the textures to
+			volume_renderer::set_volume_texture() and volume_renderer::set_occupancy_texture(). */
+		class CGV_API volume_brick_manager
+		{
+		protected:
+			/// value ranges of the bricks
+			cgv::math::min_max_brick_hierarchy<float> hierarchy;
+			/// view of the volume data, which needs to stay valid until all bricks are uploaded
+			cgv::data::const_data_view volume_data;
+			/// per brick whether it is occupied according to the last classification
+			std::vector<unsigned char> occupancy;
+			/// per brick whether it has been uploaded to the volume texture
+			std::vector<unsigned char> resident;
+			/// texels of the occupancy texture
+			std::vector<unsigned char> occupancy_texels;
+			/// index of the next brick that is checked for upload
+			size_t next_brick;
+			/// whether occupancy texels changed since the last upload
+			bool occupancy_outofdate;
+			/// buffer that holds one brick with its apron during upload
+			std::vector<unsigned char> staging_buffer;
+			/// volume texture with the uploaded bricks
+			texture volume_tex;
+			/// texture with one texel per brick
+			texture occupancy_tex;
+			/// upload brick with index bi including its apron and return number of uploaded bytes
+			size_t upload_brick(const context& ctx, size_t bi);
+		public:
+			/// construct empty manager
+			volume_brick_manager();
+			/** build the brick hierarchy of a 3d data view in parallel and mark all bricks as not uploaded. Only the
+				view is stored, such that the data needs to stay valid until stream() returns true. */
+			bool build(const cgv::data::const_data_view& dv, unsigned brick_size = 16, unsigned nr_threads = 0);
+			/** classify bricks with an opacity table that samples the values [value_min,value_max] of the data view and
+				return the number of occupied bricks, see min_max_brick_hierarchy::compute_occupancy(). The table needs to
+				match the opacity applied by the shader that renders the volume. */
+			size_t classify(const std::vector<float>& opacity, float value_min, float value_max, float opacity_threshold = 0.0f);
+			/** classify bricks with the opacity model of the volume_renderer, which gives a sample with the texture value v
+				in [0,1] the opacity v*alpha_coeff with alpha_coeff = volume_render_style::alpha and ignores the alpha
+				channel of the transfer function. value_min and value_max are the data values that map to the texture values
+				0 and 1, which are 0 and 255 for uint8 volumes. */
+			size_t classify_linear_opacity(float alpha_coeff, float value_min, float value_max, float opacity_threshold = 0.0f);
+			/// create textures if necessary and upload occupied bricks with up to about max_nr_bytes; returns whether all occupied bricks are uploaded
+			bool stream(const context& ctx, size_t max_nr_bytes = 16777216);
+			/// return whether all occupied bricks have been uploaded
+			bool is_complete() const { return next_brick >= occupancy.size(); }
+			/// return the brick hierarchy
+			const cgv::math::min_max_brick_hierarchy<float>& get_hierarchy() const { return hierarchy; }
+			/// return edge length of bricks in voxels
+			unsigned get_brick_size() const { return hierarchy.get_brick_size(); }
+			/// return reference to volume texture
+			texture& ref_volume_texture() { return volume_tex; }
+			/// return reference to occupancy texture
+			texture& ref_occupancy_texture() { return occupancy_tex; }
+			/// destruct textures
+			void destruct(const context& ctx);
+		};
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -34,6 +34,8 @@ namespace cgv {
 			shader_defines = "";
 			volume_texture = nullptr;
 			volume_texture_size = vec3(1.0f);
+			occupancy_texture = nullptr;
+			brick_size = 16;
 		}
 
 		void volume_renderer::set_attribute_array_manager(const context& ctx, attribute_array_manager* _aam_ptr)
@@ -94,6 +96,21 @@ namespace cgv {
 			return true;
 		}
 
+		int volume_renderer::get_occupancy_texture_unit() const
+		{
+			return get_style<volume_render_style>().transfer_function_texture_unit == 2 ? 3 : 2;
+		}
+
+		bool volume_renderer::set_occupancy_texture(texture* _occupancy_texture, unsigned _brick_size)
+		{
+			if(_occupancy_texture && _occupancy_texture->get_nr_dimensions() != 3)
+				return false;
+
+			occupancy_texture = _occupancy_texture;
+			brick_size = _brick_size;
+			return true;
+		}
+
 		void volume_renderer::set_eye_position(vec3 _eye_position)
 		{
 			eye_position = _eye_position;
@@ -105,6 +122,8 @@ namespace cgv {
 
 			std::string defines = "INTERPOLATION_MODE=";
 			defines += std::to_string((int)vrs.interpolation_mode);
+			defines += ";ENABLE_EMPTY_SPACE_SKIPPING=";
+			defines += occupancy_texture ? "1" : "0";
 			return defines;
 		}
 
@@ -144,22 +163,34 @@ namespace cgv {
 			ref_prog().set_uniform(ctx, "tex_size", volume_texture_size);
 			ref_prog().set_uniform(ctx, "tex_coord_scaling", vec3(cgv::math::max_value(volume_texture_size)) / volume_texture_size);
 			ref_prog().set_uniform(ctx, "transformation_matrix", vrs.transformation_matrix);
+			if(occupancy_texture) {
+				ref_prog().set_uniform(ctx, "occupancy_tex", get_occupancy_texture_unit());
+				ref_prog().set_uniform(ctx, "brick_size", float(brick_size));
+			}
 
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			if (is_gl_context(ctx)) {
+				glEnable(GL_BLEND);
+				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-			glCullFace(GL_FRONT);
-			glEnable(GL_CULL_FACE);
+				glCullFace(GL_FRONT);
+				glEnable(GL_CULL_FACE);
+			}
 			volume_texture->enable(ctx, 0);
+			if(occupancy_texture)
+				occupancy_texture->enable(ctx, get_occupancy_texture_unit());
 			return true;
 		}
 		///
 		bool volume_renderer::disable(context& ctx)
 		{
 			volume_texture->disable(ctx);
+			if(occupancy_texture)
+				occupancy_texture->disable(ctx);
 
-			glDisable(GL_BLEND);
-			glDisable(GL_CULL_FACE);
+			if (is_gl_context(ctx)) {
+				glDisable(GL_BLEND);
+				glDisable(GL_CULL_FACE);
+			}
 
 			if (!attributes_persist()) {}
 
@@ -168,7 +199,10 @@ namespace cgv {
 		///
 		void volume_renderer::draw(context& ctx, size_t start, size_t count, bool use_strips, bool use_adjacency, uint32_t strip_restart_index)
 		{
-			glDrawArrays(GL_TRIANGLE_STRIP, 0, (GLsizei)14);
+			if (is_gl_context(ctx))
+				glDrawArrays(GL_TRIANGLE_STRIP, 0, (GLsizei)14);
+			else
+				skip_draw_call(ctx, 14);
 		}
 	}
 }
@@ -54,12 +54,18 @@ namespace cgv { // @<
 			texture* volume_texture;
 			/// the size of the volume texture
 			vec3 volume_texture_size;
+			/// the 3D texture with one texel per brick that marks non empty bricks or nullptr if empty space skipping is disabled
+			texture* occupancy_texture;
+			/// edge length of bricks in voxels
+			unsigned brick_size;
 			/// the eye position in world space
 			vec3 eye_position;
 			/// whether the shader should be rebuilt after a define update
 			std::string shader_defines;
 			/// overload to allow instantiation of volume_renderer
 			render_style* create_render_style() const;
+			/// return texture unit of occupancy texture, which differs from the units of volume and transfer function
+			int get_occupancy_texture_unit() const;
 		public:
 			/// initializes position_is_center to true 
 			volume_renderer();
@@ -69,6 +75,8 @@ namespace cgv { // @<
 			bool init(context& ctx);
 			///
 			bool set_volume_texture(texture* _volume_texture);
+			/// set texture with one texel per brick of brick_size^3 voxels that is zero for empty bricks, which are skipped during ray casting, or nullptr to disable skipping
+			bool set_occupancy_texture(texture* _occupancy_texture, unsigned _brick_size = 16);
 			///
 			void set_eye_position(vec3 _eye_position);
 			///
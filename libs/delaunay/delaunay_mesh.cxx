@@ -2,6 +2,7 @@
 #include <iostream>
 #include <algorithm>
 #include <math.h>
+#include <random>
 
 /// construct empty triangle mesh
 template <class T>
@@ -144,3 +145,110 @@ void delaunay_mesh<T>::flip_edges_around_vertex_to_validate(unsigned int ci, uns
 		}
 	}
 }
+
+/// return index of the cell (x,y) along a Hilbert curve through a grid of 2^16 x 2^16 cells
+static inline unsigned int hilbert_index(unsigned int x, unsigned int y)
+{
+	const unsigned int n = 1 << 16;
+	unsigned int d = 0;
+	for (unsigned int s = n/2; s > 0; s /= 2) {
+		unsigned int rx = (x & s) > 0 ? 1 : 0;
+		unsigned int ry = (y & s) > 0 ? 1 : 0;
+		d += s*s*((3*rx)^ry);
+		// rotate quadrant such that the curve of the sub grid starts at its origin
+		if (ry == 0) {
+			if (rx == 1) {
+				x = n-1-x;
+				y = n-1-y;
+			}
+			std::swap(x, y);
+		}
+	}
+	return d;
+}
+
+/// compute a biased randomized insertion order of all vertices
+template <class T>
+void delaunay_mesh<T>::compute_brio_order(std::vector<unsigned int>& order, unsigned int seed) const
+{
+	unsigned int n = get_nr_vertices();
+	order.resize(n);
+	if (n == 0)
+		return;
+	// compute bounding box to quantize points to the grid of the Hilbert curve
+	coord_type x_min = p_of_vi(0).x(), x_max = x_min;
+	coord_type y_min = p_of_vi(0).y(), y_max = y_min;
+	for (unsigned int vi=1; vi<n; ++vi) {
+		const point_type& p = p_of_vi(vi);
+		x_min = std::min(x_min, p.x());
+		x_max = std::max(x_max, p.x());
+		y_min = std::min(y_min, p.y());
+		y_max = std::max(y_max, p.y());
+	}
+	coord_type extent = std::max(x_max-x_min, y_max-y_min);
+	coord_type scale = extent > 0 ? (coord_type)65535/extent : 0;
+	// combine Hilbert index in the upper and vertex index in the lower 32 bits to sort plain integers
+	std::vector<unsigned long long> keys(n);
+	for (unsigned int vi=0; vi<n; ++vi) {
+		const point_type& p = p_of_vi(vi);
+		unsigned int x = (unsigned int)((p.x()-x_min)*scale);
+		unsigned int y = (unsigned int)((p.y()-y_min)*scale);
+		keys[vi] = ((unsigned long long)hilbert_index(x, y) << 32) | vi;
+	}
+	std::mt19937 rand_gen(seed);
+	std::shuffle(keys.begin(), keys.end(), rand_gen);
+	// the last round contains half of the vertices, the one before a quarter and so on down to a small first round
+	const unsigned int min_round_size = 64;
+	unsigned int end = n;
+	while (end > 0) {
+		unsigned int begin = end/2 < min_round_size ? 0 : end/2;
+		std::sort(keys.begin()+begin, keys.begin()+end);
+		end = begin;
+	}
+	for (unsigned int i=0; i<n; ++i)
+		order[i] = (unsigned int)(keys[i] & 0xffffffff);
+}
+
+/// insert all vertices in BRIO order
+template <class T>
+void delaunay_mesh<T>::compute_triangulation()
+{
+	unsigned int n = get_nr_vertices();
+	if (n < 3)
+		return;
+	typedef typename triangle_mesh_type::geometry_type geometry_type;
+	std::vector<unsigned int> order;
+	compute_brio_order(order);
+	// find a second vertex distinct from the first one, as duplicates would make every third vertex collinear
+	const point_type& p0 = p_of_vi(order[0]);
+	unsigned int i;
+	for (i=1; i<n; ++i)
+		if (geometry_type::sqr_dist(p_of_vi(order[i]), p0) > 0)
+			break;
+	if (i == n) {
+		std::cerr << "cannot triangulate vertices that all coincide" << std::endl;
+		return;
+	}
+	std::swap(order[1], order[i]);
+	// find a vertex that forms a non degenerate triangle with the first two vertices
+	const point_type& p1 = p_of_vi(order[1]);
+	for (i=2; i<n; ++i) {
+		const point_type& p = p_of_vi(order[i]);
+		if (geometry_type::is_outside(p, p0, p1) || geometry_type::is_inside(p, p0, p1))
+			break;
+	}
+	if (i == n) {
+		std::cerr << "cannot triangulate vertices that are all collinear" << std::endl;
+		return;
+	}
+	std::swap(order[2], order[i]);
+	// the number of triangles is bounded by twice the number of vertices
+	this->C.reserve(this->C.size()+6*n);
+	add_triangle(order[0], order[1], order[2]);
+	unsigned int vi_last = order[2];
+	for (i=3; i<n; ++i) {
+		vertex_insertion_info vii = insert_vertex(order[i], ci_of_vi(vi_last));
+		if (!vii.insert_error && !vii.is_duplicate)
+			vi_last = order[i];
+	}
+}
@@ -42,6 +42,16 @@ public:
 	/// reimplement vertex insertion in order to keep a delaunay triangulation. If a vertex with the same location already exists, ignore vertex and return index of vertex with identical location
 	vertex_insertion_info insert_vertex(unsigned int vi, unsigned int ci_start = 0, std::vector<unsigned int>* touched_corners = 0);
 	//@}
+
+	/**@name bulk construction*/
+	//@{
+	/** compute a biased randomized insertion order (BRIO) of all vertices. The randomly shuffled vertices are split
+	    into rounds of doubling size and each round is sorted along a Hilbert curve, such that consecutive vertices
+		 are close to each other while the randomization keeps the expected number of edge flips low. */
+	void compute_brio_order(std::vector<unsigned int>& order, unsigned int seed = 0) const;
+	/// reimplement triangulation to insert all vertices in BRIO order starting each point location at the previously inserted vertex
+	virtual void compute_triangulation();
+	//@}
 };
 
 #include <cgv/config/lib_end.h>
\ No newline at end of file
@@ -77,6 +77,17 @@ unsigned int delaunay_mesh_with_hierarchy<T>::find_nearest_neighbor(const point_
 	return delaunay_mesh_type::find_nearest_neighbor(p, ci_of_vi(vi));
 }
 
+/// insert the vertices in the order of their indices, such that vertex 0 is contained in all hierarchy levels
+template <class T>
+void delaunay_mesh_with_hierarchy<T>::compute_triangulation()
+{
+	if (get_nr_vertices() < 3)
+		return;
+	add_triangle(0,1,2);
+	for (unsigned int vi=3; vi<get_nr_vertices(); ++vi)
+		insert_vertex(vi);
+}
+
 /// insert a vertex by keeping a delaunay triangulation. If a vertex with the same location already exists, ignore vertex and return index of vertex with identical location
 template <class T>
 typename delaunay_mesh_with_hierarchy<T>::vertex_insertion_info delaunay_mesh_with_hierarchy<T>::insert_vertex(unsigned int vi, unsigned int ci_start, std::vector<unsigned int>* touched_corners)
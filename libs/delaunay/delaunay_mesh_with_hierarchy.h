@@ -55,6 +55,8 @@ public:
 	//@}
 	/// reimplement to construct the hierarchy levels
 	vertex_insertion_info insert_vertex(unsigned int vi, unsigned int ci_start = 0, std::vector<unsigned int>* touched_corners = 0);
+	/// reimplement triangulation to insert the vertices in the order of their indices, which is required to build the hierarchy levels
+	void compute_triangulation();
 };
 
 #include <cgv/config/lib_end.h>
\ No newline at end of file
@@ -109,7 +109,20 @@ typename triangle_mesh<G,C>::point_location_info
 	}
 	unsigned int ci = start_ci;
 	unsigned int k = 3;
+	unsigned int rand_bits = 0x2545F491;
 	while (true) {
+		// the visibility walk can cycle in triangulations that are not delaunay, which is avoided by
+		// crossing the second of the two remaining edges first in a pseudo random fashion
+		if (k == 2) {
+			rand_bits ^= rand_bits << 13;
+			rand_bits ^= rand_bits >> 17;
+			rand_bits ^= rand_bits << 5;
+			unsigned int cj = next(ci);
+			if ((rand_bits & 1) != 0 && !is_opposite_to_border(cj) && is_outside(p, cj)) {
+				ci = next(inv(cj));
+				continue;
+			}
+		}
 		unsigned int border_exit_ci = -1;
 		unsigned int i;
 		for (i=0; i<k; ++i) {
@@ -1,4 +1,5 @@
 #include "plot2d.h"
+#include <cgv/render/attribute_array_binding.h>
 #include <libs/cgv_gl/gl/gl.h>
 
 namespace cgv {
@@ -31,6 +32,7 @@ plot2d_config::plot2d_config(const std::string& _name) : plot_base_config(_name)
 	show_lines = true;
 	line_width = 1;
 	line_color = rgb(1,0.5f,0);
+	decimation = DM_NONE;
 	configure_chart(CT_LINE_CHART);
 };
 
@@ -48,13 +50,89 @@ void plot2d_config::set_colors(const rgb& base_color)
 	line_color = 0.25f*rgb(1, 1, 1) + 0.75f*base_color;
 }
 
+plot2d::sample_series::sample_series() : stream_vbo(cgv::render::VBT_VERTICES, cgv::render::VBU_DYNAMIC_DRAW)
+{
+	nr_processed = 0;
+	x_sorted = true;
+	decimated_x_min = decimated_x_max = 0;
+	decimated_nr_columns = 0;
+	decimated_nr_processed = 0;
+	decimated_mode = DM_NONE;
+	stream_capacity = 0;
+	nr_dropped = 0;
+	nr_uploaded = 0;
+	ring_size = 0;
+}
+
 /// construct empty plot with default domain [0..1,0..1]
 plot2d::plot2d() : plot_base(2)
 {
 }
 
+bool plot2d::has_default_attributes(unsigned i) const
+{
+	const auto& ass = attribute_sources[i];
+	if (ass.size() != 2)
+		return false;
+	for (unsigned ai = 0; ai < 2; ++ai)
+		if (ass[ai].source != AS_SAMPLE_CONTAINER || (ass[ai].sub_plot_index != -1 && ass[ai].sub_plot_index != int(i)) || ass[ai].offset != ai)
+			return false;
+	return true;
+}
+
+void plot2d::update_sample_series(unsigned i)
+{
+	sample_series& s = *series[i];
+	std::vector<vec2>& S = samples[i];
+	if (S.size() < s.nr_processed) {
+		s.nr_processed = 0;
+		s.x_sorted = true;
+	}
+	if (S.size() > s.nr_processed) {
+		for (size_t j = std::max(s.nr_processed, size_t(1)); s.x_sorted && j < S.size(); ++j)
+			if (S[j][0] < S[j - 1][0])
+				s.x_sorted = false;
+		if (s.nr_processed == 0)
+			s.y_pyramid.build(&S[0][1], S.size(), 2);
+		else
+			s.y_pyramid.append(&S[0][1], S.size(), 2);
+		s.nr_processed = S.size();
+	}
+	// streamed series drop their oldest samples in whole blocks of the pyramid such that at least stream_capacity
+	// samples remain, which also covers samples pushed through ref_sub_plot_samples() and keeps them within ring_size
+	if (s.stream_capacity == 0 || S.size() <= s.stream_capacity)
+		return;
+	size_t block_size = s.y_pyramid.get_block_size();
+	size_t nr_blocks = (S.size() - s.stream_capacity) / block_size;
+	if (nr_blocks == 0)
+		return;
+	size_t nr_dropped = nr_blocks*block_size;
+	S.erase(S.begin(), S.begin() + nr_dropped);
+	s.y_pyramid.drop_front_blocks(&S[0][1], nr_blocks, 2);
+	s.nr_processed -= nr_dropped;
+	s.nr_dropped += nr_dropped;
+	s.invalidate_decimation();
+}
+
 bool plot2d::compute_sample_coordinate_interval(int i, int ai, float& samples_min, float& samples_max)
 {
+	// use cached statistics of decimated and streamed sub plots, which cover the own samples only
+	if (has_default_attributes(i) && (ref_sub_plot2d_config(i).decimation != DM_NONE || series[i]->stream_capacity > 0)) {
+		update_sample_series(i);
+		const sample_series& s = *series[i];
+		if (samples[i].empty())
+			return false;
+		if (ai == 1) {
+			samples_min = samples[i][s.y_pyramid.get_min_index()][1];
+			samples_max = samples[i][s.y_pyramid.get_max_index()][1];
+			return true;
+		}
+		if (ai == 0 && s.x_sorted) {
+			samples_min = samples[i].front()[0];
+			samples_max = samples[i].back()[0];
+			return true;
+		}
+	}
 	// compute bounding box
 	bool found_sample = false;
 	float min_value, max_value;
@@ -94,6 +172,7 @@ unsigned plot2d::add_sub_plot(const std::string& name)
 	// create new point container
 	samples.push_back(std::vector<plot2d::vec2>());
 	strips.push_back(std::vector<unsigned>());
+	series.push_back(std::unique_ptr<sample_series>(new sample_series()));
 	attribute_sources.push_back(std::vector<attribute_source>());
 	attribute_sources.back().push_back(attribute_source(i, 0, 0, 2 * sizeof(float)));
 	attribute_sources.back().push_back(attribute_source(i, 1, 0, 2 * sizeof(float)));
@@ -108,6 +187,7 @@ void plot2d::delete_sub_plot(unsigned i)
 	configs.erase(configs.begin() + i);
 	samples.erase(samples.begin() + i);
 	strips.erase(strips.begin() + i);
+	series.erase(series.begin() + i);
 }
 
 /// return a reference to the plot base configuration of the i-th plot
@@ -127,6 +207,142 @@ std::vector<unsigned>& plot2d::ref_sub_plot_strips(unsigned i)
 	return strips[i];
 }
 
+void plot2d::update_sub_plot_samples(unsigned i, size_t start, size_t count)
+{
+	sample_series& s = *series[i];
+	if (start == 0 && count >= samples[i].size()) {
+		s.nr_processed = 0;
+		s.x_sorted = true;
+	}
+	else if (start < s.nr_processed) {
+		size_t end = std::min(s.nr_processed, start + count);
+		for (size_t j = std::max(start, size_t(1)); s.x_sorted && j < std::min(s.nr_processed, end + 1); ++j)
+			if (samples[i][j][0] < samples[i][j - 1][0])
+				s.x_sorted = false;
+		s.y_pyramid.update(&samples[i][0][1], start, end - start, 2);
+	}
+	s.nr_uploaded = std::min(s.nr_uploaded, s.nr_dropped + start);
+	s.invalidate_decimation();
+}
+
+void plot2d::set_sub_plot_stream_capacity(unsigned i, size_t capacity)
+{
+	sample_series& s = *series[i];
+	s.stream_capacity = capacity;
+	s.ring_size = capacity == 0 ? 0 : capacity + s.y_pyramid.get_block_size();
+	// enforce reupload into a new ring buffer
+	s.nr_uploaded = s.nr_dropped;
+	append_sub_plot_samples(i, 0, 0);
+}
+
+void plot2d::append_sub_plot_samples(unsigned i, const vec2* new_samples, size_t count)
+{
+	sample_series& s = *series[i];
+	std::vector<vec2>& S = samples[i];
+	S.insert(S.end(), new_samples, new_samples + count);
+	if (s.stream_capacity > 0 && S.size() > s.stream_capacity)
+		update_sample_series(i);
+}
+
+bool plot2d::get_sub_plot_sample_box(unsigned i, vec2& min_pnt, vec2& max_pnt)
+{
+	return compute_sample_coordinate_interval(i, 0, min_pnt[0], max_pnt[0]) &&
+		compute_sample_coordinate_interval(i, 1, min_pnt[1], max_pnt[1]);
+}
+
+unsigned plot2d::compute_nr_pixel_columns(cgv::render::context& ctx) const
+{
+	vecn p0 = domain_min, p1 = domain_min;
+	p1(0) = domain_max(0);
+	dmat4 M = ctx.get_modelview_projection_window_matrix();
+	dvec4 q0 = M*dvec4(dvec3(transform_to_world(p0)), 1.0), q1 = M*dvec4(dvec3(transform_to_world(p1)), 1.0);
+	if (q0(3) <= 0 || q1(3) <= 0)
+		return 0;
+	double dx = q1(0) / q1(3) - q0(0) / q0(3), dy = q1(1) / q1(3) - q0(1) / q0(3);
+	return unsigned(std::min(65536.0, std::ceil(std::sqrt(dx*dx + dy*dy))));
+}
+
+bool plot2d::decimate_sub_plot(cgv::render::context& ctx, unsigned i)
+{
+	const plot2d_config& spc = ref_sub_plot2d_config(i);
+	if (spc.decimation == DM_NONE || get_domain_config_ptr()->axis_configs[0].log_scale)
+		return false;
+	update_sample_series(i);
+	sample_series& s = *series[i];
+	if (!s.x_sorted || samples[i].empty())
+		return false;
+	unsigned nr_columns = compute_nr_pixel_columns(ctx);
+	if (nr_columns == 0)
+		return false;
+	// reuse decimation of last frame if nothing changed
+	if (nr_columns == s.decimated_nr_columns && spc.decimation == s.decimated_mode && s.nr_processed == s.decimated_nr_processed &&
+		domain_min(0) == s.decimated_x_min && domain_max(0) == s.decimated_x_max)
+		return true;
+	const std::vector<vec2>& S = samples[i];
+	if (spc.decimation == DM_MIN_MAX)
+		cgv::math::decimate_min_max(&S[0], S.size(), s.y_pyramid, domain_min(0), domain_max(0), nr_columns, s.decimated);
+	else {
+		// bound the cost of lttb by evaluating it on the min max reduction to four columns per pixel
+		std::vector<vec2> reduced;
+		cgv::math::decimate_min_max(&S[0], S.size(), s.y_pyramid, domain_min(0), domain_max(0), 4 * nr_columns, reduced);
+		if (reduced.empty())
+			s.decimated.clear();
+		else
+			cgv::math::decimate_lttb(&reduced[0], reduced.size(), nr_columns, s.decimated);
+	}
+	s.decimated_nr_columns = nr_columns;
+	s.decimated_mode = spc.decimation;
+	s.decimated_nr_processed = s.nr_processed;
+	s.decimated_x_min = domain_min(0);
+	s.decimated_x_max = domain_max(0);
+	return true;
+}
+
+size_t plot2d::set_stream_attributes(cgv::render::context& ctx, unsigned i)
+{
+	update_sample_series(i);
+	sample_series& s = *series[i];
+	const std::vector<vec2>& S = samples[i];
+	if (s.stream_vbo.is_created() && s.stream_vbo.get_size_in_bytes() != 2 * s.ring_size * sizeof(vec2))
+		s.stream_vbo.destruct(ctx);
+	if (!s.stream_vbo.is_created()) {
+		s.stream_vbo.create(ctx, 2 * s.ring_size * sizeof(vec2));
+		s.nr_uploaded = s.nr_dropped;
+	}
+	// upload samples that have not been uploaded yet to both copies of the ring buffer
+	size_t first = s.nr_dropped, end = first + S.size();
+	if (s.nr_uploaded > end)
+		s.nr_uploaded = first;
+	for (size_t a = std::max(first, s.nr_uploaded); a < end; ) {
+		size_t slot = a % s.ring_size;
+		size_t count = std::min(end - a, s.ring_size - slot);
+		s.stream_vbo.replace(ctx, slot * sizeof(vec2), &S[a - first], count);
+		s.stream_vbo.replace(ctx, (slot + s.ring_size) * sizeof(vec2), &S[a - first], count);
+		a += count;
+	}
+	s.nr_uploaded = end;
+	size_t offset = (first % s.ring_size) * sizeof(vec2);
+	cgv::render::type_descriptor td = cgv::render::element_descriptor_traits<float>::get_type_descriptor(0.0f);
+	cgv::render::attribute_array_binding::set_global_attribute_array(ctx, 0, s.stream_vbo, td, S.size(), offset, sizeof(vec2));
+	cgv::render::attribute_array_binding::set_global_attribute_array(ctx, 1, s.stream_vbo, td, S.size(), offset + sizeof(float), sizeof(vec2));
+	return S.size();
+}
+
+size_t plot2d::set_sub_plot_attributes(cgv::render::context& ctx, unsigned i)
+{
+	if (samples[i].empty() || !strips[i].empty() || !has_default_attributes(i))
+		return set_attributes(ctx, i, samples);
+	if (decimate_sub_plot(ctx, i)) {
+		if (series[i]->decimated.empty())
+			return 0;
+		set_attributes(ctx, series[i]->decimated);
+		return series[i]->decimated.size();
+	}
+	if (series[i]->stream_capacity > 0)
+		return set_stream_attributes(ctx, i);
+	return set_attributes(ctx, i, samples);
+}
+
 void plot2d::create_config_gui(cgv::base::base* bp, cgv::gui::provider& p, unsigned i)
 {
 	plot2d_config& pbc = ref_sub_plot2d_config(i);
@@ -136,6 +352,7 @@ void plot2d::create_config_gui(cgv::base::base* bp, cgv::gui::provider& p, unsig
 		p.align("\a");
 			p.add_member_control(bp, "width", pbc.line_width, "value_slider", "min=1;max=20;log=true;ticks=true");
 			p.add_member_control(bp, "color", pbc.line_color);
+			p.add_member_control(bp, "decimation", pbc.decimation, "dropdown", "enums='none,min max,lttb'");
 		p.align("\b");
 		p.end_tree_node(pbc.show_lines);
 	}
@@ -170,12 +387,15 @@ void plot2d::clear(cgv::render::context& ctx)
 	stick_prog.destruct(ctx);
 	bar_prog.destruct(ctx);
 	bar_outline_prog.destruct(ctx);
+	for (const auto& s : series)
+		if (s->stream_vbo.is_created())
+			s->stream_vbo.destruct(ctx);
 }
 
 
 void plot2d::draw_sub_plot(cgv::render::context& ctx, unsigned i)
 {
-	GLsizei count = (GLsizei)set_attributes(ctx, i, samples);
+	GLsizei count = (GLsizei)set_sub_plot_attributes(ctx, i);
 	if (count == 0)
 		return;
 	const plot2d_config& spc = ref_sub_plot2d_config(i);
@@ -2,12 +2,22 @@
 
 #include "plot_base.h"
 #include <cgv/render/shader_program.h>
+#include <cgv/math/series_decimation.h>
+#include <memory>
 
 #include "lib_begin.h"
 
 namespace cgv {
 	namespace plot {
 
+/// strategies to reduce the number of drawn samples of sub plots with large series sorted by x
+enum DecimationMode
+{
+	DM_NONE,    //! draw all samples
+	DM_MIN_MAX, //! draw first, smallest, largest and last sample per pixel column
+	DM_LTTB     //! select one sample per pixel column with the largest triangle three buckets method
+};
+
 /** extend common plot configuration with parameters specific to 2d plot */
 struct CGV_API plot2d_config : public plot_base_config
 {
@@ -17,6 +27,8 @@ struct CGV_API plot2d_config : public plot_base_config
 	float line_width;
 	/// line color
 	rgb line_color;
+	/// view dependent reduction of samples, which is only applied to series sorted by x without strips and with default attribute sources
+	DecimationMode decimation;
 	/// set default values
 	plot2d_config(const std::string& _name);
 	/// configure the sub plot to a specific chart type
@@ -49,6 +61,56 @@ protected:
 	std::vector<std::vector<vec2> > samples;
 	/// allow to split series into connected strips that are represented by the number of contained samples
 	std::vector <std::vector<unsigned> > strips;
+
+	/// acceleration data of a sub plot for decimation, cached statistics and streaming
+	struct sample_series
+	{
+		/// pyramid over the y coordinates of the processed samples
+		cgv::math::min_max_pyramid<float> y_pyramid;
+		/// number of samples covered by pyramid and sortedness
+		size_t nr_processed;
+		/// whether x coordinates of processed samples do not decrease
+		bool x_sorted;
+		/// decimated samples of the last draw call
+		std::vector<vec2> decimated;
+		/// view parameters and number of processed samples of decimated samples, used to avoid recomputation
+		float decimated_x_min, decimated_x_max;
+		unsigned decimated_nr_columns;
+		size_t decimated_nr_processed;
+		DecimationMode decimated_mode;
+		/// number of samples kept at least for streamed series or 0 if series is not streamed
+		size_t stream_capacity;
+		/// number of samples dropped from the front of a streamed series
+		size_t nr_dropped;
+		/// number of samples including dropped ones that have been uploaded to stream_vbo
+		size_t nr_uploaded;
+		/// number of slots of the ring buffer
+		size_t ring_size;
+		/// vertex buffer storing two consecutive copies of the ring buffer, such that the kept samples are contiguous
+		cgv::render::vertex_buffer stream_vbo;
+		/// construct empty series
+		sample_series();
+		/// mark decimated samples as out of date
+		void invalidate_decimation() { decimated_nr_columns = 0; }
+	};
+	/// one sample series per sub plot
+	std::vector<std::unique_ptr<sample_series> > series;
+	/// no copy construction
+	plot2d(const plot2d&);
+	/// no assignment
+	plot2d& operator = (const plot2d&);
+	/// check whether sub plot i takes its two attributes from its own sample container
+	bool has_default_attributes(unsigned i) const;
+	/// ensure that pyramid and sortedness of sub plot i cover all its samples and trim streamed series to their capacity
+	void update_sample_series(unsigned i);
+	/// return number of window pixels spanned by the x-axis of the domain or 0 if it cannot be determined
+	unsigned compute_nr_pixel_columns(cgv::render::context& ctx) const;
+	/// update decimated samples of sub plot i and return whether they should be drawn instead of all samples
+	bool decimate_sub_plot(cgv::render::context& ctx, unsigned i);
+	/// upload new samples of streamed sub plot i, set its attributes from the vertex buffer and return the number of samples
+	size_t set_stream_attributes(cgv::render::context& ctx, unsigned i);
+	/// set the vertex attributes of sub plot i from decimated, streamed or all samples and return the number of vertices
+	size_t set_sub_plot_attributes(cgv::render::context& ctx, unsigned i);
 public:
 	/// construct empty plot with default domain [0..1,0..1]
 	plot2d();
@@ -65,6 +127,14 @@ public:
 	std::vector<vec2>& ref_sub_plot_samples(unsigned i = 0);
 	/// return the strip definition of the i-th sub plot
 	std::vector<unsigned>& ref_sub_plot_strips(unsigned i = 0);
+	/// notify that the samples [start,start+count) of the i-th sub plot have been changed in place, which is only necessary for decimated or streamed sub plots
+	void update_sub_plot_samples(unsigned i, size_t start = 0, size_t count = size_t(-1));
+	/// turn the i-th sub plot into a streamed series that keeps at least the last capacity samples or turn off streaming with capacity 0
+	void set_sub_plot_stream_capacity(unsigned i, size_t capacity);
+	/// append samples to the i-th sub plot, where streamed series drop their oldest samples and only upload the new ones
+	void append_sub_plot_samples(unsigned i, const vec2* new_samples, size_t count);
+	/// compute the bounding box of the samples of the i-th sub plot from cached statistics and return false if there are no samples
+	bool get_sub_plot_sample_box(unsigned i, vec2& min_pnt, vec2& max_pnt);
 	//@}
 
 	/// create the gui for a configuration, overload to specialize for extended configs
@@ -1,4 +1,5 @@
 #include "ann_tree.h"
+#include <cgv/utils/trace.h>
 
 #define ANN_USE_FLOAT
 #include <ANN/ANN.h>
@@ -41,6 +42,7 @@ bool ann_tree::is_empty() const
 
 void ann_tree::build(const point_cloud& _pc)
 {
+	CGV_TRACE_SCOPE("ann_tree::build");
 	//
 	clear();
 	// store pointer to points in point cloud
@@ -41,6 +41,7 @@ gl_point_cloud_drawable::gl_point_cloud_drawable()
 
 	use_component_colors = false;
 	use_component_transformations = false;
+	use_frustum_culling = false;
 }
 
 bool gl_point_cloud_drawable::read(const std::string& _file_name)
@@ -56,6 +57,7 @@ bool gl_point_cloud_drawable::read(const std::string& _file_name)
 	}
 	show_point_begin = 0;
 	show_point_end = pc.get_nr_points();
+	culler.invalidate();
 
 	post_redraw();
 	return true;
@@ -89,6 +91,7 @@ bool gl_point_cloud_drawable::append(const std::string& _file_name, bool add_com
 		cgv::utils::file::drop_extension(cgv::utils::file::get_file_name(_file_name));
 	show_point_begin = 0;
 	show_point_end = pc.get_nr_points();
+	culler.invalidate();
 	return true;
 }
 
@@ -261,6 +264,12 @@ void gl_point_cloud_drawable::draw_points(context& ctx)
 				}
 			}
 		}
+		// splat sizes in pixels have no bound in object space, such that culling with them would not be conservative
+		else if (use_frustum_culling && show_point_step == 1 && pc.get_nr_points() > 0 && !(pc.has_components() && use_component_transformations) && !surfel_style.measure_point_size_in_pixel) {
+			culler.set_position_array(&pc.pnt(0), pc.get_nr_points(), surfel_style.point_size*s_renderer.get_reference_point_size());
+			culler.cull(ctx);
+			culler.draw(ctx, s_renderer, offset, n);
+		}
 		else {
 			size_t nn = n / nr_draw_calls;
 			for (unsigned i=1; i<nr_draw_calls; ++i)
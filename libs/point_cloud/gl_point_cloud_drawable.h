@@ -10,6 +10,7 @@
 #include <cgv_gl/normal_renderer.h>
 #include <cgv_gl/box_renderer.h>
 #include <cgv_gl/box_wire_renderer.h>
+#include <cgv_gl/frustum_culler.h>
 
 #include "lib_begin.h"
 
@@ -29,6 +30,7 @@ protected:
 	cgv::render::normal_renderer n_renderer;
 	cgv::render::box_renderer b_renderer;
 	cgv::render::box_wire_renderer bw_renderer;
+	cgv::render::frustum_culler culler;
 
 	bool show_points;
 	bool show_box;
@@ -37,6 +39,8 @@ protected:
 	bool sort_points;
 	bool use_component_colors;
 	bool use_component_transformations;
+	/// cull chunks of points against the view frustum, only used without sorting, component colors, component transformations, point step and point sizes in pixels
+	bool use_frustum_culling;
 	rgba box_color;
 	
 	std::vector<Clr>* use_these_point_colors;
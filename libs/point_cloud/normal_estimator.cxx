@@ -3,6 +3,7 @@
 #include <cmath>
 #include <cgv/math/functions.h>
 #include <algorithm>
+#include <cgv/utils/trace.h>
 
 normal_estimator::normal_estimator(point_cloud& _pc, neighbor_graph& _ng) : pc(_pc), ng(_ng) 
 {
@@ -50,6 +51,7 @@ normal_estimator::Crd normal_estimator::estimate_scale(Idx vi) const
 /// compute normals from neighbor graph and distance and normal weights
 void normal_estimator::smooth_normals()
 {
+	CGV_TRACE_SCOPE("normal_estimator::smooth_normals");
 	if (!pc.has_normals())
 		compute_weighted_normals(false);
 
@@ -134,6 +136,7 @@ void normal_estimator::compute_weights(Idx vi, std::vector<Crd>& weights, std::v
 /// recompute normals from neighbor graph and distance and normal weights
 void normal_estimator::compute_weighted_normals(bool reorient)
 {
+	CGV_TRACE_SCOPE("normal_estimator::compute_weighted_normals");
 	if (!pc.has_normals()) {
 		pc.create_normals();
 		reorient = false;
@@ -1,8 +1,10 @@
 #include <cgv/math/permute.h>
 #include <cgv/math/det.h>
+#include <cgv/math/transform_points.h>
 #include "point_cloud.h"
 #include <cgv/utils/file.h>
 #include <cgv/utils/stopwatch.h>
+#include <cgv/utils/trace.h>
 #include <cgv/utils/scan.h>
 #include <cgv/utils/advanced_scan.h>
 #include <cgv/media/mesh/obj_reader.h>
@@ -298,11 +300,11 @@ void point_cloud::translate(const Dir& dir, Idx ci)
 /// translate by direction
 void point_cloud::rotate(const Qat& qat, Idx ci)
 {
-	for (Idx e = end_index(ci), i = begin_index(ci); i < e; ++i)
-		pnt(i) = qat.apply(pnt(i));
-	if (has_normals()) {
-		for (Idx e = end_index(ci), i = begin_index(ci); i < e; ++i)
-			nml(i) = qat.apply(nml(i));
+	Idx b = begin_index(ci), n = end_index(ci) - b;
+	if (n > 0) {
+		cgv::math::rotate_points(qat, &pnt(b), &pnt(b), n);
+		if (has_normals())
+			cgv::math::rotate_points(qat, &nml(b), &nml(b), n);
 	}
 	box_out_of_date = true;
 	if (ci != -1 && has_components())
@@ -312,32 +314,24 @@ void point_cloud::rotate(const Qat& qat, Idx ci)
 /// transform with linear transform 
 void point_cloud::transform(const Mat& mat)
 {
-	for (Idx i=0; i<(Idx)get_nr_points(); ++i) {
-		pnt(i) = mat*pnt(i);
-	}
+	if (get_nr_points() > 0)
+		cgv::math::transform_vectors(mat, &pnt(0), &pnt(0), get_nr_points());
 	box_out_of_date = true;
 }
 
 /// transform with affine transform 
 void point_cloud::transform(const AMat& amat)
 {
-	HVec h(0,0,0,1);
-	for (Idx i=0; i<(Idx)get_nr_points(); ++i) {
-		(Dir&)h=pnt(i);
-		pnt(i) = amat*h;
-	}
+	if (get_nr_points() > 0)
+		cgv::math::transform_points(amat, &pnt(0), &pnt(0), get_nr_points());
 	box_out_of_date = true;
 }
 
 /// transform with homogeneous transform and w-clip
 void point_cloud::transform(const HMat& hmat)
 {
-	HVec h0(0,0,0,1), h1;
-	for (Idx i=0; i<(Idx)get_nr_points(); ++i) {
-		(Dir&)h0=pnt(i);
-		h1 = hmat*h0;
-		pnt(i) = (1/h1(3))*(const Dir&)h1;
-	}
+	if (get_nr_points() > 0)
+		cgv::math::transform_points_projective(hmat, &pnt(0), &pnt(0), get_nr_points());
 	box_out_of_date = true;
 }
 
@@ -382,6 +376,7 @@ void point_cloud::resize(size_t nr_points)
 
 bool point_cloud::read(const string& _file_name)
 {
+	CGV_TRACE_SCOPE("point_cloud::read");
 	string ext = to_lower(get_extension(_file_name));
 	bool success = false;
 	if (ext == "bpc")
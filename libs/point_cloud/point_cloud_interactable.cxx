@@ -363,6 +363,11 @@ std::string point_cloud_interactable::get_type_name() const
 {
 	return "point_cloud_interactable";
 }
+/// cache the reflected members in a property index
+const cgv::reflect::property_index* point_cloud_interactable::get_property_index()
+{
+	return cgv::base::ref_property_index(this);
+}
 bool point_cloud_interactable::self_reflect(cgv::reflect::reflection_handler& srh)
 {
 	if (srh.reflect_member("do_append", do_append) &&
@@ -809,6 +814,7 @@ void point_cloud_interactable::create_gui()
 		if (begin_tree_node("subsample", show_point_step, false, "level=3")) {
 			align("\a");
 			add_member_control(this, "nr_draw_calls", nr_draw_calls, "value_slider", "min=1;max=100;log=true;ticks=true");
+			add_member_control(this, "frustum culling", use_frustum_culling, "check");
 			add_member_control(this, "interact step", interact_point_step, "value_slider", "min=1;max=100;log=true;ticks=true");
 			add_member_control(this, "interact delay", interact_delay, "value_slider", "min=0.01;max=1;log=true;ticks=true");
 			add_member_control(this, "show step", show_point_step, "value_slider", "min=1;max=20;log=true;ticks=true");
@@ -169,6 +169,8 @@ public:
 	std::string get_type_name() const;
 	/// describe members
 	bool self_reflect(cgv::reflect::reflection_handler& srh);
+	/// cache the reflected members in a property index
+	const cgv::reflect::property_index* get_property_index();
 	/// stream out textual statistical information shown with F8
 	void stream_stats(std::ostream&);
 	/// stream out textual help information shown with F1
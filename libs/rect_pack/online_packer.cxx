@@ -0,0 +1,377 @@
+#include "online_packer.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <random>
+
+namespace rect_pack {
+
+	static rectangle make_rectangle(int x, int y, int w, int h)
+	{
+		rectangle r;
+		r.x = x;
+		r.y = y;
+		r.width = w;
+		r.height = h;
+		return r;
+	}
+
+	static bool intersect(const rectangle& a, const rectangle& b)
+	{
+		return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+	}
+
+	/// check whether a contains b
+	static bool contains(const rectangle& a, const rectangle& b)
+	{
+		return b.x >= a.x && b.y >= a.y && b.x + b.width <= a.x + a.width && b.y + b.height <= a.y + a.height;
+	}
+
+	online_packer::online_packer(int _width, int _height)
+	{
+		clear(_width, _height);
+	}
+
+	void online_packer::clear(int _width, int _height)
+	{
+		width = _width;
+		height = _height;
+		rectangles.clear();
+		in_use.clear();
+		free_ids.clear();
+		free_rectangles.clear();
+		if (width > 0 && height > 0)
+			free_rectangles.push_back(make_rectangle(0, 0, width, height));
+		used_area = 0;
+		rebuild_threshold = 32;
+	}
+
+	bool online_packer::find_position(int w, int h, rectangle& r) const
+	{
+		int best_short_side = std::numeric_limits<int>::max();
+		int best_long_side = std::numeric_limits<int>::max();
+		for (const auto& f : free_rectangles) {
+			if (f.width < w || f.height < h)
+				continue;
+			int leftover_x = f.width - w, leftover_y = f.height - h;
+			int short_side = std::min(leftover_x, leftover_y), long_side = std::max(leftover_x, leftover_y);
+			if (short_side < best_short_side || (short_side == best_short_side && long_side < best_long_side)) {
+				r = make_rectangle(f.x, f.y, w, h);
+				best_short_side = short_side;
+				best_long_side = long_side;
+			}
+		}
+		return best_short_side != std::numeric_limits<int>::max();
+	}
+
+	bool online_packer::overlaps_used(const rectangle& r, int ignored_id) const
+	{
+		for (int i = 0; i < (int)rectangles.size(); ++i)
+			if (i != ignored_id && in_use[i] && intersect(r, rectangles[i]))
+				return true;
+		return false;
+	}
+
+	void online_packer::place(const rectangle& r)
+	{
+		// split all free rectangles overlapping r into up to four maximal pieces
+		std::vector<rectangle> pieces;
+		for (size_t i = 0; i < free_rectangles.size(); ) {
+			rectangle f = free_rectangles[i];
+			if (!intersect(f, r)) {
+				++i;
+				continue;
+			}
+			if (r.x > f.x)
+				pieces.push_back(make_rectangle(f.x, f.y, r.x - f.x, f.height));
+			if (r.x + r.width < f.x + f.width)
+				pieces.push_back(make_rectangle(r.x + r.width, f.y, f.x + f.width - r.x - r.width, f.height));
+			if (r.y > f.y)
+				pieces.push_back(make_rectangle(f.x, f.y, f.width, r.y - f.y));
+			if (r.y + r.height < f.y + f.height)
+				pieces.push_back(make_rectangle(f.x, r.y + r.height, f.width, f.y + f.height - r.y - r.height));
+			free_rectangles[i] = free_rectangles.back();
+			free_rectangles.pop_back();
+		}
+		// keep only pieces that are not contained in other pieces or untouched free rectangles
+		size_t nr_untouched = free_rectangles.size();
+		for (size_t i = 0; i < pieces.size(); ++i) {
+			bool redundant = false;
+			for (size_t j = 0; j < pieces.size() && !redundant; ++j)
+				if (j != i && contains(pieces[j], pieces[i]) && (j < i || !contains(pieces[i], pieces[j])))
+					redundant = true;
+			for (size_t j = 0; j < nr_untouched && !redundant; ++j)
+				if (contains(free_rectangles[j], pieces[i]))
+					redundant = true;
+			if (!redundant)
+				free_rectangles.push_back(pieces[i]);
+		}
+	}
+
+	void online_packer::release(const rectangle& r)
+	{
+		// merge with free rectangles that share a complete edge
+		rectangle m = r;
+		bool merged;
+		do {
+			merged = false;
+			for (size_t i = 0; i < free_rectangles.size(); ++i) {
+				const rectangle& f = free_rectangles[i];
+				if (f.x == m.x && f.width == m.width && (f.y + f.height == m.y || m.y + m.height == f.y))
+					m = make_rectangle(m.x, std::min(m.y, f.y), m.width, m.height + f.height);
+				else if (f.y == m.y && f.height == m.height && (f.x + f.width == m.x || m.x + m.width == f.x))
+					m = make_rectangle(std::min(m.x, f.x), m.y, m.width + f.width, m.height);
+				else
+					continue;
+				free_rectangles[i] = free_rectangles.back();
+				free_rectangles.pop_back();
+				merged = true;
+				break;
+			}
+		} while (merged);
+		for (size_t i = 0; i < free_rectangles.size(); ) {
+			if (contains(m, free_rectangles[i])) {
+				free_rectangles[i] = free_rectangles.back();
+				free_rectangles.pop_back();
+			}
+			else
+				++i;
+		}
+		free_rectangles.push_back(m);
+		if (free_rectangles.size() > std::min(rebuild_threshold, 8 * get_nr_rectangles() + 64))
+			rebuild_free_rectangles();
+	}
+
+	void online_packer::rebuild_free_rectangles()
+	{
+		free_rectangles.clear();
+		free_rectangles.push_back(make_rectangle(0, 0, width, height));
+		for (int i = 0; i < (int)rectangles.size(); ++i)
+			if (in_use[i])
+				place(rectangles[i]);
+		rebuild_threshold = 2 * free_rectangles.size() + 32;
+	}
+
+	int online_packer::insert(int w, int h)
+	{
+		rectangle r;
+		if (w <= 0 || h <= 0 || !find_position(w, h, r))
+			return -1;
+		place(r);
+		int id;
+		if (free_ids.empty()) {
+			id = (int)rectangles.size();
+			rectangles.push_back(r);
+			in_use.push_back(true);
+		}
+		else {
+			id = free_ids.back();
+			free_ids.pop_back();
+			rectangles[id] = r;
+			in_use[id] = true;
+		}
+		used_area += (long long)w*h;
+		return id;
+	}
+
+	bool online_packer::remove(int id)
+	{
+		if (!is_used(id))
+			return false;
+		const rectangle& r = rectangles[id];
+		in_use[id] = false;
+		free_ids.push_back(id);
+		used_area -= (long long)r.width*r.height;
+		release(r);
+		return true;
+	}
+
+	bool online_packer::resize(int id, int w, int h)
+	{
+		if (!is_used(id) || w <= 0 || h <= 0)
+			return false;
+		rectangle old_r = rectangles[id];
+		rectangle r = make_rectangle(old_r.x, old_r.y, w, h);
+		in_use[id] = false;
+		release(old_r);
+		in_use[id] = true;
+		// keep position if the rectangle shrinks or the enlarged region is free
+		bool keep_position = contains(old_r, r) ||
+			(r.x + w <= width && r.y + h <= height && !overlaps_used(r, id));
+		if (!keep_position && !find_position(w, h, r)) {
+			place(old_r);
+			return false;
+		}
+		place(r);
+		rectangles[id] = r;
+		used_area += (long long)w*h - (long long)old_r.width*old_r.height;
+		return true;
+	}
+
+	void online_packer::grow(int new_width, int new_height)
+	{
+		new_width = std::max(new_width, width);
+		new_height = std::max(new_height, height);
+		// extend free rectangles touching the right or top border into the new region
+		for (auto& f : free_rectangles) {
+			if (f.x + f.width == width)
+				f.width = new_width - f.x;
+			if (f.y + f.height == height)
+				f.height = new_height - f.y;
+		}
+		std::vector<rectangle> strips;
+		if (new_width > width)
+			strips.push_back(make_rectangle(width, 0, new_width - width, new_height));
+		if (new_height > height)
+			strips.push_back(make_rectangle(0, height, new_width, new_height - height));
+		width = new_width;
+		height = new_height;
+		for (const auto& s : strips) {
+			bool redundant = false;
+			for (const auto& f : free_rectangles)
+				if (contains(f, s))
+					redundant = true;
+			if (!redundant)
+				free_rectangles.push_back(s);
+		}
+	}
+
+	bool online_packer::defragment()
+	{
+		std::vector<int> ids;
+		for (int i = 0; i < (int)rectangles.size(); ++i)
+			if (in_use[i])
+				ids.push_back(i);
+		std::sort(ids.begin(), ids.end(), [this](int a, int b) {
+			const rectangle& ra = rectangles[a];
+			const rectangle& rb = rectangles[b];
+			return ra.height > rb.height || (ra.height == rb.height && ra.width > rb.width);
+		});
+		std::vector<rectangle> old_rectangles = rectangles, old_free_rectangles = free_rectangles;
+		free_rectangles.clear();
+		free_rectangles.push_back(make_rectangle(0, 0, width, height));
+		for (int id : ids) {
+			rectangle r;
+			if (!find_position(rectangles[id].width, rectangles[id].height, r)) {
+				rectangles.swap(old_rectangles);
+				free_rectangles.swap(old_free_rectangles);
+				return false;
+			}
+			place(r);
+			rectangles[id] = r;
+		}
+		return true;
+	}
+
+	float online_packer::get_occupancy() const
+	{
+		if (width <= 0 || height <= 0)
+			return 0.0f;
+		return float(double(used_area) / (double(width)*height));
+	}
+
+	/// enlarge smaller side of packing area by a quarter
+	static void grow_smaller_side(online_packer& packer)
+	{
+		int w = packer.get_width(), h = packer.get_height();
+		if (w <= h)
+			packer.grow(w + std::max(w / 4, 1), h);
+		else
+			packer.grow(w, h + std::max(h / 4, 1));
+	}
+
+	void analyze_online_packing(
+		const std::string& file_name_prefix,
+		unsigned nr_rectangles,
+		unsigned nr_operations,
+		PackingStrategy strategy)
+	{
+		std::vector<rectangle_size> rectangle_sizes;
+		construct_random_rectangles(nr_rectangles, rectangle_sizes);
+		std::default_random_engine generator(13);
+		std::uniform_int_distribution<unsigned> index_distribution(0, nr_rectangles - 1);
+		std::uniform_int_distribution<int> size_distribution(1, 150);
+		std::uniform_int_distribution<int> operation_distribution(0, 2);
+		std::uniform_int_distribution<int> delta_distribution(-10, 10);
+		std::vector<rectangle_size> operations;
+		std::vector<unsigned> operation_indices;
+		std::vector<int> operation_kinds;
+		for (unsigned i = 0; i < nr_operations; ++i) {
+			rectangle_size s;
+			s.width = size_distribution(generator);
+			s.height = size_distribution(generator);
+			operations.push_back(s);
+			operation_indices.push_back(index_distribution(generator));
+			operation_kinds.push_back(operation_distribution(generator));
+		}
+		// initial packing area as suggested for the offline packing
+		std::vector<rectangle> rectangles;
+		unsigned width, height;
+		float offline_occupancy = pack_rectangles_iteratively(rectangle_sizes, width, height, rectangles, CS_LongerSideFirst, false, true, strategy);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		online_packer packer(width, height);
+		std::vector<int> ids(nr_rectangles);
+		std::vector<unsigned> permutation;
+		compute_rectangle_permutation(rectangle_sizes, permutation, CS_LongerSideFirst);
+		for (unsigned i : permutation)
+			while ((ids[i] = packer.insert(rectangle_sizes[i].width, rectangle_sizes[i].height)) == -1)
+				grow_smaller_side(packer);
+		auto initial = std::chrono::high_resolution_clock::now();
+		unsigned nr_moved = 0, nr_defragmentations = 0, nr_grows = 0;
+		for (unsigned o = 0; o < nr_operations; ++o) {
+			unsigned i = operation_indices[o];
+			rectangle_size& s = rectangle_sizes[i];
+			rectangle old_r = packer.get_rectangle(ids[i]);
+			if (operation_kinds[o] == 0) {
+				// replace label by new one
+				packer.remove(ids[i]);
+				s = operations[o];
+				ids[i] = packer.insert(s.width, s.height);
+			}
+			else {
+				// small change of extent as caused by text updates
+				s.width = std::max(1, s.width + delta_distribution(generator));
+				s.height = std::max(1, s.height + (operation_kinds[o] == 1 ? 0 : delta_distribution(generator)));
+				if (!packer.resize(ids[i], s.width, s.height)) {
+					packer.remove(ids[i]);
+					ids[i] = -1;
+				}
+				else if (packer.get_rectangle(ids[i]).x != old_r.x || packer.get_rectangle(ids[i]).y != old_r.y)
+					++nr_moved;
+			}
+			if (ids[i] == -1) {
+				if (packer.defragment())
+					++nr_defragmentations;
+				while ((ids[i] = packer.insert(s.width, s.height)) == -1) {
+					grow_smaller_side(packer);
+					++nr_grows;
+				}
+			}
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		double initial_ms = std::chrono::duration<double, std::milli>(initial - start).count();
+		double online_us = std::chrono::duration<double, std::micro>(end - initial).count() / nr_operations;
+
+		// offline repacking after each of a subset of the operations
+		unsigned nr_repacks = std::min(nr_operations, 20u);
+		start = std::chrono::high_resolution_clock::now();
+		for (unsigned o = 0; o < nr_repacks; ++o)
+			pack_rectangles_iteratively(rectangle_sizes, width, height, rectangles, CS_LongerSideFirst, false, true, strategy);
+		end = std::chrono::high_resolution_clock::now();
+		double offline_us = std::chrono::duration<double, std::micro>(end - start).count() / nr_repacks;
+
+		std::cout << "online packing of " << nr_rectangles << " rectangles: initial " << initial_ms << "ms, "
+			<< online_us << "us per operation over " << nr_operations << " operations (" << nr_moved << " moved, "
+			<< nr_defragmentations << " defragmentations, " << nr_grows << " grows), "
+			<< packer.get_width() << "x" << packer.get_height() << " -> " << packer.get_occupancy()
+			<< " with " << packer.get_nr_free_rectangles() << " free rectangles\n"
+			<< "repacking after each operation: " << offline_us << "us per operation, initially "
+			<< width << "x" << height << " -> " << offline_occupancy << std::endl;
+		rectangles.clear();
+		for (unsigned i = 0; i < nr_rectangles; ++i)
+			rectangles.push_back(packer.get_rectangle(ids[i]));
+		save_rectangles_html(file_name_prefix + "Online.html", packer.get_width(), packer.get_height(), rectangles);
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "rect_pack.h"
+#include <string>
+
+#include "lib_begin.h"
+
+namespace rect_pack {
+
+	/** online version of the max rectangle strategy that supports insertion, removal and resizing of single rectangles
+		without moving the other rectangles. The free space is represented by possibly overlapping free rectangles. Space
+		released by removed or shrunk rectangles is merged with adjacent free rectangles of matching extent and reused by
+		later insertions. If the number of free rectangles grows too large, they are recomputed from the rectangles in use. Rectangles are identified by ids that are reused after removal. Rectangles are not rotated. As
+		removals fragment the free space over time, defragment() can be called to repack all rectangles, which moves them. */
+	class CGV_API online_packer
+	{
+	protected:
+		/// extent of the packing area
+		int width, height;
+		/// rectangles indexed by id
+		std::vector<rectangle> rectangles;
+		/// per id whether it is in use
+		std::vector<bool> in_use;
+		/// ids that can be reused
+		std::vector<int> free_ids;
+		/// free rectangles whose union is the free space
+		std::vector<rectangle> free_rectangles;
+		/// summed area of all rectangles in use
+		long long used_area;
+		/// number of free rectangles above which they are recomputed
+		size_t rebuild_threshold;
+		/// find position of rectangle with given extent in the free space by the best short side fit rule
+		bool find_position(int w, int h, rectangle& r) const;
+		/// check whether rectangle overlaps any rectangle in use other than the one with the given id
+		bool overlaps_used(const rectangle& r, int ignored_id) const;
+		/// remove rectangle from free space that must be free
+		void place(const rectangle& r);
+		/// add rectangle to the free space
+		void release(const rectangle& r);
+		/// recompute the maximal free rectangles from the rectangles in use, which is done when released space fragmented the free rectangles
+		void rebuild_free_rectangles();
+	public:
+		/// construct packer for area of given extent
+		online_packer(int _width = 0, int _height = 0);
+		/// remove all rectangles and set extent of packing area
+		void clear(int _width, int _height);
+		/// return width of packing area
+		int get_width() const { return width; }
+		/// return height of packing area
+		int get_height() const { return height; }
+		/// insert rectangle of given extent and return its id or -1 if it does not fit
+		int insert(int w, int h);
+		/// remove rectangle of given id and return whether the id was in use
+		bool remove(int id);
+		/** change the extent of a rectangle. The position is kept if the rectangle still fits there, otherwise the
+			rectangle is moved to a new position. Returns false and keeps the rectangle unchanged if it does not fit. */
+		bool resize(int id, int w, int h);
+		/// enlarge the packing area without moving rectangles
+		void grow(int new_width, int new_height);
+		/** repack all rectangles in the current packing area sorted by height and return whether all rectangles fit.
+			If not, the previous packing is restored. */
+		bool defragment();
+		/// return rectangle of given id
+		const rectangle& get_rectangle(int id) const { return rectangles[id]; }
+		/// return whether the id is in use
+		bool is_used(int id) const { return id >= 0 && id < (int)in_use.size() && in_use[id]; }
+		/// return number of rectangles in use
+		size_t get_nr_rectangles() const { return rectangles.size() - free_ids.size(); }
+		/// return number of free rectangles, which increases with fragmentation
+		size_t get_nr_free_rectangles() const { return free_rectangles.size(); }
+		/// return ratio of used area to area of packing area
+		float get_occupancy() const;
+	};
+
+	/** measure the time of a churn workload with the given number of rectangles and operations on the online_packer, where each
+		operation removes, inserts or resizes a random rectangle, and compare it to packing all rectangles again with
+		pack_rectangles_iteratively after each operation. The final packing is saved to a web page whose file name starts with the prefix. */
+	extern CGV_API void analyze_online_packing(
+		const std::string& file_name_prefix,
+		unsigned nr_rectangles,
+		unsigned nr_operations,
+		PackingStrategy strategy = PS_Skyline);
+}
+
+#ifdef CGV_DIR
+#include <cgv/config/lib_end.h>
+#endif
@@ -0,0 +1,254 @@
+#include "frame_codec.h"
+#include <cstring>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace rgbd {
+
+	/// number of samples that share one rice parameter
+	static const unsigned block_size = 32;
+	/// rice parameter value that marks a block without residuals
+	static const unsigned zero_block = 15;
+	/// quotients of this size are followed by the residual in escape_bits raw bits
+	static const unsigned escape_quotient = 24;
+	static const unsigned escape_bits = 17;
+
+	static inline unsigned count_trailing_zeros(uint64_t x)
+	{
+#ifdef _MSC_VER
+		unsigned long idx;
+		_BitScanForward64(&idx, x);
+		return unsigned(idx);
+#else
+		return unsigned(__builtin_ctzll(x));
+#endif
+	}
+
+	/// bit writer that fills bytes starting with the least significant bit
+	struct bit_writer
+	{
+		std::vector<char>& out;
+		uint64_t acc;
+		unsigned nr_bits;
+		bit_writer(std::vector<char>& _out) : out(_out), acc(0), nr_bits(0) {}
+		void flush_bytes()
+		{
+			while (nr_bits >= 8) {
+				out.push_back(char(acc & 255));
+				acc >>= 8;
+				nr_bits -= 8;
+			}
+		}
+		/// write the n <= 32 least significant bits of v
+		void write(uint32_t v, unsigned n)
+		{
+			acc |= uint64_t(v) << nr_bits;
+			nr_bits += n;
+			if (nr_bits >= 32)
+				flush_bytes();
+		}
+		/// write q zeros followed by a one
+		void write_unary(unsigned q)
+		{
+			while (q >= 24) {
+				write(0, 24);
+				q -= 24;
+			}
+			write(1u << q, q + 1);
+		}
+		void finish()
+		{
+			flush_bytes();
+			if (nr_bits > 0)
+				out.push_back(char(acc & 255));
+			acc = 0;
+			nr_bits = 0;
+		}
+	};
+
+	/// bit reader matching bit_writer that pads with zeros beyond the end of the data
+	struct bit_reader
+	{
+		const unsigned char* ptr;
+		const unsigned char* end;
+		uint64_t acc;
+		unsigned nr_bits;
+		size_t nr_padded_bits;
+		bool corrupted;
+		bit_reader(const char* data, size_t size) : ptr(reinterpret_cast<const unsigned char*>(data)), end(ptr + size), acc(0), nr_bits(0), nr_padded_bits(0), corrupted(false) {}
+		void refill()
+		{
+			while (nr_bits <= 56) {
+				if (ptr < end)
+					acc |= uint64_t(*ptr++) << nr_bits;
+				else
+					nr_padded_bits += 8;
+				nr_bits += 8;
+			}
+		}
+		uint32_t read(unsigned n)
+		{
+			if (nr_bits < n)
+				refill();
+			uint32_t v = uint32_t(acc & ((uint64_t(1) << n) - 1));
+			acc >>= n;
+			nr_bits -= n;
+			return v;
+		}
+		/// read number of zeros before next one, which cannot exceed escape_quotient in valid data
+		unsigned read_unary()
+		{
+			if (nr_bits < escape_quotient + 1)
+				refill();
+			if ((acc & ((uint64_t(1) << (escape_quotient + 1)) - 1)) == 0) {
+				corrupted = true;
+				return 0;
+			}
+			unsigned q = count_trailing_zeros(acc);
+			acc >>= q + 1;
+			nr_bits -= q + 1;
+			return q;
+		}
+		/// check whether data is corrupted or more bits than available have been consumed
+		bool overrun() const { return corrupted || nr_padded_bits > nr_bits; }
+	};
+
+	static inline int predict(const uint16_t* row, const uint16_t* prev_row, unsigned x)
+	{
+		if (!prev_row)
+			return x > 0 ? row[x - 1] : 0;
+		if (x == 0)
+			return prev_row[0];
+		int a = row[x - 1], b = prev_row[x], c = prev_row[x - 1];
+		int mx = a > b ? a : b, mn = a > b ? b : a;
+		if (c >= mx)
+			return mn;
+		if (c <= mn)
+			return mx;
+		return a + b - c;
+	}
+
+	static bool supports_delta_rice16(const frame_format& ff)
+	{
+		return ff.nr_bits_per_pixel == 16 && ff.width > 0 && ff.height > 0 &&
+			ff.buffer_size == unsigned(ff.width * ff.height * 2);
+	}
+
+	FrameCompression get_default_frame_compression(const frame_format& ff)
+	{
+		switch (ff.pixel_format) {
+		case PF_I:
+		case PF_DEPTH:
+		case PF_DEPTH_AND_PLAYER:
+			if (supports_delta_rice16(ff))
+				return FC_DELTA_RICE16;
+			return FC_NONE;
+		default:
+			return FC_NONE;
+		}
+	}
+
+	bool compress_frame_data(const frame_format& ff, const char* data, FrameCompression fc, std::vector<char>& out)
+	{
+		if (fc == FC_NONE) {
+			out.insert(out.end(), data, data + ff.buffer_size);
+			return true;
+		}
+		if (fc != FC_DELTA_RICE16 || !supports_delta_rice16(ff))
+			return false;
+		const unsigned w = ff.width, h = ff.height;
+		std::vector<uint16_t> rows(2 * w);
+		uint16_t* row = &rows[0];
+		uint16_t* prev_row = 0;
+		uint32_t residuals[block_size];
+		out.reserve(out.size() + ff.buffer_size / 2);
+		bit_writer bw(out);
+		for (unsigned y = 0; y < h; ++y) {
+			// copy row to aligned buffer as frame data need not be aligned
+			memcpy(row, data + size_t(2) * w * y, 2 * w);
+			for (unsigned x0 = 0; x0 < w; x0 += block_size) {
+				unsigned n = w - x0 < block_size ? w - x0 : block_size;
+				uint32_t sum = 0;
+				for (unsigned i = 0; i < n; ++i) {
+					int r = int(row[x0 + i]) - predict(row, prev_row, x0 + i);
+					residuals[i] = (uint32_t(r) << 1) ^ uint32_t(r >> 31);
+					sum += residuals[i];
+				}
+				if (sum == 0) {
+					bw.write(zero_block, 4);
+					continue;
+				}
+				unsigned k = 0;
+				while (k < zero_block - 1 && (uint64_t(n) << (k + 1)) <= sum)
+					++k;
+				bw.write(k, 4);
+				for (unsigned i = 0; i < n; ++i) {
+					uint32_t q = residuals[i] >> k;
+					if (q >= escape_quotient) {
+						bw.write_unary(escape_quotient);
+						bw.write(residuals[i], escape_bits);
+					}
+					else {
+						bw.write_unary(q);
+						if (k > 0)
+							bw.write(residuals[i] & ((1u << k) - 1), k);
+					}
+				}
+			}
+			prev_row = row;
+			row = (row == &rows[0]) ? &rows[w] : &rows[0];
+		}
+		bw.finish();
+		return true;
+	}
+
+	bool decompress_frame_data(const frame_format& ff, const char* data, size_t size, FrameCompression fc, char* dest)
+	{
+		if (fc == FC_NONE) {
+			if (size != ff.buffer_size)
+				return false;
+			memcpy(dest, data, size);
+			return true;
+		}
+		if (fc != FC_DELTA_RICE16 || !supports_delta_rice16(ff))
+			return false;
+		const unsigned w = ff.width, h = ff.height;
+		std::vector<uint16_t> rows(2 * w);
+		uint16_t* row = &rows[0];
+		uint16_t* prev_row = 0;
+		bit_reader br(data, size);
+		for (unsigned y = 0; y < h; ++y) {
+			for (unsigned x0 = 0; x0 < w; x0 += block_size) {
+				unsigned n = w - x0 < block_size ? w - x0 : block_size;
+				unsigned k = br.read(4);
+				if (k == zero_block) {
+					for (unsigned i = 0; i < n; ++i)
+						row[x0 + i] = uint16_t(predict(row, prev_row, x0 + i));
+					continue;
+				}
+				for (unsigned i = 0; i < n; ++i) {
+					uint32_t q = br.read_unary();
+					uint32_t u;
+					if (q == escape_quotient)
+						u = br.read(escape_bits);
+					else {
+						u = q << k;
+						if (k > 0)
+							u |= br.read(k);
+					}
+					int r = int(u >> 1) ^ -int(u & 1);
+					row[x0 + i] = uint16_t(predict(row, prev_row, x0 + i) + r);
+				}
+			}
+			if (br.overrun())
+				return false;
+			memcpy(dest + size_t(2) * w * y, row, 2 * w);
+			prev_row = row;
+			row = (row == &rows[0]) ? &rows[w] : &rows[0];
+		}
+		return true;
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "rgbd_device.h"
+
+#include "lib_begin.h"
+
+namespace rgbd {
+
+	/// compression schemes supported for frames stored in a recording
+	enum FrameCompression {
+		FC_NONE = 0,
+		FC_DELTA_RICE16 = 1 // lossless delta prediction of 16 bit samples followed by block adaptive rice coding
+	};
+
+	/// return the compression that is used by default for the given frame format, which is FC_DELTA_RICE16 for 16 bit depth and infrared frames and FC_NONE otherwise
+	extern CGV_API FrameCompression get_default_frame_compression(const frame_format& ff);
+
+	/** compress the data of a frame with the given compression scheme and append result to out. Per row
+	    each 16 bit sample is predicted from its left, upper and upper left neighbor with the median edge
+		detector of LOCO-I. Residuals are zig-zag mapped and rice coded in blocks of 32 samples, where each
+		block stores its rice parameter in 4 bits and blocks without residuals are stored with the parameter
+		only. Return false if the compression scheme does not support the frame format. */
+	extern CGV_API bool compress_frame_data(const frame_format& ff, const char* data, FrameCompression fc, std::vector<char>& out);
+
+	/// decompress data of size bytes compressed with compress_frame_data into ff.buffer_size bytes at dest, return false on corrupted data
+	extern CGV_API bool decompress_frame_data(const frame_format& ff, const char* data, size_t size, FrameCompression fc, char* dest);
+}
+
+#include <cgv/config/lib_end.h>
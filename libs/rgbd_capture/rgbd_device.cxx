@@ -139,6 +139,10 @@ namespace rgbd {
 	{
 		return false;
 	}
+	bool rgbd_device::query_calibration(camera_intrinsics& depth_K, camera_intrinsics& color_K, camera_extrinsics& color_E) const
+	{
+		return false;
+	}
 
 	std::ostream& operator << (std::ostream& os, const frame_size& fs)
 	{
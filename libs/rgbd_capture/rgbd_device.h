@@ -145,6 +145,39 @@ namespace rgbd {
 		/// time stamp in milliseconds. Only present if supported by accelerometer
 		unsigned long long time_stamp;
 	};
+
+	/// pinhole camera with radial (k1,k2,k3) and tangential (p1,p2) lens distortion in the model of Brown-Conrady
+	struct CGV_API camera_intrinsics
+	{
+		/// focal lengths in pixels
+		float fx, fy;
+		/// principal point in pixels
+		float cx, cy;
+		/// radial distortion coefficients
+		float k1, k2, k3;
+		/// tangential distortion coefficients
+		float p1, p2;
+		/// construct without distortion
+		camera_intrinsics(float _fx = 525.0f, float _fy = 525.0f, float _cx = 319.5f, float _cy = 239.5f);
+		/// check for equality of all parameters
+		bool operator == (const camera_intrinsics& K) const;
+		/// apply distortion to normalized image coordinates
+		void distort(float x, float y, float& xd, float& yd) const;
+		/// compute normalized image coordinates of the ray through pixel (u,v) by iterative inversion of the distortion
+		void compute_ray(float u, float v, float& x, float& y) const;
+	};
+
+	/// rigid transformation p_color = R*p_depth + t from depth to color camera coordinates with R stored in row major order
+	struct CGV_API camera_extrinsics
+	{
+		float R[9];
+		float t[3];
+		/// construct identity
+		camera_extrinsics();
+		/// construct from unit quaternion (w,x,y,z) and translation
+		camera_extrinsics(float qw, float qx, float qy, float qz, float tx, float ty, float tz);
+		bool operator == (const camera_extrinsics& E) const;
+	};
 	/// return the preferred extension for a given frame format
 	extern CGV_API std::string get_frame_extension(const frame_format& ff);
 	/// extent file name by frame index and format based extension
@@ -186,6 +219,9 @@ namespace rgbd {
 		/// query the current measurement of the acceleration sensors within the given time_out in milliseconds; return whether a measurement has been retrieved
 		virtual bool put_IMU_measurement(IMU_measurement& m, unsigned time_out) const;
 
+		/// query the intrinsics of depth and color camera and the transformation from depth to color camera coordinates, return false if the device does not provide its calibration
+		virtual bool query_calibration(camera_intrinsics& depth_K, camera_intrinsics& color_K, camera_extrinsics& color_E) const;
+
 		/// check whether the device supports the given combination of input streams
 		virtual bool check_input_stream_configuration(InputStreams is) const = 0;
 		/// query the stream formats available for a given stream configuration
@@ -2,6 +2,7 @@
 #include "rgbd_input.h"
 
 #include <cgv/utils/file.h>
+#include <iostream>
 
 using namespace std;
 
@@ -9,32 +10,60 @@ namespace rgbd {
 
 	rgbd_emulation::rgbd_emulation(const std::string& fn)
 	{
-		file_name = fn;
-		flags = idx = 0;
+		generation = 0;
+		stop_prefetcher = false;
+		loop_duration = 0;
+		read_ahead = 4;
+		attach(fn);
+	}
+
+	rgbd_emulation::~rgbd_emulation()
+	{
+		detach();
 	}
 
 	bool rgbd_emulation::attach(const std::string& fn)
 	{
-		file_name = fn;
-		flags = idx = 0;
+		detach();
+		if (!reader.open(get_recording_file_name(fn)))
+			return false;
+		file_name = get_recording_file_name(fn);
+		loop_duration = 0;
+		unsigned is = reader.get_streams();
+		for (unsigned s = 1; s < IS_ALL; s *= 2) {
+			if ((is & s) == 0)
+				continue;
+			stream_state& S = streams[s];
+			S.position = 0;
+			S.loop = 0;
+			size_t n = reader.get_nr_frames(InputStreams(s));
+			loop_duration = std::max(loop_duration, reader.get_entry(InputStreams(s), n - 1).recording_time);
+		}
+		// add one frame period at 30 Hz between the last frame of a loop and the first of the next
+		loop_duration += 1.0 / 30;
+		playback_start = std::chrono::steady_clock::now();
 		return true;
 	}
 	bool rgbd_emulation::is_attached() const
 	{
-		return !file_name.empty();
+		return reader.is_open();
 	}
-	
+
 	bool rgbd_emulation::detach()
 	{
+		stop_prefetcher_thread();
+		reader.close();
+		streams.clear();
+		free_buffers.clear();
 		file_name = "";
 		return true;
 	}
-	
+
 	bool rgbd_emulation::set_pitch(float y)
 	{
 		return true;
 	}
-	
+
 	bool rgbd_emulation::has_IMU() const
 	{
 		return true;
@@ -54,49 +83,170 @@ namespace rgbd {
 		m.time_stamp = 0;
 		return true;
 	}
-	
+
 	bool rgbd_emulation::check_input_stream_configuration(InputStreams is) const
 	{
-		return true;
+		return (is & ~reader.get_streams()) == 0;
 	}
 	void rgbd_emulation::query_stream_formats(InputStreams is, std::vector<stream_format>& stream_formats) const
 	{
-
+		for (unsigned s = 1; s < IS_ALL; s *= 2) {
+			frame_format ff;
+			if ((is & s) == 0 || !reader.get_stream_format(InputStreams(s), ff))
+				continue;
+			// estimate frame rate from recording times
+			size_t n = reader.get_nr_frames(InputStreams(s));
+			double dt = reader.get_entry(InputStreams(s), n - 1).recording_time - reader.get_entry(InputStreams(s), 0).recording_time;
+			float fps = (n > 1 && dt > 0) ? float((n - 1) / dt) : 30.0f;
+			stream_formats.push_back(stream_format(ff.width, ff.height, ff.pixel_format, fps, ff.nr_bits_per_pixel, ff.buffer_size));
+		}
 	}
 	bool rgbd_emulation::start_device(InputStreams is, std::vector<stream_format>& stream_formats)
 	{
-		return true;
+		query_stream_formats(is, stream_formats);
+		return start_device(stream_formats);
 	}
 	bool rgbd_emulation::start_device(const std::vector<stream_format>& stream_formats)
 	{
+		if (!is_attached())
+			return false;
+		seek(0);
+		start_prefetcher();
 		return true;
 	}
 	bool rgbd_emulation::is_running() const
 	{
-		return true; 
+		return prefetcher.joinable();
 	}
 	bool rgbd_emulation::stop_device()
 	{
+		stop_prefetcher_thread();
 		return true;
 	}
-	unsigned rgbd_emulation::get_width(InputStreams) const
+	unsigned rgbd_emulation::get_width(InputStreams is) const
+	{
+		frame_format ff;
+		return reader.get_stream_format(is, ff) ? ff.width : 640;
+	}
+	unsigned rgbd_emulation::get_height(InputStreams is) const
 	{
-		return 640;
+		frame_format ff;
+		return reader.get_stream_format(is, ff) ? ff.height : 480;
 	}
-	unsigned rgbd_emulation::get_height(InputStreams) const
+	void rgbd_emulation::start_prefetcher()
 	{
-		return 480;
+		if (prefetcher.joinable())
+			return;
+		stop_prefetcher = false;
+		prefetcher = std::thread(&rgbd_emulation::prefetch_loop, this);
+	}
+	void rgbd_emulation::stop_prefetcher_thread()
+	{
+		if (!prefetcher.joinable())
+			return;
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			stop_prefetcher = true;
+		}
+		cv.notify_all();
+		prefetcher.join();
+	}
+	void rgbd_emulation::prefetch_loop()
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		while (!stop_prefetcher) {
+			// fill the cache of the stream with the fewest decoded frames
+			unsigned is = IS_NONE;
+			stream_state* S = 0;
+			for (std::map<unsigned, stream_state>::iterator it = streams.begin(); it != streams.end(); ++it)
+				if (it->second.cache.size() < read_ahead && (!S || it->second.cache.size() < S->cache.size())) {
+					S = &it->second;
+					is = it->first;
+				}
+			if (!S) {
+				cv.wait(lock);
+				continue;
+			}
+			size_t n = reader.get_nr_frames(InputStreams(is));
+			size_t pos = S->cache.empty() ? S->position : (S->cache.back().first + 1) % n;
+			unsigned gen = generation;
+			frame_type frame;
+			if (!free_buffers.empty()) {
+				frame.frame_data.swap(free_buffers.back());
+				free_buffers.pop_back();
+			}
+			lock.unlock();
+			// a frame that failed to decode keeps an empty buffer and is reported by get_frame
+			if (!reader.read_frame(InputStreams(is), pos, frame))
+				frame.frame_data.clear();
+			reader.prefetch(InputStreams(is), (pos + 1) % n, read_ahead);
+			lock.lock();
+			if (gen == generation)
+				S->cache.push_back(std::make_pair(pos, std::move(frame)));
+		}
+	}
+	void rgbd_emulation::seek(double recording_time)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		++generation;
+		for (std::map<unsigned, stream_state>::iterator it = streams.begin(); it != streams.end(); ++it) {
+			stream_state& S = it->second;
+			S.position = reader.find_frame(InputStreams(it->first), recording_time);
+			if (S.position == reader.get_nr_frames(InputStreams(it->first)))
+				S.position = 0;
+			S.loop = 0;
+			S.cache.clear();
+		}
+		playback_start = std::chrono::steady_clock::now() -
+			std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(recording_time));
+		cv.notify_all();
 	}
 	bool rgbd_emulation::get_frame(InputStreams is, frame_type& frame, int timeOut)
-	{	
-		string fn = compose_file_name(file_name, frame, frame.frame_index);
-		if (!cgv::utils::file::exists(fn)) {
-			idx = 0;
-			fn = compose_file_name(file_name, frame, 0);
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		std::map<unsigned, stream_state>::iterator it = streams.find(is);
+		if (it == streams.end())
+			return false;
+		stream_state& S = it->second;
+		// deliver frames not before their recording time relative to the playback start
+		double due = reader.get_entry(is, S.position).recording_time + S.loop * loop_duration;
+		std::chrono::steady_clock::time_point due_time = playback_start +
+			std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(due));
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (now < due_time) {
+			if (timeOut == 0)
+				return false;
+			std::chrono::steady_clock::time_point wait_time = due_time;
+			if (timeOut > 0 && now + std::chrono::milliseconds(timeOut) < due_time)
+				wait_time = now + std::chrono::milliseconds(timeOut);
+			lock.unlock();
+			std::this_thread::sleep_until(wait_time);
+			lock.lock();
+			if (std::chrono::steady_clock::now() < due_time)
+				return false;
 		}
-//		if (!rgbd_input::read_frame(fn, data_ptr, get_frame_size(ff)))
-//			return false;
-		return true;
+		bool result;
+		if (!S.cache.empty() && S.cache.front().first == S.position) {
+			frame_type& C = S.cache.front().second;
+			result = !(C.frame_data.empty() && C.buffer_size > 0);
+			static_cast<frame_info&>(frame) = C;
+			frame.frame_data.swap(C.frame_data);
+			free_buffers.push_back(std::vector<char>());
+			free_buffers.back().swap(C.frame_data);
+			S.cache.pop_front();
+		}
+		else {
+			// cache is out of sync or prefetching is not running, so decode synchronously
+			++generation;
+			S.cache.clear();
+			result = reader.read_frame(is, S.position, frame);
+		}
+		if (++S.position == reader.get_nr_frames(is)) {
+			S.position = 0;
+			++S.loop;
+		}
+		cv.notify_all();
+		return result;
 	}
 	void rgbd_emulation::map_color_to_depth(const frame_type& depth_frame, const frame_type& color_frame,
 		frame_type& warped_color_frame) const
@@ -105,4 +255,4 @@ namespace rgbd {
 	}
 
 
-}
\ No newline at end of file
+}
@@ -1,28 +1,66 @@
+#pragma once
+
 #include "rgbd_device.h"
+#include "rgbd_recording.h"
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 
 using namespace std;
 
 namespace rgbd {
 
+/** emulates an rgbd device by playing back a recording in a loop. Frames are delivered with the
+    timing of the recording. A prefetch thread decodes the next read_ahead frames of each stream
+	such that get_frame usually only needs to move a decoded frame. */
 class rgbd_emulation : public rgbd_device
 {
+protected:
+	/// playback state of one stream
+	struct stream_state
+	{
+		/// position of the next frame returned by get_frame
+		size_t position;
+		/// number of completed loops through the stream
+		unsigned loop;
+		/// decoded frames with their positions following position
+		std::deque<std::pair<size_t, frame_type> > cache;
+	};
+	rgbd_recording_reader reader;
+	std::map<unsigned, stream_state> streams;
+	/// incremented on seek such that the prefetch thread discards frames decoded for old positions
+	unsigned generation;
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::thread prefetcher;
+	bool stop_prefetcher;
+	/// frame buffers returned from get_frame that are reused by the prefetch thread
+	std::vector<std::vector<char> > free_buffers;
+	/// wall clock time corresponding to recording time 0 of the first loop
+	std::chrono::steady_clock::time_point playback_start;
+	/// duration of one loop through the recording in seconds
+	double loop_duration;
+	void prefetch_loop();
+	void start_prefetcher();
+	void stop_prefetcher_thread();
 public:
 	string file_name;
-	unsigned idx;
-	unsigned flags;
+	/// number of frames per stream decoded in advance
+	unsigned read_ahead;
 
 	rgbd_emulation(const std::string& fn);
+	~rgbd_emulation();
 
 	bool attach(const std::string& fn);
 	bool is_attached() const;
 	bool detach();
 
 	bool set_pitch(float y);
-	
-	bool has_IMU() const; 
+
+	bool has_IMU() const;
 	const IMU_info& get_IMU_info() const;
 	bool put_IMU_measurement(IMU_measurement& m, unsigned time_out) const;
-	
+
 	bool check_input_stream_configuration(InputStreams is) const;
 	void query_stream_formats(InputStreams is, std::vector<stream_format>& stream_formats) const;
 
@@ -30,13 +68,15 @@ public:
 	bool start_device(const std::vector<stream_format>& stream_formats);
 	bool is_running() const;
 	bool stop_device();
-	
+
 	unsigned get_width(InputStreams) const;
 	unsigned get_height(InputStreams) const;
 
+	/// set playback of all streams to the given recording time in seconds
+	void seek(double recording_time);
 	bool get_frame(InputStreams is, frame_type& frame, int timeOut);
 	void map_color_to_depth(const frame_type& depth_frame, const frame_type& color_frame,
 		frame_type& warped_color_frame) const;
 };
 
-}
\ No newline at end of file
+}
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <algorithm>
+#include <cstring>
 #include "rgbd_input.h"
 #include "rgbd_device_emulation.h"
 #include <cgv/utils/file.h>
@@ -80,12 +81,11 @@ rgbd_input::rgbd_input()
 {
 	rgbd = 0;
 	started = false;
-	protocol_idx = 0;
-	protocol_flags = 0;
 }
 
 rgbd_input::~rgbd_input()
 {
+	disable_protocol();
 	if (started)
 		stop();
 	if (is_attached())
@@ -128,6 +128,13 @@ bool rgbd_input::attach_path(const string& path)
 	if (is_attached())
 		detach();
 	rgbd = new rgbd_emulation(path);
+	if (!rgbd->is_attached()) {
+		cerr << "rgbd_input::attach_path could not open recording " << get_recording_file_name(path)
+			 << ", protocols of one file per frame have to be converted with convert_frame_files()" << endl;
+		delete rgbd;
+		rgbd = 0;
+		return false;
+	}
 	serial = path;
 	return true;
 }
@@ -153,17 +160,23 @@ bool rgbd_input::detach()
 
 void rgbd_input::enable_protocol(const std::string& path)
 {
+	disable_protocol();
+	if (!protocol_recorder.open(get_recording_file_name(path))) {
+		cerr << "rgbd_input::enable_protocol could not open recording " << get_recording_file_name(path) << endl;
+		return;
+	}
 	protocol_path = path;
-	protocol_idx  = 0;
-	protocol_flags = 0;
 }
 
 /// disable protocolation
 void rgbd_input::disable_protocol()
 {
+	if (protocol_recorder.is_open()) {
+		protocol_recorder.close();
+		if (protocol_recorder.get_nr_dropped_frames() > 0)
+			cerr << "rgbd_input::disable_protocol dropped " << protocol_recorder.get_nr_dropped_frames() << " frames" << endl;
+	}
 	protocol_path = "";
-	protocol_idx  = 0;
-	protocol_flags = 0;
 }
 
 
@@ -263,11 +276,9 @@ bool rgbd_input::get_frame(InputStreams is, frame_type& frame, int timeOut)
 		return false;
 	}
 	if (rgbd->get_frame(is, frame, timeOut)) {
-		if (!protocol_path.empty()) {
-			string fn = compose_file_name(protocol_path, frame, frame.frame_index);
-			if (!cgv::utils::file::write(fn, &frame.frame_data.front(), frame.frame_data.size(), false))
-				std::cerr << "rgbd_input::get_frame: could not protocol frame to " << fn << std::endl;
-		}
+		// only enqueue a copy, compression and file io happen in the writer thread of the recorder
+		if (protocol_recorder.is_open())
+			protocol_recorder.push_frame(is, frame);
 		return true;
 	}
 	return false;
@@ -284,4 +295,13 @@ void rgbd_input::map_color_to_depth(const frame_type& depth_frame, const frame_t
 	rgbd->map_color_to_depth(depth_frame, color_frame, warped_color_frame);
 }
 
+bool rgbd_input::query_calibration(camera_intrinsics& depth_K, camera_intrinsics& color_K, camera_extrinsics& color_E) const
+{
+	if (!is_attached()) {
+		cerr << "rgbd_input::query_calibration called on device that has not been attached" << endl;
+		return false;
+	}
+	return rgbd->query_calibration(depth_K, color_K, color_E);
+}
+
 }
\ No newline at end of file
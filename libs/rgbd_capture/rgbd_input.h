@@ -1,6 +1,7 @@
 #pragma once
 
 #include "rgbd_driver.h"
+#include "rgbd_recording.h"
 
 #include "lib_begin.h"
 
@@ -56,12 +57,14 @@ public:
 	static bool read_frame(const std::string& file_name, frame_type& frame);
 	/// write a frame to a file
 	static bool write_frame(const std::string& file_name, const frame_type& frame);
-	/// attach to a directory that contains saved frames
+	/// attach to a recording created by protocolation, where path is extended by get_recording_file_name(); protocols of one file per frame have to be converted with convert_frame_files() before
 	bool attach_path(const std::string& path);
-	/// enable protocolation of all frames acquired by the attached rgbd input device
+	/// enable protocolation of all frames acquired by the attached rgbd input device into the recording file get_recording_file_name(path)
 	void enable_protocol(const std::string& path);
-	/// disable protocolation
+	/// disable protocolation and finish writing the recording
 	void disable_protocol();
+	/// return the recorder used for protocolation
+	const rgbd_recorder& get_protocol_recorder() const { return protocol_recorder; }
 	//@}
 
 	/**@name base control*/
@@ -93,6 +96,8 @@ public:
 	/// map a color frame to the image coordinates of the depth image
 	void map_color_to_depth(const frame_type& depth_frame, const frame_type& color_frame,
 		frame_type& warped_color_frame) const;
+	/// query the calibration of depth and color camera, return false if the device does not provide it
+	bool query_calibration(camera_intrinsics& depth_K, camera_intrinsics& color_K, camera_extrinsics& color_E) const;
 protected:
 	/// store whether camera has been started
 	bool started;
@@ -102,10 +107,8 @@ protected:
 	rgbd_device* rgbd;
 	/// path where the frame protocol should be saved in order to create an emulation device
 	std::string protocol_path;
-	/// file index of protocol
-	int protocol_idx;
-	/// flags used to determine which frames have been saved to file for current index
-	unsigned protocol_flags;
+	/// recorder that writes protocolled frames in a background thread
+	rgbd_recorder protocol_recorder;
 };
 
 /// helper template to register a driver
@@ -0,0 +1,280 @@
+#include "rgbd_mapper.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace rgbd {
+
+camera_intrinsics::camera_intrinsics(float _fx, float _fy, float _cx, float _cy)
+	: fx(_fx), fy(_fy), cx(_cx), cy(_cy), k1(0), k2(0), k3(0), p1(0), p2(0)
+{
+}
+
+bool camera_intrinsics::operator == (const camera_intrinsics& K) const
+{
+	return fx == K.fx && fy == K.fy && cx == K.cx && cy == K.cy &&
+		k1 == K.k1 && k2 == K.k2 && k3 == K.k3 && p1 == K.p1 && p2 == K.p2;
+}
+
+void camera_intrinsics::distort(float x, float y, float& xd, float& yd) const
+{
+	float r2 = x*x + y*y;
+	float radial = 1 + r2*(k1 + r2*(k2 + r2*k3));
+	xd = x*radial + 2*p1*x*y + p2*(r2 + 2*x*x);
+	yd = y*radial + p1*(r2 + 2*y*y) + 2*p2*x*y;
+}
+
+void camera_intrinsics::compute_ray(float u, float v, float& x, float& y) const
+{
+	float x0 = (u - cx) / fx, y0 = (v - cy) / fy;
+	x = x0;
+	y = y0;
+	if (k1 == 0 && k2 == 0 && k3 == 0 && p1 == 0 && p2 == 0)
+		return;
+	// fixed point iteration of x = (x0 - tangential(x,y)) / radial(x,y)
+	for (int i = 0; i < 20; ++i) {
+		float r2 = x*x + y*y;
+		float radial = 1 + r2*(k1 + r2*(k2 + r2*k3));
+		float dx = 2*p1*x*y + p2*(r2 + 2*x*x);
+		float dy = p1*(r2 + 2*y*y) + 2*p2*x*y;
+		x = (x0 - dx) / radial;
+		y = (y0 - dy) / radial;
+	}
+}
+
+camera_extrinsics::camera_extrinsics()
+{
+	for (int i = 0; i < 9; ++i)
+		R[i] = (i % 4 == 0) ? 1.0f : 0.0f;
+	t[0] = t[1] = t[2] = 0;
+}
+
+camera_extrinsics::camera_extrinsics(float w, float x, float y, float z, float tx, float ty, float tz)
+{
+	R[0] = 1 - 2*(y*y + z*z); R[1] = 2*(x*y - w*z);     R[2] = 2*(x*z + w*y);
+	R[3] = 2*(x*y + w*z);     R[4] = 1 - 2*(x*x + z*z); R[5] = 2*(y*z - w*x);
+	R[6] = 2*(x*z - w*y);     R[7] = 2*(y*z + w*x);     R[8] = 1 - 2*(x*x + y*y);
+	t[0] = tx;
+	t[1] = ty;
+	t[2] = tz;
+}
+
+bool camera_extrinsics::operator == (const camera_extrinsics& E) const
+{
+	return memcmp(R, E.R, sizeof(R)) == 0 && memcmp(t, E.t, sizeof(t)) == 0;
+}
+
+rgbd_mapper::rgbd_mapper(unsigned _nr_threads)
+{
+	width = height = 0;
+	depth_scale = 0.001f;
+	min_depth = 0.1f;
+	max_depth = 10.0f;
+	next_row = 0;
+	pass = 0;
+	job_depth = job_color = 0;
+	job_positions = 0;
+	job_colors = 0;
+	job_pixel_indices = 0;
+	job_warped = 0;
+	nr_threads = _nr_threads == 0 ? cgv::os::ref_task_scheduler().get_nr_threads() + 1 : _nr_threads;
+	scratch.resize(nr_threads);
+}
+
+void rgbd_mapper::set_depth_camera(const camera_intrinsics& K, unsigned _width, unsigned _height, float _depth_scale)
+{
+	depth_scale = _depth_scale;
+	if (K == depth_K && _width == width && _height == height && !ray_x.empty())
+		return;
+	depth_K = K;
+	width = _width;
+	height = _height;
+	ray_x.resize(size_t(width)*height);
+	ray_y.resize(size_t(width)*height);
+	for (unsigned y = 0, i = 0; y < height; ++y)
+		for (unsigned x = 0; x < width; ++x, ++i)
+			depth_K.compute_ray(float(x), float(y), ray_x[i], ray_y[i]);
+	row_counts.resize(height);
+	row_offsets.resize(height + 1);
+	for (unsigned ti = 0; ti < nr_threads; ++ti)
+		scratch[ti].resize(5 * size_t(width));
+}
+
+void rgbd_mapper::set_color_camera(const camera_intrinsics& K, const camera_extrinsics& E)
+{
+	color_K = K;
+	color_E = E;
+}
+
+void rgbd_mapper::set_depth_range(float _min_depth, float _max_depth)
+{
+	min_depth = _min_depth;
+	max_depth = _max_depth;
+}
+
+void rgbd_mapper::process_rows(unsigned ti)
+{
+	for (unsigned y = next_row++; y < height; y = next_row++)
+		process_row(pass, y, ti);
+}
+
+void rgbd_mapper::run_pass(int _pass)
+{
+	pass = _pass;
+	next_row = 0;
+	// tasks that start after all rows have been taken return immediately
+	cgv::os::task_group team;
+	for (unsigned ti = 1; ti < nr_threads; ++ti)
+		team.run([this, ti]() { process_rows(ti); });
+	process_rows(0);
+	team.wait();
+}
+
+unsigned rgbd_mapper::compute_row_depth(unsigned y, float* Z) const
+{
+	const unsigned short* D = reinterpret_cast<const unsigned short*>(&job_depth->frame_data.front()) + size_t(y)*width;
+	// kinect style depth with player index stores depth in the upper 13 bits
+	const unsigned shift = job_depth->pixel_format == PF_DEPTH_AND_PLAYER ? 3 : 0;
+	const float s = depth_scale, lo = min_depth, hi = max_depth;
+	unsigned count = 0;
+	for (unsigned x = 0; x < width; ++x) {
+		float z = float(D[x] >> shift) * s;
+		bool valid = z >= lo && z <= hi;
+		Z[x] = valid ? z : 0.0f;
+		count += valid ? 1 : 0;
+	}
+	return count;
+}
+
+void rgbd_mapper::compute_row_points(unsigned y, float* X, float* Y, float* Z, float* U, float* V) const
+{
+	compute_row_depth(y, Z);
+	const float* rx = &ray_x[size_t(y)*width];
+	const float* ry = &ray_y[size_t(y)*width];
+	for (unsigned x = 0; x < width; ++x) {
+		X[x] = rx[x] * Z[x];
+		Y[x] = ry[x] * Z[x];
+	}
+	if (!U)
+		return;
+	const float* R = color_E.R;
+	const float* t = color_E.t;
+	const camera_intrinsics& K = color_K;
+	for (unsigned x = 0; x < width; ++x) {
+		float px = R[0]*X[x] + R[1]*Y[x] + R[2]*Z[x] + t[0];
+		float py = R[3]*X[x] + R[4]*Y[x] + R[5]*Z[x] + t[1];
+		float pz = R[6]*X[x] + R[7]*Y[x] + R[8]*Z[x] + t[2];
+		// points behind the color camera are mapped to negative coordinates
+		float iz = pz > 0 ? 1.0f / pz : 0.0f;
+		float xn = px*iz, yn = py*iz;
+		float r2 = xn*xn + yn*yn;
+		float radial = 1 + r2*(K.k1 + r2*(K.k2 + r2*K.k3));
+		float xd = xn*radial + 2*K.p1*xn*yn + K.p2*(r2 + 2*xn*xn);
+		float yd = yn*radial + K.p1*(r2 + 2*yn*yn) + 2*K.p2*xn*yn;
+		U[x] = pz > 0 ? K.fx*xd + K.cx : -1.0f;
+		V[x] = pz > 0 ? K.fy*yd + K.cy : -1.0f;
+	}
+}
+
+bool rgbd_mapper::sample_color(const frame_type& color, float u, float v, unsigned char* rgba) const
+{
+	int cx = int(u + 0.5f), cy = int(v + 0.5f);
+	if (u < -0.5f || v < -0.5f || cx >= color.width || cy >= color.height) {
+		rgba[0] = rgba[1] = rgba[2] = rgba[3] = 0;
+		return false;
+	}
+	unsigned bytes_per_pixel = color.nr_bits_per_pixel / 8;
+	const unsigned char* c = reinterpret_cast<const unsigned char*>(&color.frame_data.front()) + (size_t(cy)*color.width + cx)*bytes_per_pixel;
+	switch (color.pixel_format) {
+	case PF_RGB:
+	case PF_RGBA:
+		rgba[0] = c[0]; rgba[1] = c[1]; rgba[2] = c[2];
+		break;
+	case PF_BGR:
+	case PF_BGRA:
+		rgba[0] = c[2]; rgba[1] = c[1]; rgba[2] = c[0];
+		break;
+	default:
+		rgba[0] = rgba[1] = rgba[2] = c[0];
+		break;
+	}
+	rgba[3] = 255;
+	return true;
+}
+
+void rgbd_mapper::process_row(int _pass, unsigned y, unsigned ti)
+{
+	float* S = &scratch[ti].front();
+	float *X = S, *Y = S + width, *Z = S + 2*width, *U = S + 3*width, *V = S + 4*width;
+	if (_pass == 0) {
+		row_counts[y] = compute_row_depth(y, Z);
+		return;
+	}
+	bool with_color = job_color != 0 && (_pass == 2 || job_colors != 0);
+	compute_row_points(y, X, Y, Z, with_color ? U : 0, with_color ? V : 0);
+	if (_pass == 2) {
+		unsigned char* W = reinterpret_cast<unsigned char*>(&job_warped->frame_data.front()) + 4*size_t(y)*width;
+		for (unsigned x = 0; x < width; ++x, W += 4)
+			if (Z[x] > 0)
+				sample_color(*job_color, U[x], V[x], W);
+			else
+				W[0] = W[1] = W[2] = W[3] = 0;
+		return;
+	}
+	size_t i = row_offsets[y];
+	float* P = job_positions + 3*i;
+	for (unsigned x = 0; x < width; ++x) {
+		if (Z[x] == 0)
+			continue;
+		P[0] = X[x];
+		P[1] = Y[x];
+		P[2] = Z[x];
+		P += 3;
+		if (with_color)
+			sample_color(*job_color, U[x], V[x], job_colors + 4*i);
+		if (job_pixel_indices)
+			job_pixel_indices[i] = y*width + x;
+		++i;
+	}
+}
+
+size_t rgbd_mapper::unproject(const frame_type& depth_frame, float* positions, const frame_type* color_frame, unsigned char* colors, unsigned* pixel_indices)
+{
+	if (depth_frame.width != int(width) || depth_frame.height != int(height) || depth_frame.nr_bits_per_pixel != 16 ||
+		depth_frame.frame_data.size() < 2*get_max_nr_points())
+		return 0;
+	if (color_frame && color_frame->frame_data.size() < size_t(color_frame->width)*color_frame->height*(color_frame->nr_bits_per_pixel / 8))
+		color_frame = 0;
+	job_depth = &depth_frame;
+	job_color = color_frame;
+	job_positions = positions;
+	job_colors = colors;
+	job_pixel_indices = pixel_indices;
+	// count valid pixels per row such that rows can be written in parallel to their compacted output ranges
+	run_pass(0);
+	row_offsets[0] = 0;
+	for (unsigned y = 0; y < height; ++y)
+		row_offsets[y + 1] = row_offsets[y] + row_counts[y];
+	run_pass(1);
+	return row_offsets[height];
+}
+
+void rgbd_mapper::map_color_to_depth(const frame_type& depth_frame, const frame_type& color_frame, frame_type& warped_color_frame)
+{
+	if (depth_frame.width != int(width) || depth_frame.height != int(height) || depth_frame.nr_bits_per_pixel != 16 ||
+		depth_frame.frame_data.size() < 2*get_max_nr_points() ||
+		color_frame.frame_data.size() < size_t(color_frame.width)*color_frame.height*(color_frame.nr_bits_per_pixel / 8))
+		return;
+	static_cast<frame_info&>(warped_color_frame) = depth_frame;
+	warped_color_frame.pixel_format = PF_RGBA;
+	warped_color_frame.nr_bits_per_pixel = 32;
+	warped_color_frame.compute_buffer_size();
+	if (warped_color_frame.frame_data.size() != warped_color_frame.buffer_size)
+		warped_color_frame.frame_data.resize(warped_color_frame.buffer_size);
+	job_depth = &depth_frame;
+	job_color = &color_frame;
+	job_warped = &warped_color_frame;
+	run_pass(2);
+}
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "rgbd_device.h"
+#include <cgv/os/task_scheduler.h>
+#include <vector>
+#include <atomic>
+
+#include "lib_begin.h"
+
+namespace rgbd {
+
+/** maps depth frames to 3d points and registers color frames to them. For each depth pixel the ray
+	through the pixel is precomputed in a lookup table with separate x and y arrays, such that
+	unprojection reduces to two multiplications per pixel in loops that the compiler vectorizes.
+	Rows are processed by a team of tasks on the process wide cgv::os::task_scheduler, where each task
+	owns a preallocated scratch buffer, so that no memory is allocated per frame. Points are written to caller provided arrays with three floats
+	per position and four bytes per color, which matches the position and color arrays of point_cloud.
+	The camera_intrinsics and camera_extrinsics are declared in rgbd_device.h, such that devices can report their calibration. */
+class CGV_API rgbd_mapper
+{
+protected:
+	camera_intrinsics depth_K, color_K;
+	camera_extrinsics color_E;
+	unsigned width, height;
+	float depth_scale, min_depth, max_depth;
+	/// lookup tables of the normalized ray directions (ray_x, ray_y, 1)
+	std::vector<float> ray_x, ray_y;
+	/// number of valid pixels per row and their prefix sums
+	std::vector<size_t> row_counts, row_offsets;
+	/// per thread scratch with five floats per pixel of a row
+	std::vector<std::vector<float> > scratch;
+
+	/**@name task team*/
+	//@{
+	unsigned nr_threads;
+	std::atomic<unsigned> next_row;
+	int pass;
+	/// process rows of the current pass until all rows are taken, where ti selects the scratch buffer
+	void process_rows(unsigned ti);
+	/// run the given pass over all rows with nr_threads tasks
+	void run_pass(int _pass);
+	//@}
+
+	/**@name parameters of current job*/
+	//@{
+	const frame_type* job_depth;
+	const frame_type* job_color;
+	float* job_positions;
+	unsigned char* job_colors;
+	unsigned* job_pixel_indices;
+	frame_type* job_warped;
+	//@}
+
+	/// convert depth row into metric depth, return number of valid pixels
+	unsigned compute_row_depth(unsigned y, float* Z) const;
+	/// compute points of row y in SoA layout and if requested project them to color pixel coordinates
+	void compute_row_points(unsigned y, float* X, float* Y, float* Z, float* U, float* V) const;
+	/// read color at pixel coordinates, return false if outside of color frame
+	bool sample_color(const frame_type& color, float u, float v, unsigned char* rgba) const;
+	/// process rows of given pass in thread ti
+	void process_row(int _pass, unsigned y, unsigned ti);
+public:
+	/// construct mapper with given number of concurrent tasks, where 0 uses the threads of the scheduler plus the calling thread
+	rgbd_mapper(unsigned _nr_threads = 0);
+	/// configure depth camera and recompute lookup table if parameters changed; depth_scale converts depth values to meters
+	void set_depth_camera(const camera_intrinsics& K, unsigned _width, unsigned _height, float _depth_scale = 0.001f);
+	/// configure color camera used for registration
+	void set_color_camera(const camera_intrinsics& K, const camera_extrinsics& E);
+	/// set range of valid depth values in meters
+	void set_depth_range(float _min_depth, float _max_depth);
+	/// return the maximum number of points, which is the number of depth pixels
+	size_t get_max_nr_points() const { return size_t(width)*height; }
+	/// return the number of threads
+	unsigned get_nr_threads() const { return nr_threads; }
+	/** unproject all depth pixels in depth range in row major order. positions needs space for
+	    3*get_max_nr_points() floats. If color_frame and colors are given, each point is projected to
+		the color camera and its rgba color is written to colors, where points outside the color image
+		get alpha 0. If pixel_indices is given, it receives the linear pixel index of each point.
+		Returns the number of points. */
+	size_t unproject(const frame_type& depth_frame, float* positions, const frame_type* color_frame = 0, unsigned char* colors = 0, unsigned* pixel_indices = 0);
+	/// compute color frame of depth resolution in PF_RGBA format with the color of each depth pixel, which is reallocated only if the size changes
+	void map_color_to_depth(const frame_type& depth_frame, const frame_type& color_frame, frame_type& warped_color_frame);
+};
+
+}
+
+#include <cgv/config/lib_end.h>
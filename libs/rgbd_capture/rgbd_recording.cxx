@@ -0,0 +1,534 @@
+#include "rgbd_recording.h"
+#include <cgv/utils/file.h>
+#include <cgv/utils/scan.h>
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace rgbd {
+
+static const char header_magic[8] = { 'C', 'G', 'V', 'R', 'G', 'B', 'D', 0 };
+static const char trailer_magic[8] = { 'R', 'G', 'B', 'D', 'I', 'D', 'X', 0 };
+static const uint32_t recording_version = 1;
+
+/// header at the beginning of a recording file
+struct recording_header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t entry_size;
+};
+
+/// trailer at the end of a closed recording file
+struct recording_trailer
+{
+	uint64_t nr_entries;
+	uint64_t index_offset;
+	char magic[8];
+};
+
+std::string get_recording_file_name(const std::string& path)
+{
+	if (cgv::utils::to_lower(cgv::utils::file::get_extension(path)) == "rgbd")
+		return path;
+	return path + ".rgbd";
+}
+
+/// read a frame file of the former protocol layout, whose format is given by the file extension
+static bool read_frame_file(const std::string& fn, const frame_format& ff, frame_type& frame)
+{
+	std::string data;
+	if (!cgv::utils::file::read(fn, data, false))
+		return false;
+	const frame_info* header = reinterpret_cast<const frame_info*>(data.data());
+	if (data.size() >= sizeof(frame_info) && header->buffer_size + sizeof(frame_info) == data.size() &&
+		header->pixel_format == ff.pixel_format && header->nr_bits_per_pixel == ff.nr_bits_per_pixel) {
+		static_cast<frame_info&>(frame) = *header;
+		frame.frame_data.assign(data.begin() + sizeof(frame_info), data.end());
+		return true;
+	}
+	// raw frames were protocolled without header at the fixed resolution of the former emulation
+	static_cast<frame_format&>(frame) = ff;
+	frame.width = 640;
+	frame.height = 480;
+	frame.compute_buffer_size();
+	if (data.size() != frame.buffer_size) {
+		std::cerr << "convert_frame_files: unexpected size of frame file " << fn << std::endl;
+		return false;
+	}
+	frame.frame_data.assign(data.begin(), data.end());
+	return true;
+}
+
+size_t convert_frame_files(const std::string& path, const std::string& file_name)
+{
+	// find the formats of which a first frame file exists, where confidence frames have no file extension
+	std::vector<frame_format> formats;
+	static const unsigned bit_depths[] = { 8, 16, 24, 32 };
+	for (int pf = PF_I; pf <= PF_DEPTH_AND_PLAYER; ++pf)
+		for (unsigned b = 0; b < 4; ++b) {
+			frame_format ff;
+			ff.width = 640;
+			ff.height = 480;
+			ff.pixel_format = PixelFormat(pf);
+			ff.nr_bits_per_pixel = bit_depths[b];
+			ff.compute_buffer_size();
+			if (cgv::utils::file::exists(compose_file_name(path, ff, 0)))
+				formats.push_back(ff);
+		}
+	if (formats.empty())
+		return 0;
+	rgbd_recorder recorder;
+	if (!recorder.open(file_name))
+		return 0;
+	size_t nr_frames = 0;
+	frame_type frame;
+	for (unsigned idx = 0; ; ++idx) {
+		bool found = false;
+		for (size_t i = 0; i < formats.size(); ++i) {
+			std::string fn = compose_file_name(path, formats[i], idx);
+			if (!cgv::utils::file::exists(fn))
+				continue;
+			found = true;
+			if (!read_frame_file(fn, formats[i], frame))
+				continue;
+			frame.frame_index = idx;
+			frame.time = idx / 30.0;
+			InputStreams is = IS_COLOR;
+			if (frame.pixel_format == PF_DEPTH || frame.pixel_format == PF_DEPTH_AND_PLAYER)
+				is = IS_DEPTH;
+			else if (frame.pixel_format == PF_I)
+				is = IS_INFRARED;
+			if (recorder.append_frame(is, frame, idx / 30.0))
+				++nr_frames;
+		}
+		if (!found)
+			break;
+	}
+	if (!recorder.close())
+		return 0;
+	return nr_frames;
+}
+
+rgbd_recorder::rgbd_recorder(unsigned queue_capacity)
+	: enqueue_pos(0), dequeue_pos(0), stop_requested(false), write_failed(false),
+	  nr_written_frames(0), nr_dropped_frames(0), nr_raw_bytes(0), nr_written_bytes(0), fp(0), file_offset(0)
+{
+	size_t capacity = 2;
+	while (capacity < queue_capacity)
+		capacity *= 2;
+	slots.reset(new slot[capacity]);
+	mask = capacity - 1;
+	for (size_t i = 0; i < capacity; ++i)
+		slots[i].sequence = i;
+}
+
+rgbd_recorder::~rgbd_recorder()
+{
+	close();
+}
+
+bool rgbd_recorder::write_data(const void* data, size_t size)
+{
+	if (size > 0 && fwrite(data, 1, size, fp) != size) {
+		write_failed = true;
+		return false;
+	}
+	file_offset += size;
+	return true;
+}
+
+bool rgbd_recorder::open(const std::string& _file_name)
+{
+	close();
+	fp = fopen(_file_name.c_str(), "wb");
+	if (!fp)
+		return false;
+	// large stdio buffer such that records are written in few system calls
+	setvbuf(fp, 0, _IOFBF, 1 << 20);
+	file_name = _file_name;
+	file_offset = 0;
+	// reset queue, which is not accessed concurrently as long as push_frame is not called during open
+	enqueue_pos = 0;
+	dequeue_pos = 0;
+	for (size_t i = 0; i <= mask; ++i)
+		slots[i].sequence = i;
+	index.clear();
+	write_failed = false;
+	nr_written_frames = 0;
+	nr_dropped_frames = 0;
+	nr_raw_bytes = 0;
+	nr_written_bytes = 0;
+	recording_header header;
+	memcpy(header.magic, header_magic, 8);
+	header.version = recording_version;
+	header.entry_size = sizeof(recording_index_entry);
+	if (!write_data(&header, sizeof(header))) {
+		fclose(fp);
+		fp = 0;
+		return false;
+	}
+	start_time = std::chrono::steady_clock::now();
+	stop_requested = false;
+	writer = std::thread(&rgbd_recorder::writer_loop, this);
+	return true;
+}
+
+bool rgbd_recorder::is_open() const
+{
+	return fp != 0;
+}
+
+bool rgbd_recorder::push_frame(InputStreams is, const frame_type& frame)
+{
+	return enqueue_frame(is, frame, std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count(), false);
+}
+
+bool rgbd_recorder::append_frame(InputStreams is, const frame_type& frame, double recording_time)
+{
+	return enqueue_frame(is, frame, recording_time, true);
+}
+
+bool rgbd_recorder::enqueue_frame(InputStreams is, const frame_type& frame, double recording_time, bool blocking)
+{
+	if (!fp || stop_requested)
+		return false;
+	size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+	slot* s;
+	for (;;) {
+		s = &slots[pos & mask];
+		size_t seq = s->sequence.load(std::memory_order_acquire);
+		std::ptrdiff_t dif = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+		if (dif == 0) {
+			if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (dif < 0) {
+			if (!blocking) {
+				++nr_dropped_frames;
+				return false;
+			}
+			// wait for the writer thread to free the slot
+			std::this_thread::yield();
+			pos = enqueue_pos.load(std::memory_order_relaxed);
+		}
+		else
+			pos = enqueue_pos.load(std::memory_order_relaxed);
+	}
+	// copy reuses the frame buffer of the slot once it has been allocated
+	s->stream = is;
+	s->recording_time = recording_time;
+	static_cast<frame_info&>(s->frame) = frame;
+	s->frame.frame_data.assign(frame.frame_data.begin(), frame.frame_data.end());
+	s->frame.buffer_size = unsigned(frame.frame_data.size());
+	s->sequence.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+bool rgbd_recorder::write_record(const slot& s)
+{
+	recording_index_entry entry;
+	memset(&entry, 0, sizeof(entry));
+	entry.stream = s.stream;
+	entry.info = s.frame;
+	entry.recording_time = s.recording_time;
+	FrameCompression fc = get_default_frame_compression(s.frame);
+	buffer.clear();
+	if (!s.frame.frame_data.empty() && !compress_frame_data(s.frame, &s.frame.frame_data.front(), fc, buffer)) {
+		fc = FC_NONE;
+		buffer.assign(s.frame.frame_data.begin(), s.frame.frame_data.end());
+	}
+	entry.compression = fc;
+	entry.offset = file_offset + sizeof(entry);
+	entry.size = buffer.size();
+	if (!write_data(&entry, sizeof(entry)) || !write_data(buffer.data(), buffer.size()))
+		return false;
+	index.push_back(entry);
+	++nr_written_frames;
+	nr_raw_bytes += s.frame.frame_data.size();
+	nr_written_bytes += buffer.size();
+	return true;
+}
+
+void rgbd_recorder::writer_loop()
+{
+	for (;;) {
+		slot& s = slots[dequeue_pos & mask];
+		if (s.sequence.load(std::memory_order_acquire) == dequeue_pos + 1) {
+			if (!write_failed)
+				write_record(s);
+			s.sequence.store(dequeue_pos + mask + 1, std::memory_order_release);
+			++dequeue_pos;
+			continue;
+		}
+		if (stop_requested) {
+			// producers that won a slot before the stop request may still be copying
+			if (enqueue_pos.load(std::memory_order_acquire) == dequeue_pos)
+				break;
+			std::this_thread::yield();
+			continue;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+bool rgbd_recorder::close()
+{
+	if (!fp)
+		return true;
+	stop_requested = true;
+	if (writer.joinable())
+		writer.join();
+	recording_trailer trailer;
+	trailer.nr_entries = index.size();
+	trailer.index_offset = file_offset;
+	memcpy(trailer.magic, trailer_magic, 8);
+	if (!index.empty())
+		write_data(&index.front(), index.size() * sizeof(recording_index_entry));
+	write_data(&trailer, sizeof(trailer));
+	if (fclose(fp) != 0)
+		write_failed = true;
+	fp = 0;
+	if (write_failed)
+		std::cerr << "rgbd_recorder::close: failed to write recording " << file_name << std::endl;
+	return !write_failed;
+}
+
+rgbd_recording_reader::rgbd_recording_reader() : data(0), size(0)
+{
+#ifdef _WIN32
+	file_handle = mapping_handle = 0;
+#else
+	fd = -1;
+#endif
+}
+
+rgbd_recording_reader::~rgbd_recording_reader()
+{
+	close();
+}
+
+bool rgbd_recording_reader::open(const std::string& file_name)
+{
+	close();
+#ifdef _WIN32
+	HANDLE fh = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+	if (fh == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(fh, &file_size) || file_size.QuadPart < LONGLONG(sizeof(recording_header))) {
+		CloseHandle(fh);
+		return false;
+	}
+	HANDLE mh = CreateFileMappingA(fh, 0, PAGE_READONLY, 0, 0, 0);
+	if (!mh) {
+		CloseHandle(fh);
+		return false;
+	}
+	data = reinterpret_cast<const char*>(MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0));
+	if (!data) {
+		CloseHandle(mh);
+		CloseHandle(fh);
+		return false;
+	}
+	file_handle = fh;
+	mapping_handle = mh;
+	size = uint64_t(file_size.QuadPart);
+#else
+	fd = ::open(file_name.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < off_t(sizeof(recording_header))) {
+		::close(fd);
+		fd = -1;
+		return false;
+	}
+	void* ptr = mmap(0, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	if (ptr == MAP_FAILED) {
+		::close(fd);
+		fd = -1;
+		return false;
+	}
+	data = reinterpret_cast<const char*>(ptr);
+	size = uint64_t(st.st_size);
+#endif
+	recording_header header;
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, header_magic, 8) != 0 || header.version != recording_version ||
+		header.entry_size != sizeof(recording_index_entry)) {
+		close();
+		return false;
+	}
+	if (!read_index())
+		scan_records();
+	for (size_t i = 0; i < entries.size(); ++i)
+		stream_entries[entries[i].stream].push_back(i);
+	return true;
+}
+
+bool rgbd_recording_reader::read_index()
+{
+	if (size < sizeof(recording_header) + sizeof(recording_trailer))
+		return false;
+	recording_trailer trailer;
+	memcpy(&trailer, data + size - sizeof(trailer), sizeof(trailer));
+	if (memcmp(trailer.magic, trailer_magic, 8) != 0)
+		return false;
+	uint64_t index_size = trailer.nr_entries * sizeof(recording_index_entry);
+	if (trailer.index_offset < sizeof(recording_header) || trailer.index_offset + index_size + sizeof(trailer) != size)
+		return false;
+	entries.resize(size_t(trailer.nr_entries));
+	if (!entries.empty())
+		memcpy(&entries.front(), data + trailer.index_offset, size_t(index_size));
+	for (size_t i = 0; i < entries.size(); ++i)
+		if (entries[i].offset + entries[i].size > trailer.index_offset) {
+			entries.clear();
+			return false;
+		}
+	return true;
+}
+
+void rgbd_recording_reader::scan_records()
+{
+	entries.clear();
+	uint64_t offset = sizeof(recording_header);
+	while (offset + sizeof(recording_index_entry) <= size) {
+		recording_index_entry entry;
+		memcpy(&entry, data + offset, sizeof(entry));
+		if (entry.offset != offset + sizeof(entry) || entry.offset + entry.size > size)
+			break;
+		entries.push_back(entry);
+		offset = entry.offset + entry.size;
+	}
+	if (!entries.empty())
+		std::cerr << "rgbd_recording_reader: recovered " << entries.size() << " frames from recording without index" << std::endl;
+}
+
+bool rgbd_recording_reader::is_open() const
+{
+	return data != 0;
+}
+
+void rgbd_recording_reader::close()
+{
+	if (data) {
+#ifdef _WIN32
+		UnmapViewOfFile(data);
+#else
+		munmap(const_cast<char*>(data), size_t(size));
+#endif
+	}
+#ifdef _WIN32
+	if (mapping_handle)
+		CloseHandle(mapping_handle);
+	if (file_handle)
+		CloseHandle(file_handle);
+	file_handle = mapping_handle = 0;
+#else
+	if (fd >= 0)
+		::close(fd);
+	fd = -1;
+#endif
+	data = 0;
+	size = 0;
+	entries.clear();
+	stream_entries.clear();
+}
+
+size_t rgbd_recording_reader::get_nr_frames(InputStreams is) const
+{
+	std::map<unsigned, std::vector<size_t> >::const_iterator it = stream_entries.find(is);
+	return it == stream_entries.end() ? 0 : it->second.size();
+}
+
+InputStreams rgbd_recording_reader::get_streams() const
+{
+	unsigned is = IS_NONE;
+	for (std::map<unsigned, std::vector<size_t> >::const_iterator it = stream_entries.begin(); it != stream_entries.end(); ++it)
+		is |= it->first;
+	return InputStreams(is);
+}
+
+const recording_index_entry* rgbd_recording_reader::find_entry(InputStreams is, size_t i) const
+{
+	std::map<unsigned, std::vector<size_t> >::const_iterator it = stream_entries.find(is);
+	if (it == stream_entries.end() || i >= it->second.size())
+		return 0;
+	return &entries[it->second[i]];
+}
+
+bool rgbd_recording_reader::get_stream_format(InputStreams is, frame_format& ff) const
+{
+	const recording_index_entry* e = find_entry(is, 0);
+	if (!e)
+		return false;
+	ff = e->info;
+	return true;
+}
+
+const recording_index_entry& rgbd_recording_reader::get_entry(InputStreams is, size_t i) const
+{
+	return *find_entry(is, i);
+}
+
+size_t rgbd_recording_reader::find_frame(InputStreams is, double recording_time) const
+{
+	std::map<unsigned, std::vector<size_t> >::const_iterator it = stream_entries.find(is);
+	if (it == stream_entries.end())
+		return 0;
+	const std::vector<size_t>& E = it->second;
+	size_t lo = 0, hi = E.size();
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+		if (entries[E[mid]].recording_time < recording_time)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+bool rgbd_recording_reader::read_frame(InputStreams is, size_t i, frame_type& frame) const
+{
+	const recording_index_entry* e = find_entry(is, i);
+	if (!e)
+		return false;
+	static_cast<frame_info&>(frame) = e->info;
+	frame.frame_data.resize(e->info.buffer_size);
+	if (e->info.buffer_size == 0)
+		return true;
+	return decompress_frame_data(e->info, data + e->offset, size_t(e->size), FrameCompression(e->compression), &frame.frame_data.front());
+}
+
+void rgbd_recording_reader::prefetch(InputStreams is, size_t i, size_t count) const
+{
+	const recording_index_entry* first = find_entry(is, i);
+	if (!first || count == 0)
+		return;
+	size_t n = get_nr_frames(is);
+	const recording_index_entry* last = find_entry(is, std::min(i + count, n) - 1);
+	uint64_t begin = first->offset, end = last->offset + last->size;
+#ifdef _WIN32
+	// touch one byte per page such that the pages are read in by the calling thread
+	volatile char sum = 0;
+	for (uint64_t o = begin; o < end; o += 4096)
+		sum += data[o];
+#else
+	// madvise requires page aligned addresses
+	uint64_t page_size = uint64_t(sysconf(_SC_PAGESIZE));
+	begin -= begin % page_size;
+	madvise(const_cast<char*>(data + begin), size_t(end - begin), MADV_WILLNEED);
+#endif
+}
+
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "frame_codec.h"
+#include <map>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+
+#include "lib_begin.h"
+
+namespace rgbd {
+
+/** entry of the frame index of a recording. A recording file starts with a header followed by one
+	record per frame that consists of the index entry and the compressed frame data. On close the
+	complete index and a trailer that points to it are appended, such that a reader can access all
+	frames without scanning the file. Recordings without trailer are recovered by scanning the records. */
+struct recording_index_entry
+{
+	/// input stream of the frame
+	uint32_t stream;
+	/// compression of frame data, one of FrameCompression
+	uint32_t compression;
+	/// format, index and time of the frame, where buffer_size is the uncompressed size
+	frame_info info;
+	/// time in seconds since the recording has been opened at which the frame was received
+	double recording_time;
+	/// file offset of compressed frame data
+	uint64_t offset;
+	/// size of compressed frame data in bytes
+	uint64_t size;
+};
+
+/// return the file name of the recording for the given protocol path, which appends the extension ".rgbd" if not present
+extern CGV_API std::string get_recording_file_name(const std::string& path);
+
+/** convert a protocol in the former layout of one file per frame, where frame i of a stream is stored in
+	compose_file_name(path, format, i), into the recording file_name. Frame files with a frame_info header
+	as written by rgbd_input::write_frame are supported as well as raw frames of 640x480 pixels, whose format
+	is derived from the file extension. Frames are timed at 30 Hz. Returns the number of converted frames. */
+extern CGV_API size_t convert_frame_files(const std::string& path, const std::string& file_name);
+
+/** records frames of several input streams into a single file. Frames are copied into a bounded
+	lock-free queue by push_frame, which never blocks the capture thread. A background thread
+	compresses the queued frames and appends them to the file. */
+class CGV_API rgbd_recorder
+{
+protected:
+	/// queue slot with sequence number as in the bounded queue of D. Vyukov
+	struct slot
+	{
+		std::atomic<size_t> sequence;
+		InputStreams stream;
+		double recording_time;
+		frame_type frame;
+	};
+	/// ring buffer of slots, whose size is a power of two
+	std::unique_ptr<slot[]> slots;
+	size_t mask;
+	std::atomic<size_t> enqueue_pos;
+	/// only accessed by the writer thread
+	size_t dequeue_pos;
+	std::thread writer;
+	std::atomic<bool> stop_requested;
+	std::atomic<bool> write_failed;
+	std::atomic<size_t> nr_written_frames;
+	std::atomic<size_t> nr_dropped_frames;
+	std::atomic<uint64_t> nr_raw_bytes;
+	std::atomic<uint64_t> nr_written_bytes;
+	FILE* fp;
+	std::string file_name;
+	uint64_t file_offset;
+	std::vector<recording_index_entry> index;
+	std::vector<char> buffer;
+	std::chrono::steady_clock::time_point start_time;
+	/// write given data to file and update offset
+	bool write_data(const void* data, size_t size);
+	/// compress frame of slot and append it as record
+	bool write_record(const slot& s);
+	/// function executed by the writer thread
+	void writer_loop();
+	/// enqueue a copy of the frame with the given recording time, if blocking wait for a free slot instead of dropping the frame
+	bool enqueue_frame(InputStreams is, const frame_type& frame, double recording_time, bool blocking);
+public:
+	/// construct recorder whose queue holds up to the given number of frames, which is rounded up to a power of two
+	rgbd_recorder(unsigned queue_capacity = 64);
+	/// close recording if open
+	~rgbd_recorder();
+	/// open a recording file and start the writer thread
+	bool open(const std::string& file_name);
+	/// check whether recording is open
+	bool is_open() const;
+	/// return file name of the recording
+	const std::string& get_file_name() const { return file_name; }
+	/// enqueue a copy of the frame without blocking, return false if the recorder is not open or the frame has been dropped due to a full queue
+	bool push_frame(InputStreams is, const frame_type& frame);
+	/// enqueue a copy of the frame with a given recording time in seconds and wait for a free slot if the queue is full, used to convert existing frames
+	bool append_frame(InputStreams is, const frame_type& frame, double recording_time);
+	/// write all queued frames, append index and close file, return false if a write failed
+	bool close();
+	/// return number of frames written to file
+	size_t get_nr_written_frames() const { return nr_written_frames; }
+	/// return number of frames dropped because the queue was full
+	size_t get_nr_dropped_frames() const { return nr_dropped_frames; }
+	/// return number of uncompressed frame bytes written
+	uint64_t get_nr_raw_bytes() const { return nr_raw_bytes; }
+	/// return number of compressed frame bytes written
+	uint64_t get_nr_written_bytes() const { return nr_written_bytes; }
+};
+
+/** provides seekable read access to a recording through a read only memory mapping of the file.
+	All const member functions can be called concurrently from several threads. */
+class CGV_API rgbd_recording_reader
+{
+protected:
+	const char* data;
+	uint64_t size;
+#ifdef _WIN32
+	void* file_handle;
+	void* mapping_handle;
+#else
+	int fd;
+#endif
+	std::vector<recording_index_entry> entries;
+	/// per stream the indices of its entries in recording order
+	std::map<unsigned, std::vector<size_t> > stream_entries;
+	/// read the index from the trailer, return false if trailer is missing or invalid
+	bool read_index();
+	/// reconstruct index by scanning all records
+	void scan_records();
+	/// return pointer to index entry of i-th frame of stream or 0 if not available
+	const recording_index_entry* find_entry(InputStreams is, size_t i) const;
+public:
+	/// construct closed reader
+	rgbd_recording_reader();
+	/// close file
+	~rgbd_recording_reader();
+	/// map recording file to memory and read index
+	bool open(const std::string& file_name);
+	/// check whether a recording is open
+	bool is_open() const;
+	/// unmap file
+	void close();
+	/// return the total number of frames of all streams
+	size_t get_nr_frames() const { return entries.size(); }
+	/// return the number of frames of the given stream
+	size_t get_nr_frames(InputStreams is) const;
+	/// return the streams contained in the recording
+	InputStreams get_streams() const;
+	/// return the format of the first frame of given stream, return false if stream not recorded
+	bool get_stream_format(InputStreams is, frame_format& ff) const;
+	/// return the index entry of the i-th frame of the given stream
+	const recording_index_entry& get_entry(InputStreams is, size_t i) const;
+	/// return the position of the first frame of the given stream recorded at or after the given recording time
+	size_t find_frame(InputStreams is, double recording_time) const;
+	/// decompress the i-th frame of the given stream, return false if not available or corrupted
+	bool read_frame(InputStreams is, size_t i, frame_type& frame) const;
+	/// advise the operating system to page in the compressed data of count frames of the given stream starting at position i
+	void prefetch(InputStreams is, size_t i, size_t count) const;
+};
+
+}
+
+#include <cgv/config/lib_end.h>
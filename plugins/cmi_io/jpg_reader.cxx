@@ -1,7 +1,12 @@
 #include "jpg_reader.h"
 #include <cgv/base/register.h>
 #include <cgv/base/import.h>
+#include <cgv/type/variant.h>
+#include <cgv/media/image/image_proc.h>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <string.h>
 
 METHODDEF(void) my_error_exit (j_common_ptr cinfo)
 {
@@ -16,9 +21,71 @@ METHODDEF(void) my_error_exit (j_common_ptr cinfo)
 	longjmp(myerr->setjmp_buffer, 1);
 }
 
+/// jpeg source manager reading from a memory block
+static void init_memory_source(j_decompress_ptr) {}
+static boolean fill_memory_input_buffer(j_decompress_ptr cinfo)
+{
+	// insert an end of image marker for truncated data
+	static const JOCTET eoi[2] = { 0xFF, JPEG_EOI };
+	cinfo->src->next_input_byte = eoi;
+	cinfo->src->bytes_in_buffer = 2;
+	return TRUE;
+}
+static void skip_memory_input_data(j_decompress_ptr cinfo, long num_bytes)
+{
+	if (num_bytes <= 0)
+		return;
+	if (size_t(num_bytes) > cinfo->src->bytes_in_buffer)
+		fill_memory_input_buffer(cinfo);
+	else {
+		cinfo->src->next_input_byte += num_bytes;
+		cinfo->src->bytes_in_buffer -= num_bytes;
+	}
+}
+static void term_memory_source(j_decompress_ptr) {}
+
+/** decode the jpeg stream of a band and copy nr_rows rows starting at row skip_rows and the columns [x, x+w) to 
+    dst_ptr. Kept free of objects with destructors because errors return via longjmp. */
+static bool decode_band(const unsigned char* stream, size_t size, unsigned skip_rows, unsigned nr_rows,
+	unsigned x, unsigned w, unsigned entry_size, unsigned char* line_ptr, unsigned char* dst_ptr, size_t dst_step)
+{
+	jpeg_decompress_struct cinfo;
+	my_error_mgr jerr;
+	jpeg_source_mgr src;
+	cinfo.err = jpeg_std_error(&jerr.pub);
+	jerr.pub.error_exit = my_error_exit;
+	if (setjmp(jerr.setjmp_buffer)) {
+		jpeg_destroy_decompress(&cinfo);
+		return false;
+	}
+	jpeg_create_decompress(&cinfo);
+	src.init_source = init_memory_source;
+	src.fill_input_buffer = fill_memory_input_buffer;
+	src.skip_input_data = skip_memory_input_data;
+	src.resync_to_restart = jpeg_resync_to_restart;
+	src.term_source = term_memory_source;
+	src.next_input_byte = stream;
+	src.bytes_in_buffer = size;
+	cinfo.src = &src;
+	jpeg_read_header(&cinfo, TRUE);
+	jpeg_start_decompress(&cinfo);
+	bool direct = x == 0 && w == cinfo.output_width;
+	for (unsigned r = 0; r < skip_rows + nr_rows; ++r) {
+		unsigned char* row_ptr = (r >= skip_rows && direct) ? dst_ptr + (r - skip_rows)*dst_step : line_ptr;
+		jpeg_read_scanlines(&cinfo, &row_ptr, 1);
+		if (r >= skip_rows && !direct)
+			memcpy(dst_ptr + (r - skip_rows)*dst_step, line_ptr + x*entry_size, w*entry_size);
+	}
+	// remaining rows of the band only provide context and are not decoded
+	jpeg_destroy_decompress(&cinfo);
+	return true;
+}
+
 /// default constructor
 jpg_reader::jpg_reader() : fp(0)
 {
+	nr_threads = 0;
+	layout_status = 0;
 }
 
 /// close file in destructor
@@ -47,6 +114,30 @@ abst_image_reader* jpg_reader::clone() const
 	return new jpg_reader();
 }
 
+/// return the property declarations, which allow to set the number of decoding threads
+std::string jpg_reader::get_property_declarations()
+{
+	return "nr_threads:uint32";
+}
+
+/// set the number of parallel decoding tasks with property nr_threads, where 0 uses cgv::os::get_nr_parallel_threads()
+bool jpg_reader::set_void(const std::string& property, const std::string& value_type, const void* value_ptr)
+{
+	if (property != "nr_threads")
+		return false;
+	nr_threads = cgv::type::variant<cgv::type::uint32_type>::get(value_type, value_ptr);
+	return true;
+}
+
+/// query the number of decoding threads
+bool jpg_reader::get_void(const std::string& property, const std::string& value_type, void* value_ptr)
+{
+	if (property != "nr_threads")
+		return false;
+	cgv::type::set_variant(cgv::type::uint32_type(nr_threads), value_type, value_ptr);
+	return true;
+}
+
 /// return a string containing a colon separated list of extensions that can be read with this reader
 const char* jpg_reader::get_supported_extensions() const
 {
@@ -54,8 +145,11 @@ const char* jpg_reader::get_supported_extensions() const
 }
 
 /// open the file and read the image header in order to determine the data format
-bool jpg_reader::open(const std::string& file_name, data_format& df, std::vector<data_format>* palette_formats)
+bool jpg_reader::open(const std::string& _file_name, data_format& df, std::vector<data_format>* palette_formats)
 {
+	file_name = _file_name;
+	layout_status = 0;
+
 	/* In this example we want to open the input file before doing anything else,
 	* so that the setjmp() error recovery below can assume the file is open.
 	* VERY IMPORTANT: use "b" option to fopen() if you are on a machine that
@@ -145,6 +239,9 @@ bool jpg_reader::read_line(const data_format& df, const data_view& dv)
 /// read the whole image into the given data pointer, set data format if not yet specified and allocate the data ptr if not yet done. If image file has not been opened yet, open it and close it after reading
 bool jpg_reader::read_image(const data_format& df, const data_view& dv)
 {
+	// with a single thread the segments are not faster than the sequential decoding
+	if (cgv::os::get_nr_parallel_threads(nr_threads) > 1 && cinfo.output_scanline == 0 && supports_region_read() && read_segments(df, 0, 0, dv))
+		return true;
 	bool success = true;
 	if (setjmp(jerr.setjmp_buffer))
 		return false;
@@ -164,7 +261,9 @@ bool jpg_reader::close()
 		fp = 0;
 		return false;
 	}
-	jpeg_finish_decompress(&cinfo);
+	// finishing requires all scanlines to be read, what is not the case after region reads
+	if (cinfo.output_scanline >= cinfo.output_height)
+		jpeg_finish_decompress(&cinfo);
 	jpeg_destroy_decompress(&cinfo);
 
 	int res = fclose(fp);
@@ -173,4 +272,179 @@ bool jpg_reader::close()
 	return res == 0;
 }
 
+/// regions of files with MCU row aligned restart intervals are decoded from the intersecting segments only
+bool jpg_reader::supports_region_read() const
+{
+	if (!fp || layout_status < 0 || cinfo.restart_interval == 0 || cinfo.progressive_mode || cinfo.comps_in_scan != cinfo.num_components)
+		return false;
+	// restart intervals start MCU rows every rows_per_segment rows, which is the least common multiple divided by the row length
+	unsigned a = cinfo.restart_interval, b = cinfo.MCUs_per_row;
+	while (b != 0) {
+		unsigned t = a % b;
+		a = b;
+		b = t;
+	}
+	return cinfo.restart_interval / a < cinfo.MCU_rows_in_scan;
+}
+
+/// analyze the restart markers of the opened file
+bool jpg_reader::analyze_restart_layout()
+{
+	if (layout_status != 0)
+		return layout_status > 0;
+	layout_status = -1;
+	layout.data.clear();
+	layout.restart_offsets.clear();
+	layout.segment_rows.clear();
+	layout.segment_markers.clear();
+	FILE* fp_data = cgv::base::open_data_file(file_name.c_str(), "rb");
+	if (!fp_data)
+		return false;
+	fseek(fp_data, 0, SEEK_END);
+	long size = ftell(fp_data);
+	fseek(fp_data, 0, SEEK_SET);
+	if (size > 4) {
+		layout.data.resize(size);
+		if (fread(&layout.data[0], 1, size, fp_data) != size_t(size))
+			layout.data.clear();
+	}
+	fclose(fp_data);
+	const std::vector<unsigned char>& d = layout.data;
+	if (d.size() < 4 || d[0] != 0xFF || d[1] != 0xD8)
+		return false;
+
+	// walk through the marker segments up to the start of scan, accepting only baseline and extended sequential frames
+	size_t pos = 2;
+	layout.height_offset = 0;
+	while (true) {
+		while (pos + 1 < d.size() && d[pos] == 0xFF && d[pos + 1] == 0xFF)
+			++pos;
+		if (pos + 4 > d.size() || d[pos] != 0xFF)
+			return false;
+		unsigned char marker = d[pos + 1];
+		size_t length = (size_t(d[pos + 2]) << 8) + d[pos + 3];
+		if (marker == 0xC0 || marker == 0xC1)
+			layout.height_offset = pos + 5;
+		else if (marker >= 0xC2 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+			return false;
+		pos += 2 + length;
+		if (marker == 0xDA)
+			break;
+	}
+	if (layout.height_offset == 0 || layout.height_offset + 2 > d.size() ||
+		(unsigned(d[layout.height_offset]) << 8) + d[layout.height_offset + 1] != cinfo.image_height)
+		return false;
+	layout.scan_begin = pos;
+
+	// find restart markers in the entropy coded data, skipping stuffed zero bytes and fill bytes
+	layout.scan_end = d.size();
+	while (pos + 1 < d.size()) {
+		const unsigned char* p = static_cast<const unsigned char*>(memchr(&d[pos], 0xFF, d.size() - pos - 1));
+		if (!p)
+			break;
+		pos = p - &d[0];
+		unsigned char marker = d[pos + 1];
+		if (marker == 0x00 || marker == 0xFF)
+			pos += marker == 0x00 ? 2 : 1;
+		else if (marker >= 0xD0 && marker <= 0xD7) {
+			layout.restart_offsets.push_back(pos);
+			pos += 2;
+		}
+		else {
+			layout.scan_end = pos;
+			break;
+		}
+	}
+	// files with further scans cannot be split
+	if (layout.scan_end + 1 >= d.size() || d[layout.scan_end + 1] != 0xD9)
+		return false;
+
+	// segments start at MCU rows that coincide with the end of a restart interval
+	unsigned mcu_rows = cinfo.MCU_rows_in_scan;
+	layout.mcu_height = cinfo.comps_in_scan == 1 ? DCTSIZE : cinfo.max_v_samp_factor*DCTSIZE;
+	for (unsigned row = 0; row < mcu_rows; ++row) {
+		size_t mcu = size_t(row)*cinfo.MCUs_per_row;
+		if (mcu % cinfo.restart_interval != 0)
+			continue;
+		int marker = int(mcu / cinfo.restart_interval) - 1;
+		if (marker >= int(layout.restart_offsets.size()))
+			break;
+		layout.segment_rows.push_back(row);
+		layout.segment_markers.push_back(marker);
+	}
+	layout.segment_rows.push_back(mcu_rows);
+	if (layout.segment_markers.size() < 2)
+		return false;
+	layout_status = 1;
+	return true;
+}
+
+/// decode the rows of the region from the segments intersecting it in parallel
+bool jpg_reader::read_segments(const data_format& df, unsigned x, unsigned y, const data_view& dv)
+{
+	if (!analyze_restart_layout())
+		return false;
+	const jpeg_restart_layout& l = layout;
+	unsigned w = dv.get_format()->get_width(), h = dv.get_format()->get_height();
+	unsigned entry_size = df.get_entry_size();
+	size_t nr_segments = l.segment_markers.size();
+	// segment range [s_begin, s_end) covering the rows of the region
+	size_t s_begin = 0, s_end = nr_segments;
+	while (s_begin + 1 < nr_segments && l.segment_rows[s_begin + 1] * l.mcu_height <= y)
+		++s_begin;
+	while (s_end > s_begin + 1 && l.segment_rows[s_end - 1] * l.mcu_height >= y + h)
+		--s_end;
+	std::atomic<bool> success(true);
+	// each band is extended by one segment on both sides, such that upsampled chroma rows have the same context as in sequential decoding
+	parallel_ranges(s_end - s_begin, nr_threads, 4, [&](size_t begin, size_t end) {
+		begin += s_begin;
+		end += s_begin;
+		size_t d_begin = begin > 0 ? begin - 1 : 0;
+		size_t d_end = std::min(end + 1, nr_segments);
+		unsigned row_begin = l.segment_rows[d_begin] * l.mcu_height;
+		unsigned row_end = std::min(l.segment_rows[d_end] * l.mcu_height, unsigned(cinfo.image_height));
+		unsigned y_begin = std::max(y, l.segment_rows[begin] * l.mcu_height);
+		unsigned y_end = std::min(y + h, l.segment_rows[end] * l.mcu_height);
+		if (y_begin >= y_end)
+			return;
+		// construct a jpeg stream from the headers with the height of the band and the entropy coded data of its segments
+		int first_marker = l.segment_markers[d_begin];
+		int end_marker = d_end < nr_segments ? l.segment_markers[d_end] : int(l.restart_offsets.size());
+		size_t data_begin = first_marker < 0 ? l.scan_begin : l.restart_offsets[first_marker] + 2;
+		size_t data_end = d_end < nr_segments ? l.restart_offsets[end_marker] : l.scan_end;
+		std::vector<unsigned char> stream;
+		stream.reserve(l.scan_begin + data_end - data_begin + 2);
+		stream.insert(stream.end(), l.data.begin(), l.data.begin() + l.scan_begin);
+		stream[l.height_offset] = (unsigned char)((row_end - row_begin) >> 8);
+		stream[l.height_offset + 1] = (unsigned char)((row_end - row_begin) & 255);
+		stream.insert(stream.end(), l.data.begin() + data_begin, l.data.begin() + data_end);
+		stream.push_back(0xFF);
+		stream.push_back(0xD9);
+		// the decoder expects the restart markers of the band to be numbered from 0
+		for (int m = first_marker + 1; m < end_marker; ++m)
+			stream[l.scan_begin + l.restart_offsets[m] - data_begin + 1] = (unsigned char)(0xD0 + (m - first_marker - 1) % 8);
+		std::vector<unsigned char> line(size_t(cinfo.output_width)*entry_size);
+		if (!decode_band(&stream[0], stream.size(), y_begin - row_begin, y_end - y_begin, x, w, entry_size, &line[0],
+			dv.get_ptr<unsigned char>() + size_t(y_begin - y)*dv.get_step_size(0), dv.get_step_size(0)))
+			success = false;
+	});
+	if (!success)
+		last_error = "error in decoding restart segments";
+	return success;
+}
+
+/// decode the segments intersecting the region in parallel or stream the lines up to the last row of the region
+bool jpg_reader::read_region(const data_format& df, unsigned x, unsigned y, const data_view& dv)
+{
+	const data_format* rf = dv.get_format();
+	if (!fp || dv.empty() || !rf || rf->get_entry_size() != df.get_entry_size() ||
+		x + rf->get_width() > df.get_width() || y + rf->get_height() > df.get_height())
+		return false;
+	if (supports_region_read() && read_segments(df, x, y, dv))
+		return true;
+	if (cinfo.output_scanline != 0)
+		return false;
+	return abst_image_reader::read_region(df, x, y, dv);
+}
+
 cgv::base::object_registration<jpg_reader> jrr("");
@@ -5,6 +5,7 @@
 #include <jpeglib.h>
 
 #include <cgv/media/image/image_reader.h>
+#include <vector>
 
 using namespace cgv::media::image;
 
@@ -17,6 +18,28 @@ struct my_error_mgr
 
 typedef struct my_error_mgr* my_error_ptr;
 
+/** entropy coded segments of a single scan baseline jpeg file, which start with a restart marker at the beginning
+    of an MCU row and can therefore be decoded independently of each other */
+struct jpeg_restart_layout
+{
+	/// content of the jpeg file
+	std::vector<unsigned char> data;
+	/// offset of the image height in the frame header
+	size_t height_offset;
+	/// offset of the first entropy coded byte of the scan
+	size_t scan_begin;
+	/// offset of the marker that terminates the scan
+	size_t scan_end;
+	/// offsets of all restart markers in the scan
+	std::vector<size_t> restart_offsets;
+	/// first MCU row of each segment followed by the number of MCU rows
+	std::vector<unsigned> segment_rows;
+	/// index of the restart marker in front of each segment, which is -1 for the first segment
+	std::vector<int> segment_markers;
+	/// number of pixel rows per MCU row
+	unsigned mcu_height;
+};
+
 #include "lib_begin.h"
 
 /// implements the image reader interface for bmp files
@@ -26,6 +49,15 @@ protected:
 	FILE* fp;
 	struct jpeg_decompress_struct cinfo;
 	my_error_mgr jerr;
+	std::string file_name;
+	unsigned nr_threads;
+	/// restart layout, which is analyzed on the first parallel read with status 1 for decodable segments and -1 otherwise
+	jpeg_restart_layout layout;
+	int layout_status;
+	/// analyze the restart markers of the opened file
+	bool analyze_restart_layout();
+	/// decode the rows of the region from the segments intersecting it in parallel
+	bool read_segments(const data_format& df, unsigned x, unsigned y, const data_view& dv);
 
 	std::string last_error;
 public:
@@ -39,6 +71,12 @@ public:
 	const std::string& get_last_error() const;
 	/// construct a copy of the reader
 	abst_image_reader* clone() const;
+	/// return the property declarations, which allow to set the number of decoding threads
+	std::string get_property_declarations();
+	/// set the number of parallel decoding tasks with property nr_threads, where 0 uses cgv::os::get_nr_parallel_threads()
+	bool set_void(const std::string& property, const std::string& value_type, const void* value_ptr);
+	/// query the number of decoding threads
+	bool get_void(const std::string& property, const std::string& value_type, void* value_ptr);
 	/// return a string containing a colon separated list of extensions that can be read with this reader
 	const char* get_supported_extensions() const;
 	/// open the file and read the image header in order to determine the data format
@@ -49,6 +87,11 @@ public:
 	bool read_line(const data_format& df, const data_view& dv);
 	/// read the whole image into the given data pointer, set data format if not yet specified and allocate the data ptr if not yet done. If image file has not been opened yet, open it and close it after reading
 	bool read_image(const data_format& df, const data_view& dv);
+	/// regions of files with MCU row aligned restart intervals are decoded from the intersecting segments only
+	bool supports_region_read() const;
+	/** decode the segments intersecting the region in parallel if the file has MCU row aligned restart intervals
+	    and otherwise stream the lines up to the last row of the region */
+	bool read_region(const data_format& df, unsigned x, unsigned y, const data_view& dv);
 	/// close the image file
 	bool close();
 };
@@ -1,5 +1,9 @@
 #include "tiff_reader.h"
 #include <cgv/base/register.h>
+#include <cgv/type/variant.h>
+#include <cgv/media/image/image_proc.h>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <memory.h>
 
@@ -18,8 +22,10 @@ void myErrorHandlerExt(thandle_t, const char*, const char*, va_list)
 tiff_reader::tiff_reader() : fp(0)
 {
 	allows_row_based = false;
+	allows_region_based = false;
 	nr_images = -1;
 	row = 0;
+	nr_threads = 0;
 	TIFFSetErrorHandler(myErrorHandler);
 	TIFFSetErrorHandlerExt(myErrorHandlerExt);
 	TIFFSetWarningHandler(myErrorHandler);
@@ -49,6 +55,27 @@ abst_image_reader* tiff_reader::clone() const
 {
 	return new tiff_reader();
 }
+/// return the property declarations, which allow to set the number of decoding threads
+std::string tiff_reader::get_property_declarations()
+{
+	return "nr_threads:uint32";
+}
+/// set the number of parallel decoding tasks with property nr_threads, where 0 uses cgv::os::get_nr_parallel_threads()
+bool tiff_reader::set_void(const std::string& property, const std::string& value_type, const void* value_ptr)
+{
+	if (property != "nr_threads")
+		return false;
+	nr_threads = cgv::type::variant<cgv::type::uint32_type>::get(value_type, value_ptr);
+	return true;
+}
+/// query the number of decoding threads
+bool tiff_reader::get_void(const std::string& property, const std::string& value_type, void* value_ptr)
+{
+	if (property != "nr_threads")
+		return false;
+	cgv::type::set_variant(cgv::type::uint32_type(nr_threads), value_type, value_ptr);
+	return true;
+}
 /// return a string containing a colon separated list of extensions that can be read with this reader
 const char* tiff_reader::get_supported_extensions() const
 {
@@ -93,16 +120,17 @@ bool tiff_reader::seek_image(unsigned idx)
 }
 
 /// open the file and read the image header in order to determine the data format
-bool tiff_reader::open(const std::string& file_name, data_format& df, std::vector<data_format>* palette_formats)
+bool tiff_reader::open(const std::string& _file_name, data_format& df, std::vector<data_format>* palette_formats)
 {
-	fp = TIFFOpen(file_name.c_str(), "r");
+	fp = TIFFOpen(_file_name.c_str(), "r");
 	if (!fp)
 		return false;
 
+	file_name = _file_name;
 	nr_images = -1;
 
 	uint32 width, height;		/* image width & height */	
-	uint16 format, components, config, bps;
+	uint16 format, components, config, bps, photometric;
 	TIFFGetField(fp, TIFFTAG_IMAGEWIDTH, &width);
 	TIFFGetField(fp, TIFFTAG_IMAGELENGTH, &height);
 	if (!TIFFGetField(fp, TIFFTAG_BITSPERSAMPLE, &bps))
@@ -113,6 +141,8 @@ bool tiff_reader::open(const std::string& file_name, data_format& df, std::vecto
 		components = 1;
 	if (!TIFFGetField(fp, TIFFTAG_SAMPLEFORMAT, &format))
 		format = SAMPLEFORMAT_UINT;
+	if (!TIFFGetField(fp, TIFFTAG_PHOTOMETRIC, &photometric))
+		photometric = PHOTOMETRIC_MINISBLACK;
 
 	TIFFSetField(fp, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
 
@@ -144,11 +174,23 @@ bool tiff_reader::open(const std::string& file_name, data_format& df, std::vecto
 			tid = TI_UINT32;
 			return false;
 		}
+		break;
 	default: std::cerr << "only bit depths 8, 16, and 32 supported by tiff reader" << std::endl;
 		return false;
 	}
-	df = data_format(width,height,tid,components == 1 ? CF_L : CF_RGB);
+	ComponentFormat cf;
+	switch (components) {
+	case 1 : cf = CF_L; break;
+	case 2 : cf = CF_LA; break;
+	case 3 : cf = CF_RGB; break;
+	case 4 : cf = CF_RGBA; break;
+	default: std::cerr << "only 1 to 4 samples per pixel supported by tiff reader" << std::endl;
+		return false;
+	}
+	df = data_format(width,height,tid,cf);
 	allows_row_based = config == PLANARCONFIG_CONTIG;
+	// subsampled YCbCr data is not stored in the layout of the data format
+	allows_region_based = allows_row_based && photometric != PHOTOMETRIC_YCBCR;
 	row = 0;
 	return true;
 }
@@ -216,6 +258,10 @@ bool tiff_reader::read_image(const data_format& df, const data_view& dv)
 		}
 		_TIFFfree( raster );
 	}
+	else if (allows_region_based) {
+		if (!read_region(df, 0, 0, dv))
+			return false;
+	}
 	else {
 		bool success = true;
 		for (unsigned int y = 0; success && y < df.get_height(); ++y) {
@@ -227,6 +273,84 @@ bool tiff_reader::read_image(const data_format& df, const data_view& dv)
 		TIFFReadDirectory(fp);
 	return true;
 }
+/// regions of images with interleaved samples are decoded from the intersecting strips or tiles only
+bool tiff_reader::supports_region_read() const
+{
+	return fp != 0 && allows_region_based;
+}
+/// decode the strips or tiles intersecting the region in parallel
+bool tiff_reader::read_region(const data_format& df, unsigned x, unsigned y, const data_view& dv)
+{
+	if (!fp)
+		return false;
+	if (!allows_region_based)
+		return abst_image_reader::read_region(df, x, y, dv);
+	const data_format* rf = dv.get_format();
+	if (dv.empty() || !rf || rf->get_entry_size() != df.get_entry_size() ||
+		x + rf->get_width() > df.get_width() || y + rf->get_height() > df.get_height()) {
+		last_error = "region does not fit into image";
+		return false;
+	}
+	// strips are handled as tiles spanning the image width
+	bool tiled = TIFFIsTiled(fp) != 0;
+	uint32 tile_width = df.get_width(), tile_height = df.get_height();
+	if (tiled) {
+		TIFFGetField(fp, TIFFTAG_TILEWIDTH, &tile_width);
+		TIFFGetField(fp, TIFFTAG_TILELENGTH, &tile_height);
+	}
+	else if (TIFFGetField(fp, TIFFTAG_ROWSPERSTRIP, &tile_height))
+		tile_height = std::min(tile_height, uint32(df.get_height()));
+	else
+		tile_height = df.get_height();
+	if (tile_width == 0 || tile_height == 0) {
+		last_error = "invalid tile size";
+		return false;
+	}
+	unsigned x_end = x + rf->get_width(), y_end = y + rf->get_height();
+	std::vector<std::pair<uint32, uint32> > tiles;
+	for (uint32 ty = y / tile_height*tile_height; ty < y_end; ty += tile_height)
+		for (uint32 tx = x / tile_width*tile_width; tx < x_end; tx += tile_width)
+			tiles.push_back(std::make_pair(tx, ty));
+
+	tmsize_t tile_size = tiled ? TIFFTileSize(fp) : TIFFStripSize(fp);
+	tdir_t directory = TIFFCurrentDirectory(fp);
+	unsigned entry_size = df.get_entry_size();
+	std::atomic<bool> success(true);
+	parallel_ranges(tiles.size(), nr_threads, 1, [&](size_t begin, size_t end) {
+		// libtiff handles are not thread safe, such that further threads open the file again
+		TIFF* tp = fp;
+		if (begin > 0) {
+			tp = TIFFOpen(file_name.c_str(), "r");
+			if (!tp || !TIFFSetDirectory(tp, directory)) {
+				if (tp)
+					TIFFClose(tp);
+				success = false;
+				return;
+			}
+		}
+		std::vector<unsigned char> buffer(tile_size);
+		for (size_t i = begin; success && i < end; ++i) {
+			uint32 tx = tiles[i].first, ty = tiles[i].second;
+			tmsize_t n = tiled ?
+				TIFFReadEncodedTile(tp, TIFFComputeTile(tp, tx, ty, 0, 0), &buffer[0], tile_size) :
+				TIFFReadEncodedStrip(tp, TIFFComputeStrip(tp, ty, 0), &buffer[0], tile_size);
+			if (n < 0) {
+				success = false;
+				break;
+			}
+			unsigned x0 = std::max(unsigned(tx), x), x1 = std::min(unsigned(tx + tile_width), x_end);
+			unsigned y0 = std::max(unsigned(ty), y), y1 = std::min(unsigned(ty + tile_height), y_end);
+			for (unsigned r = y0; r < y1; ++r)
+				memcpy(dv.get_ptr<unsigned char>() + (r - y)*dv.get_step_size(0) + (x0 - x)*entry_size,
+					&buffer[(size_t(r - ty)*tile_width + x0 - tx)*entry_size], (x1 - x0)*entry_size);
+		}
+		if (tp != fp)
+			TIFFClose(tp);
+	});
+	if (!success)
+		last_error = tiled ? "error in reading tiles" : "error in reading strips";
+	return success;
+}
 /// close the image file
 bool tiff_reader::close()
 {
@@ -15,8 +15,11 @@ class tiff_reader : public abst_image_reader
 {
 protected:
 	TIFF *fp;
+	std::string file_name;
 	bool allows_row_based;
+	bool allows_region_based;
 	unsigned row;
+	unsigned nr_threads;
 	mutable unsigned nr_images;
 	std::string last_error;
 public:
@@ -30,6 +33,12 @@ public:
 	const std::string& get_last_error() const;
 	/// construct a copy of the reader
 	abst_image_reader* clone() const;
+	/// return the property declarations, which allow to set the number of decoding threads
+	std::string get_property_declarations();
+	/// set the number of parallel decoding tasks with property nr_threads, where 0 uses cgv::os::get_nr_parallel_threads()
+	bool set_void(const std::string& property, const std::string& value_type, const void* value_ptr);
+	/// query the number of decoding threads
+	bool get_void(const std::string& property, const std::string& value_type, void* value_ptr);
 	/// return a string containing a colon separated list of extensions that can be read with this reader
 	const char* get_supported_extensions() const;
 	/// open the file and read the image header in order to determine the data format
@@ -40,6 +49,11 @@ public:
 	bool read_line(const data_format& df, const data_view& dv);
 	/// read the whole image into the given data pointer, set data format if not yet specified and allocate the data ptr if not yet done. If image file has not been opened yet, open it and close it after reading
 	bool read_image(const data_format& df, const data_view& dv);
+	/// regions of images with interleaved samples are decoded from the intersecting strips or tiles only
+	bool supports_region_read() const;
+	/** decode the strips or tiles intersecting the region in parallel, where each thread but the calling one reads
+	    through its own file handle. In contrast to the standard implementation the region read can be repeated. */
+	bool read_region(const data_format& df, unsigned x, unsigned y, const data_view& dv);
 	/// whether the file can contain several images
 	bool supports_multiple_images() const;
 	/// return the number of images in the file, what can cause the whole file to be scanned
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cgv/type/standard_types.h>
+
+/// structures of the avi file format including the OpenDML extensions, which are stored without padding
+namespace avi {
+
+	using cgv::type::uint8_type;
+	using cgv::type::uint16_type;
+	using cgv::type::int16_type;
+	using cgv::type::uint32_type;
+	using cgv::type::int32_type;
+	using cgv::type::uint64_type;
+
+	/// flag of main header marking the presence of an idx1 chunk
+	const uint32_type AVIF_HASINDEX = 0x10;
+	/// flag of legacy index entries marking key frames
+	const uint32_type AVIIF_KEYFRAME = 0x10;
+	/// index type of super indices
+	const uint8_type AVI_INDEX_OF_INDEXES = 0;
+	/// index type of standard indices
+	const uint8_type AVI_INDEX_OF_CHUNKS = 1;
+	/// compression type of uncompressed bitmaps
+	const uint32_type BI_RGB = 0;
+
+#pragma pack(push, 1)
+	/// content of avih chunk
+	struct main_header
+	{
+		uint32_type micro_sec_per_frame;
+		uint32_type max_bytes_per_sec;
+		uint32_type padding_granularity;
+		uint32_type flags;
+		uint32_type total_frames;
+		uint32_type initial_frames;
+		uint32_type streams;
+		uint32_type suggested_buffer_size;
+		uint32_type width;
+		uint32_type height;
+		uint32_type reserved[4];
+	};
+	/// content of strh chunk
+	struct stream_header
+	{
+		uint32_type fcc_type;
+		uint32_type fcc_handler;
+		uint32_type flags;
+		uint16_type priority;
+		uint16_type language;
+		uint32_type initial_frames;
+		uint32_type scale;
+		uint32_type rate;
+		uint32_type start;
+		uint32_type length;
+		uint32_type suggested_buffer_size;
+		uint32_type quality;
+		uint32_type sample_size;
+		int16_type frame[4];
+	};
+	/// content of strf chunk of video streams
+	struct bitmap_info_header
+	{
+		uint32_type size;
+		int32_type width;
+		int32_type height;
+		uint16_type planes;
+		uint16_type bit_count;
+		uint32_type compression;
+		uint32_type size_image;
+		int32_type x_pels_per_meter;
+		int32_type y_pels_per_meter;
+		uint32_type clr_used;
+		uint32_type clr_important;
+	};
+	/// header of OpenDML indx chunk pointing to the standard indices of all RIFF lists
+	struct super_index_header
+	{
+		uint16_type longs_per_entry;
+		uint8_type index_sub_type;
+		uint8_type index_type;
+		uint32_type nr_entries_in_use;
+		uint32_type chunk_id;
+		uint32_type reserved[3];
+	};
+	/// entry of super index
+	struct super_index_entry
+	{
+		/// file offset of the standard index chunk
+		uint64_type offset;
+		/// size of the standard index chunk including its chunk header
+		uint32_type size;
+		/// number of frames indexed by the standard index
+		uint32_type duration;
+	};
+	/// header of OpenDML ix## chunk indexing the frames of one movi list
+	struct standard_index_header
+	{
+		uint16_type longs_per_entry;
+		uint8_type index_sub_type;
+		uint8_type index_type;
+		uint32_type nr_entries_in_use;
+		uint32_type chunk_id;
+		uint64_type base_offset;
+		uint32_type reserved;
+	};
+	/// entry of standard index
+	struct standard_index_entry
+	{
+		/// offset of chunk data relative to the base offset
+		uint32_type offset;
+		/// size of chunk data, where bit 31 marks frames that are not key frames
+		uint32_type size;
+	};
+	/// entry of legacy idx1 chunk
+	struct legacy_index_entry
+	{
+		uint32_type chunk_id;
+		uint32_type flags;
+		/// offset of chunk header relative to the movi fourcc
+		uint32_type offset;
+		uint32_type size;
+	};
+#pragma pack(pop)
+}
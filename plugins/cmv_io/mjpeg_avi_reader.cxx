@@ -0,0 +1,410 @@
+#include "mjpeg_avi_reader.h"
+#include <algorithm>
+#include <cstring>
+#include <setjmp.h>
+#include <jpeglib.h>
+
+using namespace cgv::data;
+using namespace cgv::type;
+using cgv::media::fourcc;
+
+namespace {
+	/// seek with 64 bit offsets
+	int seek64(FILE* fp, long long offset)
+	{
+#ifdef _MSC_VER
+		return _fseeki64(fp, offset, SEEK_SET);
+#else
+		return fseeko(fp, off_t(offset), SEEK_SET);
+#endif
+	}
+
+	/// jpeg error manager that jumps back to the decoder instead of exiting
+	struct jump_error_mgr
+	{
+		jpeg_error_mgr pub;
+		jmp_buf setjmp_buffer;
+	};
+	void jump_error_exit(j_common_ptr cinfo)
+	{
+		longjmp(reinterpret_cast<jump_error_mgr*>(cinfo->err)->setjmp_buffer, 1);
+	}
+	void silent_output_message(j_common_ptr) {}
+
+	/// jpeg source manager reading from a memory block
+	void init_memory_source(j_decompress_ptr) {}
+	boolean fill_memory_input_buffer(j_decompress_ptr cinfo)
+	{
+		// insert an end of image marker for truncated data
+		static const JOCTET eoi[2] = { 0xFF, JPEG_EOI };
+		cinfo->src->next_input_byte = eoi;
+		cinfo->src->bytes_in_buffer = 2;
+		return TRUE;
+	}
+	void skip_memory_input_data(j_decompress_ptr cinfo, long num_bytes)
+	{
+		if (num_bytes <= 0)
+			return;
+		if (size_t(num_bytes) > cinfo->src->bytes_in_buffer)
+			fill_memory_input_buffer(cinfo);
+		else {
+			cinfo->src->next_input_byte += num_bytes;
+			cinfo->src->bytes_in_buffer -= num_bytes;
+		}
+	}
+	void term_memory_source(j_decompress_ptr) {}
+}
+
+mjpeg_avi_reader::mjpeg_avi_reader() : fp(0)
+{
+	frame_index = 0;
+	width = height = 0;
+}
+
+mjpeg_avi_reader::~mjpeg_avi_reader()
+{
+	if (fp)
+		close();
+}
+
+std::string mjpeg_avi_reader::get_type_name() const
+{
+	return "mjpeg_avi_reader";
+}
+
+abst_video_reader* mjpeg_avi_reader::clone() const
+{
+	return new mjpeg_avi_reader();
+}
+
+const std::string& mjpeg_avi_reader::get_last_error() const
+{
+	return last_error;
+}
+
+const char* mjpeg_avi_reader::get_supported_extensions() const
+{
+	return "avi";
+}
+
+bool mjpeg_avi_reader::read_at(long long offset, void* data, size_t size)
+{
+	return seek64(fp, offset) == 0 && fread(data, 1, size, fp) == size;
+}
+
+bool mjpeg_avi_reader::is_video_chunk(unsigned id) const
+{
+	unsigned type = id >> 16;
+	return (id & 0xFFFF) == stream_prefix && (type == ('d' | ('c' << 8)) || type == ('d' | ('b' << 8)));
+}
+
+bool mjpeg_avi_reader::parse_chunks(long long begin, long long end)
+{
+	long long offset = begin;
+	while (offset + 8 <= end) {
+		unsigned header[3];
+		if (!read_at(offset, header, 8))
+			return false;
+		fourcc id(header[0]);
+		unsigned size = header[1];
+		long long data_offset = offset + 8;
+		if (id == "RIFF" || id == "LIST") {
+			if (size < 4 || !read_at(data_offset, &header[2], 4))
+				return false;
+			fourcc hdr(header[2]);
+			long long list_end = data_offset + size;
+			if (hdr == "movi") {
+				// only the first movi list is scanned if no index is available
+				if (movi_offset < 0) {
+					movi_offset = data_offset;
+					movi_end = list_end;
+				}
+			}
+			else if (hdr == "strl") {
+				in_video_strl = false;
+				if (!parse_chunks(data_offset + 4, list_end))
+					return false;
+				++nr_streams;
+			}
+			else if (hdr == "AVI " || hdr == "AVIX" || hdr == "hdrl" || hdr == "odml") {
+				if (!parse_chunks(data_offset + 4, list_end))
+					return false;
+			}
+		}
+		else if (id == "avih") {
+			std::memset(&avih, 0, sizeof(avih));
+			if (!read_at(data_offset, &avih, std::min(size_t(size), sizeof(avih))))
+				return false;
+		}
+		else if (id == "strh") {
+			avi::stream_header sh;
+			std::memset(&sh, 0, sizeof(sh));
+			if (!read_at(data_offset, &sh, std::min(size_t(size), sizeof(sh))))
+				return false;
+			if (!found_video && sh.fcc_type == fourcc("vids").id) {
+				strh = sh;
+				found_video = in_video_strl = true;
+				char prefix[2] = { char('0' + nr_streams / 10 % 10), char('0' + nr_streams % 10) };
+				stream_prefix = (unsigned short)(unsigned char)prefix[0] + ((unsigned short)(unsigned char)prefix[1] << 8);
+			}
+		}
+		else if (id == "strf" && in_video_strl) {
+			std::memset(&bih, 0, sizeof(bih));
+			if (!read_at(data_offset, &bih, std::min(size_t(size), sizeof(bih))))
+				return false;
+		}
+		else if (id == "indx" && in_video_strl) {
+			avi::super_index_header ih;
+			if (size >= sizeof(ih) && read_at(data_offset, &ih, sizeof(ih)) &&
+				ih.index_type == avi::AVI_INDEX_OF_INDEXES && ih.longs_per_entry == 4 &&
+				sizeof(ih) + ih.nr_entries_in_use*sizeof(avi::super_index_entry) <= size) {
+				super_index.resize(ih.nr_entries_in_use);
+				if (!super_index.empty() && !read_at(data_offset + sizeof(ih), &super_index[0], super_index.size()*sizeof(avi::super_index_entry)))
+					return false;
+			}
+		}
+		else if (id == "idx1" && legacy_index.empty()) {
+			legacy_index.resize(size / sizeof(avi::legacy_index_entry));
+			if (!legacy_index.empty() && !read_at(data_offset, &legacy_index[0], legacy_index.size()*sizeof(avi::legacy_index_entry)))
+				return false;
+		}
+		offset = data_offset + size + (size & 1);
+	}
+	return true;
+}
+
+bool mjpeg_avi_reader::read_standard_indices()
+{
+	frames.clear();
+	for (size_t i = 0; i < super_index.size(); ++i) {
+		unsigned header[2];
+		avi::standard_index_header ih;
+		if (!read_at(super_index[i].offset, header, 8) || header[1] < sizeof(ih) || !read_at(super_index[i].offset + 8, &ih, sizeof(ih)))
+			return false;
+		if (ih.index_type != avi::AVI_INDEX_OF_CHUNKS || ih.longs_per_entry != 2 || sizeof(ih) + ih.nr_entries_in_use * 8 > header[1])
+			return false;
+		std::vector<avi::standard_index_entry> entries(ih.nr_entries_in_use);
+		if (!entries.empty() && !read_at(super_index[i].offset + 8 + sizeof(ih), &entries[0], entries.size()*sizeof(avi::standard_index_entry)))
+			return false;
+		for (size_t j = 0; j < entries.size(); ++j) {
+			frame_location fl = { (long long)(ih.base_offset + entries[j].offset), entries[j].size & 0x7FFFFFFF };
+			frames.push_back(fl);
+		}
+	}
+	return true;
+}
+
+void mjpeg_avi_reader::use_legacy_index()
+{
+	frames.clear();
+	// offsets are relative to the movi fourcc, but some writers store absolute file offsets
+	long long base = movi_offset;
+	for (size_t i = 0; i < legacy_index.size(); ++i)
+		if (is_video_chunk(legacy_index[i].chunk_id)) {
+			unsigned id = 0;
+			if (!read_at(base + legacy_index[i].offset, &id, 4) || id != legacy_index[i].chunk_id)
+				base = 0;
+			break;
+		}
+	for (size_t i = 0; i < legacy_index.size(); ++i)
+		if (is_video_chunk(legacy_index[i].chunk_id)) {
+			frame_location fl = { base + legacy_index[i].offset + 8, legacy_index[i].size };
+			frames.push_back(fl);
+		}
+}
+
+void mjpeg_avi_reader::scan_movi(long long begin, long long end)
+{
+	long long offset = begin;
+	while (offset + 8 <= end) {
+		unsigned header[3];
+		if (!read_at(offset, header, 8))
+			return;
+		if (fourcc(header[0]) == "LIST") {
+			// descend into rec lists
+			scan_movi(offset + 12, offset + 8 + header[1]);
+		}
+		else if (is_video_chunk(header[0])) {
+			frame_location fl = { offset + 8, header[1] };
+			frames.push_back(fl);
+		}
+		offset += 8 + header[1] + (header[1] & 1);
+	}
+}
+
+bool mjpeg_avi_reader::open(const std::string& file_name, data_format& df, float& fps)
+{
+	if (fp)
+		close();
+	fp = fopen(file_name.c_str(), "rb");
+	if (!fp) {
+		last_error = "could not open file: ";
+		last_error += file_name;
+		return false;
+	}
+	nr_streams = 0;
+	found_video = in_video_strl = false;
+	movi_offset = movi_end = -1;
+	super_index.clear();
+	legacy_index.clear();
+	frames.clear();
+	frame_index = 0;
+	long long file_size = 0;
+#ifdef _MSC_VER
+	if (_fseeki64(fp, 0, SEEK_END) == 0)
+		file_size = _ftelli64(fp);
+#else
+	if (fseeko(fp, 0, SEEK_END) == 0)
+		file_size = (long long)ftello(fp);
+#endif
+	unsigned header[3];
+	if (!read_at(0, header, 12) || fourcc(header[0]) != "RIFF" || fourcc(header[2]) != "AVI ") {
+		last_error = "no avi file: ";
+		last_error += file_name;
+		close();
+		return false;
+	}
+	if (!parse_chunks(0, file_size) || !found_video || movi_offset < 0) {
+		last_error = "no video stream found in avi file";
+		close();
+		return false;
+	}
+	if (bih.compression == fourcc("MJPG").id || bih.compression == fourcc("mjpg").id)
+		is_mjpeg = true;
+	else if (bih.compression == avi::BI_RGB && bih.bit_count == 24)
+		is_mjpeg = false;
+	else {
+		last_error = "unsupported video compression ";
+		last_error += fourcc(bih.compression).to_string();
+		close();
+		return false;
+	}
+	width = unsigned(bih.width);
+	is_top_down = bih.height < 0;
+	height = unsigned(is_top_down ? -bih.height : bih.height);
+	if (super_index.empty() || !read_standard_indices()) {
+		if (!legacy_index.empty())
+			use_legacy_index();
+		if (frames.empty())
+			scan_movi(movi_offset + 4, std::min(movi_end, file_size));
+	}
+	fps = strh.scale != 0 ? float(double(strh.rate) / strh.scale) : (avih.micro_sec_per_frame != 0 ? 1000000.0f / avih.micro_sec_per_frame : 25.0f);
+	df.~data_format();
+	new (&df) data_format(width, height, cgv::type::info::TI_UINT8, CF_RGB);
+	row.resize(3 * width);
+	return true;
+}
+
+size_t mjpeg_avi_reader::get_nr_frames() const
+{
+	return frames.size();
+}
+
+bool mjpeg_avi_reader::seek_frame(size_t i)
+{
+	if (i >= frames.size()) {
+		last_error = "frame index out of range";
+		return false;
+	}
+	frame_index = i;
+	return true;
+}
+
+bool mjpeg_avi_reader::decode_jpeg(const data_view& dv)
+{
+	jpeg_decompress_struct cinfo;
+	jump_error_mgr jerr;
+	cinfo.err = jpeg_std_error(&jerr.pub);
+	jerr.pub.error_exit = jump_error_exit;
+	jerr.pub.output_message = silent_output_message;
+	if (setjmp(jerr.setjmp_buffer)) {
+		jpeg_destroy_decompress(&cinfo);
+		last_error = "could not decode jpeg frame";
+		return false;
+	}
+	jpeg_create_decompress(&cinfo);
+	jpeg_source_mgr src;
+	src.init_source = init_memory_source;
+	src.fill_input_buffer = fill_memory_input_buffer;
+	src.skip_input_data = skip_memory_input_data;
+	src.resync_to_restart = jpeg_resync_to_restart;
+	src.term_source = term_memory_source;
+	src.next_input_byte = &chunk[0];
+	src.bytes_in_buffer = chunk.size();
+	cinfo.src = &src;
+	jpeg_read_header(&cinfo, TRUE);
+	bool gray = cinfo.num_components == 1;
+	cinfo.out_color_space = gray ? JCS_GRAYSCALE : JCS_RGB;
+	jpeg_start_decompress(&cinfo);
+	if (cinfo.output_width != width || cinfo.output_height != height) {
+		jpeg_destroy_decompress(&cinfo);
+		last_error = "jpeg frame size does not match video size";
+		return false;
+	}
+	unsigned char* dst = dv.get_ptr<unsigned char>();
+	size_t step = dv.get_step_size(0);
+	while (cinfo.output_scanline < height) {
+		unsigned char* dst_row = dst + cinfo.output_scanline*step;
+		JSAMPROW row_ptr = gray ? &row[0] : dst_row;
+		jpeg_read_scanlines(&cinfo, &row_ptr, 1);
+		if (gray)
+			for (unsigned x = 0; x < width; ++x)
+				dst_row[3 * x] = dst_row[3 * x + 1] = dst_row[3 * x + 2] = row[x];
+	}
+	jpeg_finish_decompress(&cinfo);
+	jpeg_destroy_decompress(&cinfo);
+	return true;
+}
+
+bool mjpeg_avi_reader::decode_raw(const data_view& dv)
+{
+	size_t row_size = (3 * width + 3) & ~3u;
+	if (chunk.size() < row_size*height) {
+		last_error = "raw frame too small";
+		return false;
+	}
+	unsigned char* dst = dv.get_ptr<unsigned char>();
+	size_t step = dv.get_step_size(0);
+	for (unsigned y = 0; y < height; ++y) {
+		const unsigned char* src = &chunk[(is_top_down ? y : height - 1 - y)*row_size];
+		unsigned char* dst_row = dst + y*step;
+		for (unsigned x = 0; x < width; ++x, src += 3, dst_row += 3) {
+			dst_row[0] = src[2];
+			dst_row[1] = src[1];
+			dst_row[2] = src[0];
+		}
+	}
+	return true;
+}
+
+bool mjpeg_avi_reader::read_frame(const data_view& dv)
+{
+	if (!fp) {
+		last_error = "attempt to read frame of not opened file";
+		return false;
+	}
+	if (frame_index >= frames.size())
+		return false;
+	const frame_location& fl = frames[frame_index];
+	chunk.resize(fl.size);
+	if (fl.size == 0 || !read_at(fl.offset, &chunk[0], fl.size)) {
+		last_error = "could not read frame data";
+		return false;
+	}
+	++frame_index;
+	return is_mjpeg ? decode_jpeg(dv) : decode_raw(dv);
+}
+
+bool mjpeg_avi_reader::close()
+{
+	if (!fp)
+		return false;
+	bool success = fclose(fp) == 0;
+	fp = 0;
+	frames.clear();
+	return success;
+}
+
+#include <cgv/base/register.h>
+
+cgv::base::object_registration<mjpeg_avi_reader> mjpeg_avi_read_reg("");
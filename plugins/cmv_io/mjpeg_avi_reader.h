@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cgv/media/video/video_reader.h>
+#include <cgv/media/riff.h>
+#include <vector>
+#include <stdio.h>
+#include "avi_structs.h"
+
+using namespace cgv::media::video;
+
+#include "lib_begin.h"
+
+/** portable video reader for avi files with a motion jpeg or uncompressed 24 bit video stream as written by
+	mjpeg_avi_writer. Frames are located with the OpenDML indices, with the legacy idx1 chunk, or by scanning the movi
+	list if the file contains no index, such that files larger than 4GB can be read. Frames are returned as 8 bit RGB
+	images with the first row on top. */
+class CGV_API mjpeg_avi_reader : public abst_video_reader
+{
+protected:
+	/// location of one frame in the file
+	struct frame_location
+	{
+		/// file offset of the chunk data
+		long long offset;
+		/// size of the chunk data
+		unsigned size;
+	};
+	mutable std::string last_error;
+	FILE* fp;
+	/// whether frames are stored as jpeg
+	bool is_mjpeg;
+	/// whether raw rows are stored from top to bottom
+	bool is_top_down;
+	unsigned width, height;
+	/// two digit stream number of the video stream in chunk ids
+	unsigned short stream_prefix;
+	/// number of parsed strl lists
+	unsigned nr_streams;
+	/// whether the video stream has been found
+	bool found_video;
+	/// whether the currently parsed strl list describes the video stream
+	bool in_video_strl;
+	/// file offset of the fourcc of the first movi list and end of the list
+	long long movi_offset, movi_end;
+	avi::main_header avih;
+	avi::stream_header strh;
+	avi::bitmap_info_header bih;
+	std::vector<avi::super_index_entry> super_index;
+	std::vector<avi::legacy_index_entry> legacy_index;
+	std::vector<frame_location> frames;
+	/// index of next frame to be read
+	size_t frame_index;
+	/// buffer for encoded chunk data
+	std::vector<unsigned char> chunk;
+	/// buffer for one decoded row
+	std::vector<unsigned char> row;
+	/// recursively parse the chunks in the file range [begin,end)
+	bool parse_chunks(long long begin, long long end);
+	/// read size bytes at the given file offset
+	bool read_at(long long offset, void* data, size_t size);
+	/// build frame list from the super index
+	bool read_standard_indices();
+	/// build frame list from the idx1 chunk
+	void use_legacy_index();
+	/// build frame list by scanning the chunks of the first movi list
+	void scan_movi(long long begin, long long end);
+	/// check whether chunk id refers to the video stream
+	bool is_video_chunk(unsigned id) const;
+	/// decode a jpeg frame into the data view
+	bool decode_jpeg(const cgv::data::data_view& dv);
+	/// convert an uncompressed frame into the data view
+	bool decode_raw(const cgv::data::data_view& dv);
+public:
+	/// construct reader without file
+	mjpeg_avi_reader();
+	/// close file if still open
+	~mjpeg_avi_reader();
+	/// returns the type name of the chosen video reader implementation
+	std::string get_type_name() const;
+	/// construct a copy of the video reader
+	abst_video_reader* clone() const;
+	/// return a reference to the last error message
+	const std::string& get_last_error() const;
+	/// return a string containing a colon separated list of extensions that can be read with this video reader
+	const char* get_supported_extensions() const;
+	/// open the file and read the header in order to determine the image format and the fps
+	bool open(const std::string& file_name, cgv::data::data_format& df, float& fps);
+	/// return the number of frames in the opened file
+	size_t get_nr_frames() const;
+	/// select the frame that is returned by the next call to read_frame()
+	bool seek_frame(size_t i);
+	/// read a frame and return whether this was successful
+	bool read_frame(const cgv::data::data_view& dv);
+	/// close the video file
+	bool close();
+};
+
+#include <cgv/config/lib_end.h>
@@ -0,0 +1,554 @@
+#include "mjpeg_avi_writer.h"
+#include <cgv/type/variant.h>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <setjmp.h>
+#include <stdio.h>
+#include <jpeglib.h>
+
+using namespace cgv::base;
+using namespace cgv::data;
+using namespace cgv::type;
+using cgv::media::fourcc;
+
+/// number of reserved entries in the super index, which allows 1024 RIFF lists
+static const unsigned max_nr_riffs = 1024;
+
+namespace {
+	/// jpeg error manager that jumps back to the encoder instead of exiting
+	struct jump_error_mgr
+	{
+		jpeg_error_mgr pub;
+		jmp_buf setjmp_buffer;
+	};
+	void jump_error_exit(j_common_ptr cinfo)
+	{
+		longjmp(reinterpret_cast<jump_error_mgr*>(cinfo->err)->setjmp_buffer, 1);
+	}
+	void silent_output_message(j_common_ptr) {}
+
+	/// jpeg destination manager that writes into a growing std::vector
+	struct vector_destination_mgr
+	{
+		jpeg_destination_mgr pub;
+		std::vector<unsigned char>* buffer;
+	};
+	void init_vector_destination(j_compress_ptr cinfo)
+	{
+		vector_destination_mgr* dest = reinterpret_cast<vector_destination_mgr*>(cinfo->dest);
+		dest->buffer->resize(std::max(dest->buffer->capacity(), size_t(65536)));
+		dest->pub.next_output_byte = &dest->buffer->front();
+		dest->pub.free_in_buffer = dest->buffer->size();
+	}
+	boolean empty_vector_output_buffer(j_compress_ptr cinfo)
+	{
+		vector_destination_mgr* dest = reinterpret_cast<vector_destination_mgr*>(cinfo->dest);
+		size_t old_size = dest->buffer->size();
+		dest->buffer->resize(2 * old_size);
+		dest->pub.next_output_byte = &(*dest->buffer)[old_size];
+		dest->pub.free_in_buffer = dest->buffer->size() - old_size;
+		return TRUE;
+	}
+	void term_vector_destination(j_compress_ptr cinfo)
+	{
+		vector_destination_mgr* dest = reinterpret_cast<vector_destination_mgr*>(cinfo->dest);
+		dest->buffer->resize(dest->buffer->size() - dest->pub.free_in_buffer);
+	}
+
+	/// compress frame pixels of the given format into encoded, where row provides space for one converted row
+	bool encode_jpeg(jpeg_compress_struct& cinfo, jump_error_mgr& jerr, int quality, ComponentFormat cf, unsigned w, unsigned h,
+		const unsigned char* pixels, unsigned char* row, std::vector<unsigned char>& encoded)
+	{
+		vector_destination_mgr dest;
+		dest.pub.init_destination = init_vector_destination;
+		dest.pub.empty_output_buffer = empty_vector_output_buffer;
+		dest.pub.term_destination = term_vector_destination;
+		dest.buffer = &encoded;
+		if (setjmp(jerr.setjmp_buffer)) {
+			jpeg_abort_compress(&cinfo);
+			return false;
+		}
+		cinfo.dest = &dest.pub;
+		cinfo.image_width = w;
+		cinfo.image_height = h;
+		cinfo.input_components = cf == CF_L ? 1 : 3;
+		cinfo.in_color_space = cf == CF_L ? JCS_GRAYSCALE : JCS_RGB;
+		jpeg_set_defaults(&cinfo);
+		jpeg_set_quality(&cinfo, quality, TRUE);
+		jpeg_start_compress(&cinfo, TRUE);
+		unsigned bpp = cf == CF_L ? 1 : (cf == CF_RGB || cf == CF_BGR ? 3 : 4);
+		while (cinfo.next_scanline < h) {
+			const unsigned char* src = pixels + size_t(cinfo.next_scanline)*w*bpp;
+			JSAMPROW row_ptr = const_cast<JSAMPROW>(src);
+			if (cf != CF_L && cf != CF_RGB) {
+				bool swap = cf == CF_BGR || cf == CF_BGRA;
+				for (unsigned x = 0; x < w; ++x, src += bpp) {
+					row[3 * x] = src[swap ? 2 : 0];
+					row[3 * x + 1] = src[1];
+					row[3 * x + 2] = src[swap ? 0 : 2];
+				}
+				row_ptr = row;
+			}
+			jpeg_write_scanlines(&cinfo, &row_ptr, 1);
+		}
+		jpeg_finish_compress(&cinfo);
+		return true;
+	}
+}
+
+mjpeg_avi_writer::mjpeg_avi_writer() : codec("MJPG")
+{
+	quality = 90;
+	nr_threads = 0;
+	max_queued_frames = 0;
+	riff_size_limit = 1 << 30;
+	width = height = 0;
+	component_format = CF_RGB;
+	bytes_per_pixel = 3;
+	nr_frames = nr_frames_first_riff = 0;
+	first_riff = true;
+	nr_frames_in_pipeline = 0;
+	next_frame_index = next_written_index = 0;
+	max_nr_encoders = nr_encoders = 0;
+	writing = failed = false;
+}
+
+mjpeg_avi_writer::~mjpeg_avi_writer()
+{
+	if (rw.is_open())
+		close();
+}
+
+std::string mjpeg_avi_writer::get_type_name() const
+{
+	return "mjpeg_avi_writer";
+}
+
+abst_video_writer* mjpeg_avi_writer::clone() const
+{
+	mjpeg_avi_writer* w = new mjpeg_avi_writer();
+	w->codec = codec;
+	w->quality = quality;
+	w->nr_threads = nr_threads;
+	w->max_queued_frames = max_queued_frames;
+	w->riff_size_limit = riff_size_limit;
+	return w;
+}
+
+const char* mjpeg_avi_writer::get_supported_extensions() const
+{
+	return "avi";
+}
+
+const std::string& mjpeg_avi_writer::get_last_error() const
+{
+	return last_error;
+}
+
+bool mjpeg_avi_writer::scan_codecs(std::vector<std::string>& codec_names) const
+{
+	codec_names.clear();
+	codec_names.push_back("MJPG");
+	codec_names.push_back("raw");
+	return true;
+}
+
+bool mjpeg_avi_writer::set_codec(const std::string& codec_name)
+{
+	if (codec_name != "MJPG" && codec_name != "raw") {
+		last_error = "unsupported codec: ";
+		last_error += codec_name;
+		return false;
+	}
+	codec = codec_name;
+	return true;
+}
+
+std::string mjpeg_avi_writer::get_codec() const
+{
+	return codec;
+}
+
+bool mjpeg_avi_writer::set_void(const std::string& property, const std::string& value_type, const void* value_ptr)
+{
+	if (property == "quality")
+		quality = std::max(1, std::min(100, variant<int32_type>::get(value_type, value_ptr)));
+	else if (property == "nr_threads")
+		nr_threads = variant<uint32_type>::get(value_type, value_ptr);
+	else if (property == "max_queued_frames")
+		max_queued_frames = variant<uint32_type>::get(value_type, value_ptr);
+	else if (property == "riff_size_limit")
+		riff_size_limit = variant<uint32_type>::get(value_type, value_ptr);
+	else
+		return false;
+	return true;
+}
+
+bool mjpeg_avi_writer::get_void(const std::string& property, const std::string& value_type, void* value_ptr)
+{
+	if (property == "quality")
+		set_variant(int32_type(quality), value_type, value_ptr);
+	else if (property == "nr_threads")
+		set_variant(uint32_type(nr_threads), value_type, value_ptr);
+	else if (property == "max_queued_frames")
+		set_variant(uint32_type(max_queued_frames), value_type, value_ptr);
+	else if (property == "riff_size_limit")
+		set_variant(uint32_type(riff_size_limit), value_type, value_ptr);
+	else
+		return false;
+	return true;
+}
+
+std::string mjpeg_avi_writer::get_property_declarations()
+{
+	return "quality:int32;nr_threads:uint32;max_queued_frames:uint32;riff_size_limit:uint32";
+}
+
+bool mjpeg_avi_writer::open(const std::string& file_name, const data_format& image_format, float fps, bool)
+{
+	if (rw.is_open())
+		close();
+	if (image_format.get_component_type() != TI_UINT8 || image_format.is_packing()) {
+		last_error = "only 8 bit components supported";
+		return false;
+	}
+	component_format = image_format.get_standard_component_format();
+	switch (component_format) {
+	case CF_L: bytes_per_pixel = 1; break;
+	case CF_RGB:
+	case CF_BGR: bytes_per_pixel = 3; break;
+	case CF_RGBA:
+	case CF_BGRA: bytes_per_pixel = 4; break;
+	default:
+		last_error = "only L, RGB, RGBA, BGR and BGRA images supported";
+		return false;
+	}
+	width = image_format.get_width();
+	height = image_format.get_height();
+	if (width == 0 || height == 0 || fps <= 0) {
+		last_error = "invalid image size or frame rate";
+		return false;
+	}
+	if (!rw.open(file_name)) {
+		last_error = "could not open file: ";
+		last_error += file_name;
+		return false;
+	}
+	chunk_id = fourcc(codec == "raw" ? "00db" : "00dc");
+
+	std::memset(&avih, 0, sizeof(avih));
+	avih.micro_sec_per_frame = uint32_type(std::floor(1000000.0 / fps + 0.5));
+	avih.flags = avi::AVIF_HASINDEX;
+	avih.streams = 1;
+	avih.width = width;
+	avih.height = height;
+
+	std::memset(&strh, 0, sizeof(strh));
+	strh.fcc_type = fourcc("vids").id;
+	strh.fcc_handler = codec == "raw" ? avi::BI_RGB : fourcc("MJPG").id;
+	strh.scale = 1000;
+	strh.rate = uint32_type(std::floor(1000.0*fps + 0.5));
+	strh.quality = uint32_type(-1);
+	strh.frame[2] = int16_type(width);
+	strh.frame[3] = int16_type(height);
+
+	std::memset(&indx, 0, sizeof(indx));
+	indx.longs_per_entry = 4;
+	indx.index_type = avi::AVI_INDEX_OF_INDEXES;
+	indx.chunk_id = chunk_id.id;
+	super_index.clear();
+
+	nr_frames = nr_frames_first_riff = 0;
+	first_riff = true;
+	legacy_index.clear();
+	standard_index.clear();
+	if (!write_headers()) {
+		last_error = "could not write avi headers";
+		rw.close();
+		return false;
+	}
+
+	// encoding tasks are started by write_frame()
+	next_frame_index = next_written_index = 0;
+	nr_frames_in_pipeline = 0;
+	writing = failed = false;
+	max_nr_encoders = cgv::os::get_nr_parallel_threads(nr_threads);
+	nr_encoders = 0;
+	return true;
+}
+
+bool mjpeg_avi_writer::write_headers()
+{
+	avi::bitmap_info_header bih;
+	std::memset(&bih, 0, sizeof(bih));
+	bih.size = sizeof(bih);
+	bih.width = width;
+	bih.height = height;
+	bih.planes = 1;
+	bih.bit_count = 24;
+	bih.compression = strh.fcc_handler;
+	bih.size_image = codec == "raw" ? ((3 * width + 3) & ~3u)*height : width*height * 3;
+	unsigned char dmlh[248];
+	std::memset(dmlh, 0, sizeof(dmlh));
+	std::vector<unsigned char> indx_data(sizeof(indx) + max_nr_riffs*sizeof(avi::super_index_entry), 0);
+	std::memcpy(&indx_data[0], &indx, sizeof(indx));
+
+	riff_offset = rw.tell();
+	if (!rw.begin_list(fourcc("RIFF"), fourcc("AVI ")) || !rw.begin_list(fourcc("LIST"), fourcc("hdrl")))
+		return false;
+	avih_offset = rw.tell() + 8;
+	if (!rw.write_chunk(fourcc("avih"), &avih, sizeof(avih)) || !rw.begin_list(fourcc("LIST"), fourcc("strl")))
+		return false;
+	strh_offset = rw.tell() + 8;
+	if (!rw.write_chunk(fourcc("strh"), &strh, sizeof(strh)) || !rw.write_chunk(fourcc("strf"), &bih, sizeof(bih)))
+		return false;
+	indx_offset = rw.tell() + 8;
+	if (!rw.write_chunk(fourcc("indx"), &indx_data[0], unsigned(indx_data.size())) || !rw.end_list() || !rw.begin_list(fourcc("LIST"), fourcc("odml")))
+		return false;
+	dmlh_offset = rw.tell() + 8;
+	if (!rw.write_chunk(fourcc("dmlh"), dmlh, sizeof(dmlh)) || !rw.end_list() || !rw.end_list())
+		return false;
+	movi_offset = rw.tell() + 8;
+	return rw.begin_list(fourcc("LIST"), fourcc("movi"));
+}
+
+bool mjpeg_avi_writer::begin_riff()
+{
+	riff_offset = rw.tell();
+	movi_offset = riff_offset + 20;
+	return rw.begin_list(fourcc("RIFF"), fourcc("AVIX")) && rw.begin_list(fourcc("LIST"), fourcc("movi"));
+}
+
+bool mjpeg_avi_writer::end_riff()
+{
+	if (super_index.size() == max_nr_riffs) {
+		last_error = "maximum number of RIFF lists exceeded";
+		return false;
+	}
+	// standard index of frames in movi list
+	avi::standard_index_header ix;
+	std::memset(&ix, 0, sizeof(ix));
+	ix.longs_per_entry = 2;
+	ix.index_type = avi::AVI_INDEX_OF_CHUNKS;
+	ix.nr_entries_in_use = uint32_type(standard_index.size());
+	ix.chunk_id = chunk_id.id;
+	ix.base_offset = movi_offset;
+	std::vector<unsigned char> ix_data(sizeof(ix) + standard_index.size()*sizeof(avi::standard_index_entry));
+	std::memcpy(&ix_data[0], &ix, sizeof(ix));
+	if (!standard_index.empty())
+		std::memcpy(&ix_data[sizeof(ix)], &standard_index[0], standard_index.size()*sizeof(avi::standard_index_entry));
+	avi::super_index_entry sie;
+	sie.offset = rw.tell();
+	sie.size = uint32_type(ix_data.size() + 8);
+	sie.duration = uint32_type(standard_index.size());
+	super_index.push_back(sie);
+	if (!rw.write_chunk(fourcc("ix00"), &ix_data[0], unsigned(ix_data.size())) || !rw.end_list())
+		return false;
+	// legacy index of first RIFF list
+	if (first_riff) {
+		nr_frames_first_riff = nr_frames;
+		static const avi::legacy_index_entry dummy = { 0, 0, 0, 0 };
+		if (!rw.write_chunk(fourcc("idx1"), legacy_index.empty() ? &dummy : &legacy_index[0], unsigned(legacy_index.size()*sizeof(avi::legacy_index_entry))))
+			return false;
+		legacy_index.clear();
+		first_riff = false;
+	}
+	standard_index.clear();
+	return rw.end_list();
+}
+
+bool mjpeg_avi_writer::complete_headers()
+{
+	avih.total_frames = uint32_type(nr_frames_first_riff);
+	strh.length = uint32_type(nr_frames);
+	strh.suggested_buffer_size = avih.suggested_buffer_size;
+	indx.nr_entries_in_use = uint32_type(super_index.size());
+	uint32_type total_frames = uint32_type(nr_frames);
+	return rw.write_at(avih_offset, &avih, sizeof(avih)) &&
+		rw.write_at(strh_offset, &strh, sizeof(strh)) &&
+		rw.write_at(indx_offset, &indx, sizeof(indx)) &&
+		(super_index.empty() || rw.write_at(indx_offset + sizeof(indx), &super_index[0], super_index.size()*sizeof(avi::super_index_entry))) &&
+		rw.write_at(dmlh_offset, &total_frames, 4);
+}
+
+bool mjpeg_avi_writer::write_encoded_frame(const frame& f)
+{
+	unsigned size = unsigned(f.encoded.size());
+	// start new RIFF list if the frame together with the indices would exceed the size limit
+	long long index_size = 32 + 8 * (standard_index.size() + 1) + (first_riff ? 8 + 16 * (legacy_index.size() + 1) : 0);
+	if (!standard_index.empty() && rw.tell() + 8 + size + 1 + index_size - riff_offset > (long long)riff_size_limit)
+		if (!end_riff() || !begin_riff())
+			return false;
+	long long offset = rw.tell();
+	if (!rw.write_chunk(chunk_id, f.encoded.empty() ? 0 : &f.encoded[0], size))
+		return false;
+	avi::standard_index_entry sie = { uint32_type(offset + 8 - movi_offset), size };
+	standard_index.push_back(sie);
+	if (first_riff) {
+		avi::legacy_index_entry lie = { chunk_id.id, avi::AVIIF_KEYFRAME, uint32_type(offset - movi_offset), size };
+		legacy_index.push_back(lie);
+	}
+	avih.suggested_buffer_size = std::max(avih.suggested_buffer_size, size + 8);
+	++nr_frames;
+	return true;
+}
+
+void mjpeg_avi_writer::encode_raw(frame& f) const
+{
+	unsigned row_size = (3 * width + 3) & ~3u;
+	f.encoded.assign(size_t(row_size)*height, 0);
+	bool swap = component_format == CF_RGB || component_format == CF_RGBA;
+	for (unsigned y = 0; y < height; ++y) {
+		const unsigned char* src = &f.pixels[size_t(y)*width*bytes_per_pixel];
+		unsigned char* dst = &f.encoded[size_t(height - 1 - y)*row_size];
+		if (component_format == CF_L) {
+			for (unsigned x = 0; x < width; ++x, dst += 3)
+				dst[0] = dst[1] = dst[2] = src[x];
+			continue;
+		}
+		for (unsigned x = 0; x < width; ++x, src += bytes_per_pixel, dst += 3) {
+			dst[0] = src[swap ? 2 : 0];
+			dst[1] = src[1];
+			dst[2] = src[swap ? 0 : 2];
+		}
+	}
+}
+
+void mjpeg_avi_writer::encode_queued_frames(bool is_task)
+{
+	jpeg_compress_struct cinfo;
+	jump_error_mgr jerr;
+	cinfo.err = jpeg_std_error(&jerr.pub);
+	jerr.pub.error_exit = jump_error_exit;
+	jerr.pub.output_message = silent_output_message;
+	jpeg_create_compress(&cinfo);
+	std::vector<unsigned char> row(3 * width);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!queued_frames.empty()) {
+		frame* f = queued_frames.front();
+		queued_frames.pop_front();
+		lock.unlock();
+		bool success = true;
+		if (codec == "raw")
+			encode_raw(*f);
+		else
+			success = encode_jpeg(cinfo, jerr, quality, component_format, width, height, &f->pixels[0], &row[0], f->encoded);
+		lock.lock();
+		if (!success && !failed) {
+			failed = true;
+			last_error = "jpeg compression failed";
+		}
+		encoded_frames[f->index] = f;
+		// the first thread that completes the next frame in order writes all consecutive encoded frames
+		if (writing)
+			continue;
+		writing = true;
+		while (!encoded_frames.empty() && encoded_frames.begin()->first == next_written_index) {
+			frame* g = encoded_frames.begin()->second;
+			encoded_frames.erase(encoded_frames.begin());
+			bool skip = failed;
+			lock.unlock();
+			bool written = skip || write_encoded_frame(*g);
+			lock.lock();
+			if (!written && !failed) {
+				failed = true;
+				last_error = "could not write frame to file";
+			}
+			++next_written_index;
+			free_frames.push_back(g);
+			--nr_frames_in_pipeline;
+			space_available.notify_all();
+		}
+		writing = false;
+	}
+	// tasks end under the lock, such that write_frame() starts a new task for frames queued afterwards
+	if (is_task)
+		--nr_encoders;
+	lock.unlock();
+	jpeg_destroy_compress(&cinfo);
+}
+
+bool mjpeg_avi_writer::write_frame(const const_data_view& image_data)
+{
+	if (!rw.is_open()) {
+		last_error = "no video file opened";
+		return false;
+	}
+	const data_format* df = image_data.get_format();
+	if (!df || df->get_width() != width || df->get_height() != height || df->get_standard_component_format() != component_format) {
+		last_error = "frame format does not match the format passed to open";
+		return false;
+	}
+	size_t max_frames = max_queued_frames == 0 ? 2 * max_nr_encoders : max_queued_frames;
+	frame* f = 0;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (!failed && nr_frames_in_pipeline >= max_frames) {
+			// help with encoding, which also avoids waiting for tasks that cannot run if called from a task
+			if (!queued_frames.empty()) {
+				lock.unlock();
+				encode_queued_frames(false);
+				lock.lock();
+			}
+			else
+				space_available.wait(lock);
+		}
+		if (failed)
+			return false;
+		if (free_frames.empty())
+			f = new frame();
+		else {
+			f = free_frames.back();
+			free_frames.pop_back();
+		}
+		++nr_frames_in_pipeline;
+		f->index = next_frame_index++;
+	}
+	// copy rows without holding the lock
+	size_t row_size = size_t(width)*bytes_per_pixel;
+	f->pixels.resize(row_size*height);
+	const unsigned char* src = image_data.get_ptr<unsigned char>();
+	size_t step = image_data.get_step_size(0);
+	if (step == row_size)
+		std::memcpy(&f->pixels[0], src, row_size*height);
+	else
+		for (unsigned y = 0; y < height; ++y)
+			std::memcpy(&f->pixels[y*row_size], src + y*step, row_size);
+	bool start_task;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queued_frames.push_back(f);
+		start_task = nr_encoders < max_nr_encoders;
+		if (start_task)
+			++nr_encoders;
+	}
+	if (start_task)
+		encoder_tasks.run([this]() { encode_queued_frames(true); });
+	return true;
+}
+
+bool mjpeg_avi_writer::close()
+{
+	if (!rw.is_open())
+		return false;
+	encoder_tasks.wait();
+	bool success = !failed;
+	for (auto& e : encoded_frames)
+		delete e.second;
+	encoded_frames.clear();
+	for (auto f : free_frames)
+		delete f;
+	free_frames.clear();
+	if (!end_riff() || !complete_headers()) {
+		if (success)
+			last_error = "could not complete avi file";
+		success = false;
+	}
+	return rw.close() && success;
+}
+
+#include <cgv/base/register.h>
+
+cgv::base::object_registration<mjpeg_avi_writer> mjpeg_avi_write_reg("");
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cgv/media/video/video_writer.h>
+#include <cgv/media/riff.h>
+#include <cgv/data/component_format.h>
+#include <cgv/os/task_scheduler.h>
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include "avi_structs.h"
+
+using namespace cgv::media::video;
+
+#include "lib_begin.h"
+
+/** portable video writer for avi files that stores frames either as motion jpeg (codec "MJPG") or as uncompressed
+	24 bit bitmaps (codec "raw"). Files grow beyond 1GB with the OpenDML extension, where each RIFF list is indexed by
+	a standard index and the first RIFF list additionally by a legacy idx1 chunk for older players.
+	write_frame() only copies the frame into a buffer of a bounded pool and returns. Encoding tasks of the cgv::os
+	scheduler compress the buffered frames in parallel, and the thread that completes the next frame in order writes
+	it and all following completed frames to the file. If all buffers are in use, write_frame() encodes queued frames
+	itself or waits for the oldest frame to be written. Supported input formats are 8 bit L, RGB, RGBA, BGR and BGRA
+	images. The properties "quality" (1 to 100), "nr_threads" (maximum number of encoding tasks, 0 for
+	cgv::os::get_nr_parallel_threads()), "max_queued_frames" (0 for twice the number of encoding tasks) and
+	"riff_size_limit" (in bytes) need to be set before open(). */
+class CGV_API mjpeg_avi_writer : public abst_video_writer
+{
+protected:
+	/// one frame in the pipeline
+	struct frame
+	{
+		/// index of frame in video
+		size_t index;
+		/// tightly packed copy of the input rows
+		std::vector<unsigned char> pixels;
+		/// chunk data of the frame
+		std::vector<unsigned char> encoded;
+	};
+	mutable std::string last_error;
+	/// selected codec
+	std::string codec;
+	/// jpeg quality in [1,100]
+	int quality;
+	/// maximum number of encoding tasks, 0 selects cgv::os::get_nr_parallel_threads()
+	unsigned nr_threads;
+	/// maximum number of frames in the pipeline, 0 selects twice the number of encoding tasks
+	unsigned max_queued_frames;
+	/// maximum size of one RIFF list in bytes
+	unsigned riff_size_limit;
+
+	/**@name frame format*/
+	//@{
+	unsigned width, height;
+	cgv::data::ComponentFormat component_format;
+	unsigned bytes_per_pixel;
+	//@}
+
+	/**@name file state*/
+	//@{
+	cgv::media::riff_writer rw;
+	avi::main_header avih;
+	avi::stream_header strh;
+	avi::super_index_header indx;
+	std::vector<avi::super_index_entry> super_index;
+	/// file offsets of the headers that are completed when closing the file
+	long long avih_offset, strh_offset, indx_offset, dmlh_offset;
+	/// file offsets of the current RIFF list and of the fourcc of the current movi list
+	long long riff_offset, movi_offset;
+	/// chunk id of frames
+	cgv::media::fourcc chunk_id;
+	/// number of written frames in total and in first RIFF list
+	size_t nr_frames, nr_frames_first_riff;
+	/// whether the first RIFF list is written
+	bool first_riff;
+	/// index of frames in the first RIFF list
+	std::vector<avi::legacy_index_entry> legacy_index;
+	/// index of frames in the current RIFF list
+	std::vector<avi::standard_index_entry> standard_index;
+	//@}
+
+	/**@name encoding pipeline*/
+	//@{
+	/// tasks encoding queued frames
+	cgv::os::task_group encoder_tasks;
+	/// maximum number of encoding tasks of the opened file
+	unsigned max_nr_encoders;
+	/// number of running or queued encoding tasks
+	unsigned nr_encoders;
+	std::mutex mutex;
+	std::condition_variable space_available;
+	/// copied frames waiting to be encoded
+	std::deque<frame*> queued_frames;
+	/// encoded frames waiting to be written in order
+	std::map<size_t, frame*> encoded_frames;
+	/// frames that can be reused
+	std::vector<frame*> free_frames;
+	/// number of frames that are queued, encoded or written
+	size_t nr_frames_in_pipeline;
+	/// index of next frame passed to write_frame and of next frame to be written to file
+	size_t next_frame_index, next_written_index;
+	/// whether a thread is writing frames to the file
+	bool writing;
+	/// whether encoding or writing failed
+	bool failed;
+	//@}
+
+	/// encode and write queued frames until the queue is empty, where encoding tasks leave nr_encoders when done
+	void encode_queued_frames(bool is_task);
+	/// convert frame to bottom up BGR rows
+	void encode_raw(frame& f) const;
+	/// write frame as chunk and start a new RIFF list if necessary, called by one thread at a time
+	bool write_encoded_frame(const frame& f);
+	/// write headers of file and start movi list
+	bool write_headers();
+	/// start an AVIX RIFF list
+	bool begin_riff();
+	/// write index chunks and finish movi and RIFF lists
+	bool end_riff();
+	/// complete the headers with the final frame counts and indices
+	bool complete_headers();
+	/// abstract interface for the setter of a dynamic property
+	bool set_void(const std::string& property, const std::string& type, const void* value);
+	/// abstract interface for the getter of a dynamic property
+	bool get_void(const std::string& property, const std::string& type, void* value);
+	/// return a semicolon separated list of property declarations
+	std::string get_property_declarations();
+public:
+	/// construct writer with MJPG codec
+	mjpeg_avi_writer();
+	/// close file if still open
+	~mjpeg_avi_writer();
+	/// returns the type name of the chosen video writer implementation
+	std::string get_type_name() const;
+	/// construct a copy of the video writer
+	abst_video_writer* clone() const;
+	/// return a string containing a colon separated list of extensions that can be read with this video writer
+	const char* get_supported_extensions() const;
+	/// return a reference to the last error message
+	const std::string& get_last_error() const;
+	/// return the supported codecs "MJPG" and "raw"
+	bool scan_codecs(std::vector<std::string>& codec_names) const;
+	/// select codec "MJPG" or "raw"
+	bool set_codec(const std::string& codec_name);
+	/// return the currently selected codec
+	std::string get_codec() const;
+	/// open file from given file name, format and fps
+	bool open(const std::string& file_name, const cgv::data::data_format& image_format, float fps, bool interactive);
+	/// copy the frame into the pipeline and return without waiting for its encoding
+	bool write_frame(const cgv::data::const_data_view& image_data);
+	/// wait for all frames to be written, complete and close the video file
+	bool close();
+};
+
+#include <cgv/config/lib_end.h>
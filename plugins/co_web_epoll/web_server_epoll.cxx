@@ -0,0 +1,1003 @@
+#include "web_server_epoll.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <strings.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+
+using namespace cgv::os;
+
+namespace {
+
+unsigned nr_worker_threads = 0;
+unsigned keep_alive_timeout = 15;
+size_t max_stream_backlog = 32 << 20;
+/// maximum size of the request header
+const size_t max_header_size = 64 << 10;
+/// stop reading from a connection when this many bytes of pipelined requests wait for being processed, which also limits the size of a request
+const size_t max_input_size = 1 << 20;
+/// epoll identifiers of the listening socket and the wake up event, connections use larger identifiers
+const uint64_t listen_id = 0;
+const uint64_t wake_id = 1;
+
+/// part of a response that is either held in memory or a range of an open file; offset is advanced while sending till size is reached
+struct segment
+{
+	std::string data;
+	int file;
+	off_t offset;
+	off_t size;
+	segment() : file(-1), offset(0), size(0) {}
+	explicit segment(std::string& _data) : file(-1), offset(0), size(_data.size()) { data.swap(_data); }
+	segment(int _file, off_t _size) : file(_file), offset(0), size(_size) {}
+	size_t get_nr_remaining_bytes() const { return size_t(size - offset); }
+};
+
+template <typename C>
+void release_segments(C& segments)
+{
+	for (typename C::iterator i = segments.begin(); i != segments.end(); ++i)
+		if (i->file != -1)
+			::close(i->file);
+	segments.clear();
+}
+
+class stream_impl;
+
+/// data produced by a worker or a stream for one connection that is handed to the event loop
+struct output
+{
+	uint64_t connection_id;
+	std::vector<segment> segments;
+	/// stream of a chunked response whose header is contained in this output
+	std::weak_ptr<stream_impl> stream;
+	/// whether this output completes the current response
+	bool complete;
+	/// whether the connection stays open after the response is complete
+	bool keep_alive;
+	output(uint64_t id = 0, bool _complete = true, bool _keep_alive = true) : connection_id(id), complete(_complete), keep_alive(_keep_alive) {}
+};
+
+/// queue of outputs that wakes up the event loop through an eventfd. It can outlive the server as long as streams reference it.
+struct output_queue
+{
+	std::mutex mtx;
+	std::vector<output> outputs;
+	int event_fd;
+	/// set by the server on termination, after which no outputs are accepted
+	bool closed;
+	output_queue() : closed(false) { event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC); }
+	~output_queue()
+	{
+		for (size_t i = 0; i < outputs.size(); ++i)
+			release_segments(outputs[i].segments);
+		::close(event_fd);
+	}
+	void wake()
+	{
+		uint64_t one = 1;
+		ssize_t res = ::write(event_fd, &one, sizeof(one));
+		(void)res;
+	}
+	/// append output and wake up the event loop
+	void push(output& o)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			if (closed) {
+				release_segments(o.segments);
+				return;
+			}
+			outputs.push_back(std::move(o));
+		}
+		wake();
+	}
+};
+
+/// chunked response stream, whose state is protected by the mutex of the output queue
+class stream_impl : public http_stream
+{
+	std::shared_ptr<output_queue> queue;
+	uint64_t connection_id;
+	bool keep_alive;
+	/// chunks written before the response header has been queued
+	std::vector<segment> pending;
+	bool started, ended;
+public:
+	/// cleared by the event loop when the connection is closed
+	std::atomic<bool> open;
+	/// number of bytes waiting on the connection as updated by the event loop
+	std::atomic<size_t> backlog;
+
+	stream_impl(const std::shared_ptr<output_queue>& _queue, uint64_t id, bool _keep_alive) :
+		queue(_queue), connection_id(id), keep_alive(_keep_alive), started(false), ended(false), open(true), backlog(0) {}
+	~stream_impl()
+	{
+		close();
+	}
+	bool write(const void* data, size_t size)
+	{
+		// a chunk of size zero would terminate the response
+		if (size == 0)
+			return is_open();
+		if (!open || backlog > max_stream_backlog)
+			return false;
+		char header[24];
+		int n = std::sprintf(header, "%zx\r\n", size);
+		std::string chunk;
+		chunk.reserve(n + size + 2);
+		chunk.append(header, n);
+		chunk.append(static_cast<const char*>(data), size);
+		chunk.append("\r\n", 2);
+		{
+			std::lock_guard<std::mutex> lock(queue->mtx);
+			if (ended || queue->closed)
+				return false;
+			backlog += chunk.size();
+			if (!started) {
+				pending.push_back(segment(chunk));
+				return true;
+			}
+			output o(connection_id, false);
+			o.segments.push_back(segment(chunk));
+			queue->outputs.push_back(std::move(o));
+		}
+		queue->wake();
+		return true;
+	}
+	bool is_open() const
+	{
+		return open;
+	}
+	size_t get_nr_pending_bytes() const
+	{
+		return backlog;
+	}
+	void close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(queue->mtx);
+			if (ended)
+				return;
+			ended = true;
+			open = false;
+			// the worker appends the terminating chunk to the header if the response has not been started yet
+			if (!started || queue->closed)
+				return;
+			std::string terminator("0\r\n\r\n");
+			output o(connection_id, true, keep_alive);
+			o.segments.push_back(segment(terminator));
+			queue->outputs.push_back(std::move(o));
+		}
+		queue->wake();
+	}
+	/// called by the worker with locked queue mutex to append the chunks written so far to the response header
+	void start(output& header)
+	{
+		started = true;
+		for (size_t i = 0; i < pending.size(); ++i)
+			header.segments.push_back(std::move(pending[i]));
+		pending.clear();
+		if (ended) {
+			std::string terminator("0\r\n\r\n");
+			header.segments.push_back(segment(terminator));
+		}
+		else
+			header.complete = false;
+	}
+	/// called by the worker with locked queue mutex if the response does not use the stream
+	void discard()
+	{
+		started = ended = true;
+		open = false;
+		release_segments(pending);
+	}
+};
+
+/// state of a client connection, which is only accessed by the event loop
+struct connection
+{
+	int fd;
+	uint64_t id;
+	/// received bytes that have not been parsed yet
+	std::string in;
+	/// position in the received bytes from which to search for the end of the header
+	size_t scan_pos;
+	/// segments waiting for being sent and their total number of bytes
+	std::deque<segment> out;
+	size_t out_bytes;
+	/// whether a request is processed by a worker or its response is streamed
+	bool busy;
+	/// whether to close the connection after the current response
+	bool close_after_output;
+	/// whether the client shut down its side of the connection
+	bool peer_closed;
+	/// whether the connection is to be flushed after processing of outputs
+	bool flush_pending;
+	/// whether epoll reported a hang up or an error, after which the connection is no longer registered
+	bool hung_up;
+	/// currently registered epoll events
+	uint32_t events;
+	std::weak_ptr<stream_impl> stream;
+	time_t last_activity;
+	connection(int _fd, uint64_t _id) : fd(_fd), id(_id), scan_pos(0), out_bytes(0), busy(false),
+		close_after_output(false), peer_closed(false), flush_pending(false), hung_up(false), events(EPOLLIN), last_activity(time(0)) {}
+};
+
+/// parsed request that waits for being processed by a worker
+struct job
+{
+	uint64_t connection_id;
+	bool keep_alive;
+	http_request request;
+};
+
+bool equal_ignore_case(const char* b, const char* e, const char* literal)
+{
+	size_t n = std::strlen(literal);
+	return size_t(e - b) == n && strncasecmp(b, literal, n) == 0;
+}
+
+bool contains_ignore_case(const char* b, const char* e, const char* literal)
+{
+	size_t n = std::strlen(literal);
+	for (; b + n <= e; ++b)
+		if (strncasecmp(b, literal, n) == 0)
+			return true;
+	return false;
+}
+
+int hex_value(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+std::string url_decode(const char* b, const char* e)
+{
+	std::string s;
+	s.reserve(e - b);
+	for (; b < e; ++b) {
+		if (*b == '+')
+			s += ' ';
+		else if (*b == '%' && e - b > 2 && hex_value(b[1]) >= 0 && hex_value(b[2]) >= 0) {
+			s += char(16 * hex_value(b[1]) + hex_value(b[2]));
+			b += 2;
+		}
+		else
+			s += *b;
+	}
+	return s;
+}
+
+void split_target(const char* b, const char* e, http_request& r)
+{
+	const char* q = static_cast<const char*>(std::memchr(b, '?', e - b));
+	r.path = url_decode(b, q ? q : e);
+	if (!q)
+		return;
+	for (b = q + 1; b < e; ) {
+		const char* amp = static_cast<const char*>(std::memchr(b, '&', e - b));
+		if (!amp)
+			amp = e;
+		const char* eq = static_cast<const char*>(std::memchr(b, '=', amp - b));
+		if (amp > b)
+			r.params[url_decode(b, eq ? eq : amp)] = eq ? url_decode(eq + 1, amp) : std::string();
+		b = amp + 1;
+	}
+}
+
+std::string base64_decode(const char* b, const char* e)
+{
+	std::string s;
+	unsigned bits = 0;
+	int nr_bits = 0;
+	for (; b < e; ++b) {
+		char c = *b;
+		int v;
+		if (c >= 'A' && c <= 'Z') v = c - 'A';
+		else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+		else if (c >= '0' && c <= '9') v = c - '0' + 52;
+		else if (c == '+') v = 62;
+		else if (c == '/') v = 63;
+		else break;
+		bits = (bits << 6) | v;
+		nr_bits += 6;
+		if (nr_bits >= 8) {
+			nr_bits -= 8;
+			s += char((bits >> nr_bits) & 255);
+		}
+	}
+	return s;
+}
+
+/** parse the next request from the received bytes of a connection without copying header lines.
+    Returns 1 if a request has been extracted, 0 if more bytes are needed, -1 on malformed requests and
+    -2 on requests whose header and body exceed max_input_size, such that they could never be received. */
+int parse_request(connection& c, job& j)
+{
+	const char* data = c.in.data();
+	size_t size = c.in.size();
+	const void* found = size > c.scan_pos ? memmem(data + c.scan_pos, size - c.scan_pos, "\r\n\r\n", 4) : 0;
+	if (!found) {
+		if (size > max_header_size)
+			return -1;
+		c.scan_pos = size > 3 ? size - 3 : 0;
+		return 0;
+	}
+	const char* header_end = static_cast<const char*>(found);
+	c.scan_pos = header_end - data;
+	http_request& r = j.request;
+	// request line
+	const char* line_end = static_cast<const char*>(std::memchr(data, '\r', header_end + 2 - data));
+	const char* sp1 = static_cast<const char*>(std::memchr(data, ' ', line_end - data));
+	if (!sp1)
+		return -1;
+	const char* target = sp1 + 1;
+	const char* sp2 = static_cast<const char*>(std::memchr(target, ' ', line_end - target));
+	if (!sp2)
+		return -1;
+	bool http_1_0 = equal_ignore_case(sp2 + 1, line_end, "HTTP/1.0");
+	j.keep_alive = !http_1_0;
+	size_t content_length = 0;
+	// header fields
+	for (const char* l = line_end + 2; l < header_end; ) {
+		const char* e = static_cast<const char*>(std::memchr(l, '\r', header_end + 2 - l));
+		const char* colon = static_cast<const char*>(std::memchr(l, ':', e - l));
+		if (colon) {
+			const char* v = colon + 1;
+			while (v < e && (*v == ' ' || *v == '\t'))
+				++v;
+			switch (colon - l) {
+			case 6:
+				if (equal_ignore_case(l, colon, "Accept"))
+					r.accept.assign(v, e);
+				break;
+			case 10:
+				if (equal_ignore_case(l, colon, "User-Agent"))
+					r.user_agent.assign(v, e);
+				else if (equal_ignore_case(l, colon, "Connection")) {
+					if (contains_ignore_case(v, e, "close"))
+						j.keep_alive = false;
+					else if (contains_ignore_case(v, e, "keep-alive"))
+						j.keep_alive = true;
+				}
+				break;
+			case 13:
+				if (equal_ignore_case(l, colon, "Authorization") && e - v > 6 && strncasecmp(v, "Basic ", 6) == 0) {
+					std::string decoded = base64_decode(v + 6, e);
+					size_t pos = decoded.find(':');
+					r.authentication_given = true;
+					r.username = decoded.substr(0, pos);
+					r.password = pos == std::string::npos ? std::string() : decoded.substr(pos + 1);
+				}
+				break;
+			case 14:
+				if (equal_ignore_case(l, colon, "Content-Length"))
+					content_length = std::strtoul(v, 0, 10);
+				break;
+			case 15:
+				if (equal_ignore_case(l, colon, "Accept-Language"))
+					r.accept_language.assign(v, e);
+				else if (equal_ignore_case(l, colon, "Accept-Encoding"))
+					r.accept_encoding.assign(v, e);
+				break;
+			case 17:
+				// chunked request bodies are not supported
+				if (equal_ignore_case(l, colon, "Transfer-Encoding"))
+					return -1;
+				break;
+			}
+		}
+		l = e + 2;
+	}
+	size_t request_size = header_end + 4 - data;
+	if (request_size > max_input_size || content_length > max_input_size - request_size)
+		return -2;
+	if (size < request_size + content_length)
+		return 0;
+	r.method.assign(data, sp1);
+	split_target(target, sp2, r);
+	r.request.assign(data, header_end + 2);
+	r.content.assign(header_end + 4, content_length);
+	r.status = "200 OK";
+	c.in.erase(0, request_size + content_length);
+	c.scan_pos = 0;
+	return 1;
+}
+
+void append_date(std::string& head)
+{
+	static thread_local time_t last_time = 0;
+	static thread_local char date[64];
+	time_t now = time(0);
+	if (now != last_time) {
+		tm t;
+		gmtime_r(&now, &t);
+		strftime(date, sizeof(date), "Date: %a, %d %b %Y %H:%M:%S GMT\r\n", &t);
+		last_time = now;
+	}
+	head += date;
+}
+
+const char* guess_content_type(const std::string& file_name)
+{
+	static const char* types[][2] = {
+		{ ".html", "text/html" }, { ".htm", "text/html" }, { ".css", "text/css" }, { ".js", "application/javascript" },
+		{ ".json", "application/json" }, { ".txt", "text/plain" }, { ".png", "image/png" }, { ".jpg", "image/jpeg" },
+		{ ".jpeg", "image/jpeg" }, { ".svg", "image/svg+xml" }, { ".wasm", "application/wasm" }
+	};
+	size_t pos = file_name.find_last_of('.');
+	if (pos != std::string::npos)
+		for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i)
+			if (strcasecmp(file_name.c_str() + pos, types[i][0]) == 0)
+				return types[i][1];
+	return "application/octet-stream";
+}
+
+/// server instance that is stored in the user data of a web_server
+class epoll_server
+{
+	web_server* instance;
+	std::shared_ptr<output_queue> queue;
+	int listen_fd, epoll_fd;
+	std::atomic<bool> stop_request;
+	/**@name termination of the event loop */
+	//@{
+	std::mutex run_mtx;
+	std::condition_variable run_cv;
+	bool finished;
+	//@}
+	/**@name worker pool */
+	//@{
+	std::vector<std::thread> workers;
+	std::mutex job_mtx;
+	std::condition_variable job_cv;
+	std::deque<job> jobs;
+	bool stop_workers;
+	//@}
+	/**@name connections that are only accessed by the event loop */
+	//@{
+	std::unordered_map<uint64_t, connection*> connections;
+	uint64_t next_connection_id;
+	char receive_buffer[64 << 10];
+	//@}
+
+	void update_events(connection& c)
+	{
+		if (c.hung_up)
+			return;
+		uint32_t events = 0;
+		if (!c.peer_closed && c.in.size() < max_input_size)
+			events |= EPOLLIN;
+		if (!c.out.empty())
+			events |= EPOLLOUT;
+		if (events == c.events)
+			return;
+		epoll_event ev;
+		ev.events = events;
+		ev.data.u64 = c.id;
+		epoll_ctl(epoll_fd, EPOLL_CTL_MOD, c.fd, &ev);
+		c.events = events;
+	}
+	void close_connection(connection* c)
+	{
+		epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c->fd, 0);
+		::close(c->fd);
+		release_segments(c->out);
+		std::shared_ptr<stream_impl> s = c->stream.lock();
+		if (s)
+			s->open = false;
+		connections.erase(c->id);
+		delete c;
+	}
+	void accept_connections()
+	{
+		for (;;) {
+			int fd = accept4(listen_fd, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if (fd == -1) {
+				if (errno == EINTR || errno == ECONNABORTED)
+					continue;
+				return;
+			}
+			int one = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+			connection* c = new connection(fd, next_connection_id++);
+			epoll_event ev;
+			ev.events = c->events;
+			ev.data.u64 = c->id;
+			if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+				::close(fd);
+				delete c;
+				continue;
+			}
+			connections[c->id] = c;
+		}
+	}
+	/// answer malformed or too large requests with the given status and close the connection afterwards
+	void reject_request(connection& c, const char* status)
+	{
+		std::string answer("HTTP/1.1 ");
+		answer += status;
+		answer += "\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+		c.out_bytes += answer.size();
+		c.out.push_back(segment(answer));
+		c.close_after_output = true;
+		c.in.clear();
+	}
+	/// pass the next complete request to the workers if the connection is idle, return false if the connection has been closed
+	bool dispatch(connection& c)
+	{
+		if (!c.busy && !c.close_after_output) {
+			job j;
+			int res = parse_request(c, j);
+			if (res == 1) {
+				j.connection_id = c.id;
+				c.busy = true;
+				{
+					std::lock_guard<std::mutex> lock(job_mtx);
+					jobs.push_back(std::move(j));
+				}
+				job_cv.notify_one();
+			}
+			else if (res < 0) {
+				reject_request(c, res == -1 ? "400 Bad Request" : "413 Payload Too Large");
+				return flush(c);
+			}
+		}
+		if (c.peer_closed && !c.busy && c.out.empty()) {
+			close_connection(&c);
+			return false;
+		}
+		update_events(c);
+		return true;
+	}
+	/// read available bytes and dispatch requests, return false if the connection has been closed
+	bool receive(connection& c)
+	{
+		for (;;) {
+			ssize_t n = recv(c.fd, receive_buffer, sizeof(receive_buffer), 0);
+			if (n > 0) {
+				c.in.append(receive_buffer, n);
+				if (size_t(n) < sizeof(receive_buffer) || c.in.size() >= max_input_size)
+					break;
+			}
+			else if (n == 0) {
+				c.peer_closed = true;
+				break;
+			}
+			else if (errno == EINTR)
+				continue;
+			else if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			else {
+				close_connection(&c);
+				return false;
+			}
+		}
+		c.last_activity = time(0);
+		return dispatch(c);
+	}
+	/** epoll reports hang ups and errors independently of the registered events, such that a connection waiting for a
+		worker would be reported in every iteration. It is removed from epoll instead and closed once its response has
+		been flushed, which fails on a hung up connection. Return false if the connection has been closed. */
+	bool hang_up(connection& c)
+	{
+		c.peer_closed = true;
+		c.hung_up = true;
+		epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c.fd, 0);
+		c.events = 0;
+		if (!c.out.empty())
+			return flush(c);
+		return true;
+	}
+	/// send as much of the pending output as possible, return false if the connection has been closed
+	bool flush(connection& c)
+	{
+		while (!c.out.empty()) {
+			segment& s = c.out.front();
+			ssize_t n;
+			if (s.file == -1) {
+				// gather consecutive memory segments into one system call
+				iovec iov[16];
+				int cnt = 0;
+				for (std::deque<segment>::iterator i = c.out.begin(); i != c.out.end() && i->file == -1 && cnt < 16; ++i, ++cnt) {
+					iov[cnt].iov_base = &i->data[0] + i->offset;
+					iov[cnt].iov_len = i->get_nr_remaining_bytes();
+				}
+				n = writev(c.fd, iov, cnt);
+				if (n > 0) {
+					c.out_bytes -= n;
+					while (n > 0) {
+						segment& f = c.out.front();
+						size_t r = f.get_nr_remaining_bytes();
+						if (size_t(n) < r) {
+							f.offset += n;
+							break;
+						}
+						n -= r;
+						c.out.pop_front();
+					}
+					continue;
+				}
+			}
+			else {
+				n = sendfile(c.fd, s.file, &s.offset, s.get_nr_remaining_bytes());
+				if (n > 0) {
+					c.out_bytes -= n;
+					if (s.offset == s.size) {
+						::close(s.file);
+						c.out.pop_front();
+					}
+					continue;
+				}
+				// file has been truncated after its size was sent in the header
+				if (n == 0) {
+					close_connection(&c);
+					return false;
+				}
+			}
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			close_connection(&c);
+			return false;
+		}
+		c.last_activity = time(0);
+		std::shared_ptr<stream_impl> s = c.stream.lock();
+		if (s)
+			s->backlog = c.out_bytes;
+		if (c.out.empty() && !c.busy && c.close_after_output) {
+			close_connection(&c);
+			return false;
+		}
+		update_events(c);
+		return true;
+	}
+	/// append outputs of workers and streams to their connections and send them
+	void process_outputs()
+	{
+		uint64_t value;
+		while (read(queue->event_fd, &value, sizeof(value)) > 0)
+			;
+		std::vector<output> outputs;
+		{
+			std::lock_guard<std::mutex> lock(queue->mtx);
+			outputs.swap(queue->outputs);
+		}
+		std::vector<connection*> to_be_flushed;
+		for (size_t i = 0; i < outputs.size(); ++i) {
+			output& o = outputs[i];
+			std::unordered_map<uint64_t, connection*>::iterator it = connections.find(o.connection_id);
+			if (it == connections.end()) {
+				release_segments(o.segments);
+				continue;
+			}
+			connection& c = *it->second;
+			for (size_t j = 0; j < o.segments.size(); ++j) {
+				c.out_bytes += o.segments[j].get_nr_remaining_bytes();
+				c.out.push_back(std::move(o.segments[j]));
+			}
+			if (!o.stream.expired())
+				c.stream = o.stream;
+			if (o.complete) {
+				c.busy = false;
+				c.stream.reset();
+				if (!o.keep_alive)
+					c.close_after_output = true;
+			}
+			if (!c.flush_pending) {
+				c.flush_pending = true;
+				to_be_flushed.push_back(&c);
+			}
+		}
+		for (size_t i = 0; i < to_be_flushed.size(); ++i) {
+			connection& c = *to_be_flushed[i];
+			c.flush_pending = false;
+			// continue with pipelined requests once the previous response is complete
+			if (flush(c) && !c.busy)
+				dispatch(c);
+		}
+	}
+	void close_idle_connections()
+	{
+		time_t now = time(0);
+		std::vector<connection*> idle;
+		for (std::unordered_map<uint64_t, connection*>::iterator it = connections.begin(); it != connections.end(); ++it) {
+			connection* c = it->second;
+			if (!c->busy && (c->hung_up || (c->out.empty() && now - c->last_activity > time_t(keep_alive_timeout))))
+				idle.push_back(c);
+		}
+		for (size_t i = 0; i < idle.size(); ++i)
+			close_connection(idle[i]);
+	}
+	/// compose the response of a processed request
+	void respond(job& j, std::shared_ptr<stream_impl>& s)
+	{
+		http_request& r = j.request;
+		output o(j.connection_id, true, j.keep_alive);
+		std::string head("HTTP/1.1 ");
+		head.reserve(256);
+		int file = -1;
+		struct stat st;
+		if (!r.streaming && !r.file_name.empty()) {
+			file = open(r.file_name.c_str(), O_RDONLY | O_CLOEXEC);
+			if (file != -1 && (fstat(file, &st) == -1 || !S_ISREG(st.st_mode))) {
+				::close(file);
+				file = -1;
+			}
+			if (file == -1) {
+				r.status = "404 Not Found";
+				r.answer = "<html><body><h1>Not Found</h1></body></html>";
+				r.content_type.clear();
+			}
+			else if (r.content_type.empty())
+				r.content_type = guess_content_type(r.file_name);
+		}
+		if (!r.auth_realm.empty()) {
+			head += "401 Unauthorized\r\nWWW-Authenticate: Basic realm=\"";
+			head += r.auth_realm;
+			head += "\"\r\n";
+		}
+		else {
+			head += r.status;
+			head += "\r\n";
+		}
+		append_date(head);
+		head += "Server: cgv web server\r\n";
+		head += j.keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+		head += "Content-Type: ";
+		head += r.content_type.empty() ? "text/html; charset=ISO-8859-1" : r.content_type.c_str();
+		head += "\r\n";
+		if (r.streaming) {
+			head += "Transfer-Encoding: chunked\r\n\r\n";
+			o.segments.push_back(segment(head));
+			o.stream = s;
+			{
+				std::lock_guard<std::mutex> lock(queue->mtx);
+				s->start(o);
+				if (!queue->closed)
+					queue->outputs.push_back(std::move(o));
+			}
+			queue->wake();
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(queue->mtx);
+			s->discard();
+		}
+		char length[48];
+		std::sprintf(length, "Content-Length: %llu\r\n\r\n", (unsigned long long)(file == -1 ? r.answer.size() : st.st_size));
+		head += length;
+		o.segments.push_back(segment(head));
+		if (file != -1)
+			o.segments.push_back(segment(file, st.st_size));
+		else if (!r.answer.empty())
+			o.segments.push_back(segment(r.answer));
+		queue->push(o);
+	}
+	void worker_loop()
+	{
+		for (;;) {
+			job j;
+			{
+				std::unique_lock<std::mutex> lock(job_mtx);
+				while (!stop_workers && jobs.empty())
+					job_cv.wait(lock);
+				if (stop_workers)
+					return;
+				j = std::move(jobs.front());
+				jobs.pop_front();
+			}
+			std::shared_ptr<stream_impl> s(new stream_impl(queue, j.connection_id, j.keep_alive));
+			j.request.stream = s;
+			try {
+				instance->handle_request(j.request);
+			}
+			catch (...) {
+				// answer failed handlers such that the connection does not wait for a response forever
+				http_request& r = j.request;
+				r.streaming = false;
+				r.auth_realm.clear();
+				r.file_name.clear();
+				r.content_type.clear();
+				r.status = "500 Internal Server Error";
+				r.answer = "<html><body><h1>Internal Server Error</h1></body></html>";
+			}
+			j.request.stream.reset();
+			respond(j, s);
+		}
+	}
+public:
+	epoll_server(web_server* _instance) : instance(_instance), queue(new output_queue()), listen_fd(-1), epoll_fd(-1),
+		stop_request(false), finished(false), stop_workers(false), next_connection_id(2) {}
+	~epoll_server()
+	{
+		if (listen_fd != -1)
+			::close(listen_fd);
+		if (epoll_fd != -1)
+			::close(epoll_fd);
+	}
+	/// open listening socket and event loop, return false on failure
+	bool listen(unsigned port)
+	{
+		listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (listen_fd == -1 || queue->event_fd == -1)
+			return false;
+		int one = 1;
+		setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+		sockaddr_in addr;
+		std::memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_ANY);
+		addr.sin_port = htons(port);
+		if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) == -1 || ::listen(listen_fd, SOMAXCONN) == -1)
+			return false;
+		epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+		if (epoll_fd == -1)
+			return false;
+		epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.u64 = listen_id;
+		epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+		ev.data.u64 = wake_id;
+		epoll_ctl(epoll_fd, EPOLL_CTL_ADD, queue->event_fd, &ev);
+		return true;
+	}
+	/// run event loop until stop is called
+	void run()
+	{
+		// writing to sockets closed by the peer raises SIGPIPE, which is blocked in the event loop thread and discarded at the end
+		sigset_t pipe_set, old_set;
+		sigemptyset(&pipe_set);
+		sigaddset(&pipe_set, SIGPIPE);
+		pthread_sigmask(SIG_BLOCK, &pipe_set, &old_set);
+
+		unsigned n = nr_worker_threads ? nr_worker_threads : std::max(1u, std::thread::hardware_concurrency());
+		for (unsigned i = 0; i < n; ++i)
+			workers.push_back(std::thread(&epoll_server::worker_loop, this));
+
+		epoll_event events[256];
+		time_t last_sweep = time(0);
+		while (!stop_request) {
+			int nr_events = epoll_wait(epoll_fd, events, 256, 1000);
+			if (nr_events == -1 && errno != EINTR)
+				break;
+			for (int i = 0; i < nr_events; ++i) {
+				uint64_t id = events[i].data.u64;
+				if (id == listen_id)
+					accept_connections();
+				else if (id == wake_id)
+					process_outputs();
+				else {
+					// look up by id because earlier events of this batch may have closed the connection
+					std::unordered_map<uint64_t, connection*>::iterator it = connections.find(id);
+					if (it == connections.end())
+						continue;
+					connection& c = *it->second;
+					if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !receive(c))
+						continue;
+					if ((events[i].events & (EPOLLHUP | EPOLLERR)) && !hang_up(c))
+						continue;
+					if ((events[i].events & EPOLLOUT) && !c.out.empty())
+						flush(c);
+				}
+			}
+			if (time(0) != last_sweep) {
+				close_idle_connections();
+				last_sweep = time(0);
+			}
+		}
+		// shut down workers, which finish requests in progress
+		{
+			std::lock_guard<std::mutex> lock(job_mtx);
+			stop_workers = true;
+			jobs.clear();
+		}
+		job_cv.notify_all();
+		for (size_t i = 0; i < workers.size(); ++i)
+			workers[i].join();
+		workers.clear();
+		{
+			std::lock_guard<std::mutex> lock(queue->mtx);
+			queue->closed = true;
+			for (size_t i = 0; i < queue->outputs.size(); ++i)
+				release_segments(queue->outputs[i].segments);
+			queue->outputs.clear();
+		}
+		while (!connections.empty())
+			close_connection(connections.begin()->second);
+
+		timespec zero = { 0, 0 };
+		while (sigtimedwait(&pipe_set, 0, &zero) == SIGPIPE)
+			;
+		pthread_sigmask(SIG_SETMASK, &old_set, 0);
+
+		std::lock_guard<std::mutex> lock(run_mtx);
+		finished = true;
+		run_cv.notify_all();
+	}
+	/// request termination of the event loop and wait for it
+	void stop()
+	{
+		stop_request = true;
+		queue->wake();
+		std::unique_lock<std::mutex> lock(run_mtx);
+		while (!finished)
+			run_cv.wait(lock);
+	}
+};
+
+}
+
+void web_server_provider_epoll::set_nr_worker_threads(unsigned nr)
+{
+	nr_worker_threads = nr;
+}
+
+unsigned web_server_provider_epoll::get_nr_worker_threads()
+{
+	return nr_worker_threads ? nr_worker_threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+void web_server_provider_epoll::set_keep_alive_timeout(unsigned seconds)
+{
+	keep_alive_timeout = seconds;
+}
+
+void web_server_provider_epoll::set_max_stream_backlog(size_t nr_bytes)
+{
+	max_stream_backlog = nr_bytes;
+}
+
+void web_server_provider_epoll::start_web_server(cgv::os::web_server* instance)
+{
+	epoll_server* s = new epoll_server(instance);
+	if (!s->listen(instance->get_port())) {
+		std::cerr << "web server could not listen to port " << instance->get_port() << ": " << std::strerror(errno) << std::endl;
+		delete s;
+		return;
+	}
+	ref_user_data(instance) = s;
+	s->run();
+}
+
+void web_server_provider_epoll::stop_web_server(cgv::os::web_server* instance)
+{
+	epoll_server* s = (epoll_server*)ref_user_data(instance);
+	if (!s)
+		return;
+	ref_user_data(instance) = 0;
+	s->stop();
+	delete s;
+}
+
+cgv::os::web_server_provider_registration<web_server_provider_epoll> web_server_epoll_registration;
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cgv/os/web_server.h>
+
+#ifdef CGV_OS_WEB_EPOLL_EXPORTS
+#	define CGV_EXPORTS
+#endif
+
+#include <cgv/config/lib_begin.h>
+
+/** web server provider for linux. A single event loop thread multiplexes all connections with
+    epoll and parses requests in place, while a fixed pool of worker threads calls
+	web_server::handle_request. Connections are kept alive and pipelined requests are answered
+	in order. Files given in http_request::file_name are sent with sendfile and responses with
+	http_request::streaming set are sent with chunked transfer encoding. Requests with more than 1 MB of
+	header and body are answered with 413 and exceptions thrown by handle_request with 500. */
+struct CGV_API web_server_provider_epoll : public cgv::os::web_server_provider
+{
+	/// set the number of worker threads used by subsequently started servers, where 0 uses the hardware concurrency
+	static void set_nr_worker_threads(unsigned nr);
+	/// return the number of worker threads used by subsequently started servers
+	static unsigned get_nr_worker_threads();
+	/// set the number of seconds after which idle connections are closed
+	static void set_keep_alive_timeout(unsigned seconds);
+	/// set the number of bytes that may wait for being sent on a streaming connection before http_stream::write drops data
+	static void set_max_stream_backlog(size_t nr_bytes);
+	/// listen to the port of the instance and serve requests until stop_web_server is called
+	void start_web_server(cgv::os::web_server* instance);
+	/// stop serving, wait for the event loop and the workers to terminate and release all connections
+	void stop_web_server(cgv::os::web_server* instance);
+};
+
+#include <cgv/config/lib_end.h>
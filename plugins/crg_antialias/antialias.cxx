@@ -146,6 +146,12 @@ void antialias::on_set(void* m)
 	post_redraw();
 }
 
+/// cache the reflected members in a property index
+const cgv::reflect::property_index* antialias::get_property_index()
+{
+	return cgv::base::ref_property_index(this);
+}
+
 /// you must overload this for gui creation
 bool antialias::self_reflect(cgv::reflect::reflection_handler& srh)
 {
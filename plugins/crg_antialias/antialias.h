@@ -29,6 +29,8 @@ public:
 	void on_set(void*);
 	/// enum all member variables
 	bool self_reflect(cgv::reflect::reflection_handler& srh);
+	/// cache the reflected members in a property index
+	const cgv::reflect::property_index* get_property_index();
 	/// return the type name 
 	std::string get_type_name() const;
 	/// overload to show the content of this object
@@ -176,6 +176,12 @@ void depth_of_field::on_set(void* m)
 	post_redraw();
 }
 
+/// cache the reflected members in a property index
+const cgv::reflect::property_index* depth_of_field::get_property_index()
+{
+	return cgv::base::ref_property_index(this);
+}
+
 /// you must overload this for gui creation
 bool depth_of_field::self_reflect(cgv::reflect::reflection_handler& rh)
 {
@@ -288,6 +288,12 @@ void grid::draw_lines(context& ctx)
 	glBlendFunc(blend_src, blend_dst);
 }
 
+/// cache the reflected members in a property index
+const cgv::reflect::property_index* grid::get_property_index()
+{
+	return cgv::base::ref_property_index(this);
+}
+
 /// reflect adjustable members
 bool grid::self_reflect(cgv::reflect::reflection_handler& srh)
 {
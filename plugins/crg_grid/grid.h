@@ -36,6 +36,8 @@ public:
 	grid();
 	/// reflect adjustable members
 	bool self_reflect(cgv::reflect::reflection_handler& srh);
+	/// cache the reflected members in a property index
+	const cgv::reflect::property_index* get_property_index();
 	/// update gui and post redraw in on_set method
 	void on_set(void* member_ptr);
 	/// overload to return the type name of this object
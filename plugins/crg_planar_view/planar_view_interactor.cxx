@@ -32,6 +32,12 @@ void planar_view_interactor::set_default_values()
 	on_set(&angle);
 }
 
+/// cache the reflected members in a property index
+const cgv::reflect::property_index* planar_view_interactor::get_property_index()
+{
+	return cgv::base::ref_property_index(this);
+}
+
 /// describe members
 bool planar_view_interactor::self_reflect(cgv::reflect::reflection_handler& rh)
 {
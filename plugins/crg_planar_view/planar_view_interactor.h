@@ -49,6 +49,8 @@ public:
 
 	/// describe members
 	bool self_reflect(cgv::reflect::reflection_handler& rh);
+	/// cache the reflected members in a property index
+	const cgv::reflect::property_index* get_property_index();
 	/// default callback
 	void on_set(void* member_ptr);
 	/// create a gui
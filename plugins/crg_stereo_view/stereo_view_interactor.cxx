@@ -1648,6 +1648,12 @@ void stereo_view_interactor::set_default_view()
 	post_redraw();
 }
 
+/// cache the reflected members in a property index
+const cgv::reflect::property_index* stereo_view_interactor::get_property_index()
+{
+	return cgv::base::ref_property_index(this);
+}
+
 /// you must overload this for gui creation
 bool stereo_view_interactor::self_reflect(cgv::reflect::reflection_handler& srh)
 {
@@ -102,6 +102,8 @@ protected:
 	///
 	void draw_focus();
 	bool self_reflect(cgv::reflect::reflection_handler& srh);
+	/// cache the reflected members in a property index
+	const cgv::reflect::property_index* get_property_index();
 	std::string get_property_declarations();
 	bool set_void(const std::string& property, const std::string& value_type, const void* value_ptr);
 	bool get_void(const std::string& property, const std::string& value_type, void* value_ptr);
@@ -992,6 +992,12 @@ void vr_view_interactor::create_gui()
 	stereo_view_interactor::create_gui();
 }
 
+/// cache the reflected members in a property index
+const cgv::reflect::property_index* vr_view_interactor::get_property_index()
+{
+	return cgv::base::ref_property_index(this);
+}
+
 /// you must overload this for gui creation
 bool vr_view_interactor::self_reflect(cgv::reflect::reflection_handler& srh)
 {
@@ -300,6 +300,8 @@ public:
 	void after_finish(cgv::render::context& ctx);
 	///
 	bool self_reflect(cgv::reflect::reflection_handler& srh);
+	/// cache the reflected members in a property index
+	const cgv::reflect::property_index* get_property_index();
 	/// you must overload this for gui creation
 	void create_gui();
 };
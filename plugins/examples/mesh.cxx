@@ -194,9 +194,11 @@ public:
 		if (M.has_colors())
 			return;
 		M.ensure_colors(cgv::media::CT_RGB, M.get_nr_positions());
+		std::vector<rgb> colors(M.get_nr_positions());
 		double int_part;
-		for (unsigned i = 0; i < M.get_nr_positions(); ++i)			
-			M.set_color(i, cgv::media::color_scale(modf(20*double(i)/(M.get_nr_positions() - 1),&int_part)));
+		for (unsigned i = 0; i < M.get_nr_positions(); ++i)
+			colors[i] = cgv::media::color_scale(modf(20*double(i)/(M.get_nr_positions() - 1),&int_part));
+		M.set_colors(0, colors.size(), colors.data(), cgv::media::CT_RGB);
 	}
 	void create_gui()
 	{
@@ -12,6 +12,8 @@
 #include <cgv/type/standard_types.h>
 #include <cgv/math/ftransform.h>
 #include <cgv/math/svd.h>
+#include <cgv/render/update_pool.h>
+#include <functional>
 
 using namespace std;
 using namespace cgv::base;
@@ -112,6 +114,7 @@ rgbd_control::rgbd_control() :
 	clr_rot = dquat(1, 0, 0, 0);
 	clr_ctr = dvec2(320, 240);
 	clr_f_p = dvec2(525.0, 525.0);
+	override_calibration = false;
 
 	validate_color_camera = true;
 	T.identity();
@@ -129,6 +132,8 @@ rgbd_control::rgbd_control() :
 	near_mode = true;
 	acquire_next = false;
 	always_acquire_next = false;
+	update_in_background = true;
+	frame_time = frame_jitter = frame_time_max = 0;
 
 	prs.measure_point_size_in_pixel = false;
 	prs.point_size = 0.2f;
@@ -159,6 +164,12 @@ rgbd_control::rgbd_control() :
 	connect(get_animation_trigger().shoot, this, &rgbd_control::timer_event);
 }
 
+/// wait for running updates
+rgbd_control::~rgbd_control()
+{
+	cgv::render::ref_update_pool().wait(this);
+}
+
 ///
 bool rgbd_control::self_reflect(cgv::reflect::reflection_handler& rh)
 {
@@ -278,6 +289,9 @@ void rgbd_control::on_set(void* member_ptr)
 	}
 	if (member_ptr == &near_mode)
 		rgbd_inp.set_near_mode(near_mode);
+	// restart frame time measurement to compare both update modes
+	if (member_ptr == &update_in_background)
+		frame_meter.reset();
 
 	update_member(member_ptr);
 	post_redraw();
@@ -317,6 +331,7 @@ void rgbd_control::clear(cgv::render::context& ctx)
 	warped_color.destruct(ctx);
 	depth.destruct(ctx);
 	rgbd_prog.destruct(ctx);
+	point_cloud_arrays.destruct(ctx);
 	cgv::render::ref_point_renderer(ctx, -1);
 }
 
@@ -376,11 +391,26 @@ void rgbd_control::init_frame(context& ctx)
 	if (!rgbd_prog.is_created())
 		rgbd_prog.build_program(ctx, "rgbd_shader.glpr");
 
+	// take over the latest results of update_frames() once per frame
+	bool warped_color_frame_changed = false;
+	if (ctx.get_render_pass() == cgv::render::RP_MAIN) {
+		point_clouds.consume();
+		warped_color_frame_changed = warped_color_frames.consume();
+		// measure frame times and show them every 30 frames
+		if (frame_meter.tick() > 0 && frame_meter.get_nr_frames() % 30 == 0) {
+			frame_time = float(frame_meter.get_average());
+			frame_jitter = float(frame_meter.get_jitter());
+			frame_time_max = float(frame_meter.get_max());
+			update_member(&frame_time);
+			update_member(&frame_jitter);
+			update_member(&frame_time_max);
+		}
+	}
 	if (device_mode != DM_DETACHED) {
 		update_texture_from_frame(ctx, color, color_frame, attachment_changed, color_frame_changed);
 		update_texture_from_frame(ctx, depth, depth_frame, attachment_changed, depth_frame_changed);
 		update_texture_from_frame(ctx, infrared, ir_frame, attachment_changed, infrared_frame_changed);
-		update_texture_from_frame(ctx, warped_color, warped_color_frame, attachment_changed, (color_frame_changed|| depth_frame_changed) &&remap_color);
+		update_texture_from_frame(ctx, warped_color, warped_color_frames.ref_front(), attachment_changed, warped_color_frame_changed);
 		color_frame_changed = false;
 		infrared_frame_changed = false;
 		/*
@@ -407,14 +437,19 @@ void rgbd_control::draw(context& ctx)
 	ctx.push_modelview_matrix();
 	vec3 flip_vec(flip[0] ? -1.0f : 1.0f, flip[1] ? -1.0f : 1.0f, flip[2] ? -1.0f : 1.0f);
 	ctx.mul_modelview_matrix(cgv::math::scale4<double>(flip_vec[0], -flip_vec[1], flip_vec[2]));
-	if (P.size() > 0) {
+	const point_cloud& pc = point_clouds.ref_front();
+	if (pc.P.size() > 0) {
 		ctx.mul_modelview_matrix(cgv::math::translate4<double>(-1.5f,0,0));
 		cgv::render::point_renderer& pr = ref_point_renderer(ctx);
 		pr.set_render_style(prs);
-		pr.set_position_array(ctx, P);
-		if (C.size() == P.size())
-			pr.set_color_array(ctx, C);
-		pr.render(ctx, 0, P.size());
+		// point clouds are only uploaded once after they have been consumed
+		if (point_cloud_arrays.attach(ctx, pr, point_clouds)) {
+			pr.set_position_array(ctx, pc.P);
+			if (pc.C.size() == pc.P.size())
+				pr.set_color_array(ctx, pc.C);
+		}
+		pr.render(ctx, 0, pc.P.size());
+		point_cloud_arrays.detach(ctx, pr);
 		ctx.mul_modelview_matrix(cgv::math::translate4<double>(3, 0, 0));
 	}
 	// transform to image coordinates
@@ -628,6 +663,10 @@ void rgbd_control::create_gui()
 	if (begin_tree_node("Point Cloud", always_acquire_next, false, "level=2")) {
 		align("\a");
 		add_member_control(this, "always_acquire_next", always_acquire_next, "toggle");
+		add_member_control(this, "update_in_background", update_in_background, "toggle");
+		add_view("frame_time", frame_time);
+		add_view("frame_jitter", frame_jitter);
+		add_view("frame_time_max", frame_time_max);
 
 		for (unsigned i = 0; i < 4; ++i)
 			for (unsigned j = 0; j < 4; ++j)
@@ -647,6 +686,7 @@ void rgbd_control::create_gui()
 		align("\a");
 		add_member_control(this, "plane_depth", plane_depth, "value_slider", "min=500;max=4000;ticks=true");
 		add_member_control(this, "validate_color_camera", validate_color_camera, "toggle");
+		add_member_control(this, "override_calibration", override_calibration, "toggle");
 		add_member_control(this, "Dcx", ctr(0), "value_slider", "min=300;max=340;step=0.00001;ticks=true");
 		add_member_control(this, "Dcy", ctr(1), "value_slider", "min=210;max=250;step=0.00001;ticks=true");
 		add_member_control(this, "Dfx", f_p(0), "value_slider", "min=550;max=600;log=true;step=0.00001;ticks=true");
@@ -666,32 +706,44 @@ void rgbd_control::create_gui()
 	}
 }
 
+void rgbd_control::configure_mapper(const rgbd::frame_type& depth_frame)
+{
+	camera_intrinsics depth_K, color_K;
+	camera_extrinsics color_E;
+	// without override use the calibration of the device, which also warps the color frames in this case
+	if (override_calibration || !rgbd_inp.query_calibration(depth_K, color_K, color_E)) {
+		depth_K = camera_intrinsics(float(f_p(0)), float(f_p(1)), float(ctr(0)), float(ctr(1)));
+		color_K = camera_intrinsics(float(clr_f_p(0)), float(clr_f_p(1)), float(clr_ctr(0)), float(clr_ctr(1)));
+		color_E = camera_extrinsics(float(clr_rot.w()), float(clr_rot.x()), float(clr_rot.y()), float(clr_rot.z()),
+			float(clr_tra(0)), float(clr_tra(1)), float(clr_tra(2)));
+	}
+	mapper.set_depth_camera(depth_K, depth_frame.width, depth_frame.height);
+	mapper.set_color_camera(color_K, color_E);
+}
+
+void rgbd_control::update_frames(bool remap, bool construct)
+{
+	if (remap) {
+		mapper.map_color_to_depth(depth_frame_2, color_frame_2, warped_color_frames.ref_back());
+		warped_color_frames.publish();
+	}
+	if (construct)
+		construct_point_cloud();
+}
+
 size_t rgbd_control::construct_point_cloud()
 {
-	/*
-	if (remap_color)
-		rgbd_inp.map_color_to_depth(rgbd::FF_DEPTH_RAW, depth2_data.get_ptr<unsigned char>(), rgbd::FF_COLOR_RGB32, color2_data.get_ptr<unsigned char>());
-	P2.clear();
-	C2.clear();
-	std::vector<vec3> Q;
-	unsigned short* d_ptr = depth2_data.get_ptr<unsigned short>();
-	unsigned char* c_ptr = color2_data.get_ptr<unsigned char>();
-	for (unsigned y = 0; y < depth_fmt.get_height(); ++y)
-		for (unsigned x = 0; x < depth_fmt.get_width(); ++x) {
-			float point[3];
-			if (rgbd_inp.map_pixel_to_point(x, y, *d_ptr++, FF_DEPTH_RAW, point)) {
-				P2.push_back(vec3(3, point));
-				C2.push_back(reinterpret_cast<rgba8&>(*c_ptr));
-				Q.push_back(vec3(float(x), float(y), (float)d_ptr[-1]));
-				rgba8& col = C2.back();
-				std::swap(col[0], col[2]);
-				col[3] = 255;
-			}
-			c_ptr += color_fmt.get_entry_size();
-		}
-	compute_homography(P2, Q);
-	*/
-	return P2.size();
+	point_cloud& pc = point_clouds.ref_back();
+	// capacity is kept between frames such that resizing does not reallocate
+	pc.P.resize(mapper.get_max_nr_points());
+	pc.C.resize(mapper.get_max_nr_points());
+	size_t n = 0;
+	if (!pc.P.empty())
+		n = mapper.unproject(depth_frame_2, &pc.P.front()[0], &color_frame_2, &pc.C.front()[0]);
+	pc.P.resize(n);
+	pc.C.resize(n);
+	point_clouds.publish();
+	return n;
 }
 void rgbd_control::calibrate_device()
 {
@@ -789,17 +841,9 @@ void rgbd_control::compute_homography(const std::vector<vec3>& P, const std::vec
 
 void rgbd_control::timer_event(double t, double dt)
 {
-	// in case a point cloud is being constructed
-	if (future_handle.valid()) {
-		// check for termination of thread
-		if (future_handle.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
-			size_t N = future_handle.get();
-			// copy computed point cloud
-			P = P2;
-			C = C2;
-			post_redraw();
-		}
-	}
+	// redraw when update_frames() published new results
+	if (point_clouds.has_new_snapshot() || warped_color_frames.has_new_snapshot())
+		post_redraw();
 	if (rgbd_inp.is_started()) {
 		IMU_measurement m;
 		if (rgbd_inp.put_IMU_measurement(m, 10)) {
@@ -849,15 +893,25 @@ void rgbd_control::timer_event(double t, double dt)
 				post_redraw();
 			if (stream_color && stream_depth && color_frame.is_allocated() && depth_frame.is_allocated() &&
 				(color_frame_changed || depth_frame_changed) ) {
-				if (!future_handle.valid() && (always_acquire_next || acquire_next)) {
+				bool construct = always_acquire_next || acquire_next;
+				// frames are handed over only after the previous update finished and skipped otherwise
+				if ((construct || remap_color) && !cgv::render::ref_update_pool().is_busy(this)) {
 					acquire_next = false;
 					color_frame_2 = color_frame;
 					depth_frame_2 = depth_frame;
-					future_handle = std::async(&rgbd_control::construct_point_cloud, this);
-				}
-				else {
-					if (remap_color)
-						rgbd_inp.map_color_to_depth(depth_frame, color_frame, warped_color_frame);
+					configure_mapper(depth_frame_2);
+					// without override the device warps with its own calibration, which is not called from the update pool
+					bool remap = remap_color && override_calibration;
+					if (remap_color && !override_calibration) {
+						rgbd_inp.map_color_to_depth(depth_frame_2, color_frame_2, warped_color_frames.ref_back());
+						warped_color_frames.publish();
+					}
+					if (remap || construct) {
+						if (update_in_background)
+							cgv::render::ref_update_pool().schedule(this, std::bind(&rgbd_control::update_frames, this, remap, construct));
+						else
+							update_frames(remap, construct);
+					}
 				}
 			}
 		}
@@ -1022,17 +1076,18 @@ void rgbd_control::on_save_point_cloud_cb()
 	if (!fp)
 		return;
 
-	unsigned int n = (unsigned int)P.size();
+	const point_cloud& pc = point_clouds.ref_front();
+	unsigned int n = (unsigned int)pc.P.size();
 	unsigned int m = 0;
 	unsigned int m1 = m;
-	if (C.size() == n)
+	if (pc.C.size() == n)
 		m1 = 2*n+m;
 	bool success = 
 		fwrite(&n,sizeof(unsigned int),1,fp) == 1 &&
 		fwrite(&m1,sizeof(unsigned int),1,fp) == 1 &&
-		fwrite(&P[0][0],sizeof(vec3),n,fp) == n;
-	if (C.size() == n)
-		success = success && (fwrite(&C[0][0],sizeof(rgba8),n,fp) == n);
+		fwrite(&pc.P[0][0],sizeof(vec3),n,fp) == n;
+	if (pc.C.size() == n)
+		success = success && (fwrite(&pc.C[0][0],sizeof(rgba8),n,fp) == n);
 	fclose(fp);
 }
 
@@ -1111,7 +1166,14 @@ void rgbd_control::on_device_select_cb()
 		}
 	}
 	else if (device_mode == DM_PROTOCOL) {
-		rgbd_inp.attach_path(protocol_path);
+		if (!rgbd_inp.attach_path(protocol_path)) {
+			// protocols of the former layout with one file per frame are converted to a recording once
+			size_t n = convert_frame_files(protocol_path, get_recording_file_name(protocol_path));
+			if (n > 0) {
+				std::cout << "rgbd_control: converted " << n << " frame files of " << protocol_path << " to " << get_recording_file_name(protocol_path) << std::endl;
+				rgbd_inp.attach_path(protocol_path);
+			}
+		}
 		update_member(&device_idx);
 		// on_device_select_cb();
 	}
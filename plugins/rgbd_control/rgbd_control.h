@@ -2,6 +2,7 @@
 
 #include <rgbd_input.h>
 #include <rgbd_mouse.h>
+#include <rgbd_mapper.h>
 
 #include <cgv/base/node.h>
 #include <cgv/math/fvec.h>
@@ -12,11 +13,13 @@
 #include <cgv/render/drawable.h>
 #include <cgv/render/shader_program.h>
 #include <cgv/render/texture.h>
+#include <cgv/render/render_snapshot.h>
+#include <cgv/render/frame_jitter_meter.h>
 #include <cgv_gl/point_renderer.h>
+#include <cgv_gl/snapshot_array_manager.h>
 
 #include <string>
 #include <mutex>
-#include <future>
 
 #include "lib_begin.h"
 
@@ -31,6 +34,8 @@ public:
 	enum DeviceMode { DM_DETACHED, DM_PROTOCOL, DM_DEVICE };
 	///
 	rgbd_control();
+	/// wait for running updates
+	~rgbd_control();
 	/// overload to return the type name of this object. By default the type interface is queried over get_type.
 	std::string get_type_name() const { return "rgbd_control"; }
 	///
@@ -78,8 +83,17 @@ protected:
 	vec2 mouse_pos;
 
 	/// raw point cloud
-	std::vector<vec3> P, P2;
-	std::vector<rgba8> C, C2;
+	struct point_cloud
+	{
+		std::vector<vec3> P;
+		std::vector<rgba8> C;
+	};
+	/// point clouds published by construct_point_cloud()
+	cgv::render::snapshot_buffer<point_cloud> point_clouds;
+	/// color frames warped to the depth frame that are published by update_frames()
+	cgv::render::snapshot_buffer<rgbd::frame_type> warped_color_frames;
+	/// gpu storage of the front point cloud
+	cgv::render::snapshot_array_manager point_cloud_arrays;
 
 	/// processing parameters
 	bool remap_color;
@@ -103,6 +117,8 @@ protected:
 	dquat clr_rot;
 	dvec3 clr_tra;
 	dvec2 clr_ctr, clr_f_p;
+	/// whether color frames are warped and point clouds are constructed with the calibration parameters above instead of the calibration of the device
+	bool override_calibration;
 	unsigned plane_depth;
 	bool validate_color_camera;
 	void calibrate_device();
@@ -124,11 +140,22 @@ private:
 	bool attachment_changed;
 
 	/// internal members used for data storage
-	rgbd::frame_type color_frame, depth_frame, ir_frame, warped_color_frame;
+	rgbd::frame_type color_frame, depth_frame, ir_frame;
+	/// frames handed over to update_frames(), which are only written if no update is running
 	rgbd::frame_type color_frame_2, depth_frame_2, ir_frame_2;
 
-	std::future<size_t> future_handle;
+	/// engine used to unproject depth frames and to register color frames
+	rgbd::rgbd_mapper mapper;
+	/// update mapper with the calibration of the device or with the calibration parameters if override_calibration is set or the device provides no calibration
+	void configure_mapper(const rgbd::frame_type& depth_frame);
+	/// whether update_frames() runs in the update pool instead of the gui thread
+	bool update_in_background;
+	/// warp color frame and construct point cloud from the handed over frames and publish the results
+	void update_frames(bool remap, bool construct);
 	size_t construct_point_cloud();
+	/// frame times measured in init_frame
+	cgv::render::frame_jitter_meter frame_meter;
+	float frame_time, frame_jitter, frame_time_max;
 	void compute_homography(const std::vector<vec3>& P, const std::vector<vec3>& Q);
 	bool acquire_next;
 	bool always_acquire_next;
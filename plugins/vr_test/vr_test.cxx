@@ -6,12 +6,15 @@
 #include <cgv/utils/scan.h>
 #include <cgv/utils/options.h>
 #include <cgv/gui/dialog.h>
+#include <cgv/gui/trigger.h>
 #include <cgv/render/attribute_array_binding.h>
+#include <cgv/render/update_pool.h>
 #include <cgv_gl/sphere_renderer.h>
 #include <cgv/media/mesh/simple_mesh.h>
 #include <cg_vr/vr_events.h>
 
 #include <random>
+#include <functional>
 
 #include "intersection.h"
 
@@ -70,6 +73,121 @@ void vr_test::stop_camera()
 		cgv::gui::message(camera_ptr->get_last_error());
 }
 
+/// record input and apply it to the scene in the update pool or directly
+void vr_test::submit_input(const controller_input& input)
+{
+	{
+		std::lock_guard<std::mutex> lock(input_mutex);
+		pending_inputs.push_back(input);
+	}
+	if (update_in_background)
+		cgv::render::ref_update_pool().schedule(this, std::bind(&vr_test::update_scene, this));
+	else {
+		// an update scheduled before switching to the gui thread might still run
+		cgv::render::ref_update_pool().wait(this);
+		update_scene();
+	}
+}
+
+void vr_test::apply_input(const controller_input& input)
+{
+	int ci = input.ci;
+	switch (input.kind) {
+	case controller_input::CIK_TOUCH:
+		if (state[ci] == IS_OVER)
+			state[ci] = IS_GRAB;
+		break;
+	case controller_input::CIK_RELEASE:
+		if (state[ci] == IS_GRAB)
+			state[ci] = IS_OVER;
+		break;
+	case controller_input::CIK_POSE:
+		if (state[ci] == IS_GRAB) {
+			// in grab mode apply relative transformation to grabbed boxes
+
+			// get previous and current controller position
+			const vec3& last_pos = input.last_position;
+			const vec3& pos = input.position;
+			// get rotation from previous to current orientation
+			// this is the current orientation matrix times the
+			// inverse (or transpose) of last orientation matrix:
+			// vrpe.get_orientation()*transpose(vrpe.get_last_orientation())
+			const mat3& rotation = input.rotation;
+			// iterate intersection points of current controller
+			for (size_t i = 0; i < intersection_points.size(); ++i) {
+				if (intersection_controller_indices[i] != ci)
+					continue;
+				// extract box index
+				unsigned bi = intersection_box_indices[i];
+				// update translation with position change and rotation
+				movable_box_translations[bi] = 
+					rotation * (movable_box_translations[bi] - last_pos) + pos;
+				// update orientation with rotation, note that quaternions
+				// need to be multiplied in oposite order. In case of matrices
+				// one would write box_orientation_matrix *= rotation
+				movable_box_rotations[bi] = quat(rotation) * movable_box_rotations[bi];
+				// update intersection points
+				intersection_points[i] = rotation * (intersection_points[i] - last_pos) + pos;
+			}
+		}
+		else {// not grab
+			// clear intersections of current controller 
+			size_t i = 0;
+			while (i < intersection_points.size()) {
+				if (intersection_controller_indices[i] == ci) {
+					intersection_points.erase(intersection_points.begin() + i);
+					intersection_colors.erase(intersection_colors.begin() + i);
+					intersection_box_indices.erase(intersection_box_indices.begin() + i);
+					intersection_controller_indices.erase(intersection_controller_indices.begin() + i);
+				}
+				else
+					++i;
+			}
+
+			// compute intersections
+			compute_intersections(input.ray_origin, input.ray_direction, ci, ci == 0 ? rgb(1, 0, 0) : rgb(0, 0, 1));
+
+			// update state based on whether we have found at least 
+			// one intersection with controller ray
+			if (intersection_points.size() == i)
+				state[ci] = IS_NONE;
+			else
+				if (state[ci] == IS_NONE)
+					state[ci] = IS_OVER;
+		}
+		break;
+	}
+}
+
+void vr_test::update_scene()
+{
+	std::vector<controller_input> inputs;
+	{
+		std::lock_guard<std::mutex> lock(input_mutex);
+		inputs.swap(pending_inputs);
+	}
+	for (size_t i = 0; i < inputs.size(); ++i)
+		apply_input(inputs[i]);
+
+	// assignment reuses the capacity of the snapshot that is overwritten
+	scene_snapshot& S = scene_snapshots.ref_back();
+	S.movable_box_translations = movable_box_translations;
+	S.movable_box_rotations = movable_box_rotations;
+	S.intersection_points = intersection_points;
+	S.intersection_colors = intersection_colors;
+	S.intersection_box_indices = intersection_box_indices;
+	S.intersection_controller_indices = intersection_controller_indices;
+	for (int ci = 0; ci < 4; ++ci)
+		S.state[ci] = state[ci];
+	scene_snapshots.publish();
+}
+
+void vr_test::timer_event(double t, double dt)
+{
+	if (scene_snapshots.has_new_snapshot())
+		post_redraw();
+}
+
 /// compute intersection points of controller ray with movable boxes
 void vr_test::compute_intersections(const vec3& origin, const vec3& direction, int ci, const rgb& color)
 {
@@ -308,6 +426,18 @@ vr_test::vr_test()
 	}
 	font_enum_decl += "'";
 	state[0] = state[1] = state[2] = state[3] = IS_NONE;
+
+	update_in_background = true;
+	frame_time = frame_jitter = frame_time_max = 0;
+	// the initial scene is available already to the passes of the first frame
+	update_scene();
+	scene_snapshots.consume();
+	connect(cgv::gui::get_animation_trigger().shoot, this, &vr_test::timer_event);
+}
+
+vr_test::~vr_test()
+{
+	cgv::render::ref_update_pool().wait(this);
 }
 	
 void vr_test::stream_help(std::ostream& os) {
@@ -325,6 +455,10 @@ void vr_test::on_set(void* member_ptr)
 		label_outofdate = true;
 	}
 
+	// restart frame time measurement to compare both update modes
+	if (member_ptr == &update_in_background)
+		frame_meter.reset();
+
 	vr::vr_kit* kit_ptr = vr::get_vr_kit(last_kit_handle);
 	if (kit_ptr) {
 		for (int ii = 0; ii < (int)left_inp_cfg.size(); ++ii)
@@ -369,13 +503,14 @@ bool vr_test::handle(cgv::gui::event& e)
 		cgv::gui::vr_stick_event& vrse = static_cast<cgv::gui::vr_stick_event&>(e);
 		switch (vrse.get_action()) {
 		case cgv::gui::SA_TOUCH:
-			if (state[vrse.get_controller_index()] == IS_OVER)
-				state[vrse.get_controller_index()] = IS_GRAB;
-			break;
 		case cgv::gui::SA_RELEASE:
-			if (state[vrse.get_controller_index()] == IS_GRAB)
-				state[vrse.get_controller_index()] = IS_OVER;
+		{
+			controller_input input;
+			input.kind = vrse.get_action() == cgv::gui::SA_TOUCH ? controller_input::CIK_TOUCH : controller_input::CIK_RELEASE;
+			input.ci = vrse.get_controller_index();
+			submit_input(input);
 			break;
+		}
 		case cgv::gui::SA_PRESS:
 		case cgv::gui::SA_UNPRESS:
 			std::cout << "stick " << vrse.get_stick_index()
@@ -400,63 +535,15 @@ bool vr_test::handle(cgv::gui::event& e)
 		// check for controller pose events
 		int ci = vrpe.get_trackable_index();
 		if (ci != -1) {
-			if (state[ci] == IS_GRAB) {
-				// in grab mode apply relative transformation to grabbed boxes
-
-				// get previous and current controller position
-				vec3 last_pos = vrpe.get_last_position();
-				vec3 pos = vrpe.get_position();
-				// get rotation from previous to current orientation
-				// this is the current orientation matrix times the
-				// inverse (or transpose) of last orientation matrix:
-				// vrpe.get_orientation()*transpose(vrpe.get_last_orientation())
-				mat3 rotation = vrpe.get_rotation_matrix();
-				// iterate intersection points of current controller
-				for (size_t i = 0; i < intersection_points.size(); ++i) {
-					if (intersection_controller_indices[i] != ci)
-						continue;
-					// extract box index
-					unsigned bi = intersection_box_indices[i];
-					// update translation with position change and rotation
-					movable_box_translations[bi] = 
-						rotation * (movable_box_translations[bi] - last_pos) + pos;
-					// update orientation with rotation, note that quaternions
-					// need to be multiplied in oposite order. In case of matrices
-					// one would write box_orientation_matrix *= rotation
-					movable_box_rotations[bi] = quat(rotation) * movable_box_rotations[bi];
-					// update intersection points
-					intersection_points[i] = rotation * (intersection_points[i] - last_pos) + pos;
-				}
-			}
-			else {// not grab
-				// clear intersections of current controller 
-				size_t i = 0;
-				while (i < intersection_points.size()) {
-					if (intersection_controller_indices[i] == ci) {
-						intersection_points.erase(intersection_points.begin() + i);
-						intersection_colors.erase(intersection_colors.begin() + i);
-						intersection_box_indices.erase(intersection_box_indices.begin() + i);
-						intersection_controller_indices.erase(intersection_controller_indices.begin() + i);
-					}
-					else
-						++i;
-				}
-
-				// compute intersections
-				vec3 origin, direction;
-				vrpe.get_state().controller[ci].put_ray(&origin(0), &direction(0));
-				compute_intersections(origin, direction, ci, ci == 0 ? rgb(1, 0, 0) : rgb(0, 0, 1));
-				label_outofdate = true;
-
-
-				// update state based on whether we have found at least 
-				// one intersection with controller ray
-				if (intersection_points.size() == i)
-					state[ci] = IS_NONE;
-				else
-					if (state[ci] == IS_NONE)
-						state[ci] = IS_OVER;
-			}
+			// movable boxes and intersections are updated in update_scene()
+			controller_input input;
+			input.kind = controller_input::CIK_POSE;
+			input.ci = ci;
+			input.last_position = vrpe.get_last_position();
+			input.position = vrpe.get_position();
+			input.rotation = vrpe.get_rotation_matrix();
+			vrpe.get_state().controller[ci].put_ray(&input.ray_origin(0), &input.ray_direction(0));
+			submit_input(input);
 			post_redraw();
 		}
 		return true;
@@ -526,6 +613,21 @@ void vr_test::clear(cgv::render::context& ctx)
 
 void vr_test::init_frame(cgv::render::context& ctx)
 {
+	// take over the latest scene snapshot once per frame, such that both eyes show the same state
+	if (ctx.get_render_pass() == cgv::render::RP_MAIN) {
+		if (scene_snapshots.consume())
+			label_outofdate = true;
+		// measure frame times and show them every 30 frames
+		if (frame_meter.tick() > 0 && frame_meter.get_nr_frames() % 30 == 0) {
+			frame_time = float(frame_meter.get_average());
+			frame_jitter = float(frame_meter.get_jitter());
+			frame_time_max = float(frame_meter.get_max());
+			update_member(&frame_time);
+			update_member(&frame_jitter);
+			update_member(&frame_time_max);
+		}
+	}
+	const scene_snapshot& S = scene_snapshots.ref_front();
 	if (label_fbo.get_width() != label_resolution) {
 		label_tex.destruct(ctx);
 		label_fbo.destruct(ctx);
@@ -553,11 +655,11 @@ void vr_test::init_frame(cgv::render::context& ctx)
 			ctx.output_stream().flush(); // make sure to flush the stream before change of font size or font face
 
 			ctx.enable_font_face(label_font_face, 0.7f*label_size);
-			for (size_t i = 0; i < intersection_points.size(); ++i) {
+			for (size_t i = 0; i < S.intersection_points.size(); ++i) {
 				ctx.output_stream()
-					<< "box " << intersection_box_indices[i]
-					<< " at (" << intersection_points[i]
-					<< ") with controller " << intersection_controller_indices[i] << "\n";
+					<< "box " << S.intersection_box_indices[i]
+					<< " at (" << S.intersection_points[i]
+					<< ") with controller " << S.intersection_controller_indices[i] << "\n";
 			}
 			ctx.output_stream().flush();
 
@@ -646,6 +748,7 @@ void vr_test::init_frame(cgv::render::context& ctx)
 
 void vr_test::draw(cgv::render::context& ctx)
 {
+	const scene_snapshot& S = scene_snapshots.ref_front();
 	if (MI.is_constructed()) {
 		dmat4 R;
 		mesh_orientation.put_homogeneous_matrix(R);
@@ -749,7 +852,7 @@ void vr_test::draw(cgv::render::context& ctx)
 					R.push_back(0.002f);
 					P.push_back(ray_origin + ray_length * ray_direction);
 					R.push_back(0.003f);
-					rgb c(float(1 - ci), 0.5f * (int)state[ci], float(ci));
+					rgb c(float(1 - ci), 0.5f * (int)S.state[ci], float(ci));
 					C.push_back(c);
 					C.push_back(c);
 				}
@@ -786,8 +889,8 @@ void vr_test::draw(cgv::render::context& ctx)
 	renderer.set_render_style(movable_style);
 	renderer.set_box_array(ctx, movable_boxes);
 	renderer.set_color_array(ctx, movable_box_colors);
-	renderer.set_translation_array(ctx, movable_box_translations);
-	renderer.set_rotation_array(ctx, movable_box_rotations);
+	renderer.set_translation_array(ctx, S.movable_box_translations);
+	renderer.set_rotation_array(ctx, S.movable_box_rotations);
 	if (renderer.validate_and_enable(ctx)) {
 		if (show_seethrough) {
 			glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
@@ -808,12 +911,12 @@ void vr_test::draw(cgv::render::context& ctx)
 
 
 	// draw intersection points
-	if (!intersection_points.empty()) {
+	if (!S.intersection_points.empty()) {
 		auto& sr = cgv::render::ref_sphere_renderer(ctx);
-		sr.set_position_array(ctx, intersection_points);
-		sr.set_color_array(ctx, intersection_colors);
+		sr.set_position_array(ctx, S.intersection_points);
+		sr.set_color_array(ctx, S.intersection_colors);
 		sr.set_render_style(srs);
-		sr.render(ctx, 0, intersection_points.size());
+		sr.render(ctx, 0, S.intersection_points.size());
 	}
 
 	// draw label
@@ -888,6 +991,10 @@ void vr_test::create_gui() {
 	add_gui("mesh_orientation", static_cast<dvec4&>(mesh_orientation), "direction", "options='min=-1;max=1;ticks=true");
 	add_member_control(this, "ray_length", ray_length, "value_slider", "min=0.1;max=10;log=true;ticks=true");
 	add_member_control(this, "show_seethrough", show_seethrough, "check");
+	add_member_control(this, "update_in_background", update_in_background, "check");
+	add_view("frame_time", frame_time);
+	add_view("frame_jitter", frame_jitter);
+	add_view("frame_time_max", frame_time_max);
 	if(last_kit_handle) {
 		add_decorator("cameras", "heading", "level=3");
 		add_view("nr", nr_cameras);
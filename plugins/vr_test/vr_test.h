@@ -10,6 +10,9 @@
 #include <cgv/render/shader_program.h>
 #include <cgv_gl/rounded_cone_renderer.h>
 #include <cgv/render/frame_buffer.h>
+#include <cgv/render/render_snapshot.h>
+#include <cgv/render/frame_jitter_meter.h>
+#include <mutex>
 
 ///@ingroup VR
 ///@{
@@ -104,6 +107,40 @@ protected:
 	// state of current interaction with boxes for all controllers
 	InteractionState state[4];
 
+	// controller input recorded by handle() and applied to the scene in update_scene()
+	struct controller_input
+	{
+		enum Kind { CIK_TOUCH, CIK_RELEASE, CIK_POSE };
+		Kind kind;
+		int ci;
+		vec3 last_position;
+		vec3 position;
+		mat3 rotation;
+		vec3 ray_origin;
+		vec3 ray_direction;
+	};
+	// state of the movable boxes and of the interaction that is drawn
+	struct scene_snapshot
+	{
+		std::vector<vec3> movable_box_translations;
+		std::vector<quat> movable_box_rotations;
+		std::vector<vec3> intersection_points;
+		std::vector<rgb> intersection_colors;
+		std::vector<int> intersection_box_indices;
+		std::vector<int> intersection_controller_indices;
+		InteractionState state[4];
+	};
+	// inputs that have not been applied yet, protected by input_mutex
+	std::vector<controller_input> pending_inputs;
+	std::mutex input_mutex;
+	// scene snapshots published by update_scene(), the members above are only accessed by update_scene()
+	cgv::render::snapshot_buffer<scene_snapshot> scene_snapshots;
+	// whether update_scene() runs in the update pool instead of the gui thread
+	bool update_in_background;
+	// frame times measured in init_frame
+	cgv::render::frame_jitter_meter frame_meter;
+	float frame_time, frame_jitter, frame_time_max;
+
 	// render style for interaction
 	cgv::render::sphere_render_style srs;
 	cgv::render::box_render_style movable_style;
@@ -138,6 +175,14 @@ public:
 
 	void stop_camera();
 
+	/// record input and apply it to the scene in the update pool or directly
+	void submit_input(const controller_input& input);
+	/// apply input to movable boxes and interaction state
+	void apply_input(const controller_input& input);
+	/// apply the pending inputs and publish a scene snapshot
+	void update_scene();
+	/// redraw when a new scene snapshot has been published
+	void timer_event(double t, double dt);
 	/// compute intersection points of controller ray with movable boxes
 	void compute_intersections(const vec3& origin, const vec3& direction, int ci, const rgb& color);
 	/// keep track of status changes
@@ -157,6 +202,8 @@ public:
 public:
 	vr_test();
 
+	~vr_test();
+
 	std::string get_type_name() { return "vr_test"; }
 
 	void stream_help(std::ostream& os);
@@ -0,0 +1,58 @@
+#include <crg_stereo_view/stereo_view_interactor.h>
+#include <cgv/reflect/set_reflection_handler.h>
+#include <cgv/reflect/get_reflection_handler.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+typedef std::chrono::high_resolution_clock clock_type;
+
+/// return the seconds elapsed since t0
+static double seconds_since(const clock_type::time_point& t0)
+{
+	return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+/// compare property access through the self reflection and through the property index of the stereo view interactor
+int main(int argc, char** argv)
+{
+	unsigned n = argc > 1 ? (unsigned)std::atoi(argv[1]) : 100000;
+	stereo_view_interactor svi("stereo interactor");
+	cgv::base::base& b = svi;
+	// properties from the front, the middle and the end of the self reflection as set by config files
+	const char* properties[] = { "use_gamepad", "focus_x", "eye_distance", "view_dir_z", "z_far", "clip_relative_to_extent" };
+	const unsigned nr_properties = sizeof(properties) / sizeof(properties[0]);
+	std::cout << "property index of stereo_view_interactor: " << (b.get_property_index() ? "enabled" : "disabled") << std::endl;
+
+	clock_type::time_point t0 = clock_type::now();
+	for (unsigned i = 0; i < n; ++i) {
+		double v = 1.0 + (i & 7);
+		cgv::reflect::set_reflection_handler srh(properties[i % nr_properties], "flt64", &v);
+		b.self_reflect(srh);
+	}
+	double t_set_reflect = seconds_since(t0);
+	t0 = clock_type::now();
+	for (unsigned i = 0; i < n; ++i)
+		b.set(properties[i % nr_properties], 1.0 + (i & 7));
+	double t_set_index = seconds_since(t0);
+
+	double sum = 0;
+	t0 = clock_type::now();
+	for (unsigned i = 0; i < n; ++i) {
+		double v = 0;
+		cgv::reflect::get_reflection_handler grh(properties[i % nr_properties], "flt64", &v);
+		b.self_reflect(grh);
+		sum += v;
+	}
+	double t_get_reflect = seconds_since(t0);
+	t0 = clock_type::now();
+	for (unsigned i = 0; i < n; ++i)
+		sum += b.get<double>(properties[i % nr_properties]);
+	double t_get_index = seconds_since(t0);
+
+	std::cout << "set " << n << " properties: self reflection " << n / t_set_reflect << "/s, property index " << n / t_set_index
+		<< "/s (" << t_set_reflect / t_set_index << "x)" << std::endl;
+	std::cout << "get " << n << " properties: self reflection " << n / t_get_reflect << "/s, property index " << n / t_get_index
+		<< "/s (" << t_get_reflect / t_get_index << "x), checksum " << sum << std::endl;
+	return 0;
+}
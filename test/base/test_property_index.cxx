@@ -0,0 +1,213 @@
+#include <cgv/base/base.h>
+#include <cgv/base/register.h>
+#include <cgv/reflect/property_index.h>
+#include <cgv/reflect/set_reflection_handler.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace cgv::base;
+using namespace cgv::reflect;
+
+/// nested style as used by drawables
+struct index_test_style : public cgv::reflect::self_reflection_tag
+{
+	float radius;
+	bool use_color;
+	index_test_style() : radius(1.0f), use_color(true) {}
+	bool self_reflect(reflection_handler& rh)
+	{
+		return
+			rh.reflect_member("radius", radius) &&
+			rh.reflect_member("use_color", use_color);
+	}
+};
+
+struct index_test_base : public base
+{
+	std::string name;
+	bool show;
+	index_test_base() : name("base"), show(true) {}
+	std::string get_type_name() const { return "index_test_base"; }
+	bool self_reflect(reflection_handler& rh)
+	{
+		return
+			rh.reflect_member("name", name) &&
+			rh.reflect_member("show", show);
+	}
+};
+
+/// drawable like object with members of different kinds
+struct index_test_drawable : public index_test_base
+{
+	int nr_points;
+	double scale;
+	float color[4];
+	index_test_style style;
+	std::vector<int> values;
+	void* last_set;
+	unsigned nr_on_set;
+	index_test_drawable() : nr_points(10), scale(1.5), last_set(0), nr_on_set(0)
+	{
+		for (unsigned i = 0; i < 4; ++i)
+			color[i] = 0.25f*i;
+		values.push_back(1);
+		values.push_back(2);
+	}
+	std::string get_type_name() const { return "index_test_drawable"; }
+	const property_index* get_property_index() { return ref_property_index(this); }
+	bool self_reflect(reflection_handler& rh)
+	{
+		return
+			rh.reflect_base(*static_cast<index_test_base*>(this)) &&
+			rh.reflect_member("nr_points", nr_points) &&
+			rh.reflect_member("scale", scale) &&
+			rh.reflect_member("color", color) &&
+			rh.reflect_member("style", style) &&
+			rh.reflect_member("values", values);
+	}
+	void on_set(void* member_ptr)
+	{
+		last_set = member_ptr;
+		++nr_on_set;
+	}
+};
+
+/// derived drawable that adds a member without overloading get_property_index()
+struct index_test_derived_drawable : public index_test_drawable
+{
+	int extra;
+	index_test_derived_drawable() : extra(0) {}
+	bool self_reflect(reflection_handler& rh)
+	{
+		return
+			index_test_drawable::self_reflect(rh) &&
+			rh.reflect_member("extra", extra);
+	}
+};
+
+/// object that reflects the member of the currently selected kit as done by vr_emulator
+struct index_test_kits : public base
+{
+	index_test_style* kits[2];
+	unsigned current_kit;
+	index_test_kits() : current_kit(0) { kits[0] = new index_test_style(); kits[1] = new index_test_style(); }
+	~index_test_kits() { delete kits[0]; delete kits[1]; }
+	std::string get_type_name() const { return "index_test_kits"; }
+	const property_index* get_property_index() { return ref_property_index(this); }
+	bool self_reflect(reflection_handler& rh)
+	{
+		return
+			rh.reflect_member("current_kit", current_kit) &&
+			rh.reflect_member("radius", kits[current_kit]->radius);
+	}
+};
+
+bool test_property_index()
+{
+	index_test_drawable d;
+	property_index pi;
+	property_index_builder pib(pi, &d, sizeof(d));
+	d.self_reflect(pib);
+	TEST_ASSERT(pi.find("nr_points") && pi.find("name") && pi.find("style.radius") && pi.find("color[2]") && pi.find("values"))
+	TEST_ASSERT(!pi.find("values[1]") && !pi.find("unknown"))
+	TEST_ASSERT_EQ(property_index::get_member_ptr(&d, *pi.find("style.radius")), (void*)&d.style.radius)
+
+	// conversions between number types
+	d.set("nr_points", 7.6);
+	TEST_ASSERT_EQ(d.nr_points, 7)
+	TEST_ASSERT_EQ(d.last_set, (void*)&d.nr_points)
+	d.set("scale", 3);
+	TEST_ASSERT_EQ(d.scale, 3.0)
+	d.set("color[2]", 0.9);
+	TEST_ASSERT_EQ(d.color[2], 0.9f)
+	d.set("style.radius", 2);
+	TEST_ASSERT_EQ(d.style.radius, 2.0f)
+	d.set("style.use_color", false);
+	TEST_ASSERT(!d.style.use_color)
+	TEST_ASSERT_EQ(d.get<float>("scale"), 3.0f)
+	TEST_ASSERT_EQ(d.get<int>("color[2]"), 0)
+	// strings and members of the base class
+	d.set("name", "drawable");
+	TEST_ASSERT_EQ(d.name, "drawable")
+	TEST_ASSERT_EQ(d.get<std::string>("name"), "drawable")
+	d.set("show", 0);
+	TEST_ASSERT(!d.show)
+	d.set("nr_points", std::string("42"));
+	TEST_ASSERT_EQ(d.nr_points, 42)
+	// members that are not indexed use the self reflection
+	d.set("values[1]", 5);
+	TEST_ASSERT_EQ(d.values[1], 5)
+	TEST_ASSERT(!d.set_void("unknown", "int32", &d.nr_points))
+	// a second instance uses the same offsets
+	index_test_drawable d2;
+	d2.set("scale", 0.5f);
+	TEST_ASSERT_EQ(d2.scale, 0.5)
+	TEST_ASSERT_EQ(d.scale, 3.0)
+	std::string type_name;
+	TEST_ASSERT_EQ(d2.find_member_ptr("style.radius", &type_name), (void*)&d2.style.radius)
+	TEST_ASSERT_EQ(type_name, "flt32")
+	// batch assignment
+	std::vector<std::string> properties, value_types;
+	std::vector<const void*> value_ptrs;
+	int n = 3;
+	double s = 4.0;
+	properties.push_back("nr_points"); value_types.push_back("int32"); value_ptrs.push_back(&n);
+	properties.push_back("scale");     value_types.push_back("flt64"); value_ptrs.push_back(&s);
+	properties.push_back("unknown");   value_types.push_back("flt64"); value_ptrs.push_back(&s);
+	unsigned nr_on_set = d2.nr_on_set;
+	TEST_ASSERT_EQ(d2.multi_set_void(properties, value_types, value_ptrs), 2)
+	TEST_ASSERT(d2.nr_points == 3 && d2.scale == 4.0 && d2.nr_on_set == nr_on_set + 2)
+	TEST_ASSERT_EQ(d2.get_property_index(), d.get_property_index())
+	// derived types that do not overload get_property_index() use the self reflection
+	index_test_derived_drawable dd;
+	TEST_ASSERT(dd.get_property_index() == 0)
+	dd.set("extra", 5);
+	dd.set("scale", 2);
+	TEST_ASSERT(dd.extra == 5 && dd.scale == 2.0)
+	// members reached through pointers are looked up with the self reflection of the current state
+	index_test_kits k;
+	property_index ki;
+	property_index_builder kib(ki, &k, sizeof(k));
+	k.self_reflect(kib);
+	TEST_ASSERT(ki.find("current_kit") && !ki.find("radius"))
+	k.set("radius", 2.0f);
+	k.set("current_kit", 1);
+	k.set("radius", 3.0f);
+	TEST_ASSERT(k.kits[0]->radius == 2.0f && k.kits[1]->radius == 3.0f)
+	// types that do not overload get_property_index() always use the self reflection
+	index_test_base b;
+	b.set("name", "plain");
+	TEST_ASSERT_EQ(b.get<std::string>("name"), "plain")
+	TEST_ASSERT_EQ(b.find_member_ptr("show"), (void*)&b.show)
+	return true;
+}
+
+bool test_property_index_performance()
+{
+	index_test_drawable d;
+	const char* properties[] = { "nr_points", "scale", "color[3]", "style.radius", "show" };
+	const unsigned n = 100000;
+	typedef std::chrono::high_resolution_clock clock;
+	clock::time_point t0 = clock::now();
+	for (unsigned i = 0; i < n; ++i) {
+		double v = i;
+		set_reflection_handler srh(properties[i % 5], "flt64", &v);
+		d.self_reflect(srh);
+	}
+	clock::time_point t1 = clock::now();
+	for (unsigned i = 0; i < n; ++i)
+		d.set(properties[i % 5], double(i));
+	clock::time_point t2 = clock::now();
+	double t_reflect = std::chrono::duration<double>(t1 - t0).count();
+	double t_index = std::chrono::duration<double>(t2 - t1).count();
+	std::cout << "set " << n << " properties: self reflection " << n / t_reflect << "/s, property index " << n / t_index << "/s" << std::endl;
+	TEST_ASSERT_EQ(d.nr_points, 99995)
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_property_index_reg("cgv::base::test_property_index", test_property_index);
+
+extern CGV_API benchmark_registration test_property_index_performance_reg("cgv::base::test_property_index_performance", test_property_index_performance);
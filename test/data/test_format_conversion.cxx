@@ -0,0 +1,203 @@
+#include <cgv/base/register.h>
+#include <cgv/data/format_conversion.h>
+#include <cgv/data/data_format.h>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace cgv::base;
+using namespace cgv::data;
+
+/// reference conversion through the per component access of component_format
+static void reference_convert(const component_format& sf, const void* src, const component_format& df, void* dst, size_t n)
+{
+	const unsigned char* s = static_cast<const unsigned char*>(src);
+	unsigned char* d = static_cast<unsigned char*>(dst);
+	for (size_t i = 0; i < n; ++i, s += sf.get_entry_size(), d += df.get_entry_size())
+		for (unsigned c = 0; c < df.get_nr_components(); ++c) {
+			unsigned ci = sf.get_component_index(df.get_component_name(c));
+			double v = ci == (unsigned)-1 ? (df.get_component_name(c) == "A" ? 255.0 : 0.0) : sf.get<double>(ci, s);
+			df.set<double>(c, d, v);
+		}
+}
+
+bool test_half_conversion()
+{
+	float values[] = { 0.0f, 1.0f, -2.5f, 65504.0f, 6.103515625e-05f, 5.9604645e-08f, 0.333333f };
+	for (unsigned i = 0; i < sizeof(values) / sizeof(float); ++i) {
+		float f = half_to_float(float_to_half(values[i]));
+		TEST_ASSERT(std::abs(f - values[i]) <= std::abs(values[i]) * 1e-3f)
+	}
+	TEST_ASSERT_EQ(float_to_half(1.0f), 0x3c00)
+	TEST_ASSERT_EQ(float_to_half(1e6f), 0x7c00)
+	TEST_ASSERT_EQ(float_to_half(-1e6f), 0xfc00)
+	// rounding to nearest even
+	TEST_ASSERT_EQ(float_to_half(1.0f + 1.0f / 2048), 0x3c00)
+	TEST_ASSERT_EQ(float_to_half(1.0f + 3.0f / 2048), 0x3c02)
+	TEST_ASSERT(half_to_float(0x7e00) != half_to_float(0x7e00))
+	return true;
+}
+
+bool test_format_converter()
+{
+	const size_t n = 37;
+	std::vector<unsigned char> rgb(3 * n), rgba(4 * n), rgba_ref(4 * n), back(3 * n);
+	for (size_t i = 0; i < rgb.size(); ++i)
+		rgb[i] = (unsigned char)(i * 7 + 3);
+
+	// 8 bit reorderings agree with the per component path
+	const char* formats[][2] = {
+		{ "uint8[R,G,B]", "uint8[R,G,B,A]" },
+		{ "uint8[R,G,B]", "uint8[B,G,R]" },
+		{ "uint8[B,G,R]", "uint8[R,G,B,A]" },
+		{ "uint8[R,G,B]", "uint8[G,R]" },
+		{ 0, 0 }
+	};
+	for (unsigned f = 0; formats[f][0]; ++f) {
+		component_format sf(formats[f][0]), df(formats[f][1]);
+		format_converter fc(sf, df);
+		TEST_ASSERT(fc.is_valid() && fc.is_specialized())
+		fc.convert(&rgb[0], &rgba[0], n);
+		reference_convert(sf, &rgb[0], df, &rgba_ref[0], n);
+		TEST_ASSERT(std::memcmp(&rgba[0], &rgba_ref[0], n * df.get_entry_size()) == 0)
+	}
+	// rgba -> rgb round trip
+	format_converter to_rgba(component_format("uint8[R,G,B]"), component_format("uint8[R,G,B,A]"));
+	format_converter to_rgb(component_format("uint8[R,G,B,A]"), component_format("uint8[R,G,B]"));
+	to_rgba.convert(&rgb[0], &rgba[0], n);
+	TEST_ASSERT_EQ(rgba[3], 255)
+	to_rgb.convert(&rgba[0], &back[0], n);
+	TEST_ASSERT(back == rgb)
+
+	// normalized 16 bit depth to float and back
+	std::vector<unsigned short> depth(n), depth_back(n);
+	std::vector<float> depth_f(n);
+	for (size_t i = 0; i < n; ++i)
+		depth[i] = (unsigned short)(i * 1771);
+	format_converter d2f(component_format("uint16[D]"), component_format("flt32[D]"));
+	format_converter f2d(component_format("flt32[D]"), component_format("uint16[D]"));
+	TEST_ASSERT(d2f.is_specialized() && f2d.is_specialized())
+	d2f.convert(&depth[0], &depth_f[0], n);
+	TEST_ASSERT(std::abs(depth_f[1] - 1771.0f / 65535) < 1e-6f)
+	f2d.convert(&depth_f[0], &depth_back[0], n);
+	TEST_ASSERT(depth_back == depth)
+	// integer interpretation keeps the values
+	format_converter d2f_int(component_format("_uint16[D]"), component_format("flt32[D]"));
+	d2f_int.convert(&depth[0], &depth_f[0], n);
+	TEST_ASSERT_EQ(depth_f[2], 3542.0f)
+
+	// float to half and back
+	std::vector<float> col(4 * n), col_back(4 * n);
+	std::vector<unsigned short> col_h(4 * n);
+	for (size_t i = 0; i < col.size(); ++i)
+		col[i] = float(i) / col.size();
+	format_converter f2h(component_format("flt32[R,G,B,A]"), component_format("flt16[R,G,B,A]"));
+	format_converter h2f(component_format("flt16[R,G,B,A]"), component_format("flt32[R,G,B,A]"));
+	TEST_ASSERT(f2h.is_specialized() && h2f.is_specialized())
+	f2h.convert(&col[0], &col_h[0], n);
+	h2f.convert(&col_h[0], &col_back[0], n);
+	for (size_t i = 0; i < col.size(); ++i)
+		TEST_ASSERT(std::abs(col[i] - col_back[i]) < 1e-3f)
+
+	// float to 8 bit with rounding and clamping
+	float fv[] = { -1.0f, 0.0f, 0.5f, 1.0f, 2.0f, 0.2f, 0.7f, 0.9f, 1e7f, -1e7f, 0, 0, 0, 0, 0, 0, 1.0f };
+	unsigned char uv[17];
+	format_converter f2u(component_format("flt32[L]"), component_format("uint8[L]"));
+	f2u.convert(fv, uv, 17);
+	TEST_ASSERT(uv[0] == 0 && uv[1] == 0 && uv[2] == 128 && uv[3] == 255 && uv[4] == 255 && uv[5] == 51 && uv[8] == 255 && uv[9] == 0 && uv[16] == 255)
+
+	// packed 565 and 1010102 formats
+	unsigned short p565 = (unsigned short)((31 << 11) | (32 << 5) | 0);
+	unsigned char u565[3];
+	format_converter unpack565(component_format("uint16[R:5,G:6,B:5]"), component_format("uint8[B,G,R]"));
+	TEST_ASSERT(unpack565.is_specialized())
+	unpack565.convert(&p565, u565, 1);
+	TEST_ASSERT(u565[0] == 255 && u565[1] == 130 && u565[2] == 0)
+	unsigned short p565_back = 0;
+	format_converter pack565(component_format("uint8[B,G,R]"), component_format("uint16[R:5,G:6,B:5]"));
+	pack565.convert(u565, &p565_back, 1);
+	TEST_ASSERT_EQ(p565_back, p565)
+	unsigned p1010102 = 1023u | (512u << 10) | (0u << 20) | (3u << 30);
+	float f1010102[4];
+	format_converter unpack1010102(component_format("uint32[R:10,G:10,B:10,A:2]"), component_format("flt32[R,G,B,A]"));
+	unpack1010102.convert(&p1010102, f1010102, 1);
+	TEST_ASSERT(f1010102[0] == 1.0f && std::abs(f1010102[1] - 512.0f / 1023) < 1e-6f && f1010102[2] == 0.0f && f1010102[3] == 1.0f)
+
+	// luminance through generic kernel
+	unsigned char white[3] = { 255, 255, 255 }, lum = 0;
+	format_converter rgb2l(component_format("uint8[R,G,B]"), component_format("uint8[L]"));
+	TEST_ASSERT(rgb2l.is_valid() && !rgb2l.is_specialized())
+	rgb2l.convert(white, &lum, 1);
+	TEST_ASSERT_EQ(lum, 255)
+	return true;
+}
+
+bool test_convert_data_view()
+{
+	// large enough to distribute rows over threads
+	data_format src_df(512, 256, cgv::type::info::TI_UINT8, CF_RGB);
+	data_format dst_df(512, 256, cgv::type::info::TI_UINT8, CF_RGBA);
+	data_format small_df(32, 16, cgv::type::info::TI_UINT8, CF_RGBA);
+	data_view src(&src_df), dst(&dst_df), small(&small_df);
+	for (unsigned i = 0; i < src_df.get_nr_bytes(); ++i)
+		src.get_ptr<unsigned char>()[i] = (unsigned char)(i * 13);
+	TEST_ASSERT(!small.convert_from(src))
+	TEST_ASSERT(dst.convert_from(src, 4))
+	bool equal = true;
+	for (unsigned y = 0; y < 256; ++y)
+		for (unsigned x = 0; x < 512; ++x)
+			for (unsigned c = 0; c < 4; ++c)
+				equal = equal && dst.get_ptr<unsigned char>(y, x)[c] == (c == 3 ? 255 : src.get_ptr<unsigned char>(y, x)[c]);
+	TEST_ASSERT(equal)
+	// convert a single row back
+	data_view row = src(7);
+	std::memset(row.get_ptr<unsigned char>(), 0, 512 * 3);
+	TEST_ASSERT(row.convert_from(dst(7)))
+	for (unsigned x = 0; x < 512; ++x)
+		TEST_ASSERT(src.get_ptr<unsigned char>(7, x)[1] == dst.get_ptr<unsigned char>(7, x)[1])
+	return true;
+}
+
+bool test_format_conversion_performance()
+{
+	const unsigned w = 1920, h = 1080;
+	std::vector<unsigned char> rgb(3 * w * h), rgba(4 * w * h);
+	std::vector<unsigned short> depth(w * h);
+	std::vector<float> depth_f(w * h);
+	for (size_t i = 0; i < rgb.size(); ++i)
+		rgb[i] = (unsigned char)i;
+	for (size_t i = 0; i < depth.size(); ++i)
+		depth[i] = (unsigned short)i;
+	component_format rgb_cf("uint8[R,G,B]"), rgba_cf("uint8[R,G,B,A]"), d_cf("uint16[D]"), f_cf("flt32[D]");
+	typedef std::chrono::high_resolution_clock clock;
+	clock::time_point t0 = clock::now();
+	reference_convert(rgb_cf, &rgb[0], rgba_cf, &rgba[0], w * h);
+	clock::time_point t1 = clock::now();
+	format_converter(rgb_cf, rgba_cf).convert(&rgb[0], &rgba[0], w * h);
+	clock::time_point t2 = clock::now();
+	reference_convert(d_cf, &depth[0], f_cf, &depth_f[0], w * h);
+	clock::time_point t3 = clock::now();
+	format_converter(d_cf, f_cf).convert(&depth[0], &depth_f[0], w * h);
+	clock::time_point t4 = clock::now();
+	std::cout << "rgb8->rgba8 1080p: per component " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+		<< " ms, kernel " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+	std::cout << "uint16->flt32 1080p: per component " << std::chrono::duration<double, std::milli>(t3 - t2).count()
+		<< " ms, kernel " << std::chrono::duration<double, std::milli>(t4 - t3).count() << " ms" << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration half_conversion_test_registration(
+	"cgv::data::half_conversion", test_half_conversion);
+
+extern CGV_API test_registration format_converter_test_registration(
+	"cgv::data::format_converter", test_format_converter);
+
+extern CGV_API test_registration convert_data_view_test_registration(
+	"cgv::data::convert_data_view", test_convert_data_view);
+
+extern CGV_API benchmark_registration format_conversion_performance_test_registration(
+	"cgv::data::format_conversion_performance", test_format_conversion_performance);
@@ -0,0 +1,125 @@
+#include <cg_nui/sphere_container.h>
+#include <cgv/math/random.h>
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+using namespace cgv::nui;
+typedef cgv::render::render_types::vec3 vec3;
+
+/// reference implementation of closest point query that iterates all spheres
+static float linear_closest_distance(const sphere_container& sc, const std::vector<vec3>& centers, const vec3& p)
+{
+	float best = std::numeric_limits<float>::max();
+	for (uint32_t i = 0; i < centers.size(); ++i)
+		best = std::min(best, std::abs((p - centers[i]).length() - sc.get_radius(i)));
+	return best;
+}
+
+/// reference implementation of first intersection query that iterates all spheres and expects normalized direction
+static float linear_first_intersection(const sphere_container& sc, const std::vector<vec3>& centers, const vec3& s, const vec3& d)
+{
+	float best = std::numeric_limits<float>::max();
+	for (uint32_t i = 0; i < centers.size(); ++i) {
+		vec3 oc = s - centers[i];
+		float r = sc.get_radius(i);
+		float b = dot(oc, d), h = b * b - dot(oc, oc) + r * r;
+		if (h < 0.0f)
+			continue;
+		h = sqrt(h);
+		float t = -b - h >= 0.0f ? -b - h : -b + h;
+		if (t >= 0.0f)
+			best = std::min(best, t);
+	}
+	return best;
+}
+
+template <typename F>
+static double measure(F f)
+{
+	std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
+	f();
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t n = argc > 1 ? atoi(argv[1]) : 50000;
+	uint32_t nr_queries = argc > 2 ? atoi(argv[2]) : 2000;
+	cgv::math::random rg(11);
+	sphere_container sc(0, true, false);
+	std::vector<vec3> centers(n);
+	for (uint32_t i = 0; i < n; ++i) {
+		rg.uniform(-10.0f, 10.0f, centers[i][0]);
+		rg.uniform(-10.0f, 10.0f, centers[i][1]);
+		rg.uniform(-10.0f, 10.0f, centers[i][2]);
+		float r;
+		rg.uniform(0.01f, 0.1f, r);
+		sc.add_sphere(centers[i], r);
+	}
+	std::vector<vec3> points(nr_queries), directions(nr_queries);
+	for (uint32_t q = 0; q < nr_queries; ++q) {
+		rg.uniform(-12.0f, 12.0f, points[q][0]);
+		rg.uniform(-12.0f, 12.0f, points[q][1]);
+		rg.uniform(-12.0f, 12.0f, points[q][2]);
+		rg.uniform(-1.0f, 1.0f, directions[q][0]);
+		rg.uniform(-1.0f, 1.0f, directions[q][1]);
+		rg.uniform(-1.0f, 1.0f, directions[q][2]);
+		directions[q].normalize();
+	}
+	double sec_build = measure([&]() { sc.ref_bvh(); });
+	std::cout << "bvh over " << n << " spheres with " << sc.ref_bvh().get_nr_nodes() << " nodes built in " << 1000 * sec_build << " ms" << std::endl;
+
+	uint32_t nr_errors = 0;
+	std::vector<float> bvh_result(nr_queries), linear_result(nr_queries);
+	double sec_bvh = measure([&]() {
+		for (uint32_t q = 0; q < nr_queries; ++q) {
+			contact_info info;
+			sc.compute_closest_point(info, points[q]);
+			bvh_result[q] = info.get_closest_distance();
+		}
+	});
+	double sec_linear = measure([&]() {
+		for (uint32_t q = 0; q < nr_queries; ++q)
+			linear_result[q] = linear_closest_distance(sc, centers, points[q]);
+	});
+	for (uint32_t q = 0; q < nr_queries; ++q)
+		if (std::abs(bvh_result[q] - linear_result[q]) > 1e-4f)
+			++nr_errors;
+	std::cout << "closest point: bvh " << nr_queries / sec_bvh << " queries/s, linear " << nr_queries / sec_linear
+		<< " queries/s, speedup " << sec_linear / sec_bvh << std::endl;
+
+	sec_bvh = measure([&]() {
+		for (uint32_t q = 0; q < nr_queries; ++q) {
+			contact_info info;
+			sc.compute_first_intersection(info, points[q], directions[q]);
+			bvh_result[q] = info.get_closest_distance();
+		}
+	});
+	sec_linear = measure([&]() {
+		for (uint32_t q = 0; q < nr_queries; ++q)
+			linear_result[q] = linear_first_intersection(sc, centers, points[q], directions[q]);
+	});
+	for (uint32_t q = 0; q < nr_queries; ++q)
+		if (std::abs(bvh_result[q] - linear_result[q]) > 1e-3f)
+			++nr_errors;
+	std::cout << "first intersection: bvh " << nr_queries / sec_bvh << " queries/s, linear " << nr_queries / sec_linear
+		<< " queries/s, speedup " << sec_linear / sec_bvh << std::endl;
+
+	// move every 10th sphere, which refits the hierarchy, and check that closest point queries follow
+	double sec_refit = measure([&]() {
+		for (uint32_t i = 0; i < n; i += 10) {
+			centers[i] = -centers[i];
+			sc.set_position(i, centers[i]);
+		}
+	});
+	for (uint32_t q = 0; q < nr_queries; ++q) {
+		contact_info info;
+		sc.compute_closest_point(info, points[q]);
+		if (std::abs(info.get_closest_distance() - linear_closest_distance(sc, centers, points[q])) > 1e-4f)
+			++nr_errors;
+	}
+	std::cout << "refit of " << (n + 9) / 10 << " spheres in " << 1000 * sec_refit << " ms" << std::endl;
+	std::cout << nr_errors << " mismatches with linear search" << std::endl;
+	return nr_errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+#include <delaunay/delaunay_mesh_with_hierarchy.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <math.h>
+
+typedef delaunay_mesh<> mesh_type;
+typedef delaunay_mesh_with_hierarchy<> hierarchy_mesh_type;
+typedef mesh_type::point_type point_type;
+
+/// generate n uniformly distributed points, optionally sorted along x which is the worst case for walking from a fixed corner
+void generate_points(unsigned int n, bool sorted, std::vector<point_type>& points)
+{
+	std::mt19937 rand_gen;
+	std::uniform_real_distribution<double> uni_dist(0.0, 1.0);
+	points.resize(n);
+	for (unsigned int i = 0; i < n; ++i) {
+		double x = uni_dist(rand_gen);
+		double y = uni_dist(rand_gen);
+		points[i] = point_type(x, y);
+	}
+	if (sorted)
+		std::sort(points.begin(), points.end(), [](const point_type& p, const point_type& q) { return p.x() < q.x(); });
+}
+
+/// return whether the four points of the edge opposite to ci are so close to cocircular that rounding can decide the delaunay predicate either way
+bool is_nearly_cocircular(const mesh_type& m, unsigned int ci)
+{
+	const point_type& p3 = m.p_of_vi(m.vi_of_ci(m.inv(ci)));
+	double d[3][3], c_max = std::max(fabs(p3.x()), fabs(p3.y()));
+	unsigned int cj = ci;
+	for (unsigned int i = 0; i < 3; ++i, cj = m.next(cj)) {
+		const point_type& p = m.p_of_vi(m.vi_of_ci(cj));
+		d[i][0] = p.x() - p3.x();
+		d[i][1] = p.y() - p3.y();
+		d[i][2] = d[i][0] * d[i][0] + d[i][1] * d[i][1];
+		c_max = std::max(c_max, std::max(fabs(p.x()), fabs(p.y())));
+	}
+	double det = d[0][0] * (d[1][1] * d[2][2] - d[1][2] * d[2][1])
+		- d[0][1] * (d[1][0] * d[2][2] - d[1][2] * d[2][0])
+		+ d[0][2] * (d[1][0] * d[2][1] - d[1][1] * d[2][0]);
+	// the predicate evaluates products of four untranslated coordinates
+	return fabs(det) < 1e-12 * c_max * c_max * c_max * c_max;
+}
+
+/// check that all flipable edges are locally delaunay up to rounding errors of the predicate
+bool is_delaunay(const mesh_type& m)
+{
+	for (unsigned int ci = 0; ci < 3 * m.get_nr_triangles(); ++ci)
+		if (m.is_flipable(ci) && !m.is_locally_delaunay(ci) && !is_nearly_cocircular(m, ci))
+			return false;
+	return true;
+}
+
+/// insert the points one by one in their given order with the point location started at corner 0
+template <class M>
+void insert_in_given_order(M& m)
+{
+	m.add_triangle(0, 1, 2);
+	for (unsigned int vi = 3; vi < m.get_nr_vertices(); ++vi)
+		m.insert_vertex(vi);
+}
+
+template <class M>
+double measure_points_per_second(const std::vector<point_type>& points, bool bulk, M& m)
+{
+	for (unsigned int i = 0; i < points.size(); ++i)
+		m.add_point(points[i]);
+	typedef std::chrono::high_resolution_clock clock;
+	clock::time_point t0 = clock::now();
+	if (bulk)
+		m.compute_triangulation();
+	else
+		insert_in_given_order(m);
+	double t = std::chrono::duration<double>(clock::now() - t0).count();
+	return points.size() / t;
+}
+
+/// compare insertion in given order, hierarchy point location and BRIO bulk construction, where the slow variants are skipped for large inputs
+bool compare_construction(unsigned int n, bool sorted)
+{
+	std::vector<point_type> points;
+	generate_points(n, sorted, points);
+	std::cout << n << (sorted ? " x-sorted" : " random") << " points:";
+	bool valid = true;
+	mesh_type b;
+	std::cout << " brio " << measure_points_per_second(points, true, b) << "/s";
+	valid = is_delaunay(b) && valid;
+	if (!sorted || n <= 100000) {
+		hierarchy_mesh_type h;
+		std::cout << ", hierarchy " << measure_points_per_second(points, true, h) << "/s";
+		valid = is_delaunay(h) && h.get_nr_triangles() == b.get_nr_triangles() && valid;
+	}
+	if (n <= 100000) {
+		mesh_type m;
+		std::cout << ", given order " << measure_points_per_second(points, false, m) << "/s";
+		valid = is_delaunay(m) && m.get_nr_triangles() == b.get_nr_triangles() && valid;
+	}
+	std::cout << std::endl;
+	if (!valid)
+		std::cout << "triangulation is not delaunay" << std::endl;
+	return valid;
+}
+
+/// bulk construction must not pick two coinciding vertices as the first edge of the seed triangle, where for many of these sizes the BRIO order starts with two duplicates
+bool triangulate_duplicates()
+{
+	for (unsigned int n = 100; n <= 200; ++n) {
+		mesh_type m;
+		for (unsigned int i = 0; i < n; ++i)
+			m.add_point(point_type(0.25, 0.5));
+		m.add_point(point_type(0.0, 0.0));
+		m.add_point(point_type(1.0, 0.0));
+		m.add_point(point_type(1.0, 1.0));
+		m.compute_triangulation();
+		if (m.get_nr_triangles() == 0) {
+			std::cout << "duplicate vertices prevented triangulation" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	bool valid = triangulate_duplicates();
+	unsigned int sizes[] = { 10000, 100000, 1000000 };
+	for (unsigned int i = 0; i < 3; ++i) {
+		valid = compare_construction(sizes[i], false) && valid;
+		valid = compare_construction(sizes[i], true) && valid;
+	}
+	return valid ? 0 : 1;
+}
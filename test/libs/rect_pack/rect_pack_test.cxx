@@ -1,4 +1,5 @@
 #include <rect_pack/rect_pack.h>
+#include <rect_pack/online_packer.h>
 
 
 int main(int argc, char** argv)
@@ -6,4 +7,5 @@ int main(int argc, char** argv)
 	std::vector<rect_pack::rectangle_size> rectangle_sizes;
 	rect_pack::construct_random_rectangles(1401, rectangle_sizes);
 	rect_pack::compare_packing_strategies("rect_pack_", rectangle_sizes, rect_pack::CS_ShorterSideFirst, false, true, false, true);
+	rect_pack::analyze_online_packing("rect_pack_", 1401, 5000);
 }
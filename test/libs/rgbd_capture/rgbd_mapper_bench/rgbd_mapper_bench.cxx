@@ -0,0 +1,153 @@
+#include <rgbd_capture/rgbd_mapper.h>
+#include <rgbd_capture/rgbd_recording.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using namespace rgbd;
+
+/// write a short synthetic recording of a tilted plane with a moving sphere and a color gradient
+static bool create_recording(const std::string& fn, unsigned nr_frames)
+{
+	rgbd_recorder recorder;
+	if (!recorder.open(fn))
+		return false;
+	frame_type depth, color;
+	static_cast<frame_format&>(depth) = stream_format(640, 480, PF_DEPTH, 30, 16);
+	static_cast<frame_format&>(color) = stream_format(640, 480, PF_BGRA, 30, 32);
+	depth.frame_data.resize(depth.buffer_size);
+	color.frame_data.resize(color.buffer_size);
+	for (unsigned i = 0; i < nr_frames; ++i) {
+		depth.frame_index = color.frame_index = i;
+		depth.time = color.time = i / 30.0;
+		unsigned short* d = reinterpret_cast<unsigned short*>(&depth.frame_data.front());
+		unsigned char* c = reinterpret_cast<unsigned char*>(&color.frame_data.front());
+		float cx = 320 + 200 * std::sin(0.05f * i);
+		for (int y = 0; y < 480; ++y)
+			for (int x = 0; x < 640; ++x, c += 4) {
+				float z = 1500.0f + 2.0f * y;
+				float r2 = (x - cx) * (x - cx) + (y - 240.0f) * (y - 240.0f);
+				if (r2 < 100 * 100)
+					z -= std::sqrt(100 * 100 - r2) * 3;
+				*d++ = (x < 8 || ((x * 7 + y * 13 + i) % 53) == 0) ? 0 : (unsigned short)z;
+				c[0] = (unsigned char)x; c[1] = (unsigned char)y; c[2] = (unsigned char)(x + y + i); c[3] = 255;
+			}
+		// wait for the writer instead of dropping frames as this is not a capture path
+		while (!recorder.push_frame(IS_DEPTH, depth))
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		while (!recorder.push_frame(IS_COLOR, color))
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return recorder.close();
+}
+
+/// per pixel reference without lookup tables that appends to vectors as done before
+static void reference_unproject(const camera_intrinsics& DK, const camera_intrinsics& CK, const camera_extrinsics& E,
+	const frame_type& depth, const frame_type& color, std::vector<float>& P, std::vector<unsigned char>& C)
+{
+	P.clear();
+	C.clear();
+	const unsigned short* d = reinterpret_cast<const unsigned short*>(&depth.frame_data.front());
+	for (int y = 0; y < depth.height; ++y)
+		for (int x = 0; x < depth.width; ++x) {
+			float z = *d++ * 0.001f;
+			if (z < 0.1f || z > 10.0f)
+				continue;
+			float rx, ry;
+			DK.compute_ray(float(x), float(y), rx, ry);
+			float p[3] = { rx * z, ry * z, z };
+			P.insert(P.end(), p, p + 3);
+			float q[3];
+			for (int j = 0; j < 3; ++j)
+				q[j] = E.R[3 * j] * p[0] + E.R[3 * j + 1] * p[1] + E.R[3 * j + 2] * p[2] + E.t[j];
+			float xd, yd;
+			CK.distort(q[0] / q[2], q[1] / q[2], xd, yd);
+			int u = int(CK.fx * xd + CK.cx + 0.5f), v = int(CK.fy * yd + CK.cy + 0.5f);
+			if (u < 0 || v < 0 || u >= color.width || v >= color.height) {
+				C.insert(C.end(), 4, 0);
+				continue;
+			}
+			const unsigned char* c = reinterpret_cast<const unsigned char*>(&color.frame_data.front()) + 4 * (v * color.width + u);
+			unsigned char rgba[4] = { c[2], c[1], c[0], 255 };
+			C.insert(C.end(), rgba, rgba + 4);
+		}
+}
+
+int main(int argc, char** argv)
+{
+	std::string fn = argc > 1 ? get_recording_file_name(argv[1]) : std::string("rgbd_mapper_bench.rgbd");
+	if (argc <= 1 && !create_recording(fn, 60)) {
+		std::cerr << "could not create " << fn << std::endl;
+		return 1;
+	}
+	rgbd_recording_reader reader;
+	if (!reader.open(fn) || reader.get_nr_frames(IS_DEPTH) == 0) {
+		std::cerr << "could not read depth frames from " << fn << std::endl;
+		return 1;
+	}
+	size_t nr_frames = std::min(reader.get_nr_frames(IS_DEPTH), reader.get_nr_frames(IS_COLOR));
+	std::vector<frame_type> depth_frames(nr_frames), color_frames(nr_frames);
+	for (size_t i = 0; i < nr_frames; ++i) {
+		reader.read_frame(IS_DEPTH, i, depth_frames[i]);
+		reader.read_frame(IS_COLOR, i, color_frames[i]);
+	}
+	const frame_type& D0 = depth_frames[0];
+	camera_intrinsics DK(571.25f, 571.25f, 320.0f, 224.0f);
+	DK.k1 = 0.05f; DK.k2 = -0.1f; DK.p1 = 0.001f;
+	camera_intrinsics CK(525.0f, 525.0f, 320.0f, 240.0f);
+	CK.k1 = 0.02f;
+	camera_extrinsics E(0.9999f, 0.01f, 0.0f, 0.0f, 0.023f, 0.0f, 0.0f);
+
+	std::vector<float> P_ref;
+	std::vector<unsigned char> C_ref;
+	std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+	size_t nr_points = 0;
+	for (size_t i = 0; i < nr_frames; ++i) {
+		reference_unproject(DK, CK, E, depth_frames[i], color_frames[i], P_ref, C_ref);
+		nr_points += P_ref.size() / 3;
+	}
+	double sec_ref = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	std::cout << nr_frames << " frames " << D0.width << "x" << D0.height << " from " << fn << std::endl;
+	std::cout << "reference per pixel:    " << 1000 * sec_ref / nr_frames << " ms/frame (" << nr_points / sec_ref * 1e-6 << " Mpts/s)" << std::endl;
+
+	unsigned nr_errors = 0;
+	unsigned thread_counts[2] = { 1, 0 };
+	for (unsigned k = 0; k < 2; ++k) {
+		rgbd_mapper mapper(thread_counts[k]);
+		mapper.set_depth_camera(DK, D0.width, D0.height, 0.001f);
+		mapper.set_color_camera(CK, E);
+		std::vector<float> P(3 * mapper.get_max_nr_points());
+		std::vector<unsigned char> C(4 * mapper.get_max_nr_points());
+		t0 = std::chrono::steady_clock::now();
+		nr_points = 0;
+		for (size_t i = 0; i < nr_frames; ++i)
+			nr_points += mapper.unproject(depth_frames[i], &P[0], &color_frames[i], &C[0]);
+		double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		frame_type warped;
+		t0 = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < nr_frames; ++i)
+			mapper.map_color_to_depth(depth_frames[i], color_frames[i], warped);
+		double sec_warp = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		std::cout << "mapper threads=" << mapper.get_nr_threads() << ": " << 1000 * sec / nr_frames << " ms/frame ("
+			<< nr_points / sec * 1e-6 << " Mpts/s, speedup " << sec_ref / sec << "), color warp " << 1000 * sec_warp / nr_frames << " ms/frame" << std::endl;
+		// compare last frame with reference
+		size_t n = mapper.unproject(depth_frames[nr_frames - 1], &P[0], &color_frames[nr_frames - 1], &C[0]);
+		if (n * 3 != P_ref.size())
+			++nr_errors;
+		else {
+			// color lookups can differ for points that project to the border between two color pixels
+			size_t nr_color_mismatches = 0;
+			for (size_t i = 0; i < 3 * n; ++i) {
+				if (std::abs(P[i] - P_ref[i]) > 1e-5f * (1 + std::abs(P_ref[i])))
+					++nr_errors;
+				if (C[4 * (i / 3) + i % 3] != C_ref[4 * (i / 3) + i % 3])
+					++nr_color_mismatches;
+			}
+			if (nr_color_mismatches > n / 1000)
+				++nr_errors;
+		}
+	}
+	std::cout << nr_errors << " mismatches with reference" << std::endl;
+	return nr_errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+#include <rgbd_capture/rgbd_input.h>
+#include <rgbd_capture/rgbd_recording.h>
+#include <cgv/utils/file.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <iostream>
+
+using namespace rgbd;
+
+/// synthetic depth frame of a tilted plane with a moving sphere, sensor noise and invalid pixels
+static void create_depth_frame(unsigned idx, frame_type& frame)
+{
+	static_cast<frame_format&>(frame) = stream_format(640, 480, PF_DEPTH, 30, 16);
+	frame.frame_index = idx;
+	frame.time = idx / 30.0;
+	frame.frame_data.resize(frame.buffer_size);
+	unsigned short* d = reinterpret_cast<unsigned short*>(&frame.frame_data.front());
+	unsigned seed = 17 + idx;
+	float cx = 320 + 200 * std::sin(0.05f * idx), cy = 240;
+	for (int y = 0; y < frame.height; ++y)
+		for (int x = 0; x < frame.width; ++x) {
+			seed = seed * 1664525u + 1013904223u;
+			float z = 1500.0f + 2.0f * y;
+			float r2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+			if (r2 < 100 * 100)
+				z -= std::sqrt(100 * 100 - r2) * 3;
+			int noise = int((seed >> 16) % 5) - 2;
+			bool invalid = x < 8 || (x > 500 && y > 400) || (seed >> 8) % 97 == 0;
+			*d++ = invalid ? 0 : (unsigned short)(z + noise);
+		}
+}
+
+static void create_color_frame(unsigned idx, frame_type& frame)
+{
+	static_cast<frame_format&>(frame) = stream_format(640, 480, PF_BGRA, 30, 32);
+	frame.frame_index = idx;
+	frame.time = idx / 30.0;
+	frame.frame_data.resize(frame.buffer_size);
+	for (unsigned i = 0; i < frame.buffer_size; ++i)
+		frame.frame_data[i] = char(i * 7 + idx);
+}
+
+int main(int argc, char** argv)
+{
+	std::string fn = get_recording_file_name(argc > 1 ? argv[1] : "rgbd_recording_test");
+	unsigned nr_frames = argc > 2 ? atoi(argv[2]) : 120;
+	std::vector<frame_type> depth_frames(nr_frames), color_frames(nr_frames);
+	for (unsigned i = 0; i < nr_frames; ++i) {
+		create_depth_frame(i, depth_frames[i]);
+		create_color_frame(i, color_frames[i]);
+	}
+	unsigned nr_errors = 0;
+
+	// record at 30 Hz and measure the time spent on the capture path
+	rgbd_recorder recorder;
+	if (!recorder.open(fn)) {
+		std::cerr << "could not open " << fn << std::endl;
+		return 1;
+	}
+	double max_push = 0, sum_push = 0;
+	std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+	for (unsigned i = 0; i < nr_frames; ++i) {
+		std::this_thread::sleep_until(t_start + std::chrono::microseconds(33333 * i));
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		recorder.push_frame(IS_DEPTH, depth_frames[i]);
+		recorder.push_frame(IS_COLOR, color_frames[i]);
+		double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		sum_push += dt;
+		max_push = std::max(max_push, dt);
+	}
+	recorder.close();
+	std::cout << "recorded " << recorder.get_nr_written_frames() << " frames, dropped " << recorder.get_nr_dropped_frames()
+		<< ", push of depth+color avg " << 1e6 * sum_push / nr_frames << " us max " << 1e6 * max_push << " us" << std::endl;
+	std::cout << "written " << recorder.get_nr_written_bytes() / 1048576.0 << " MB of " << recorder.get_nr_raw_bytes() / 1048576.0 << " MB" << std::endl;
+
+	// depth compression ratio and codec throughput
+	std::vector<char> compressed;
+	std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+	for (unsigned i = 0; i < nr_frames; ++i) {
+		compressed.clear();
+		compress_frame_data(depth_frames[i], &depth_frames[i].frame_data.front(), FC_DELTA_RICE16, compressed);
+	}
+	double sec_compress = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	std::cout << "depth compression ratio " << double(depth_frames[0].buffer_size) / compressed.size()
+		<< ", compression " << nr_frames / sec_compress << " fps" << std::endl;
+
+	// read back all frames through the memory mapped reader
+	rgbd_recording_reader reader;
+	if (!reader.open(fn)) {
+		std::cerr << "could not read " << fn << std::endl;
+		return 1;
+	}
+	if (reader.get_nr_frames(IS_DEPTH) != nr_frames || reader.get_nr_frames(IS_COLOR) != nr_frames)
+		++nr_errors;
+	frame_type frame;
+	t0 = std::chrono::steady_clock::now();
+	for (unsigned i = 0; i < reader.get_nr_frames(IS_DEPTH); ++i)
+		if (!reader.read_frame(IS_DEPTH, i, frame) || frame.frame_data != depth_frames[i].frame_data || frame.frame_index != i)
+			++nr_errors;
+	double sec_decompress = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	std::cout << "depth decompression " << nr_frames / sec_decompress << " fps" << std::endl;
+	for (unsigned i = 0; i < reader.get_nr_frames(IS_COLOR); ++i)
+		if (!reader.read_frame(IS_COLOR, i, frame) || frame.frame_data != color_frames[i].frame_data)
+			++nr_errors;
+	size_t pos = reader.find_frame(IS_DEPTH, reader.get_entry(IS_DEPTH, nr_frames / 2).recording_time);
+	if (pos != nr_frames / 2)
+		++nr_errors;
+	reader.close();
+
+	// play back through the emulation device
+	rgbd_input input;
+	std::vector<stream_format> sfs;
+	if (!input.attach_path(fn) || !input.start(IS_COLOR_AND_DEPTH, sfs) || sfs.size() != 2)
+		++nr_errors;
+	else {
+		t0 = std::chrono::steady_clock::now();
+		for (unsigned i = 0; i < nr_frames; ++i) {
+			if (!input.get_frame(IS_DEPTH, frame, -1) || frame.frame_data != depth_frames[i].frame_data)
+				++nr_errors;
+			if (!input.get_frame(IS_COLOR, frame, -1) || frame.frame_data != color_frames[i].frame_data)
+				++nr_errors;
+		}
+		double sec_play = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		std::cout << "played back " << nr_frames << " frames in " << sec_play << " s at " << sfs[0].fps << " fps" << std::endl;
+		input.stop();
+		input.detach();
+	}
+	// protocols of one file per frame are converted explicitly, depth with frame header and color as raw data
+	std::string frame_path = std::string(argc > 1 ? argv[1] : "rgbd_recording_test") + "_frame_";
+	std::remove(get_recording_file_name(frame_path).c_str());
+	const unsigned nr_frame_files = std::min(10u, nr_frames);
+	for (unsigned i = 0; i < nr_frame_files; ++i) {
+		rgbd_input::write_frame(compose_file_name(frame_path, depth_frames[i], i), depth_frames[i]);
+		cgv::utils::file::write(compose_file_name(frame_path, color_frames[i], i), &color_frames[i].frame_data.front(), color_frames[i].frame_data.size(), false);
+	}
+	if (input.attach_path(frame_path))
+		++nr_errors;
+	if (convert_frame_files(frame_path, get_recording_file_name(frame_path)) != 2 * nr_frame_files ||
+		!input.attach_path(frame_path) || !input.start(IS_COLOR_AND_DEPTH, sfs))
+		++nr_errors;
+	else {
+		for (unsigned i = 0; i < nr_frame_files; ++i) {
+			if (!input.get_frame(IS_DEPTH, frame, -1) || frame.frame_data != depth_frames[i].frame_data)
+				++nr_errors;
+			if (!input.get_frame(IS_COLOR, frame, -1) || frame.frame_data != color_frames[i].frame_data || frame.pixel_format != PF_BGRA)
+				++nr_errors;
+		}
+		std::cout << "played back " << nr_frame_files << " converted frame files" << std::endl;
+		input.stop();
+		input.detach();
+	}
+	for (unsigned i = 0; i < nr_frame_files; ++i) {
+		std::remove(compose_file_name(frame_path, depth_frames[i], i).c_str());
+		std::remove(compose_file_name(frame_path, color_frames[i], i).c_str());
+	}
+	std::remove(get_recording_file_name(frame_path).c_str());
+	std::cout << nr_errors << " errors" << std::endl;
+	return nr_errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+#include <chrono>
+#include <iostream>
+#include <cgv/math/chunk_box_hierarchy.h>
+#include <cgv/math/ftransform.h>
+#include <cgv/math/random.h>
+#include <cgv/base/register.h>
+
+using namespace cgv::base;
+using namespace cgv::math;
+
+typedef chunk_box_hierarchy<float> hierarchy_type;
+typedef hierarchy_type::vec_type vec3;
+
+/// generate points along a random walk such that chunks of consecutive points are spatially coherent
+static void generate_points(std::vector<vec3>& points, std::vector<float>& radii, size_t n, unsigned seed)
+{
+	cgv::math::random rg(seed);
+	points.resize(n);
+	radii.resize(n);
+	vec3 p(0.0f);
+	for (size_t i = 0; i < n; ++i) {
+		for (unsigned j = 0; j < 3; ++j) {
+			float d;
+			rg.uniform(-0.05f, 0.05f, d);
+			p[j] = std::max(-10.0f, std::min(10.0f, p[j] + d));
+		}
+		points[i] = p;
+		rg.uniform(0.0f, 0.02f, radii[i]);
+	}
+}
+
+/// return frustum of a camera at eye looking at the origin
+static fmat<float, 4, 4> compute_modelview_projection(const vec3& eye, float fovy, float z_far = 50.0f)
+{
+	return perspective4<float>(fovy, 1.5f, 0.1f, z_far) * look_at4<float>(eye, vec3(0.0f), vec3(0, 1, 0));
+}
+
+/// check that ranges are sorted and maximal and contain every element whose sphere is not outside of a plane
+static bool check_ranges(const std::vector<hierarchy_type::index_range>& ranges, size_t nr_visible, const std::vector<vec3>& points,
+	const std::vector<float>& radii, float radius, const fmat<float, 4, 4>& mvp)
+{
+	std::vector<unsigned char> covered(points.size(), 0);
+	size_t nr_covered = 0;
+	for (size_t i = 0; i < ranges.size(); ++i) {
+		if (ranges[i].count == 0 || ranges[i].start + ranges[i].count > points.size())
+			return false;
+		if (i > 0 && ranges[i - 1].start + ranges[i - 1].count >= ranges[i].start)
+			return false;
+		for (size_t j = ranges[i].start; j < ranges[i].start + ranges[i].count; ++j)
+			covered[j] = 1;
+		nr_covered += ranges[i].count;
+	}
+	if (nr_covered != nr_visible)
+		return false;
+	hierarchy_type::plane_type planes[6];
+	hierarchy_type::extract_frustum_planes(mvp, planes);
+	for (size_t i = 0; i < points.size(); ++i) {
+		bool inside = true;
+		for (unsigned pi = 0; pi < 6; ++pi)
+			if (dot(vec3(planes[pi][0], planes[pi][1], planes[pi][2]), points[i]) + planes[pi][3] < -(radius + radii[i]))
+				inside = false;
+		if (inside && !covered[i])
+			return false;
+	}
+	return true;
+}
+
+/// compare all boxes of two hierarchies
+static bool equal_boxes(const hierarchy_type& h1, const hierarchy_type& h2)
+{
+	if (h1.get_nr_levels() != h2.get_nr_levels())
+		return false;
+	for (unsigned li = 0; li < h1.get_nr_levels(); ++li)
+		if (h1.get_level(li).box_min != h2.get_level(li).box_min || h1.get_level(li).box_max != h2.get_level(li).box_max)
+			return false;
+	return true;
+}
+
+bool test_chunk_box_hierarchy()
+{
+	std::vector<vec3> points;
+	std::vector<float> radii;
+	generate_points(points, radii, 100003, 3);
+	hierarchy_type h;
+	h.build(&points[0], points.size(), 0.01f, &radii[0], 64, 4, 1);
+	TEST_ASSERT_EQ(h.get_level(0).get_nr_boxes(), size_t((points.size() + 63) / 64));
+	TEST_ASSERT_EQ(h.get_level(h.get_nr_levels() - 1).get_nr_boxes(), size_t(1));
+	// conservative culling with single and multiple threads for several views
+	vec3 eyes[4] = { vec3(0, 0, 20), vec3(5, 3, 1), vec3(-2, 0.5f, 0.5f), vec3(30, 30, 30) };
+	std::vector<hierarchy_type::index_range> ranges, ranges_mt;
+	for (unsigned vi = 0; vi < 4; ++vi) {
+		fmat<float, 4, 4> mvp = compute_modelview_projection(eyes[vi], 40.0f);
+		size_t nr_visible = h.cull(mvp, ranges, 1);
+		TEST_ASSERT(check_ranges(ranges, nr_visible, points, radii, 0.01f, mvp));
+		TEST_ASSERT_EQ(h.cull(mvp, ranges_mt, 4), nr_visible);
+		TEST_ASSERT_EQ(ranges_mt.size(), ranges.size());
+	}
+	// camera inside of the point set sees only part of it
+	TEST_ASSERT(h.cull(compute_modelview_projection(eyes[2], 40.0f), ranges) < points.size());
+	// everything is visible from far away
+	TEST_ASSERT_EQ(h.cull(compute_modelview_projection(eyes[3], 60.0f, 100.0f), ranges), points.size());
+	TEST_ASSERT_EQ(ranges.size(), size_t(1));
+	// incremental update results in the same boxes as a rebuild
+	cgv::math::random rg(5);
+	for (unsigned k = 0; k < 100; ++k) {
+		unsigned i;
+		rg.uniform(0u, unsigned(points.size() - 1), i);
+		points[i] += vec3(1.0f, -2.0f, 0.5f);
+		h.invalidate(i, 1);
+	}
+	h.invalidate(points.size() - 10, 100);
+	TEST_ASSERT(h.get_nr_dirty_chunks() <= 101);
+	TEST_ASSERT(h.update(&points[0], &radii[0]) > 0);
+	TEST_ASSERT_EQ(h.get_nr_dirty_chunks(), size_t(0));
+	hierarchy_type h2;
+	h2.build(&points[0], points.size(), 0.01f, &radii[0], 64, 4, 3);
+	TEST_ASSERT(equal_boxes(h, h2));
+	fmat<float, 4, 4> mvp = compute_modelview_projection(eyes[1], 40.0f);
+	TEST_ASSERT(check_ranges(ranges, h.cull(mvp, ranges), points, radii, 0.01f, mvp));
+	// empty hierarchy
+	hierarchy_type h3;
+	h3.build(0, 0);
+	TEST_ASSERT_EQ(h3.cull(mvp, ranges), size_t(0));
+	TEST_ASSERT(ranges.empty());
+	return true;
+}
+
+bool test_chunk_box_hierarchy_performance()
+{
+	std::vector<vec3> points;
+	std::vector<float> radii;
+	const size_t n = 4000000;
+	generate_points(points, radii, n, 7);
+	typedef std::chrono::high_resolution_clock clock;
+	hierarchy_type h;
+	clock::time_point t0 = clock::now();
+	h.build(&points[0], n, 0.01f, 0, 256);
+	clock::time_point t1 = clock::now();
+	std::vector<hierarchy_type::index_range> ranges;
+	const unsigned nr_frames = 100;
+	size_t nr_visible = 0;
+	for (unsigned f = 0; f < nr_frames; ++f) {
+		float a = 6.2831853f*f / nr_frames;
+		nr_visible += h.cull(compute_modelview_projection(vec3(3 * std::cos(a), 1, 3 * std::sin(a)), 50.0f), ranges);
+	}
+	clock::time_point t2 = clock::now();
+	for (size_t i = 0; i < n; i += 1000)
+		h.invalidate(i, 1);
+	h.update(&points[0]);
+	clock::time_point t3 = clock::now();
+	std::cout << "\n  chunk boxes over " << n / 1000000 << "M points: build " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+		<< " ms, cull " << std::chrono::duration<double, std::micro>(t2 - t1).count() / nr_frames << " us per frame with "
+		<< 100.0*nr_visible / (double(n)*nr_frames) << "% visible in " << ranges.size() << " ranges, update of "
+		<< n / 1000 << " chunks " << std::chrono::duration<double, std::milli>(t3 - t2).count() << " ms" << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_chunk_box_hierarchy_reg("cgv::math::test_chunk_box_hierarchy", test_chunk_box_hierarchy);
+
+extern CGV_API benchmark_registration test_chunk_box_hierarchy_performance_reg("cgv::math::test_chunk_box_hierarchy_performance", test_chunk_box_hierarchy_performance);
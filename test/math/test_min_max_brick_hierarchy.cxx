@@ -0,0 +1,124 @@
+#include <chrono>
+#include <iostream>
+#include <cgv/math/min_max_brick_hierarchy.h>
+#include <cgv/math/random.h>
+#include <cgv/base/register.h>
+
+using namespace cgv::base;
+using namespace cgv::data;
+using namespace cgv::math;
+
+/// fill a uint8 volume with a few random boxes on a zero background
+static void fill_sparse_volume(data_view& dv, unsigned nr_boxes, unsigned max_box_size)
+{
+	const data_format& df = *dv.get_format();
+	unsigned w = df.get_width(), h = df.get_height(), d = df.get_depth();
+	unsigned char* ptr = dv.get_ptr<unsigned char>();
+	std::fill(ptr, ptr + df.get_nr_bytes(), (unsigned char)0);
+	cgv::math::random rg(7);
+	for (unsigned b = 0; b < nr_boxes; ++b) {
+		unsigned x0, y0, z0, s, v;
+		rg.uniform(0, w - 1, x0);
+		rg.uniform(0, h - 1, y0);
+		rg.uniform(0, d - 1, z0);
+		rg.uniform(1, max_box_size, s);
+		rg.uniform(1, 255, v);
+		for (unsigned z = z0; z < std::min(d, z0 + s); ++z)
+			for (unsigned y = y0; y < std::min(h, y0 + s); ++y)
+				for (unsigned x = x0; x < std::min(w, x0 + s); ++x)
+					ptr[x + w*(y + size_t(h)*z)] = (unsigned char)v;
+	}
+}
+
+/// compare brick ranges and occupancy against brute force evaluation
+static bool check_brick_hierarchy(unsigned w, unsigned h, unsigned d, unsigned brick_size, unsigned nr_threads)
+{
+	data_format df(w, h, d, cgv::type::info::TI_UINT8, "L");
+	data_view dv(&df);
+	fill_sparse_volume(dv, 6, 6);
+	const unsigned char* ptr = dv.get_ptr<unsigned char>();
+	min_max_brick_hierarchy<float> bh;
+	TEST_ASSERT(bh.build(const_data_view(dv), brick_size, 0, nr_threads));
+	const min_max_brick_hierarchy<float>::level& l0 = bh.get_level(0);
+	// opacity table over [0,255] that is transparent below 100
+	std::vector<float> opacity(64, 0.0f);
+	for (unsigned i = 0; i < opacity.size(); ++i)
+		if (i*255.0f / 63 >= 100)
+			opacity[i] = 0.5f;
+	std::vector<unsigned char> occupancy;
+	bh.compute_occupancy(opacity, 0.0f, 255.0f, occupancy);
+	bool ok = true;
+	for (unsigned bz = 0; bz < l0.dims[2]; ++bz)
+		for (unsigned by = 0; by < l0.dims[1]; ++by)
+			for (unsigned bx = 0; bx < l0.dims[0]; ++bx) {
+				float v_min = 255, v_max = 0;
+				for (int z = int(bz*brick_size) - 1; z <= int((bz + 1)*brick_size); ++z)
+					for (int y = int(by*brick_size) - 1; y <= int((by + 1)*brick_size); ++y)
+						for (int x = int(bx*brick_size) - 1; x <= int((bx + 1)*brick_size); ++x) {
+							if (x < 0 || y < 0 || z < 0 || x >= int(w) || y >= int(h) || z >= int(d))
+								continue;
+							float v = ptr[x + w*(y + size_t(h)*z)];
+							v_min = std::min(v_min, v);
+							v_max = std::max(v_max, v);
+						}
+				size_t bi = l0.get_index(bx, by, bz);
+				if (l0.min_values[bi] != v_min || l0.max_values[bi] != v_max)
+					ok = false;
+				// the table entry at index ceil(v_max*63/255) is the first one that can be opaque
+				bool occupied = std::ceil(v_max*63.0f / 255) * 255.0f / 63 >= 100;
+				if ((occupancy[bi] != 0) != occupied)
+					ok = false;
+			}
+	const min_max_brick_hierarchy<float>::level& top = bh.get_level(bh.get_nr_levels() - 1);
+	TEST_ASSERT_EQ(top.get_nr_bricks(), size_t(1));
+	TEST_ASSERT_EQ(top.min_values[0], (float)*std::min_element(ptr, ptr + df.get_nr_bytes()));
+	TEST_ASSERT_EQ(top.max_values[0], (float)*std::max_element(ptr, ptr + df.get_nr_bytes()));
+	return ok;
+}
+
+/// measure build and classification throughput at resolution res^3
+static void benchmark_brick_hierarchy(unsigned res, unsigned nr_threads)
+{
+	data_format df(res, res, res, cgv::type::info::TI_UINT8, "L");
+	data_view dv(&df);
+	fill_sparse_volume(dv, 200, res / 8);
+	min_max_brick_hierarchy<float> bh;
+	std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
+	bh.build(const_data_view(dv), 16, 0, nr_threads);
+	double sec_build = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+	std::vector<float> opacity(256, 0.0f);
+	std::fill(opacity.begin() + 128, opacity.end(), 1.0f);
+	std::vector<unsigned char> occupancy;
+	const unsigned n = 100;
+	size_t nr_occupied = 0;
+	t0 = std::chrono::high_resolution_clock::now();
+	for (unsigned i = 0; i < n; ++i)
+		nr_occupied = bh.compute_occupancy(opacity, 0.0f, 255.0f, occupancy);
+	double sec_classify = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count() / n;
+	double mvox = (double)res*res*res*1e-6;
+	std::cout << "\n  bricks " << res << "^3 threads=" << nr_threads << ": build " << 1000 * sec_build << " ms ("
+		<< mvox / sec_build << " Mvox/s), classify " << occupancy.size() << " bricks " << 1000 * sec_classify
+		<< " ms with " << nr_occupied << " occupied";
+}
+
+bool test_min_max_brick_hierarchy()
+{
+	TEST_ASSERT(check_brick_hierarchy(37, 29, 23, 8, 1));
+	TEST_ASSERT(check_brick_hierarchy(37, 29, 23, 8, 3));
+	TEST_ASSERT(check_brick_hierarchy(16, 16, 16, 16, 0));
+	TEST_ASSERT(check_brick_hierarchy(5, 70, 9, 4, 2));
+	return true;
+}
+
+bool test_min_max_brick_hierarchy_performance()
+{
+	benchmark_brick_hierarchy(512, 1);
+	benchmark_brick_hierarchy(512, 0);
+	std::cout << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_min_max_brick_hierarchy_reg("cgv::math::min_max_brick_hierarchy", test_min_max_brick_hierarchy);
+extern CGV_API benchmark_registration test_min_max_brick_hierarchy_performance_reg("cgv::math::test_min_max_brick_hierarchy_performance", test_min_max_brick_hierarchy_performance);
@@ -0,0 +1,95 @@
+#include <chrono>
+#include <iostream>
+#include <cgv/math/parallel_distance_transform.h>
+#include <cgv/math/random.h>
+#include <cgv/base/register.h>
+
+using namespace cgv::base;
+using namespace cgv::data;
+using namespace cgv::math;
+
+/// compare parallel distance transform of a random binary volume against brute force
+static bool check_distance_transform(unsigned w, unsigned h, unsigned d, unsigned nr_features, unsigned nr_threads)
+{
+	data_format df;
+	if (d > 1)
+		df = data_format(w, h, d, cgv::type::info::TI_UINT8, "L");
+	else
+		df = data_format(w, h, cgv::type::info::TI_UINT8, "L");
+	data_view dv(&df);
+	unsigned char* ptr = dv.get_ptr<unsigned char>();
+	std::fill(ptr, ptr + df.get_nr_bytes(), (unsigned char)0);
+	cgv::math::random rg(5);
+	std::vector<unsigned> features;
+	for (unsigned i = 0; i < nr_features; ++i) {
+		unsigned idx;
+		rg.uniform(0, w*h*d - 1, idx);
+		ptr[idx] = 255;
+		features.push_back(idx);
+	}
+	std::vector<float> dist;
+	std::vector<unsigned> nearest;
+	TEST_ASSERT(sqrdist_transf(const_data_view(dv), dist, &nearest, 128.0, 0, nr_threads));
+	bool ok = true;
+	for (unsigned z = 0; z < d; ++z)
+		for (unsigned y = 0; y < h; ++y)
+			for (unsigned x = 0; x < w; ++x) {
+				unsigned best = std::numeric_limits<unsigned>::max();
+				for (unsigned f = 0; f < features.size(); ++f) {
+					int fx = features[f] % w, fy = (features[f] / w) % h, fz = features[f] / (w*h);
+					unsigned dd = (fx - x)*(fx - x) + (fy - y)*(fy - y) + (fz - z)*(fz - z);
+					best = std::min(best, dd);
+				}
+				unsigned i = x + w*(y + h*z);
+				int nx = nearest[i] % w, ny = (nearest[i] / w) % h, nz = nearest[i] / (w*h);
+				unsigned dn = (nx - x)*(nx - x) + (ny - y)*(ny - y) + (nz - z)*(nz - z);
+				if (dist[i] != (float)best || dn != best || ptr[nearest[i]] == 0)
+					ok = false;
+			}
+	return ok;
+}
+
+/// measure throughput at resolution res^3 with a few spherical features
+static void benchmark_distance_transform(unsigned res, unsigned nr_threads)
+{
+	data_format df(res, res, res, cgv::type::info::TI_FLT32, "L");
+	data_view dv(&df);
+	float* ptr = dv.get_ptr<float>();
+	std::fill(ptr, ptr + df.get_nr_entries(), 0.0f);
+	for (unsigned i = 0; i < 16; ++i)
+		ptr[(size_t)(i*7919 % res) + res*((size_t)(i*104729 % res) + res*(i*1299709 % res))] = 1.0f;
+	std::vector<float> dist;
+	std::vector<unsigned> nearest;
+	std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
+	sqrdist_transf(const_data_view(dv), dist, 0, 0.5, 0, nr_threads);
+	double sec_dist = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+	t0 = std::chrono::high_resolution_clock::now();
+	sqrdist_transf(const_data_view(dv), dist, &nearest, 0.5, 0, nr_threads);
+	double sec_nearest = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+	double mvox = (double)res*res*res*1e-6;
+	std::cout << "\n  edt " << res << "^3 threads=" << nr_threads << ": " << 1000 * sec_dist << " ms ("
+		<< mvox / sec_dist << " Mvox/s), with nearest index " << 1000 * sec_nearest << " ms ("
+		<< mvox / sec_nearest << " Mvox/s)";
+}
+
+bool test_parallel_distance_transform()
+{
+	TEST_ASSERT(check_distance_transform(37, 29, 1, 12, 1));
+	TEST_ASSERT(check_distance_transform(37, 29, 1, 12, 4));
+	TEST_ASSERT(check_distance_transform(23, 19, 17, 9, 3));
+	TEST_ASSERT(check_distance_transform(16, 16, 16, 1, 0));
+	return true;
+}
+
+bool test_parallel_distance_transform_performance()
+{
+	benchmark_distance_transform(512, 1);
+	benchmark_distance_transform(512, 0);
+	std::cout << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_parallel_distance_transform_reg("cgv::math::parallel_distance_transform", test_parallel_distance_transform);
+extern CGV_API benchmark_registration test_parallel_distance_transform_performance_reg("cgv::math::test_parallel_distance_transform_performance", test_parallel_distance_transform_performance);
@@ -0,0 +1,119 @@
+#include <cmath>
+#include <chrono>
+#include <iostream>
+#include <cgv/math/parallel_ransac.h>
+#include <cgv/base/register.h>
+
+using namespace cgv::base;
+using namespace cgv::math;
+
+/// synthetic cloud with n*inlier_ratio points on the plane z=0.5*x+0.2 with noise and uniform outliers in [-1,1]^3
+static std::vector<fvec<float,3> > create_plane_cloud(size_t n, float inlier_ratio, float noise)
+{
+	cgv::math::random rg(17);
+	std::vector<fvec<float,3> > P(n);
+	for (size_t i = 0; i < n; ++i) {
+		float x, y, z;
+		rg.uniform(-1.0f, 1.0f, x);
+		rg.uniform(-1.0f, 1.0f, y);
+		float u;
+		rg.uniform(u);
+		if (u < inlier_ratio) {
+			rg.uniform(-noise, noise, z);
+			z += 0.5f*x + 0.2f;
+		}
+		else
+			rg.uniform(-1.0f, 1.0f, z);
+		P[i].set(x, y, z);
+	}
+	return P;
+}
+
+/// synthetic cloud with points on the sphere with center (0.1,-0.2,0.3) and radius 0.6 and uniform outliers
+static std::vector<fvec<float,3> > create_sphere_cloud(size_t n, float inlier_ratio, float noise)
+{
+	cgv::math::random rg(23);
+	std::vector<fvec<float,3> > P(n);
+	fvec<float,3> c(0.1f, -0.2f, 0.3f);
+	for (size_t i = 0; i < n; ++i) {
+		float u;
+		rg.uniform(u);
+		fvec<float,3> p;
+		rg.uniform(-1.0f, 1.0f, p[0]);
+		rg.uniform(-1.0f, 1.0f, p[1]);
+		rg.uniform(-1.0f, 1.0f, p[2]);
+		if (u < inlier_ratio && sqr_length(p) > 0.01f) {
+			float r;
+			rg.uniform(-noise, noise, r);
+			p = c + (0.6f + r)*normalize(p);
+		}
+		P[i] = p;
+	}
+	return P;
+}
+
+template <class Model>
+static parallel_ransac_result<fvec<float,4> > benchmark_ransac(const char* name, const std::vector<fvec<float,3> >& P, parallel_ransac_config<float> cfg)
+{
+	parallel_ransac<Model> engine(&P[0], P.size(), cfg.seed);
+	std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
+	parallel_ransac_result<fvec<float,4> > R = engine.run(cfg);
+	double sec = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+	std::cout << "\n  " << name << " threads=" << cfg.nr_threads << " sprt=" << cfg.use_sprt << " lo=" << cfg.local_optimization
+		<< ": " << R.nr_hypotheses << " hypotheses in " << 1000*sec << " ms (" << R.nr_hypotheses / sec << " hyp/s, "
+		<< R.nr_rejected << " rejected, " << R.nr_evaluated_points / sec * 1e-6 << " Mpts/s) inliers=" << R.nr_inliers;
+	return R;
+}
+
+bool test_parallel_ransac()
+{
+	std::vector<fvec<float,3> > P = create_plane_cloud(200000, 0.3f, 0.005f);
+	fvec<float,3> n_ref = normalize(fvec<float,3>(0.5f, 0.0f, -1.0f));
+	parallel_ransac_config<float> cfg(0.01f);
+	cfg.nr_threads = 0;
+	cfg.use_sprt = true;
+	// time to solution with adaptive termination
+	cfg.confidence = 0.99f;
+	cfg.max_iterations = 100000;
+	cfg.local_optimization = true;
+	parallel_ransac_result<fvec<float,4> > R = benchmark_ransac<ransac_plane_model<float> >("plane adaptive", P, cfg);
+	TEST_ASSERT(R.valid);
+	fvec<float,3> n(R.model(0), R.model(1), R.model(2));
+	TEST_ASSERT(std::abs(dot(n, n_ref)) > 0.999f);
+	float s = dot(n, n_ref) < 0 ? -1.0f : 1.0f;
+	TEST_ASSERT(std::abs(s*R.model(3) - 0.2f / length(fvec<float,3>(0.5f, 0.0f, -1.0f))) < 0.01f);
+	TEST_ASSERT(R.nr_inliers > 50000);
+
+	std::vector<fvec<float,3> > S = create_sphere_cloud(200000, 0.4f, 0.005f);
+	cfg.nr_threads = 0;
+	R = benchmark_ransac<ransac_sphere_model<float> >("sphere adaptive", S, cfg);
+	TEST_ASSERT(R.valid);
+	TEST_ASSERT(length(fvec<float,3>(R.model(0), R.model(1), R.model(2)) - fvec<float,3>(0.1f, -0.2f, 0.3f)) < 0.01f);
+	TEST_ASSERT(std::abs(R.model(3) - 0.6f) < 0.01f);
+	std::cout << std::endl;
+	return true;
+}
+
+bool test_parallel_ransac_performance()
+{
+	std::vector<fvec<float,3> > P = create_plane_cloud(200000, 0.3f, 0.005f);
+	parallel_ransac_config<float> cfg(0.01f);
+	cfg.use_sprt = false;
+	cfg.local_optimization = false;
+	cfg.nr_threads = 1;
+	cfg.max_iterations = 200;
+	// fixed iteration count to compare the throughput of serial and parallel scoring, as confidence 1 disables adaptive termination
+	cfg.confidence = 1.0f;
+	benchmark_ransac<ransac_plane_model<float> >("plane fixed", P, cfg);
+	cfg.nr_threads = 0;
+	benchmark_ransac<ransac_plane_model<float> >("plane fixed", P, cfg);
+	cfg.use_sprt = true;
+	benchmark_ransac<ransac_plane_model<float> >("plane fixed", P, cfg);
+	std::cout << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_parallel_ransac_reg("cgv::math::parallel_ransac", test_parallel_ransac);
+extern CGV_API benchmark_registration test_parallel_ransac_performance_reg("cgv::math::test_parallel_ransac_performance", test_parallel_ransac_performance);
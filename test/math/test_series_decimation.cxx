@@ -0,0 +1,191 @@
+#include <chrono>
+#include <iostream>
+#include <cgv/math/series_decimation.h>
+#include <cgv/math/random.h>
+#include <cgv/base/register.h>
+
+using namespace cgv::base;
+using namespace cgv::math;
+
+typedef fvec<float, 2> vec2;
+
+/// generate a random walk over increasing x values
+static void generate_series(std::vector<vec2>& samples, size_t n, unsigned seed)
+{
+	cgv::math::random rg(seed);
+	samples.resize(n);
+	float y = 0;
+	for (size_t i = 0; i < n; ++i) {
+		float d;
+		rg.uniform(-1.0f, 1.0f, d);
+		y += d;
+		samples[i] = vec2(float(i), y);
+	}
+}
+
+/// compare pyramid query with scanning the values
+static bool check_find(const min_max_pyramid<float>& p, const std::vector<vec2>& samples, size_t begin, size_t end)
+{
+	size_t i_min, i_max;
+	if (!p.find(&samples[0][1], begin, end, i_min, i_max, 2))
+		return begin >= end;
+	if (i_min < begin || i_min >= end || i_max < begin || i_max >= end)
+		return false;
+	for (size_t i = begin; i < end; ++i)
+		if (samples[i][1] < samples[i_min][1] || samples[i][1] > samples[i_max][1])
+			return false;
+	return true;
+}
+
+/// compare all levels of two pyramids
+static bool equal_pyramids(const min_max_pyramid<float>& p1, const min_max_pyramid<float>& p2, const std::vector<vec2>& samples)
+{
+	if (p1.get_nr_levels() != p2.get_nr_levels() || p1.get_nr_values() != p2.get_nr_values())
+		return false;
+	for (unsigned li = 0; li < p1.get_nr_levels(); ++li) {
+		const min_max_pyramid<float>::level& l1 = p1.get_level(li), &l2 = p2.get_level(li);
+		if (l1.get_nr_entries() != l2.get_nr_entries())
+			return false;
+		for (size_t b = 0; b < l1.get_nr_entries(); ++b)
+			if (samples[l1.min_index[b]][1] != samples[l2.min_index[b]][1] || samples[l1.max_index[b]][1] != samples[l2.max_index[b]][1])
+				return false;
+	}
+	return true;
+}
+
+bool test_series_decimation()
+{
+	std::vector<vec2> samples;
+	generate_series(samples, 10007, 3);
+	min_max_pyramid<float> p(16);
+	p.build(&samples[0][1], samples.size(), 2);
+	TEST_ASSERT_EQ(p.get_level(0).get_nr_entries(), size_t((samples.size() + 15) / 16));
+	TEST_ASSERT_EQ(p.get_level(p.get_nr_levels() - 1).get_nr_entries(), size_t(1));
+	TEST_ASSERT(check_find(p, samples, 0, samples.size()));
+	cgv::math::random rg(7);
+	for (unsigned k = 0; k < 1000; ++k) {
+		unsigned a, b;
+		rg.uniform(0u, unsigned(samples.size()), a);
+		rg.uniform(0u, unsigned(samples.size()), b);
+		TEST_ASSERT(check_find(p, samples, std::min(a, b), std::max(a, b)));
+	}
+	TEST_ASSERT(check_find(p, samples, 17, 18));
+	TEST_ASSERT(check_find(p, samples, 5, 31));
+
+	// incremental append, update and dropping of blocks result in the same pyramid as a rebuild
+	min_max_pyramid<float> q(16), r(16);
+	std::vector<vec2> streamed;
+	for (size_t i = 0; i < samples.size(); i += 333) {
+		streamed.insert(streamed.end(), samples.begin() + i, samples.begin() + std::min(samples.size(), i + 333));
+		q.append(&streamed[0][1], streamed.size(), 2);
+	}
+	TEST_ASSERT(equal_pyramids(p, q, samples));
+	samples[5000][1] = 1000.0f;
+	samples[5001][1] = -1000.0f;
+	p.update(&samples[0][1], 5000, 2, 2);
+	TEST_ASSERT_EQ(p.get_max_index(), size_t(5000));
+	TEST_ASSERT_EQ(p.get_min_index(), size_t(5001));
+	r.build(&samples[0][1], samples.size(), 2);
+	TEST_ASSERT(equal_pyramids(p, r, samples));
+	samples.erase(samples.begin(), samples.begin() + 5 * 16);
+	p.drop_front_blocks(&samples[0][1], 5, 2);
+	r.build(&samples[0][1], samples.size(), 2);
+	TEST_ASSERT(equal_pyramids(p, r, samples));
+	TEST_ASSERT(check_find(p, samples, 100, 9000));
+
+	// min max decimation keeps the extremes of each column and the samples next to the view
+	std::vector<vec2> result;
+	float x_min = 1000.5f, x_max = 8000.5f;
+	unsigned nr_columns = 100;
+	size_t nr_visible = decimate_min_max(&samples[0], samples.size(), p, x_min, x_max, nr_columns, result);
+	TEST_ASSERT_EQ(nr_visible, size_t(7000));
+	TEST_ASSERT(result.size() <= 4 * nr_columns + 2);
+	TEST_ASSERT(result.front()[0] < x_min && result.back()[0] > x_max);
+	for (size_t i = 1; i < result.size(); ++i)
+		TEST_ASSERT(result[i - 1][0] < result[i][0]);
+	float column_width = (x_max - x_min) / nr_columns;
+	for (unsigned c = 0; c < nr_columns; ++c) {
+		float y_min = 1e30f, y_max = -1e30f, z_min = 1e30f, z_max = -1e30f;
+		float c0 = x_min + c*column_width, c1 = x_min + (c + 1)*column_width;
+		for (size_t i = 0; i < samples.size(); ++i)
+			if (samples[i][0] >= c0 && samples[i][0] < c1) {
+				y_min = std::min(y_min, samples[i][1]);
+				y_max = std::max(y_max, samples[i][1]);
+			}
+		for (size_t i = 0; i < result.size(); ++i)
+			if (result[i][0] >= c0 && result[i][0] < c1) {
+				z_min = std::min(z_min, result[i][1]);
+				z_max = std::max(z_max, result[i][1]);
+			}
+		TEST_ASSERT_EQ(y_min, z_min);
+		TEST_ASSERT_EQ(y_max, z_max);
+	}
+	// few visible samples are copied
+	decimate_min_max(&samples[0], samples.size(), p, 2000.0f, 2010.0f, nr_columns, result);
+	TEST_ASSERT_EQ(result.size(), size_t(13));
+
+	// lttb keeps first and last sample and a spike
+	std::vector<vec2> spike(1000), reduced;
+	for (unsigned i = 0; i < spike.size(); ++i)
+		spike[i] = vec2(float(i), i == 567 ? 100.0f : 0.0f);
+	decimate_lttb(&spike[0], spike.size(), 50, reduced);
+	TEST_ASSERT_EQ(reduced.size(), size_t(50));
+	TEST_ASSERT_EQ(reduced.front(), spike.front());
+	TEST_ASSERT_EQ(reduced.back(), spike.back());
+	bool found_spike = false;
+	for (size_t i = 0; i < reduced.size(); ++i) {
+		if (reduced[i][1] == 100.0f)
+			found_spike = true;
+		if (i > 0)
+			TEST_ASSERT(reduced[i - 1][0] < reduced[i][0]);
+	}
+	TEST_ASSERT(found_spike);
+	decimate_lttb(&spike[0], 10, 50, reduced);
+	TEST_ASSERT_EQ(reduced.size(), size_t(10));
+	return true;
+}
+
+bool test_series_decimation_performance()
+{
+	typedef std::chrono::high_resolution_clock clock;
+	const size_t n = 10000000;
+	const unsigned nr_columns = 1920, nr_frames = 200;
+	std::vector<vec2> samples, result, reduced;
+	generate_series(samples, n, 5);
+	min_max_pyramid<float> p;
+	clock::time_point t0 = clock::now();
+	p.build(&samples[0][1], n, 2);
+	clock::time_point t1 = clock::now();
+	// zoom into the center and pan through the series
+	size_t nr_out = 0;
+	for (unsigned f = 0; f < nr_frames; ++f) {
+		float width = f < nr_frames / 2 ? float(n) * std::pow(0.001f, float(f) / (nr_frames / 2)) : 0.01f*n;
+		float center = f < nr_frames / 2 ? 0.5f*n : 0.01f*n*(f - nr_frames / 2);
+		decimate_min_max(&samples[0], n, p, center - 0.5f*width, center + 0.5f*width, nr_columns, result);
+		nr_out += result.size();
+	}
+	clock::time_point t2 = clock::now();
+	for (unsigned f = 0; f < nr_frames; ++f) {
+		float width = f < nr_frames / 2 ? float(n) * std::pow(0.001f, float(f) / (nr_frames / 2)) : 0.01f*n;
+		float center = f < nr_frames / 2 ? 0.5f*n : 0.01f*n*(f - nr_frames / 2);
+		decimate_min_max(&samples[0], n, p, center - 0.5f*width, center + 0.5f*width, 4 * nr_columns, result);
+		decimate_lttb(&result[0], result.size(), nr_columns, reduced);
+	}
+	clock::time_point t3 = clock::now();
+	// streaming of blocks of 1000 samples
+	min_max_pyramid<float> q;
+	for (size_t i = 1000; i <= n; i += 1000)
+		q.append(&samples[0][1], i, 2);
+	clock::time_point t4 = clock::now();
+	std::cout << "\n  decimation of " << n / 1000000 << "M samples: build " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+		<< " ms, min max " << std::chrono::duration<double, std::micro>(t2 - t1).count() / nr_frames << " us per frame with "
+		<< nr_out / nr_frames << " samples, lttb " << std::chrono::duration<double, std::micro>(t3 - t2).count() / nr_frames
+		<< " us per frame, streamed append " << std::chrono::duration<double, std::milli>(t4 - t3).count() << " ms" << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_series_decimation_reg("cgv::math::test_series_decimation", test_series_decimation);
+
+extern CGV_API benchmark_registration test_series_decimation_performance_reg("cgv::math::test_series_decimation_performance", test_series_decimation_performance);
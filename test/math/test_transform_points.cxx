@@ -0,0 +1,261 @@
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cgv/math/transform_points.h>
+#include <cgv/math/inv.h>
+#include <cgv/math/random.h>
+#include <cgv/base/register.h>
+
+using namespace cgv::base;
+using namespace cgv::math;
+
+template <typename T, cgv::type::uint32_type N, cgv::type::uint32_type M>
+static void random_matrix(cgv::math::random& rg, fmat<T, N, M>& m)
+{
+	for (unsigned i = 0; i < N; ++i)
+		for (unsigned j = 0; j < M; ++j)
+			rg.uniform(T(-2), T(2), m(i, j));
+}
+
+template <typename T, cgv::type::uint32_type N>
+static void random_vector(cgv::math::random& rg, fvec<T, N>& v)
+{
+	for (unsigned i = 0; i < N; ++i)
+		rg.uniform(T(-10), T(10), v(i));
+}
+
+/// check that a and b differ by a few rounding errors relative to the given magnitude, which allows compilers to contract the reference computations to fused multiply adds
+template <typename T>
+static bool nearly_equal(T a, T b, T magnitude)
+{
+	return std::abs(a - b) <= 16 * std::numeric_limits<T>::epsilon()*(1 + magnitude);
+}
+
+template <typename T, cgv::type::uint32_type N>
+static bool nearly_equal(const fvec<T, N>& a, const fvec<T, N>& b, T magnitude)
+{
+	for (unsigned i = 0; i < N; ++i)
+		if (!nearly_equal(a(i), b(i), magnitude))
+			return false;
+	return true;
+}
+
+/// compare 4x4 products with scalar loops
+template <typename T>
+static bool check_products(unsigned nr_tests)
+{
+	cgv::math::random rg(13);
+	for (unsigned n = 0; n < nr_tests; ++n) {
+		fmat<T, 4, 4> A, B;
+		fvec<T, 4> v;
+		random_matrix(rg, A);
+		random_matrix(rg, B);
+		random_vector(rg, v);
+		fvec<T, 4> Av = A*v, vA = v*A;
+		fmat<T, 4, 4> AB = A*B;
+		for (unsigned i = 0; i < 4; ++i) {
+			T r = 0, s = 0;
+			for (unsigned k = 0; k < 4; ++k) {
+				r += A(i, k)*v(k);
+				s += A(k, i)*v(k);
+			}
+			if (!nearly_equal(Av(i), r, T(80)) || !nearly_equal(vA(i), s, T(80)))
+				return false;
+			for (unsigned j = 0; j < 4; ++j) {
+				T p = 0;
+				for (unsigned k = 0; k < 4; ++k)
+					p += A(i, k)*B(k, j);
+				if (!nearly_equal(AB(i, j), p, T(16)))
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+/// compare float inverse against the generic implementation evaluated in double precision
+static bool check_inverse(unsigned nr_tests)
+{
+	cgv::math::random rg(17);
+	for (unsigned n = 0; n < nr_tests; ++n) {
+		fmat<float, 4, 4> A;
+		fmat<double, 4, 4> Ad;
+		random_matrix(rg, A);
+		for (unsigned i = 0; i < 4; ++i)
+			A(i, i) += 5.0f;
+		for (unsigned i = 0; i < 16; ++i)
+			Ad[i] = A[i];
+		fmat<float, 4, 4> Ai = inv(A);
+		fmat<double, 4, 4> Adi = inv(Ad);
+		for (unsigned i = 0; i < 16; ++i)
+			if (std::abs(Ai[i] - Adi[i]) > 1e-5*(1 + std::abs(Adi[i])))
+				return false;
+	}
+	// exact for integer matrices with power of two determinant
+	fmat<float, 4, 4> S;
+	S.identity();
+	S(0, 3) = 3; S(1, 3) = -2; S(2, 3) = 5; S(0, 0) = 2; S(1, 2) = 1;
+	fmat<float, 4, 4> Si = inv(S), I = Si*S;
+	for (unsigned i = 0; i < 4; ++i)
+		for (unsigned j = 0; j < 4; ++j)
+			if (I(i, j) != (i == j ? 1.0f : 0.0f))
+				return false;
+	return true;
+}
+
+/// compare batched transformations against transforming points one by one for all numbers of remaining points
+template <typename T>
+static bool check_transform_points()
+{
+	typedef fvec<T, 3> vec3;
+	typedef fvec<T, 4> vec4;
+	cgv::math::random rg(23);
+	fmat<T, 3, 3> L;
+	fmat<T, 4, 4> H;
+	vec3 t;
+	random_matrix(rg, L);
+	random_matrix(rg, H);
+	random_vector(rg, t);
+	fmat<T, 3, 4> A;
+	for (unsigned i = 0; i < 3; ++i) {
+		for (unsigned j = 0; j < 3; ++j)
+			A(i, j) = L(i, j);
+		A(i, 3) = t(i);
+	}
+	quaternion<T> q(T(0.5), T(0.5), T(-0.5), T(0.5));
+	for (unsigned n = 0; n < 23; ++n) {
+		std::vector<vec3> P(n), Q(n);
+		for (unsigned i = 0; i < n; ++i)
+			random_vector(rg, P[i]);
+		// linear and affine
+		transform_points(L, t, P.data(), Q.data(), n);
+		for (unsigned i = 0; i < n; ++i)
+			if (!nearly_equal(Q[i], L*P[i] + t, T(70)))
+				return false;
+		transform_points(A, P.data(), Q.data(), n);
+		for (unsigned i = 0; i < n; ++i)
+			if (!nearly_equal(Q[i], A*vec4(P[i], 1), T(70)))
+				return false;
+		transform_points(H, P.data(), Q.data(), n);
+		for (unsigned i = 0; i < n; ++i) {
+			vec4 h = H*vec4(P[i], 1);
+			if (!nearly_equal(Q[i], vec3(h(0), h(1), h(2)), T(70)))
+				return false;
+		}
+		transform_vectors(L, P.data(), Q.data(), n);
+		for (unsigned i = 0; i < n; ++i)
+			if (!nearly_equal(Q[i], L*P[i], T(60)))
+				return false;
+		// projective in place
+		Q = P;
+		transform_points_projective(H, Q.data(), Q.data(), n);
+		for (unsigned i = 0; i < n; ++i) {
+			vec4 h = H*vec4(P[i], 1);
+			if (!nearly_equal(Q[i], (1 / h(3))*vec3(h(0), h(1), h(2)), T(5000) / (h(3)*h(3))))
+				return false;
+		}
+		// rotation agrees with quaternion up to rounding
+		rotate_points(q, P.data(), Q.data(), n);
+		for (unsigned i = 0; i < n; ++i)
+			if (length(Q[i] - q.apply(P[i])) > 1e-5f*(1 + length(P[i])))
+				return false;
+	}
+	return true;
+}
+
+bool test_transform_points()
+{
+	TEST_ASSERT(check_products<float>(1000));
+	TEST_ASSERT(check_products<double>(1000));
+	TEST_ASSERT(check_inverse(1000));
+	TEST_ASSERT(check_transform_points<float>());
+	TEST_ASSERT(check_transform_points<double>());
+	// integer valued coordinates are transformed exactly
+	fmat<float, 3, 3> L;
+	L.identity();
+	L(0, 1) = 2; L(2, 0) = -1;
+	fvec<float, 3> P[5] = { fvec<float, 3>(1, 2, 3), fvec<float, 3>(-4, 5, 6), fvec<float, 3>(7, -8, 9), fvec<float, 3>(0, 0, 0), fvec<float, 3>(1, 1, 1) };
+	transform_points(L, fvec<float, 3>(1, 0, -1), P, P, 5);
+	TEST_ASSERT_EQ(P[0], (fvec<float, 3>(6, 2, 1)));
+	TEST_ASSERT_EQ(P[2], (fvec<float, 3>(-8, -8, 1)));
+	TEST_ASSERT_EQ(P[4], (fvec<float, 3>(4, 1, -1)));
+	return true;
+}
+
+/// time transformation of n points with per point matrix vector products and with the batched version
+template <typename T>
+static void benchmark_transform_points(size_t n, const char* type_name)
+{
+	typedef fvec<T, 3> vec3;
+	cgv::math::random rg(3);
+	fmat<T, 3, 3> L;
+	vec3 t;
+	random_matrix(rg, L);
+	random_vector(rg, t);
+	std::vector<vec3> P(n), Q(n);
+	for (size_t i = 0; i < n; ++i)
+		random_vector(rg, P[i]);
+	const unsigned nr_repetitions = 20;
+	std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
+	for (unsigned r = 0; r < nr_repetitions; ++r)
+		for (size_t i = 0; i < n; ++i)
+			Q[i] = L*P[i] + t;
+	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+	for (unsigned r = 0; r < nr_repetitions; ++r)
+		transform_points(L, t, P.data(), Q.data(), n);
+	std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+	double mpts = 1e-6*n*nr_repetitions;
+	std::cout << "\n  transform " << n << " " << type_name << " points: per point " << mpts / std::chrono::duration<double>(t1 - t0).count()
+		<< " Mpts/s, batched " << mpts / std::chrono::duration<double>(t2 - t1).count() << " Mpts/s";
+}
+
+/// time 4x4 products and inverse on arrays of random matrices and vectors
+template <typename T>
+static void benchmark_matrix_operations(const char* type_name)
+{
+	cgv::math::random rg(5);
+	const unsigned n = 1024, nr_repetitions = 1000;
+	std::vector<fmat<T, 4, 4> > A(n), B(n);
+	std::vector<fvec<T, 4> > v(n), w(n);
+	for (unsigned i = 0; i < n; ++i) {
+		random_matrix(rg, A[i]);
+		for (unsigned j = 0; j < 4; ++j)
+			A[i](j, j) += 5;
+		random_vector(rg, v[i]);
+	}
+	std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
+	for (unsigned r = 0; r < nr_repetitions; ++r)
+		for (unsigned i = 0; i < n; ++i)
+			B[i] = A[i] * A[(i + r) & (n - 1)];
+	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+	for (unsigned r = 0; r < nr_repetitions; ++r)
+		for (unsigned i = 0; i < n; ++i)
+			w[i] = A[(i + r) & (n - 1)] * v[i];
+	std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+	for (unsigned r = 0; r < nr_repetitions; ++r)
+		for (unsigned i = 0; i < n; ++i)
+			B[i] = inv(A[i]);
+	std::chrono::high_resolution_clock::time_point t3 = std::chrono::high_resolution_clock::now();
+	double nr_ops = double(n)*nr_repetitions;
+	std::cout << "\n  " << type_name << " 4x4: mat*mat " << std::chrono::duration<double, std::nano>(t1 - t0).count() / nr_ops
+		<< " ns, mat*vec " << std::chrono::duration<double, std::nano>(t2 - t1).count() / nr_ops
+		<< " ns, inv " << std::chrono::duration<double, std::nano>(t3 - t2).count() / nr_ops << " ns (" << B[0](0, 0) + w[0](0) << ")";
+}
+
+bool test_transform_points_performance()
+{
+	benchmark_transform_points<float>(1000000, "float");
+	benchmark_transform_points<double>(1000000, "double");
+	benchmark_matrix_operations<float>("float");
+	benchmark_matrix_operations<double>("double");
+	std::cout << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_transform_points_reg("cgv::math::test_transform_points", test_transform_points);
+
+extern CGV_API benchmark_registration test_transform_points_performance_reg("cgv::math::test_transform_points_performance", test_transform_points_performance);
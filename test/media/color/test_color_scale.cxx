@@ -0,0 +1,140 @@
+#include <cgv/media/color_scale.h>
+#include <cgv/base/register.h>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <random>
+
+using namespace cgv::base;
+using namespace cgv::media;
+
+typedef color_scale_lut::rgb_type rgb_type;
+typedef color_scale_lut::rgb8_type rgb8_type;
+typedef color_scale_lut::rgba8_type rgba8_type;
+
+static float color_distance(const rgb_type& c0, const rgb_type& c1)
+{
+	return std::max(std::abs(c0[0] - c1[0]), std::max(std::abs(c0[1] - c1[1]), std::abs(c0[2] - c1[2])));
+}
+
+/// value with additional attributes as in a point cloud
+struct scalar_point
+{
+	float position[3];
+	float value;
+};
+
+bool test_color_scale_lut()
+{
+	// tables agree with the scalar evaluation up to the quantization
+	ColorScale scales[] = { CS_TEMPERATURE, CS_HUE, CS_HUE_LUMINANCE };
+	for (unsigned s = 0; s < 3; ++s) {
+		color_scale_lut lut(scales[s]);
+		float max_error = 0;
+		for (unsigned i = 0; i <= 1000; ++i) {
+			double v = 0.001*i;
+			max_error = std::max(max_error, color_distance(lut.lookup(v), color_scale(v, scales[s])));
+		}
+		TEST_ASSERT(max_error < 2e-3f)
+	}
+	// strided float arrays and double arrays with clamping and NaN
+	color_scale_lut lut;
+	lut.set_value_range(-2.0f, 2.0f);
+	std::vector<scalar_point> points(1001);
+	std::vector<double> doubles(points.size());
+	for (size_t i = 0; i < points.size(); ++i)
+		doubles[i] = points[i].value = float(i) / 200 - 2.5f;
+	points[7].value = std::numeric_limits<float>::quiet_NaN();
+	doubles[7] = std::numeric_limits<double>::quiet_NaN();
+	std::vector<rgb_type> colors(points.size()), double_colors(points.size());
+	std::vector<rgb8_type> colors8(points.size());
+	std::vector<rgba8_type> colors_rgba8(points.size());
+	lut.map(&points[0].value, points.size(), &colors[0], sizeof(scalar_point));
+	lut.map(&points[0].value, points.size(), &colors8[0], sizeof(scalar_point));
+	lut.set_alpha(128);
+	lut.map(&points[0].value, points.size(), &colors_rgba8[0], sizeof(scalar_point));
+	lut.map(&doubles[0], doubles.size(), &double_colors[0]);
+	bool ok = true;
+	for (size_t i = 0; i < points.size(); ++i) {
+		if (i != 7 && color_distance(colors[i], lut.lookup(points[i].value)) != 0)
+			ok = false;
+		if (color_distance(colors[i], double_colors[i]) != 0)
+			ok = false;
+		for (unsigned c = 0; c < 3; ++c)
+			if (colors8[i][c] != colors_rgba8[i][c] || std::abs(colors8[i][c] - 255 * colors[i][c]) > 0.5f)
+				ok = false;
+		if (colors_rgba8[i].alpha() != 128)
+			ok = false;
+	}
+	TEST_ASSERT(ok)
+	TEST_ASSERT_EQ(color_distance(colors[7], color_scale(0.0)), 0.0f)
+	TEST_ASSERT_EQ(color_distance(colors[0], color_scale(0.0)), 0.0f)
+	TEST_ASSERT_EQ(color_distance(colors[1000], color_scale(1.0)), 0.0f)
+	// log and gamma mapping
+	lut.set_value_range(1.0f, 1000.0f, CSM_LOG);
+	TEST_ASSERT(color_distance(lut.lookup(std::sqrt(1000.0)), color_scale(0.5)) < 2e-3f)
+	lut.set_value_range(0.0f, 1.0f, CSM_GAMMA, 2.0f);
+	TEST_ASSERT(color_distance(lut.lookup(0.5), color_scale(0.25)) < 2e-3f)
+	// user defined gradients
+	std::vector<float> positions;
+	std::vector<rgb_type> gradient_colors;
+	positions.push_back(0.0f); gradient_colors.push_back(rgb_type(0, 0, 1));
+	positions.push_back(0.5f); gradient_colors.push_back(rgb_type(1, 1, 1));
+	positions.push_back(1.0f); gradient_colors.push_back(rgb_type(1, 0, 0));
+	color_scale_lut gradient;
+	gradient.set_gradient(positions, gradient_colors);
+	TEST_ASSERT(color_distance(gradient.lookup(0.25), rgb_type(0.5f, 0.5f, 1)) < 1e-3f)
+	TEST_ASSERT(color_distance(gradient.lookup(0.75), rgb_type(1, 0.5f, 0.5f)) < 1e-3f)
+	// threads produce the same result as a single thread
+	std::vector<float> values(300000);
+	std::mt19937 rand_gen;
+	std::uniform_real_distribution<float> uni_dist(-0.1f, 1.1f);
+	for (size_t i = 0; i < values.size(); ++i)
+		values[i] = uni_dist(rand_gen);
+	std::vector<rgba8_type> single(values.size()), multi(values.size());
+	gradient.map(&values[0], values.size(), &single[0], 0, 1);
+	gradient.map(&values[0], values.size(), &multi[0], 0, 4);
+	TEST_ASSERT(std::equal(single.begin(), single.end(), multi.begin(), [](const rgba8_type& c0, const rgba8_type& c1) {
+		return c0[0] == c1[0] && c0[1] == c1[1] && c0[2] == c1[2] && c0.alpha() == c1.alpha(); }))
+	return true;
+}
+
+bool test_color_scale_lut_performance()
+{
+	const size_t n = 4000000;
+	std::vector<float> values(n);
+	std::mt19937 rand_gen;
+	std::uniform_real_distribution<float> uni_dist(0.0f, 1.0f);
+	for (size_t i = 0; i < n; ++i)
+		values[i] = uni_dist(rand_gen);
+	std::vector<rgb_type> colors(n);
+	std::vector<rgba8_type> colors_rgba8(n);
+	typedef std::chrono::high_resolution_clock clock;
+	ColorScale scales[] = { CS_TEMPERATURE, CS_HUE };
+	const char* names[] = { "temperature", "hue" };
+	for (unsigned s = 0; s < 2; ++s) {
+		color_scale_lut lut(scales[s]);
+		clock::time_point t0 = clock::now();
+		for (size_t i = 0; i < n; ++i)
+			colors[i] = color_scale(values[i], scales[s]);
+		clock::time_point t1 = clock::now();
+		lut.map(&values[0], n, &colors[0], 0, 1);
+		clock::time_point t2 = clock::now();
+		lut.map(&values[0], n, &colors_rgba8[0], 0, 1);
+		clock::time_point t3 = clock::now();
+		lut.map(&values[0], n, &colors_rgba8[0]);
+		clock::time_point t4 = clock::now();
+		std::cout << "\n  " << names[s] << " " << n << " values: color_scale() " << n / std::chrono::duration<double>(t1 - t0).count() * 1e-6
+			<< " M/s, lut rgb " << n / std::chrono::duration<double>(t2 - t1).count() * 1e-6
+			<< " M/s, lut rgba8 " << n / std::chrono::duration<double>(t3 - t2).count() * 1e-6
+			<< " M/s, lut rgba8 all threads " << n / std::chrono::duration<double>(t4 - t3).count() * 1e-6 << " M/s";
+	}
+	std::cout << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_color_scale_lut_reg("cgv::media::test_color_scale_lut", test_color_scale_lut);
+
+extern CGV_API benchmark_registration test_color_scale_lut_performance_reg("cgv::media::test_color_scale_lut_performance", test_color_scale_lut_performance);
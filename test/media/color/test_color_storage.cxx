@@ -0,0 +1,145 @@
+#include <cgv/media/colored_model.h>
+#include <cgv/base/register.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+using namespace cgv::base;
+using namespace cgv::media;
+
+typedef color_storage_types::rgb rgb;
+typedef color_storage_types::rgba rgba;
+typedef color_storage_types::rgb8 rgb8;
+typedef color_storage_types::rgba8 rgba8;
+
+/// vertex with interleaved attributes as in a vertex buffer
+struct colored_vertex
+{
+	float position[3];
+	rgba color;
+	float tex_coord[2];
+};
+
+/// fill model with n random colors of the given type
+static void fill_random_colors(colored_model& M, ColorType ct, size_t n)
+{
+	M.destruct_colors();
+	M.ensure_colors(ct, n);
+	std::mt19937 rand_gen((unsigned)ct);
+	std::uniform_real_distribution<float> uni_dist(0.0f, 1.0f);
+	for (size_t i = 0; i < n; ++i)
+		M.set_color(i, rgba(uni_dist(rand_gen), uni_dist(rand_gen), uni_dist(rand_gen), uni_dist(rand_gen)));
+}
+
+/// compare bulk conversion to destination type C against per color conversion
+template <typename C>
+static bool check_put_colors(const colored_model& M, ColorType ct)
+{
+	size_t n = M.get_nr_colors();
+	std::vector<C> bulk(n), single(n);
+	M.put_colors(0, n, bulk.data(), ct);
+	for (size_t i = 0; i < n; ++i)
+		M.put_color(i, single[i]);
+	return std::memcmp(bulk.data(), single.data(), n*sizeof(C)) == 0;
+}
+
+/// compare bulk conversion from source type C against per color conversion
+template <typename C>
+static bool check_set_colors(ColorType storage_type, ColorType ct)
+{
+	colored_model M;
+	fill_random_colors(M, ct, 101);
+	std::vector<C> src(M.get_nr_colors());
+	M.put_colors(0, src.size(), src.data(), ct);
+	colored_model bulk, single;
+	bulk.ensure_colors(storage_type, src.size());
+	single.ensure_colors(storage_type, src.size());
+	// set all but the first color in bulk to check the offset
+	bulk.set_color(0, src[0]);
+	bulk.set_colors(1, src.size() - 1, &src[1], ct);
+	for (size_t i = 0; i < src.size(); ++i)
+		single.set_color(i, src[i]);
+	return std::memcmp(bulk.get_color_data_ptr(), single.get_color_data_ptr(), src.size()*bulk.get_color_size()) == 0;
+}
+
+bool test_color_storage()
+{
+	ColorType types[] = { CT_RGB8, CT_RGBA8, CT_RGB, CT_RGBA };
+	colored_model M;
+	for (unsigned si = 0; si < 4; ++si) {
+		fill_random_colors(M, types[si], 101);
+		TEST_ASSERT(check_put_colors<rgb8>(M, CT_RGB8));
+		TEST_ASSERT(check_put_colors<rgba8>(M, CT_RGBA8));
+		TEST_ASSERT(check_put_colors<rgb>(M, CT_RGB));
+		TEST_ASSERT(check_put_colors<rgba>(M, CT_RGBA));
+		TEST_ASSERT(check_set_colors<rgb8>(types[si], CT_RGB8));
+		TEST_ASSERT(check_set_colors<rgba8>(types[si], CT_RGBA8));
+		TEST_ASSERT(check_set_colors<rgb>(types[si], CT_RGB));
+		TEST_ASSERT(check_set_colors<rgba>(types[si], CT_RGBA));
+	}
+	// strided conversion into and out of interleaved vertices
+	fill_random_colors(M, CT_RGB8, 57);
+	std::vector<colored_vertex> vertices(M.get_nr_colors());
+	M.put_colors(0, vertices.size(), &vertices[0].color, CT_RGBA, sizeof(colored_vertex));
+	bool ok = true;
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		rgba c;
+		M.put_color(i, c);
+		if (!(c == vertices[i].color))
+			ok = false;
+	}
+	TEST_ASSERT(ok);
+	colored_model N;
+	N.ensure_colors(CT_RGB8, vertices.size());
+	N.set_colors(0, vertices.size(), &vertices[0].color, CT_RGBA, sizeof(colored_vertex));
+	TEST_ASSERT(std::memcmp(M.get_color_data_ptr(), N.get_color_data_ptr(), M.get_nr_colors()*sizeof(rgb8)) == 0);
+	// change of storage type converts all colors
+	N.ensure_colors(CT_RGBA);
+	TEST_ASSERT(check_put_colors<rgb8>(N, CT_RGB8));
+	const rgba* converted = static_cast<const rgba*>(N.get_color_data_ptr());
+	for (size_t i = 0; i < vertices.size(); ++i)
+		if (!(converted[i] == vertices[i].color))
+			ok = false;
+	TEST_ASSERT(ok);
+	return true;
+}
+
+bool test_color_storage_performance()
+{
+	typedef std::chrono::high_resolution_clock clock;
+	const size_t n = 10000000;
+	colored_model M;
+	M.ensure_colors(CT_RGBA8, n);
+	std::vector<rgb> colors(n);
+	for (size_t i = 0; i < n; ++i)
+		colors[i] = rgb(float(i % 256) / 255, float(i % 7) / 7, float(i % 13) / 13);
+	// initialize destinations such that page faults are not measured
+	std::vector<rgba> vertex_colors(n, rgba(0, 0, 0, 0));
+	std::vector<rgba8> copy(n, rgba8(0, 0, 0, 0));
+	clock::time_point t0 = clock::now();
+	for (size_t i = 0; i < n; ++i)
+		M.set_color(i, colors[i]);
+	clock::time_point t1 = clock::now();
+	M.set_colors(0, n, colors.data(), CT_RGB);
+	clock::time_point t2 = clock::now();
+	for (size_t i = 0; i < n; ++i)
+		M.put_color(i, vertex_colors[i]);
+	clock::time_point t3 = clock::now();
+	M.put_colors(0, n, vertex_colors.data(), CT_RGBA);
+	clock::time_point t4 = clock::now();
+	M.put_colors(0, n, copy.data(), CT_RGBA8);
+	clock::time_point t5 = clock::now();
+	std::cout << "\n  recolor " << n << " vertices: set_color rgb->rgba8 " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+		<< " ms, set_colors " << std::chrono::duration<double, std::milli>(t2 - t1).count()
+		<< " ms; put_color rgba8->rgba " << std::chrono::duration<double, std::milli>(t3 - t2).count()
+		<< " ms, put_colors " << std::chrono::duration<double, std::milli>(t4 - t3).count()
+		<< " ms; put_colors rgba8->rgba8 " << std::chrono::duration<double, std::milli>(t5 - t4).count() << " ms" << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_color_storage_reg("cgv::media::test_color_storage", test_color_storage);
+
+extern CGV_API benchmark_registration test_color_storage_performance_reg("cgv::media::test_color_storage_performance", test_color_storage_performance);
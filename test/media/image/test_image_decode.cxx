@@ -0,0 +1,342 @@
+#include <cgv/media/image/image_reader.h>
+#include <cgv/media/image/image_writer.h>
+#include <cgv/media/image/image_decode_queue.h>
+#include <cgv/base/register.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <setjmp.h>
+#include <jpeglib.h>
+#include <tiffio.h>
+
+using namespace cgv::base;
+using namespace cgv::data;
+using namespace cgv::media::image;
+using namespace cgv::type::info;
+
+/// fill image with smooth gradients and some texture, such that jpeg compresses it reasonably
+static void generate_image(std::vector<unsigned char>& pixels, unsigned w, unsigned h, unsigned nr_components, unsigned bytes_per_component, unsigned seed)
+{
+	pixels.resize(size_t(w)*h*nr_components*bytes_per_component);
+	size_t i = 0;
+	for (unsigned y = 0; y < h; ++y)
+		for (unsigned x = 0; x < w; ++x)
+			for (unsigned c = 0; c < nr_components; ++c) {
+				unsigned t = (x * (c + 1) + y * (3 - c) + 37 * seed + ((x ^ y) & 7)) % 512;
+				unsigned v = t < 256 ? t : 511 - t;
+				for (unsigned b = 0; b < bytes_per_component; ++b)
+					pixels[i++] = (unsigned char)(b == 0 ? v : (v * 7 + x) & 255);
+			}
+}
+
+/// write an 8 bit jpeg file with the given restart interval in MCU rows, where 0 disables restart markers
+static bool write_jpeg(const std::string& file_name, const std::vector<unsigned char>& pixels, unsigned w, unsigned h, unsigned nr_components, unsigned restart_in_rows, unsigned restart_interval = 0)
+{
+	FILE* fp = fopen(file_name.c_str(), "wb");
+	if (!fp)
+		return false;
+	jpeg_compress_struct cinfo;
+	jpeg_error_mgr jerr;
+	cinfo.err = jpeg_std_error(&jerr);
+	jpeg_create_compress(&cinfo);
+	jpeg_stdio_dest(&cinfo, fp);
+	cinfo.image_width = w;
+	cinfo.image_height = h;
+	cinfo.input_components = nr_components;
+	cinfo.in_color_space = nr_components == 1 ? JCS_GRAYSCALE : JCS_RGB;
+	jpeg_set_defaults(&cinfo);
+	jpeg_set_quality(&cinfo, 90, TRUE);
+	cinfo.restart_in_rows = restart_in_rows;
+	cinfo.restart_interval = restart_interval;
+	jpeg_start_compress(&cinfo, TRUE);
+	while (cinfo.next_scanline < cinfo.image_height) {
+		JSAMPROW row = const_cast<JSAMPROW>(&pixels[size_t(cinfo.next_scanline)*w*nr_components]);
+		jpeg_write_scanlines(&cinfo, &row, 1);
+	}
+	jpeg_finish_compress(&cinfo);
+	jpeg_destroy_compress(&cinfo);
+	return fclose(fp) == 0;
+}
+
+/// write a tiff file with tiles of the given size or strips if tile_size is 0
+static bool write_tiff(const std::string& file_name, const std::vector<unsigned char>& pixels, unsigned w, unsigned h, unsigned nr_components, unsigned bytes_per_component, unsigned tile_size, bool compress)
+{
+	TIFF* tp = TIFFOpen(file_name.c_str(), "w");
+	if (!tp)
+		return false;
+	TIFFSetField(tp, TIFFTAG_IMAGEWIDTH, w);
+	TIFFSetField(tp, TIFFTAG_IMAGELENGTH, h);
+	TIFFSetField(tp, TIFFTAG_SAMPLESPERPIXEL, nr_components);
+	TIFFSetField(tp, TIFFTAG_BITSPERSAMPLE, 8 * bytes_per_component);
+	TIFFSetField(tp, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+	TIFFSetField(tp, TIFFTAG_PHOTOMETRIC, nr_components < 3 ? PHOTOMETRIC_MINISBLACK : PHOTOMETRIC_RGB);
+	if (nr_components == 2 || nr_components == 4) {
+		uint16 extra = EXTRASAMPLE_UNASSALPHA;
+		TIFFSetField(tp, TIFFTAG_EXTRASAMPLES, 1, &extra);
+	}
+	TIFFSetField(tp, TIFFTAG_COMPRESSION, compress ? COMPRESSION_LZW : COMPRESSION_NONE);
+	size_t entry_size = nr_components*bytes_per_component;
+	bool success = true;
+	if (tile_size > 0) {
+		TIFFSetField(tp, TIFFTAG_TILEWIDTH, tile_size);
+		TIFFSetField(tp, TIFFTAG_TILELENGTH, tile_size);
+		std::vector<unsigned char> tile(tile_size*tile_size*entry_size);
+		for (unsigned ty = 0; ty < h; ty += tile_size)
+			for (unsigned tx = 0; tx < w; tx += tile_size) {
+				std::fill(tile.begin(), tile.end(), 0);
+				for (unsigned y = ty; y < std::min(ty + tile_size, h); ++y)
+					memcpy(&tile[(y - ty)*tile_size*entry_size], &pixels[(size_t(y)*w + tx)*entry_size], (std::min(tx + tile_size, w) - tx)*entry_size);
+				if (TIFFWriteTile(tp, &tile[0], tx, ty, 0, 0) < 0)
+					success = false;
+			}
+	}
+	else {
+		TIFFSetField(tp, TIFFTAG_ROWSPERSTRIP, 16);
+		for (unsigned y = 0; y < h; ++y)
+			if (TIFFWriteScanline(tp, const_cast<unsigned char*>(&pixels[y*w*entry_size]), y, 0) < 0)
+				success = false;
+	}
+	TIFFClose(tp);
+	return success;
+}
+
+/// write a png file
+static bool write_png(const std::string& file_name, const std::vector<unsigned char>& pixels, unsigned w, unsigned h, ComponentFormat cf)
+{
+	data_format df(w, h, TI_UINT8, cf);
+	image_writer writer(file_name);
+	return writer.write_image(const_data_view(&df, &pixels[0])) && writer.close();
+}
+
+/// read image with the given number of decoding threads
+static bool read_image(const std::string& file_name, data_view& dv, unsigned nr_threads)
+{
+	data_format df;
+	image_reader reader(df);
+	if (!reader.open(file_name))
+		return false;
+	reader.set("nr_threads", nr_threads);
+	data_format* image_format = new data_format(df);
+	new(&dv) data_view(image_format);
+	dv.manage_format();
+	bool success = reader.read_image(static_cast<const data_view&>(dv));
+	return reader.close() && success;
+}
+
+/// read region with the given number of decoding threads
+static bool read_region(const std::string& file_name, unsigned x, unsigned y, unsigned w, unsigned h, data_view& dv, unsigned nr_threads)
+{
+	data_format df;
+	image_reader reader(df);
+	if (!reader.open(file_name))
+		return false;
+	reader.set("nr_threads", nr_threads);
+	bool success = reader.read_region(x, y, w, h, dv);
+	return reader.close() && success;
+}
+
+/// compare the region of the image to the data view and return whether all bytes match
+static bool region_matches(const std::vector<unsigned char>& pixels, unsigned w, unsigned entry_size, unsigned x, unsigned y, const data_view& dv)
+{
+	const data_format& rf = *dv.get_format();
+	if (rf.get_entry_size() != entry_size)
+		return false;
+	for (unsigned r = 0; r < rf.get_height(); ++r)
+		if (memcmp(&pixels[(size_t(y + r)*w + x)*entry_size], dv.get_ptr<unsigned char>() + r*dv.get_step_size(0), rf.get_width()*entry_size) != 0)
+			return false;
+	return true;
+}
+
+/// copy the bytes of a data view into a vector
+static std::vector<unsigned char> get_bytes(const data_view& dv)
+{
+	return std::vector<unsigned char>(dv.get_ptr<unsigned char>(), dv.get_ptr<unsigned char>() + dv.get_format()->get_nr_bytes());
+}
+
+bool test_image_decode()
+{
+	std::vector<unsigned char> pixels;
+	std::string tif_name = "test_image_decode.tif", jpg_name = "test_image_decode.jpg", png_name = "test_image_decode.png";
+
+	// tiled and stripped tiffs are read exactly for all thread counts, also regions crossing tile borders
+	unsigned tiff_configs[4][4] = { { 3, 1, 64, 1 }, { 4, 2, 32, 0 }, { 1, 1, 0, 1 }, { 2, 1, 16, 0 } };
+	for (unsigned i = 0; i < 4; ++i) {
+		unsigned nr_components = tiff_configs[i][0], bytes_per_component = tiff_configs[i][1], entry_size = nr_components*bytes_per_component;
+		unsigned w = 203, h = 141;
+		generate_image(pixels, w, h, nr_components, bytes_per_component, i);
+		TEST_ASSERT(write_tiff(tif_name, pixels, w, h, nr_components, bytes_per_component, tiff_configs[i][2], tiff_configs[i][3] != 0));
+		for (unsigned nr_threads = 1; nr_threads <= 4; nr_threads += 3) {
+			data_view dv;
+			TEST_ASSERT(read_image(tif_name, dv, nr_threads));
+			TEST_ASSERT(region_matches(pixels, w, entry_size, 0, 0, dv));
+			data_view region;
+			TEST_ASSERT(read_region(tif_name, 37, 61, 100, 70, region, nr_threads));
+			TEST_ASSERT(region.get_format()->get_width() == 100 && region.get_format()->get_height() == 70);
+			TEST_ASSERT(region_matches(pixels, w, entry_size, 37, 61, region));
+		}
+		// tiff regions can be read repeatedly from one opened file
+		data_format df;
+		image_reader reader(df);
+		TEST_ASSERT(reader.open(tif_name));
+		TEST_ASSERT(reader.supports_region_read());
+		data_view r1, r2;
+		TEST_ASSERT(reader.read_region(w - 1, h - 1, 1, 1, r1));
+		TEST_ASSERT(region_matches(pixels, w, entry_size, w - 1, h - 1, r1));
+		TEST_ASSERT(reader.read_region(0, 0, 20, 90, r2));
+		TEST_ASSERT(region_matches(pixels, w, entry_size, 0, 0, r2));
+		data_view outside;
+		TEST_ASSERT(!reader.read_region(200, 0, 4, 4, outside));
+		TEST_ASSERT(reader.close());
+	}
+
+	// jpegs with restart markers are decoded in parallel segments with the result of the sequential decoder
+	unsigned jpeg_configs[5][3] = { { 3, 1, 0 }, { 3, 2, 0 }, { 1, 1, 0 }, { 3, 0, 7 }, { 3, 0, 0 } };
+	for (unsigned i = 0; i < 5; ++i) {
+		unsigned nr_components = jpeg_configs[i][0];
+		unsigned w = 301, h = 227;
+		generate_image(pixels, w, h, nr_components, 1, i);
+		TEST_ASSERT(write_jpeg(jpg_name, pixels, w, h, nr_components, jpeg_configs[i][1], jpeg_configs[i][2]));
+		data_view sequential;
+		TEST_ASSERT(read_image(jpg_name, sequential, 1));
+		std::vector<unsigned char> reference = get_bytes(sequential);
+		for (unsigned nr_threads = 2; nr_threads <= 5; nr_threads += 3) {
+			data_view parallel;
+			TEST_ASSERT(read_image(jpg_name, parallel, nr_threads));
+			TEST_ASSERT(get_bytes(parallel) == reference);
+		}
+		unsigned regions[3][4] = { { 13, 100, 200, 60 }, { 0, 0, 301, 17 }, { 300, 226, 1, 1 } };
+		for (unsigned r = 0; r < 3; ++r) {
+			data_view region;
+			TEST_ASSERT(read_region(jpg_name, regions[r][0], regions[r][1], regions[r][2], regions[r][3], region, r + 1));
+			TEST_ASSERT(region_matches(reference, w, nr_components, regions[r][0], regions[r][1], region));
+		}
+	}
+
+	// png regions are streamed line by line
+	generate_image(pixels, 77, 55, 4, 1, 5);
+	TEST_ASSERT(write_png(png_name, pixels, 77, 55, CF_RGBA));
+	data_view png_region;
+	TEST_ASSERT(read_region(png_name, 10, 20, 30, 35, png_region, 1));
+	TEST_ASSERT(region_matches(pixels, 77, 4, 10, 20, png_region));
+
+	// the decode queue delivers the images of all files by ticket and reports failures
+	image_decode_queue queue(3);
+	std::vector<unsigned> tickets;
+	for (unsigned i = 0; i < 12; ++i) {
+		if (i % 3 == 2)
+			tickets.push_back(queue.enqueue_region(png_name, 10, 20, 30, 35));
+		else
+			tickets.push_back(queue.enqueue(i % 3 == 0 ? png_name : tif_name));
+	}
+	unsigned invalid_ticket = queue.enqueue("test_image_decode_missing.png");
+	data_view tif_reference;
+	TEST_ASSERT(read_image(tif_name, tif_reference, 1));
+	for (unsigned i = 0; i < 12; ++i) {
+		data_view dv;
+		TEST_ASSERT(queue.retrieve(tickets[i], dv));
+		bool matches;
+		if (i % 3 == 1)
+			matches = get_bytes(dv) == get_bytes(tif_reference);
+		else
+			matches = region_matches(pixels, 77, 4, i % 3 == 2 ? 10 : 0, i % 3 == 2 ? 20 : 0, dv);
+		TEST_ASSERT(matches);
+	}
+	data_view dv;
+	std::string error;
+	TEST_ASSERT(!queue.retrieve(invalid_ticket, dv, &error));
+	TEST_ASSERT(!error.empty());
+	TEST_ASSERT(!queue.retrieve(tickets[0], dv));
+	TEST_ASSERT_EQ(queue.get_nr_pending(), size_t(0));
+
+	std::remove(tif_name.c_str());
+	std::remove(jpg_name.c_str());
+	std::remove(png_name.c_str());
+	return true;
+}
+
+bool test_image_decode_performance()
+{
+	typedef std::chrono::high_resolution_clock clock;
+	const unsigned nr_files = 24, w = 1024, h = 768;
+	const char* extensions[3] = { "png", "jpg", "tif" };
+	std::vector<unsigned char> pixels;
+	unsigned hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+	std::cout << std::endl;
+
+	// batch loads of many files, sequentially and with the decode queue
+	for (unsigned e = 0; e < 3; ++e) {
+		std::vector<std::string> file_names;
+		for (unsigned i = 0; i < nr_files; ++i) {
+			file_names.push_back(std::string("test_image_decode_performance_") + std::to_string(i) + "." + extensions[e]);
+			generate_image(pixels, w, h, 3, 1, i);
+			bool written;
+			if (e == 0)
+				written = write_png(file_names.back(), pixels, w, h, CF_RGB);
+			else if (e == 1)
+				written = write_jpeg(file_names.back(), pixels, w, h, 3, 0);
+			else
+				written = write_tiff(file_names.back(), pixels, w, h, 3, 1, 256, true);
+			TEST_ASSERT(written);
+		}
+		double mb = double(nr_files)*w*h * 3 / (1024 * 1024);
+		clock::time_point t0 = clock::now();
+		for (unsigned i = 0; i < nr_files; ++i) {
+			data_view dv;
+			TEST_ASSERT(read_image(file_names[i], dv, 1));
+		}
+		double seconds = std::chrono::duration<double>(clock::now() - t0).count();
+		std::cout << "  " << nr_files << " " << extensions[e] << " files " << w << "x" << h << " sequential: "
+			<< nr_files / seconds << " files/s, " << mb / seconds << " MB/s" << std::endl;
+		for (unsigned nr_threads = 1; nr_threads <= 2 * hardware_threads; nr_threads *= 2) {
+			clock::time_point t0 = clock::now();
+			image_decode_queue queue(nr_threads);
+			std::vector<unsigned> tickets;
+			for (unsigned i = 0; i < nr_files; ++i)
+				tickets.push_back(queue.enqueue(file_names[i]));
+			for (unsigned i = 0; i < nr_files; ++i) {
+				data_view dv;
+				TEST_ASSERT(queue.retrieve(tickets[i], dv));
+			}
+			double seconds = std::chrono::duration<double>(clock::now() - t0).count();
+			std::cout << "    decode queue with " << nr_threads << " threads: " << nr_files / seconds << " files/s, " << mb / seconds << " MB/s" << std::endl;
+		}
+		for (unsigned i = 0; i < nr_files; ++i)
+			std::remove(file_names[i].c_str());
+	}
+
+	// single large files decoded in parallel tiles or restart segments, and regions thereof
+	const unsigned W = 3840, H = 2160;
+	generate_image(pixels, W, H, 3, 1, 0);
+	std::string large_names[2] = { "test_image_decode_performance.tif", "test_image_decode_performance.jpg" };
+	TEST_ASSERT(write_tiff(large_names[0], pixels, W, H, 3, 1, 256, true));
+	TEST_ASSERT(write_jpeg(large_names[1], pixels, W, H, 3, 1));
+	std::vector<unsigned> thread_counts(1, 1);
+	if (hardware_threads > 1)
+		thread_counts.push_back(hardware_threads);
+	for (unsigned f = 0; f < 2; ++f) {
+		for (unsigned t = 0; t < thread_counts.size(); ++t) {
+			unsigned nr_threads = thread_counts[t];
+			clock::time_point t0 = clock::now();
+			data_view dv;
+			TEST_ASSERT(read_image(large_names[f], dv, nr_threads));
+			clock::time_point t1 = clock::now();
+			data_view region;
+			TEST_ASSERT(read_region(large_names[f], 1700, 1000, 512, 512, region, nr_threads));
+			clock::time_point t2 = clock::now();
+			std::cout << "  " << large_names[f] << " " << W << "x" << H << " with " << nr_threads << " threads: image "
+				<< std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms, 512x512 region "
+				<< std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+		}
+		std::remove(large_names[f].c_str());
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_image_decode_reg("cgv::media::test_image_decode", test_image_decode);
+
+extern CGV_API benchmark_registration test_image_decode_performance_reg("cgv::media::test_image_decode_performance", test_image_decode_performance);
@@ -0,0 +1,234 @@
+#include <cgv/media/image/image_pyramid.h>
+#include <cgv/media/image/image_proc.h>
+#include <cgv/math/fvec.h>
+#include <cgv/base/register.h>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+using namespace cgv::base;
+using namespace cgv::data;
+using namespace cgv::media::image;
+using namespace cgv::type::info;
+
+/// fill view data with random bytes
+static void fill_random(const data_view& dv, unsigned seed)
+{
+	std::mt19937 rand_gen(seed);
+	unsigned char* ptr = dv.get_ptr<unsigned char>();
+	for (size_t i = 0; i < dv.get_format()->get_nr_bytes(); ++i)
+		ptr[i] = (unsigned char)(rand_gen() & 255);
+}
+
+/// return maximum absolute difference of the bytes of two views of same format
+static int max_byte_difference(const data_view& a, const data_view& b)
+{
+	int d = 0;
+	for (size_t i = 0; i < a.get_format()->get_nr_bytes(); ++i)
+		d = std::max(d, std::abs(int(a.get_ptr<unsigned char>()[i]) - int(b.get_ptr<unsigned char>()[i])));
+	return d;
+}
+
+bool test_image_pyramid()
+{
+	// box filter on even sizes is the rounded average of 2x2 blocks
+	data_format rgba8_format(64, 32, TI_UINT8, CF_RGBA);
+	data_view rgba8(&rgba8_format);
+	fill_random(rgba8, 1);
+	data_format half_format = get_downsampled_format(rgba8_format);
+	TEST_ASSERT_EQ(half_format.get_width(), 32u);
+	TEST_ASSERT_EQ(half_format.get_height(), 16u);
+	data_view half(&half_format);
+	TEST_ASSERT(downsample_image(rgba8, half, downsample_options(DF_BOX, false, 1)));
+	const unsigned char* s = rgba8.get_ptr<unsigned char>();
+	const unsigned char* h = half.get_ptr<unsigned char>();
+	int max_diff = 0;
+	for (unsigned y = 0; y < 16; ++y)
+		for (unsigned x = 0; x < 32; ++x)
+			for (unsigned c = 0; c < 4; ++c) {
+				float avg = (s[4 * (2 * y * 64 + 2 * x) + c] + s[4 * (2 * y * 64 + 2 * x + 1) + c] +
+					s[4 * ((2 * y + 1) * 64 + 2 * x) + c] + s[4 * ((2 * y + 1) * 64 + 2 * x + 1) + c]) / 4.0f;
+				max_diff = std::max(max_diff, std::abs(int(avg + 0.5f) - int(h[4 * (y * 32 + x) + c])));
+			}
+	TEST_ASSERT_EQ(max_diff, 0);
+
+	// gamma correct averaging of black and white
+	data_format gray_format(4, 2, TI_UINT8, CF_RGB);
+	data_view gray(&gray_format);
+	for (unsigned i = 0; i < 8; ++i)
+		std::memset(gray.get_ptr<unsigned char>() + 3 * i, (i & 1) ? 255 : 0, 3);
+	data_format gray_half_format(2, 1, TI_UINT8, CF_RGB);
+	data_view gray_half(&gray_half_format);
+	TEST_ASSERT(downsample_image(gray, gray_half));
+	TEST_ASSERT_EQ(int(gray_half.get_ptr<unsigned char>()[0]), 128);
+	TEST_ASSERT(downsample_image(gray, gray_half, downsample_options(DF_BOX, true)));
+	TEST_ASSERT_EQ(int(gray_half.get_ptr<unsigned char>()[0]), 188);
+
+	// all filters reproduce linear ramps and keep constant volumes of odd resolution
+	DownsampleFilter filters[3] = { DF_BOX, DF_KAISER, DF_LANCZOS };
+	data_format ramp_format(38, 24, TI_FLT32, "L");
+	data_view ramp(&ramp_format);
+	float* r = ramp.get_ptr<float>();
+	for (unsigned y = 0; y < 24; ++y)
+		for (unsigned x = 0; x < 38; ++x)
+			r[y * 38 + x] = 0.5f + 0.01f*x - 0.02f*y;
+	data_format ramp_half_format = get_downsampled_format(ramp_format);
+	data_view ramp_half(&ramp_half_format);
+	for (unsigned f = 0; f < 3; ++f) {
+		TEST_ASSERT(downsample_image(ramp, ramp_half, downsample_options(filters[f])));
+		const float* rh = ramp_half.get_ptr<float>();
+		// the filter footprint of interior entries does not reach the border
+		for (unsigned y = 4; y < 8; ++y)
+			for (unsigned x = 4; x < 15; ++x) {
+				float sx = 2.0f*x + 0.5f, sy = 2.0f*y + 0.5f;
+				TEST_ASSERT(std::abs(rh[y * 19 + x] - (0.5f + 0.01f*sx - 0.02f*sy)) < 1e-5f);
+			}
+		data_format constant_format(29, 17, 11, TI_UINT16, "L");
+		data_view constant(&constant_format);
+		for (size_t i = 0; i < constant_format.get_nr_entries(); ++i)
+			constant.get_ptr<unsigned short>()[i] = 1234;
+		data_format constant_half_format = get_downsampled_format(constant_format);
+		TEST_ASSERT_EQ(constant_half_format.get_depth(), 6u);
+		data_view constant_half(&constant_half_format);
+		TEST_ASSERT(downsample_image(constant, constant_half, downsample_options(filters[f])));
+		for (size_t i = 0; i < constant_half_format.get_nr_entries(); ++i)
+			TEST_ASSERT_EQ(constant_half.get_ptr<unsigned short>()[i], 1234);
+	}
+
+	// box filter of volumes averages 2x2x2 blocks
+	data_format volume_format(8, 6, 4, TI_UINT8, "L");
+	data_view volume(&volume_format);
+	fill_random(volume, 2);
+	data_format volume_half_format = get_downsampled_format(volume_format);
+	data_view volume_half(&volume_half_format);
+	TEST_ASSERT(downsample_image(volume, volume_half));
+	const unsigned char* v = volume.get_ptr<unsigned char>();
+	max_diff = 0;
+	for (unsigned z = 0; z < 2; ++z)
+		for (unsigned y = 0; y < 3; ++y)
+			for (unsigned x = 0; x < 4; ++x) {
+				float sum = 0;
+				for (unsigned k = 0; k < 8; ++k)
+					sum += v[((2 * z + (k >> 2)) * 6 + 2 * y + ((k >> 1) & 1)) * 8 + 2 * x + (k & 1)];
+				max_diff = std::max(max_diff, std::abs(int(sum / 8 + 0.5f) - int(volume_half.get_ptr<unsigned char>()[(z * 3 + y) * 4 + x])));
+			}
+	TEST_ASSERT_EQ(max_diff, 0);
+
+	// results do not depend on the number of threads
+	data_format large_format(701, 413, TI_UINT8, CF_RGB);
+	data_view large(&large_format);
+	fill_random(large, 3);
+	data_format large_half_format = get_downsampled_format(large_format);
+	data_view large_half_1(&large_half_format), large_half_4(&large_half_format);
+	for (unsigned f = 0; f < 3; ++f) {
+		downsample_options options(filters[f], true, 1);
+		TEST_ASSERT(downsample_image(large, large_half_1, options));
+		options.nr_threads = 4;
+		TEST_ASSERT(downsample_image(large, large_half_4, options));
+		TEST_ASSERT_EQ(max_byte_difference(large_half_1, large_half_4), 0);
+	}
+
+	// pyramid down to a single entry
+	std::vector<data_view> levels;
+	TEST_ASSERT_EQ(build_image_pyramid(large, levels), 10u);
+	TEST_ASSERT_EQ(levels.size(), size_t(10));
+	TEST_ASSERT_EQ(levels[0].get_format()->get_width(), 351u);
+	TEST_ASSERT_EQ(levels.back().get_format()->get_width(), 1u);
+	TEST_ASSERT_EQ(levels.back().get_format()->get_height(), 1u);
+	TEST_ASSERT_EQ(build_image_pyramid(large, levels, downsample_options(), 3), 3u);
+	TEST_ASSERT_EQ(levels[2].get_format()->get_height(), 52u);
+
+	// mismatching dimensions are rejected
+	TEST_ASSERT(!downsample_image(volume, half));
+
+	// parallel integer wavelet transform is lossless without quantization of details and independent of the number of threads
+	typedef cgv::math::fvec<int, 3> int3;
+	const unsigned W = 256, H = 128;
+	std::vector<int3> image(W*H), transformed_1, transformed_4;
+	std::mt19937 rand_gen(4);
+	for (size_t i = 0; i < image.size(); ++i)
+		image[i] = int3(int(rand_gen() & 255), int(rand_gen() & 255), int(rand_gen() & 255));
+	transformed_1 = image;
+	integer_wavelet_transform<int3, int3>(&transformed_1[0], W, H, 1, W, 3, 0, true, 1, 1, 1);
+	integer_wavelet_transform<int3, int3>(&transformed_1[0], H, W, W, 1, 3, 0, true, 1, 1, 1);
+	transformed_4 = image;
+	integer_wavelet_transform<int3, int3>(&transformed_4[0], W, H, 1, W, 3, 0, true, 1, 1, 4);
+	integer_wavelet_transform<int3, int3>(&transformed_4[0], H, W, W, 1, 3, 0, true, 1, 1, 4);
+	TEST_ASSERT(transformed_1 == transformed_4);
+	integer_inverse_wavelet_transform<int3, int3>(&transformed_1[0], H, W, W, 1, 3, 0, true, 1, 1, 1);
+	integer_inverse_wavelet_transform<int3, int3>(&transformed_1[0], W, H, 1, W, 3, 0, true, 1, 1, 1);
+	TEST_ASSERT(transformed_1 == image);
+	integer_inverse_wavelet_transform<int3, int3>(&transformed_4[0], H, W, W, 1, 3, 0, true, 1, 1, 4);
+	integer_inverse_wavelet_transform<int3, int3>(&transformed_4[0], W, H, 1, W, 3, 0, true, 1, 1, 4);
+	TEST_ASSERT(transformed_4 == image);
+	return true;
+}
+
+bool test_image_pyramid_performance()
+{
+	typedef std::chrono::high_resolution_clock clock;
+	std::cout << std::endl;
+	// 4K images with and without sRGB decoding
+	data_format image_format(3840, 2160, TI_UINT8, CF_RGBA);
+	data_view image(&image_format);
+	fill_random(image, 5);
+	data_format half_format = get_downsampled_format(image_format);
+	data_view half(&half_format);
+	const char* filter_names[3] = { "box", "kaiser", "lanczos" };
+	for (unsigned f = 0; f < 3; ++f) {
+		for (unsigned srgb = 0; srgb < 2; ++srgb) {
+			downsample_options options(DownsampleFilter(f), srgb == 1);
+			const unsigned nr_repetitions = 5;
+			clock::time_point t0 = clock::now();
+			for (unsigned i = 0; i < nr_repetitions; ++i)
+				TEST_ASSERT(downsample_image(image, half, options));
+			double seconds = std::chrono::duration<double>(clock::now() - t0).count() / nr_repetitions;
+			std::cout << "  downsample 3840x2160 rgba8 " << filter_names[f] << (srgb ? " srgb" : "") << ": " << seconds*1000.0 << " ms, "
+				<< image_format.get_nr_bytes() / seconds * 1e-9 << " GB/s" << std::endl;
+		}
+	}
+	// complete pyramid
+	std::vector<data_view> levels;
+	clock::time_point t0 = clock::now();
+	build_image_pyramid(image, levels, downsample_options(DF_KAISER, true));
+	double seconds = std::chrono::duration<double>(clock::now() - t0).count();
+	std::cout << "  kaiser srgb pyramid of 3840x2160 rgba8 with " << levels.size() << " levels: " << seconds*1000.0 << " ms, "
+		<< image_format.get_nr_bytes() / seconds * 1e-9 << " GB/s" << std::endl;
+
+	// volumes
+	data_format volume_format(256, 256, 256, TI_UINT8, "L");
+	data_view volume(&volume_format);
+	fill_random(volume, 6);
+	data_format volume_half_format = get_downsampled_format(volume_format);
+	data_view volume_half(&volume_half_format);
+	for (unsigned f = 0; f < 3; f += 2) {
+		t0 = clock::now();
+		TEST_ASSERT(downsample_image(volume, volume_half, downsample_options(DownsampleFilter(f))));
+		seconds = std::chrono::duration<double>(clock::now() - t0).count();
+		std::cout << "  downsample 256^3 uint8 volume " << filter_names[f] << ": " << seconds*1000.0 << " ms, "
+			<< volume_format.get_nr_bytes() / seconds * 1e-9 << " GB/s" << std::endl;
+	}
+
+	// wavelet transform of a 4K rgb image in both directions
+	typedef cgv::math::fvec<int, 3> int3;
+	const unsigned W = 3840, H = 2160;
+	std::vector<int3> coefficients(size_t(W)*H, int3(1, 2, 3));
+	for (unsigned nr_threads = 1; nr_threads <= 2; ++nr_threads) {
+		unsigned n = nr_threads == 1 ? 1 : 0;
+		t0 = clock::now();
+		integer_wavelet_transform<int3, int3>(&coefficients[0], W, H, 1, W, 3, 0, true, 1, 2, n);
+		integer_wavelet_transform<int3, int3>(&coefficients[0], H, W, W, 1, 3, 0, true, 1, 2, n);
+		seconds = std::chrono::duration<double>(clock::now() - t0).count();
+		std::cout << "  integer wavelet transform of 3840x2160 int3 with " << (n == 1 ? "1 thread" : "all threads") << ": " << seconds*1000.0 << " ms, "
+			<< coefficients.size()*sizeof(int3) / seconds * 1e-9 << " GB/s" << std::endl;
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_image_pyramid_reg("cgv::media::test_image_pyramid", test_image_pyramid);
+
+extern CGV_API benchmark_registration test_image_pyramid_performance_reg("cgv::media::test_image_pyramid_performance", test_image_pyramid_performance);
@@ -0,0 +1,158 @@
+#include <cmv_io/mjpeg_avi_writer.h>
+#include <cmv_io/mjpeg_avi_reader.h>
+#include <cgv/base/register.h>
+#include <cgv/type/variant.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+using namespace cgv::base;
+using namespace cgv::data;
+using namespace cgv::type;
+
+/// fill image with a smooth triangle wave pattern that depends on the frame index
+static void generate_frame(std::vector<unsigned char>& pixels, unsigned w, unsigned h, unsigned bpp, unsigned f)
+{
+	pixels.resize(size_t(w)*h*bpp);
+	for (unsigned y = 0; y < h; ++y)
+		for (unsigned x = 0; x < w; ++x)
+			for (unsigned c = 0; c < bpp; ++c) {
+				unsigned t = (x * (c + 1) + y * (3 - c) + 40 * f) % 512;
+				pixels[(size_t(y)*w + x)*bpp + c] = (unsigned char)(t < 256 ? t : 511 - t);
+			}
+}
+
+/// write nr_frames frames and return whether successful
+static bool write_video(const std::string& file_name, const std::string& codec, unsigned w, unsigned h, ComponentFormat cf,
+	unsigned nr_frames, unsigned nr_threads, unsigned riff_size_limit)
+{
+	mjpeg_avi_writer writer;
+	unsigned bpp = cf == CF_L ? 1 : (cf == CF_RGB || cf == CF_BGR ? 3 : 4);
+	writer.set("nr_threads", nr_threads);
+	writer.set("riff_size_limit", riff_size_limit);
+	writer.set("quality", 95);
+	if (!writer.set_codec(codec))
+		return false;
+	data_format df(w, h, cgv::type::info::TI_UINT8, cf);
+	if (!writer.open(file_name, df, 25.0f, false))
+		return false;
+	std::vector<unsigned char> pixels;
+	for (unsigned f = 0; f < nr_frames; ++f) {
+		generate_frame(pixels, w, h, bpp, f);
+		if (!writer.write_frame(const_data_view(&df, &pixels[0])))
+			return false;
+	}
+	return writer.close();
+}
+
+/// read video and return maximum absolute difference to the generated rgb frames or -1 on failure
+static int compare_video(const std::string& file_name, unsigned w, unsigned h, ComponentFormat cf, unsigned nr_frames)
+{
+	mjpeg_avi_reader reader;
+	data_format df;
+	float fps;
+	if (!reader.open(file_name, df, fps) || df.get_width() != w || df.get_height() != h || std::abs(fps - 25.0f) > 0.01f)
+		return -1;
+	if (reader.get_nr_frames() != nr_frames)
+		return -1;
+	unsigned bpp = cf == CF_L ? 1 : (cf == CF_RGB || cf == CF_BGR ? 3 : 4);
+	bool swap = cf == CF_BGR || cf == CF_BGRA;
+	std::vector<unsigned char> pixels, decoded(size_t(w)*h * 3);
+	int max_diff = 0;
+	for (unsigned f = 0; f < nr_frames; ++f) {
+		if (!reader.read_frame(data_view(&df, &decoded[0])))
+			return -1;
+		generate_frame(pixels, w, h, bpp, f);
+		for (size_t i = 0; i < size_t(w)*h; ++i)
+			for (unsigned c = 0; c < 3; ++c) {
+				unsigned src_c = bpp == 1 ? 0 : (swap ? 2 - c : c);
+				max_diff = std::max(max_diff, std::abs(int(decoded[3 * i + c]) - int(pixels[bpp*i + src_c])));
+			}
+	}
+	if (reader.read_frame(data_view(&df, &decoded[0])))
+		return -1;
+	// random access
+	if (!reader.seek_frame(nr_frames / 2) || !reader.read_frame(data_view(&df, &decoded[0])))
+		return -1;
+	reader.close();
+	return max_diff;
+}
+
+bool test_avi_io()
+{
+	std::string file_name = "test_avi_io.avi";
+	// raw frames are stored losslessly, a small riff size limit forces OpenDML AVIX lists
+	TEST_ASSERT(write_video(file_name, "raw", 61, 37, CF_BGR, 40, 3, 20000));
+	TEST_ASSERT_EQ(compare_video(file_name, 61, 37, CF_BGR, 40), 0);
+	TEST_ASSERT(write_video(file_name, "raw", 32, 16, CF_RGBA, 5, 1, 1 << 30));
+	TEST_ASSERT_EQ(compare_video(file_name, 32, 16, CF_RGBA, 5), 0);
+	TEST_ASSERT(write_video(file_name, "raw", 20, 10, CF_L, 3, 2, 1 << 30));
+	TEST_ASSERT_EQ(compare_video(file_name, 20, 10, CF_L, 3), 0);
+
+	// jpeg frames are lossy, but must arrive in order also with many encoder threads
+	TEST_ASSERT(write_video(file_name, "MJPG", 160, 96, CF_RGB, 60, 8, 100000));
+	int diff = compare_video(file_name, 160, 96, CF_RGB, 60);
+	TEST_ASSERT(diff >= 0 && diff < 24);
+	TEST_ASSERT(write_video(file_name, "MJPG", 64, 48, CF_L, 10, 0, 1 << 30));
+	diff = compare_video(file_name, 64, 48, CF_L, 10);
+	TEST_ASSERT(diff >= 0 && diff < 24);
+
+	// unsupported formats are rejected
+	mjpeg_avi_writer writer;
+	TEST_ASSERT(!writer.set_codec("H264"));
+	TEST_ASSERT(!writer.open(file_name, data_format(16, 16, cgv::type::info::TI_FLT32, CF_RGB), 25.0f, false));
+	std::remove(file_name.c_str());
+	return true;
+}
+
+bool test_avi_io_performance()
+{
+	typedef std::chrono::high_resolution_clock clock;
+	std::string file_name = "test_avi_io_performance.avi";
+	unsigned sizes[2][2] = { { 1920, 1080 }, { 3840, 2160 } };
+	const char* codecs[2] = { "MJPG", "raw" };
+	const unsigned nr_frames = 60;
+	std::cout << std::endl;
+	for (unsigned s = 0; s < 2; ++s) {
+		unsigned w = sizes[s][0], h = sizes[s][1];
+		data_format df(w, h, cgv::type::info::TI_UINT8, CF_RGB);
+		std::vector<unsigned char> pixels;
+		generate_frame(pixels, w, h, 3, 0);
+		for (unsigned c = 0; c < 2; ++c) {
+			mjpeg_avi_writer writer;
+			writer.set_codec(codecs[c]);
+			TEST_ASSERT(writer.open(file_name, df, 60.0f, false));
+			double max_latency = 0;
+			clock::time_point t0 = clock::now();
+			for (unsigned f = 0; f < nr_frames; ++f) {
+				clock::time_point t = clock::now();
+				TEST_ASSERT(writer.write_frame(const_data_view(&df, &pixels[0])));
+				max_latency = std::max(max_latency, std::chrono::duration<double, std::milli>(clock::now() - t).count());
+			}
+			clock::time_point t1 = clock::now();
+			TEST_ASSERT(writer.close());
+			clock::time_point t2 = clock::now();
+			mjpeg_avi_reader reader;
+			data_format rdf;
+			float fps;
+			TEST_ASSERT(reader.open(file_name, rdf, fps));
+			std::vector<unsigned char> decoded(size_t(w)*h * 3);
+			while (reader.read_frame(data_view(&rdf, &decoded[0])))
+				;
+			clock::time_point t3 = clock::now();
+			reader.close();
+			std::cout << "  " << codecs[c] << " " << w << "x" << h << ": write_frame " << std::chrono::duration<double, std::milli>(t1 - t0).count() / nr_frames
+				<< " ms avg, " << max_latency << " ms max, sustained " << nr_frames / std::chrono::duration<double>(t2 - t0).count()
+				<< " fps, read " << nr_frames / std::chrono::duration<double>(t3 - t2).count() << " fps" << std::endl;
+		}
+	}
+	std::remove(file_name.c_str());
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_avi_io_reg("cgv::media::test_avi_io", test_avi_io);
+
+extern CGV_API benchmark_registration test_avi_io_performance_reg("cgv::media::test_avi_io_performance", test_avi_io_performance);
@@ -0,0 +1,259 @@
+#include <cgv/base/register.h>
+#include <cgv/os/task_scheduler.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace cgv::base;
+using namespace cgv::os;
+
+/// fibonacci numbers computed with nested task groups
+static unsigned parallel_fib(task_scheduler& s, unsigned n)
+{
+	if (n < 2)
+		return n;
+	unsigned a, b;
+	task_group g(s);
+	g.run([&s, &a, n]() { a = parallel_fib(s, n - 1); });
+	b = parallel_fib(s, n - 2);
+	g.wait();
+	return a + b;
+}
+
+/// block until the flag is set
+static void wait_for_flag(const std::atomic<bool>& flag)
+{
+	while (!flag.load())
+		std::this_thread::yield();
+}
+
+bool test_task_scheduler()
+{
+	task_scheduler s(4);
+	TEST_ASSERT_EQ(s.get_nr_threads(), 4u);
+	TEST_ASSERT(!s.is_worker_thread());
+
+	// every index is visited exactly once
+	std::vector<int> visits(100003, 0);
+	task_group g(s);
+	TEST_ASSERT(g.parallel_for(0, visits.size(), [&visits](size_t i) { ++visits[i]; }));
+	bool all_once = true;
+	for (size_t i = 0; i < visits.size(); ++i)
+		if (visits[i] != 1)
+			all_once = false;
+	TEST_ASSERT(all_once);
+	std::atomic<size_t> covered(0);
+	TEST_ASSERT(g.parallel_for_ranges(10, 1000, [&covered](size_t b, size_t e) { covered += e - b; }, 7));
+	TEST_ASSERT_EQ(covered.load(), size_t(990));
+	TEST_ASSERT(g.parallel_for(5, 5, [&visits](size_t i) { ++visits[i]; }));
+
+	// reductions combine the chunks in order
+	auto sum = [](size_t b, size_t e, unsigned long long x) { for (size_t i = b; i < e; ++i) x += i; return x; };
+	auto add = [](unsigned long long x, unsigned long long y) { return x + y; };
+	TEST_ASSERT_EQ(g.parallel_reduce(0, 1000000, 0ull, sum, add), 499999500000ull);
+	TEST_ASSERT_EQ(g.parallel_reduce(3, 3, 7ull, sum, add), 7ull);
+	auto fsum = [](size_t b, size_t e, double x) { for (size_t i = b; i < e; ++i) x += 1.0 / (i + 1); return x; };
+	auto fadd = [](double x, double y) { return x + y; };
+	double h1 = g.parallel_reduce(0, 100000, 0.0, fsum, fadd, 1000);
+	double h2 = g.parallel_reduce(0, 100000, 0.0, fsum, fadd, 1000);
+	TEST_ASSERT(h1 == h2);
+	TEST_ASSERT(std::abs(h1 - 12.0901461) < 1e-6);
+
+	// nested groups do not deadlock as waiting threads execute tasks
+	TEST_ASSERT_EQ(parallel_fib(s, 20), 6765u);
+
+	// tasks of higher priority are executed first
+	task_scheduler single(1);
+	std::atomic<bool> started(false), release(false);
+	task_group blocker(single);
+	blocker.run([&started, &release]() { started = true; wait_for_flag(release); });
+	wait_for_flag(started);
+	std::mutex order_mtx;
+	std::vector<int> order;
+	task_group idle_group(single, EP_IDLE), normal_group(single, EP_NORMAL), high_group(single, EP_HIGH);
+	idle_group.run([&]() { std::lock_guard<std::mutex> lock(order_mtx); order.push_back(EP_IDLE); });
+	normal_group.run([&]() { std::lock_guard<std::mutex> lock(order_mtx); order.push_back(EP_NORMAL); });
+	high_group.run([&]() { std::lock_guard<std::mutex> lock(order_mtx); order.push_back(EP_HIGH); });
+	release = true;
+	// let the worker process the queue alone, as a waiting thread would execute tasks itself
+	while (idle_group.get_nr_pending() + normal_group.get_nr_pending() + high_group.get_nr_pending() > 0)
+		std::this_thread::yield();
+	blocker.wait();
+	TEST_ASSERT_EQ(order.size(), size_t(3));
+	TEST_ASSERT_EQ(order[0], int(EP_HIGH));
+	TEST_ASSERT_EQ(order[1], int(EP_NORMAL));
+	TEST_ASSERT_EQ(order[2], int(EP_IDLE));
+
+	// cancelled groups skip tasks that have not been started
+	started = release = false;
+	blocker.run([&started, &release]() { started = true; wait_for_flag(release); });
+	wait_for_flag(started);
+	std::atomic<int> nr_runs(0);
+	task_group cancelled(single);
+	for (int i = 0; i < 100; ++i)
+		cancelled.run([&nr_runs]() { ++nr_runs; });
+	cancelled.cancel();
+	cancelled.run([&nr_runs]() { ++nr_runs; });
+	release = true;
+	TEST_ASSERT(!cancelled.wait());
+	TEST_ASSERT(cancelled.is_cancelled());
+	TEST_ASSERT_EQ(nr_runs.load(), 0);
+	TEST_ASSERT(blocker.wait());
+
+	// threads waiting for a group leave detached tasks to the workers
+	started = release = false;
+	blocker.run([&started, &release]() { started = true; wait_for_flag(release); });
+	wait_for_flag(started);
+	std::atomic<bool> detached_run(false);
+	single.spawn([&detached_run]() { detached_run = true; });
+	task_group helped(single);
+	helped.run([]() {});
+	TEST_ASSERT(helped.wait());
+	TEST_ASSERT(!detached_run.load());
+	release = true;
+	blocker.wait();
+	wait_for_flag(detached_run);
+
+	task_group stopped(s);
+	std::atomic<size_t> nr_visited(0);
+	TEST_ASSERT(!stopped.parallel_for(0, 1000000, [&](size_t i) { if (++nr_visited == 1000) stopped.cancel(); }, 100));
+	TEST_ASSERT(nr_visited.load() < 1000000);
+
+	// the first exception of a task is rethrown by wait
+	task_group throwing(s);
+	throwing.run([]() { throw std::runtime_error("task failed"); });
+	throwing.run([]() {});
+	bool caught = false;
+	try {
+		throwing.wait();
+	}
+	catch (const std::runtime_error& e) {
+		caught = std::string(e.what()) == "task failed";
+	}
+	TEST_ASSERT(caught);
+	TEST_ASSERT(throwing.wait());
+
+	// spawned tasks are executed before the scheduler is destructed
+	std::atomic<int> nr_spawned(0);
+	{
+		task_scheduler detached(2);
+		for (int i = 0; i < 1000; ++i)
+			detached.spawn([&nr_spawned]() { ++nr_spawned; }, ExecutionPriority(i % 3));
+	}
+	TEST_ASSERT_EQ(nr_spawned.load(), 1000);
+
+	// the number of threads can be changed outside of tasks only
+	TEST_ASSERT(s.set_nr_threads(2));
+	TEST_ASSERT_EQ(s.get_nr_threads(), 2u);
+	std::atomic<bool> from_task(true);
+	task_group config(s);
+	config.run([&]() { from_task = s.set_nr_threads(3); });
+	config.wait();
+	TEST_ASSERT(!from_task.load());
+	TEST_ASSERT_EQ(s.get_nr_threads(), 2u);
+	TEST_ASSERT(s.set_nr_threads(0));
+	TEST_ASSERT_EQ(s.get_nr_threads(), task_scheduler::get_default_nr_threads());
+	TEST_ASSERT_EQ(g.parallel_reduce(0, 1000, 0ull, sum, add), 499500ull);
+
+#ifdef __linux__
+	TEST_ASSERT(s.set_thread_affinity(true));
+	TEST_ASSERT(s.get_thread_affinity());
+	TEST_ASSERT_EQ(parallel_fib(s, 15), 610u);
+	TEST_ASSERT(s.set_thread_affinity(false));
+	TEST_ASSERT(!s.get_thread_affinity());
+#endif
+
+	// the process wide scheduler is constructed once and used by the free functions
+	TEST_ASSERT(&ref_task_scheduler() == &ref_task_scheduler());
+	TEST_ASSERT(ref_task_scheduler().get_nr_threads() >= 1);
+	std::atomic<size_t> nr_free(0);
+	TEST_ASSERT(parallel_for(0, 1000, [&nr_free](size_t) { ++nr_free; }));
+	TEST_ASSERT_EQ(nr_free.load(), size_t(1000));
+	TEST_ASSERT_EQ(parallel_reduce(0, 1000, 0ull, sum, add, 0, EP_HIGH), 499500ull);
+	return true;
+}
+
+/// compute intensive loop body
+static float kernel(size_t i)
+{
+	float x = float(i % 1024) * 0.001f;
+	for (int k = 0; k < 64; ++k)
+		x = std::sqrt(x * x + 0.5f) * 0.9f;
+	return x;
+}
+
+bool test_task_scheduler_performance()
+{
+	typedef std::chrono::steady_clock clock;
+	unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+	std::cout << "\n  " << hw << " hardware threads\n";
+
+	// scheduling overhead of empty tasks compared to std::async
+	const unsigned nr_tasks = 200000;
+	{
+		task_scheduler s;
+		task_group g(s);
+		std::atomic<unsigned> nr_runs(0);
+		clock::time_point t0 = clock::now();
+		for (unsigned i = 0; i < nr_tasks; ++i)
+			g.run([&nr_runs]() { ++nr_runs; });
+		g.wait();
+		double ns_group = std::chrono::duration<double, std::nano>(clock::now() - t0).count() / nr_tasks;
+		TEST_ASSERT_EQ(nr_runs.load(), nr_tasks);
+
+		nr_runs = 0;
+		t0 = clock::now();
+		g.parallel_for(0, nr_tasks, [&nr_runs](size_t) { ++nr_runs; }, 1);
+		double ns_fork = std::chrono::duration<double, std::nano>(clock::now() - t0).count() / nr_tasks;
+		TEST_ASSERT_EQ(nr_runs.load(), nr_tasks);
+
+		const unsigned nr_async = 2000;
+		nr_runs = 0;
+		t0 = clock::now();
+		std::vector<std::future<void> > futures;
+		for (unsigned i = 0; i < nr_async; ++i)
+			futures.push_back(std::async(std::launch::async, [&nr_runs]() { ++nr_runs; }));
+		for (unsigned i = 0; i < nr_async; ++i)
+			futures[i].wait();
+		double ns_async = std::chrono::duration<double, std::nano>(clock::now() - t0).count() / nr_async;
+		TEST_ASSERT_EQ(nr_runs.load(), nr_async);
+		std::cout << "  overhead per task: task_group::run " << ns_group << " ns, parallel_for split "
+			<< ns_fork << " ns, std::async " << ns_async << " ns\n";
+	}
+
+	// scaling of a compute bound parallel_for with the number of worker threads
+	const size_t n = 1 << 22;
+	std::vector<float> result(n);
+	double t_single = 0;
+	std::vector<unsigned> thread_counts;
+	for (unsigned t = 1; t < hw; t *= 2)
+		thread_counts.push_back(t);
+	thread_counts.push_back(hw);
+	for (size_t c = 0; c < thread_counts.size(); ++c) {
+		task_scheduler s(thread_counts[c]);
+		task_group g(s);
+		clock::time_point t0 = clock::now();
+		g.parallel_for(0, n, [&result](size_t i) { result[i] = kernel(i); });
+		double ms = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+		if (c == 0)
+			t_single = ms;
+		bool correct = true;
+		for (size_t i = 0; i < n; i += 4099)
+			if (result[i] != kernel(i))
+				correct = false;
+		TEST_ASSERT(correct);
+		std::cout << "  parallel_for with " << thread_counts[c] << " workers: " << ms << " ms, speedup " << t_single / ms << "\n";
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_task_scheduler_reg("cgv::os::test_task_scheduler", test_task_scheduler);
+
+extern CGV_API benchmark_registration test_task_scheduler_performance_reg("cgv::os::test_task_scheduler_performance", test_task_scheduler_performance);
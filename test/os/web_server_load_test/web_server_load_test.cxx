@@ -0,0 +1,316 @@
+#include <cgv/os/web_server.h>
+#include <co_web_epoll/web_server_epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace cgv::os;
+
+/// server answering small pages, a static file and a chunked stream that is continued after handle_request returned
+class load_test_server : public web_server
+{
+	std::mutex mtx;
+	std::vector<std::thread> pushers;
+public:
+	std::string file_name;
+	load_test_server(unsigned port) : web_server(port) {}
+	~load_test_server()
+	{
+		for (size_t i = 0; i < pushers.size(); ++i)
+			pushers[i].join();
+	}
+	void handle_request(http_request& r)
+	{
+		if (r.path == "/hello") {
+			r.content_type = "text/plain";
+			r.answer = "hello world";
+		}
+		else if (r.path == "/echo")
+			r.answer = r.params["id"];
+		else if (r.path == "/file")
+			r.file_name = file_name;
+		else if (r.path == "/throw")
+			throw std::runtime_error("handler failure");
+		else if (r.path == "/stream" && r.stream) {
+			r.streaming = true;
+			r.content_type = "text/plain";
+			for (int i = 0; i < 3; ++i)
+				r.stream->write("chunk " + std::to_string(i) + "\n");
+			http_stream_ptr s = r.stream;
+			std::lock_guard<std::mutex> lock(mtx);
+			pushers.push_back(std::thread([s]() {
+				for (int i = 3; i < 8; ++i) {
+					std::this_thread::sleep_for(std::chrono::milliseconds(2));
+					s->write("chunk " + std::to_string(i) + "\n");
+				}
+				s->close();
+			}));
+		}
+		else {
+			r.status = "404 Not Found";
+			r.answer = "not found";
+		}
+	}
+};
+
+/// blocking client connection with buffered response parsing
+struct client
+{
+	int fd;
+	std::string buffer;
+	client() : fd(-1) {}
+	~client()
+	{
+		if (fd != -1)
+			close(fd);
+	}
+	bool connect_to(unsigned port)
+	{
+		fd = socket(AF_INET, SOCK_STREAM, 0);
+		sockaddr_in addr;
+		std::memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(port);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (connect(fd, (sockaddr*)&addr, sizeof(addr)) == -1) {
+			close(fd);
+			fd = -1;
+			return false;
+		}
+		int one = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		return true;
+	}
+	bool send_all(const std::string& s)
+	{
+		for (size_t pos = 0; pos < s.size(); ) {
+			ssize_t n = send(fd, s.data() + pos, s.size() - pos, MSG_NOSIGNAL);
+			if (n <= 0)
+				return false;
+			pos += n;
+		}
+		return true;
+	}
+	bool fill()
+	{
+		char tmp[16384];
+		ssize_t n = recv(fd, tmp, sizeof(tmp), 0);
+		if (n <= 0)
+			return false;
+		buffer.append(tmp, n);
+		return true;
+	}
+	bool read_line(std::string& line)
+	{
+		size_t pos;
+		while ((pos = buffer.find("\r\n")) == std::string::npos)
+			if (!fill())
+				return false;
+		line = buffer.substr(0, pos);
+		buffer.erase(0, pos + 2);
+		return true;
+	}
+	bool read_bytes(size_t n, std::string& s)
+	{
+		while (buffer.size() < n)
+			if (!fill())
+				return false;
+		s.append(buffer, 0, n);
+		buffer.erase(0, n);
+		return true;
+	}
+	/// read one response and return its status line and dechunked body
+	bool read_response(std::string& status, std::string& body)
+	{
+		body.clear();
+		if (!read_line(status))
+			return false;
+		size_t content_length = 0;
+		bool chunked = false;
+		std::string line;
+		while (read_line(line) && !line.empty()) {
+			if (line.compare(0, 15, "Content-Length:") == 0)
+				content_length = std::strtoul(line.c_str() + 15, 0, 10);
+			else if (line == "Transfer-Encoding: chunked")
+				chunked = true;
+		}
+		if (!chunked)
+			return read_bytes(content_length, body);
+		for (;;) {
+			if (!read_line(line))
+				return false;
+			size_t size = std::strtoul(line.c_str(), 0, 16);
+			if (size == 0)
+				return read_line(line);
+			std::string crlf;
+			if (!read_bytes(size, body) || !read_bytes(2, crlf))
+				return false;
+		}
+	}
+};
+
+static int nr_errors = 0;
+
+static void check(bool condition, const char* what)
+{
+	if (!condition) {
+		std::cerr << "FAILED: " << what << std::endl;
+		++nr_errors;
+	}
+}
+
+static void test_protocol(unsigned port, const std::string& file_content)
+{
+	client c;
+	check(c.connect_to(port), "connect");
+	std::string status, body;
+
+	// pipelined requests are answered in order on one connection
+	std::string requests;
+	for (int i = 0; i < 20; ++i)
+		requests += "GET /echo?id=" + std::to_string(i) + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+	check(c.send_all(requests), "send pipelined requests");
+	for (int i = 0; i < 20; ++i) {
+		check(c.read_response(status, body), "read pipelined response");
+		check(body == std::to_string(i), "order of pipelined responses");
+	}
+	// static file through sendfile
+	check(c.send_all("GET /file HTTP/1.1\r\n\r\n"), "send file request");
+	check(c.read_response(status, body) && status == "HTTP/1.1 200 OK", "file response status");
+	check(body == file_content, "file content");
+
+	// chunked stream followed by a pipelined request that has to wait for the end of the stream
+	check(c.send_all("GET /stream HTTP/1.1\r\n\r\nGET /hello HTTP/1.1\r\n\r\n"), "send stream request");
+	check(c.read_response(status, body), "read stream");
+	std::string expected;
+	for (int i = 0; i < 8; ++i)
+		expected += "chunk " + std::to_string(i) + "\n";
+	check(body == expected, "stream content");
+	check(c.read_response(status, body) && body == "hello world", "request after stream");
+
+	// exceptions of the handler are answered with 500 and keep the connection usable
+	check(c.send_all("GET /throw HTTP/1.1\r\n\r\nGET /hello HTTP/1.1\r\n\r\n"), "send throwing request");
+	check(c.read_response(status, body) && status == "HTTP/1.1 500 Internal Server Error", "500 status");
+	check(c.read_response(status, body) && body == "hello world", "request after exception");
+
+	// request with body and connection close
+	check(c.send_all("POST /missing HTTP/1.1\r\nContent-Length: 5\r\nConnection: close\r\n\r\nabcde"), "send post");
+	check(c.read_response(status, body) && status == "HTTP/1.1 404 Not Found", "404 status");
+	check(!c.fill(), "connection closed after Connection: close");
+
+	// requests that exceed the input limit are rejected as soon as their header is complete
+	client large;
+	check(large.connect_to(port), "connect for large request");
+	check(large.send_all("POST /hello HTTP/1.1\r\nContent-Length: 1048576\r\n\r\n"), "send large request");
+	check(large.read_response(status, body) && status == "HTTP/1.1 413 Payload Too Large", "413 status");
+	check(!large.fill(), "connection closed after 413");
+}
+
+struct load_result
+{
+	std::vector<double> latencies;
+	size_t nr_failures;
+	load_result() : nr_failures(0) {}
+};
+
+static void run_client(unsigned port, unsigned nr_requests, unsigned depth, load_result& result)
+{
+	client c;
+	if (!c.connect_to(port)) {
+		result.nr_failures += nr_requests;
+		return;
+	}
+	std::string batch;
+	for (unsigned i = 0; i < depth; ++i)
+		batch += "GET /hello HTTP/1.1\r\nHost: localhost\r\n\r\n";
+	std::string status, body;
+	for (unsigned done = 0; done < nr_requests; done += depth) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (!c.send_all(batch)) {
+			result.nr_failures += nr_requests - done;
+			return;
+		}
+		for (unsigned i = 0; i < depth; ++i) {
+			if (!c.read_response(status, body) || body != "hello world") {
+				result.nr_failures += nr_requests - done;
+				return;
+			}
+			result.latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	unsigned nr_connections = argc > 1 ? atoi(argv[1]) : 16;
+	unsigned nr_requests = argc > 2 ? atoi(argv[2]) : 2000;
+	unsigned depth = argc > 3 ? std::max(1, atoi(argv[3])) : 1;
+	unsigned nr_workers = argc > 4 ? atoi(argv[4]) : 0;
+	unsigned port = argc > 5 ? atoi(argv[5]) : 18080;
+	nr_requests = (nr_requests + depth - 1) / depth * depth;
+
+	web_server_provider_epoll::set_nr_worker_threads(nr_workers);
+	load_test_server* server = new load_test_server(port);
+	server->file_name = "web_server_load_test.dat";
+	std::string file_content;
+	for (unsigned i = 0; i < 200000; ++i)
+		file_content += char('a' + i % 26);
+	std::ofstream(server->file_name.c_str(), std::ios::binary) << file_content;
+	std::thread server_thread([server]() { server->start(); });
+	// wait until the server accepts connections
+	bool ready = false;
+	for (int i = 0; i < 200 && !ready; ++i) {
+		client c;
+		ready = c.connect_to(port);
+		if (!ready)
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	check(ready, "server start");
+	if (ready) {
+		test_protocol(port, file_content);
+
+		std::vector<load_result> results(nr_connections);
+		std::vector<std::thread> clients;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (unsigned i = 0; i < nr_connections; ++i)
+			clients.push_back(std::thread(run_client, port, nr_requests, depth, std::ref(results[i])));
+		for (unsigned i = 0; i < nr_connections; ++i)
+			clients[i].join();
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::vector<double> latencies;
+		size_t nr_failures = 0;
+		for (unsigned i = 0; i < nr_connections; ++i) {
+			latencies.insert(latencies.end(), results[i].latencies.begin(), results[i].latencies.end());
+			nr_failures += results[i].nr_failures;
+		}
+		std::sort(latencies.begin(), latencies.end());
+		check(nr_failures == 0, "all load requests answered");
+		if (!latencies.empty()) {
+			std::printf("%u connections x %u requests, pipeline depth %u, %u workers\n", nr_connections, nr_requests, depth,
+				web_server_provider_epoll::get_nr_worker_threads());
+			std::printf("%.0f requests/s, latency p50 %.1f us, p99 %.1f us, max %.1f us\n", latencies.size() / seconds,
+				latencies[latencies.size() / 2], latencies[size_t(0.99 * (latencies.size() - 1))], latencies.back());
+		}
+	}
+	server->stop();
+	server_thread.join();
+	delete server;
+	std::remove("web_server_load_test.dat");
+	std::cout << nr_errors << " errors" << std::endl;
+	return nr_errors == 0 ? 0 : 1;
+}
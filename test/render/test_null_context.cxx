@@ -0,0 +1,117 @@
+#include <cgv/render/null_context.h>
+#include <cgv/render/drawable.h>
+#include <cgv/render/vertex_buffer.h>
+#include <cgv/render/attribute_array_binding.h>
+#include <cgv/math/ftransform.h>
+#include <cgv/base/node.h>
+#include <cgv/base/register.h>
+#include <iostream>
+
+using namespace cgv::base;
+using namespace cgv::render;
+
+/// drawable that draws a set of cubes from a vertex buffer and with the immediate mode tesselation
+class cube_drawable : public node, public drawable
+{
+	vertex_buffer vbo;
+	attribute_array_binding aab;
+	std::vector<vec3> points;
+public:
+	unsigned nr_cubes;
+	cube_drawable(const std::string& name, unsigned n) : node(name), nr_cubes(n), points(1000, vec3(1.0f)) {}
+	std::string get_type_name() const { return "cube_drawable"; }
+	bool init(context& ctx)
+	{
+		shader_program& prog = ctx.ref_surface_shader_program();
+		return vbo.create(ctx, points) && aab.create(ctx) &&
+			aab.set_attribute_array(ctx, prog.get_position_index(), type_descriptor(cgv::type::info::TI_FLT32, 3u), vbo, 0, points.size());
+	}
+	void draw(context& ctx)
+	{
+		shader_program& prog = ctx.ref_surface_shader_program();
+		prog.enable(ctx);
+		aab.enable(ctx);
+		aab.disable(ctx);
+		for (unsigned i = 0; i < nr_cubes; ++i) {
+			ctx.push_modelview_matrix();
+			ctx.mul_modelview_matrix(cgv::math::translate4<double>(i, 0.0, 0.0));
+			prog.set_uniform(ctx, "scale", 0.5f);
+			ctx.tesselate_unit_cube();
+			ctx.pop_modelview_matrix();
+		}
+		prog.disable(ctx);
+	}
+	void clear(context& ctx)
+	{
+		aab.destruct(ctx);
+		vbo.destruct(ctx);
+	}
+};
+
+bool test_null_context()
+{
+	null_context_ptr ctx_ptr(new null_context(800, 600));
+	null_context& ctx = *ctx_ptr;
+	TEST_ASSERT_EQ(ctx.get_render_api(), RA_NULL);
+	cube_drawable* a = new cube_drawable("a", 3);
+	cube_drawable* b = new cube_drawable("b", 1);
+	ctx.append_child(a);
+	ctx.append_child(b);
+	// initialization uploads the vertex buffers
+	TEST_ASSERT_EQ(ctx.get_statistics().nr_commands[NCC_VERTEX_BUFFER_CREATE], size_t(2));
+	TEST_ASSERT_EQ(ctx.get_statistics().nr_buffer_bytes, size_t(2 * 1000 * sizeof(render_types::vec3)));
+	ctx.render_frame();
+	const render_statistics& stats = ctx.get_statistics();
+	// one cube is drawn with six quads
+	TEST_ASSERT_EQ(stats.nr_draw_calls, size_t(4));
+	TEST_ASSERT_EQ(stats.nr_vertices, size_t(4 * 24));
+	TEST_ASSERT_EQ(stats.nr_commands[NCC_SHADER_PROGRAM_ENABLE], size_t(2));
+	TEST_ASSERT_EQ(stats.nr_commands[NCC_ATTRIBUTE_ARRAY_BINDING_ENABLE], size_t(2));
+	TEST_ASSERT_EQ(stats.nr_commands[NCC_CLEAR], size_t(1));
+	TEST_ASSERT_EQ(stats.nr_buffer_bytes, size_t(0));
+	TEST_ASSERT(stats.nr_uniform_sets >= 4);
+	TEST_ASSERT(stats.nr_state_changes > 0);
+	TEST_ASSERT_EQ(ctx.get_commands().size(), stats.nr_commands[NCC_CLEAR] + stats.nr_commands[NCC_DRAW] + stats.nr_state_changes +
+		stats.nr_uniform_sets + stats.nr_commands[NCC_SET_ATTRIBUTE_ARRAY]);
+	// a frame without recording collects the same statistics
+	size_t nr_commands = ctx.get_commands().size();
+	ctx.set_recording(false);
+	ctx.render_frame();
+	TEST_ASSERT(ctx.get_commands().empty());
+	TEST_ASSERT_EQ(ctx.get_statistics().nr_draw_calls, size_t(4));
+	ctx.set_recording(true);
+	ctx.render_frame();
+	TEST_ASSERT_EQ(ctx.get_commands().size(), nr_commands);
+	// timings are reported per drawable
+	ctx.clear_drawable_timings();
+	double frame_seconds = ctx.replay_frame(10);
+	TEST_ASSERT(frame_seconds > 0);
+	TEST_ASSERT_EQ(ctx.get_nr_timed_frames(), 10u);
+	TEST_ASSERT_EQ(ctx.get_drawable_timings().size(), size_t(2));
+	TEST_ASSERT_EQ(ctx.get_drawable_timings()[0].name, std::string("cube_drawable a"));
+	TEST_ASSERT_EQ(ctx.get_drawable_timings()[1].name, std::string("cube_drawable b"));
+	TEST_ASSERT(ctx.get_drawable_timings()[0].seconds > 0);
+	ctx.remove_all_children();
+	return true;
+}
+
+bool test_null_context_performance()
+{
+	null_context_ptr ctx_ptr(new null_context());
+	null_context& ctx = *ctx_ptr;
+	ctx.append_child(new cube_drawable("small", 10));
+	ctx.append_child(new cube_drawable("large", 1000));
+	ctx.replay_frame(10);
+	ctx.clear_drawable_timings();
+	double frame_seconds = ctx.replay_frame(100);
+	std::cout << "\n  " << 1000 * frame_seconds << " ms per frame\n";
+	ctx.print_report(std::cout);
+	ctx.remove_all_children();
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_null_context_reg("cgv::render::test_null_context", test_null_context);
+
+extern CGV_API benchmark_registration test_null_context_performance_reg("cgv::render::test_null_context_performance", test_null_context_performance);
@@ -0,0 +1,290 @@
+#include <cgv/render/render_snapshot.h>
+#include <cgv/render/update_pool.h>
+#include <cgv/render/frame_jitter_meter.h>
+#include <cgv/render/null_context.h>
+#include <cgv/render/drawable.h>
+#include <cgv/render/vertex_buffer.h>
+#include <cgv/base/node.h>
+#include <cgv/base/register.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+using namespace cgv::base;
+using namespace cgv::render;
+
+/// snapshot of which all entries equal the version, such that torn snapshots can be detected
+struct version_snapshot
+{
+	std::vector<cgv::type::uint64_type> values;
+};
+
+/// task that fails if it runs concurrently with another task of the same owner
+struct exclusive_task
+{
+	std::atomic<int>* nr_running;
+	std::atomic<int>* nr_runs;
+	bool* overlapped;
+	void operator () () const
+	{
+		if (nr_running->fetch_add(1) != 0)
+			*overlapped = true;
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+		nr_running->fetch_sub(1);
+		nr_runs->fetch_add(1);
+	}
+};
+
+/// publish n snapshots of the given size
+static void publish_versions(snapshot_buffer<version_snapshot>* sb, unsigned n, size_t size)
+{
+	for (unsigned i = 0; i < n; ++i) {
+		version_snapshot& s = sb->ref_back();
+		s.values.assign(size, sb->get_nr_published() + 1);
+		sb->publish();
+	}
+}
+
+bool test_render_snapshot()
+{
+	// sequential publish and consume
+	snapshot_buffer<version_snapshot> sb;
+	TEST_ASSERT(!sb.has_new_snapshot());
+	TEST_ASSERT(!sb.consume());
+	TEST_ASSERT_EQ(sb.get_front_version(), cgv::type::uint64_type(0));
+	TEST_ASSERT(sb.ref_front().values.empty());
+	publish_versions(&sb, 1, 4);
+	TEST_ASSERT(sb.has_new_snapshot());
+	TEST_ASSERT(sb.consume());
+	TEST_ASSERT(!sb.has_new_snapshot());
+	TEST_ASSERT_EQ(sb.get_front_version(), cgv::type::uint64_type(1));
+	TEST_ASSERT_EQ(sb.ref_front().values.size(), size_t(4));
+	TEST_ASSERT_EQ(sb.ref_front().values[0], cgv::type::uint64_type(1));
+	// the render side only sees the latest of several published snapshots
+	publish_versions(&sb, 5, 4);
+	TEST_ASSERT(sb.consume());
+	TEST_ASSERT_EQ(sb.get_front_version(), cgv::type::uint64_type(6));
+	TEST_ASSERT_EQ(sb.ref_front().values[3], cgv::type::uint64_type(6));
+	TEST_ASSERT(!sb.consume());
+	TEST_ASSERT_EQ(sb.get_front_version(), cgv::type::uint64_type(6));
+
+	// uploads are only needed after a new snapshot has been consumed
+	snapshot_upload_tracker tracker;
+	TEST_ASSERT(tracker.needs_upload(sb));
+	tracker.set_uploaded(sb);
+	TEST_ASSERT(!tracker.needs_upload(sb));
+	publish_versions(&sb, 1, 4);
+	TEST_ASSERT(!tracker.needs_upload(sb));
+	sb.consume();
+	TEST_ASSERT(tracker.needs_upload(sb));
+	tracker.set_uploaded(sb);
+	tracker.invalidate();
+	TEST_ASSERT(tracker.needs_upload(sb));
+
+	// concurrent publishing never hands a snapshot under construction to the render side
+	snapshot_buffer<version_snapshot> concurrent;
+	std::thread writer(publish_versions, &concurrent, 20000u, size_t(64));
+	cgv::type::uint64_type last_version = 0;
+	bool consistent = true, monotonic = true;
+	unsigned nr_consumed = 0;
+	while (last_version < 20000) {
+		if (!concurrent.consume()) {
+			std::this_thread::yield();
+			continue;
+		}
+		++nr_consumed;
+		const version_snapshot& s = concurrent.ref_front();
+		cgv::type::uint64_type v = concurrent.get_front_version();
+		for (size_t i = 0; i < s.values.size(); ++i)
+			if (s.values[i] != v)
+				consistent = false;
+		if (s.values.size() != 64)
+			consistent = false;
+		if (v <= last_version)
+			monotonic = false;
+		last_version = v;
+	}
+	writer.join();
+	TEST_ASSERT(consistent);
+	TEST_ASSERT(monotonic);
+	TEST_ASSERT(nr_consumed > 0);
+
+	// the tasks of one owner run exclusively and pending tasks are replaced
+	cgv::os::task_scheduler scheduler(3);
+	update_pool pool(&scheduler);
+	TEST_ASSERT_EQ(pool.get_nr_threads(), 3u);
+	std::atomic<int> nr_running(0), nr_runs(0);
+	bool overlapped = false;
+	exclusive_task task = { &nr_running, &nr_runs, &overlapped };
+	int owner;
+	unsigned nr_replaced = 0;
+	for (unsigned i = 0; i < 200; ++i)
+		if (!pool.schedule(&owner, task))
+			++nr_replaced;
+	pool.wait(&owner);
+	TEST_ASSERT(!pool.is_busy(&owner));
+	TEST_ASSERT(!overlapped);
+	TEST_ASSERT_EQ(nr_runs.load() + int(nr_replaced), 200);
+	TEST_ASSERT(nr_runs.load() >= 1);
+
+	// tasks of different owners run concurrently
+	std::atomic<int> started(0);
+	int owners[3];
+	for (unsigned i = 0; i < 3; ++i)
+		pool.schedule(&owners[i], [&started]() {
+			started.fetch_add(1);
+			std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+			while (started.load() < 3 && std::chrono::steady_clock::now() - t < std::chrono::seconds(5))
+				std::this_thread::yield();
+		});
+	pool.wait_all();
+	TEST_ASSERT_EQ(started.load(), 3);
+
+	// cancel removes a pending task that waits behind a running one
+	std::atomic<bool> release(false);
+	std::atomic<int> nr_cancelled_runs(0);
+	pool.schedule(&owner, [&release]() { while (!release.load()) std::this_thread::yield(); });
+	pool.schedule(&owner, [&nr_cancelled_runs]() { nr_cancelled_runs.fetch_add(1); });
+	TEST_ASSERT(pool.is_busy(&owner));
+	TEST_ASSERT(pool.cancel(&owner));
+	TEST_ASSERT(!pool.cancel(&owner));
+	release = true;
+	pool.wait(&owner);
+	TEST_ASSERT_EQ(nr_cancelled_runs.load(), 0);
+	TEST_ASSERT(!pool.is_busy(&owner));
+
+	// the process wide pool is constructed once
+	TEST_ASSERT(&ref_update_pool() == &ref_update_pool());
+	TEST_ASSERT(ref_update_pool().get_nr_threads() >= 1);
+	return true;
+}
+
+/// drawable that receives a new point cloud every few frames, whose construction takes longer than a frame
+class cloud_drawable : public node, public drawable
+{
+public:
+	struct cloud
+	{
+		std::vector<vec3> points;
+	};
+protected:
+	update_pool& pool;
+	snapshot_buffer<cloud> clouds;
+	snapshot_upload_tracker tracker;
+	vertex_buffer vbo;
+	unsigned nr_frames;
+	unsigned nr_points;
+	unsigned sensor_period;
+	/// construct the point cloud of the given sensor frame and publish it
+	void construct_cloud(unsigned sensor_frame)
+	{
+		std::vector<vec3>& P = clouds.ref_back().points;
+		P.resize(nr_points);
+		float phase = 0.1f * sensor_frame;
+		for (unsigned i = 0; i < nr_points; ++i) {
+			float a = 0.001f * i + phase;
+			P[i] = vec3(std::cos(a) * std::sin(0.37f * a), std::sin(a) * std::cos(0.53f * a), std::exp(-0.0001f * i));
+		}
+		clouds.publish();
+	}
+public:
+	bool in_background;
+	unsigned nr_uploads;
+	cloud_drawable(update_pool& _pool, unsigned _nr_points, unsigned _sensor_period, bool _in_background) :
+		node("cloud"), pool(_pool), nr_frames(0), nr_points(_nr_points), sensor_period(_sensor_period), in_background(_in_background), nr_uploads(0) {}
+	~cloud_drawable() { pool.wait(this); }
+	std::string get_type_name() const { return "cloud_drawable"; }
+	void init_frame(context& ctx)
+	{
+		if (nr_frames++ % sensor_period == 0) {
+			if (in_background)
+				pool.schedule(this, std::bind(&cloud_drawable::construct_cloud, this, nr_frames));
+			else
+				construct_cloud(nr_frames);
+		}
+		clouds.consume();
+	}
+	void draw(context& ctx)
+	{
+		const cloud& c = clouds.ref_front();
+		if (c.points.empty())
+			return;
+		if (tracker.needs_upload(clouds)) {
+			if (vbo.is_created() && vbo.get_size_in_bytes() == c.points.size() * sizeof(vec3))
+				vbo.replace(ctx, 0, &c.points.front(), c.points.size());
+			else {
+				vbo.destruct(ctx);
+				vbo.create(ctx, c.points);
+			}
+			tracker.set_uploaded(clouds);
+			++nr_uploads;
+		}
+		shader_program& prog = ctx.ref_surface_shader_program();
+		prog.enable(ctx);
+		ctx.tesselate_unit_cube();
+		prog.disable(ctx);
+	}
+	void clear(context& ctx)
+	{
+		vbo.destruct(ctx);
+		tracker.invalidate();
+	}
+	void wait() { pool.wait(this); }
+};
+
+/// render nr_frames frames with a frame budget of the given milliseconds and return the measured frame times
+static frame_jitter_meter measure_frames(null_context& ctx, unsigned nr_frames, double budget_ms)
+{
+	frame_jitter_meter meter;
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now();
+	meter.tick();
+	for (unsigned i = 0; i < nr_frames; ++i) {
+		ctx.render_frame();
+		// emulate waiting for the vertical retrace, where frames that miss the deadline wait for the next one
+		deadline += std::chrono::microseconds(int(1000 * budget_ms));
+		while (deadline < std::chrono::steady_clock::now())
+			deadline += std::chrono::microseconds(int(1000 * budget_ms));
+		std::this_thread::sleep_until(deadline);
+		meter.tick();
+	}
+	return meter;
+}
+
+bool test_render_snapshot_performance()
+{
+	const unsigned nr_points = 600000;
+	const unsigned sensor_period = 4;
+	const unsigned nr_frames = 120;
+	const double budget_ms = 16.0;
+	cgv::os::task_scheduler scheduler(1);
+	update_pool pool(&scheduler);
+	std::cout << "\n  " << nr_points << " points every " << sensor_period << " frames, frame budget " << budget_ms << " ms\n";
+	for (int mode = 0; mode < 2; ++mode) {
+		bool in_background = mode == 1;
+		null_context_ptr ctx_ptr(new null_context(320, 240));
+		null_context& ctx = *ctx_ptr;
+		ctx.set_recording(false);
+		cloud_drawable* d = new cloud_drawable(pool, nr_points, sensor_period, in_background);
+		ctx.append_child(d);
+		// warm up allocations of all three snapshots
+		measure_frames(ctx, 12, budget_ms);
+		d->wait();
+		frame_jitter_meter meter = measure_frames(ctx, nr_frames, budget_ms);
+		d->wait();
+		std::cout << "  " << (in_background ? "update pool: " : "gui thread:  ")
+			<< "frame time avg " << meter.get_average() << " ms, jitter " << meter.get_jitter()
+			<< " ms, max " << meter.get_max() << " ms, " << d->nr_uploads << " uploads\n";
+		TEST_ASSERT(d->nr_uploads > 0);
+		ctx.remove_all_children();
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_render_snapshot_reg("cgv::render::test_render_snapshot", test_render_snapshot);
+
+extern CGV_API benchmark_registration test_render_snapshot_performance_reg("cgv::render::test_render_snapshot_performance", test_render_snapshot_performance);
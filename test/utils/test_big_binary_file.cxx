@@ -0,0 +1,235 @@
+#include <cgv/base/register.h>
+#include <cgv/utils/big_binary_file.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace cgv::base;
+using namespace cgv::utils;
+
+static const char* test_file_name = "test_big_binary_file.bin";
+
+/// write file whose bytes are a function of their offset
+static bool write_test_file(size_t size)
+{
+	big_binary_file f(test_file_name);
+	if (!f.open(big_binary_file::WRITE))
+		return false;
+	std::vector<unsigned char> data(size);
+	for (size_t i = 0; i < size; ++i)
+		data[i] = (unsigned char)(i * 7 + (i >> 12));
+	bool result = f.write_array(&data[0], data.size());
+	f.close();
+	return result;
+}
+
+static unsigned char expected_byte(long long i)
+{
+	return (unsigned char)(i * 7 + (i >> 12));
+}
+
+static bool check_range(const unsigned char* data, long long offset, size_t num)
+{
+	for (size_t i = 0; i < num; ++i)
+		if (data[i] != expected_byte(offset + i))
+			return false;
+	return true;
+}
+
+bool test_big_binary_file()
+{
+	const size_t size = 3 << 20;
+	TEST_ASSERT(write_test_file(size))
+	big_binary_file f(test_file_name);
+	TEST_ASSERT_EQ(f.size(), (long long)size)
+	TEST_ASSERT(f.open(big_binary_file::READ))
+	std::vector<unsigned char> buffer(size);
+	size_t numread = 0;
+	TEST_ASSERT(f.read(&buffer[0], size, &numread))
+	TEST_ASSERT_EQ(numread, size)
+	TEST_ASSERT(check_range(&buffer[0], 0, size))
+	TEST_ASSERT(!f.read(&buffer[0], 10, &numread))
+	TEST_ASSERT_EQ(numread, (size_t)0)
+
+	// read ahead with small reads and jumps
+	std::mt19937 gen(11);
+	f.set_read_ahead(64 << 10);
+	long long pos = 12345;
+	TEST_ASSERT(f.seek(pos))
+	for (unsigned i = 0; i < 20000; ++i) {
+		size_t num = gen() % 3000;
+		if (i % 500 == 0) {
+			pos = gen() % size;
+			f.seek(pos);
+		}
+		if (i % 1000 == 1)
+			num = 200000;
+		bool success = f.read(&buffer[0], num, &numread);
+		size_t expected = (size_t)std::min<long long>(num, size - pos);
+		TEST_ASSERT_EQ(numread, expected)
+		TEST_ASSERT_EQ(success, expected == num)
+		TEST_ASSERT(check_range(&buffer[0], pos, numread))
+		pos += numread;
+		TEST_ASSERT_EQ(f.position(), pos)
+		if (pos == (long long)size) {
+			pos = 0;
+			f.seek(0);
+		}
+	}
+	f.set_read_ahead(0);
+
+	// asynchronous reads with futures and callbacks
+	std::vector<std::vector<unsigned char> > blocks(32, std::vector<unsigned char>(40000));
+	std::vector<std::future<size_t> > futures;
+	for (unsigned i = 0; i < 16; ++i)
+		futures.push_back(f.read_async(i * 100000, &blocks[i][0], blocks[i].size()));
+	std::atomic<unsigned> nr_correct(0);
+	for (unsigned i = 16; i < 32; ++i) {
+		long long offset = i * 100000;
+		unsigned char* ptr = &blocks[i][0];
+		f.read_async(offset, ptr, blocks[i].size(), [&nr_correct, offset, ptr](size_t n) {
+			if (n == 40000 && check_range(ptr, offset, n))
+				++nr_correct;
+		});
+	}
+	for (unsigned i = 0; i < 16; ++i) {
+		TEST_ASSERT_EQ(futures[i].get(), (size_t)40000)
+		TEST_ASSERT(check_range(&blocks[i][0], i * 100000, 40000))
+	}
+	f.wait_async();
+	TEST_ASSERT_EQ(nr_correct.load(), 16u)
+	TEST_ASSERT_EQ(f.read_async(size - 100, &buffer[0], 1000).get(), (size_t)100)
+
+	// memory mapped views with unaligned offsets
+	const unsigned char* ptr = f.map(12345, 100000, big_binary_file::AH_SEQUENTIAL);
+	TEST_ASSERT(ptr != 0)
+	TEST_ASSERT_EQ(f.get_mapped_size(), (size_t)100000)
+	TEST_ASSERT(check_range(ptr, 12345, 100000))
+	TEST_ASSERT(f.advise(5000, 20000, big_binary_file::AH_WILL_NEED))
+	ptr = f.map(size - 10);
+	TEST_ASSERT(ptr != 0)
+	TEST_ASSERT_EQ(f.get_mapped_size(), (size_t)10)
+	TEST_ASSERT(check_range(ptr, size - 10, 10))
+	TEST_ASSERT(f.map(size) == 0)
+	f.close();
+	TEST_ASSERT(f.get_mapped_ptr() == 0)
+
+	// write through a mapped view
+	TEST_ASSERT(f.open(big_binary_file::READ_WRITE))
+	unsigned char* wptr = f.map(1000, 10);
+	TEST_ASSERT(wptr != 0)
+	wptr[0] = 42;
+	f.close();
+	TEST_ASSERT(f.open(big_binary_file::READ))
+	unsigned char v = 0;
+	TEST_ASSERT(f.seek(1000) && f.read(v) && v == 42)
+	f.close();
+
+	// offsets beyond 4GB in a sparse file
+	TEST_ASSERT(f.open(big_binary_file::READ_WRITE))
+	long long big_offset = 5ll << 30;
+	TEST_ASSERT(f.seek(big_offset))
+	TEST_ASSERT(f.write(123456789ll))
+	TEST_ASSERT_EQ(f.size(), big_offset + 8)
+	long long w = 0;
+	TEST_ASSERT(f.seek(big_offset) && f.read(w) && w == 123456789ll)
+	f.close();
+	std::remove(test_file_name);
+	return true;
+}
+
+bool test_big_binary_file_performance()
+{
+	const size_t size = 256 << 20;
+	const size_t block = 4096;
+	TEST_ASSERT(write_test_file(size))
+	std::vector<unsigned char> buffer(block);
+	typedef std::chrono::high_resolution_clock clock;
+	double mb = size / double(1 << 20);
+	unsigned checksum = 0;
+
+	// sequential reads of small blocks
+	FILE* fp = fopen(test_file_name, "rb");
+	clock::time_point t0 = clock::now();
+	while (fread(&buffer[0], 1, block, fp) == block)
+		checksum += buffer[0];
+	clock::time_point t1 = clock::now();
+	fclose(fp);
+	big_binary_file f(test_file_name);
+	f.open(big_binary_file::READ);
+	while (f.read(&buffer[0], block))
+		checksum += buffer[0];
+	clock::time_point t2 = clock::now();
+	f.seek(0);
+	f.set_read_ahead(1 << 20);
+	while (f.read(&buffer[0], block))
+		checksum += buffer[0];
+	clock::time_point t3 = clock::now();
+	f.set_read_ahead(0);
+	const unsigned char* ptr = f.map(0, 0, big_binary_file::AH_SEQUENTIAL);
+	for (size_t i = 0; i < size; i += block) {
+		std::memcpy(&buffer[0], ptr + i, block);
+		checksum += buffer[0];
+	}
+	clock::time_point t4 = clock::now();
+	f.unmap();
+	std::cout << "sequential 4KB reads: stdio " << mb / std::chrono::duration<double>(t1 - t0).count()
+		<< " MB/s, read " << mb / std::chrono::duration<double>(t2 - t1).count()
+		<< " MB/s, read ahead " << mb / std::chrono::duration<double>(t3 - t2).count()
+		<< " MB/s, mapped " << mb / std::chrono::duration<double>(t4 - t3).count() << " MB/s" << std::endl;
+
+	// random reads of small blocks
+	const unsigned n = 20000;
+	std::vector<long long> offsets(n);
+	std::mt19937 gen(3);
+	for (unsigned i = 0; i < n; ++i)
+		offsets[i] = (gen() % (size / block)) * block;
+	double random_mb = n * block / double(1 << 20);
+	fp = fopen(test_file_name, "rb");
+	t0 = clock::now();
+	for (unsigned i = 0; i < n; ++i) {
+		fseek(fp, (long)offsets[i], SEEK_SET);
+		if (fread(&buffer[0], 1, block, fp) == block)
+			checksum += buffer[0];
+	}
+	t1 = clock::now();
+	fclose(fp);
+	for (unsigned i = 0; i < n; ++i)
+		if (f.read_at(offsets[i], &buffer[0], block))
+			checksum += buffer[0];
+	t2 = clock::now();
+	const unsigned nr_outstanding = 16;
+	std::vector<unsigned char> blocks(nr_outstanding * block);
+	std::vector<std::future<size_t> > futures(nr_outstanding);
+	for (unsigned i = 0; i < n; ++i) {
+		unsigned j = i % nr_outstanding;
+		if (futures[j].valid() && futures[j].get() == block)
+			checksum += blocks[j * block];
+		futures[j] = f.read_async(offsets[i], &blocks[j * block], block);
+	}
+	f.wait_async();
+	t3 = clock::now();
+	ptr = f.map(0, 0, big_binary_file::AH_RANDOM);
+	for (unsigned i = 0; i < n; ++i) {
+		std::memcpy(&buffer[0], ptr + offsets[i], block);
+		checksum += buffer[0];
+	}
+	t4 = clock::now();
+	f.close();
+	std::cout << "random 4KB reads: stdio " << random_mb / std::chrono::duration<double>(t1 - t0).count()
+		<< " MB/s, read_at " << random_mb / std::chrono::duration<double>(t2 - t1).count()
+		<< " MB/s, " << nr_outstanding << " async " << random_mb / std::chrono::duration<double>(t3 - t2).count()
+		<< " MB/s, mapped " << random_mb / std::chrono::duration<double>(t4 - t3).count() << " MB/s (checksum " << checksum << ")" << std::endl;
+	std::remove(test_file_name);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_big_binary_file_reg("cgv::utils::test_big_binary_file", test_big_binary_file);
+
+extern CGV_API benchmark_registration test_big_binary_file_performance_reg("cgv::utils::test_big_binary_file_performance", test_big_binary_file_performance);
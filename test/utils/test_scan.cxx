@@ -0,0 +1,323 @@
+#include <cgv/base/register.h>
+#include <cgv/utils/advanced_scan.h>
+#include <cgv/utils/tokenizer.h>
+#include <cgv/utils/convert_string.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+using namespace cgv::base;
+using namespace cgv::utils;
+
+/// reference implementation of split_to_tokens that checks every character with string searches
+static void reference_split_to_tokens(const char* begin, const char* end, std::vector<token>& tokens, const std::string& separators,
+	bool merge_separators, const std::string& open_parenthesis, const std::string& close_parenthesis, const std::string& whitespaces)
+{
+	const char* b = begin;
+	const char* p = b;
+	size_t pos;
+	bool last_is_sep = false;
+	while (p < end) {
+		bool is_sep = false;
+		bool is_whitespace = false;
+		bool create_token = false;
+		if ((is_whitespace = is_element(*p, whitespaces)))
+			create_token = true;
+		else {
+			is_sep = is_element(*p, separators);
+			if (is_sep) {
+				if (!(last_is_sep && merge_separators))
+					create_token = true;
+			}
+			else if (last_is_sep)
+				create_token = true;
+		}
+		last_is_sep = is_sep;
+		if (create_token) {
+			if (p > b)
+				tokens.push_back(token(b, p));
+			b = is_whitespace ? p + 1 : p;
+		}
+		else if ((pos = open_parenthesis.find_first_of(*p)) != std::string::npos) {
+			b = ++p;
+			while (p != end && *p != close_parenthesis[pos])
+				++p;
+			tokens.push_back(token(b, p));
+			b = p + 1;
+		}
+		if (p == end)
+			break;
+		++p;
+		if (p == end && p > b)
+			tokens.push_back(token(b, p));
+	}
+}
+
+/// reference implementation of split_to_lines that scans character by character
+static void reference_split_to_lines(const char* global_begin, const char* global_end, std::vector<line>& lines)
+{
+	const char* ptr = global_begin;
+	while (ptr < global_end) {
+		const char* begin = ptr;
+		while (ptr < global_end && *ptr != '\n')
+			++ptr;
+		const char* end = ptr;
+		while (end > begin && is_space(end[-1]))
+			--end;
+		lines.push_back(line(begin, end));
+		++ptr;
+	}
+}
+
+/// tokenizer with the reference implementation of bite that checks every character with string searches
+struct reference_tokenizer : public tokenizer
+{
+	reference_tokenizer(const std::string& s) : tokenizer(s) {}
+	token reference_bite()
+	{
+		skip_whitespaces();
+		token result(begin, begin);
+		if (handle_separators(result)) {
+			begin = result.end;
+			return result;
+		}
+		if (result.end == end) {
+			begin = result.end;
+			return result;
+		}
+		while (++result.end < end) {
+			const char* tmp_end = result.end;
+			if (handle_skip(result) && result.end == end)
+				break;
+			if (result.end < end && (is_element(*result.end, separators) || is_element(*result.end, whitespaces))) {
+				begin = result.end = tmp_end;
+				return result;
+			}
+		}
+		begin = result.end;
+		return result;
+	}
+	void reference_bite_all(std::vector<token>& result)
+	{
+		while (!skip_ws_check_empty())
+			result.push_back(reference_bite());
+	}
+};
+
+static bool same_tokens(const std::vector<token>& a, const std::vector<token>& b)
+{
+	if (a.size() != b.size())
+		return false;
+	for (size_t i = 0; i < a.size(); ++i)
+		if (a[i].begin != b[i].begin || a[i].end != b[i].end)
+			return false;
+	return true;
+}
+
+/// generate text of OBJ files with about the given size
+static std::string generate_obj_text(size_t size)
+{
+	std::mt19937 gen(7);
+	std::uniform_real_distribution<double> coord(-100.0, 100.0);
+	std::string text;
+	text.reserve(size + 100);
+	char buffer[128];
+	unsigned i = 0;
+	while (text.size() < size) {
+		if (i % 3 == 2)
+			sprintf(buffer, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", i, i, i, i + 1, i + 1, i + 1, i + 2, i + 2, i + 2);
+		else
+			sprintf(buffer, "v %.6f %.6f %.6f\n", coord(gen), coord(gen), coord(gen));
+		text += buffer;
+		++i;
+	}
+	return text;
+}
+
+bool test_split_equivalence()
+{
+	std::mt19937 gen(3);
+	// alphabet with frequent separators, white spaces and parentheses
+	const char alphabet[] = "abcxyz0123456789 \t\n\r,;/()'\"{}";
+	std::uniform_int_distribution<int> char_dist(0, sizeof(alphabet) - 2);
+	std::uniform_int_distribution<int> len_dist(0, 200);
+	for (unsigned iter = 0; iter < 2000; ++iter) {
+		std::string s(len_dist(gen), ' ');
+		for (size_t j = 0; j < s.size(); ++j)
+			s[j] = alphabet[char_dist(gen)];
+		// occasional long runs of plain characters exercise the vectorized search
+		if (iter % 4 == 0)
+			s.insert(len_dist(gen) % (s.size() + 1), std::string(len_dist(gen), 'k'));
+		const char* b = s.c_str();
+		const char* e = b + s.size();
+		bool merge = (iter & 1) != 0;
+		std::vector<token> t0, t1;
+		split_to_tokens(b, e, t0, ",;/", merge, "(\"", ")\"", " \t\n\r");
+		reference_split_to_tokens(b, e, t1, ",;/", merge, "(\"", ")\"", " \t\n\r");
+		TEST_ASSERT(same_tokens(t0, t1))
+		t0.clear(); t1.clear();
+		split_to_tokens(b, e, t0, "", merge, "", "", " \t");
+		reference_split_to_tokens(b, e, t1, "", merge, "", "", " \t");
+		TEST_ASSERT(same_tokens(t0, t1))
+
+		std::vector<line> l0, l1;
+		split_to_lines(b, e, l0);
+		reference_split_to_lines(b, e, l1);
+		TEST_ASSERT(same_tokens(std::vector<token>(l0.begin(), l0.end()), std::vector<token>(l1.begin(), l1.end())))
+
+		std::vector<token> k0, k1;
+		tokenizer tok(s);
+		reference_tokenizer ref(s);
+		if (merge) {
+			tok.set_sep(",;/", true).set_skip("'({", "')}", "\\\\\\");
+			ref.set_sep(",;/", true).set_skip("'({", "')}", "\\\\\\");
+		}
+		else {
+			tok.set_sep("()").set_skip("\"'", "\"'");
+			ref.set_sep("()").set_skip("\"'", "\"'");
+		}
+		bite_all(tok, k0);
+		ref.reference_bite_all(k1);
+		TEST_ASSERT(same_tokens(k0, k1))
+	}
+	return true;
+}
+
+bool test_parse_numbers()
+{
+	std::mt19937_64 gen(5);
+	std::uniform_real_distribution<double> mantissa_dist(-1.0, 1.0);
+	std::uniform_int_distribution<int> exponent_dist(-320, 310);
+	char buffer[64];
+	for (unsigned i = 0; i < 100000; ++i) {
+		double v = std::ldexp(mantissa_dist(gen), exponent_dist(gen) * 3);
+		if (i % 2 == 0)
+			v = std::floor(mantissa_dist(gen) * 1e6) / 1000.0;
+		const char* formats[] = { "%.17g", "%.9g", "%.6f", "%.3e" };
+		sprintf(buffer, formats[i % 4], v);
+		const char* end = buffer + std::strlen(buffer);
+		double d;
+		TEST_ASSERT_EQ(parse_double(buffer, end, d), end)
+		TEST_ASSERT_EQ(d, std::strtod(buffer, 0))
+		float f;
+		TEST_ASSERT_EQ(parse_float(buffer, end, f), end)
+		TEST_ASSERT_EQ(f, std::strtof(buffer, 0))
+	}
+	// inputs with more than 19 significant digits
+	const char* long_numbers[] = { "3.14159265358979323846264338327950288", "123456789012345678901234567890", "0.000000000000000000000000123456789012345678901234567", "9007199254740993" };
+	for (unsigned i = 0; i < 4; ++i) {
+		double d;
+		parse_double(long_numbers[i], long_numbers[i] + std::strlen(long_numbers[i]), d);
+		TEST_ASSERT_EQ(d, std::strtod(long_numbers[i], 0))
+	}
+	// partial matches and failures
+	double d = 7;
+	const char* s = "-1.5e3x";
+	TEST_ASSERT_EQ(parse_double(s, s + 7, d) - s, 6)
+	TEST_ASSERT_EQ(d, -1500.0)
+	s = "2.e";
+	TEST_ASSERT_EQ(parse_double(s, s + 3, d) - s, 2)
+	TEST_ASSERT_EQ(d, 2.0)
+	s = "-.e5";
+	TEST_ASSERT_EQ(parse_double(s, s + 4, d), s)
+	s = "1e999";
+	TEST_ASSERT_EQ(parse_double(s, s + 5, d) - s, 5)
+	TEST_ASSERT(d > 1e308)
+	long long l;
+	s = "-9223372036854775808";
+	TEST_ASSERT_EQ(parse_integer(s, s + 20, l) - s, 20)
+	TEST_ASSERT(l == -9223372036854775807ll - 1)
+	s = "9223372036854775808";
+	TEST_ASSERT_EQ(parse_integer(s, s + 19, l), s)
+	s = "+";
+	TEST_ASSERT_EQ(parse_integer(s, s + 1, l), s)
+	// conversions of convert_string
+	int n;
+	TEST_ASSERT(from_string(n, " -42 ") && n == -42)
+	TEST_ASSERT(!from_string(n, "abc"))
+	TEST_ASSERT(!from_string(n, "4294967296"))
+	TEST_ASSERT(from_string(d, "\t0.1") && d == 0.1)
+	float f;
+	TEST_ASSERT(from_string(f, "2.5e-3") && f == 2.5e-3f)
+	TEST_ASSERT(!from_string(f, ""))
+	TEST_ASSERT(is_double("1.25e2", d) && d == 125.0)
+	return true;
+}
+
+bool test_scan_performance()
+{
+	std::string text = generate_obj_text(64 << 20);
+	const char* b = text.c_str();
+	const char* e = b + text.size();
+	double gb = text.size() / 1e9;
+	typedef std::chrono::high_resolution_clock clock;
+
+	std::vector<line> lines, ref_lines;
+	lines.reserve(4 << 20);
+	ref_lines.reserve(4 << 20);
+	clock::time_point t0 = clock::now();
+	reference_split_to_lines(b, e, ref_lines);
+	clock::time_point t1 = clock::now();
+	split_to_lines(b, e, lines);
+	clock::time_point t2 = clock::now();
+	TEST_ASSERT_EQ(lines.size(), ref_lines.size())
+	std::cout << "split_to_lines: reference " << gb / std::chrono::duration<double>(t1 - t0).count()
+		<< " GB/s, vectorized " << gb / std::chrono::duration<double>(t2 - t1).count() << " GB/s" << std::endl;
+
+	std::vector<token> tokens, ref_tokens;
+	tokens.reserve(32 << 20);
+	ref_tokens.reserve(32 << 20);
+	t0 = clock::now();
+	reference_split_to_tokens(b, e, ref_tokens, "/", false, "", "", " \t\n\r");
+	t1 = clock::now();
+	split_to_tokens(b, e, tokens, "/", false, "", "", " \t\n\r");
+	t2 = clock::now();
+	TEST_ASSERT_EQ(tokens.size(), ref_tokens.size())
+	std::cout << "split_to_tokens: reference " << gb / std::chrono::duration<double>(t1 - t0).count()
+		<< " GB/s, vectorized " << gb / std::chrono::duration<double>(t2 - t1).count() << " GB/s" << std::endl;
+
+	tokens.clear();
+	ref_tokens.clear();
+	reference_tokenizer ref(text);
+	ref.set_ws(" \t\n\r").set_sep("/");
+	tokenizer tok(text);
+	tok.set_ws(" \t\n\r").set_sep("/");
+	t0 = clock::now();
+	ref.reference_bite_all(ref_tokens);
+	t1 = clock::now();
+	tok.bite_all(tokens);
+	t2 = clock::now();
+	TEST_ASSERT_EQ(tokens.size(), ref_tokens.size())
+	std::cout << "tokenizer: reference " << gb / std::chrono::duration<double>(t1 - t0).count()
+		<< " GB/s, vectorized " << gb / std::chrono::duration<double>(t2 - t1).count() << " GB/s" << std::endl;
+
+	// parse the vertex coordinates
+	double sum = 0, ref_sum = 0;
+	t0 = clock::now();
+	for (size_t i = 0; i < tokens.size(); ++i)
+		if (*tokens[i].begin == '-' || (*tokens[i].begin >= '0' && *tokens[i].begin <= '9'))
+			ref_sum += atof(std::string(tokens[i].begin, tokens[i].end).c_str());
+	t1 = clock::now();
+	for (size_t i = 0; i < tokens.size(); ++i) {
+		double v;
+		if (parse_double(tokens[i].begin, tokens[i].end, v) != tokens[i].begin)
+			sum += v;
+	}
+	t2 = clock::now();
+	TEST_ASSERT_EQ(sum, ref_sum)
+	std::cout << "number parsing: atof " << tokens.size() / std::chrono::duration<double>(t1 - t0).count()
+		<< " tokens/s, parse_double " << tokens.size() / std::chrono::duration<double>(t2 - t1).count() << " tokens/s" << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_split_equivalence_reg("cgv::utils::test_split_equivalence", test_split_equivalence);
+
+extern CGV_API test_registration test_parse_numbers_reg("cgv::utils::test_parse_numbers", test_parse_numbers);
+
+extern CGV_API benchmark_registration test_scan_performance_reg("cgv::utils::test_scan_performance", test_scan_performance);
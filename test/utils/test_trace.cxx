@@ -0,0 +1,170 @@
+#include <cgv/base/register.h>
+#include <cgv/utils/trace.h>
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace cgv::base;
+using namespace cgv::utils;
+
+static void traced_work(unsigned nr_iterations)
+{
+	CGV_TRACE_SCOPE("outer");
+	for (unsigned i = 0; i < nr_iterations; ++i) {
+		CGV_TRACE_SCOPE("inner");
+		CGV_TRACE_INSTANT("tick");
+	}
+}
+
+/// count events of the given thread and check that scopes are properly nested
+static bool check_thread_events(const std::vector<trace_record>& events, unsigned thread_index, size_t& nr_events)
+{
+	std::vector<unsigned> stack;
+	nr_events = 0;
+	for (size_t i = 0; i < events.size(); ++i) {
+		const trace_record& r = events[i];
+		if (r.thread_index != thread_index)
+			continue;
+		if (nr_events > 0 && r.time < events[i - 1].time)
+			return false;
+		++nr_events;
+		if (r.phase == TP_BEGIN)
+			stack.push_back(r.name_id);
+		else if (r.phase == TP_END) {
+			if (stack.empty() || stack.back() != r.name_id)
+				return false;
+			stack.pop_back();
+		}
+	}
+	return stack.empty();
+}
+
+bool test_trace()
+{
+	clear_trace();
+	// nothing is recorded while tracing is disabled
+	enable_tracing(false);
+	traced_work(10);
+	std::vector<trace_record> events;
+	collect_trace_events(events);
+	TEST_ASSERT(events.empty());
+	// trace in several threads
+	enable_tracing();
+	set_trace_thread_name("main");
+	traced_work(10);
+	std::vector<std::thread> threads;
+	for (unsigned t = 0; t < 3; ++t)
+		threads.push_back(std::thread([t]() {
+			set_trace_thread_name(std::string("worker \"") + char('a' + t) + "\"");
+			traced_work(100 * (t + 1));
+		}));
+	for (unsigned t = 0; t < threads.size(); ++t)
+		threads[t].join();
+	std::vector<std::string> thread_names;
+	collect_trace_events(events, &thread_names);
+	TEST_ASSERT(thread_names.size() >= 4);
+	unsigned nr_checked = 0;
+	for (unsigned ti = 0; ti < thread_names.size(); ++ti) {
+		size_t nr_events;
+		TEST_ASSERT(check_thread_events(events, ti, nr_events));
+		if (thread_names[ti] == "main") {
+			TEST_ASSERT_EQ(nr_events, size_t(2 + 3 * 10));
+			++nr_checked;
+		}
+		for (unsigned t = 0; t < 3; ++t)
+			if (thread_names[ti] == std::string("worker \"") + char('a' + t) + "\"") {
+				TEST_ASSERT_EQ(nr_events, size_t(2 + 3 * 100 * (t + 1)));
+				++nr_checked;
+			}
+	}
+	TEST_ASSERT_EQ(nr_checked, 4u);
+	TEST_ASSERT_EQ(get_trace_name(intern_trace_name("inner")), std::string("inner"));
+	// the events of the exited workers have been drained and are released, such that only the main thread events are exported again
+	unsigned main_index = unsigned(std::find(thread_names.begin(), thread_names.end(), std::string("main")) - thread_names.begin());
+	events.clear();
+	collect_trace_events(events);
+	size_t nr_main_events;
+	TEST_ASSERT(check_thread_events(events, main_index, nr_main_events));
+	TEST_ASSERT_EQ(events.size(), nr_main_events);
+	// the exported trace contains the kept events and the escaped names of all threads
+	std::stringstream ss;
+	write_chrome_trace(ss);
+	std::string json = ss.str();
+	TEST_ASSERT(json.find("\"traceEvents\"") != std::string::npos);
+	TEST_ASSERT(json.find("\"args\":{\"name\":\"worker \\\"c\\\"\"}") != std::string::npos);
+	size_t nr_lines = 0;
+	for (size_t i = 0; i < json.size(); ++i)
+		if (json[i] == '\n')
+			++nr_lines;
+	TEST_ASSERT_EQ(nr_lines, thread_names.size() + events.size() + 2);
+	// ring buffer keeps the most recent events and unmatched end events are not exported
+	clear_trace();
+	set_trace_buffer_capacity(100);
+	std::promise<void> recorded, finish;
+	std::future<void> finished = finish.get_future();
+	std::thread overflow_thread([&recorded, &finished]() {
+		set_trace_thread_name("overflow");
+		traced_work(1000);
+		recorded.set_value();
+		finished.wait();
+	});
+	recorded.get_future().wait();
+	set_trace_buffer_capacity(65536);
+	events.clear();
+	thread_names.clear();
+	collect_trace_events(events, &thread_names);
+	// the oldest kept event is dropped as its slot may be overwritten by the running thread
+	TEST_ASSERT_EQ(events.size(), size_t(127));
+	TEST_ASSERT_EQ(thread_names[events.front().thread_index], std::string("overflow"));
+	TEST_ASSERT(events.back().phase == TP_END && events.back().name_id == intern_trace_name("outer"));
+	ss.str("");
+	write_chrome_trace(ss);
+	json = ss.str();
+	TEST_ASSERT(json.find("\"name\":\"outer\",\"ph\":\"E\"") == std::string::npos);
+	// the events of a thread are kept until it exits and are collected once afterwards
+	finish.set_value();
+	overflow_thread.join();
+	events.clear();
+	collect_trace_events(events);
+	TEST_ASSERT_EQ(events.size(), size_t(128));
+	events.clear();
+	collect_trace_events(events);
+	TEST_ASSERT(events.empty());
+	enable_tracing(false);
+	clear_trace();
+	return true;
+}
+
+bool test_trace_performance()
+{
+	const unsigned n = 1000000;
+	typedef std::chrono::high_resolution_clock clock;
+	clear_trace();
+	enable_tracing(false);
+	clock::time_point t0 = clock::now();
+	traced_work(n);
+	clock::time_point t1 = clock::now();
+	enable_tracing();
+	traced_work(n);
+	clock::time_point t2 = clock::now();
+	enable_tracing(false);
+	std::stringstream ss;
+	write_chrome_trace(ss);
+	clock::time_point t3 = clock::now();
+	// each iteration records three events
+	std::cout << "\n  per event: disabled " << std::chrono::duration<double, std::nano>(t1 - t0).count() / (3.0*n)
+		<< " ns, enabled " << std::chrono::duration<double, std::nano>(t2 - t1).count() / (3.0*n)
+		<< " ns; chrome export of " << ss.str().size() / 1024 << " KB in " << std::chrono::duration<double, std::milli>(t3 - t2).count() << " ms" << std::endl;
+	clear_trace();
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_trace_reg("cgv::utils::test_trace", test_trace);
+
+extern CGV_API benchmark_registration test_trace_performance_reg("cgv::utils::test_trace_performance", test_trace_performance);